@@ -61,4 +61,48 @@ class AxisAlignedBox3f {
 	Vec3f mVerts[8];
 };
 
+//! Bounding volume hierarchy over an array of AxisAlignedBox3f's, for hierarchical culling with Frustum::intersects( const AxisAlignedBoxTree&, uint32_t* ).
+class AxisAlignedBoxTree {
+  public:
+	//! Bounds are stored as center and half size. Each subtree covers the contiguous range [mFirstItem, mFirstItem + mNumItems) of the tree-ordered items.
+	struct Node {
+		Vec3f		mCenter, mHalfSize;
+		uint32_t	mFirstItem, mNumItems;
+		//! Index of the first of two consecutive children, or 0 for leaves
+		uint32_t	mFirstChild;
+	};
+
+	AxisAlignedBoxTree() {}
+	//! Builds a tree over \a count boxes, splitting until nodes hold at most \a maxLeafSize boxes (no more than 32).
+	AxisAlignedBoxTree( const AxisAlignedBox3f *boxes, size_t count, size_t maxLeafSize = 16 ) { build( boxes, count, maxLeafSize ); }
+
+	//! Builds a tree over \a count boxes, splitting until nodes hold at most \a maxLeafSize boxes (no more than 32).
+	void	build( const AxisAlignedBox3f *boxes, size_t count, size_t maxLeafSize = 16 );
+	//! Updates the bounds of all nodes from \a boxes, which must have the same count and order as passed to build(). Cheaper than rebuilding for moving objects, but the tree quality degrades with large motions.
+	void	refit( const AxisAlignedBox3f *boxes );
+
+	//! Returns the number of boxes in the tree
+	size_t	getNumItems() const { return mItemIndices.size(); }
+	const std::vector<Node>&		getNodes() const { return mNodes; }
+	//! Returns the index passed to build() for each item in tree order
+	const std::vector<uint32_t>&	getItemIndices() const { return mItemIndices; }
+
+	//! Item bounds in tree order, as structure-of-arrays for batch tests such as Frustum::intersectsBoxes()
+	const float*	getItemCentersX() const { return mItemCenters[0].data(); }
+	const float*	getItemCentersY() const { return mItemCenters[1].data(); }
+	const float*	getItemCentersZ() const { return mItemCenters[2].data(); }
+	const float*	getItemHalfSizesX() const { return mItemHalfSizes[0].data(); }
+	const float*	getItemHalfSizesY() const { return mItemHalfSizes[1].data(); }
+	const float*	getItemHalfSizesZ() const { return mItemHalfSizes[2].data(); }
+
+  protected:
+	void		buildNode( uint32_t nodeIndex, uint32_t first, uint32_t count, size_t maxLeafSize, const AxisAlignedBox3f *boxes );
+	void		refitNode( uint32_t nodeIndex );
+	void		setItem( uint32_t treeIndex, const AxisAlignedBox3f &box );
+
+	std::vector<Node>		mNodes;
+	std::vector<uint32_t>	mItemIndices;
+	std::vector<float>		mItemCenters[3], mItemHalfSizes[3];
+};
+
 } // namespace cinder
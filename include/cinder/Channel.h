@@ -27,6 +27,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Area.h"
+#include "cinder/PixelAllocator.h"
 
 namespace cinder {
 
@@ -46,6 +47,8 @@ class ChannelT {
 		T							*mData;
 		uint8_t						mIncrement;
 		bool						mOwnsData;
+		PixelAllocatorRef			mAllocator;
+		size_t						mAllocatedBytes;
 		
 		void						(*mDeallocatorFunc)(void *refcon);
 		void						*mDeallocatorRefcon;
@@ -55,7 +58,7 @@ class ChannelT {
  public:
 	/*! Constructs an empty Channel, which is the equivalent of NULL and should not be used directly. */
 	ChannelT() {}
-	//! Allocates and owns a contiguous block of memory that is sizeof(T) * width * height
+	//! Allocates and owns a contiguous block of memory that is sizeof(T) * width * height, from PixelAllocator::getDefault()
 	ChannelT( int32_t width, int32_t height );
 	//! Does not allocate or own memory pointed to by \a data
 	ChannelT( int32_t width, int32_t height, int32_t rowBytes, uint8_t increment, T *data );
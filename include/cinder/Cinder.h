@@ -90,6 +90,13 @@ using std::uint64_t;
 
 #define CINDER_LITTLE_ENDIAN
 
+// SIMD instruction sets available to the compiler; used to select vectorized code paths
+#if defined( _M_X64 ) || defined( _M_IX86 ) || defined( __SSE2__ )
+	#define CINDER_SSE2
+#elif defined( __ARM_NEON__ )
+	#define CINDER_NEON
+#endif
+
 } // namespace cinder
 
 #if defined( CINDER_WINRT )
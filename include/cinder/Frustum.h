@@ -82,6 +82,16 @@ class Frustum
 		return intersects(box); 
 	};
 
+	//! Tests \a count spheres, given as separate arrays of center coordinates and radii. Sets bit \a i of \a resultMask if sphere \a i is partially contained within frustum. \a resultMask must hold ( count + 31 ) / 32 words. Returns the number of visible spheres.
+	size_t intersectsSpheres( const T *centerX, const T *centerY, const T *centerZ, const T *radius, size_t count, uint32_t *resultMask ) const;
+	//! Tests \a count boxes, given as separate arrays of center coordinates and half sizes. Sets bit \a i of \a resultMask if box \a i is partially contained within frustum. \a resultMask must hold ( count + 31 ) / 32 words. Returns the number of visible boxes.
+	size_t intersectsBoxes( const T *centerX, const T *centerY, const T *centerZ, const T *halfSizeX, const T *halfSizeY, const T *halfSizeZ, size_t count, uint32_t *resultMask ) const;
+	//! Tests the boxes of \a tree, skipping subtrees which are fully inside or outside the frustum. Bit \a i of \a resultMask corresponds to box \a i passed to AxisAlignedBoxTree::build(). Returns the number of visible boxes.
+	size_t intersects( const AxisAlignedBoxTree &tree, uint32_t *resultMask ) const;
+
+	//! Writes the indices of the set bits in the first \a count bits of \a mask to \a indices. Returns the number of indices written.
+	static size_t	maskToIndices( const uint32_t *mask, size_t count, uint32_t *indices );
+
   protected:
 	Plane<T>	mFrustumPlanes[6];
 };
@@ -30,6 +30,8 @@
 #include "cinder/BSpline.h"
 
 #include <set>
+#include <string>
+#include <functional>
 
 namespace cinder { namespace geom {
 
@@ -43,7 +45,16 @@ enum Attrib { POSITION, COLOR, TEX_COORD_0, TEX_COORD_1, TEX_COORD_2, TEX_COORD_
 	NUM_ATTRIBS };
 extern std::string sAttribNames[(int)Attrib::NUM_ATTRIBS];
 enum Primitive { LINES, TRIANGLES, TRIANGLE_STRIP, TRIANGLE_FAN }; 
-enum DataType { FLOAT, INTEGER, DOUBLE };
+/*! Storage format of a vertex attribute. The \c _NORM types are fixed-point and are fetched by the GPU as floats normalized
+	to [-1,1] (signed) or [0,1] (unsigned). The packed \c 10_10_10_2 types always occupy 4 bytes per element, with the
+	2-bit component holding w. \c INTEGER attributes are stored and submitted to GL as 32-bit floats, as they were before
+	these formats existed. */
+enum DataType { FLOAT, INTEGER, DOUBLE, HALF_FLOAT, INT8_NORM, UINT8_NORM, INT16_NORM, UINT16_NORM, INT_10_10_10_2_NORM, UINT_10_10_10_2_NORM };
+
+//! Returns the number of bytes occupied by one element of \a dims components stored as \a dataType. 8 and 16-bit types are padded to a multiple of 4 bytes.
+uint8_t		dataTypeByteSize( DataType dataType, uint8_t dims );
+//! Returns whether \a dataType is a fixed-point format which is normalized when fetched
+bool		isNormalized( DataType dataType );
 
 //! Debug utility which returns the name of \a attrib as a std::string
 std::string attribToString( Attrib attrib );
@@ -66,7 +77,7 @@ struct AttribInfo {
 	void		setStride( size_t stride ) { mStride = stride; }
 	void		setOffset( size_t offset ) { mOffset = offset; }
 
-	uint8_t		getByteSize() const { if( mDataType == geom::DataType::DOUBLE ) return mDims * 8; else return mDims * 4; }
+	uint8_t		getByteSize() const { return dataTypeByteSize( mDataType, mDims ); }
 
 protected:
 	Attrib		mAttrib;
@@ -105,6 +116,10 @@ protected:
 };
 
 void copyData( uint8_t srcDimensions, const float *srcData, size_t numElements, uint8_t dstDimensions, size_t dstStrideBytes, float *dstData );
+//! Converts \a numElements of \a srcDimensions floats to \a dstDimensions components stored as \a dstDataType. Elements are tightly packed when \a dstStrideBytes is 0.
+void copyData( uint8_t srcDimensions, const float *srcData, size_t numElements, uint8_t dstDimensions, DataType dstDataType, size_t dstStrideBytes, void *dstData );
+//! Converts \a numElements of \a srcDimensions components stored as \a srcDataType back to tightly packed floats. Elements are tightly packed when \a srcStrideBytes is 0.
+void unpackData( DataType srcDataType, uint8_t srcDimensions, size_t srcStrideBytes, const void *srcData, size_t numElements, float *dstData );
 
 class Source {
 public:
@@ -152,6 +167,49 @@ protected:
 	void copyIndexDataForceTriangles( Primitive primitive, const uint32_t *source, size_t numIndices, uint16_t *target );
 };
 
+//! Process-wide cache of the vertex data generated by the parametric Sources, shared by every instance with identical parameters. Thread-safe.
+class PrimitiveCache {
+  public:
+	//! Generated vertex and index data of a primitive
+	struct Data {
+		std::vector<Vec3f>		mPositions;
+		std::vector<Vec3f>		mNormals;
+		std::vector<Vec2f>		mTexCoords;
+		std::vector<Vec3f>		mColors;
+		std::vector<uint32_t>	mIndices;
+
+		size_t	getByteSize() const;
+	};
+	typedef std::shared_ptr<const Data>	DataRef;
+
+	//! Identifies generated data by the Source's type name and every parameter that affects it
+	class Key {
+	  public:
+		explicit Key( const char *typeName ) : mBytes( typeName ) { mBytes.push_back( 0 ); }
+
+		//! Appends the bytes of \a value, which must be a POD type without padding
+		template<typename T>
+		Key&	operator<<( const T &value ) { mBytes.append( reinterpret_cast<const char*>( &value ), sizeof( T ) ); return *this; }
+		Key&	operator<<( const std::set<Attrib> &attribs );
+
+		const std::string&	getBytes() const { return mBytes; }
+
+	  private:
+		std::string		mBytes;
+	};
+
+	//! Returns the data cached for \a key, calling \a generate to produce it on a miss. \a generate runs outside of the cache's lock.
+	static DataRef	get( const Key &key, const std::function<void( Data *data )> &generate );
+
+	//! Sets the maximum number of bytes retained, evicting the least recently used data beyond it. \c 0 disables caching. Defaults to 32MB.
+	static void		setCapacity( size_t bytes );
+	static size_t	getCapacity();
+	//! Returns the number of bytes currently retained by the cache
+	static size_t	getSize();
+	//! Releases all cached data. Sources already holding data keep it alive.
+	static void		clear();
+};
+
 class Rect : public Source {
 public:
 	//! Defaults to having POSITION, TEX_COORD_0, NORMAL
@@ -209,16 +267,19 @@ public:
 	virtual Icosahedron&	enable( Attrib attrib ) { mEnabledAttribs.insert( attrib ); mCalculationsCached = false; return *this; }
 	virtual Icosahedron&	disable( Attrib attrib ) { mEnabledAttribs.erase( attrib ); mCalculationsCached = false; return *this; }
 
-	virtual size_t		getNumVertices() const override { calculate(); return mPositions.size(); }
-	virtual size_t		getNumIndices() const override { calculate(); return mIndices.size(); }
+	virtual size_t		getNumVertices() const override { calculate(); return mData->mPositions.size(); }
+	virtual size_t		getNumIndices() const override { calculate(); return mData->mIndices.size(); }
 	virtual Primitive	getPrimitive() const override { return Primitive::TRIANGLES; }
 	virtual uint8_t		getAttribDims( Attrib attr ) const override;
 	virtual void		loadInto( Target *target ) const override;
 
 protected:
 	virtual void		calculate() const;
+	virtual void		calculateImpl() const;
 
 	mutable bool						mCalculationsCached;
+	mutable PrimitiveCache::DataRef		mData;
+	// scratch storage for generation, moved into mData
 	mutable std::vector<Vec3f>			mPositions;
 	mutable std::vector<Vec3f>			mNormals;
 	mutable std::vector<Vec3f>			mColors;
@@ -249,8 +310,6 @@ protected:
 	void			updateVertexCounts() const;
 
 	static void		generatePatches( float *v, float *n, float *tc, uint32_t *el, int grid );
-	static void		buildPatchReflect( int patchNum, float *B, float *dB, float *v, float *n, float *tc, unsigned int *el,
-		int &index, int &elIndex, int &tcIndex, int grid, bool reflectX, bool reflectY );
 	static void		buildPatch( Vec3f patch[][4], float *B, float *dB, float *v, float *n, float *tc, 
 		unsigned int *el, int &index, int &elIndex, int &tcIndex, int grid, const Matrix33f reflect, bool invertNormal );
 	static void		getPatch( int patchNum, Vec3f patch[][4], bool reverseV );
@@ -263,10 +322,7 @@ protected:
 	mutable bool					mCalculationsCached;
 	mutable	size_t					mNumVertices;
 	mutable size_t					mNumIndices;
-	mutable std::vector<float>		mPositions;
-	mutable std::vector<float>		mTexCoords;
-	mutable std::vector<float>		mNormals;
-	mutable std::vector<uint32_t>	mIndices;
+	mutable PrimitiveCache::DataRef	mData;
 
 	static const uint8_t	sPatchIndices[][16];
 	static const float		sCurveData[][3];
@@ -332,6 +388,8 @@ protected:
 	int			mNumSlices;
 
 	mutable bool						mCalculationsCached;
+	mutable PrimitiveCache::DataRef		mData;
+	// scratch storage for generation, moved into mData
 	mutable std::vector<Vec3f>			mPositions;
 	mutable std::vector<Vec2f>			mTexCoords;
 	mutable std::vector<Vec3f>			mNormals;
@@ -353,6 +411,7 @@ public:
 
 protected:
 	virtual void		calculate() const;
+	virtual void		calculateImpl() const;
 	virtual void		calculateImplUV() const;
 	virtual void		subdivide() const;
 
@@ -416,8 +475,8 @@ public:
 		mRadiusMinor = math<float>::max(0.f, minor); 
 		mCalculationsCached = false; return *this; }
 
-	virtual size_t		getNumVertices() const override { calculate(); return mPositions.size(); }
-	virtual size_t		getNumIndices() const override { calculate(); return mIndices.size(); }
+	virtual size_t		getNumVertices() const override { calculate(); return mData->mPositions.size(); }
+	virtual size_t		getNumIndices() const override { calculate(); return mData->mIndices.size(); }
 	virtual Primitive	getPrimitive() const override { return Primitive::TRIANGLES; }
 	virtual uint8_t		getAttribDims( Attrib attr ) const override;
 	virtual void		loadInto( Target *target ) const override;
@@ -437,6 +496,8 @@ protected:
 	float		mTwistOffset;
 
 	mutable bool						mCalculationsCached;
+	mutable PrimitiveCache::DataRef		mData;
+	// scratch storage for generation, moved into mData
 	mutable std::vector<Vec3f>			mPositions;
 	mutable std::vector<Vec2f>			mTexCoords;
 	mutable std::vector<Vec3f>			mNormals;
@@ -490,8 +551,8 @@ public:
 	//! Conveniently sets origin, height and direction.
 	virtual Cylinder&	set( const Vec3f &from, const Vec3f &to );
 
-	virtual size_t		getNumVertices() const override { calculate(); return mPositions.size(); }
-	virtual size_t		getNumIndices() const override { calculate(); return mIndices.size(); }
+	virtual size_t		getNumVertices() const override { calculate(); return mData->mPositions.size(); }
+	virtual size_t		getNumIndices() const override { calculate(); return mData->mIndices.size(); }
 	virtual Primitive	getPrimitive() const override { return Primitive::TRIANGLES; }
 	virtual uint8_t		getAttribDims( Attrib attr ) const override;
 	virtual void		loadInto( Target *target ) const override;
@@ -510,6 +571,8 @@ protected:
 	int			mNumSlices;
 
 	mutable bool						mCalculationsCached;
+	mutable PrimitiveCache::DataRef		mData;
+	// scratch storage for generation, moved into mData
 	mutable std::vector<Vec3f>			mPositions;
 	mutable std::vector<Vec2f>			mTexCoords;
 	mutable std::vector<Vec3f>			mNormals;
@@ -0,0 +1,128 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Channel.h"
+#include "cinder/Area.h"
+#include "cinder/Vector.h"
+
+#include <list>
+#include <vector>
+#if defined( _MSC_VER ) && ( _MSC_VER >= 1600 ) || defined( _LIBCPP_VERSION )
+	#include <unordered_map>
+#else
+	#include <boost/unordered_map.hpp>
+#endif
+
+namespace cinder {
+
+/** CPU-side cache of glyph coverage bitmaps, packed onto shelves in fixed-size 8-bit pages. When no page has room for a new glyph the least recently used glyphs are evicted,
+	except those used since the last call to beginUse(). Each page tracks the Area modified since its last clearDirtyArea(), so only that needs to be re-uploaded to a texture.
+	Makes no graphics API calls and is not thread-safe. \see gl::TextureFont::Format::dynamicAtlas() **/
+class GlyphAtlas {
+  public:
+	typedef uint16_t	Glyph;
+
+	struct Entry {
+		//! The page the glyph is stored in
+		size_t		mPage;
+		//! The glyph's pixels within its page, which are empty for glyphs with no coverage, such as spaces
+		Area		mArea;
+		//! The offset of the upper-left of mArea from the glyph's origin, as supplied to insert()
+		Vec2f		mOriginOffset;
+	};
+
+	//! Creates an atlas of at most \a maxPages pages of \a pageWidth x \a pageHeight pixels, which leaves \a padding empty pixels between glyphs
+	GlyphAtlas( int32_t pageWidth, int32_t pageHeight, size_t maxPages, int32_t padding = 1 );
+
+	//! Starts a new use, typically one draw call. Glyphs found or inserted after this are not evicted until the next call.
+	void			beginUse();
+	//! Returns the Entry for \a glyph and marks it as used, or \c NULL if it isn't in the atlas
+	const Entry*	find( Glyph glyph );
+	/** Copies \a coverage into the atlas as \a glyph, evicting least recently used glyphs as necessary, and marks it as used. Returns its Entry,
+		or \c NULL if \a coverage doesn't fit even after evicting every glyph not used since beginUse(). An empty or null \a coverage is stored without taking up any space. **/
+	const Entry*	insert( Glyph glyph, const Channel8u &coverage, const Vec2f &originOffset );
+	//! Removes \a glyph from the atlas, if it's present
+	void			erase( Glyph glyph );
+	//! Returns the glyphs evicted since the last call, and clears the list
+	std::vector<Glyph>	takeEvicted();
+
+	//! Returns the number of glyphs in the atlas, including empty ones
+	size_t				getNumGlyphs() const { return mEntries.size(); }
+	//! Returns the number of pages allocated so far, which grows up to the \a maxPages passed to the constructor
+	size_t				getNumPages() const { return mPages.size(); }
+	//! Returns the 8-bit coverage of page \a page
+	const Channel8u&	getPage( size_t page ) const { return mPages[page].mChannel; }
+	//! Returns the Area of page \a page modified since its last clearDirtyArea(), which is empty if there's none
+	const Area&			getDirtyArea( size_t page ) const { return mPages[page].mDirtyArea; }
+	//! Marks page \a page as uploaded
+	void				clearDirtyArea( size_t page ) { mPages[page].mDirtyArea = Area( 0, 0, 0, 0 ); }
+
+	int32_t		getPageWidth() const { return mPageWidth; }
+	int32_t		getPageHeight() const { return mPageHeight; }
+	size_t		getMaxPages() const { return mMaxPages; }
+
+  protected:
+	// a row of glyphs of at most mHeight pixels, with its unused horizontal spans sorted by x
+	struct Shelf {
+		int32_t									mY, mHeight;
+		std::vector<std::pair<int32_t,int32_t> >	mFreeSpans; // [x1,x2)
+		size_t									mNumGlyphs;
+	};
+
+	struct Page {
+		Channel8u			mChannel;
+		std::vector<Shelf>	mShelves; // ordered by mY, without gaps
+		int32_t				mShelvesHeight;
+		Area				mDirtyArea;
+	};
+
+	struct Slot {
+		Entry								mEntry;
+		Area								mAllocated; // mEntry.mArea plus padding; empty if mEntry.mArea is
+		uint32_t							mLastUse;
+		std::list<Glyph>::iterator			mLruIt;
+	};
+
+	bool	allocate( int32_t width, int32_t height, size_t *resultPage, Area *resultArea );
+	bool	allocateOnPage( size_t pageIdx, int32_t width, int32_t height, Area *resultArea );
+	bool	evictLeastRecentlyUsed();
+	void	release( const Slot &slot );
+	void	touch( Slot &slot );
+
+	int32_t					mPageWidth, mPageHeight, mPadding;
+	size_t					mMaxPages;
+	std::vector<Page>		mPages;
+#if defined( _MSC_VER ) && ( _MSC_VER >= 1600 ) || defined( _LIBCPP_VERSION )
+	std::unordered_map<Glyph, Slot>		mEntries;
+#else
+	boost::unordered_map<Glyph, Slot>	mEntries;
+#endif
+	std::list<Glyph>		mLru; // most recently used first; only glyphs which take up space
+	uint32_t				mUse;
+	std::vector<Glyph>		mEvicted;
+};
+
+} // namespace cinder
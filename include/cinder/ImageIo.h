@@ -30,6 +30,7 @@
 #include "cinder/DataTarget.h"
 #include "cinder/Surface.h"
 #include "cinder/Exception.h"
+#include "cinder/RowSwizzle.h"
 
 #include <vector>
 #include <map>
@@ -85,27 +86,49 @@ class ImageIo {
 
 class ImageSource : public ImageIo {
   public:
-	ImageSource() : ImageIo(), mIsPremultiplied( false ), mPixelAspectRatio( 1 ), mCustomPixelInc( 0 ) {}
+	ImageSource() : ImageIo(), mIsPremultiplied( false ), mPixelAspectRatio( 1 ), mCustomPixelInc( 0 ), mReductionRegion( 0, 0, 0, 0 ), mReductionScale( 1 ), mReduced( false ) {}
 	virtual ~ImageSource() {}  
 
 	//! Optional parameters passed when creating an Image. \see loadImage()
 	class Options {
 	  public:
-		Options() : mIndex( 0 ), mThrowOnFirstException( false ) {}
+		Options() : mIndex( 0 ), mThrowOnFirstException( false ), mTargetSize( 0, 0 ), mScaleDenominator( 1 ), mRegion( 0, 0, 0, 0 ) {}
 
 		//! Specifies an image index for multi-part images, like animated GIFs
 		Options& index( int32_t index )						{ mIndex = index; return *this; }
 		//! If an exception occurs, enabling this will prevent any attempts at using other handlers to load the image. Default = false, all handlers are tried and if none succeed, the last exception is rethrown. \see ImageIoException
 		Options& throwOnFirstException( bool b = true )		{ mThrowOnFirstException = b; return *this; }
+		/** Requests the image (or its region()) be decoded at the smallest of 1/1, 1/2, 1/4 or 1/8 of full resolution that is still at least \a size in both dimensions.
+			Suited to thumbnails which are resized further after loading. Overrides scaleDenominator(). **/
+		Options& targetSize( const Vec2i &size )			{ mTargetSize = size; return *this; }
+		/** Requests the image be decoded at 1 / \a denominator of full resolution, where \a denominator is 1, 2, 4 or 8. Each resulting pixel is the average of a block of source pixels.
+			Decoders with native scaling, such as JPEG's, may differ from ceil( size / \a denominator ) by a pixel. **/
+		Options& scaleDenominator( int32_t denominator )	{ mScaleDenominator = denominator; return *this; }
+		//! Requests only the pixels within \a area, measured in full-resolution pixels, be decoded. Any scaling applies to the region.
+		Options& region( const Area &area )					{ mRegion = area; return *this; }
 
 		//! Returns image index. \see index()
 		int32_t				getIndex() const				{ return mIndex; }
 		//! Returns whether throwOnFirstException() is enabled or not.
 		bool				getThrowOnFirstException()		{ return mThrowOnFirstException; }
+		//! Returns the requested minimum size, or (0, 0) if none. \see targetSize()
+		const Vec2i&		getTargetSize() const			{ return mTargetSize; }
+		//! Returns the requested scale denominator. \see scaleDenominator()
+		int32_t				getScaleDenominator() const		{ return mScaleDenominator; }
+		//! Returns the requested region, which is empty if none was requested. \see region()
+		const Area&			getRegion() const				{ return mRegion; }
+
+		//! Returns the region() clipped to an image of \a fullWidth x \a fullHeight, or the whole image if no region was requested
+		Area				calcRegion( int32_t fullWidth, int32_t fullHeight ) const;
+		//! Returns the scale denominator (1, 2, 4 or 8) to decode a region of \a regionWidth x \a regionHeight with, resolving targetSize() and scaleDenominator()
+		int32_t				calcScaleDenominator( int32_t regionWidth, int32_t regionHeight ) const;
 		
 	  protected:
 		int32_t			mIndex;
 		bool			mThrowOnFirstException;
+		Vec2i			mTargetSize;
+		int32_t			mScaleDenominator;
+		Area			mRegion;
 	};
 
 	//! Returns the aspect ratio of individual pixels to accommodate non-square pixels
@@ -139,6 +162,23 @@ class ImageSource : public ImageIo {
 	void		rowFuncSourceRgb( ImageTargetRef target, int32_t row, const void *data );
 	template<typename SD, typename TD, ColorModel TCM, bool ALPHA>
 	void		rowFuncSourceGray( ImageTargetRef target, int32_t row, const void *data );
+	//! Converts a row with mRowSwizzle, used for everything but RGB to gray conversion
+	void		rowFuncSwizzle( ImageTargetRef target, int32_t row, const void *data );
+
+	/** Applies the region and scale requested by \a options to an image of \a fullWidth x \a fullHeight, and sets the ImageSource's size to the result.
+		Decoders which call this from their constructor hand each decoded row to processRow() instead of calling their RowFunc. **/
+	void		setupReduction( int32_t fullWidth, int32_t fullHeight, const Options &options );
+	//! Returns whether setupReduction() found a region or scale to apply
+	bool		isReduced() const { return mReduced; }
+	//! Returns the region of the full-resolution image being decoded. \see setupReduction()
+	const Area&	getReductionRegion() const { return mReductionRegion; }
+	//! Returns the scale denominator being decoded at. \see setupReduction()
+	int32_t		getReductionScale() const { return mReductionScale; }
+	/** Passes row \a sourceRow of the full-resolution image through \a func, applying the region and scale from setupReduction(). \a data points to the row's first pixel inside the region.
+		Rows must arrive in increasing order; rows outside the region are ignored. Blocks of rows are averaged as they arrive, so only one row of sums is held. **/
+	void		processRow( RowFunc func, ImageTargetRef target, int32_t sourceRow, const void *data );
+	template<typename SD>
+	void		processRowScaled( RowFunc func, ImageTargetRef target, int32_t sourceRow, const void *data );
 
 	float						mPixelAspectRatio;
 	bool						mIsPremultiplied;
@@ -148,6 +188,13 @@ class ImageSource : public ImageIo {
 	int8_t						mRowFuncTargetRed, mRowFuncTargetGreen, mRowFuncTargetBlue, mRowFuncTargetAlpha;
 	int8_t						mRowFuncSourceGray, mRowFuncTargetGray;
 	int8_t						mRowFuncSourceInc, mRowFuncTargetInc;
+	RowSwizzle					mRowSwizzle;
+
+	Area						mReductionRegion;
+	int32_t						mReductionScale;
+	bool						mReduced;
+	std::vector<float>			mReductionSums;
+	std::vector<uint8_t>		mReductionRow;
 };
 
 class ImageTarget : public ImageIo {
@@ -160,21 +207,36 @@ class ImageTarget : public ImageIo {
 	
 	class Options {
 	  public:
-		Options() : mQuality( 0.9f ), mColorModelDefault( true ) {}
+		//! PNG row filters. FILTER_ADAPTIVE chooses per row the filter whose output has the smallest sum of absolute values, as libpng does.
+		enum Filter { FILTER_NONE, FILTER_SUB, FILTER_UP, FILTER_AVERAGE, FILTER_PAETH, FILTER_ADAPTIVE };
+
+		Options() : mQuality( 0.9f ), mColorModelDefault( true ), mCompressionLevel( -1 ), mFilter( FILTER_ADAPTIVE ), mNumThreads( 0 ) {}
 		
 		Options& quality( float quality ) { mQuality = quality; return *this; }
 		Options& colorModel( ImageIo::ColorModel cm ) { mColorModelDefault = false; mColorModel = cm; return *this; }
+		//! Sets the zlib compression level of lossless encoders such as PNG, from 0 (stored) to 9 (smallest). Default is -1, zlib's default.
+		Options& compressionLevel( int level ) { mCompressionLevel = level; return *this; }
+		//! Sets the row filter of PNG encoders. Default is FILTER_ADAPTIVE.
+		Options& filter( Filter filter ) { mFilter = filter; return *this; }
+		//! Sets the number of threads used by encoders which can encode in parallel. Default is \c 0, which means std::thread::hardware_concurrency().
+		Options& numThreads( size_t numThreads ) { mNumThreads = numThreads; return *this; }
 		
 		void	setColorModelDefault() { mColorModelDefault = true; }
 		
 		float				getQuality() const { return mQuality; }
 		bool				isColorModelDefault() const { return mColorModelDefault; }
 		ImageIo::ColorModel	getColorModel() const { return mColorModel; }
+		int					getCompressionLevel() const { return mCompressionLevel; }
+		Filter				getFilter() const { return mFilter; }
+		size_t				getNumThreads() const { return mNumThreads; }
 		
 	  protected:
 		float					mQuality;
 		bool					mColorModelDefault;
 		ImageIo::ColorModel		mColorModel;
+		int						mCompressionLevel;
+		Filter					mFilter;
+		size_t					mNumThreads;
 	};
 	
   protected:
@@ -0,0 +1,159 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/ImageIo.h"
+#include "cinder/DataSource.h"
+#include "cinder/Thread.h"
+
+#include <atomic>
+#include <queue>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class ImageLoader>		ImageLoaderRef;
+
+/** Decodes images into Surfaces on a fixed pool of worker threads. Requests are served highest priority first, can be cancelled through a CancelToken,
+	and their completion callbacks are called from update(), which is typically called from the App's update(). Decoded pixels come from a PixelAllocatorPool,
+	and workers wait before decoding while more than Format::maxBytesInFlight() bytes of Surfaces have yet to be delivered. **/
+class ImageLoader {
+  public:
+	//! Cancels the requests it was passed to. A single token may be shared by any number of requests, for example all of the images of one gallery page.
+	class CancelToken {
+	  public:
+		CancelToken() : mCancelled( false ) {}
+
+		//! Cancels every request using this token. Requests still queued are dropped, and completions not yet delivered are discarded.
+		void	cancel() { mCancelled = true; }
+		bool	isCancelled() const { return mCancelled; }
+
+	  private:
+		std::atomic<bool>	mCancelled;
+	};
+	typedef std::shared_ptr<CancelToken>	CancelTokenRef;
+
+	//! Called from update() with the decoded Surface, which is empty if decoding failed
+	typedef std::function<void( const Surface8u &surface )>		CompletionFn;
+
+	struct Format {
+		Format() : mNumThreads( 0 ), mMaxBytesInFlight( 256 * 1024 * 1024 ), mAlpha( boost::logic::indeterminate ) {}
+
+		//! Sets the number of worker threads. Default is \c 0, which means one fewer than std::thread::hardware_concurrency() (and at least one).
+		Format&	numThreads( size_t numThreads ) { mNumThreads = numThreads; return *this; }
+		//! Sets the maximum number of bytes of decoded Surfaces not yet delivered by update(). A single image larger than this is still decoded once nothing else is in flight. Default is 256MB.
+		Format&	maxBytesInFlight( size_t maxBytes ) { mMaxBytesInFlight = maxBytes; return *this; }
+		//! Sets the allocator for decoded Surfaces. Default is a PixelAllocatorPool owned by the ImageLoader.
+		Format&	allocator( const PixelAllocatorRef &allocator ) { mAllocator = allocator; return *this; }
+		//! Sets whether decoded Surfaces have an alpha channel. Default is \c indeterminate, which follows each image.
+		Format&	alpha( boost::tribool alpha ) { mAlpha = alpha; return *this; }
+
+		size_t				getNumThreads() const { return mNumThreads; }
+		size_t				getMaxBytesInFlight() const { return mMaxBytesInFlight; }
+		PixelAllocatorRef	getAllocator() const { return mAllocator; }
+		boost::tribool		getAlpha() const { return mAlpha; }
+
+	  private:
+		size_t				mNumThreads, mMaxBytesInFlight;
+		PixelAllocatorRef	mAllocator;
+		boost::tribool		mAlpha;
+	};
+
+	static ImageLoaderRef	create( const Format &format = Format() ) { return ImageLoaderRef( new ImageLoader( format ) ); }
+	//! Cancels any outstanding requests and waits for the workers to finish their current images
+	~ImageLoader();
+
+	/** Queues \a dataSource for decoding and returns the CancelToken for the request, which is \a cancelToken when one is supplied. Higher values of \a priority are decoded first,
+		and requests of equal priority in the order they were made. Optional \a extension parameter allows specification of a file type. **/
+	CancelTokenRef	load( const DataSourceRef &dataSource, const CompletionFn &completionFn, int priority = 0, const CancelTokenRef &cancelToken = CancelTokenRef(), const std::string &extension = "" );
+	//! Queues the file at \a path for decoding; the file is opened on a worker thread. \see load( const DataSourceRef&, ... )
+	CancelTokenRef	load( const fs::path &path, const CompletionFn &completionFn, int priority = 0, const CancelTokenRef &cancelToken = CancelTokenRef(), const std::string &extension = "" );
+
+	/** Calls the completion callbacks of finished requests on the calling thread, at most \a maxCompletions of them when nonzero. Returns the number of callbacks called.
+		Requests whose tokens have been cancelled are discarded without a callback. **/
+	size_t	update( size_t maxCompletions = 0 );
+	//! Cancels every request made so far
+	void	cancelAll();
+
+	//! Returns the number of requests not yet picked up by a worker
+	size_t	getNumQueued() const;
+	//! Returns the number of decoded or decoding bytes whose completions have yet to be delivered by update()
+	size_t	getBytesInFlight() const;
+	//! Returns the allocator used for decoded Surfaces
+	const PixelAllocatorRef&	getAllocator() const { return mAllocator; }
+
+  protected:
+	ImageLoader( const Format &format );
+
+	struct Request {
+		DataSourceRef	mDataSource;
+		fs::path		mPath;
+		std::string		mExtension;
+		CompletionFn	mCompletionFn;
+		CancelTokenRef	mCancelToken;
+		int				mPriority;
+		uint64_t		mSequence;
+		uint32_t		mGeneration; // value of ImageLoader::mGeneration when requested; cancelAll() advances it
+		
+		bool operator<( const Request &rhs ) const { return ( mPriority != rhs.mPriority ) ? ( mPriority < rhs.mPriority ) : ( mSequence > rhs.mSequence ); }
+	};
+
+	struct Completion {
+		CompletionFn	mCompletionFn;
+		CancelTokenRef	mCancelToken;
+		uint32_t		mGeneration;
+		Surface8u		mSurface;
+		size_t			mBytes;
+	};
+
+	CancelTokenRef	enqueue( Request &request, const CompletionFn &completionFn, int priority, const CancelTokenRef &cancelToken, const std::string &extension );
+	bool			isCancelled( const CancelTokenRef &cancelToken, uint32_t generation ) const { return cancelToken->isCancelled() || generation != mGeneration; }
+	void			workerLoop();
+	void			decode( const Request &request );
+	//! Blocks until \a numBytes fit within the in-flight budget. Returns \c false if \a request is cancelled or the loader is shutting down while waiting.
+	bool			acquireBytes( size_t numBytes, const Request &request );
+	void			releaseBytes( size_t numBytes );
+
+	Format							mFormat;
+	PixelAllocatorRef				mAllocator;
+	std::vector<std::thread>		mThreads;
+	std::atomic<bool>				mShouldQuit;
+	uint64_t						mNextSequence;
+	std::atomic<uint32_t>			mGeneration;
+
+	mutable std::mutex				mQueueMutex;
+	std::condition_variable			mQueueCond;
+	std::priority_queue<Request>	mQueue;
+
+	mutable std::mutex				mBytesMutex;
+	std::condition_variable			mBytesCond;
+	size_t							mBytesInFlight;
+
+	std::mutex						mCompletionsMutex;
+	std::vector<Completion>			mCompletions;
+};
+
+} // namespace cinder
@@ -52,6 +52,7 @@ class ImageSourceFileWic : public ImageSource {
 	static IWICImagingFactory* getFactory();
 
 	bool	processFormat( const ::GUID &guid, ::GUID *convertGUID );
+	bool	loadScaledNative( ImageSource::RowFunc func, ImageTargetRef target );
 
 	std::shared_ptr<IWICBitmapFrameDecode>	mFrame;
 	std::shared_ptr<IWICStream>				mStream;
@@ -48,6 +48,7 @@ class ImageSourcePng : public ImageSource {
   protected:
 	ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Options options );
 	bool loadHeader();
+	bool setupTransformsForTarget( ImageTargetRef target );
 	
 	std::shared_ptr<ci_png_info>	mCiInfoPtr;
 	png_struct_def					*mPngPtr;
@@ -0,0 +1,57 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/ImageIo.h"
+
+#include <vector>
+
+namespace cinder {
+
+/** Writes PNG files using zlib directly. Rows are split into bands which are filtered and deflated on separate threads, and the bands are joined into a single zlib stream
+	in the manner of pigz: each band is primed with the preceding 32k of filtered data as its dictionary, and ends on a byte boundary with a sync flush.
+	The compression level, row filter and thread count come from ImageTarget::Options. Float images are written as 16-bit. **/
+class ImageTargetPng : public ImageTarget {
+  public:
+	static ImageTargetRef		createRef( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const std::string &extensionData );
+	
+	virtual void*	getRowPointer( int32_t row );
+	virtual void	finalize();
+	
+	static void		registerSelf();
+	
+  protected:
+	ImageTargetPng( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options );
+	
+	std::vector<uint8_t>		mData;
+	size_t						mRowBytes;
+	uint8_t						mNumChannels, mBytesPerChannel;
+	DataTargetRef				mDataTarget;
+	ImageTarget::Options		mOptions;
+};
+
+REGISTER_IMAGE_IO_FILE_HANDLER( ImageTargetPng )
+
+} // namespace cinder
@@ -211,6 +211,14 @@ public:
 	Vec3<T>				transformVec( const Vec3<T> &rhs ) const;
 	Vec4<T>				transformVec( const Vec4<T> &rhs ) const { return transformVec( rhs.xyz() ); }
 
+	// batch versions of the above, transforming \a count elements of \a src into \a dst. \a src and \a dst may be the same array.
+	// Matrix44f uses SSE or NEON where available.
+	void				transformPoints( const Vec3<T> *src, Vec3<T> *dst, size_t count ) const;
+	void				transformPointsAffine( const Vec3<T> *src, Vec3<T> *dst, size_t count ) const;
+	void				transformVecs( const Vec3<T> *src, Vec3<T> *dst, size_t count ) const;
+	// post-multiplies \a count column vectors - same as operator*( const Vec4<T>& ) on each
+	void				postMultiply( const Vec4<T> *src, Vec4<T> *dst, size_t count ) const;
+
 	// returns the translation values from the last column
 	Vec4<T>				getTranslate() const { return Vec4<T>( m03, m13, m23, m33 ); }
 	// sets the translation values in the last column
@@ -1086,6 +1094,40 @@ Vec3<T> Matrix44<T>::transformVec( const Vec3<T> &rhs ) const
 	return Vec3<T>( x, y, z );
 }
 
+template< typename T >
+void Matrix44<T>::transformPoints( const Vec3<T> *src, Vec3<T> *dst, size_t count ) const
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = transformPoint( src[i] );
+}
+
+template< typename T >
+void Matrix44<T>::transformPointsAffine( const Vec3<T> *src, Vec3<T> *dst, size_t count ) const
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = transformPointAffine( src[i] );
+}
+
+template< typename T >
+void Matrix44<T>::transformVecs( const Vec3<T> *src, Vec3<T> *dst, size_t count ) const
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = transformVec( src[i] );
+}
+
+template< typename T >
+void Matrix44<T>::postMultiply( const Vec4<T> *src, Vec4<T> *dst, size_t count ) const
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = *this * src[i];
+}
+
+// SIMD specializations; defined in Matrix.cpp
+template<> void Matrix44<float>::transformPoints( const Vec3<float> *src, Vec3<float> *dst, size_t count ) const;
+template<> void Matrix44<float>::transformPointsAffine( const Vec3<float> *src, Vec3<float> *dst, size_t count ) const;
+template<> void Matrix44<float>::transformVecs( const Vec3<float> *src, Vec3<float> *dst, size_t count ) const;
+template<> void Matrix44<float>::postMultiply( const Vec4<float> *src, Vec4<float> *dst, size_t count ) const;
+
 template< typename T > // thanks to @juj/MathGeoLib for fix
 void Matrix44<T>::orthonormalInvert()
 {
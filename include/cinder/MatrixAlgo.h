@@ -27,23 +27,25 @@
 #include "cinder/Matrix33.h"
 #include "cinder/Matrix44.h"
 
-#if defined( CINDER_MSW ) || defined( CINDER_MAC )
+#if defined( CINDER_SSE2 )
 #   include <emmintrin.h>
 #   include <xmmintrin.h>
+#elif defined( CINDER_NEON )
+#   include <arm_neon.h>
 #endif
 
 namespace cinder {
 
-#if defined( CINDER_MSW ) || defined( CINDER_MAC )
-
 #if defined( CINDER_MSW )
 	#define CINDER_ALIGN16_MATRIX44F( VAR ) \
 		__declspec( align( 16 ) ) Matrix44f VAR
-#elif defined( CINDER_MAC )
+#else
 	#define CINDER_ALIGN16_MATRIX44F( VAR ) \
 		Matrix44f VAR __attribute__ ( ( aligned ( 16 ) ) )
 #endif
 
+#if defined( CINDER_SSE2 )
+
 inline Matrix44f SseMultiply( const Matrix44f& mat0, const Matrix44f& mat1 ) 
 {
 	CINDER_ALIGN16_MATRIX44F( ret );
@@ -61,11 +63,11 @@ inline Matrix44f SseMultiply( const Matrix44f& mat0, const Matrix44f& mat1 )
 	//       the moment.
 	int i;
 
-	// Load in the rows for b
-	a_line_0  = _mm_load_ps( a +  0 );
-	a_line_4  = _mm_load_ps( a +  4 );
-	a_line_8  = _mm_load_ps( a +  8 );
-	a_line_12 = _mm_load_ps( a + 12 );
+	// Load in the rows for b; mat0 is not guaranteed to be 16-byte aligned
+	a_line_0  = _mm_loadu_ps( a +  0 );
+	a_line_4  = _mm_loadu_ps( a +  4 );
+	a_line_8  = _mm_loadu_ps( a +  8 );
+	a_line_12 = _mm_loadu_ps( a + 12 );
 
 	i = 0;
 	// 
@@ -254,6 +256,163 @@ inline Matrix44f SseInvert( const Matrix44f& mat )
 #   pragma runtime_checks( "", restore )
 #endif
 
-#endif // #if defined( CINDER_MSW ) || defined( CINDER_MAC )
+//! Transforms \a count points by \a mat including the divide by w. Same as Matrix44f::transformPoint() on each.
+inline void SseTransformPoints( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	const __m128 c0 = _mm_loadu_ps( mat.m +  0 );
+	const __m128 c1 = _mm_loadu_ps( mat.m +  4 );
+	const __m128 c2 = _mm_loadu_ps( mat.m +  8 );
+	const __m128 c3 = _mm_loadu_ps( mat.m + 12 );
+
+	for( size_t i = 0; i < count; ++i ) {
+		__m128 r = _mm_add_ps( _mm_mul_ps( c0, _mm_set1_ps( src[i].x ) ), c3 );
+		r = _mm_add_ps( _mm_mul_ps( c1, _mm_set1_ps( src[i].y ) ), r );
+		r = _mm_add_ps( _mm_mul_ps( c2, _mm_set1_ps( src[i].z ) ), r );
+		r = _mm_div_ps( r, _mm_shuffle_ps( r, r, _MM_SHUFFLE( 3, 3, 3, 3 ) ) );
+		// store x,y then z separately; a 4-wide store would clobber src[i+1] when transforming in place
+		_mm_storel_pi( (__m64*)&dst[i].x, r );
+		_mm_store_ss( &dst[i].z, _mm_movehl_ps( r, r ) );
+	}
+}
+
+//! Transforms \a count points by \a mat, omitting the divide by w. Same as Matrix44f::transformPointAffine() on each.
+inline void SseTransformPointsAffine( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	const __m128 c0 = _mm_loadu_ps( mat.m +  0 );
+	const __m128 c1 = _mm_loadu_ps( mat.m +  4 );
+	const __m128 c2 = _mm_loadu_ps( mat.m +  8 );
+	const __m128 c3 = _mm_loadu_ps( mat.m + 12 );
+
+	for( size_t i = 0; i < count; ++i ) {
+		__m128 r = _mm_add_ps( _mm_mul_ps( c0, _mm_set1_ps( src[i].x ) ), c3 );
+		r = _mm_add_ps( _mm_mul_ps( c1, _mm_set1_ps( src[i].y ) ), r );
+		r = _mm_add_ps( _mm_mul_ps( c2, _mm_set1_ps( src[i].z ) ), r );
+		_mm_storel_pi( (__m64*)&dst[i].x, r );
+		_mm_store_ss( &dst[i].z, _mm_movehl_ps( r, r ) );
+	}
+}
+
+//! Transforms \a count direction vectors by the upper 3x3 of \a mat. Same as Matrix44f::transformVec() on each.
+inline void SseTransformVecs( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	const __m128 c0 = _mm_loadu_ps( mat.m +  0 );
+	const __m128 c1 = _mm_loadu_ps( mat.m +  4 );
+	const __m128 c2 = _mm_loadu_ps( mat.m +  8 );
+
+	for( size_t i = 0; i < count; ++i ) {
+		__m128 r = _mm_mul_ps( c0, _mm_set1_ps( src[i].x ) );
+		r = _mm_add_ps( _mm_mul_ps( c1, _mm_set1_ps( src[i].y ) ), r );
+		r = _mm_add_ps( _mm_mul_ps( c2, _mm_set1_ps( src[i].z ) ), r );
+		_mm_storel_pi( (__m64*)&dst[i].x, r );
+		_mm_store_ss( &dst[i].z, _mm_movehl_ps( r, r ) );
+	}
+}
+
+//! Post-multiplies \a count column vectors by \a mat. Same as Matrix44f::operator*( const Vec4f& ) on each.
+inline void SsePostMultiply( const Matrix44f &mat, const Vec4f *src, Vec4f *dst, size_t count )
+{
+	const __m128 c0 = _mm_loadu_ps( mat.m +  0 );
+	const __m128 c1 = _mm_loadu_ps( mat.m +  4 );
+	const __m128 c2 = _mm_loadu_ps( mat.m +  8 );
+	const __m128 c3 = _mm_loadu_ps( mat.m + 12 );
+
+	for( size_t i = 0; i < count; ++i ) {
+		__m128 v = _mm_loadu_ps( &src[i].x );
+		__m128 r = _mm_mul_ps( c0, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 0, 0, 0, 0 ) ) );
+		r = _mm_add_ps( _mm_mul_ps( c1, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ), r );
+		r = _mm_add_ps( _mm_mul_ps( c2, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ), r );
+		r = _mm_add_ps( _mm_mul_ps( c3, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ), r );
+		_mm_storeu_ps( &dst[i].x, r );
+	}
+}
+
+#elif defined( CINDER_NEON )
+
+inline Matrix44f NeonMultiply( const Matrix44f& mat0, const Matrix44f& mat1 )
+{
+	CINDER_ALIGN16_MATRIX44F( ret );
+
+	const float32x4_t a0 = vld1q_f32( mat0.m +  0 );
+	const float32x4_t a1 = vld1q_f32( mat0.m +  4 );
+	const float32x4_t a2 = vld1q_f32( mat0.m +  8 );
+	const float32x4_t a3 = vld1q_f32( mat0.m + 12 );
+
+	for( int i = 0; i < 16; i += 4 ) {
+		float32x4_t r = vmulq_n_f32( a0, mat1.m[i + 0] );
+		r = vmlaq_n_f32( r, a1, mat1.m[i + 1] );
+		r = vmlaq_n_f32( r, a2, mat1.m[i + 2] );
+		r = vmlaq_n_f32( r, a3, mat1.m[i + 3] );
+		vst1q_f32( ret.m + i, r );
+	}
+
+	return ret;
+}
+
+//! Transforms \a count points by \a mat including the divide by w. Same as Matrix44f::transformPoint() on each.
+inline void NeonTransformPoints( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	const float32x4_t c0 = vld1q_f32( mat.m +  0 );
+	const float32x4_t c1 = vld1q_f32( mat.m +  4 );
+	const float32x4_t c2 = vld1q_f32( mat.m +  8 );
+	const float32x4_t c3 = vld1q_f32( mat.m + 12 );
+
+	for( size_t i = 0; i < count; ++i ) {
+		float32x4_t r = vmlaq_n_f32( c3, c0, src[i].x );
+		r = vmlaq_n_f32( r, c1, src[i].y );
+		r = vmlaq_n_f32( r, c2, src[i].z );
+		float invW = 1.0f / vgetq_lane_f32( r, 3 );
+		dst[i].set( vgetq_lane_f32( r, 0 ) * invW, vgetq_lane_f32( r, 1 ) * invW, vgetq_lane_f32( r, 2 ) * invW );
+	}
+}
+
+//! Transforms \a count points by \a mat, omitting the divide by w. Same as Matrix44f::transformPointAffine() on each.
+inline void NeonTransformPointsAffine( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	const float32x4_t c0 = vld1q_f32( mat.m +  0 );
+	const float32x4_t c1 = vld1q_f32( mat.m +  4 );
+	const float32x4_t c2 = vld1q_f32( mat.m +  8 );
+	const float32x4_t c3 = vld1q_f32( mat.m + 12 );
+
+	for( size_t i = 0; i < count; ++i ) {
+		float32x4_t r = vmlaq_n_f32( c3, c0, src[i].x );
+		r = vmlaq_n_f32( r, c1, src[i].y );
+		r = vmlaq_n_f32( r, c2, src[i].z );
+		dst[i].set( vgetq_lane_f32( r, 0 ), vgetq_lane_f32( r, 1 ), vgetq_lane_f32( r, 2 ) );
+	}
+}
+
+//! Transforms \a count direction vectors by the upper 3x3 of \a mat. Same as Matrix44f::transformVec() on each.
+inline void NeonTransformVecs( const Matrix44f &mat, const Vec3f *src, Vec3f *dst, size_t count )
+{
+	const float32x4_t c0 = vld1q_f32( mat.m +  0 );
+	const float32x4_t c1 = vld1q_f32( mat.m +  4 );
+	const float32x4_t c2 = vld1q_f32( mat.m +  8 );
+
+	for( size_t i = 0; i < count; ++i ) {
+		float32x4_t r = vmulq_n_f32( c0, src[i].x );
+		r = vmlaq_n_f32( r, c1, src[i].y );
+		r = vmlaq_n_f32( r, c2, src[i].z );
+		dst[i].set( vgetq_lane_f32( r, 0 ), vgetq_lane_f32( r, 1 ), vgetq_lane_f32( r, 2 ) );
+	}
+}
+
+//! Post-multiplies \a count column vectors by \a mat. Same as Matrix44f::operator*( const Vec4f& ) on each.
+inline void NeonPostMultiply( const Matrix44f &mat, const Vec4f *src, Vec4f *dst, size_t count )
+{
+	const float32x4_t c0 = vld1q_f32( mat.m +  0 );
+	const float32x4_t c1 = vld1q_f32( mat.m +  4 );
+	const float32x4_t c2 = vld1q_f32( mat.m +  8 );
+	const float32x4_t c3 = vld1q_f32( mat.m + 12 );
+
+	for( size_t i = 0; i < count; ++i ) {
+		float32x4_t r = vmulq_n_f32( c0, src[i].x );
+		r = vmlaq_n_f32( r, c1, src[i].y );
+		r = vmlaq_n_f32( r, c2, src[i].z );
+		r = vmlaq_n_f32( r, c3, src[i].w );
+		vst1q_f32( &dst[i].x, r );
+	}
+}
+
+#endif // defined( CINDER_NEON )
 
 } // namespace cinder
@@ -77,6 +77,8 @@ class Path2d {
 	void	getSegmentRelativeT( float t, size_t *segment, float *relativeT ) const;
 	
 	std::vector<Vec2f>	subdivide( float approximationScale = 1.0f ) const;
+	//! Stores the subdivision of the path into \a result, replacing its contents but reusing its capacity. Consider a Path2dSubdivisionCache if the path rarely changes.
+	void				subdivide( std::vector<Vec2f> *result, float approximationScale = 1.0f ) const;
 	
 	//! Scales the Path2d by \a amount.x on X and \a amount.y on Y around the center \a scaleCenter
 	void		scale( const Vec2f &amount, Vec2f scaleCenter = Vec2f::zero() );
@@ -196,6 +198,27 @@ class Path2dCalcCache {
 	std::vector<float>	mSegmentLengths;
 };
 
+//! Caches the subdivision of a Path2d, recalculating it only when the approximation scale or the path changes. Holds its own copy of the path, which is only modified through setPath2d().
+class Path2dSubdivisionCache {
+  public:
+	explicit Path2dSubdivisionCache( const Path2d &path )
+		: mPath( path ), mApproximationScale( 0 ), mDirty( true )
+	{}
+
+	const Path2d&	getPath2d() const { return mPath; }
+	//! Replaces the cached path with a copy of \a path, reusing the storage of the previous one
+	void			setPath2d( const Path2d &path ) { mPath = path; mDirty = true; }
+
+	//! Returns the subdivision of the path at \a approximationScale, reusing the previous result if neither the path nor the scale have changed.
+	const std::vector<Vec2f>&	getSubdivision( float approximationScale = 1.0f );
+
+  private:
+	Path2d				mPath;
+	std::vector<Vec2f>	mSubdivision;
+	float				mApproximationScale;
+	bool				mDirty;
+};
+
 class Path2dExc : public Exception {
 };
 
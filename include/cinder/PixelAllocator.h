@@ -0,0 +1,112 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+
+#include <map>
+#include <vector>
+#include <mutex>
+
+namespace cinder {
+
+typedef std::shared_ptr<class PixelAllocator>		PixelAllocatorRef;
+typedef std::shared_ptr<class PixelAllocatorPool>	PixelAllocatorPoolRef;
+
+//! Allocates the pixel memory owned by SurfaceT and ChannelT. Implementations return memory aligned to ALIGNMENT bytes and must be thread-safe.
+class PixelAllocator {
+  public:
+	virtual ~PixelAllocator() {}
+
+	//! Alignment in bytes of every allocation, and of rows padded by alignRowBytes()
+	enum { ALIGNMENT = 64 };
+
+	//! Returns at least \a numBytes of memory aligned to ALIGNMENT. The size is rounded up to a multiple of ALIGNMENT so SIMD loops may safely process the tail of the last row.
+	virtual void*	allocate( size_t numBytes ) = 0;
+	//! Releases \a data which was returned by allocate( \a numBytes )
+	virtual void	deallocate( void *data, size_t numBytes ) = 0;
+
+	//! Returns \a numBytes rounded up to a multiple of ALIGNMENT
+	static size_t	alignSize( size_t numBytes ) { return ( numBytes + ALIGNMENT - 1 ) & ~size_t( ALIGNMENT - 1 ); }
+	//! Returns \a rowBytes rounded up to a multiple of ALIGNMENT, so that every row of a Surface begins on an aligned address
+	static int32_t	alignRowBytes( int32_t rowBytes ) { return (int32_t)alignSize( rowBytes ); }
+
+	//! Returns the allocator used by Surfaces and Channels whose constraints don't specify one. Defaults to a PixelAllocatorAligned.
+	static PixelAllocatorRef	getDefault();
+	//! Sets the allocator used for Surfaces and Channels created after this call. Passing \c nullptr restores the default.
+	static void					setDefault( const PixelAllocatorRef &allocator );
+};
+
+//! Allocates directly from the heap with ALIGNMENT-byte alignment
+class PixelAllocatorAligned : public PixelAllocator {
+  public:
+	static PixelAllocatorRef	create() { return PixelAllocatorRef( new PixelAllocatorAligned ); }
+
+	virtual void*	allocate( size_t numBytes ) override;
+	virtual void	deallocate( void *data, size_t numBytes ) override;
+};
+
+/** Recycles released allocations in buckets by size, suited to video and camera pipelines which allocate same-sized frames repeatedly.
+	At most \a maxPooledBytes of released memory is retained; releases beyond that are returned to the heap. **/
+class PixelAllocatorPool : public PixelAllocator {
+  public:
+	static PixelAllocatorPoolRef	create( size_t maxPooledBytes = 256 * 1024 * 1024 ) { return PixelAllocatorPoolRef( new PixelAllocatorPool( maxPooledBytes ) ); }
+	~PixelAllocatorPool();
+
+	virtual void*	allocate( size_t numBytes ) override;
+	virtual void	deallocate( void *data, size_t numBytes ) override;
+
+	//! Returns all retained memory to the heap
+	void	purge();
+
+	//! Returns the maximum number of bytes retained while not in use
+	size_t	getMaxPooledBytes() const { return mMaxPooledBytes; }
+	//! Sets the maximum number of bytes retained while not in use, releasing any excess
+	void	setMaxPooledBytes( size_t maxPooledBytes );
+
+	//! Returns the number of calls to allocate()
+	size_t	getNumAllocations() const;
+	//! Returns the number of calls to allocate() satisfied from the pool
+	size_t	getNumHits() const;
+	//! Returns the fraction of calls to allocate() satisfied from the pool, or \c 0 if there have been none
+	float	getHitRate() const;
+	//! Returns the number of bytes currently held from the heap, both in use and retained by the pool
+	size_t	getResidentBytes() const;
+	//! Returns the number of bytes retained by the pool and not in use
+	size_t	getPooledBytes() const;
+	//! Resets the allocation and hit counts
+	void	resetStats();
+
+  protected:
+	PixelAllocatorPool( size_t maxPooledBytes );
+
+	void	trim( size_t maxPooledBytes );
+
+	mutable std::mutex					mMutex;
+	std::map<size_t,std::vector<void*> >	mBuckets;
+	size_t								mMaxPooledBytes, mPooledBytes, mResidentBytes;
+	size_t								mNumAllocations, mNumHits;
+};
+
+} // namespace cinder
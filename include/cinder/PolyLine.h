@@ -68,6 +68,8 @@ class PolyLine {
 	static std::vector<PolyLine> 	calcXor( const std::vector<PolyLine> &a, std::vector<PolyLine> &b );
 	//! Calculates the boolean difference of \a a and \a b. Assumes the first PolyLine in the vector is the outermost and the (optional) others are holes.
 	static std::vector<PolyLine> 	calcDifference( const std::vector<PolyLine> &a, std::vector<PolyLine> &b );		
+	//! Calculates \a a inflated (positive \a distance) or deflated (negative \a distance) by \a distance, using mitered corners. Assumes the first PolyLine in the vector is the outermost and the (optional) others are holes.
+	static std::vector<PolyLine> 	calcOffset( const std::vector<PolyLine> &a, typename T::TYPE distance );
 	
   private:
 	std::vector<T>			mPoints;
@@ -0,0 +1,75 @@
+/*
+ Copyright (c) 2014, The Cinder Project: http://libcinder.org
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/PolyLine.h"
+
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace cinder {
+
+//! Computes boolean operations and offsets of polygons made of one or more closed PolyLine contours. Coordinates are snapped to a fixed-point integer grid spanning the input's bounds and swept with a Vatti-style scanbeam algorithm. Scratch memory is retained between calls, so reusing a single PolygonClipper avoids reallocation. Not thread-safe.
+class PolygonClipper : private boost::noncopyable {
+  public:
+	typedef enum Operation { UNION, INTERSECTION, XOR, DIFFERENCE } Operation;
+	//! Determines which regions are inside a polygon from the winding number of its contours
+	typedef enum FillRule { FILL_EVEN_ODD, FILL_NONZERO, FILL_POSITIVE, FILL_NEGATIVE } FillRule;
+	//! Determines how convex corners are extended by calcOffset()
+	typedef enum JoinType { JOIN_MITER, JOIN_SQUARE, JOIN_ROUND } JoinType;
+
+	PolygonClipper();
+	~PolygonClipper();
+
+	//! Removes all subject and clip contours, retaining scratch memory for reuse
+	void	clear();
+
+	//! Adds a closed contour to the subject polygon
+	template<typename T>
+	void	addSubject( const PolyLine<T> &contour );
+	//! Adds closed contours to the subject polygon
+	template<typename T>
+	void	addSubject( const std::vector<PolyLine<T> > &contours );
+	//! Adds a closed contour to the clip polygon
+	template<typename T>
+	void	addClip( const PolyLine<T> &contour );
+	//! Adds closed contours to the clip polygon
+	template<typename T>
+	void	addClip( const std::vector<PolyLine<T> > &contours );
+
+	//! Calculates \a op applied to the subject and clip polygons, replacing the contents of \a result. Each outer contour (counter-clockwise with y pointing up) is followed by its holes (clockwise). Contours are closed by repeating their first point.
+	template<typename T>
+	void	calcBoolean( Operation op, std::vector<PolyLine<T> > *result, FillRule fillRule = FILL_EVEN_ODD );
+	//! Inflates (positive \a delta) or deflates (negative \a delta) the subject polygon, replacing the contents of \a result. \a miterLimit is a multiple of \a delta beyond which JOIN_MITER corners are squared off, and \a arcTolerance is the maximum deviation of JOIN_ROUND arcs from a true circle. The clip polygon is ignored.
+	template<typename T>
+	void	calcOffset( double delta, std::vector<PolyLine<T> > *result, JoinType joinType = JOIN_MITER, double miterLimit = 2.0, double arcTolerance = 0.25, FillRule fillRule = FILL_EVEN_ODD );
+
+  private:
+	class Impl;
+
+	std::unique_ptr<Impl>	mImpl;
+};
+
+} // namespace cinder
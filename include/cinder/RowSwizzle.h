@@ -0,0 +1,61 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+
+namespace cinder {
+
+/** Converts rows of interleaved pixels between channel orders and data types (uint8_t, uint16_t and float). The kernel is chosen once by create(): a straight memcpy when the layouts
+	and types match, SIMD kernels for 8-bit reordering, RGB <-> RGBA expansion and contraction and 8-bit <-> float conversion, and a scalar loop otherwise. **/
+class RowSwizzle {
+  public:
+	//! Constructs a RowSwizzle which does nothing
+	RowSwizzle();
+
+	/** Returns a RowSwizzle from pixels of type \a SD which are \a srcInc elements apart with red, green, blue and alpha at \a srcOffsets, to pixels of type \a TD described by \a dstInc and \a dstOffsets.
+		An offset of -1 marks an absent channel; a grayscale layout uses only the first and last offsets. Target channels absent from the source are left untouched, except alpha which is set to its maximum when \a fillAlpha is \c true. **/
+	template<typename SD, typename TD>
+	static RowSwizzle	create( const int8_t srcOffsets[4], int8_t srcInc, const int8_t dstOffsets[4], int8_t dstInc, bool fillAlpha = false );
+
+	//! Converts \a numPixels pixels from \a src to \a dst, which must not overlap
+	void	operator()( const void *src, void *dst, int32_t numPixels ) const	{ (*mFn)( *this, src, dst, numPixels ); }
+
+	//! Returns whether rows are copied with a straight memcpy
+	bool	isCopy() const;
+
+  private:
+	typedef void (*Fn)( const RowSwizzle &swizzle, const void *src, void *dst, int32_t numPixels );
+
+	Fn			mFn;
+	int8_t		mNumPairs; // number of channels copied from the source
+	int8_t		mSrcOffsets[4], mDstOffsets[4]; // source and target offsets of each copied channel
+	int8_t		mSrcInc, mDstInc;
+	int8_t		mFillOffset; // target offset of an alpha channel set to its maximum, or -1
+	size_t		mCopyBytes; // bytes per pixel when mFn is a memcpy
+
+	friend struct RowSwizzleKernels;
+};
+
+} // namespace cinder
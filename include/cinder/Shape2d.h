@@ -79,6 +79,9 @@ class Shape2d {
 	//! Returns whether the point \a pt is contained within the boundaries of the shape
 	bool	contains( const Vec2f &pt ) const;
 
+	//! Stores the subdivision of each contour into the corresponding element of \a result, reusing existing storage. Shapes with many contours are subdivided in parallel.
+	void	subdivide( std::vector<std::vector<Vec2f> > *result, float approximationScale = 1.0f ) const;
+
 	//! Iterates all of the contours and points of a Shape2d.
 	/** Expects a template parameter that implements
 		\code bool operator()( Path2d::SegmentType type, Vec2f *points, Vec2f *previousPoint ) \endcode.
@@ -30,6 +30,7 @@
 #include "cinder/Cinder.h"
 #include "cinder/Area.h"
 #include "cinder/Channel.h"
+#include "cinder/PixelAllocator.h"
 #include "cinder/ChanTraits.h"
 #include "cinder/Color.h"
 #include "cinder/Filesystem.h"
@@ -79,13 +80,22 @@ class SurfaceConstraints {
  
 	virtual SurfaceChannelOrder getChannelOrder( bool alpha ) const { return ( alpha ) ? SurfaceChannelOrder::RGBA : SurfaceChannelOrder::RGB; }
 	virtual int32_t				getRowBytes( int requestedWidth, const SurfaceChannelOrder &sco, int elementSize ) const { return requestedWidth * elementSize * sco.getPixelInc(); }
+	//! Returns the allocator for the Surface's pixel data
+	virtual PixelAllocatorRef	getAllocator() const { return PixelAllocator::getDefault(); }
 };
 
 class SurfaceConstraintsDefault : public SurfaceConstraints {
 };
 
+//! Pads each row to a multiple of PixelAllocator::ALIGNMENT bytes so that every row begins on an aligned address, for SIMD processing
+class SurfaceConstraintsAligned : public SurfaceConstraints {
+ public:
+	virtual int32_t				getRowBytes( int requestedWidth, const SurfaceChannelOrder &sco, int elementSize ) const { return PixelAllocator::alignRowBytes( requestedWidth * elementSize * sco.getPixelInc() ); }
+};
+
 typedef std::shared_ptr<class ImageSource> ImageSourceRef;
 typedef std::shared_ptr<class ImageTarget> ImageTargetRef;
+class RowSwizzle;
 
 template<typename T>
 //! An in-memory representation of an image. \ImplShared
@@ -94,6 +104,8 @@ class SurfaceT {
 	/// \cond
 	struct Obj {
 		Obj( int32_t aWidth, int32_t aHeight, SurfaceChannelOrder aChannelOrder, T *aData, bool aOwnsData, int32_t aRowBytes );
+		//! Allocates and owns \a aHeight rows of \a aRowBytes from \a aAllocator
+		Obj( int32_t aWidth, int32_t aHeight, SurfaceChannelOrder aChannelOrder, int32_t aRowBytes, const PixelAllocatorRef &aAllocator );
 		~Obj();
 		
 		void		initChannels();
@@ -104,6 +116,8 @@ class SurfaceT {
 		bool						mIsPremultiplied;
 		T							*mData;
 		bool						mOwnsData;
+		PixelAllocatorRef			mAllocator;
+		size_t						mAllocatedBytes;
 		SurfaceChannelOrder			mChannelOrder;
 		ChannelT<T>					mChannels[4];
 		
@@ -249,6 +263,7 @@ class SurfaceT {
 	void init( ImageSourceRef imageSource, const SurfaceConstraints &constraints = SurfaceConstraintsDefault(), boost::tribool alpha = boost::logic::indeterminate );
 
 	void	copyRawSameChannelOrder( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &absoluteOffset );
+	void	copyRawSwizzled( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &absoluteOffset, const RowSwizzle &swizzle );
 	void	copyRawRgba( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &absoluteOffset );
 	void 	copyRawRgbFullAlpha( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &absoluteOffset );
 	void	copyRawRgb( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &absoluteOffset );
@@ -67,6 +67,10 @@
 	}
 #endif
 
+#include <algorithm>
+#include <exception>
+#include <vector>
+
 namespace cinder {
 //! Create an instance of this class at the beginning of any multithreaded code that makes use of Cinder functionality
 class ThreadSetup {
@@ -86,4 +90,61 @@ class ThreadSetup {
 #endif
 };
 
+//! Splits [\a begin, \a end) into contiguous chunks of at least \a minChunkSize and calls \a fn( chunkBegin, chunkEnd ) for each, using up to std::thread::hardware_concurrency() threads including the calling one. Blocks until all chunks are complete, rethrowing the first exception thrown by \a fn. Small ranges run entirely on the calling thread.
+template<typename FN>
+void parallelFor( size_t begin, size_t end, size_t minChunkSize, const FN &fn )
+{
+	if( end <= begin )
+		return;
+
+	size_t numChunks = ( end - begin ) / std::max<size_t>( minChunkSize, 1 );
+	numChunks = std::min<size_t>( numChunks, std::max<unsigned>( std::thread::hardware_concurrency(), 1 ) );
+	if( numChunks <= 1 ) {
+		fn( begin, end );
+		return;
+	}
+
+	const size_t chunkSize = ( end - begin + numChunks - 1 ) / numChunks;
+	std::mutex exceptionMutex;
+	std::exception_ptr exception;
+	auto runChunk = [&]( size_t chunkBegin, size_t chunkEnd ) {
+		try {
+			fn( chunkBegin, chunkEnd );
+		}
+		catch( ... ) {
+			std::lock_guard<std::mutex> lock( exceptionMutex );
+			if( ! exception )
+				exception = std::current_exception();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve( numChunks - 1 );
+	try {
+		for( size_t chunk = 1; chunk < numChunks; ++chunk ) {
+			size_t chunkBegin = begin + chunk * chunkSize;
+			size_t chunkEnd = std::min( chunkBegin + chunkSize, end );
+			if( chunkBegin >= chunkEnd )
+				break;
+			threads.push_back( std::thread( [&runChunk, chunkBegin, chunkEnd] {
+				ThreadSetup threadSetup;
+				runChunk( chunkBegin, chunkEnd );
+			} ) );
+		}
+	}
+	catch( ... ) {
+		// std::thread's constructor threw; destroying the joinable threads already started would call std::terminate()
+		for( size_t t = 0; t < threads.size(); ++t )
+			threads[t].join();
+		throw;
+	}
+	runChunk( begin, std::min( begin + chunkSize, end ) );
+
+	for( size_t t = 0; t < threads.size(); ++t )
+		threads[t].join();
+
+	if( exception )
+		std::rethrow_exception( exception );
+}
+
 } // namespace cinder
\ No newline at end of file
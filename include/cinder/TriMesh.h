@@ -26,6 +26,7 @@
 #pragma once
 
 #include <vector>
+#include <cfloat>
 #include "cinder/Vector.h"
 #include "cinder/AxisAlignedBox.h"
 #include "cinder/DataSource.h"
@@ -270,6 +271,43 @@ class TriMesh : public geom::Source {
 		Optionally, vertices are normalized if \a normalize is TRUE. */
 	void		subdivide( int division = 2, bool normalize = false );
 
+	//! Describes how well the index order of a TriMesh reuses a FIFO post-transform vertex cache
+	struct VertexCacheStats {
+		//! Average cache miss ratio: vertex shader invocations per triangle. Ranges from 0.5 for an ideal grid to 3.
+		float		mAcmr;
+		//! Average transformed vertex ratio: vertex shader invocations per referenced vertex. 1 is ideal.
+		float		mAtvr;
+		//! Total number of simulated cache misses
+		size_t		mNumCacheMisses;
+	};
+
+	//! Simulates a FIFO vertex cache of \a cacheSize entries over the indices and returns the resulting ACMR and ATVR.
+	VertexCacheStats	calcVertexCacheStats( size_t cacheSize = 32 ) const;
+	/*! Reorders the triangles to maximize post-transform vertex cache reuse, using Tom Forsyth's linear-speed
+		algorithm tuned for a cache of \a cacheSize entries. Vertices are left untouched. */
+	void		optimizeVertexCache( size_t cacheSize = 32 );
+	/*! Reorders all vertex attributes into the order in which the indices first reference them, which improves
+		vertex fetch locality. Vertices that no triangle references are removed. */
+	void		optimizeVertexFetch();
+	//! Merges vertices whose attributes are all bitwise identical and removes the duplicates. Returns the number of vertices removed.
+	size_t		weldVertices();
+	//! Convenience which runs weldVertices() if \a weld is \c true, followed by optimizeVertexCache() and optimizeVertexFetch().
+	void		optimize( bool weld = true );
+
+	/*! Returns indices of a simplified version of the mesh with at most \a targetNumTriangles triangles, produced by quadric error metric
+		edge collapses. Vertices are neither moved nor created, so the result indexes this TriMesh's vertex data directly. Open borders
+		and attribute seams (vertices sharing a position but differing in normal, texture coordinate or color) are preserved. Collapses
+		whose error exceeds \a maxError, in position units, are rejected. The largest error introduced is written to \a resultError if it's non-null. */
+	std::vector<uint32_t>	simplify( size_t targetNumTriangles, float maxError = FLT_MAX, float *resultError = nullptr ) const;
+	/*! Much faster but coarser alternative to simplify() which clusters vertices on a uniform grid sized to yield at most \a targetNumTriangles
+		triangles. Runs in parallel, and does not preserve attribute seams. */
+	std::vector<uint32_t>	simplifyClustered( size_t targetNumTriangles, float *resultError = nullptr ) const;
+	/*! Returns a chain of up to \a numLevels index buffers which all reference this TriMesh's vertices. Level 0 is the current indices and each
+		following level has \a reduction times the triangles of its predecessor; the chain ends early once a level can't be simplified further.
+		If \a fast is \c true, the first level is produced by simplifyClustered() instead, which makes it practical to build LODs for
+		meshes of millions of triangles at load time. If non-null, \a resultErrors receives an upper bound of each level's error. */
+	std::vector<std::vector<uint32_t>>	calcLodChain( size_t numLevels, float reduction = 0.5f, bool fast = false, std::vector<float> *resultErrors = nullptr ) const;
+
 
 	//! Create TriMesh from vectors of vertex data.
 /*	static TriMesh		create( std::vector<uint32_t> &indices, const std::vector<ColorAf> &colors,
@@ -287,6 +325,8 @@ class TriMesh : public geom::Source {
 
 	//! Returns whether or not the vertex, color etc. at both indices is the same.
 	bool		isEqual( uint32_t indexA, uint32_t indexB ) const;
+	//! Moves vertex \c i to \c remap[i] in every attribute array, dropping vertices mapped to \c 0xFFFFFFFF, and resizes to \a numVertices.
+	void		remapVertices( const std::vector<uint32_t> &remap, size_t numVertices );
 
 	uint8_t		mPositionsDims, mNormalsDims, mTangentsDims, mBitangentsDims, mColorsDims;
 	uint8_t		mTexCoords0Dims, mTexCoords1Dims, mTexCoords2Dims, mTexCoords3Dims;
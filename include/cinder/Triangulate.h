@@ -28,6 +28,8 @@
 #include "cinder/Shape2d.h"
 #include "cinder/Path2d.h"
 
+#include <vector>
+
 struct TESStesselator;
 
 namespace cinder {
@@ -52,18 +54,37 @@ class Triangulator {
 	void		addPath( const Path2d &path, float approximationScale = 1.0f );
 	//! Adds a PolyLine2f to the tesselation.
 	void		addPolyLine( const PolyLine2f &polyLine );
+	//! Adds a contour of \a numPoints points to the tesselation.
+	void		addContour( const Vec2f *points, size_t numPoints );
+
+	//! Discards any contours added since the last tesselation. The tesselator's memory is retained and reused.
+	void		reset();
 
 	//! Performs the tesselation, returning a TriMesh2d
 	TriMesh		calcMesh( Winding winding = WINDING_ODD );
-	
+	//! Performs the tesselation, replacing the contents of \a result while reusing its storage. \a result must have 2D positions.
+	void		calcMesh( TriMesh *result, Winding winding = WINDING_ODD );
+	//! Performs the tesselation, appending to \a positions and \a indices. Appended indices are offset by the initial size of \a positions. Returns the number of triangles appended.
+	size_t		calcMesh( std::vector<Vec2f> *positions, std::vector<uint32_t> *indices, Winding winding = WINDING_ODD );
+
+	//! Triangulates each of \a shapes independently into the corresponding element of \a result, which is resized to match. Work is spread across threads, each reusing a single tesselator.
+	static void	calcMeshes( const std::vector<Shape2d> &shapes, std::vector<TriMesh> *result, float approximationScale = 1.0f, Winding winding = WINDING_ODD );
+
+	//! Returns the number of bytes the tesselator has requested from the system allocator
+	size_t		getNumBytesAllocated() const;
+
 	class Exception : public cinder::Exception {
 	};
 	
   protected:	
+	class MemoryPool;
+
 	void			allocate();
+	bool			tesselate( Winding winding );
 	
-	int									mAllocated;
+	std::shared_ptr<MemoryPool>			mPool;
 	std::shared_ptr<TESStesselator>		mTess;
+	std::vector<Vec2f>					mSubdivided;
 };
 
 } // namespace cinder
\ No newline at end of file
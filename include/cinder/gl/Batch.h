@@ -95,9 +95,9 @@ class Batch {
 //! Cannot be shared across contexts
 class VertBatch {
   public:
-	//! If \a useContextDefaultBuffers is \c true, uses default buffers for the context, saving allocations; suitable for single draw.
+	//! If \a useContextDefaultBuffers is \c true, streams each draw through the context's streaming vertex buffer and default VAO, saving allocations; suitable for single draw.
 	VertBatch( GLenum primType = GL_POINTS, bool useContextDefaultBuffers = true );
-	//! If \a useContextDefaultBuffers is \c false, allocates and uses internal buffers and VAO; suitable for multiple draws.
+	//! If \a useContextDefaultBuffers is \c false, uploads once to an internal buffer and VAO; suitable for multiple draws.
 	static VertBatchRef create( GLenum primType = GL_POINTS, bool useContextDefaultBuffers = false );
 
 	void	setType( GLenum type );
@@ -132,7 +132,12 @@ class VertBatch {
 	
   protected:
 	void	addVertex( const Vec4f &v );
-	void	setupBuffers();
+	//! Returns the size in bytes of an interleaved vertex: position, then normal, color and texCoord when present
+	size_t	getStride() const;
+	//! Writes the vertices interleaved into \a dest, which must hold getStride() * mVertices.size() bytes
+	void	writeInterleaved( uint8_t *dest ) const;
+	//! Points \a glslProg's attributes at the interleaved vertices at \a offset in \a vbo. Expects the target VAO to be bound.
+	void	setupAttribs( Context *ctx, const GlslProgRef &glslProg, const VboRef &vbo, size_t offset ) const;
 
 	GLenum					mPrimType;
 
@@ -145,6 +150,7 @@ class VertBatch {
 	bool					mOwnsBuffers;
 	VaoRef					mVao;
 	VboRef					mVbo;
+	GlslProgRef				mVaoGlslProg; // the GlslProg whose attributes mVao was set up for
 };
 
 } } // namespace cinder::gl
\ No newline at end of file
@@ -46,6 +46,8 @@ class BufferObj {
 #if ! defined( CINDER_GL_ES )
 	//! Returns some or all of the data from the buffer object currently bound for this objects \a target.
 	void		getBufferSubData( GLintptr offset, GLsizeiptr size, GLvoid *data );
+	//! Analogous to glBufferStorage(), allocating immutable storage which may remain mapped while in use (\c GL_MAP_PERSISTENT_BIT). Requires OpenGL 4.4 or \c GL_ARB_buffer_storage.
+	void		bufferStorage( GLsizeiptr size, const GLvoid *data, GLbitfield flags );
 #endif // ! defined( CINDER_GL_ES )
 	//! Calls bufferSubData when the size is adequate, otherwise calls bufferData, forcing a reallocation of the data store
 	void		copyData( GLsizeiptr size, const GLvoid *data );
@@ -31,6 +31,10 @@
 
 #include <vector>
 #include <map>
+#include <iosfwd>
+#if ! defined( CINDER_GL_ES )
+	#include <thread>
+#endif
 
 namespace cinder { namespace gl {
 
@@ -45,6 +49,8 @@ typedef std::shared_ptr<BufferObj>		BufferObjRef;
 #if ! defined( CINDER_GL_ES )
 class TransformFeedbackObj;
 typedef std::shared_ptr<TransformFeedbackObj>	TransformFeedbackObjRef;
+class Sync;
+typedef std::shared_ptr<Sync>			SyncRef;
 #endif
 class Texture;
 typedef std::shared_ptr<Texture>		TextureRef;
@@ -55,6 +61,30 @@ typedef std::shared_ptr<Fbo>			FboRef;
 class VertBatch;
 typedef std::shared_ptr<VertBatch>		VertBatchRef;
 
+//! Tallies of the state changes requested of a Context. A request is redundant when it matched the Context's cached state, so no GL call was made.
+struct ContextStats {
+	enum State { BUFFER_BINDING, TEXTURE_BINDING, ACTIVE_TEXTURE, GLSL_PROG, VAO, FRAMEBUFFER, BOOL_STATE, BLEND_FUNC, VIEWPORT, SCISSOR, NUM_STATES };
+
+	ContextStats() { reset(); }
+
+	void		reset();
+	//! Records a request to change \a state, returning \a issued so it can wrap the cache test
+	bool		count( State state, bool issued ) { if( issued ) ++mNumIssued[state]; else ++mNumRedundant[state]; return issued; }
+
+	uint32_t	getNumIssued( State state ) const { return mNumIssued[state]; }
+	uint32_t	getNumRedundant( State state ) const { return mNumRedundant[state]; }
+	uint32_t	getTotalIssued() const;
+	uint32_t	getTotalRedundant() const;
+	uint32_t	getNumDrawCalls() const { return mNumDrawCalls; }
+
+	static const char*	stateToString( State state );
+
+	uint32_t	mNumIssued[NUM_STATES], mNumRedundant[NUM_STATES];
+	uint32_t	mNumDrawCalls;
+};
+
+std::ostream& operator<<( std::ostream &os, const ContextStats &stats );
+
 class Context {
   public:
 	struct PlatformData {
@@ -331,6 +361,17 @@ class Context {
 	void			setCurrentColor( const ColorAf &color ) { mColor = color; }
 	GlslProgRef		getStockShader( const ShaderDef &shaderDef );
 	void			setDefaultShaderVars();
+	//! Builds the stock shaders returned by getCommonStockShaderDefs() so that first use doesn't stall on compilation. Loads from the program binary cache when GlslProg::setBinaryCacheDirectory() has been called.
+	void			preloadStockShaders();
+	//! Returns the ShaderDefs for the stock shaders used by the convenience drawing functions
+	static std::vector<ShaderDef>	getCommonStockShaderDefs();
+#if ! defined( CINDER_GL_ES )
+	/** Compiles getCommonStockShaderDefs() on a background thread using a Context shared with this one, writing the results to the program binary cache.
+		Subsequent calls to preloadStockShaders() or getStockShader() load the binaries rather than recompiling. Requires GlslProg::setBinaryCacheDirectory(). The caller should join() or detach() the returned thread. **/
+	std::thread		warmStockShaderCacheAsync();
+	//! Returns whether this Context can save and load program binaries. The driver is queried on first use and the answer cached.
+	bool			isProgramBinarySupported();
+#endif
 
 	//! Returns default VBO for vertex array data, ensuring it is at least \a requiredSize bytes. Designed for use with convenience functions.
 	VboRef			getDefaultArrayVbo( size_t requiredSize = 0 );
@@ -343,6 +384,22 @@ class Context {
 	//! Returns a VBO for drawing textured rectangles; used by gl::draw(TextureRef)
 	VaoRef			getDrawTextureVao();
 
+	//! Copies \a sizeBytes of \a data into the next free region of the context's streaming vertex buffer and returns its byte offset within getStreamArrayVbo(). Designed for geometry which is drawn once, such as VertBatch and the convenience functions. The draws sourcing a region must be issued before the next region is reserved.
+	size_t			streamArrayData( const void *data, size_t sizeBytes );
+	//! Reserves the next \a sizeBytes of the streaming vertex buffer and returns a pointer for writing them directly. Must be followed by streamArrayEnd() before drawing. Sets \a resultOffset to the region's byte offset within getStreamArrayVbo().
+	void*			streamArrayBegin( size_t sizeBytes, size_t *resultOffset );
+	//! Completes the region reserved by streamArrayBegin()
+	void			streamArrayEnd();
+	//! Returns the VBO written by streamArrayData(). It is replaced when a region exceeds its capacity, so retrieve it after streaming.
+	const VboRef&	getStreamArrayVbo() const { return mStreamArrayVbo; }
+
+	//! Returns the state change tallies of the frame in progress. Counting requires no GPU cooperation, so it can guard against state cache regressions.
+	const ContextStats&	getStats() const { return mStats; }
+	//! Returns the state change tallies of the most recently completed frame
+	const ContextStats&	getFrameStats() const { return mFrameStats; }
+	//! Completes the frame's tallies, making them available from getFrameStats(). Called by RendererGl after each frame.
+	void				endFrameStats() { mFrameStats = mStats; mStats.reset(); }
+
 	//! Returns a reference to the immediate mode emulation structure. Generally use gl::begin() and friends instead.
 	VertBatch&		immediate() { return *mImmediateMode; }
 
@@ -399,10 +456,31 @@ class Context {
 	VaoRef						mDrawTextureVao;
 	VboRef						mDrawTextureVbo;
 
+	VboRef						mStreamArrayVbo;
+	size_t						mStreamArrayOffset; // next free byte of mStreamArrayVbo
+	size_t						mStreamArrayReservedOffset, mStreamArrayReservedSize;
+	uint8_t						*mStreamArrayMapped; // persistently mapped storage, or NULL when orphaning
+	std::vector<uint8_t>		mStreamArrayStaging; // written via streamArrayBegin() when not mapped
+#if ! defined( CINDER_GL_ES )
+	SyncRef						mStreamArrayFences[4];
+	int							mStreamArraySegment;
+	int							mProgramBinarySupported; // -1 until queried
+#endif
+
   private:
 	Context( const std::shared_ptr<PlatformData> &platformData );
   
 	void	allocateDrawTextureVboAndVao();
+	// (re)creates the streaming vertex buffer so that each of its segments holds at least \a minSegmentSize bytes
+	void	allocateStreamArrayVbo( size_t minSegmentSize );
+	// returns the offset of \a sizeBytes in the streaming vertex buffer which are safe to overwrite
+	size_t	streamArrayReserve( size_t sizeBytes );
+#if ! defined( CINDER_GL_ES )
+	// fences the current segment of the persistently mapped streaming buffer, then waits for the GPU to release \a segment
+	void	enterStreamArraySegment( int segment );
+#endif
+	// uploads uniforms deferred on the bound GlslProg ahead of a draw call
+	void	flushGlslProgUniforms();
 
 	std::shared_ptr<PlatformData>	mPlatformData;
 	
@@ -429,6 +507,9 @@ class Context {
 	std::set<const Vao*>			mLiveVaos;
 	std::set<const Fbo*>			mLiveFbos;
 
+	// Stats
+	ContextStats					mStats, mFrameStats;
+
 	friend class				Environment;
 	friend class				EnvironmentEs2Profile;
 	friend class				EnvironmentCoreProfile;
@@ -0,0 +1,130 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Batch.h"
+
+#include <string>
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class DrawQueue>	DrawQueueRef;
+
+/** Records Batch draws along with their model matrices, uniforms and textures, and submits them sorted by GlslProg, VAO and texture
+	to minimize state changes. Draws of the same Batch with identical uniforms and textures are merged into a single instanced draw
+	when its GlslProg declares a \c mat4 attribute named by getInstanceMatrixAttrib() (\c ciInstanceMatrix by default). In that case
+	the model matrices are supplied through that attribute and the model matrix is identity. Because draws are reordered, the queue
+	is intended for opaque geometry. Draws of a GlslProg are only reordered among themselves when they all set the same uniforms,
+	so that each sees the uniforms it would have in recorded order. **/
+class DrawQueue : public boost::noncopyable {
+  public:
+	//! A recorded draw, returned by DrawQueue::draw() for attaching uniforms and textures. Only valid until the next call to draw().
+	class Draw {
+	  public:
+		Draw&	uniform( const std::string &name, int data );
+		Draw&	uniform( const std::string &name, float data );
+		Draw&	uniform( const std::string &name, const Vec2f &data );
+		Draw&	uniform( const std::string &name, const Vec3f &data );
+		Draw&	uniform( const std::string &name, const Vec4f &data );
+		Draw&	uniform( const std::string &name, const Color &data );
+		Draw&	uniform( const std::string &name, const ColorA &data );
+		Draw&	uniform( const std::string &name, const Matrix33f &data );
+		Draw&	uniform( const std::string &name, const Matrix44f &data );
+		//! Binds \a texture to \a textureUnit for this draw
+		Draw&	texture( const TextureRef &texture, uint8_t textureUnit = 0 );
+
+	  protected:
+		Draw( DrawQueue *queue, const BatchRef &batch, const Matrix44f &modelMatrix );
+
+		Draw&	addUniform( const std::string &name, GLenum type, const void *data, size_t sizeBytes );
+
+		DrawQueue		*mQueue;
+		BatchRef		mBatch;
+		Matrix44f		mModelMatrix;
+		uint32_t		mFirstUniform, mNumUniforms;
+		uint32_t		mFirstTexture, mNumTextures;
+
+		friend class DrawQueue;
+	};
+
+	DrawQueue();
+	static DrawQueueRef		create() { return DrawQueueRef( new DrawQueue ); }
+
+	//! Records a draw of \a batch with the current model matrix
+	Draw&	draw( const BatchRef &batch ) { return draw( batch, gl::getModelMatrix() ); }
+	//! Records a draw of \a batch with \a modelMatrix
+	Draw&	draw( const BatchRef &batch, const Matrix44f &modelMatrix );
+
+	//! Issues the recorded draws and clears the queue. Restores the GlslProg, VAO and model matrix; textures remain bound.
+	void	submit();
+	//! Discards the recorded draws without issuing them
+	void	clear();
+
+	//! Returns the number of draws recorded since the last submit() or clear()
+	size_t	getNumRecorded() const { return mDraws.size(); }
+
+	//! Sets the name of the per-instance \c mat4 attribute used for automatic instancing. An empty string disables instancing.
+	void				setInstanceMatrixAttrib( const std::string &name ) { mInstanceMatrixAttrib = name; }
+	const std::string&	getInstanceMatrixAttrib() const { return mInstanceMatrixAttrib; }
+
+	//! Returns the number of draws issued by the last submit()
+	size_t	getNumDrawCalls() const { return mNumDrawCalls; }
+	//! Returns the number of those draws which were instanced
+	size_t	getNumInstancedDrawCalls() const { return mNumInstancedDrawCalls; }
+	//! Returns the number of draw calls the last submit() saved by instancing
+	size_t	getNumDrawCallsSaved() const { return mNumDrawCallsSaved; }
+	//! Returns the number of GlslProg, VAO and texture changes made by the last submit()
+	size_t	getNumStateChanges() const { return mNumStateChanges; }
+	//! Returns how many fewer GlslProg, VAO and texture changes the last submit() made than drawing in recorded order would have
+	size_t	getNumStateChangesSaved() const { return mNumStateChangesSaved; }
+
+  protected:
+	struct UniformRecord {
+		GLint		mLocation;
+		GLenum		mType;
+		uint32_t	mDataOffset, mDataSize;
+	};
+
+	// returns the number of program, VAO and texture changes between draws \a a and \a b; \a a may be null
+	size_t	countStateChanges( const Draw *a, const Draw &b ) const;
+	// returns whether \a a and \a b can be issued as instances of one draw
+	bool	isInstanceable( const Draw &a, const Draw &b ) const;
+	// returns the sorted, unique uniform locations set by \a draw
+	void	getUniformLocations( const Draw &draw, std::vector<GLint> *result ) const;
+	void	applyUniforms( const Draw &draw ) const;
+	void	bindTextures( const Draw &draw ) const;
+
+	std::vector<Draw>			mDraws;
+	std::vector<UniformRecord>	mUniforms;
+	std::vector<uint8_t>		mUniformData;
+	std::vector<std::pair<uint8_t,TextureRef>>	mTextures;
+	std::vector<uint32_t>		mOrder; // scratch storage for the submission order
+
+	std::string		mInstanceMatrixAttrib;
+	size_t			mNumDrawCalls, mNumInstancedDrawCalls, mNumDrawCallsSaved, mNumStateChanges, mNumStateChangesSaved;
+};
+
+} } // namespace cinder::gl
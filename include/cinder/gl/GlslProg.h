@@ -29,12 +29,14 @@
 #include <exception>
 #include <map>
 #include <set>
+#include <unordered_map>
 
 #include "cinder/gl/gl.h"
 #include "cinder/Vector.h"
 #include "cinder/Color.h"
 #include "cinder/Matrix.h"
 #include "cinder/DataSource.h"
+#include "cinder/Filesystem.h"
 #include "cinder/GeomIo.h"
 
 //! Convenience macro that allows one to embed raw glsl code in-line. The \a VERSION parameter will be used for the glsl's '#version' define.
@@ -139,6 +141,8 @@ class GlslProg : public std::enable_shared_from_this<GlslProg> {
 	
 	GLuint			getHandle() const { return mHandle; }
 	
+	// The uniform() variants skip the upload when \a data matches the last value set through this GlslProg.
+	// The name variants hash the name to find its location; pass the result of getUniformLocation() in hot loops instead.
 	void	uniform( const std::string &name, int data ) const;
 	void	uniform( int location, int data ) const;	
 	void	uniform( const std::string &name, const Vec2i &data ) const;
@@ -176,6 +180,13 @@ class GlslProg : public std::enable_shared_from_this<GlslProg> {
 	void    uniform( int location, const Matrix44f *data, int count, bool transpose = false ) const;
 	void    uniform( const std::string &name, const Matrix44f *data, int count, bool transpose = false ) const;
 
+	//! Sets whether uniform() only records values, leaving them to be uploaded by flushUniforms() at draw time. Avoids binding the GlslProg for each uniform set outside of a draw. Defaults to \c false.
+	void	setUniformsDeferred( bool deferred );
+	//! Returns whether uniform() values are deferred until flushUniforms()
+	bool	isUniformsDeferred() const { return mUniformsDeferred; }
+	//! Uploads the uniform values recorded since the last flush while deferred. Called automatically by Cinder's draw functions for the bound GlslProg.
+	void	flushUniforms() const;
+
 	//! Returns a std::map from the uniform name to its OpenGL type (GL_BOOL, GL_FLOAT_VEC3, etc)
 	const std::map<std::string,GLenum>&		getActiveUniformTypes() const;
 	//! Returns a std::map from the attribute name to its OpenGL type (GL_BOOL, GL_FLOAT_VEC3, etc)
@@ -183,6 +194,8 @@ class GlslProg : public std::enable_shared_from_this<GlslProg> {
 
 	//! Returns the map between uniform semantics and active uniforms' names
 	const UniformSemanticMap&		getUniformSemantics() const;
+	//! Returns the locations of the active uniforms which map to a semantic, sparing name lookups when they are set every draw
+	const std::vector<std::pair<GLint,UniformSemantic>>&	getUniformSemanticLocations() const;
 	//! Returns the map between attribute semantics and active attributes' names
 	const AttribSemanticMap&		getAttribSemantics() const;
 	
@@ -205,6 +218,20 @@ class GlslProg : public std::enable_shared_from_this<GlslProg> {
 	//! Sets the debugging label associated with the Program. Calls glObjectLabel() when available.
 	void				setLabel( const std::string &label );
 
+	//! Returns whether the program was loaded from the program binary cache rather than compiled from source
+	bool		isLoadedFromBinaryCache() const { return mLoadedFromBinaryCache; }
+#if ! defined( CINDER_GL_ES )
+	/** Enables the on-disk program binary cache in \a directory, which is created if necessary. Programs are keyed by a hash of their sources,
+		attribute locations, feedback varyings and the driver's vendor, renderer and version strings. Cached programs are loaded with
+		glProgramBinary() rather than compiled, and are recompiled whenever the driver rejects them. An empty path disables the cache, which is the default.
+		Requires OpenGL 4.1 or \c GL_ARB_get_program_binary. Set before creating GlslProgs on other threads. **/
+	static void				setBinaryCacheDirectory( const fs::path &directory );
+	//! Returns the directory of the program binary cache; empty when it is disabled
+	static const fs::path&	getBinaryCacheDirectory();
+	//! Returns whether the current context can save and load program binaries. Equivalent to gl::context()->isProgramBinarySupported().
+	static bool				isBinaryCacheSupported();
+#endif
+
   protected:
 	GlslProg( const Format &format );
 
@@ -212,10 +239,36 @@ class GlslProg : public std::enable_shared_from_this<GlslProg> {
 	void			loadShader( const std::string &shaderSource, GLint shaderType );
 	void			attachShaders();
 	void			link();
+#if ! defined( CINDER_GL_ES )
+	// returns the cache file for a program built from \a format with \a attribLocations, or an empty path when the cache isn't in use
+	static fs::path	getBinaryCachePath( const Format &format, const std::map<std::string,GLint> &attribLocations );
+	bool			loadBinary( const fs::path &path );
+	void			saveBinary( const fs::path &path ) const;
+#endif
+
+	// the last value set for a uniform location, used to skip redundant uploads and to defer them
+	struct UniformValue {
+		UniformValue() : mType( 0 ), mCount( 0 ), mTranspose( false ), mDirty( false ), mStale( false ) {}
+
+		GLenum					mType; // GL_INT, GL_FLOAT_VEC3, GL_FLOAT_MAT4, etc
+		GLsizei					mCount;
+		bool					mTranspose;
+		bool					mDirty; // set while deferred and not yet uploaded
+		bool					mStale; // set when an overlapping array element or array has been written since, so the next write is never skipped
+		std::vector<uint8_t>	mData;
+	};
+
+	void			setUniformValue( int location, GLenum type, GLsizei count, bool transpose, const void *data, size_t dataSize ) const;
+	void			uploadUniform( int location, const UniformValue &value ) const;
+	GLint			findUniformLocation( const std::string &name ) const;
 	
 	GLuint									mHandle;
 
-	mutable std::map<std::string, int>		mUniformLocs;
+	mutable std::unordered_map<std::string, int>	mUniformLocs;
+	mutable std::unordered_map<int, UniformValue>	mUniformValues;
+	mutable std::vector<int>						mDirtyUniforms;
+	bool											mUniformsDeferred;
+	mutable bool									mHasUniformArrays; // whether any value has been set with a count above 1
 	mutable bool							mActiveUniformTypesCached;
 	mutable std::map<std::string, GLenum>	mActiveUniformTypes;
 
@@ -227,6 +280,7 @@ class GlslProg : public std::enable_shared_from_this<GlslProg> {
 	UniformSemanticMap						mUniformNameToSemanticMap;
 	mutable bool							mUniformSemanticsCached;
 	mutable UniformSemanticMap				mUniformSemantics;
+	mutable std::vector<std::pair<GLint,UniformSemantic>>	mUniformSemanticLocations;
 	
 	static AttribSemanticMap				sDefaultAttribNameToSemanticMap;
 	AttribSemanticMap						mAttribNameToSemanticMap;
@@ -236,6 +290,7 @@ class GlslProg : public std::enable_shared_from_this<GlslProg> {
 	mutable std::set<std::string>			mLoggedMissingUniforms;
 
 	std::string								mLabel; // debug label
+	bool									mLoadedFromBinaryCache;
 
 	// storage as a work-around for NVidia on MSW driver bug expecting persistent memory in calls to glTransformFeedbackVaryings
 #if ! defined( CINDER_GL_ES )
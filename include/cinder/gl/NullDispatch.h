@@ -0,0 +1,57 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+
+#include <string>
+
+namespace cinder { namespace gl {
+
+#if ! defined( CINDER_GL_ES )
+
+/*! Swaps glload's entry points for stubs which do nothing but count their calls. This allows Context's state caching and the
+	drawing paths to be exercised and measured without a GL context or driver. Every entry point called by the gl namespace is
+	covered. Queries report zeros, except that shaders compile, programs link, framebuffers are complete, glGetString() reports
+	a 3.2 context and glMapBufferRange() maps to scratch memory. glMapBuffer() fails. Only desktop GL, whose entry points are
+	glload function pointers, is supported. */
+class NullDispatch {
+  public:
+	//! Installs the stubs, saving the current entry points for uninstall(), and resets the call counts. Not thread-safe.
+	static void		install();
+	//! Restores the entry points saved by install()
+	static void		uninstall();
+	static bool		isInstalled();
+
+	//! Returns the number of calls to the entry point \a name, such as \c "glBindTexture", since install() or resetCounts(). Returns \c 0 for entry points which aren't covered.
+	static uint32_t	getNumCalls( const std::string &name );
+	//! Returns the number of calls to all entry points since install() or resetCounts()
+	static uint32_t	getTotalCalls();
+	static void		resetCounts();
+};
+
+#endif // ! defined( CINDER_GL_ES )
+
+} } // namespace cinder::gl
@@ -410,20 +410,22 @@ class Texture : public TextureBase {
 	void			update( const Channel8u &channel, const Area &area, int mipLevel = 0 );
 	//! Updates the pixels of a Texture with contents of \a textureData. Inefficient if the bounds of \a textureData don't match those of \a this
 	void			update( const TextureData &textureData );
+	//! Updates mip level \a mipLevel of a Texture with the same level of \a textureData. Expects the level's size to match the Texture's.
+	void			update( const TextureData &textureData, int mipLevel );
 #if ! defined( CINDER_GL_ES )
 	//! Updates the pixels of a Texture with the contents of a PBO (whose target must be \c GL_PIXEL_UNPACK_BUFFER) at mipmap level \a mipLevel. \a format and \a type correspond to parameters of glTexSubImage2D, and would often be GL_RGB and GL_UNSIGNED_BYTE respectively. Reads from the PBO starting at \a pboByteOffset.
 	void			update( const PboRef &pbo, GLenum format, GLenum type, int mipLevel = 0, size_t pboByteOffset = 0 );
 	//! Updates a subregion (measured as origin upper-left) of the pixels of a Texture with the contents of a PBO (whose target must be \c GL_PIXEL_UNPACK_BUFFER) at mipmap level \a mipLevel.  \a format and \a type correspond to parameters of glTexSubImage2D, and would often be GL_RGB and GL_UNSIGNED_BYTE respectively. Reads from the PBO starting at \a pboByteOffset.
 	void			update( const PboRef &pbo, GLenum format, GLenum type, const Area &destArea, int mipLevel = 0, size_t pboByteOffset = 0 );
-	//! Updates a Texture from a KTX file. Uses \a intermediatePbo if supplied; requires it to be large enough to hold all MIP levels and throws if it is not.
+	//! Updates a Texture from a KTX file. Uses \a intermediatePbo if supplied; requires it to be large enough to hold all MIP levels and throws if it is not. Otherwise each level is uploaded as soon as it has been read when the sizes match.
 	void			updateFromKtx( const DataSourceRef &dataSource, const PboRef &intermediatePbo = PboRef() );
-	//! Updates a Texture from a DDS file. Uses \a intermediatePbo if supplied; requires it to be large enough to hold all MIP levels and throws if it is not.
+	//! Updates a Texture from a DDS file. Uses \a intermediatePbo if supplied; requires it to be large enough to hold all MIP levels and throws if it is not. Otherwise each level is uploaded as soon as it has been read when the sizes match.
 	void			updateFromDds( const DataSourceRef &dataSource, const PboRef &intermediatePbo = PboRef() );
 #else
-	//! Updates a Texture from a KTX file. Assumes sizes match.
+	//! Updates a Texture from a KTX file, uploading each level as soon as it has been read. Assumes sizes match.
 	void			updateFromKtx( const DataSourceRef &dataSource );
   #if defined( CINDER_GL_ANGLE )
-	//! Updates a Texture from a KTX file. Assumes sizes match.
+	//! Updates a Texture from a DDS file, uploading each level as soon as it has been read. Assumes sizes match.
 	void			updateFromDds( const DataSourceRef &dataSource );
   #endif
 #endif
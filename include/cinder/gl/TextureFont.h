@@ -42,7 +42,7 @@ class TextureFont {
   public:
 	class Format {
 	  public:
-		Format() : mTextureWidth( 1024 ), mTextureHeight( 1024 ), mPremultiply( false ), mMipmapping( false )
+		Format() : mTextureWidth( 1024 ), mTextureHeight( 1024 ), mPremultiply( false ), mMipmapping( false ), mDynamicAtlas( false ), mMaxTextures( 2 )
 		{}
 		
 		//! Sets the width of the textures created internally for glyphs. Default \c 1024
@@ -63,11 +63,23 @@ class TextureFont {
 		Format&		enableMipmapping( bool enable = true ) { mMipmapping = enable; return *this; }
 		//! Returns whether the TextureFont texture has mipmapping enabled
 		bool		hasMipmapping() const { return mMipmapping; }
+
+		/** Enables a dynamic atlas, whose glyphs are rasterized on a worker thread the first time they're drawn rather than all at creation. Glyphs appear once rasterized,
+			typically a frame later, and the least recently drawn are evicted once maxTextures() textures are full. Suits large character sets such as CJK. Default is disabled. **/
+		Format&		dynamicAtlas( bool enable = true ) { mDynamicAtlas = enable; return *this; }
+		//! Returns whether the TextureFont uses a dynamic atlas. Default is disabled.
+		bool		isDynamicAtlas() const { return mDynamicAtlas; }
+		//! Sets the maximum number of textures a dynamic atlas fills before evicting glyphs. Default \c 2
+		Format&		maxTextures( size_t maxTextures ) { mMaxTextures = maxTextures; return *this; }
+		//! Returns the maximum number of textures a dynamic atlas fills before evicting glyphs. Default \c 2
+		size_t		getMaxTextures() const { return mMaxTextures; }
 		
 	  protected:
 		int32_t		mTextureWidth, mTextureHeight;
 		bool		mPremultiply;
 		bool		mMipmapping;
+		bool		mDynamicAtlas;
+		size_t		mMaxTextures;
 	};
 
 	struct DrawOptions {
@@ -104,9 +116,10 @@ class TextureFont {
 		float		mScale;
 	};
 
-	//! Creates a new TextureFontRef with font \a font, ensuring that glyphs necessary to render \a supportedChars are renderable, and format \a format
+	//! Creates a new TextureFontRef with font \a font, ensuring that glyphs necessary to render \a supportedChars are renderable, and format \a format. With a dynamic atlas, \a supportedChars are only queued for rasterization.
 	static TextureFontRef		create( const Font &font, const Format &format = Format(), const std::string &supportedChars = TextureFont::defaultChars() )
 	{ return TextureFontRef( new TextureFont( font, supportedChars, format ) ); }
+	~TextureFont();
 	
 	//! Draws string \a str at baseline \a baseline with DrawOptions \a options
 	void	drawString( const std::string &str, const Vec2f &baseline, const DrawOptions &options = DrawOptions() );
@@ -143,6 +156,8 @@ class TextureFont {
 	float	getDescent() const { return mFont.getDescent(); }
 	//! Returns whether the TextureFont output premultipled output. Default is \c false.
 	bool	isPremultiplied() const { return mFormat.getPremultiply(); }
+	//! Returns the number of glyphs a dynamic atlas has yet to rasterize, which aren't drawn until they are. Always \c 0 without a dynamic atlas.
+	size_t	getNumPendingGlyphs() const;
 
 	//! Returns the default set of characters for a TextureFont, suitable for most English text, including some common ligatures and accented vowels.
 	//! \c "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz1234567890().?!,:;'\"&*=+-/\\@#_[]<>%^llflfiphrids"
@@ -151,6 +166,12 @@ class TextureFont {
   protected:
 	TextureFont( const Font &font, const std::string &supportedChars, const Format &format );
 
+	struct DynamicAtlas;
+	//! Starts the dynamic atlas' worker thread and queues \a glyphs for it
+	void	startDynamicAtlas( const std::vector<Font::Glyph> &glyphs );
+	//! Adds the glyphs rasterized since the last call to the dynamic atlas, requests those of \a glyphMeasures it lacks, and uploads what changed
+	void	updateDynamicAtlas( const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures );
+
 	struct GlyphInfo {
 		uint8_t		mTextureIndex;
 		Area		mTexCoords;
@@ -165,6 +186,7 @@ class TextureFont {
 	std::vector<gl::TextureRef>						mTextures;
 	Font											mFont;
 	Format											mFormat;
+	std::unique_ptr<DynamicAtlas>					mDynamicAtlas;
 };
 
 } } // namespace cinder::gl
\ No newline at end of file
@@ -25,14 +25,24 @@
 
 #include "cinder/gl/Texture.h"
 #include "cinder/DataSource.h"
+#include "cinder/Filter.h"
+
+#include <functional>
 
 namespace cinder { namespace gl {
 
-void parseKtx( const DataSourceRef &dataSource, TextureData *resultData );
+//! Called by the parsers once level \a levelIndex of \a textureData has been read, so that it can be consumed before the remaining levels are. When \a textureData uses an intermediate PBO it remains mapped until parsing completes.
+typedef std::function<void( const TextureData &textureData, size_t levelIndex )>	TextureDataLevelFn;
+
+void parseKtx( const DataSourceRef &dataSource, TextureData *resultData, const TextureDataLevelFn &levelFn = TextureDataLevelFn() );
 #if ! defined( CINDER_GL_ES ) || defined( CINDER_GL_ANGLE )
-void parseDds( const DataSourceRef &dataSource, TextureData *resultData );
+void parseDds( const DataSourceRef &dataSource, TextureData *resultData, const TextureDataLevelFn &levelFn = TextureDataLevelFn() );
 #endif
 
+/** Fills \a resultData with \a surface followed by its complete mip chain, generated on the CPU by ip::generateMipmaps(). Levels are stored as tightly packed RGB or RGBA.
+	When \a srgb is \c true the chain is filtered in linear space and \a resultData uses an sRGB internal format. Pass the result to Texture::create() with mipmapping enabled. **/
+void generateMipmapTextureData( const Surface8u &surface, TextureData *resultData, const FilterBase &filter = FilterBox(), bool srgb = false );
+//! Fills \a resultData with \a surface followed by its complete mip chain, generated on the CPU by ip::generateMipmaps().
+void generateMipmapTextureData( const Surface32f &surface, TextureData *resultData, const FilterBase &filter = FilterBox(), bool srgb = false );
 
-
-} } // namespace cinder::gl
\ No newline at end of file
+} } // namespace cinder::gl
@@ -53,6 +53,8 @@ class VboMesh {
 		Layout&		usage( GLenum usage ) { mUsage = usage; return *this; }
 		GLenum		getUsage() const { return mUsage; }
 		Layout&		attrib( geom::Attrib attrib, uint8_t dims ) { mAttribInfos.push_back( geom::AttribInfo( attrib, geom::DataType::FLOAT, dims, 0, 0, 0 ) ); return *this; }
+		//! Adds \a attrib stored as \a dataType, such as geom::DataType::HALF_FLOAT or geom::DataType::INT_10_10_10_2_NORM for compact normals
+		Layout&		attrib( geom::Attrib attrib, geom::DataType dataType, uint8_t dims ) { mAttribInfos.push_back( geom::AttribInfo( attrib, dataType, dims, 0, 0, 0 ) ); return *this; }
 		
 		void		clearAttribs() { mAttribInfos.clear(); }
 
@@ -70,6 +72,8 @@ class VboMesh {
 	static VboMeshRef	create( uint32_t numVertices, GLenum glPrimitive, const std::vector<std::pair<geom::BufferLayout,VboRef>> &vertexArrayBuffers, uint32_t numIndices = 0, GLenum indexType = GL_UNSIGNED_SHORT, const VboRef &indexVbo = VboRef() );
 	//! Creates a VboMesh which represents the user's vertex buffer objects. Allows optional \a indexVbo to enable indexed vertices; creates a static VBO if none provided.
 	static VboMeshRef	create( uint32_t numVertices, GLenum glPrimitive, const std::vector<Layout> &vertexArrayLayouts, uint32_t numIndices = 0, GLenum indexType = GL_UNSIGNED_SHORT, const VboRef &indexVbo = VboRef() );
+	//! Creates a VboMesh which represents the geom::Source \a source, storing its attributes according to \a vertexArrayLayouts. Attributes absent from the layouts are ignored.
+	static VboMeshRef	create( const geom::Source &source, const std::vector<Layout> &vertexArrayLayouts );
 	//! Creates a VboMesh which represents the geom::Source \a source. Allows optional \a arrayVbo and \a indexArrayVbo in order to simplify recycling of VBOs.
 	static VboMeshRef	create( const geom::Source &source, const VboRef &arrayVbo, const VboRef &indexArrayVbo );
 
@@ -236,6 +240,7 @@ class VboMesh {
 	VboMesh( const geom::Source &source, const VboRef &arrayVbo, const VboRef &indexArrayVbo );
 	VboMesh( uint32_t numVertices, uint32_t numIndices, GLenum glPrimitive, GLenum indexType, const std::vector<std::pair<geom::BufferLayout,VboRef>> &vertexArrayBuffers, const VboRef &indexVbo );
 	VboMesh( uint32_t numVertices, uint32_t numIndices, GLenum glPrimitive, GLenum indexType, const std::vector<Layout> &vertexArrayLayouts, const VboRef &indexVbo );
+	VboMesh( const geom::Source &source, const std::vector<Layout> &vertexArrayLayouts );
 
 	void	allocateIndexVbo();
 
@@ -292,6 +292,10 @@ inline void setWireframeEnabled( bool enable = true )	{ if( enable ) enableWiref
 GLenum toGl( geom::Primitive prim );
 //! Converts an OpenGL primitive mode( GL_TRIANGLES, GL_TRIANGLE_STRIP, etc ) to a geom::Primitive
 geom::Primitive toGeomPrimitive( GLenum prim );
+//! Converts a geom::DataType to the OpenGL vertex attribute type ( GL_FLOAT, GL_HALF_FLOAT, GL_SHORT, etc ). Returns 0 if unsupported by the current GL, such as the packed types on ES 2.
+GLenum toGl( geom::DataType dataType );
+//! Returns the number of components to pass to glVertexAttribPointer() for \a attribInfo. Packed 10_10_10_2 types always specify 4.
+GLint toGlAttribSize( const geom::AttribInfo &attribInfo );
 //! Converts a UniformSemantic to its name
 std::string uniformSemanticToString( UniformSemantic uniformSemantic );
 
@@ -0,0 +1,63 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+
+namespace cinder { namespace ip {
+
+//! Decodes the sRGB-encoded value \a v, in the range \c [0,1], to linear
+float	srgbToLinear( float v );
+//! Encodes the linear value \a v to sRGB, clamping it to the range \c [0,1] first
+float	linearToSrgb( float v );
+
+//! Decodes \a count 8-bit sRGB values from \a src to linear values in \c [0,1] in \a dst, through a 256-entry table
+void	srgbToLinear( const uint8_t *src, float *dst, size_t count );
+//! Encodes \a count linear values from \a src to 8-bit sRGB in \a dst, rounded to nearest. Exactly matches linearToSrgb( float ) through a table of 4096 starting values and the 255 rounding thresholds.
+void	linearToSrgb( const float *src, uint8_t *dst, size_t count );
+//! Decodes \a count sRGB values from \a src to linear in \a dst, which may be the same as \a src
+void	srgbToLinear( const float *src, float *dst, size_t count );
+//! Encodes \a count linear values from \a src to sRGB in \a dst, which may be the same as \a src
+void	linearToSrgb( const float *src, float *dst, size_t count );
+
+//! Converts \a count colors from \a src to hue, saturation and value in \a dst, with the same results as rgbToHSV(). Uses SSE2 four colors at a time.
+void	rgbToHsv( const Colorf *src, Vec3f *dst, size_t count );
+//! Converts \a count hue, saturation and value triples from \a src to colors in \a dst, with the same results as hsvToRGB(). Uses SSE2 four colors at a time.
+void	hsvToRgb( const Vec3f *src, Colorf *dst, size_t count );
+
+//! Decodes the red, green and blue channels of \a surface from sRGB to linear in place, in parallel across rows. 8-bit Surfaces convert through a table.
+template<typename T>
+void	srgbToLinear( SurfaceT<T> *surface );
+//! Encodes the red, green and blue channels of \a surface from linear to sRGB in place, in parallel across rows. 8-bit Surfaces convert through a table.
+template<typename T>
+void	linearToSrgb( SurfaceT<T> *surface );
+//! Converts \a surface to hue, saturation and value in place, stored in its red, green and blue channels respectively and scaled to the channel's range
+template<typename T>
+void	rgbToHsv( SurfaceT<T> *surface );
+//! Converts \a surface from hue, saturation and value stored in its red, green and blue channels back to color, in place
+template<typename T>
+void	hsvToRgb( SurfaceT<T> *surface );
+
+} } // namespace cinder::ip
@@ -33,5 +33,8 @@ void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );
 //! Converts Surface \a srcSurface to grayscale and stores the result in Channel \a dstChannel. Uses primary weights dictated by the Rec. 709 Video Standard
 template<typename T>
 void grayscale( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel );
+//! Copies Channel \a srcChannel into the red, green and blue channels of Surface \a dstSurface, leaving any alpha untouched
+template<typename T>
+void grayscale( const ChannelT<T> &srcChannel, SurfaceT<T> *dstSurface );
 
 } } // namespace cinder::ip
@@ -0,0 +1,40 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Filter.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+/** Returns the mip chain of \a srcSurface, not including \a srcSurface itself. The first element is half the size of \a srcSurface and the last is 1x1.
+	Each level is filtered from the previous one using \a filter, in parallel across bands of rows, and intermediate results stay in floating point. When \a srgb is \c true the color channels are decoded to linear before filtering and re-encoded afterwards.
+	Unpremultiplied alpha is premultiplied while filtering so that transparent pixels don't bleed color, and the results match \a srcSurface's premultiplication. \a maxLevels limits the number of levels returned; \c 0 returns the full chain. **/
+template<typename T>
+std::vector<SurfaceT<T> > generateMipmaps( const SurfaceT<T> &srcSurface, const FilterBase &filter = FilterBox(), bool srgb = false, int maxLevels = 0 );
+
+} } // namespace cinder::ip
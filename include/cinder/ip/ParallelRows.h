@@ -0,0 +1,67 @@
+/*
+ Copyright (c) 2010, The Barbarian Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+
+// Row iteration shared by the ip implementations; not part of the public API
+namespace cinder { namespace ip { namespace impl {
+
+//! Returns the minimum number of rows of \a width pixels per parallelFor() chunk, aiming for roughly 64k pixels each
+inline size_t minRowsPerChunk( int32_t width )
+{
+	return std::max<size_t>( 1, 65536 / std::max<int32_t>( width, 1 ) );
+}
+
+//! Calls \a chunkFn( rowBegin, rowEnd ) over the rows [\a rowBegin, \a rowEnd) of \a width pixels, in parallel chunks for large areas
+template<typename FN>
+void forEachRowChunk( int32_t rowBegin, int32_t rowEnd, int32_t width, const FN &chunkFn )
+{
+	parallelFor( rowBegin, rowEnd, minRowsPerChunk( width ), chunkFn );
+}
+
+//! Calls \a rowFn( y ) for each row y in [\a rowBegin, \a rowEnd) of \a width pixels, in parallel chunks for large areas
+template<typename FN>
+void forEachRow( int32_t rowBegin, int32_t rowEnd, int32_t width, const FN &rowFn )
+{
+	forEachRowChunk( rowBegin, rowEnd, width, [&]( size_t chunkBegin, size_t chunkEnd ) {
+		for( size_t y = chunkBegin; y < chunkEnd; ++y )
+			rowFn( (int32_t)y );
+	} );
+}
+
+//! Calls \a rowFn( rowPtr, width ) for each row of \a surface, in parallel chunks for large surfaces
+template<typename T, typename FN>
+void forEachRow( SurfaceT<T> *surface, const FN &rowFn )
+{
+	const int32_t width = surface->getWidth();
+	forEachRow( 0, surface->getHeight(), width, [&]( int32_t y ) {
+		rowFn( surface->getData( Vec2i( 0, y ) ), width );
+	} );
+}
+
+} } } // namespace cinder::ip::impl
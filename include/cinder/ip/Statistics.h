@@ -0,0 +1,84 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/ChanTraits.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+/** Reductions over the pixels of a Surface or Channel inside an Area, which is clipped to its bounds. Rows are split across threads for large areas, and 8-bit and float
+	layouts of up to 4 elements per pixel use SSE2 kernels. Results are in the channel's own units, e.g. \c [0,255] for 8-bit. **/
+
+//! Returns the sums of the red, green, blue and alpha channels of \a surface within \a area as x, y, z and w, accumulated in double precision. w is \c 0 for Surfaces without alpha.
+template<typename T>
+Vec4d	calcSum( const SurfaceT<T> &surface, const Area &area );
+//! Returns the sum of the values of \a channel within \a area, accumulated in double precision
+template<typename T>
+double	calcSum( const ChannelT<T> &channel, const Area &area );
+
+//! Returns the mean of each channel of \a surface within \a area. Alpha is \c 0 for Surfaces without alpha, and the result is black for an empty area.
+template<typename T>
+ColorA	calcMean( const SurfaceT<T> &surface, const Area &area );
+//! Returns the mean value of \a channel within \a area, or \c 0 for an empty area
+template<typename T>
+float	calcMean( const ChannelT<T> &channel, const Area &area );
+
+//! Determines the minimum and maximum of each channel of \a surface within \a area. Alpha is reported as CHANTRAIT<T>::max() for Surfaces without alpha. An empty area reports zeroes.
+template<typename T>
+void	getMinMax( const SurfaceT<T> &surface, const Area &area, ColorAT<T> *resultMin, ColorAT<T> *resultMax );
+//! Determines the minimum and maximum values of \a channel within \a area. An empty area reports zeroes.
+template<typename T>
+void	getMinMax( const ChannelT<T> &channel, const Area &area, T *resultMin, T *resultMax );
+
+/** Counts the values of \a channel within \a area into \a numBins equal bins spanning \c [\a rangeMin, \a rangeMax], replacing the contents of \a result. Values outside the range are counted in the first or last bin.
+	With the defaults, each value of a Channel8u has its own bin. **/
+template<typename T>
+void	calcHistogram( const ChannelT<T> &channel, const Area &area, std::vector<uint32_t> *result, int32_t numBins = 256, float rangeMin = 0, float rangeMax = CHANTRAIT<T>::max() );
+/** Counts the red, green, blue and optionally alpha channels of \a surface within \a area in a single pass, binned as calcHistogram( const ChannelT<T>&, ... ).
+	\a resultAlpha is cleared to zero bins for Surfaces without alpha. **/
+template<typename T>
+void	calcHistogram( const SurfaceT<T> &surface, const Area &area, std::vector<uint32_t> *resultRed, std::vector<uint32_t> *resultGreen, std::vector<uint32_t> *resultBlue, std::vector<uint32_t> *resultAlpha = NULL,
+						int32_t numBins = 256, float rangeMin = 0, float rangeMax = CHANTRAIT<T>::max() );
+
+//! Statistics of the Rec. 709 luminance of a region, normalized so that CHANTRAIT<T>::max() is \c 1. \see calcLuminanceStats()
+struct LuminanceStats {
+	LuminanceStats() : mMin( 0 ), mMax( 0 ), mMean( 0 ), mLogMean( 0 ) {}
+
+	float	mMin, mMax, mMean;
+	//! The geometric mean, exp( mean( log( 0.0001 + luminance ) ) ), which auto-exposure uses as the scene's key
+	float	mLogMean;
+};
+
+/** Returns the luminance statistics of \a surface within \a area. 8-bit Surfaces use the luma of ip::grayscale(), binned into a histogram so that no logarithms are taken per pixel.
+	An empty area returns all zeroes. **/
+template<typename T>
+LuminanceStats	calcLuminanceStats( const SurfaceT<T> &surface, const Area &area );
+template<>
+LuminanceStats	calcLuminanceStats( const SurfaceT<uint8_t> &surface, const Area &area );
+
+} } // namespace cinder::ip
@@ -30,6 +30,7 @@ class ObjLoaderApp : public AppBasic {
 	void keyDown( KeyEvent event );
 
 	void	loadObjFile( const fs::path &filePath );
+	void	buildLods( bool fast );
 	void	frameCurrentObject();
 	void	draw();
 	
@@ -37,6 +38,8 @@ class ObjLoaderApp : public AppBasic {
 	MayaCamUI		mMayaCam;
 	TriMeshRef		mMesh;
 	gl::BatchRef	mBatch;
+	std::vector<gl::BatchRef>	mLodBatches;
+	size_t			mLod;
 	gl::GlslProgRef	mShader;
 	gl::TextureRef	mTexture;
 };
@@ -85,6 +88,23 @@ void ObjLoaderApp::loadObjFile( const fs::path &filePath )
 	ObjLoader loader( (DataSourceRef)loadFile( filePath ) );
 	mMesh = TriMesh::create( loader );
 	mBatch = gl::Batch::create( mMesh, gl::getStockShader( gl::ShaderDef().color() ) );
+	mLodBatches.clear();
+	mLod = 0;
+}
+
+// Builds a LOD chain for the current mesh, each level halving the triangles. All levels share the vertex VBO.
+void ObjLoaderApp::buildLods( bool fast )
+{
+	std::vector<std::vector<uint32_t>> lods = mMesh->calcLodChain( 8, 0.5f, fast );
+
+	gl::VboMeshRef vboMesh = gl::VboMesh::create( *mMesh );
+	mLodBatches.clear();
+	for( size_t l = 0; l < lods.size(); ++l ) {
+		gl::VboRef indexVbo = gl::Vbo::create( GL_ELEMENT_ARRAY_BUFFER, lods[l].size() * sizeof(uint32_t), lods[l].data() );
+		gl::VboMeshRef lodMesh = gl::VboMesh::create( mMesh->getNumVertices(), GL_TRIANGLES, vboMesh->getVertexArrayLayoutVbos(), lods[l].size(), GL_UNSIGNED_INT, indexVbo );
+		mLodBatches.push_back( gl::Batch::create( lodMesh, gl::getStockShader( gl::ShaderDef().color() ) ) );
+	}
+	mLod = 0;
 }
 
 void ObjLoaderApp::frameCurrentObject()
@@ -120,6 +140,15 @@ void ObjLoaderApp::keyDown( KeyEvent event )
 	else if( event.getChar() == 'f' ) {
 		frameCurrentObject();
 	}
+	else if( event.getChar() == 'l' || event.getChar() == 'L' ) {
+		buildLods( event.getChar() == 'L' );
+	}
+	else if( event.getChar() == ']' && ! mLodBatches.empty() ) {
+		mLod = std::min( mLod + 1, mLodBatches.size() - 1 );
+	}
+	else if( event.getChar() == '[' && ! mLodBatches.empty() ) {
+		mLod = ( mLod > 0 ) ? mLod - 1 : 0;
+	}
 }
 
 void ObjLoaderApp::draw()
@@ -143,7 +172,10 @@ void ObjLoaderApp::draw()
 //	mShader.bind();
 	gl::pushMatrices();
 		gl::rotate( mArcball.getQuat() );
-		mBatch->draw();
+		if( mLodBatches.empty() )
+			mBatch->draw();
+		else
+			mLodBatches[mLod]->draw();
 	gl::popMatrices();
 }
 
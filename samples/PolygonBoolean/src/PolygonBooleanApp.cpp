@@ -17,6 +17,7 @@ class PolygonBooleanApp : public AppBasic {
 	void				doIntersection();
 	void				doXor();
 	void				doDifference();
+	void				doOffset();
 
 	vector<PolyLine2f>	makePolyWithHole() const;
 	vector<PolyLine2f>	makeStar() const;
@@ -25,6 +26,7 @@ class PolygonBooleanApp : public AppBasic {
 	vector<PolyLine2f> 	mPolyA, mPolyB, mPolyResult;
 	TriMesh2d			mPolyAMesh, mPolyBMesh;
 	
+	float				mOffsetDistance;
 	params::InterfaceGl	mParams;
 };
 
@@ -101,13 +103,21 @@ void PolygonBooleanApp::doDifference()
 	mPolyResult = PolyLine2f::calcDifference( mPolyA, mPolyB );
 }
 
+void PolygonBooleanApp::doOffset()
+{
+	mPolyResult = PolyLine2f::calcOffset( mPolyA, mOffsetDistance );
+}
+
 void PolygonBooleanApp::setup()
 {
-	mParams = params::InterfaceGl( "App parameters", Vec2i( 180, 100 ) );
+	mParams = params::InterfaceGl( "App parameters", Vec2i( 180, 140 ) );
 	mParams.addButton( "Union", std::bind( &PolygonBooleanApp::doUnion, this ) );
 	mParams.addButton( "Intersection", std::bind( &PolygonBooleanApp::doIntersection, this ) );
 	mParams.addButton( "XOR", std::bind( &PolygonBooleanApp::doXor, this ) );
 	mParams.addButton( "Difference", std::bind( &PolygonBooleanApp::doDifference, this ) );
+	mOffsetDistance = 10.0f;
+	mParams.addParam( "Offset Distance", &mOffsetDistance, "step=1" );
+	mParams.addButton( "Offset", std::bind( &PolygonBooleanApp::doOffset, this ) );
 
 	mPolyA = makePolyWithHole();
 	mPolyAMesh = makeMesh( mPolyA );
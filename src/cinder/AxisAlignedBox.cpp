@@ -23,6 +23,7 @@
 #include "cinder/AxisAlignedBox.h"
 
 #include <limits>
+#include <algorithm>
 
 namespace cinder {
 
@@ -192,8 +193,7 @@ AxisAlignedBox3f AxisAlignedBox3f::transformed( const Matrix44f &transform ) con
 {
 	Vec3f verts[8];
 
-	for(size_t i=0;i<8;i++) 
-		verts[i] = transform.transformPointAffine(mVerts[i]);
+	transform.transformPointsAffine( mVerts, verts, 8 );
 
 	Vec3f min = verts[0];
 	Vec3f max = verts[0];
@@ -211,4 +211,131 @@ AxisAlignedBox3f AxisAlignedBox3f::transformed( const Matrix44f &transform ) con
 	return AxisAlignedBox3f(min, max);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// AxisAlignedBoxTree
+namespace {
+
+struct BoxCenterCompare {
+	BoxCenterCompare( const AxisAlignedBox3f *boxes, int axis ) : mBoxes( boxes ), mAxis( axis ) {}
+
+	bool operator()( uint32_t a, uint32_t b ) const
+	{
+		return ( mBoxes[a].getMin()[mAxis] + mBoxes[a].getMax()[mAxis] ) < ( mBoxes[b].getMin()[mAxis] + mBoxes[b].getMax()[mAxis] );
+	}
+
+	const AxisAlignedBox3f	*mBoxes;
+	int						mAxis;
+};
+
+} // anonymous namespace
+
+void AxisAlignedBoxTree::build( const AxisAlignedBox3f *boxes, size_t count, size_t maxLeafSize )
+{
+	maxLeafSize = std::max<size_t>( 1, std::min<size_t>( maxLeafSize, 32 ) );
+
+	mNodes.clear();
+	mItemIndices.resize( count );
+	for( size_t i = 0; i < count; ++i )
+		mItemIndices[i] = (uint32_t)i;
+	for( int axis = 0; axis < 3; ++axis ) {
+		mItemCenters[axis].resize( count );
+		mItemHalfSizes[axis].resize( count );
+	}
+
+	if( count == 0 )
+		return;
+
+	mNodes.reserve( 2 * ( count / maxLeafSize + 1 ) );
+	mNodes.push_back( Node() );
+	buildNode( 0, 0, (uint32_t)count, maxLeafSize, boxes );
+
+	for( size_t i = 0; i < count; ++i )
+		setItem( (uint32_t)i, boxes[mItemIndices[i]] );
+}
+
+void AxisAlignedBoxTree::buildNode( uint32_t nodeIndex, uint32_t first, uint32_t count, size_t maxLeafSize, const AxisAlignedBox3f *boxes )
+{
+	Vec3f boundsMin( boxes[mItemIndices[first]].getMin() ), boundsMax( boxes[mItemIndices[first]].getMax() );
+	Vec3f centroidMin( boundsMin + boundsMax ), centroidMax( centroidMin );
+	for( uint32_t i = first + 1; i < first + count; ++i ) {
+		const AxisAlignedBox3f &box = boxes[mItemIndices[i]];
+		Vec3f centroid = box.getMin() + box.getMax();
+		for( int axis = 0; axis < 3; ++axis ) {
+			boundsMin[axis] = std::min( boundsMin[axis], box.getMin()[axis] );
+			boundsMax[axis] = std::max( boundsMax[axis], box.getMax()[axis] );
+			centroidMin[axis] = std::min( centroidMin[axis], centroid[axis] );
+			centroidMax[axis] = std::max( centroidMax[axis], centroid[axis] );
+		}
+	}
+
+	Node &node = mNodes[nodeIndex];
+	node.mCenter = ( boundsMin + boundsMax ) * 0.5f;
+	node.mHalfSize = ( boundsMax - boundsMin ) * 0.5f;
+	node.mFirstItem = first;
+	node.mNumItems = count;
+	node.mFirstChild = 0;
+
+	if( count <= maxLeafSize )
+		return;
+
+	// split at the median centroid along the axis with the largest centroid spread
+	Vec3f spread = centroidMax - centroidMin;
+	int axis = ( spread.x > spread.y ) ? ( ( spread.x > spread.z ) ? 0 : 2 ) : ( ( spread.y > spread.z ) ? 1 : 2 );
+	uint32_t half = count / 2;
+	std::nth_element( mItemIndices.begin() + first, mItemIndices.begin() + first + half, mItemIndices.begin() + first + count, BoxCenterCompare( boxes, axis ) );
+
+	uint32_t firstChild = (uint32_t)mNodes.size();
+	mNodes[nodeIndex].mFirstChild = firstChild;
+	mNodes.push_back( Node() );
+	mNodes.push_back( Node() );
+	buildNode( firstChild, first, half, maxLeafSize, boxes );
+	buildNode( firstChild + 1, first + half, count - half, maxLeafSize, boxes );
+}
+
+void AxisAlignedBoxTree::refit( const AxisAlignedBox3f *boxes )
+{
+	for( size_t i = 0; i < mItemIndices.size(); ++i )
+		setItem( (uint32_t)i, boxes[mItemIndices[i]] );
+
+	if( ! mNodes.empty() )
+		refitNode( 0 );
+}
+
+void AxisAlignedBoxTree::refitNode( uint32_t nodeIndex )
+{
+	Vec3f boundsMin, boundsMax;
+	const Node node = mNodes[nodeIndex];
+	if( node.mFirstChild ) {
+		refitNode( node.mFirstChild );
+		refitNode( node.mFirstChild + 1 );
+		const Node &a = mNodes[node.mFirstChild];
+		const Node &b = mNodes[node.mFirstChild + 1];
+		for( int axis = 0; axis < 3; ++axis ) {
+			boundsMin[axis] = std::min( a.mCenter[axis] - a.mHalfSize[axis], b.mCenter[axis] - b.mHalfSize[axis] );
+			boundsMax[axis] = std::max( a.mCenter[axis] + a.mHalfSize[axis], b.mCenter[axis] + b.mHalfSize[axis] );
+		}
+	}
+	else {
+		for( int axis = 0; axis < 3; ++axis ) {
+			boundsMin[axis] = std::numeric_limits<float>::max();
+			boundsMax[axis] = -std::numeric_limits<float>::max();
+			for( uint32_t i = node.mFirstItem; i < node.mFirstItem + node.mNumItems; ++i ) {
+				boundsMin[axis] = std::min( boundsMin[axis], mItemCenters[axis][i] - mItemHalfSizes[axis][i] );
+				boundsMax[axis] = std::max( boundsMax[axis], mItemCenters[axis][i] + mItemHalfSizes[axis][i] );
+			}
+		}
+	}
+
+	mNodes[nodeIndex].mCenter = ( boundsMin + boundsMax ) * 0.5f;
+	mNodes[nodeIndex].mHalfSize = ( boundsMax - boundsMin ) * 0.5f;
+}
+
+void AxisAlignedBoxTree::setItem( uint32_t treeIndex, const AxisAlignedBox3f &box )
+{
+	for( int axis = 0; axis < 3; ++axis ) {
+		mItemCenters[axis][treeIndex] = ( box.getMin()[axis] + box.getMax()[axis] ) * 0.5f;
+		mItemHalfSizes[axis][treeIndex] = ( box.getMax()[axis] - box.getMin()[axis] ) * 0.5f;
+	}
+}
+
 } // namespace cinder
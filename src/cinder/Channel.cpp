@@ -23,6 +23,7 @@
 #include "cinder/Channel.h"
 #include "cinder/ChanTraits.h"
 #include "cinder/ImageIo.h"
+#include "cinder/ip/Statistics.h"
 
 #include <boost/type_traits/is_same.hpp>
 
@@ -116,13 +117,15 @@ ChannelT<T>::Obj::Obj( int32_t aWidth, int32_t aHeight )
 	mIncrement = 1;
 	
 	mOwnsData = true;
-	mData = new T[mWidth * mHeight];
+	mAllocator = PixelAllocator::getDefault();
+	mAllocatedBytes = (size_t)mHeight * mRowBytes;
+	mData = reinterpret_cast<T*>( mAllocator->allocate( mAllocatedBytes ) );
 	mDeallocatorFunc = 0;
 }
 
 template<typename T>
 ChannelT<T>::Obj::Obj( int32_t aWidth, int32_t aHeight, int32_t aRowBytes, uint8_t aIncrement, bool aOwnsData, T *aData )
-	: mWidth( aWidth ), mHeight( aHeight ), mRowBytes( aRowBytes ), mIncrement( aIncrement ), mOwnsData( aOwnsData ), mData( aData )
+	: mWidth( aWidth ), mHeight( aHeight ), mRowBytes( aRowBytes ), mIncrement( aIncrement ), mOwnsData( aOwnsData ), mData( aData ), mAllocatedBytes( 0 )
 {
 	mDeallocatorFunc = 0;
 }
@@ -132,8 +135,12 @@ ChannelT<T>::Obj::~Obj()
 {
 	if( mDeallocatorFunc )
 		(*mDeallocatorFunc)( mDeallocatorRefcon );
-	if( mOwnsData )
-		delete [] mData;
+	if( mOwnsData ) {
+		if( mAllocator )
+			mAllocator->deallocate( mData, mAllocatedBytes );
+		else
+			delete [] mData;
+	}
 }
 
 template<typename T>
@@ -153,12 +160,7 @@ ChannelT<T>::ChannelT( ImageSourceRef imageSource )
 {
 	int32_t width = imageSource->getWidth();
 	int32_t height = imageSource->getHeight();
-	int32_t rowBytes = width * sizeof(T);
-
-	T *data = new T[height * (rowBytes/sizeof(T))];
-
-	mObj = shared_ptr<Obj>( new Obj( width, height, rowBytes, 1, true, data ) );
-	mObj->mOwnsData = true;
+	mObj = shared_ptr<Obj>( new Obj( width, height ) );
 	
 	shared_ptr<ImageTargetChannel<T> > target = ImageTargetChannel<T>::createRef( this );
 	imageSource->load( target );	
@@ -224,27 +226,12 @@ void ChannelT<T>::copyFrom( const ChannelT<T> &srcChannel, const Area &srcArea,
 template<typename T>
 T ChannelT<T>::areaAverage( const Area &area ) const
 {
-	typename CHANTRAIT<T>::Sum sum = 0;
 	const Area clipped( area.getClipBy( getBounds() ) );
 	
 	if( ( clipped.getWidth() <= 0 ) || ( clipped.getHeight() <= 0 ) )
 		return 0;
 
-	uint8_t increment = mObj->mIncrement;
-	int32_t rowBytes = mObj->mRowBytes;
-	
-	const T *line = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( mObj->mData + clipped.x1 * mObj->mIncrement ) + clipped.y1 * mObj->mRowBytes );
-	for( int32_t y = clipped.y1; y < clipped.y2; ++y ) {
-		const T *d = line;
-		for( int32_t x = clipped.x1; x < clipped.x2; ++x ) {
-			sum += *d;
-			d += increment;
-		}
-		
-		line = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( line ) + rowBytes );
-	} 
-	
-	return static_cast<T>( sum / ( clipped.getWidth() * clipped.getHeight() ) );
+	return static_cast<T>( ip::calcSum( *this, clipped ) / ( (double)clipped.getWidth() * clipped.getHeight() ) );
 }
 
 template class ChannelT<uint8_t>;
@@ -25,6 +25,11 @@
 
 #include "cinder/Frustum.h"
 
+#include <algorithm>
+#if defined( CINDER_SSE2 )
+	#include <emmintrin.h>
+#endif
+
 #if defined( CINDER_MSW )
 	#undef NEAR
 	#undef FAR
@@ -138,6 +143,238 @@ bool Frustum<T>::intersects( const AxisAlignedBox3f &box ) const
 	return true;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// Batch culling
+namespace {
+
+template<typename T, typename DataT>
+size_t intersectsSpheresImpl( const Plane<T> *planes, const DataT *centerX, const DataT *centerY, const DataT *centerZ, const DataT *radius, size_t count, uint32_t *resultMask )
+{
+	std::fill( resultMask, resultMask + ( count + 31 ) / 32, 0 );
+
+	size_t visible = 0;
+	for( size_t i = 0; i < count; ++i ) {
+		Vec3<T> center( centerX[i], centerY[i], centerZ[i] );
+		bool inside = true;
+		for( size_t p = 0; p < 6 && inside; ++p )
+			inside = planes[p].distance( center ) >= -radius[i];
+		if( inside ) {
+			resultMask[i >> 5] |= 1u << ( i & 31 );
+			++visible;
+		}
+	}
+
+	return visible;
+}
+
+template<typename T, typename DataT>
+size_t intersectsBoxesImpl( const Plane<T> *planes, const DataT *centerX, const DataT *centerY, const DataT *centerZ, const DataT *halfSizeX, const DataT *halfSizeY, const DataT *halfSizeZ, size_t count, uint32_t *resultMask )
+{
+	std::fill( resultMask, resultMask + ( count + 31 ) / 32, 0 );
+
+	size_t visible = 0;
+	for( size_t i = 0; i < count; ++i ) {
+		Vec3<T> center( centerX[i], centerY[i], centerZ[i] );
+		bool inside = true;
+		// the box is outside a plane if its vertex furthest along the plane normal is behind it
+		for( size_t p = 0; p < 6 && inside; ++p ) {
+			const Vec3<T> &n = planes[p].getNormal();
+			T extent = math<T>::abs( n.x ) * halfSizeX[i] + math<T>::abs( n.y ) * halfSizeY[i] + math<T>::abs( n.z ) * halfSizeZ[i];
+			inside = planes[p].distance( center ) >= -extent;
+		}
+		if( inside ) {
+			resultMask[i >> 5] |= 1u << ( i & 31 );
+			++visible;
+		}
+	}
+
+	return visible;
+}
+
+#if defined( CINDER_SSE2 )
+const int sBitCount4[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+// SSE versions test four spheres or boxes at a time; the remainder is handled by the scalar versions above
+size_t intersectsSpheresImpl( const Plane<float> *planes, const float *centerX, const float *centerY, const float *centerZ, const float *radius, size_t count, uint32_t *resultMask )
+{
+	size_t simdCount = count & ~size_t( 3 );
+	size_t visible = 0;
+	if( simdCount < count ) {
+		uint32_t tailMask;
+		visible = intersectsSpheresImpl<float, float>( planes, centerX + simdCount, centerY + simdCount, centerZ + simdCount, radius + simdCount, count - simdCount, &tailMask );
+		std::fill( resultMask, resultMask + ( count + 31 ) / 32, 0 );
+		resultMask[simdCount >> 5] = tailMask << ( simdCount & 31 );
+	}
+	else
+		std::fill( resultMask, resultMask + ( count + 31 ) / 32, 0 );
+
+	__m128 nx[6], ny[6], nz[6], d[6];
+	for( size_t p = 0; p < 6; ++p ) {
+		nx[p] = _mm_set1_ps( planes[p].getNormal().x );
+		ny[p] = _mm_set1_ps( planes[p].getNormal().y );
+		nz[p] = _mm_set1_ps( planes[p].getNormal().z );
+		d[p] = _mm_set1_ps( planes[p].getDistance() );
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+	for( size_t i = 0; i < simdCount; i += 4 ) {
+		__m128 x = _mm_loadu_ps( centerX + i );
+		__m128 y = _mm_loadu_ps( centerY + i );
+		__m128 z = _mm_loadu_ps( centerZ + i );
+		__m128 negRadius = _mm_sub_ps( zero, _mm_loadu_ps( radius + i ) );
+		__m128 inside = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+		for( size_t p = 0; p < 6; ++p ) {
+			__m128 dist = _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx[p], x ), _mm_mul_ps( ny[p], y ) ), _mm_mul_ps( nz[p], z ) );
+			inside = _mm_and_ps( inside, _mm_cmpge_ps( _mm_sub_ps( dist, d[p] ), negRadius ) );
+		}
+		int bits = _mm_movemask_ps( inside );
+		resultMask[i >> 5] |= uint32_t( bits ) << ( i & 31 );
+		visible += sBitCount4[bits];
+	}
+
+	return visible;
+}
+
+size_t intersectsBoxesImpl( const Plane<float> *planes, const float *centerX, const float *centerY, const float *centerZ, const float *halfSizeX, const float *halfSizeY, const float *halfSizeZ, size_t count, uint32_t *resultMask )
+{
+	size_t simdCount = count & ~size_t( 3 );
+	size_t visible = 0;
+	if( simdCount < count ) {
+		uint32_t tailMask;
+		visible = intersectsBoxesImpl<float, float>( planes, centerX + simdCount, centerY + simdCount, centerZ + simdCount,
+						halfSizeX + simdCount, halfSizeY + simdCount, halfSizeZ + simdCount, count - simdCount, &tailMask );
+		std::fill( resultMask, resultMask + ( count + 31 ) / 32, 0 );
+		resultMask[simdCount >> 5] = tailMask << ( simdCount & 31 );
+	}
+	else
+		std::fill( resultMask, resultMask + ( count + 31 ) / 32, 0 );
+
+	__m128 nx[6], ny[6], nz[6], absNx[6], absNy[6], absNz[6], d[6];
+	for( size_t p = 0; p < 6; ++p ) {
+		const Vec3f &n = planes[p].getNormal();
+		nx[p] = _mm_set1_ps( n.x );
+		ny[p] = _mm_set1_ps( n.y );
+		nz[p] = _mm_set1_ps( n.z );
+		absNx[p] = _mm_set1_ps( math<float>::abs( n.x ) );
+		absNy[p] = _mm_set1_ps( math<float>::abs( n.y ) );
+		absNz[p] = _mm_set1_ps( math<float>::abs( n.z ) );
+		d[p] = _mm_set1_ps( planes[p].getDistance() );
+	}
+
+	for( size_t i = 0; i < simdCount; i += 4 ) {
+		__m128 x = _mm_loadu_ps( centerX + i );
+		__m128 y = _mm_loadu_ps( centerY + i );
+		__m128 z = _mm_loadu_ps( centerZ + i );
+		__m128 hx = _mm_loadu_ps( halfSizeX + i );
+		__m128 hy = _mm_loadu_ps( halfSizeY + i );
+		__m128 hz = _mm_loadu_ps( halfSizeZ + i );
+		__m128 inside = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+		for( size_t p = 0; p < 6; ++p ) {
+			__m128 dist = _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx[p], x ), _mm_mul_ps( ny[p], y ) ), _mm_mul_ps( nz[p], z ) );
+			__m128 extent = _mm_add_ps( _mm_add_ps( _mm_mul_ps( absNx[p], hx ), _mm_mul_ps( absNy[p], hy ) ), _mm_mul_ps( absNz[p], hz ) );
+			inside = _mm_and_ps( inside, _mm_cmpge_ps( _mm_add_ps( _mm_sub_ps( dist, d[p] ), extent ), _mm_setzero_ps() ) );
+		}
+		int bits = _mm_movemask_ps( inside );
+		resultMask[i >> 5] |= uint32_t( bits ) << ( i & 31 );
+		visible += sBitCount4[bits];
+	}
+
+	return visible;
+}
+#endif // defined( CINDER_SSE2 )
+
+} // anonymous namespace
+
+template<typename T>
+size_t Frustum<T>::intersectsSpheres( const T *centerX, const T *centerY, const T *centerZ, const T *radius, size_t count, uint32_t *resultMask ) const
+{
+	return intersectsSpheresImpl( mFrustumPlanes, centerX, centerY, centerZ, radius, count, resultMask );
+}
+
+template<typename T>
+size_t Frustum<T>::intersectsBoxes( const T *centerX, const T *centerY, const T *centerZ, const T *halfSizeX, const T *halfSizeY, const T *halfSizeZ, size_t count, uint32_t *resultMask ) const
+{
+	return intersectsBoxesImpl( mFrustumPlanes, centerX, centerY, centerZ, halfSizeX, halfSizeY, halfSizeZ, count, resultMask );
+}
+
+template<typename T>
+size_t Frustum<T>::intersects( const AxisAlignedBoxTree &tree, uint32_t *resultMask ) const
+{
+	const size_t count = tree.getNumItems();
+	std::fill( resultMask, resultMask + ( count + 31 ) / 32, 0 );
+	if( count == 0 )
+		return 0;
+
+	const std::vector<AxisAlignedBoxTree::Node> &nodes = tree.getNodes();
+	const std::vector<uint32_t> &itemIndices = tree.getItemIndices();
+
+	// each stack entry carries the planes its parent was not fully inside of, so nested nodes skip those tests
+	std::pair<uint32_t, uint32_t> stack[64];
+	size_t stackSize = 0;
+	stack[stackSize++] = std::make_pair( 0u, 0x3Fu );
+
+	size_t visible = 0;
+	while( stackSize > 0 ) {
+		uint32_t nodeIndex = stack[stackSize - 1].first;
+		uint32_t planeMask = stack[stackSize - 1].second;
+		--stackSize;
+		const AxisAlignedBoxTree::Node &node = nodes[nodeIndex];
+
+		bool outside = false;
+		for( uint32_t p = 0; p < 6 && ! outside; ++p ) {
+			if( ! ( planeMask & ( 1u << p ) ) )
+				continue;
+			const Vec3<T> &n = mFrustumPlanes[p].getNormal();
+			T dist = mFrustumPlanes[p].distance( Vec3<T>( node.mCenter ) );
+			T extent = math<T>::abs( n.x ) * node.mHalfSize.x + math<T>::abs( n.y ) * node.mHalfSize.y + math<T>::abs( n.z ) * node.mHalfSize.z;
+			if( dist < -extent )
+				outside = true;
+			else if( dist >= extent )
+				planeMask &= ~( 1u << p );
+		}
+
+		if( outside )
+			continue;
+		else if( planeMask == 0 ) {
+			for( uint32_t i = node.mFirstItem; i < node.mFirstItem + node.mNumItems; ++i )
+				resultMask[itemIndices[i] >> 5] |= 1u << ( itemIndices[i] & 31 );
+			visible += node.mNumItems;
+		}
+		else if( node.mFirstChild ) {
+			stack[stackSize++] = std::make_pair( node.mFirstChild + 1, planeMask );
+			stack[stackSize++] = std::make_pair( node.mFirstChild, planeMask );
+		}
+		else {
+			// leaves hold at most 32 items
+			uint32_t leafMask;
+			const uint32_t first = node.mFirstItem;
+			visible += intersectsBoxesImpl( mFrustumPlanes, tree.getItemCentersX() + first, tree.getItemCentersY() + first, tree.getItemCentersZ() + first,
+								tree.getItemHalfSizesX() + first, tree.getItemHalfSizesY() + first, tree.getItemHalfSizesZ() + first, node.mNumItems, &leafMask );
+			for( uint32_t i = 0; leafMask; ++i, leafMask >>= 1 ) {
+				if( leafMask & 1 )
+					resultMask[itemIndices[first + i] >> 5] |= 1u << ( itemIndices[first + i] & 31 );
+			}
+		}
+	}
+
+	return visible;
+}
+
+template<typename T>
+size_t Frustum<T>::maskToIndices( const uint32_t *mask, size_t count, uint32_t *indices )
+{
+	size_t result = 0;
+	for( size_t word = 0; word < ( count + 31 ) / 32; ++word ) {
+		uint32_t bits = mask[word];
+		for( uint32_t i = (uint32_t)word * 32; bits && i < count; ++i, bits >>= 1 ) {
+			if( bits & 1 )
+				indices[result++] = i;
+		}
+	}
+
+	return result;
+}
+
 template class Frustum<float>;
 template class Frustum<double>;
 
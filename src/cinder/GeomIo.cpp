@@ -24,7 +24,18 @@
 #include "cinder/App/App.h"
 #include "cinder/GeomIo.h"
 #include "cinder/Quaternion.h"
+#include "cinder/Thread.h"
 #include <algorithm>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#if defined( CINDER_SSE2 )
+	#include <emmintrin.h>
+#elif defined( CINDER_NEON )
+	#include <arm_neon.h>
+#endif
 
 using namespace std;
 
@@ -74,6 +85,393 @@ uint8_t	BufferLayout::getAttribDims( Attrib attrib ) const
 	return 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////
+// DataType
+uint8_t dataTypeByteSize( DataType dataType, uint8_t dims )
+{
+	switch( dataType ) {
+		case DataType::DOUBLE: return dims * 8;
+		case DataType::HALF_FLOAT: case DataType::INT16_NORM: case DataType::UINT16_NORM: return ( dims * 2 + 3 ) & ~3;
+		case DataType::INT8_NORM: case DataType::UINT8_NORM: return ( dims + 3 ) & ~3;
+		case DataType::INT_10_10_10_2_NORM: case DataType::UINT_10_10_10_2_NORM: return 4;
+		default: return dims * 4;
+	}
+}
+
+bool isNormalized( DataType dataType )
+{
+	switch( dataType ) {
+		case DataType::INT8_NORM: case DataType::UINT8_NORM: case DataType::INT16_NORM: case DataType::UINT16_NORM:
+		case DataType::INT_10_10_10_2_NORM: case DataType::UINT_10_10_10_2_NORM:
+			return true;
+		default:
+			return false;
+	}
+}
+
+namespace { // conversion kernels for copyData() and unpackData(); each encodes one element held in 4 floats
+
+inline int32_t roundToInt( float v )
+{
+	return int32_t( ( v >= 0 ) ? ( v + 0.5f ) : ( v - 0.5f ) );
+}
+
+// NaN clamps to \a lower, matching _mm_max_ps()
+inline float clampNorm( float v, float lower )
+{
+	return ( v >= lower ) ? ( ( v > 1 ) ? 1 : v ) : lower;
+}
+
+#if ! defined( CINDER_SSE2 )
+// round-to-nearest-even conversion from F. Giesen, "float_to_half_fast3_rtne"
+uint16_t floatToHalf( float f )
+{
+	union { float f; uint32_t u; } in = { f };
+	const uint32_t sign = in.u & 0x80000000u;
+	in.u ^= sign;
+
+	uint16_t result;
+	if( in.u >= ( 127 + 16 ) << 23 ) // overflow to infinity, or NaN
+		result = ( in.u > 0x7f800000u ) ? 0x7e00 : 0x7c00;
+	else if( in.u < ( 127 - 14 ) << 23 ) { // subnormal or zero; let the FPU round the mantissa
+		union { uint32_t u; float f; } magic = { ( ( 127 - 15 ) + ( 23 - 10 ) + 1 ) << 23 };
+		in.f += magic.f;
+		result = uint16_t( in.u - magic.u );
+	}
+	else {
+		const uint32_t mantissaOdd = ( in.u >> 13 ) & 1;
+		in.u += ( uint32_t( 15 - 127 ) << 23 ) + 0xfff + mantissaOdd;
+		result = uint16_t( in.u >> 13 );
+	}
+
+	return result | uint16_t( sign >> 16 );
+}
+#endif // ! defined( CINDER_SSE2 )
+
+float halfToFloat( uint16_t h )
+{
+	union { uint32_t u; float f; } out, magic = { ( 254 - 15 ) << 23 };
+	out.u = ( h & 0x7fffu ) << 13;
+	out.f *= magic.f; // rebias the exponent, handling subnormals
+	if( out.f >= 65536.0f ) // infinity or NaN
+		out.u |= 255 << 23;
+	out.u |= uint32_t( h & 0x8000u ) << 16;
+	return out.f;
+}
+
+inline uint32_t pack1010102( int32_t x, int32_t y, int32_t z, int32_t w )
+{
+	return ( uint32_t( x ) & 0x3ff ) | ( ( uint32_t( y ) & 0x3ff ) << 10 ) | ( ( uint32_t( z ) & 0x3ff ) << 20 ) | ( uint32_t( w ) << 30 );
+}
+
+template<DataType TYPE>
+void encode( const float *v, uint8_t *out );
+
+template<>
+void encode<DataType::FLOAT>( const float *v, uint8_t *out )
+{
+	memcpy( out, v, 4 * sizeof(float) );
+}
+
+#if defined( CINDER_SSE2 )
+
+template<>
+void encode<DataType::HALF_FLOAT>( const float *v, uint8_t *out )
+{
+	// four-wide version of floatToHalf()
+	const __m128 f = _mm_loadu_ps( v );
+	const __m128 sign = _mm_and_ps( f, _mm_castsi128_ps( _mm_set1_epi32( 0x80000000 ) ) );
+	const __m128 absF = _mm_xor_ps( f, sign );
+	const __m128i absBits = _mm_castps_si128( absF );
+
+	const __m128i isNan = _mm_castps_si128( _mm_cmpunord_ps( absF, absF ) );
+	const __m128i isRegular = _mm_cmpgt_epi32( _mm_set1_epi32( ( 127 + 16 ) << 23 ), absBits );
+	const __m128i infOrNan = _mm_or_si128( _mm_and_si128( isNan, _mm_set1_epi32( 0x200 ) ), _mm_set1_epi32( 0x7c00 ) );
+
+	const __m128i isSubnormal = _mm_cmpgt_epi32( _mm_set1_epi32( ( 127 - 14 ) << 23 ), absBits );
+	const __m128i subnormalMagic = _mm_set1_epi32( ( ( 127 - 15 ) + ( 23 - 10 ) + 1 ) << 23 );
+	const __m128i subnormal = _mm_sub_epi32( _mm_castps_si128( _mm_add_ps( absF, _mm_castsi128_ps( subnormalMagic ) ) ), subnormalMagic );
+
+	const __m128i mantissaOdd = _mm_srai_epi32( _mm_slli_epi32( absBits, 31 - 13 ), 31 );
+	const __m128i biased = _mm_sub_epi32( _mm_add_epi32( absBits, _mm_set1_epi32( 0xfff - ( ( 127 - 15 ) << 23 ) ) ), mantissaOdd );
+	const __m128i normal = _mm_srli_epi32( biased, 13 );
+
+	const __m128i finite = _mm_or_si128( _mm_and_si128( isSubnormal, subnormal ), _mm_andnot_si128( isSubnormal, normal ) );
+	__m128i result = _mm_or_si128( _mm_and_si128( isRegular, finite ), _mm_andnot_si128( isRegular, infOrNan ) );
+	result = _mm_or_si128( result, _mm_srai_epi32( _mm_castps_si128( sign ), 16 ) );
+	_mm_storel_epi64( reinterpret_cast<__m128i*>( out ), _mm_packs_epi32( result, result ) );
+}
+
+// four-wide version of roundToInt(); _mm_cvtps_epi32() would round half to even instead
+inline __m128i roundToInt( __m128 v )
+{
+	const __m128 half = _mm_or_ps( _mm_set1_ps( 0.5f ), _mm_and_ps( v, _mm_castsi128_ps( _mm_set1_epi32( 0x80000000 ) ) ) );
+	return _mm_cvttps_epi32( _mm_add_ps( v, half ) );
+}
+
+inline __m128i quantize( const float *v, float lower, float scale )
+{
+	const __m128 clamped = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( v ), _mm_set1_ps( lower ) ), _mm_set1_ps( 1.0f ) );
+	return roundToInt( _mm_mul_ps( clamped, _mm_set1_ps( scale ) ) );
+}
+
+template<>
+void encode<DataType::INT8_NORM>( const float *v, uint8_t *out )
+{
+	const __m128i words = _mm_packs_epi32( quantize( v, -1, 127 ), _mm_setzero_si128() );
+	*reinterpret_cast<int32_t*>( out ) = _mm_cvtsi128_si32( _mm_packs_epi16( words, words ) );
+}
+
+template<>
+void encode<DataType::UINT8_NORM>( const float *v, uint8_t *out )
+{
+	const __m128i words = _mm_packs_epi32( quantize( v, 0, 255 ), _mm_setzero_si128() );
+	*reinterpret_cast<int32_t*>( out ) = _mm_cvtsi128_si32( _mm_packus_epi16( words, words ) );
+}
+
+template<>
+void encode<DataType::INT16_NORM>( const float *v, uint8_t *out )
+{
+	const __m128i ints = quantize( v, -1, 32767 );
+	_mm_storel_epi64( reinterpret_cast<__m128i*>( out ), _mm_packs_epi32( ints, ints ) );
+}
+
+template<>
+void encode<DataType::UINT16_NORM>( const float *v, uint8_t *out )
+{
+	// SSE2 has no unsigned saturating 32 -> 16 pack, so bias into the signed range and flip the top bit back
+	const __m128i biased = _mm_sub_epi32( quantize( v, 0, 65535 ), _mm_set1_epi32( 32768 ) );
+	const __m128i words = _mm_xor_si128( _mm_packs_epi32( biased, biased ), _mm_set1_epi16( (short)0x8000 ) );
+	_mm_storel_epi64( reinterpret_cast<__m128i*>( out ), words );
+}
+
+template<>
+void encode<DataType::INT_10_10_10_2_NORM>( const float *v, uint8_t *out )
+{
+	int32_t ints[4];
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( ints ), roundToInt( _mm_mul_ps( _mm_min_ps( _mm_max_ps( _mm_loadu_ps( v ), _mm_set1_ps( -1 ) ), _mm_set1_ps( 1 ) ), _mm_setr_ps( 511, 511, 511, 1 ) ) ) );
+	*reinterpret_cast<uint32_t*>( out ) = pack1010102( ints[0], ints[1], ints[2], ints[3] );
+}
+
+template<>
+void encode<DataType::UINT_10_10_10_2_NORM>( const float *v, uint8_t *out )
+{
+	int32_t ints[4];
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( ints ), roundToInt( _mm_mul_ps( _mm_min_ps( _mm_max_ps( _mm_loadu_ps( v ), _mm_setzero_ps() ), _mm_set1_ps( 1 ) ), _mm_setr_ps( 1023, 1023, 1023, 3 ) ) ) );
+	*reinterpret_cast<uint32_t*>( out ) = pack1010102( ints[0], ints[1], ints[2], ints[3] );
+}
+
+#else // scalar and NEON
+
+template<>
+void encode<DataType::HALF_FLOAT>( const float *v, uint8_t *out )
+{
+	uint16_t *result = reinterpret_cast<uint16_t*>( out );
+	for( int i = 0; i < 4; ++i )
+		result[i] = floatToHalf( v[i] );
+}
+
+#if defined( CINDER_NEON )
+inline int32x4_t quantize( const float *v, float lower, float scale )
+{
+	const float32x4_t scaled = vmulq_n_f32( vminq_f32( vmaxq_f32( vld1q_f32( v ), vdupq_n_f32( lower ) ), vdupq_n_f32( 1.0f ) ), scale );
+	// vcvtq_s32_f32 truncates, so add 0.5 with the sign of each lane first
+	const uint32x4_t signBits = vandq_u32( vreinterpretq_u32_f32( scaled ), vdupq_n_u32( 0x80000000 ) );
+	const float32x4_t half = vreinterpretq_f32_u32( vorrq_u32( vreinterpretq_u32_f32( vdupq_n_f32( 0.5f ) ), signBits ) );
+	return vcvtq_s32_f32( vaddq_f32( scaled, half ) );
+}
+
+template<>
+void encode<DataType::INT8_NORM>( const float *v, uint8_t *out )
+{
+	const int16x4_t words = vqmovn_s32( quantize( v, -1, 127 ) );
+	vst1_lane_s32( reinterpret_cast<int32_t*>( out ), vreinterpret_s32_s8( vqmovn_s16( vcombine_s16( words, words ) ) ), 0 );
+}
+
+template<>
+void encode<DataType::UINT8_NORM>( const float *v, uint8_t *out )
+{
+	const uint16x4_t words = vqmovun_s32( quantize( v, 0, 255 ) );
+	vst1_lane_u32( reinterpret_cast<uint32_t*>( out ), vreinterpret_u32_u8( vqmovn_u16( vcombine_u16( words, words ) ) ), 0 );
+}
+
+template<>
+void encode<DataType::INT16_NORM>( const float *v, uint8_t *out )
+{
+	vst1_s16( reinterpret_cast<int16_t*>( out ), vqmovn_s32( quantize( v, -1, 32767 ) ) );
+}
+
+template<>
+void encode<DataType::UINT16_NORM>( const float *v, uint8_t *out )
+{
+	vst1_u16( reinterpret_cast<uint16_t*>( out ), vqmovun_s32( quantize( v, 0, 65535 ) ) );
+}
+#else
+template<>
+void encode<DataType::INT8_NORM>( const float *v, uint8_t *out )
+{
+	for( int i = 0; i < 4; ++i )
+		reinterpret_cast<int8_t*>( out )[i] = int8_t( roundToInt( clampNorm( v[i], -1 ) * 127 ) );
+}
+
+template<>
+void encode<DataType::UINT8_NORM>( const float *v, uint8_t *out )
+{
+	for( int i = 0; i < 4; ++i )
+		out[i] = uint8_t( roundToInt( clampNorm( v[i], 0 ) * 255 ) );
+}
+
+template<>
+void encode<DataType::INT16_NORM>( const float *v, uint8_t *out )
+{
+	for( int i = 0; i < 4; ++i )
+		reinterpret_cast<int16_t*>( out )[i] = int16_t( roundToInt( clampNorm( v[i], -1 ) * 32767 ) );
+}
+
+template<>
+void encode<DataType::UINT16_NORM>( const float *v, uint8_t *out )
+{
+	for( int i = 0; i < 4; ++i )
+		reinterpret_cast<uint16_t*>( out )[i] = uint16_t( roundToInt( clampNorm( v[i], 0 ) * 65535 ) );
+}
+#endif // defined( CINDER_NEON )
+
+template<>
+void encode<DataType::INT_10_10_10_2_NORM>( const float *v, uint8_t *out )
+{
+	*reinterpret_cast<uint32_t*>( out ) = pack1010102( roundToInt( clampNorm( v[0], -1 ) * 511 ), roundToInt( clampNorm( v[1], -1 ) * 511 ),
+														roundToInt( clampNorm( v[2], -1 ) * 511 ), roundToInt( clampNorm( v[3], -1 ) ) );
+}
+
+template<>
+void encode<DataType::UINT_10_10_10_2_NORM>( const float *v, uint8_t *out )
+{
+	*reinterpret_cast<uint32_t*>( out ) = pack1010102( roundToInt( clampNorm( v[0], 0 ) * 1023 ), roundToInt( clampNorm( v[1], 0 ) * 1023 ),
+														roundToInt( clampNorm( v[2], 0 ) * 1023 ), roundToInt( clampNorm( v[3], 0 ) * 3 ) );
+}
+
+#endif // defined( CINDER_SSE2 )
+
+template<DataType TYPE, size_t ELEMENT_BYTES>
+void copyDataConvertImpl( uint8_t srcDimensions, const float *srcData, size_t numElements, uint8_t dstDimensions, size_t dstStrideBytes, uint8_t *dstData )
+{
+	static const float sFillerData[4] = { 0, 0, 0, 1 };
+	const uint8_t minDim = std::min( srcDimensions, dstDimensions );
+
+	if( dstStrideBytes == 0 )
+		dstStrideBytes = ELEMENT_BYTES;
+
+	float element[4];
+	uint32_t encoded[4];
+	memcpy( element, sFillerData, sizeof(element) );
+	for( size_t v = 0; v < numElements; ++v ) {
+		for( uint8_t d = 0; d < minDim; ++d )
+			element[d] = srcData[d];
+		encode<TYPE>( element, reinterpret_cast<uint8_t*>( encoded ) );
+		memcpy( dstData, encoded, ELEMENT_BYTES ); // constant size, so this compiles to plain moves
+		srcData += srcDimensions;
+		dstData += dstStrideBytes;
+	}
+}
+
+template<DataType TYPE>
+void copyDataConvertImpl( uint8_t srcDimensions, const float *srcData, size_t numElements, uint8_t dstDimensions, size_t dstStrideBytes, uint8_t *dstData )
+{
+	switch( dataTypeByteSize( TYPE, dstDimensions ) ) {
+		case 4: copyDataConvertImpl<TYPE,4>( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, dstData ); break;
+		case 8: copyDataConvertImpl<TYPE,8>( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, dstData ); break;
+		case 12: copyDataConvertImpl<TYPE,12>( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, dstData ); break;
+		case 16: copyDataConvertImpl<TYPE,16>( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, dstData ); break;
+	}
+}
+
+void copyDataDoubleImpl( uint8_t srcDimensions, const float *srcData, size_t numElements, uint8_t dstDimensions, size_t dstStrideBytes, uint8_t *dstData )
+{
+	static const double sFillerData[4] = { 0, 0, 0, 1 };
+
+	if( dstStrideBytes == 0 )
+		dstStrideBytes = dstDimensions * sizeof(double);
+
+	for( size_t v = 0; v < numElements; ++v ) {
+		double *dst = reinterpret_cast<double*>( dstData );
+		for( uint8_t d = 0; d < dstDimensions; ++d )
+			dst[d] = ( d < srcDimensions ) ? srcData[d] : sFillerData[d];
+		srcData += srcDimensions;
+		dstData += dstStrideBytes;
+	}
+}
+
+inline float decodeComponent( DataType dataType, const uint8_t *data, uint8_t component )
+{
+	switch( dataType ) {
+		case DataType::FLOAT: case DataType::INTEGER: return reinterpret_cast<const float*>( data )[component];
+		case DataType::DOUBLE: return (float)reinterpret_cast<const double*>( data )[component];
+		case DataType::HALF_FLOAT: return halfToFloat( reinterpret_cast<const uint16_t*>( data )[component] );
+		case DataType::INT8_NORM: return std::max( reinterpret_cast<const int8_t*>( data )[component] / 127.0f, -1.0f );
+		case DataType::UINT8_NORM: return data[component] / 255.0f;
+		case DataType::INT16_NORM: return std::max( reinterpret_cast<const int16_t*>( data )[component] / 32767.0f, -1.0f );
+		case DataType::UINT16_NORM: return reinterpret_cast<const uint16_t*>( data )[component] / 65535.0f;
+		case DataType::INT_10_10_10_2_NORM: {
+			const int32_t packed = *reinterpret_cast<const int32_t*>( data );
+			if( component == 3 )
+				return std::max( float( packed >> 30 ), -1.0f );
+			return std::max( float( int32_t( uint32_t( packed ) << ( 22 - component * 10 ) ) >> 22 ) / 511.0f, -1.0f );
+		}
+		case DataType::UINT_10_10_10_2_NORM: {
+			const uint32_t packed = *reinterpret_cast<const uint32_t*>( data );
+			if( component == 3 )
+				return ( packed >> 30 ) / 3.0f;
+			return ( ( packed >> ( component * 10 ) ) & 0x3ff ) / 1023.0f;
+		}
+		default:
+			return 0;
+	}
+}
+
+} // anonymous namespace
+
+void copyData( uint8_t srcDimensions, const float *srcData, size_t numElements, uint8_t dstDimensions, DataType dstDataType, size_t dstStrideBytes, void *dstData )
+{
+	if( srcDimensions < 1 || srcDimensions > 4 )
+		throw ExcIllegalSourceDimensions();
+	if( dstDimensions < 1 || dstDimensions > 4 )
+		throw ExcIllegalDestDimensions();
+
+	uint8_t *dst = reinterpret_cast<uint8_t*>( dstData );
+	switch( dstDataType ) {
+		case DataType::FLOAT: case DataType::INTEGER:
+			if( srcDimensions > 1 && dstDimensions > 1 )
+				copyData( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, reinterpret_cast<float*>( dstData ) );
+			else
+				copyDataConvertImpl<DataType::FLOAT>( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, dst );
+		break;
+		case DataType::DOUBLE: copyDataDoubleImpl( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, dst ); break;
+		case DataType::HALF_FLOAT: copyDataConvertImpl<DataType::HALF_FLOAT>( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, dst ); break;
+		case DataType::INT8_NORM: copyDataConvertImpl<DataType::INT8_NORM>( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, dst ); break;
+		case DataType::UINT8_NORM: copyDataConvertImpl<DataType::UINT8_NORM>( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, dst ); break;
+		case DataType::INT16_NORM: copyDataConvertImpl<DataType::INT16_NORM>( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, dst ); break;
+		case DataType::UINT16_NORM: copyDataConvertImpl<DataType::UINT16_NORM>( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, dst ); break;
+		case DataType::INT_10_10_10_2_NORM: copyDataConvertImpl<DataType::INT_10_10_10_2_NORM>( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, dst ); break;
+		case DataType::UINT_10_10_10_2_NORM: copyDataConvertImpl<DataType::UINT_10_10_10_2_NORM>( srcDimensions, srcData, numElements, dstDimensions, dstStrideBytes, dst ); break;
+	}
+}
+
+void unpackData( DataType srcDataType, uint8_t srcDimensions, size_t srcStrideBytes, const void *srcData, size_t numElements, float *dstData )
+{
+	if( srcDimensions < 1 || srcDimensions > 4 )
+		throw ExcIllegalSourceDimensions();
+
+	if( srcStrideBytes == 0 )
+		srcStrideBytes = dataTypeByteSize( srcDataType, srcDimensions );
+
+	const uint8_t *src = reinterpret_cast<const uint8_t*>( srcData );
+	for( size_t v = 0; v < numElements; ++v ) {
+		for( uint8_t d = 0; d < srcDimensions; ++d )
+			*dstData++ = decodeComponent( srcDataType, src, d );
+		src += srcStrideBytes;
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////
 // Source
 namespace { // these are helper functions for copyData() and copyDataMultAdd
@@ -296,6 +694,122 @@ void Target::generateIndices( Primitive sourcePrimitive, size_t sourceNumIndices
 	copyIndices( sourcePrimitive, indices.get(), sourceNumIndices, requiredBytesPerIndex );
 }
 
+///////////////////////////////////////////////////////////////////////////////////////
+// PrimitiveCache
+namespace {
+
+struct PrimitiveCacheState {
+	typedef std::list<std::pair<std::string, PrimitiveCache::DataRef>>	EntryList;
+
+	PrimitiveCacheState()
+		: mCapacity( 32 * 1024 * 1024 ), mSize( 0 )
+	{}
+
+	// drops least recently used entries until the retained size fits the capacity; requires mMutex
+	void evict()
+	{
+		while( mSize > mCapacity && ! mEntries.empty() ) {
+			mSize -= mEntries.back().second->getByteSize();
+			mLookup.erase( mEntries.back().first );
+			mEntries.pop_back();
+		}
+	}
+
+	std::mutex		mMutex;
+	EntryList		mEntries; // most recently used first
+	std::unordered_map<std::string, EntryList::iterator>	mLookup;
+	size_t			mCapacity, mSize;
+};
+
+// namespace scope rather than function-local, as static local initialization is not thread-safe on all of our compilers
+PrimitiveCacheState sPrimitiveCache;
+
+// moves a Source's scratch storage into the Data handed out by the PrimitiveCache, leaving it empty
+void moveIntoData( PrimitiveCache::Data *data, std::vector<Vec3f> &positions, std::vector<Vec3f> &normals, std::vector<Vec2f> &texCoords,
+	std::vector<Vec3f> &colors, std::vector<uint32_t> &indices )
+{
+	data->mPositions.swap( positions );
+	data->mNormals.swap( normals );
+	data->mTexCoords.swap( texCoords );
+	data->mColors.swap( colors );
+	data->mIndices.swap( indices );
+}
+
+} // anonymous namespace
+
+size_t PrimitiveCache::Data::getByteSize() const
+{
+	return mPositions.size() * sizeof(Vec3f) + mNormals.size() * sizeof(Vec3f) + mTexCoords.size() * sizeof(Vec2f)
+		+ mColors.size() * sizeof(Vec3f) + mIndices.size() * sizeof(uint32_t);
+}
+
+PrimitiveCache::Key& PrimitiveCache::Key::operator<<( const std::set<Attrib> &attribs )
+{
+	// one bit per Attrib; NUM_ATTRIBS is well below 32
+	uint32_t mask = 0;
+	for( auto attrib : attribs )
+		mask |= 1 << attrib;
+	return *this << mask;
+}
+
+PrimitiveCache::DataRef PrimitiveCache::get( const Key &key, const std::function<void( Data *data )> &generate )
+{
+	{
+		lock_guard<mutex> lock( sPrimitiveCache.mMutex );
+		auto it = sPrimitiveCache.mLookup.find( key.getBytes() );
+		if( it != sPrimitiveCache.mLookup.end() ) {
+			sPrimitiveCache.mEntries.splice( sPrimitiveCache.mEntries.begin(), sPrimitiveCache.mEntries, it->second );
+			return it->second->second;
+		}
+	}
+
+	// generate without holding the lock so that unrelated primitives can be built concurrently
+	auto data = make_shared<Data>();
+	generate( data.get() );
+
+	lock_guard<mutex> lock( sPrimitiveCache.mMutex );
+	// another thread may have generated the same primitive meanwhile; keep the first one so instances share it
+	auto it = sPrimitiveCache.mLookup.find( key.getBytes() );
+	if( it != sPrimitiveCache.mLookup.end() )
+		return it->second->second;
+
+	if( sPrimitiveCache.mCapacity > 0 ) {
+		sPrimitiveCache.mEntries.push_front( make_pair( key.getBytes(), DataRef( data ) ) );
+		sPrimitiveCache.mLookup[key.getBytes()] = sPrimitiveCache.mEntries.begin();
+		sPrimitiveCache.mSize += data->getByteSize();
+		sPrimitiveCache.evict();
+	}
+
+	return data;
+}
+
+void PrimitiveCache::setCapacity( size_t bytes )
+{
+	lock_guard<mutex> lock( sPrimitiveCache.mMutex );
+	sPrimitiveCache.mCapacity = bytes;
+	sPrimitiveCache.evict();
+}
+
+size_t PrimitiveCache::getCapacity()
+{
+	lock_guard<mutex> lock( sPrimitiveCache.mMutex );
+	return sPrimitiveCache.mCapacity;
+}
+
+size_t PrimitiveCache::getSize()
+{
+	lock_guard<mutex> lock( sPrimitiveCache.mMutex );
+	return sPrimitiveCache.mSize;
+}
+
+void PrimitiveCache::clear()
+{
+	lock_guard<mutex> lock( sPrimitiveCache.mMutex );
+	sPrimitiveCache.mEntries.clear();
+	sPrimitiveCache.mLookup.clear();
+	sPrimitiveCache.mSize = 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////
 // Rect
 float Rect::sPositions[4*2] = { 0.5f,-0.5f,	-0.5f,-0.5f,	0.5f,0.5f,	-0.5f,0.5f };
@@ -437,6 +951,19 @@ void Icosahedron::calculate() const
 	if( mCalculationsCached )
 		return;
 
+	PrimitiveCache::Key key( "Icosahedron" );
+	key << mEnabledAttribs;
+	mData = PrimitiveCache::get( key, [this]( PrimitiveCache::Data *data ) {
+		calculateImpl();
+		vector<Vec2f> noTexCoords;
+		moveIntoData( data, mPositions, mNormals, noTexCoords, mColors, mIndices );
+	} );
+
+	mCalculationsCached = true;
+}
+
+void Icosahedron::calculateImpl() const
+{
 	// instead of copying the positions, we create 3 unique vertices per face
 	// to make sure the face is flat
 	mPositions.resize( 60, Vec3f::zero() );
@@ -475,8 +1002,6 @@ void Icosahedron::calculate() const
 			mColors[i].z = mPositions[i].z * 0.5f + 0.5f;
 		}
 	}
-
-	mCalculationsCached = true;
 }
 
 uint8_t	Icosahedron::getAttribDims( Attrib attr ) const
@@ -494,13 +1019,13 @@ void Icosahedron::loadInto( Target *target ) const
 {
 	calculate();
 
-	target->copyAttrib( Attrib::POSITION, 3, 0, mPositions.data()->ptr(), mPositions.size() );
+	target->copyAttrib( Attrib::POSITION, 3, 0, mData->mPositions.data()->ptr(), mData->mPositions.size() );
 	if( isEnabled( Attrib::NORMAL ) )
-		target->copyAttrib( Attrib::NORMAL, 3, 0, mNormals.data()->ptr(), mNormals.size() );
+		target->copyAttrib( Attrib::NORMAL, 3, 0, mData->mNormals.data()->ptr(), mData->mNormals.size() );
 	if( isEnabled( Attrib::COLOR ) )
-		target->copyAttrib( Attrib::COLOR, 3, 0, mColors.data()->ptr(), mColors.size() );
+		target->copyAttrib( Attrib::COLOR, 3, 0, mData->mColors.data()->ptr(), mData->mColors.size() );
 
-	target->copyIndices( Primitive::TRIANGLES, mIndices.data(), mIndices.size(), 1 );
+	target->copyIndices( Primitive::TRIANGLES, mData->mIndices.data(), mData->mIndices.size(), 1 );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -576,13 +1101,13 @@ void Teapot::loadInto( Target *target ) const
 {
 	calculate();
 
-	target->copyAttrib( Attrib::POSITION, 3, 0, (const float*)mPositions.data(), mNumVertices );
+	target->copyAttrib( Attrib::POSITION, 3, 0, mData->mPositions.data()->ptr(), mNumVertices );
 	if( isEnabled( Attrib::TEX_COORD_0 ) )
-		target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, (const float*)mTexCoords.data(), mNumVertices );
+		target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, mData->mTexCoords.data()->ptr(), mNumVertices );
 	if( isEnabled( Attrib::NORMAL ) )
-		target->copyAttrib( Attrib::NORMAL, 3, 0, (const float*)mNormals.data(), mNumVertices );
+		target->copyAttrib( Attrib::NORMAL, 3, 0, mData->mNormals.data()->ptr(), mNumVertices );
 
-	target->copyIndices( Primitive::TRIANGLES, mIndices.data(), mNumIndices, 4 );
+	target->copyIndices( Primitive::TRIANGLES, mData->mIndices.data(), mNumIndices, 4 );
 }
 
 size_t Teapot::getNumIndices() const
@@ -616,76 +1141,72 @@ void Teapot::calculate() const
 
 	updateVertexCounts();
 
-	mPositions.resize(mNumVertices*3, 0.f); //= unique_ptr<float[]>( new float[mNumVertices * 3] );
-	mTexCoords.resize(mNumVertices*2, 0.f); //= unique_ptr<float[]>( new float[mNumVertices * 2] );	
-	mNormals.resize(mNumVertices*3, 0.f); //= unique_ptr<float[]>( new float[mNumVertices * 3] );
-	mIndices.resize(mNumIndices, 0); //= unique_ptr<uint32_t[]>( new uint32_t[mNumIndices] );
+	// every attribute is generated regardless of which are enabled, so only the subdivision identifies the data
+	PrimitiveCache::Key key( "Teapot" );
+	key << mSubdivision;
+	mData = PrimitiveCache::get( key, [this]( PrimitiveCache::Data *data ) {
+		data->mPositions.resize( mNumVertices );
+		data->mTexCoords.resize( mNumVertices );
+		data->mNormals.resize( mNumVertices );
+		data->mIndices.resize( mNumIndices );
 
-	generatePatches( mPositions.data(), mNormals.data(), mTexCoords.data(), mIndices.data(), mSubdivision );
+		generatePatches( data->mPositions.data()->ptr(), data->mNormals.data()->ptr(), data->mTexCoords.data()->ptr(), data->mIndices.data(), mSubdivision );
+	} );
 
 	mCalculationsCached = true;
 }
 
+namespace {
+// one copy of a Teapot patch, possibly reflected
+struct TeapotPatchJob {
+	TeapotPatchJob( int patchNum, bool reverseV, const Matrix33f &reflect, bool invertNormal )
+		: mPatchNum( patchNum ), mReverseV( reverseV ), mReflect( reflect ), mInvertNormal( invertNormal )
+	{}
+
+	int			mPatchNum;
+	bool		mReverseV;
+	Matrix33f	mReflect;
+	bool		mInvertNormal;
+};
+} // anonymous namespace
+
 void Teapot::generatePatches( float *v, float *n, float *tc, uint32_t *el, int grid )
 {
 	unique_ptr<float[]> B( new float[4*(grid+1)] );  // Pre-computed Bernstein basis functions
 	unique_ptr<float[]> dB( new float[4*(grid+1)] ); // Pre-computed derivitives of basis functions
-	int idx = 0, elIndex = 0, tcIndex = 0;
 
 	// Pre-compute the basis functions  (Bernstein polynomials)
 	// and their derivatives
 	computeBasisFunctions( B.get(), dB.get(), grid );
 
-	// Build each patch
-	// The rim
-	buildPatchReflect( 0, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, true, true );
-	// The body
-	buildPatchReflect( 1, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, true, true );
-	buildPatchReflect( 2, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, true, true );
-	// The lid
-	buildPatchReflect( 3, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, true, true );
-	buildPatchReflect( 4, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, true, true );
-	// The bottom
-	buildPatchReflect( 5, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, true, true );
-	// The handle
-	buildPatchReflect( 6, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, false, true );
-	buildPatchReflect( 7, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, false, true );
-	// The spout
-	buildPatchReflect( 8, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, false, true );
-	buildPatchReflect( 9, B.get(), dB.get(), v, n, tc, el, idx, elIndex, tcIndex, grid, false, true );
-}
-
-void Teapot::buildPatchReflect( int patchNum, float *B, float *dB, float *v, float *n, float *tc, unsigned int *el,
-	int &index, int &elIndex, int &tcIndex, int grid, bool reflectX, bool reflectY )
-{
-	Vec3f patch[4][4];
-	Vec3f patchRevV[4][4];
-	getPatch( patchNum, patch, false);
-	getPatch( patchNum, patchRevV, true);
-
-	// Patch without modification
-	buildPatch( patchRevV, B, dB, v, n, tc, el, index, elIndex, tcIndex, grid, Matrix33f::identity(), false );
-
-	// Patch reflected in x
-	if( reflectX ) {
-		buildPatch( patch, B, dB, v, n, tc, el, index, elIndex, tcIndex, grid, Matrix33f( Vec3f(-1.0f, 0.0f, 0.0f),
-			Vec3f(0.0f, 1.0f, 0.0f),
-			Vec3f(0.0f, 0.0f, 1.0f) ), true );
+	const Matrix33f reflectX( Vec3f( -1, 0, 0 ), Vec3f( 0, 1, 0 ), Vec3f( 0, 0, 1 ) );
+	const Matrix33f reflectY( Vec3f( 1, 0, 0 ), Vec3f( 0, -1, 0 ), Vec3f( 0, 0, 1 ) );
+	const Matrix33f reflectXY( Vec3f( -1, 0, 0 ), Vec3f( 0, -1, 0 ), Vec3f( 0, 0, 1 ) );
+
+	// The rim, body, lid and bottom (0-5) are reflected in x and y; the handle and spout (6-9) only in y
+	vector<TeapotPatchJob> jobs;
+	for( int patchNum = 0; patchNum < 10; ++patchNum ) {
+		const bool mirrorX = patchNum < 6;
+		jobs.push_back( TeapotPatchJob( patchNum, true, Matrix33f::identity(), false ) );
+		if( mirrorX )
+			jobs.push_back( TeapotPatchJob( patchNum, false, reflectX, true ) );
+		jobs.push_back( TeapotPatchJob( patchNum, false, reflectY, true ) );
+		if( mirrorX )
+			jobs.push_back( TeapotPatchJob( patchNum, true, reflectXY, false ) );
 	}
 
-	// Patch reflected in y
-	if( reflectY ) {
-		buildPatch( patch, B, dB, v, n, tc, el, index, elIndex, tcIndex, grid, Matrix33f( Vec3f(1.0f, 0.0f, 0.0f),
-			Vec3f(0.0f, -1.0f, 0.0f),
-			Vec3f(0.0f, 0.0f, 1.0f) ), true );
-	}
+	// each patch writes to its own fixed range of the output, so they are built in parallel
+	const int numPatchVertices = ( grid + 1 ) * ( grid + 1 );
+	const int numPatchIndices = grid * grid * 6;
+	parallelFor( 0, jobs.size(), std::max( 1, 4096 / numPatchVertices ), [&]( size_t begin, size_t end ) {
+		for( size_t j = begin; j < end; ++j ) {
+			Vec3f patch[4][4];
+			getPatch( jobs[j].mPatchNum, patch, jobs[j].mReverseV );
 
-	// Patch reflected in x and y
-	if( reflectX && reflectY ) {
-		buildPatch( patchRevV, B, dB, v, n, tc, el, index, elIndex, tcIndex, grid, Matrix33f( Vec3f(-1.0f, 0.0f, 0.0f),
-			Vec3f(0.0f, -1.0f, 0.0f),
-			Vec3f(0.0f, 0.0f, 1.0f) ), false );
-	}
+			int index = int( j ) * numPatchVertices * 3, elIndex = int( j ) * numPatchIndices, tcIndex = int( j ) * numPatchVertices * 2;
+			buildPatch( patch, B.get(), dB.get(), v, n, tc, el, index, elIndex, tcIndex, grid, jobs[j].mReflect, jobs[j].mInvertNormal );
+		}
+	} );
 }
 
 void Teapot::buildPatch( Vec3f patch[][4], float *B, float *dB, float *v, float *n, float *tc, 
@@ -917,7 +1438,12 @@ void Sphere::calculate() const
 	// numRings = numSegments / 2
 	int numRings = ( numSegments >> 1 );
 
-	calculateImplUV( numSegments + 1, numRings + 1 );
+	PrimitiveCache::Key key( "Sphere" );
+	key << numSegments << mRadius << mCenter << mEnabledAttribs;
+	mData = PrimitiveCache::get( key, [&]( PrimitiveCache::Data *data ) {
+		calculateImplUV( numSegments + 1, numRings + 1 );
+		moveIntoData( data, mPositions, mNormals, mTexCoords, mColors, mIndices );
+	} );
 	mCalculationsCached = true;
 }
 
@@ -984,13 +1510,13 @@ void Sphere::calculateImplUV( size_t segments, size_t rings ) const
 size_t Sphere::getNumVertices() const
 {
 	calculate();
-	return mPositions.size();
+	return mData->mPositions.size();
 }
 
 size_t Sphere::getNumIndices() const
 {
 	calculate();
-	return mIndices.size();
+	return mData->mIndices.size();
 }
 
 uint8_t Sphere::getAttribDims( Attrib attr ) const
@@ -1009,15 +1535,15 @@ void Sphere::loadInto( Target *target ) const
 {
 	calculate();
 	if( isEnabled( Attrib::POSITION ) )
-		target->copyAttrib( Attrib::POSITION, 3, 0, mPositions.data()->ptr(), mPositions.size() );
+		target->copyAttrib( Attrib::POSITION, 3, 0, mData->mPositions.data()->ptr(), mData->mPositions.size() );
 	if( isEnabled( Attrib::TEX_COORD_0 ) )
-		target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, mTexCoords.data()->ptr(), mTexCoords.size() );
+		target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, mData->mTexCoords.data()->ptr(), mData->mTexCoords.size() );
 	if( isEnabled( Attrib::NORMAL ) )
-		target->copyAttrib( Attrib::NORMAL, 3, 0, mNormals.data()->ptr(), mNormals.size() );
+		target->copyAttrib( Attrib::NORMAL, 3, 0, mData->mNormals.data()->ptr(), mData->mNormals.size() );
 	if( isEnabled( Attrib::COLOR ) )
-		target->copyAttrib( Attrib::COLOR, 3, 0, mColors.data()->ptr(), mColors.size() );
+		target->copyAttrib( Attrib::COLOR, 3, 0, mData->mColors.data()->ptr(), mData->mColors.size() );
 
-	target->copyIndices( Primitive::TRIANGLES, mIndices.data(), mIndices.size(), 4 );
+	target->copyIndices( Primitive::TRIANGLES, mData->mIndices.data(), mData->mIndices.size(), 4 );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -1036,6 +1562,18 @@ void Icosphere::calculate() const
 	if( mCalculationsCached )
 		return;
 
+	PrimitiveCache::Key key( "Icosphere" );
+	key << mSubdivision << mEnabledAttribs;
+	mData = PrimitiveCache::get( key, [this]( PrimitiveCache::Data *data ) {
+		calculateImpl();
+		moveIntoData( data, mPositions, mNormals, mTexCoords, mColors, mIndices );
+	} );
+
+	mCalculationsCached = true;
+}
+
+void Icosphere::calculateImpl() const
+{
 	// start by copying the base icosahedron in its entirety (vertices are shared among faces)
 	mPositions.assign( reinterpret_cast<Vec3f*>(sPositions), reinterpret_cast<Vec3f*>(sPositions) + 12 );
 	mNormals.assign( reinterpret_cast<Vec3f*>(sPositions), reinterpret_cast<Vec3f*>(sPositions) + 12 );
@@ -1061,8 +1599,6 @@ void Icosphere::calculate() const
 
 	// calculate texture coords based on equirectangular texture map
 	calculateImplUV();
-
-	mCalculationsCached = true;
 }
 
 void Icosphere::calculateImplUV() const
@@ -1112,46 +1648,43 @@ void Icosphere::calculateImplUV() const
 void Icosphere::subdivide() const
 {
 	for( int j = 0; j < mSubdivision; ++j ) {
-		mPositions.reserve( mPositions.size() + mIndices.size() );
-		mNormals.reserve( mNormals.size() + mIndices.size() );
-		mIndices.reserve( mIndices.size() * 4 );
-
-		const int numTriangles = mIndices.size() / 3;
-		for( int i = 0; i < numTriangles; ++i ) {
-			uint32_t index0 = mIndices[i * 3 + 0];
-			uint32_t index1 = mIndices[i * 3 + 1];
-			uint32_t index2 = mIndices[i * 3 + 2];
-
-			uint32_t index3 = mPositions.size();
-			uint32_t index4 = index3 + 1;
-			uint32_t index5 = index4 + 1;
-
-			// add new triangles
-			mIndices[i * 3 + 1] = index3;
-			mIndices[i * 3 + 2] = index5;
-
-			mIndices.push_back( index3 );
-			mIndices.push_back( index1 );
-			mIndices.push_back( index4 );
-
-			mIndices.push_back( index5 );
-			mIndices.push_back( index3 );
-			mIndices.push_back( index4 );
-
-			mIndices.push_back( index5 );
-			mIndices.push_back( index4 );
-			mIndices.push_back( index2 );
-
-			// add new positions
-			mPositions.push_back( 0.5f * (mPositions[index0] + mPositions[index1]) );
-			mPositions.push_back( 0.5f * (mPositions[index1] + mPositions[index2]) );
-			mPositions.push_back( 0.5f * (mPositions[index2] + mPositions[index0]) );
-
-			// add new normals
-			mNormals.push_back( 0.5f * (mNormals[index0] + mNormals[index1]) );
-			mNormals.push_back( 0.5f * (mNormals[index1] + mNormals[index2]) );
-			mNormals.push_back( 0.5f * (mNormals[index2] + mNormals[index0]) );
-		}
+		const size_t numTriangles = mIndices.size() / 3;
+		const size_t numPositions = mPositions.size();
+		mPositions.resize( numPositions + numTriangles * 3 );
+		mNormals.resize( numPositions + numTriangles * 3 );
+		mIndices.resize( numTriangles * 12 );
+
+		// every triangle owns a fixed range of the new vertices and triangles, so they can be split in parallel
+		parallelFor( 0, numTriangles, 8192, [&]( size_t begin, size_t end ) {
+			for( size_t i = begin; i < end; ++i ) {
+				uint32_t index0 = mIndices[i * 3 + 0];
+				uint32_t index1 = mIndices[i * 3 + 1];
+				uint32_t index2 = mIndices[i * 3 + 2];
+
+				uint32_t index3 = uint32_t( numPositions + i * 3 );
+				uint32_t index4 = index3 + 1;
+				uint32_t index5 = index4 + 1;
+
+				// add new triangles
+				mIndices[i * 3 + 1] = index3;
+				mIndices[i * 3 + 2] = index5;
+
+				uint32_t *indices = &mIndices[numTriangles * 3 + i * 9];
+				indices[0] = index3; indices[1] = index1; indices[2] = index4;
+				indices[3] = index5; indices[4] = index3; indices[5] = index4;
+				indices[6] = index5; indices[7] = index4; indices[8] = index2;
+
+				// add new positions
+				mPositions[index3] = 0.5f * (mPositions[index0] + mPositions[index1]);
+				mPositions[index4] = 0.5f * (mPositions[index1] + mPositions[index2]);
+				mPositions[index5] = 0.5f * (mPositions[index2] + mPositions[index0]);
+
+				// add new normals
+				mNormals[index3] = 0.5f * (mNormals[index0] + mNormals[index1]);
+				mNormals[index4] = 0.5f * (mNormals[index1] + mNormals[index2]);
+				mNormals[index5] = 0.5f * (mNormals[index2] + mNormals[index0]);
+			}
+		} );
 	}
 }
 
@@ -1171,15 +1704,15 @@ void Icosphere::loadInto( Target *target ) const
 {
 	calculate();
 
-	target->copyAttrib( Attrib::POSITION, 3, 0, mPositions.data()->ptr(), mPositions.size() );
+	target->copyAttrib( Attrib::POSITION, 3, 0, mData->mPositions.data()->ptr(), mData->mPositions.size() );
 	if( isEnabled( Attrib::TEX_COORD_0 ) )
-		target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, mTexCoords.data()->ptr(), mTexCoords.size() );
+		target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, mData->mTexCoords.data()->ptr(), mData->mTexCoords.size() );
 	if( isEnabled( Attrib::NORMAL ) )
-		target->copyAttrib( Attrib::NORMAL, 3, 0, mNormals.data()->ptr(), mNormals.size() );
+		target->copyAttrib( Attrib::NORMAL, 3, 0, mData->mNormals.data()->ptr(), mData->mNormals.size() );
 	if( isEnabled( Attrib::COLOR ) )
-		target->copyAttrib( Attrib::COLOR, 3, 0, mColors.data()->ptr(), mColors.size() );
+		target->copyAttrib( Attrib::COLOR, 3, 0, mData->mColors.data()->ptr(), mData->mColors.size() );
 
-	target->copyIndices( Primitive::TRIANGLES, mIndices.data(), mIndices.size(), 4 );
+	target->copyIndices( Primitive::TRIANGLES, mData->mIndices.data(), mData->mIndices.size(), 4 );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -1218,7 +1751,12 @@ void Capsule::calculate() const
 	// numRings = numSegments / 2 and should always be an even number
 	int numRings = ( numSegments >> 2 ) << 1;
 
-	calculateImplUV( numSegments + 1, numRings + 1 );
+	PrimitiveCache::Key key( "Capsule" );
+	key << numSegments << mNumSlices << mRadius << mLength << mCenter << mDirection << mEnabledAttribs;
+	mData = PrimitiveCache::get( key, [&]( PrimitiveCache::Data *data ) {
+		calculateImplUV( numSegments + 1, numRings + 1 );
+		moveIntoData( data, mPositions, mNormals, mTexCoords, mColors, mIndices );
+	} );
 	mCalculationsCached = true;
 }
 
@@ -1302,7 +1840,7 @@ void Capsule::calculateRing( size_t segments, float radius, float y, float dy )
 
 Torus::Torus()
 	: mCenter( 0, 0, 0), mRadiusMajor( 1.0f ), mRadiusMinor( 0.75f ), mCoils( 1 ), mHeight( 0 )
-	, mNumSegmentsAxis( 18 ), mNumSegmentsRing( 18 ), mTwist( 0 ), mTwistOffset( 0 )
+	, mNumSegmentsAxis( 18 ), mNumSegmentsRing( 18 ), mTwist( 0 ), mTwistOffset( 0 ), mCalculationsCached( false )
 {
 	enable( Attrib::POSITION );
 	enable( Attrib::NORMAL );
@@ -1322,7 +1860,12 @@ void Torus::calculate() const
 	if( numRing < 3 )
 		numRing = std::max( 12, (int)math<double>::floor( mRadiusMajor * float(M_PI * 2) ) );
 
-	calculateImplUV( numAxis + 1, numRing + 1 );
+	PrimitiveCache::Key key( "Torus" );
+	key << numAxis << numRing << mCenter << mRadiusMajor << mRadiusMinor << mHeight << mCoils << mTwist << mTwistOffset << mEnabledAttribs;
+	mData = PrimitiveCache::get( key, [&]( PrimitiveCache::Data *data ) {
+		calculateImplUV( numAxis + 1, numRing + 1 );
+		moveIntoData( data, mPositions, mNormals, mTexCoords, mColors, mIndices );
+	} );
 	mCalculationsCached = true;
 }
 
@@ -1403,22 +1946,22 @@ void Torus::loadInto( Target *target ) const
 {
 	calculate();
 
-	target->copyAttrib( Attrib::POSITION, 3, 0, mPositions.data()->ptr(), mPositions.size() );
+	target->copyAttrib( Attrib::POSITION, 3, 0, mData->mPositions.data()->ptr(), mData->mPositions.size() );
 	if( isEnabled( Attrib::TEX_COORD_0 ) )
-		target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, mTexCoords.data()->ptr(), mTexCoords.size() );
+		target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, mData->mTexCoords.data()->ptr(), mData->mTexCoords.size() );
 	if( isEnabled( Attrib::NORMAL ) )
-		target->copyAttrib( Attrib::NORMAL, 3, 0, mNormals.data()->ptr(), mNormals.size() );
+		target->copyAttrib( Attrib::NORMAL, 3, 0, mData->mNormals.data()->ptr(), mData->mNormals.size() );
 	if( isEnabled( Attrib::COLOR ) )
-		target->copyAttrib( Attrib::COLOR, 3, 0, mColors.data()->ptr(), mColors.size() );
+		target->copyAttrib( Attrib::COLOR, 3, 0, mData->mColors.data()->ptr(), mData->mColors.size() );
 
-	target->copyIndices( Primitive::TRIANGLES, mIndices.data(), mIndices.size(), 4 );
+	target->copyIndices( Primitive::TRIANGLES, mData->mIndices.data(), mData->mIndices.size(), 4 );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
 // Cylinder
 
 Cylinder::Cylinder()
-	: mOrigin( 0, 0, 0 ), mHeight( 2.0f ), mDirection( 0, 1, 0 ), mRadiusBase( 1.0f ), mRadiusApex( 1.0f ), mNumSegments( 18 ), mNumSlices( 6 )
+	: mOrigin( 0, 0, 0 ), mHeight( 2.0f ), mDirection( 0, 1, 0 ), mRadiusBase( 1.0f ), mRadiusApex( 1.0f ), mNumSegments( 18 ), mNumSlices( 6 ), mCalculationsCached( false )
 {
 	enable( Attrib::POSITION );
 	enable( Attrib::NORMAL );
@@ -1447,7 +1990,12 @@ void Cylinder::calculate() const
 	}
 	int numSlices = math<int>::max( mNumSlices, 1 );
 
-	calculateImplUV( numSegments + 1, numSlices + 1 );
+	PrimitiveCache::Key key( "Cylinder" );
+	key << numSegments << numSlices << mOrigin << mHeight << mDirection << mRadiusBase << mRadiusApex << mEnabledAttribs;
+	mData = PrimitiveCache::get( key, [&]( PrimitiveCache::Data *data ) {
+		calculateImplUV( numSegments + 1, numSlices + 1 );
+		moveIntoData( data, mPositions, mNormals, mTexCoords, mColors, mIndices );
+	} );
 	mCalculationsCached = true;
 }
 
@@ -1583,15 +2131,15 @@ void Cylinder::loadInto( Target *target ) const
 {
 	calculate();
 
-	target->copyAttrib( Attrib::POSITION, 3, 0, mPositions.data()->ptr(), mPositions.size() );
+	target->copyAttrib( Attrib::POSITION, 3, 0, mData->mPositions.data()->ptr(), mData->mPositions.size() );
 	if( isEnabled( Attrib::TEX_COORD_0 ) )
-		target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, mTexCoords.data()->ptr(), mTexCoords.size() );
+		target->copyAttrib( Attrib::TEX_COORD_0, 2, 0, mData->mTexCoords.data()->ptr(), mData->mTexCoords.size() );
 	if( isEnabled( Attrib::NORMAL ) )
-		target->copyAttrib( Attrib::NORMAL, 3, 0, mNormals.data()->ptr(), mNormals.size() );
+		target->copyAttrib( Attrib::NORMAL, 3, 0, mData->mNormals.data()->ptr(), mData->mNormals.size() );
 	if( isEnabled( Attrib::COLOR ) )
-		target->copyAttrib( Attrib::COLOR, 3, 0, mColors.data()->ptr(), mColors.size() );
+		target->copyAttrib( Attrib::COLOR, 3, 0, mData->mColors.data()->ptr(), mData->mColors.size() );
 
-	target->copyIndices( Primitive::TRIANGLES, mIndices.data(), mIndices.size(), 4 );
+	target->copyIndices( Primitive::TRIANGLES, mData->mIndices.data(), mData->mIndices.size(), 4 );
 }
 
 
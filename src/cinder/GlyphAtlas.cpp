@@ -0,0 +1,277 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/GlyphAtlas.h"
+#include "cinder/ip/Fill.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+// shelves are opened at a multiple of this height so that glyphs of similar heights can share them
+const int32_t SHELF_HEIGHT_ROUNDING = 4;
+
+inline int32_t roundShelfHeight( int32_t height )
+{
+	return ( height + SHELF_HEIGHT_ROUNDING - 1 ) / SHELF_HEIGHT_ROUNDING * SHELF_HEIGHT_ROUNDING;
+}
+
+// whether a glyph of \a height may be placed on an occupied shelf of \a shelfHeight without wasting too much of it
+inline bool shelfHeightFits( int32_t shelfHeight, int32_t height )
+{
+	return ( shelfHeight >= height ) && ( shelfHeight - height <= std::max( SHELF_HEIGHT_ROUNDING, height / 2 ) );
+}
+
+} // anonymous namespace
+
+GlyphAtlas::GlyphAtlas( int32_t pageWidth, int32_t pageHeight, size_t maxPages, int32_t padding )
+	: mPageWidth( pageWidth ), mPageHeight( pageHeight ), mPadding( padding ), mMaxPages( std::max<size_t>( maxPages, 1 ) ), mUse( 1 )
+{
+}
+
+void GlyphAtlas::beginUse()
+{
+	++mUse;
+}
+
+const GlyphAtlas::Entry* GlyphAtlas::find( Glyph glyph )
+{
+	auto slotIt = mEntries.find( glyph );
+	if( slotIt == mEntries.end() )
+		return NULL;
+
+	touch( slotIt->second );
+	return &slotIt->second.mEntry;
+}
+
+const GlyphAtlas::Entry* GlyphAtlas::insert( Glyph glyph, const Channel8u &coverage, const Vec2f &originOffset )
+{
+	erase( glyph );
+
+	Slot slot;
+	slot.mEntry.mPage = 0;
+	slot.mEntry.mOriginOffset = originOffset;
+	slot.mLastUse = mUse;
+	slot.mLruIt = mLru.end();
+	if( coverage && ( coverage.getWidth() > 0 ) && ( coverage.getHeight() > 0 ) ) {
+		if( ! allocate( coverage.getWidth() + mPadding, coverage.getHeight() + mPadding, &slot.mEntry.mPage, &slot.mAllocated ) )
+			return NULL;
+
+		Page &page = mPages[slot.mEntry.mPage];
+		slot.mEntry.mArea = Area( slot.mAllocated.getUL(), slot.mAllocated.getUL() + coverage.getSize() );
+		// clear the padding too, which may hold an evicted glyph
+		ip::fill<uint8_t>( &page.mChannel, 0, slot.mAllocated );
+		page.mChannel.copyFrom( coverage, coverage.getBounds(), slot.mEntry.mArea.getUL() );
+		if( page.mDirtyArea.calcArea() == 0 )
+			page.mDirtyArea = slot.mAllocated;
+		else
+			page.mDirtyArea.include( slot.mAllocated );
+
+		mLru.push_front( glyph );
+		slot.mLruIt = mLru.begin();
+	}
+	else {
+		slot.mEntry.mArea = slot.mAllocated = Area( 0, 0, 0, 0 );
+	}
+
+	return &mEntries.insert( make_pair( glyph, slot ) ).first->second.mEntry;
+}
+
+void GlyphAtlas::erase( Glyph glyph )
+{
+	auto slotIt = mEntries.find( glyph );
+	if( slotIt == mEntries.end() )
+		return;
+
+	if( slotIt->second.mLruIt != mLru.end() ) {
+		release( slotIt->second );
+		mLru.erase( slotIt->second.mLruIt );
+	}
+	mEntries.erase( slotIt );
+}
+
+vector<GlyphAtlas::Glyph> GlyphAtlas::takeEvicted()
+{
+	vector<Glyph> result;
+	result.swap( mEvicted );
+	return result;
+}
+
+void GlyphAtlas::touch( Slot &slot )
+{
+	slot.mLastUse = mUse;
+	if( slot.mLruIt != mLru.end() )
+		mLru.splice( mLru.begin(), mLru, slot.mLruIt );
+}
+
+bool GlyphAtlas::allocate( int32_t width, int32_t height, size_t *resultPage, Area *resultArea )
+{
+	if( ( width > mPageWidth ) || ( height > mPageHeight ) )
+		return false;
+
+	while( true ) {
+		for( size_t p = 0; p < mPages.size(); ++p ) {
+			if( allocateOnPage( p, width, height, resultArea ) ) {
+				*resultPage = p;
+				return true;
+			}
+		}
+
+		if( mPages.size() < mMaxPages ) {
+			Page page;
+			page.mChannel = Channel8u( mPageWidth, mPageHeight );
+			ip::fill<uint8_t>( &page.mChannel, 0 );
+			page.mShelvesHeight = 0;
+			// a new page needs to be uploaded in full
+			page.mDirtyArea = page.mChannel.getBounds();
+			mPages.push_back( page );
+		}
+		else if( ! evictLeastRecentlyUsed() )
+			return false;
+	}
+}
+
+bool GlyphAtlas::allocateOnPage( size_t pageIdx, int32_t width, int32_t height, Area *resultArea )
+{
+	Page &page = mPages[pageIdx];
+
+	// prefer the occupied shelf wasting the least height, then the first empty one tall enough, and otherwise open a new one
+	size_t bestShelf = page.mShelves.size(), bestSpan = 0;
+	for( size_t s = 0; s < page.mShelves.size(); ++s ) {
+		const Shelf &shelf = page.mShelves[s];
+		const bool occupied = shelf.mNumGlyphs > 0;
+		if( occupied ? ! shelfHeightFits( shelf.mHeight, height ) : ( shelf.mHeight < height ) )
+			continue;
+		if( bestShelf < page.mShelves.size() ) {
+			const Shelf &best = page.mShelves[bestShelf];
+			if( ( best.mNumGlyphs > 0 ) ? ( ! occupied || ( shelf.mHeight >= best.mHeight ) ) : ! occupied )
+				continue;
+		}
+		for( size_t span = 0; span < shelf.mFreeSpans.size(); ++span ) {
+			if( shelf.mFreeSpans[span].second - shelf.mFreeSpans[span].first >= width ) {
+				bestShelf = s;
+				bestSpan = span;
+				break;
+			}
+		}
+	}
+
+	if( bestShelf == page.mShelves.size() ) {
+		const int32_t shelfHeight = std::min( roundShelfHeight( height ), mPageHeight - page.mShelvesHeight );
+		if( shelfHeight < height )
+			return false;
+		Shelf shelf;
+		shelf.mY = page.mShelvesHeight;
+		shelf.mHeight = shelfHeight;
+		shelf.mFreeSpans.push_back( make_pair( 0, mPageWidth ) );
+		shelf.mNumGlyphs = 0;
+		page.mShelves.push_back( shelf );
+		page.mShelvesHeight += shelfHeight;
+		bestSpan = 0;
+	}
+	else if( page.mShelves[bestShelf].mNumGlyphs == 0 ) {
+		// give the rest of an empty shelf taller than needed its own shelf
+		Shelf &shelf = page.mShelves[bestShelf];
+		const int32_t shelfHeight = roundShelfHeight( height );
+		if( shelf.mHeight > shelfHeight ) {
+			Shelf rest;
+			rest.mY = shelf.mY + shelfHeight;
+			rest.mHeight = shelf.mHeight - shelfHeight;
+			rest.mFreeSpans.push_back( make_pair( 0, mPageWidth ) );
+			rest.mNumGlyphs = 0;
+			shelf.mHeight = shelfHeight;
+			page.mShelves.insert( page.mShelves.begin() + bestShelf + 1, rest );
+		}
+	}
+
+	Shelf &shelf = page.mShelves[bestShelf];
+	pair<int32_t,int32_t> &span = shelf.mFreeSpans[bestSpan];
+	*resultArea = Area( span.first, shelf.mY, span.first + width, shelf.mY + height );
+	span.first += width;
+	if( span.first == span.second )
+		shelf.mFreeSpans.erase( shelf.mFreeSpans.begin() + bestSpan );
+	++shelf.mNumGlyphs;
+	return true;
+}
+
+bool GlyphAtlas::evictLeastRecentlyUsed()
+{
+	if( mLru.empty() )
+		return false;
+
+	// everything used more recently than the back of the list is in use too
+	const Glyph glyph = mLru.back();
+	auto slotIt = mEntries.find( glyph );
+	if( slotIt->second.mLastUse == mUse )
+		return false;
+
+	release( slotIt->second );
+	mLru.pop_back();
+	mEntries.erase( slotIt );
+	mEvicted.push_back( glyph );
+	return true;
+}
+
+void GlyphAtlas::release( const Slot &slot )
+{
+	Page &page = mPages[slot.mEntry.mPage];
+	size_t s = 0;
+	while( page.mShelves[s].mY != slot.mAllocated.y1 )
+		++s;
+
+	// return the span, merging it with its neighbors
+	Shelf &shelf = page.mShelves[s];
+	const pair<int32_t,int32_t> released( slot.mAllocated.x1, slot.mAllocated.x2 );
+	auto spanIt = shelf.mFreeSpans.insert( std::lower_bound( shelf.mFreeSpans.begin(), shelf.mFreeSpans.end(), released ), released );
+	if( ( spanIt + 1 != shelf.mFreeSpans.end() ) && ( ( spanIt + 1 )->first == spanIt->second ) ) {
+		spanIt->second = ( spanIt + 1 )->second;
+		shelf.mFreeSpans.erase( spanIt + 1 );
+	}
+	if( ( spanIt != shelf.mFreeSpans.begin() ) && ( ( spanIt - 1 )->second == spanIt->first ) ) {
+		( spanIt - 1 )->second = spanIt->second;
+		shelf.mFreeSpans.erase( spanIt );
+	}
+
+	if( --shelf.mNumGlyphs > 0 )
+		return;
+
+	// merge the now empty shelf with empty neighbors, and drop empty shelves from the bottom of the page
+	if( ( s + 1 < page.mShelves.size() ) && ( page.mShelves[s + 1].mNumGlyphs == 0 ) ) {
+		page.mShelves[s].mHeight += page.mShelves[s + 1].mHeight;
+		page.mShelves.erase( page.mShelves.begin() + s + 1 );
+	}
+	if( ( s > 0 ) && ( page.mShelves[s - 1].mNumGlyphs == 0 ) ) {
+		page.mShelves[s - 1].mHeight += page.mShelves[s].mHeight;
+		page.mShelves.erase( page.mShelves.begin() + s );
+	}
+	if( page.mShelves.back().mNumGlyphs == 0 ) {
+		page.mShelvesHeight -= page.mShelves.back().mHeight;
+		page.mShelves.pop_back();
+	}
+}
+
+} // namespace cinder
@@ -166,6 +166,101 @@ size_t ImageSource::getRowBytes() const
 	return getWidth() * ImageIo::channelOrderNumChannels( getChannelOrder() ) * ImageIo::dataTypeBytes( getDataType() );
 }
 
+Area ImageSource::Options::calcRegion( int32_t fullWidth, int32_t fullHeight ) const
+{
+	const Area bounds( 0, 0, fullWidth, fullHeight );
+	if( mRegion.getWidth() <= 0 || mRegion.getHeight() <= 0 )
+		return bounds;
+	else
+		return mRegion.getClipBy( bounds );
+}
+
+int32_t ImageSource::Options::calcScaleDenominator( int32_t regionWidth, int32_t regionHeight ) const
+{
+	// the largest denominator whose rounded-up size still covers the target size
+	if( mTargetSize.x > 0 || mTargetSize.y > 0 ) {
+		int32_t denominator = 1;
+		while( denominator < 8 && ( regionWidth + denominator * 2 - 1 ) / ( denominator * 2 ) >= mTargetSize.x && ( regionHeight + denominator * 2 - 1 ) / ( denominator * 2 ) >= mTargetSize.y )
+			denominator *= 2;
+		return denominator;
+	}
+	else if( mScaleDenominator >= 8 )
+		return 8;
+	else if( mScaleDenominator >= 4 )
+		return 4;
+	else if( mScaleDenominator >= 2 )
+		return 2;
+	else
+		return 1;
+}
+
+void ImageSource::setupReduction( int32_t fullWidth, int32_t fullHeight, const Options &options )
+{
+	mReductionRegion = options.calcRegion( fullWidth, fullHeight );
+	if( mReductionRegion.getWidth() <= 0 || mReductionRegion.getHeight() <= 0 )
+		throw ImageIoExceptionFailedLoad( "Requested region lies outside the image." );
+	mReductionScale = options.calcScaleDenominator( mReductionRegion.getWidth(), mReductionRegion.getHeight() );
+	mReduced = ( mReductionScale != 1 ) || ! ( mReductionRegion == Area( 0, 0, fullWidth, fullHeight ) );
+
+	setSize( ( mReductionRegion.getWidth() + mReductionScale - 1 ) / mReductionScale, ( mReductionRegion.getHeight() + mReductionScale - 1 ) / mReductionScale );
+}
+
+namespace {
+template<typename T>
+inline T averageToChannel( float average ) { return (T)( average + 0.5f ); }
+template<>
+inline float averageToChannel<float>( float average ) { return average; }
+} // anonymous namespace
+
+template<typename SD>
+void ImageSource::processRowScaled( RowFunc func, ImageTargetRef target, int32_t sourceRow, const void *data )
+{
+	const int32_t scale = mReductionScale;
+	const int32_t inc = mCustomPixelInc ? mCustomPixelInc : channelOrderNumChannels( mChannelOrder );
+	const int32_t regionWidth = mReductionRegion.getWidth();
+	const int32_t blockRow = ( sourceRow - mReductionRegion.y1 ) % scale;
+	if( blockRow == 0 )
+		mReductionSums.assign( mWidth * inc, 0.0f );
+
+	const SD *src = reinterpret_cast<const SD*>( data );
+	for( int32_t x = 0; x < regionWidth; ++x ) {
+		float *sums = &mReductionSums[( x / scale ) * inc];
+		for( int32_t c = 0; c < inc; ++c )
+			sums[c] += src[c];
+		src += inc;
+	}
+
+	// once the block's last row has arrived, average it into a row of the source's own layout for the row function
+	if( blockRow == scale - 1 || sourceRow == mReductionRegion.y2 - 1 ) {
+		mReductionRow.resize( mWidth * inc * sizeof(SD) );
+		SD *out = reinterpret_cast<SD*>( &mReductionRow[0] );
+		for( int32_t x = 0; x < mWidth; ++x ) {
+			const float invCount = 1.0f / ( ( blockRow + 1 ) * std::min( scale, regionWidth - x * scale ) );
+			for( int32_t c = 0; c < inc; ++c )
+				out[x * inc + c] = averageToChannel<SD>( mReductionSums[x * inc + c] * invCount );
+		}
+		((*this).*func)( target, ( sourceRow - mReductionRegion.y1 ) / scale, out );
+	}
+}
+
+void ImageSource::processRow( RowFunc func, ImageTargetRef target, int32_t sourceRow, const void *data )
+{
+	if( sourceRow < mReductionRegion.y1 || sourceRow >= mReductionRegion.y2 )
+		return;
+
+	if( mReductionScale == 1 )
+		((*this).*func)( target, sourceRow - mReductionRegion.y1, data );
+	else {
+		switch( getDataType() ) {
+			case UINT8: processRowScaled<uint8_t>( func, target, sourceRow, data ); break;
+			case UINT16: processRowScaled<uint16_t>( func, target, sourceRow, data ); break;
+			case FLOAT32: processRowScaled<float>( func, target, sourceRow, data ); break;
+			default:
+				throw ImageIoExceptionIllegalDataType( "Unknown data type." );
+		}
+	}
+}
+
 /* SD - source data type, TD - target data type, TCM - target color model */
 template<typename SD, typename TD, ImageIo::ColorModel TCM, bool ALPHA>
 void ImageSource::rowFuncSourceRgb( ImageTargetRef target, int32_t row, const void *data )
@@ -251,7 +346,7 @@ void ImageSource::rowFuncSourceGray( ImageTargetRef target, int32_t row, const v
 	else if( TCM == CM_GRAY ) {
 		if( ALPHA ) {
 			for( int32_t c = 0; c < width; c++ ) {
-				targetData[mRowFuncTargetGray]	= CHANTRAIT<TD>::convert( sourceData[mRowFuncTargetGray] );
+				targetData[mRowFuncTargetGray]	= CHANTRAIT<TD>::convert( sourceData[mRowFuncSourceGray] );
 				targetData[mRowFuncTargetAlpha]	= CHANTRAIT<TD>::convert( sourceData[mRowFuncSourceAlpha] );
 				targetData += mRowFuncTargetInc;
 				sourceData += mRowFuncSourceInc;
@@ -259,7 +354,7 @@ void ImageSource::rowFuncSourceGray( ImageTargetRef target, int32_t row, const v
 		}
 		else {
 			for( int32_t c = 0; c < width; c++ ) {
-				targetData[mRowFuncTargetGray]	= CHANTRAIT<TD>::convert( sourceData[mRowFuncTargetGray] );
+				targetData[mRowFuncTargetGray]	= CHANTRAIT<TD>::convert( sourceData[mRowFuncSourceGray] );
 				targetData += mRowFuncTargetInc;
 				sourceData += mRowFuncSourceInc;
 			}			
@@ -270,6 +365,11 @@ void ImageSource::rowFuncSourceGray( ImageTargetRef target, int32_t row, const v
 	}
 }
 
+void ImageSource::rowFuncSwizzle( ImageTargetRef target, int32_t row, const void *data )
+{
+	mRowSwizzle( data, target->getRowPointer( row ), getWidth() );
+}
+
 void ImageSource::setupRowFuncRgbSource( ImageTargetRef target )
 {
 	translateRgbColorModelToOffsets( mChannelOrder, &mRowFuncSourceRed, &mRowFuncSourceGreen, &mRowFuncSourceBlue, &mRowFuncSourceAlpha, &mRowFuncSourceInc );
@@ -297,7 +397,13 @@ ImageSource::RowFunc ImageSource::setupRowFuncForTypesAndTargetColorModel( Image
 			if( mCustomPixelInc != 0 )
 				mRowFuncSourceInc = mCustomPixelInc;
 			bool alpha = ( mRowFuncSourceAlpha != -1 ) && ( mRowFuncTargetAlpha != -1 );
-			if( alpha )
+			if( TCM == CM_RGB ) {
+				const int8_t sourceOffsets[4] = { mRowFuncSourceRed, mRowFuncSourceGreen, mRowFuncSourceBlue, alpha ? mRowFuncSourceAlpha : (int8_t)-1 };
+				const int8_t targetOffsets[4] = { mRowFuncTargetRed, mRowFuncTargetGreen, mRowFuncTargetBlue, alpha ? mRowFuncTargetAlpha : (int8_t)-1 };
+				mRowSwizzle = RowSwizzle::create<SD,TD>( sourceOffsets, mRowFuncSourceInc, targetOffsets, mRowFuncTargetInc );
+				return &ImageSource::rowFuncSwizzle;
+			}
+			else if( alpha )
 				return &ImageSource::rowFuncSourceRgb<SD,TD,TCM,true>;
 			else
 				return &ImageSource::rowFuncSourceRgb<SD,TD,TCM,false>;
@@ -308,10 +414,18 @@ ImageSource::RowFunc ImageSource::setupRowFuncForTypesAndTargetColorModel( Image
 			if( mCustomPixelInc != 0 )
 				mRowFuncSourceInc = mCustomPixelInc;
 			bool alpha = ( mRowFuncSourceAlpha != -1 ) && ( mRowFuncTargetAlpha != -1 );
-			if( alpha )
-				return &ImageSource::rowFuncSourceGray<SD,TD,TCM,true>;
-			else
-				return &ImageSource::rowFuncSourceGray<SD,TD,TCM,false>;
+			const int8_t sourceAlpha = alpha ? mRowFuncSourceAlpha : (int8_t)-1;
+			if( TCM == CM_RGB ) { // gray is replicated into each of red, green and blue
+				const int8_t sourceOffsets[4] = { mRowFuncSourceGray, mRowFuncSourceGray, mRowFuncSourceGray, sourceAlpha };
+				const int8_t targetOffsets[4] = { mRowFuncTargetRed, mRowFuncTargetGreen, mRowFuncTargetBlue, alpha ? mRowFuncTargetAlpha : (int8_t)-1 };
+				mRowSwizzle = RowSwizzle::create<SD,TD>( sourceOffsets, mRowFuncSourceInc, targetOffsets, mRowFuncTargetInc );
+			}
+			else {
+				const int8_t sourceOffsets[4] = { mRowFuncSourceGray, -1, -1, sourceAlpha };
+				const int8_t targetOffsets[4] = { mRowFuncTargetGray, -1, -1, alpha ? mRowFuncTargetAlpha : (int8_t)-1 };
+				mRowSwizzle = RowSwizzle::create<SD,TD>( sourceOffsets, mRowFuncSourceInc, targetOffsets, mRowFuncTargetInc );
+			}
+			return &ImageSource::rowFuncSwizzle;
 		}
 		break;
 		case CM_UNKNOWN:
@@ -0,0 +1,235 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ImageLoader.h"
+#include "cinder/Log.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+// Hands the ImageLoader's allocator to each decoded Surface
+class SurfaceConstraintsImageLoader : public SurfaceConstraints {
+  public:
+	SurfaceConstraintsImageLoader( const PixelAllocatorRef &allocator ) : mAllocator( allocator ) {}
+
+	virtual PixelAllocatorRef	getAllocator() const { return mAllocator; }
+
+	PixelAllocatorRef	mAllocator;
+};
+} // anonymous namespace
+
+ImageLoader::ImageLoader( const Format &format )
+	: mFormat( format ), mAllocator( format.getAllocator() ), mShouldQuit( false ), mNextSequence( 0 ), mGeneration( 0 ), mBytesInFlight( 0 )
+{
+	if( ! mAllocator )
+		mAllocator = PixelAllocatorPool::create();
+
+	size_t numThreads = mFormat.getNumThreads();
+	if( numThreads == 0 )
+		numThreads = std::max<size_t>( std::thread::hardware_concurrency(), 2 ) - 1;
+
+	for( size_t t = 0; t < numThreads; ++t )
+		mThreads.push_back( std::thread( std::bind( &ImageLoader::workerLoop, this ) ) );
+}
+
+ImageLoader::~ImageLoader()
+{
+	cancelAll();
+	{
+		lock_guard<mutex> lock( mQueueMutex );
+		mShouldQuit = true;
+	}
+	mQueueCond.notify_all();
+	mBytesCond.notify_all();
+
+	for( size_t t = 0; t < mThreads.size(); ++t )
+		mThreads[t].join();
+}
+
+ImageLoader::CancelTokenRef ImageLoader::load( const DataSourceRef &dataSource, const CompletionFn &completionFn, int priority, const CancelTokenRef &cancelToken, const std::string &extension )
+{
+	Request request;
+	request.mDataSource = dataSource;
+	return enqueue( request, completionFn, priority, cancelToken, extension );
+}
+
+ImageLoader::CancelTokenRef ImageLoader::load( const fs::path &path, const CompletionFn &completionFn, int priority, const CancelTokenRef &cancelToken, const std::string &extension )
+{
+	Request request;
+	request.mPath = path;
+	return enqueue( request, completionFn, priority, cancelToken, extension );
+}
+
+ImageLoader::CancelTokenRef ImageLoader::enqueue( Request &request, const CompletionFn &completionFn, int priority, const CancelTokenRef &cancelToken, const std::string &extension )
+{
+	request.mExtension = extension;
+	request.mCompletionFn = completionFn;
+	request.mCancelToken = cancelToken ? cancelToken : CancelTokenRef( new CancelToken );
+	request.mPriority = priority;
+	{
+		lock_guard<mutex> lock( mQueueMutex );
+		request.mSequence = mNextSequence++;
+		request.mGeneration = mGeneration;
+		mQueue.push( request );
+	}
+	mQueueCond.notify_one();
+
+	return request.mCancelToken;
+}
+
+void ImageLoader::workerLoop()
+{
+	ThreadSetup threadSetup;
+
+	while( true ) {
+		Request request;
+		{
+			unique_lock<mutex> lock( mQueueMutex );
+			while( mQueue.empty() && ! mShouldQuit )
+				mQueueCond.wait( lock );
+			if( mShouldQuit )
+				return;
+			request = mQueue.top();
+			mQueue.pop();
+		}
+
+		if( ! isCancelled( request.mCancelToken, request.mGeneration ) )
+			decode( request );
+	}
+}
+
+void ImageLoader::decode( const Request &request )
+{
+	Completion completion;
+	completion.mCompletionFn = request.mCompletionFn;
+	completion.mCancelToken = request.mCancelToken;
+	completion.mGeneration = request.mGeneration;
+	completion.mBytes = 0;
+
+	try {
+		// reading the header is cheap; the in-flight budget is only claimed for the decoded pixels
+		ImageSourceRef imageSource = request.mDataSource ? loadImage( request.mDataSource, ImageSource::Options(), request.mExtension )
+														: loadImage( request.mPath, ImageSource::Options(), request.mExtension );
+		const bool alpha = boost::indeterminate( mFormat.getAlpha() ) ? imageSource->hasAlpha() : bool( mFormat.getAlpha() );
+		const size_t numBytes = (size_t)imageSource->getWidth() * imageSource->getHeight() * ( alpha ? 4 : 3 );
+		if( ! acquireBytes( numBytes, request ) )
+			return;
+
+		completion.mBytes = numBytes;
+		completion.mSurface = Surface8u( imageSource, SurfaceConstraintsImageLoader( mAllocator ), alpha );
+	}
+	catch( std::exception &exc ) {
+		CI_LOG_E( "failed to decode image: " << exc.what() );
+	}
+
+	lock_guard<mutex> lock( mCompletionsMutex );
+	mCompletions.push_back( completion );
+}
+
+bool ImageLoader::acquireBytes( size_t numBytes, const Request &request )
+{
+	unique_lock<mutex> lock( mBytesMutex );
+	// an image larger than the whole budget is let through once nothing else is in flight
+	while( mBytesInFlight > 0 && mBytesInFlight + numBytes > mFormat.getMaxBytesInFlight() ) {
+		if( mShouldQuit || isCancelled( request.mCancelToken, request.mGeneration ) )
+			return false;
+		// cancellation doesn't signal mBytesCond, so poll for it
+		mBytesCond.wait_for( lock, std::chrono::milliseconds( 50 ) );
+	}
+
+	mBytesInFlight += numBytes;
+	return true;
+}
+
+void ImageLoader::releaseBytes( size_t numBytes )
+{
+	{
+		lock_guard<mutex> lock( mBytesMutex );
+		mBytesInFlight -= numBytes;
+	}
+	mBytesCond.notify_all();
+}
+
+size_t ImageLoader::update( size_t maxCompletions )
+{
+	vector<Completion> completions;
+	{
+		lock_guard<mutex> lock( mCompletionsMutex );
+		if( maxCompletions == 0 || maxCompletions >= mCompletions.size() )
+			completions.swap( mCompletions );
+		else {
+			completions.assign( mCompletions.begin(), mCompletions.begin() + maxCompletions );
+			mCompletions.erase( mCompletions.begin(), mCompletions.begin() + maxCompletions );
+		}
+	}
+
+	size_t numCalled = 0;
+	for( auto compIt = completions.begin(); compIt != completions.end(); ++compIt ) {
+		if( compIt->mBytes )
+			releaseBytes( compIt->mBytes );
+		if( ! isCancelled( compIt->mCancelToken, compIt->mGeneration ) && compIt->mCompletionFn ) {
+			compIt->mCompletionFn( compIt->mSurface );
+			++numCalled;
+		}
+	}
+
+	return numCalled;
+}
+
+void ImageLoader::cancelAll()
+{
+	{
+		lock_guard<mutex> lock( mQueueMutex );
+		++mGeneration;
+		mQueue = priority_queue<Request>();
+	}
+
+	// discard undelivered completions, returning their bytes to the budget
+	vector<Completion> completions;
+	{
+		lock_guard<mutex> lock( mCompletionsMutex );
+		completions.swap( mCompletions );
+	}
+	for( auto compIt = completions.begin(); compIt != completions.end(); ++compIt )
+		if( compIt->mBytes )
+			releaseBytes( compIt->mBytes );
+}
+
+size_t ImageLoader::getNumQueued() const
+{
+	lock_guard<mutex> lock( mQueueMutex );
+	return mQueue.size();
+}
+
+size_t ImageLoader::getBytesInFlight() const
+{
+	lock_guard<mutex> lock( mBytesMutex );
+	return mBytesInFlight;
+}
+
+} // namespace cinder
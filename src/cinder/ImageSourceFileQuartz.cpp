@@ -30,6 +30,9 @@
 	#include <CoreServices/CoreServices.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
+
 namespace cinder {
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -118,6 +121,32 @@ ImageSourceFileQuartzRef ImageSourceFileQuartz::createFileQuartzRef( DataSourceR
 	else
 		throw ImageIoExceptionFailedLoad( "Failed to load CGImageSource." );
 
+	// regions and reduced sizes come from a thumbnail, which ImageIO decodes at reduced size natively for JPEG, cropped to the region
+	const int32_t fullWidth = (int32_t)::CGImageGetWidth( imageRef.get() ), fullHeight = (int32_t)::CGImageGetHeight( imageRef.get() );
+	const Area region = options.calcRegion( fullWidth, fullHeight );
+	if( region.getWidth() <= 0 || region.getHeight() <= 0 )
+		throw ImageIoExceptionFailedLoad( "Requested region lies outside the image." );
+	const int32_t scale = options.calcScaleDenominator( region.getWidth(), region.getHeight() );
+	if( scale != 1 ) {
+		int32_t maxPixelSize = ( std::max( fullWidth, fullHeight ) + scale - 1 ) / scale;
+		::CFNumberRef maxPixelSizeRef = ::CFNumberCreate( kCFAllocatorDefault, kCFNumberSInt32Type, &maxPixelSize );
+		::CFStringRef thumbnailKeys[3] = { kCGImageSourceShouldAllowFloat, kCGImageSourceCreateThumbnailFromImageAlways, kCGImageSourceThumbnailMaxPixelSize };
+		::CFTypeRef thumbnailValues[3] = { kCFBooleanTrue, kCFBooleanTrue, maxPixelSizeRef };
+		const std::shared_ptr<__CFDictionary> thumbnailDict( (__CFDictionary*)CFDictionaryCreate( kCFAllocatorDefault, (const void **)&thumbnailKeys, (const void **)&thumbnailValues, 3, NULL, NULL ), cocoa::safeCfRelease );
+		::CGImageRef thumbnailRef = ::CGImageSourceCreateThumbnailAtIndex( sourceRef.get(), options.getIndex(), thumbnailDict.get() );
+		::CFRelease( maxPixelSizeRef );
+		if( thumbnailRef )
+			imageRef = std::shared_ptr<CGImage>( thumbnailRef, CGImageRelease );
+	}
+	if( scale != 1 || ! ( region == Area( 0, 0, fullWidth, fullHeight ) ) ) {
+		// the thumbnail's size may differ from the requested one by a pixel, so the region is mapped by the actual ratio
+		const double sx = ::CGImageGetWidth( imageRef.get() ) / (double)fullWidth, sy = ::CGImageGetHeight( imageRef.get() ) / (double)fullHeight;
+		const ::CGRect rect = ::CGRectMake( std::floor( region.x1 * sx ), std::floor( region.y1 * sy ), std::ceil( region.getWidth() * sx ), std::ceil( region.getHeight() * sy ) );
+		::CGImageRef croppedRef = ::CGImageCreateWithImageInRect( imageRef.get(), rect );
+		if( croppedRef )
+			imageRef = std::shared_ptr<CGImage>( croppedRef, CGImageRelease );
+	}
+
 	const std::shared_ptr<__CFDictionary> imageProperties( (__CFDictionary*)::CGImageSourceCopyProperties( sourceRef.get(), NULL ), ::CFRelease );
 	const std::shared_ptr<__CFDictionary> imageIndexProperties( (__CFDictionary*)::CGImageSourceCopyPropertiesAtIndex( sourceRef.get(), options.getIndex(), NULL ), ::CFRelease );
 
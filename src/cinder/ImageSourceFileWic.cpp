@@ -127,6 +127,7 @@ ImageSourceFileWic::ImageSourceFileWic( DataSourceRef dataSourceRef, ImageSource
 		throw ImageIoExceptionFailedLoad( "Could not retrieve pixel format from WIC Decoder." );
 	
 	mRequiresConversion = processFormat( mPixelFormat, &mConvertPixelFormat );
+	setupReduction( width, height, options );
 	mRowBytes = mWidth * ImageIo::dataTypeBytes( mDataType ) * channelOrderNumChannels( mChannelOrder );
 }
 
@@ -184,12 +185,59 @@ bool ImageSourceFileWic::processFormat( const ::GUID &guid, ::GUID *convertGUID
 	return false;
 }
 
+// Decodes the region directly at the reduced size when the frame's codec can scale natively (WIC's JPEG codec scales its DCT). Returns false, having decoded nothing, otherwise.
+bool ImageSourceFileWic::loadScaledNative( ImageSource::RowFunc func, ImageTargetRef target )
+{
+	const Area &region = getReductionRegion();
+	const int32_t scale = getReductionScale();
+	// the scaled image can only be cropped along whole pixels of the scaled image
+	if( scale == 1 || mRequiresConversion || ( region.x1 % scale ) || ( region.y1 % scale ) )
+		return false;
+
+	IWICBitmapSourceTransform *transformP = NULL;
+	if( ! SUCCEEDED( mFrame->QueryInterface( IID_IWICBitmapSourceTransform, reinterpret_cast<void**>( &transformP ) ) ) )
+		return false;
+	std::shared_ptr<IWICBitmapSourceTransform> transform = msw::makeComShared( transformP );
+
+	UINT fullWidth = 0, fullHeight = 0;
+	mFrame->GetSize( &fullWidth, &fullHeight );
+	const UINT scaledWidth = ( fullWidth + scale - 1 ) / scale, scaledHeight = ( fullHeight + scale - 1 ) / scale;
+	UINT closestWidth = scaledWidth, closestHeight = scaledHeight;
+	if( ( ! SUCCEEDED( transform->GetClosestSize( &closestWidth, &closestHeight ) ) ) || closestWidth != scaledWidth || closestHeight != scaledHeight )
+		return false;
+	::GUID pixelFormat = mPixelFormat;
+	if( ( ! SUCCEEDED( transform->GetClosestPixelFormat( &pixelFormat ) ) ) || pixelFormat != mPixelFormat )
+		return false;
+
+	// WIC scales before it crops, so the rect is in the scaled image's pixels
+	std::unique_ptr<uint8_t[]> data( new uint8_t[mRowBytes * mHeight] );
+	const WICRect rect = { region.x1 / scale, region.y1 / scale, mWidth, mHeight };
+	if( ! SUCCEEDED( transform->CopyPixels( &rect, scaledWidth, scaledHeight, &pixelFormat, WICBitmapTransformRotate0, (UINT)mRowBytes, mRowBytes * mHeight, data.get() ) ) )
+		return false;
+
+	const uint8_t *dataPtr = data.get();
+	for( int32_t row = 0; row < mHeight; ++row ) {
+		((*this).*func)( target, row, dataPtr );
+		dataPtr += mRowBytes;
+	}
+
+	return true;
+}
+
 void ImageSourceFileWic::load( ImageTargetRef target )
 {
 	// get a pointer to the ImageSource function appropriate for handling our data configuration
 	ImageSource::RowFunc func = setupRowFunc( target );
 
-	std::unique_ptr<uint8_t[]> data( new uint8_t[mRowBytes * mHeight] );
+	if( loadScaledNative( func, target ) )
+		return;
+
+	// otherwise decode the region at full resolution and let processRow() reduce it
+	const Area &region = getReductionRegion();
+	const WICRect rect = { region.x1, region.y1, region.getWidth(), region.getHeight() };
+	const UINT regionRowBytes = region.getWidth() * ImageIo::dataTypeBytes( mDataType ) * channelOrderNumChannels( mChannelOrder );
+	const UINT regionBytes = regionRowBytes * region.getHeight();
+	std::unique_ptr<uint8_t[]> data( new uint8_t[regionBytes] );
 
 	if( mRequiresConversion ) {
 		IWICFormatConverter *pIFormatConverter = NULL;	
@@ -200,15 +248,15 @@ void ImageSourceFileWic::load( ImageTargetRef target )
 		hr = formatConverter->Initialize( mFrame.get(), mConvertPixelFormat, WICBitmapDitherTypeNone, NULL, 0.f, WICBitmapPaletteTypeCustom );
 		if( ! SUCCEEDED( hr ) )
 			throw ImageIoExceptionFailedLoad( "Could not initialize WIC Format Converter." );
-		hr = formatConverter->CopyPixels( NULL, (UINT)mRowBytes, mRowBytes * mHeight, data.get() );
+		hr = formatConverter->CopyPixels( &rect, regionRowBytes, regionBytes, data.get() );
 	}
 	else
-		mFrame->CopyPixels( NULL, (UINT)mRowBytes, mRowBytes * mHeight, data.get() );
+		mFrame->CopyPixels( &rect, regionRowBytes, regionBytes, data.get() );
 	
 	const uint8_t *dataPtr = data.get();
-	for( int32_t row = 0; row < mHeight; ++row ) {
-		((*this).*func)( target, row, dataPtr );
-		dataPtr += mRowBytes;
+	for( int32_t row = region.y1; row < region.y2; ++row ) {
+		processRow( func, target, row, dataPtr );
+		dataPtr += regionRowBytes;
 	}
 }
 
@@ -74,7 +74,7 @@ ImageSourcePngRef ImageSourcePng::createRef( DataSourceRef dataSourceRef, ImageS
 	return ImageSourcePngRef( new ImageSourcePng( dataSourceRef, options ) );
 }
 
-ImageSourcePng::ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Options /*options*/ )
+ImageSourcePng::ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Options options )
 	: ImageSource(), mInfoPtr( 0 ), mPngPtr( 0 )
 {
 	mPngPtr = png_create_read_struct( PNG_LIBPNG_VER_STRING, (png_voidp)NULL, NULL, NULL );
@@ -96,6 +96,8 @@ ImageSourcePng::ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Option
 	
 	if( ! loadHeader() )
 		throw ImageSourcePngException( "Could not load png header." );
+
+	setupReduction( png_get_image_width( mPngPtr, mInfoPtr ), png_get_image_height( mPngPtr, mInfoPtr ), options );
 }
 
 // part of this being separated allows for us to play nicely with the setjmp of libpng
@@ -125,10 +127,12 @@ bool ImageSourcePng::loadHeader()
 		png_set_swap( mPngPtr );
 	#endif
 
+		// a tRNS chunk is expanded into a full alpha channel by png_set_tRNS_to_alpha() below
+		const bool transparency = png_get_valid( mPngPtr, mInfoPtr, PNG_INFO_tRNS ) != 0;
 		switch( colorType ) {
 			case PNG_COLOR_TYPE_GRAY:
 				setColorModel( ImageIo::CM_GRAY );
-				setChannelOrder( ImageIo::Y );			
+				setChannelOrder( transparency ? ImageIo::YA : ImageIo::Y );
 			break;
 			case PNG_COLOR_TYPE_GRAY_ALPHA:
 				setColorModel( ImageIo::CM_GRAY );
@@ -137,7 +141,7 @@ bool ImageSourcePng::loadHeader()
 			case PNG_COLOR_TYPE_RGB:
 			case PNG_COLOR_TYPE_PALETTE:
 				setColorModel( ImageIo::CM_RGB );
-				setChannelOrder( ImageIo::RGB );
+				setChannelOrder( transparency ? ImageIo::RGBA : ImageIo::RGB );
 			break;
 			case PNG_COLOR_TYPE_RGB_ALPHA:
 				setColorModel( ImageIo::CM_RGB );
@@ -150,8 +154,7 @@ bool ImageSourcePng::loadHeader()
 		png_set_expand_gray_1_2_4_to_8( mPngPtr );
 		png_set_palette_to_rgb( mPngPtr );
 		png_set_tRNS_to_alpha( mPngPtr );
-		
-		png_read_update_info( mPngPtr, mInfoPtr );
+		// png_read_update_info() is deferred to load(), once the target's layout is known
 	}
 	
 	return success;
@@ -163,6 +166,43 @@ ImageSourcePng::~ImageSourcePng()
 		png_destroy_read_struct( &mPngPtr, &mInfoPtr, NULL );
 }
 
+// Asks libpng for rows in exactly the target's layout when a combination of its transforms can produce it. Returns false, having set no transforms, otherwise.
+bool ImageSourcePng::setupTransformsForTarget( ImageTargetRef target )
+{
+	// libpng's png_set_expand_16() and png_set_scale_16() measured slower than the row function's conversion, so only the channel layout is left to libpng
+	const ImageIo::ChannelOrder targetChannelOrder = target->getChannelOrder();
+	if( target->getDataType() != getDataType() || targetChannelOrder == ImageIo::CUSTOM )
+		return false;
+	// RGB to gray goes through the row function, which uses Cinder's own luminance weights
+	if( target->getColorModel() == ImageIo::CM_GRAY && getColorModel() != ImageIo::CM_GRAY )
+		return false;
+
+	const bool sourceAlpha = hasAlpha();
+	bool targetAlphaFirst = false, targetBgr = false, targetAlphaSlot = false; // targetAlphaSlot: an alpha or ignored (X) channel
+	switch( targetChannelOrder ) {
+		case ImageIo::ABGR: case ImageIo::XBGR:	targetAlphaFirst = true; // fall through
+		case ImageIo::BGRA: case ImageIo::BGRX:	targetBgr = true; targetAlphaSlot = true; break;
+		case ImageIo::ARGB: case ImageIo::XRGB:	targetAlphaFirst = true; // fall through
+		case ImageIo::RGBA: case ImageIo::RGBX:	targetAlphaSlot = true; break;
+		case ImageIo::BGR:						targetBgr = true; break;
+		case ImageIo::YA:						targetAlphaSlot = true; break;
+		default:								break;
+	}
+
+	if( target->getColorModel() == ImageIo::CM_RGB && getColorModel() == ImageIo::CM_GRAY )
+		png_set_gray_to_rgb( mPngPtr );
+	if( targetBgr )
+		png_set_bgr( mPngPtr );
+	if( sourceAlpha && ! targetAlphaSlot )
+		png_set_strip_alpha( mPngPtr );
+	else if( sourceAlpha && targetAlphaFirst )
+		png_set_swap_alpha( mPngPtr );
+	else if( ( ! sourceAlpha ) && targetAlphaSlot ) // the row function would leave this channel alone; here it is filled opaque
+		png_set_add_alpha( mPngPtr, ( getDataType() == ImageIo::UINT16 ) ? 0xFFFF : 0xFF, targetAlphaFirst ? PNG_FILLER_BEFORE : PNG_FILLER_AFTER );
+
+	return true;
+}
+
 void ImageSourcePng::load( ImageTargetRef target )
 {
 	bool success = true;
@@ -172,13 +212,42 @@ void ImageSourcePng::load( ImageTargetRef target )
 		success = false;
 	}
 	else {
-		// get a pointer to the ImageSource function appropriate for handling our data configuration
-		ImageSource::RowFunc func = setupRowFunc( target );
-		//int number_passes = png_set_interlace_handling( mPngPtr );
-		shared_ptr<png_byte> row_pointer( new png_byte[png_get_rowbytes( mPngPtr, mInfoPtr )], checked_array_deleter<png_byte>() );
-		for( int32_t row = 0; row < mHeight; ++row ) {
-			png_read_row( mPngPtr, row_pointer.get(), NULL );
-			((*this).*func)( target, row, row_pointer.get() );
+		// when libpng can produce the target's layout itself, decode straight into the target's rows; regions and reduced sizes always go through processRow()
+		const bool direct = ( ! isReduced() ) && setupTransformsForTarget( target );
+		const int numPasses = png_set_interlace_handling( mPngPtr );
+		png_read_update_info( mPngPtr, mInfoPtr );
+
+		if( direct ) {
+			// each interlace pass fills in more of the rows already in the target
+			for( int pass = 0; pass < numPasses; ++pass )
+				for( int32_t row = 0; row < mHeight; ++row )
+					png_read_row( mPngPtr, reinterpret_cast<png_bytep>( target->getRowPointer( row ) ), NULL );
+		}
+		else {
+			// get a pointer to the ImageSource function appropriate for handling our data configuration
+			ImageSource::RowFunc func = setupRowFunc( target );
+			const size_t rowBytes = png_get_rowbytes( mPngPtr, mInfoPtr );
+			const int32_t fullWidth = png_get_image_width( mPngPtr, mInfoPtr );
+			const int32_t fullHeight = png_get_image_height( mPngPtr, mInfoPtr );
+			const Area &region = getReductionRegion();
+			const size_t regionOffset = region.x1 * ( rowBytes / fullWidth );
+			if( numPasses > 1 ) { // interlaced images are decoded whole before conversion
+				shared_ptr<png_byte> image( new png_byte[rowBytes * fullHeight], checked_array_deleter<png_byte>() );
+				vector<png_bytep> rowPointers( fullHeight );
+				for( int32_t row = 0; row < fullHeight; ++row )
+					rowPointers[row] = image.get() + row * rowBytes;
+				png_read_image( mPngPtr, &rowPointers[0] );
+				for( int32_t row = region.y1; row < region.y2; ++row )
+					processRow( func, target, row, rowPointers[row] + regionOffset );
+			}
+			else {
+				// rows below the region are never decoded
+				shared_ptr<png_byte> row_pointer( new png_byte[rowBytes], checked_array_deleter<png_byte>() );
+				for( int32_t row = 0; row < region.y2; ++row ) {
+					png_read_row( mPngPtr, row_pointer.get(), NULL );
+					processRow( func, target, row, row_pointer.get() + regionOffset );
+				}
+			}
 		}
 	}
 	
@@ -0,0 +1,266 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ImageTargetPng.h"
+#include "cinder/Thread.h"
+
+#include <zlib.h>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+// Roughly how much filtered data each band deflates; small enough to keep every thread busy on a 4K frame, large enough that sync flushes cost little
+const size_t BAND_BYTES = 256 * 1024;
+// Deflate's window; each band is primed with this much of the filtered data preceding it
+const size_t DICTIONARY_BYTES = 32768;
+
+inline uint8_t paethPredictor( uint8_t a, uint8_t b, uint8_t c )
+{
+	int p = (int)a + b - c;
+	int pa = abs( p - a ), pb = abs( p - b ), pc = abs( p - c );
+	if( pa <= pb && pa <= pc )
+		return a;
+	else if( pb <= pc )
+		return b;
+	else
+		return c;
+}
+
+// Writes \a row filtered with \a filter (1-4 per the PNG spec) to \a out; \a prev is the previous unfiltered row or zeros
+void applyFilter( int filter, const uint8_t *row, const uint8_t *prev, size_t rowBytes, size_t bpp, uint8_t *out )
+{
+	switch( filter ) {
+		case ImageTarget::Options::FILTER_SUB:
+			for( size_t i = 0; i < bpp; ++i )
+				out[i] = row[i];
+			for( size_t i = bpp; i < rowBytes; ++i )
+				out[i] = row[i] - row[i - bpp];
+		break;
+		case ImageTarget::Options::FILTER_UP:
+			for( size_t i = 0; i < rowBytes; ++i )
+				out[i] = row[i] - prev[i];
+		break;
+		case ImageTarget::Options::FILTER_AVERAGE:
+			for( size_t i = 0; i < bpp; ++i )
+				out[i] = row[i] - ( prev[i] >> 1 );
+			for( size_t i = bpp; i < rowBytes; ++i )
+				out[i] = row[i] - (uint8_t)( ( (int)row[i - bpp] + prev[i] ) >> 1 );
+		break;
+		case ImageTarget::Options::FILTER_PAETH:
+			for( size_t i = 0; i < bpp; ++i )
+				out[i] = row[i] - prev[i]; // the predictor reduces to "up" for the first pixel
+			for( size_t i = bpp; i < rowBytes; ++i )
+				out[i] = row[i] - paethPredictor( row[i - bpp], prev[i], prev[i - bpp] );
+		break;
+		default:
+			memcpy( out, row, rowBytes );
+	}
+}
+
+// Filters rows [\a rowBegin, \a rowEnd) of \a image into \a out, each prefixed by its filter type byte
+void filterRows( const ImageTarget::Options::Filter filter, const uint8_t *image, size_t rowBytes, size_t bpp, int32_t rowBegin, int32_t rowEnd, const uint8_t *zeroRow, uint8_t *out, vector<uint8_t> *scratch )
+{
+	for( int32_t row = rowBegin; row < rowEnd; ++row, out += rowBytes + 1 ) {
+		const uint8_t *cur = image + row * rowBytes;
+		const uint8_t *prev = ( row > 0 ) ? cur - rowBytes : zeroRow;
+		if( filter != ImageTarget::Options::FILTER_ADAPTIVE ) {
+			out[0] = (uint8_t)filter;
+			applyFilter( filter, cur, prev, rowBytes, bpp, out + 1 );
+			continue;
+		}
+
+		// minimum sum of absolute differences, treating filtered bytes as signed
+		uint64_t bestSum = ~uint64_t( 0 );
+		for( int f = ImageTarget::Options::FILTER_NONE; f <= ImageTarget::Options::FILTER_PAETH; ++f ) {
+			uint8_t *candidate = &(*scratch)[f * rowBytes];
+			applyFilter( f, cur, prev, rowBytes, bpp, candidate );
+			uint64_t sum = 0;
+			for( size_t i = 0; i < rowBytes && sum < bestSum; ++i )
+				sum += abs( (int)(int8_t)candidate[i] );
+			if( sum < bestSum ) {
+				bestSum = sum;
+				out[0] = (uint8_t)f;
+			}
+		}
+		memcpy( out + 1, &(*scratch)[out[0] * rowBytes], rowBytes );
+	}
+}
+
+struct Band {
+	int32_t			mRowBegin, mRowEnd;
+	vector<uint8_t>	mCompressed;
+	uLong			mAdler, mLength;
+};
+
+void writeChunk( const OStreamRef &stream, const char *type, const uint8_t *data, size_t size )
+{
+	stream->writeBig( (uint32_t)size );
+	stream->writeData( type, 4 );
+	if( size )
+		stream->writeData( data, size );
+	uLong crc = crc32( 0, reinterpret_cast<const Bytef*>( type ), 4 );
+	if( size )
+		crc = crc32( crc, data, (uInt)size );
+	stream->writeBig( (uint32_t)crc );
+}
+
+} // anonymous namespace
+
+void ImageTargetPng::registerSelf()
+{
+	// ahead of the platform encoders, which are single-threaded
+	const int32_t PRIORITY = 1;
+	ImageIoRegistrar::registerTargetType( "png", ImageTargetPng::createRef, PRIORITY, "png" );
+}
+
+ImageTargetRef ImageTargetPng::createRef( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const string &extensionData )
+{
+	return ImageTargetRef( new ImageTargetPng( dataTarget, imageSource, options ) );
+}
+
+ImageTargetPng::ImageTargetPng( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options )
+	: ImageTarget(), mDataTarget( dataTarget ), mOptions( options )
+{
+	setSize( imageSource->getWidth(), imageSource->getHeight() );
+
+	// PNG has no float samples; floats are written as 16-bit
+	setDataType( ( imageSource->getDataType() == ImageIo::UINT8 ) ? ImageIo::UINT8 : ImageIo::UINT16 );
+	mBytesPerChannel = ( getDataType() == ImageIo::UINT8 ) ? 1 : 2;
+
+	ImageIo::ColorModel cm = options.isColorModelDefault() ? imageSource->getColorModel() : options.getColorModel();
+	setColorModel( ( cm == ImageIo::CM_GRAY ) ? ImageIo::CM_GRAY : ImageIo::CM_RGB );
+	if( getColorModel() == ImageIo::CM_GRAY )
+		setChannelOrder( imageSource->hasAlpha() ? ImageIo::YA : ImageIo::Y );
+	else
+		setChannelOrder( imageSource->hasAlpha() ? ImageIo::RGBA : ImageIo::RGB );
+	mNumChannels = channelOrderNumChannels( getChannelOrder() );
+
+	mRowBytes = (size_t)mWidth * mNumChannels * mBytesPerChannel;
+	mData.resize( mRowBytes * mHeight );
+}
+
+void* ImageTargetPng::getRowPointer( int32_t row )
+{
+	return &mData[row * mRowBytes];
+}
+
+void ImageTargetPng::finalize()
+{
+	if( mWidth <= 0 || mHeight <= 0 )
+		throw ImageIoExceptionFailedWrite( "PNG images can't be empty." );
+
+	const size_t bpp = mNumChannels * mBytesPerChannel;
+	const size_t filteredRowBytes = mRowBytes + 1;
+	const ImageTarget::Options::Filter filter = mOptions.getFilter();
+	const int level = mOptions.getCompressionLevel();
+	const size_t numThreads = mOptions.getNumThreads() ? mOptions.getNumThreads() : std::max<unsigned>( std::thread::hardware_concurrency(), 1 );
+
+	// PNG samples are big-endian
+#if defined( CINDER_LITTLE_ENDIAN )
+	if( mBytesPerChannel == 2 ) {
+		parallelFor( 0, mHeight, 64, [&]( size_t rowBegin, size_t rowEnd ) {
+			uint16_t *samples = reinterpret_cast<uint16_t*>( &mData[rowBegin * mRowBytes] );
+			for( size_t s = 0; s < ( rowEnd - rowBegin ) * mRowBytes / 2; ++s )
+				samples[s] = ( samples[s] >> 8 ) | ( samples[s] << 8 );
+		} );
+	}
+#endif
+
+	const int32_t rowsPerBand = (int32_t)std::max<size_t>( BAND_BYTES / filteredRowBytes, 1 );
+	const int32_t dictionaryRows = (int32_t)( ( DICTIONARY_BYTES + filteredRowBytes - 1 ) / filteredRowBytes );
+	vector<Band> bands( ( mHeight + rowsPerBand - 1 ) / rowsPerBand );
+	for( size_t b = 0; b < bands.size(); ++b ) {
+		bands[b].mRowBegin = (int32_t)b * rowsPerBand;
+		bands[b].mRowEnd = std::min( bands[b].mRowBegin + rowsPerBand, mHeight );
+	}
+
+	const vector<uint8_t> zeroRow( mRowBytes, 0 );
+	const uint8_t *image = mData.empty() ? nullptr : &mData[0];
+	auto encodeBands = [&]( size_t bandBegin, size_t bandEnd ) {
+		vector<uint8_t> filtered, scratch( ( filter == ImageTarget::Options::FILTER_ADAPTIVE ) ? 5 * mRowBytes : 0 );
+		for( size_t b = bandBegin; b < bandEnd; ++b ) {
+			Band &band = bands[b];
+			// filtering is a function of the raw rows alone, so the dictionary rows from the previous band are simply filtered again
+			const int32_t filterBegin = std::max( band.mRowBegin - dictionaryRows, 0 );
+			filtered.resize( ( band.mRowEnd - filterBegin ) * filteredRowBytes );
+			filterRows( filter, image, mRowBytes, bpp, filterBegin, band.mRowEnd, &zeroRow[0], &filtered[0], &scratch );
+			const size_t dictionarySize = std::min( ( band.mRowBegin - filterBegin ) * filteredRowBytes, DICTIONARY_BYTES );
+			uint8_t *input = &filtered[( band.mRowBegin - filterBegin ) * filteredRowBytes];
+			band.mLength = (uLong)( ( band.mRowEnd - band.mRowBegin ) * filteredRowBytes );
+			band.mAdler = adler32( adler32( 0, Z_NULL, 0 ), input, band.mLength );
+
+			z_stream strm;
+			memset( &strm, 0, sizeof(strm) );
+			// a raw deflate stream; the zlib header and checksum are written once for the whole image
+			if( deflateInit2( &strm, level, Z_DEFLATED, -15, 8, ( filter == ImageTarget::Options::FILTER_NONE ) ? Z_DEFAULT_STRATEGY : Z_FILTERED ) != Z_OK )
+				throw ImageIoExceptionFailedWrite( "Could not initialize zlib." );
+			if( dictionarySize )
+				deflateSetDictionary( &strm, input - dictionarySize, (uInt)dictionarySize );
+			band.mCompressed.resize( deflateBound( &strm, band.mLength ) + 16 );
+			strm.next_in = input;
+			strm.avail_in = band.mLength;
+			strm.next_out = &band.mCompressed[0];
+			strm.avail_out = (uInt)band.mCompressed.size();
+			// every band but the last ends on a byte boundary with a non-final block, so that the bands concatenate into one stream
+			int result = deflate( &strm, ( b + 1 == bands.size() ) ? Z_FINISH : Z_SYNC_FLUSH );
+			band.mCompressed.resize( band.mCompressed.size() - strm.avail_out );
+			deflateEnd( &strm );
+			if( ( result != Z_STREAM_END && result != Z_OK ) || strm.avail_in != 0 )
+				throw ImageIoExceptionFailedWrite( "zlib compression failed." );
+		}
+	};
+	parallelFor( 0, bands.size(), ( bands.size() + numThreads - 1 ) / numThreads, encodeBands );
+
+	uLong adler = adler32( 0, Z_NULL, 0 );
+	for( size_t b = 0; b < bands.size(); ++b )
+		adler = adler32_combine( adler, bands[b].mAdler, bands[b].mLength );
+
+	// zlib header: deflate with a 32k window, FLEVEL from the compression level and FCHECK making the pair a multiple of 31
+	const int flevel = ( level < 0 || level == 6 ) ? 2 : ( level < 2 ) ? 0 : ( level < 6 ) ? 1 : 3;
+	uint8_t zlibHeader[2] = { 0x78, (uint8_t)( flevel << 6 ) };
+	zlibHeader[1] += ( 31 - ( ( zlibHeader[0] << 8 ) + zlibHeader[1] ) % 31 ) % 31;
+	bands.front().mCompressed.insert( bands.front().mCompressed.begin(), zlibHeader, zlibHeader + 2 );
+	const uint8_t adlerBytes[4] = { uint8_t( adler >> 24 ), uint8_t( adler >> 16 ), uint8_t( adler >> 8 ), uint8_t( adler ) };
+	bands.back().mCompressed.insert( bands.back().mCompressed.end(), adlerBytes, adlerBytes + 4 );
+
+	OStreamRef stream = mDataTarget->getStream();
+	const uint8_t signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	stream->writeData( signature, 8 );
+
+	const uint8_t colorType = ( getColorModel() == ImageIo::CM_GRAY ) ? ( hasAlpha() ? 4 : 0 ) : ( hasAlpha() ? 6 : 2 );
+	const uint8_t ihdr[13] = { uint8_t( mWidth >> 24 ), uint8_t( mWidth >> 16 ), uint8_t( mWidth >> 8 ), uint8_t( mWidth ),
+								uint8_t( mHeight >> 24 ), uint8_t( mHeight >> 16 ), uint8_t( mHeight >> 8 ), uint8_t( mHeight ),
+								uint8_t( mBytesPerChannel * 8 ), colorType, 0, 0, 0 };
+	writeChunk( stream, "IHDR", ihdr, 13 );
+	// one IDAT per band
+	for( size_t b = 0; b < bands.size(); ++b )
+		writeChunk( stream, "IDAT", &bands[b].mCompressed[0], bands[b].mCompressed.size() );
+	writeChunk( stream, "IEND", nullptr, 0 );
+}
+
+} // namespace cinder
@@ -137,6 +137,60 @@ Matrix44<T> lastFrame(
     return Matrix44<T>::createTranslation( lastPoint - prevPoint )*prevMatrix;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// Matrix44f batch transforms
+template<>
+void Matrix44<float>::transformPoints( const Vec3f *src, Vec3f *dst, size_t count ) const
+{
+#if defined( CINDER_SSE2 )
+	SseTransformPoints( *this, src, dst, count );
+#elif defined( CINDER_NEON )
+	NeonTransformPoints( *this, src, dst, count );
+#else
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = transformPoint( src[i] );
+#endif
+}
+
+template<>
+void Matrix44<float>::transformPointsAffine( const Vec3f *src, Vec3f *dst, size_t count ) const
+{
+#if defined( CINDER_SSE2 )
+	SseTransformPointsAffine( *this, src, dst, count );
+#elif defined( CINDER_NEON )
+	NeonTransformPointsAffine( *this, src, dst, count );
+#else
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = transformPointAffine( src[i] );
+#endif
+}
+
+template<>
+void Matrix44<float>::transformVecs( const Vec3f *src, Vec3f *dst, size_t count ) const
+{
+#if defined( CINDER_SSE2 )
+	SseTransformVecs( *this, src, dst, count );
+#elif defined( CINDER_NEON )
+	NeonTransformVecs( *this, src, dst, count );
+#else
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = transformVec( src[i] );
+#endif
+}
+
+template<>
+void Matrix44<float>::postMultiply( const Vec4f *src, Vec4f *dst, size_t count ) const
+{
+#if defined( CINDER_SSE2 )
+	SsePostMultiply( *this, src, dst, count );
+#elif defined( CINDER_NEON )
+	NeonPostMultiply( *this, src, dst, count );
+#else
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = *this * src[i];
+#endif
+}
+
 // Explicitly declare the functions
 template Matrix44f firstFrame( const Vec3f &firstPoint, const Vec3f &secondPoint, const Vec3f &thirdPoint );
 template Matrix44f nextFrame( const Matrix44f &prevMatrix, const Vec3f &prevPoint, const Vec3f &curPoint, Vec3f &prevTangent, Vec3f &curTangent );
@@ -467,34 +467,41 @@ Vec2f Path2d::getSegmentTangent( size_t segment, float t ) const
 
 vector<Vec2f> Path2d::subdivide( float approximationScale ) const
 {
+	vector<Vec2f> result;
+	subdivide( &result, approximationScale );
+	return result;
+}
+
+void Path2d::subdivide( vector<Vec2f> *result, float approximationScale ) const
+{
+	result->clear();
 	if( mSegments.empty() )
-		return vector<Vec2f>();
+		return;
 
 	float distanceToleranceSqr = 0.5f / approximationScale;
 	distanceToleranceSqr *= distanceToleranceSqr;
 	
 	size_t firstPoint = 0;
-	vector<Vec2f> result;
-	result.push_back( mPoints[0] );
+	result->push_back( mPoints[0] );
 	for( size_t s = 0; s < mSegments.size(); ++s ) {
 		switch( mSegments[s] ) {
 			case CUBICTO:
-				result.push_back( mPoints[firstPoint] );
-				subdivideCubic( distanceToleranceSqr, mPoints[firstPoint], mPoints[firstPoint+1], mPoints[firstPoint+2], mPoints[firstPoint+3], 0, &result );
-				result.push_back( mPoints[firstPoint+3] );
+				result->push_back( mPoints[firstPoint] );
+				subdivideCubic( distanceToleranceSqr, mPoints[firstPoint], mPoints[firstPoint+1], mPoints[firstPoint+2], mPoints[firstPoint+3], 0, result );
+				result->push_back( mPoints[firstPoint+3] );
 			break;
 			case QUADTO:
-				result.push_back( mPoints[firstPoint] );
-				subdivideQuadratic( distanceToleranceSqr, mPoints[firstPoint], mPoints[firstPoint+1], mPoints[firstPoint+2], 0, &result );
-				result.push_back( mPoints[firstPoint+2] );
+				result->push_back( mPoints[firstPoint] );
+				subdivideQuadratic( distanceToleranceSqr, mPoints[firstPoint], mPoints[firstPoint+1], mPoints[firstPoint+2], 0, result );
+				result->push_back( mPoints[firstPoint+2] );
 			break;
 			case LINETO:
-				result.push_back( mPoints[firstPoint] );
-				result.push_back( mPoints[firstPoint+1] );
+				result->push_back( mPoints[firstPoint] );
+				result->push_back( mPoints[firstPoint+1] );
 			break;
 			case CLOSE:
-				result.push_back( mPoints[firstPoint] );
-				result.push_back( mPoints[0] );
+				result->push_back( mPoints[firstPoint] );
+				result->push_back( mPoints[0] );
 			break;
 			default:
 				throw Path2dExc();
@@ -502,8 +509,6 @@ vector<Vec2f> Path2d::subdivide( float approximationScale ) const
 		
 		firstPoint += sSegmentTypePointCounts[mSegments[s]];
 	}
-	
-	return result;
 }
 
 // This technique is due to Maxim Shemanarev but removes his tangent error estimates
@@ -1153,5 +1158,17 @@ float Path2dCalcCache::calcTimeForDistance( float distance, bool wrap, float tol
 	return mPath.segmentSolveTimeForDistance( currentSegment, currentSegmentLength, distance, tolerance, maxIterations );
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Path2dSubdivisionCache
+const vector<Vec2f>& Path2dSubdivisionCache::getSubdivision( float approximationScale )
+{
+	if( mDirty || approximationScale != mApproximationScale ) {
+		mPath.subdivide( &mSubdivision, approximationScale );
+		mApproximationScale = approximationScale;
+		mDirty = false;
+	}
+
+	return mSubdivision;
+}
 
 } // namespace cinder
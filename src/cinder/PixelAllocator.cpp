@@ -0,0 +1,218 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/PixelAllocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#if defined( CINDER_MSW ) || defined( CINDER_WINRT )
+	#include <malloc.h>
+#endif
+
+namespace cinder {
+
+namespace {
+
+void* allocateAligned( size_t numBytes )
+{
+	numBytes = PixelAllocator::alignSize( std::max<size_t>( numBytes, 1 ) );
+#if defined( CINDER_MSW ) || defined( CINDER_WINRT )
+	void *result = ::_aligned_malloc( numBytes, PixelAllocator::ALIGNMENT );
+#else
+	void *result = nullptr;
+	if( ::posix_memalign( &result, PixelAllocator::ALIGNMENT, numBytes ) != 0 )
+		result = nullptr;
+#endif
+	if( ! result )
+		throw std::bad_alloc();
+	return result;
+}
+
+void freeAligned( void *data )
+{
+#if defined( CINDER_MSW ) || defined( CINDER_WINRT )
+	::_aligned_free( data );
+#else
+	::free( data );
+#endif
+}
+
+std::mutex			sDefaultAllocatorMutex;
+PixelAllocatorRef	sDefaultAllocator;
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PixelAllocator
+PixelAllocatorRef PixelAllocator::getDefault()
+{
+	std::lock_guard<std::mutex> lock( sDefaultAllocatorMutex );
+	if( ! sDefaultAllocator )
+		sDefaultAllocator = PixelAllocatorAligned::create();
+	return sDefaultAllocator;
+}
+
+void PixelAllocator::setDefault( const PixelAllocatorRef &allocator )
+{
+	std::lock_guard<std::mutex> lock( sDefaultAllocatorMutex );
+	sDefaultAllocator = allocator;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PixelAllocatorAligned
+void* PixelAllocatorAligned::allocate( size_t numBytes )
+{
+	return allocateAligned( numBytes );
+}
+
+void PixelAllocatorAligned::deallocate( void *data, size_t /*numBytes*/ )
+{
+	freeAligned( data );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PixelAllocatorPool
+PixelAllocatorPool::PixelAllocatorPool( size_t maxPooledBytes )
+	: mMaxPooledBytes( maxPooledBytes ), mPooledBytes( 0 ), mResidentBytes( 0 ), mNumAllocations( 0 ), mNumHits( 0 )
+{
+}
+
+PixelAllocatorPool::~PixelAllocatorPool()
+{
+	purge();
+}
+
+void* PixelAllocatorPool::allocate( size_t numBytes )
+{
+	const size_t bucketSize = alignSize( std::max<size_t>( numBytes, 1 ) );
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		++mNumAllocations;
+		auto bucketIt = mBuckets.find( bucketSize );
+		if( bucketIt != mBuckets.end() && ! bucketIt->second.empty() ) {
+			void *result = bucketIt->second.back();
+			bucketIt->second.pop_back();
+			mPooledBytes -= bucketSize;
+			++mNumHits;
+			return result;
+		}
+	}
+
+	// allocate outside the lock
+	void *result = allocateAligned( bucketSize );
+	std::lock_guard<std::mutex> lock( mMutex );
+	mResidentBytes += bucketSize;
+	return result;
+}
+
+void PixelAllocatorPool::deallocate( void *data, size_t numBytes )
+{
+	if( ! data )
+		return;
+
+	const size_t bucketSize = alignSize( std::max<size_t>( numBytes, 1 ) );
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		if( mPooledBytes + bucketSize <= mMaxPooledBytes ) {
+			mBuckets[bucketSize].push_back( data );
+			mPooledBytes += bucketSize;
+			return;
+		}
+		mResidentBytes -= bucketSize;
+	}
+
+	freeAligned( data );
+}
+
+void PixelAllocatorPool::purge()
+{
+	trim( 0 );
+}
+
+void PixelAllocatorPool::setMaxPooledBytes( size_t maxPooledBytes )
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mMaxPooledBytes = maxPooledBytes;
+	}
+	trim( maxPooledBytes );
+}
+
+void PixelAllocatorPool::trim( size_t maxPooledBytes )
+{
+	std::vector<void*> released;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		// release the largest buckets first, since they are the least likely to be reused
+		for( auto bucketIt = mBuckets.rbegin(); bucketIt != mBuckets.rend() && mPooledBytes > maxPooledBytes; ++bucketIt ) {
+			while( ! bucketIt->second.empty() && mPooledBytes > maxPooledBytes ) {
+				released.push_back( bucketIt->second.back() );
+				bucketIt->second.pop_back();
+				mPooledBytes -= bucketIt->first;
+				mResidentBytes -= bucketIt->first;
+			}
+		}
+	}
+
+	for( size_t i = 0; i < released.size(); ++i )
+		freeAligned( released[i] );
+}
+
+size_t PixelAllocatorPool::getNumAllocations() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mNumAllocations;
+}
+
+size_t PixelAllocatorPool::getNumHits() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mNumHits;
+}
+
+float PixelAllocatorPool::getHitRate() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return ( mNumAllocations > 0 ) ? ( mNumHits / (float)mNumAllocations ) : 0.0f;
+}
+
+size_t PixelAllocatorPool::getResidentBytes() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mResidentBytes;
+}
+
+size_t PixelAllocatorPool::getPooledBytes() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mPooledBytes;
+}
+
+void PixelAllocatorPool::resetStats()
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mNumAllocations = mNumHits = 0;
+}
+
+} // namespace cinder
@@ -21,11 +21,9 @@
 */
 
 #include "cinder/PolyLine.h"
+#include "cinder/PolygonClipper.h"
 
-#include <boost/geometry.hpp>
-#include <boost/geometry/geometries/point_xy.hpp>
-#include <boost/geometry/geometries/polygon.hpp>
-#include <boost/geometry/multi/multi.hpp>
+#include <mutex>
 
 namespace cinder {
 
@@ -109,47 +107,70 @@ bool PolyLine<T>::contains( const Vec2f &pt ) const
 
 
 namespace {
-typedef boost::geometry::model::polygon<boost::geometry::model::d2::point_xy<double> > polygon;
+// The static boolean and offset functions borrow their PolygonClipper from this pool, so its scratch memory is reused across calls (and threads) rather than reallocated each time
+class PolygonClipperPool {
+  public:
+	~PolygonClipperPool()
+	{
+		for( size_t i = 0; i < mClippers.size(); ++i )
+			delete mClippers[i];
+	}
 
-template<typename T>
-std::vector<PolyLine<T> > convertBoostGeometryPolygons( std::vector<polygon> &polygons )
-{
-	std::vector<PolyLine<T> > result;
-	for( std::vector<polygon>::const_iterator outIt = polygons.begin(); outIt != polygons.end(); ++outIt ) {
-		typedef polygon::inner_container_type::const_iterator RingIterator;
-		typedef polygon::ring_type::const_iterator PointIterator;
-
-		result.push_back( PolyLine<T>() );	
-		for( PointIterator pt = outIt->outer().begin(); pt != outIt->outer().end(); ++pt )
-			result.back().push_back( T( boost::geometry::get<0>(*pt), boost::geometry::get<1>(*pt) ) );
-
-		for( RingIterator crunk = outIt->inners().begin(); crunk != outIt->inners().end(); ++crunk ) {
-			PolyLine<T> contour;
-			for( PointIterator pt = crunk->begin(); pt != crunk->end(); ++pt )
-				contour.push_back( T( boost::geometry::get<0>(*pt), boost::geometry::get<1>(*pt) ) );
-			result.push_back( contour );
+	PolygonClipper*	acquire()
+	{
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			if( ! mClippers.empty() ) {
+				PolygonClipper *result = mClippers.back();
+				mClippers.pop_back();
+				return result;
+			}
 		}
+		return new PolygonClipper;
 	}
-	
-	return result;
-}
+
+	void	release( PolygonClipper *clipper )
+	{
+		clipper->clear();
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			if( mClippers.size() < MAX_POOLED_CLIPPERS ) {
+				mClippers.push_back( clipper );
+				return;
+			}
+		}
+		delete clipper;
+	}
+
+  private:
+	static const size_t	MAX_POOLED_CLIPPERS = 8;
+
+	std::mutex						mMutex;
+	std::vector<PolygonClipper*>	mClippers;
+};
+
+PolygonClipperPool sPolygonClipperPool;
+
+class ScopedPolygonClipper : private boost::noncopyable {
+  public:
+	ScopedPolygonClipper() : mClipper( sPolygonClipperPool.acquire() ) {}
+	~ScopedPolygonClipper() { sPolygonClipperPool.release( mClipper ); }
+
+	PolygonClipper*	operator->() const { return mClipper; }
+
+  private:
+	PolygonClipper	*mClipper;
+};
 
 template<typename T>
-polygon convertPolyLinesToBoostGeometry( const std::vector<PolyLine<T> > &a )
+std::vector<PolyLine<T> > calcBoolean( PolygonClipper::Operation op, const std::vector<PolyLine<T> > &a, const std::vector<PolyLine<T> > &b )
 {
-	polygon result;
-	
-	for( typename std::vector<T>::const_iterator ptIt = a[0].getPoints().begin(); ptIt != a[0].getPoints().end(); ++ptIt )
-		result.outer().push_back( boost::geometry::make<boost::geometry::model::d2::point_xy<double> >( ptIt->x, ptIt->y ) );
-	for( typename std::vector<PolyLine<T> >::const_iterator plIt = a.begin() + 1; plIt != a.end(); ++plIt ) {
-		polygon::ring_type ring;
-		for( typename std::vector<T>::const_iterator ptIt = plIt->getPoints().begin(); ptIt != plIt->getPoints().end(); ++ptIt )
-			ring.push_back( boost::geometry::make<boost::geometry::model::d2::point_xy<double> >( ptIt->x, ptIt->y ) );
-		result.inners().push_back( ring );
-	}
-	
-	boost::geometry::correct( result );
-	
+	ScopedPolygonClipper clipper;
+	clipper->addSubject( a );
+	clipper->addClip( b );
+
+	std::vector<PolyLine<T> > result;
+	clipper->calcBoolean( op, &result );
 	return result;
 }
 } // anonymous namespace
@@ -157,77 +178,36 @@ polygon convertPolyLinesToBoostGeometry( const std::vector<PolyLine<T> > &a )
 template<typename T>
 std::vector<PolyLine<T> > PolyLine<T>::calcUnion( const std::vector<PolyLine<T> > &a, std::vector<PolyLine<T> > &b )
 {
-	typedef boost::geometry::model::polygon<boost::geometry::model::d2::point_xy<double> > polygon;
-
-	if( a.empty() )
-		return b;
-	else if( b.empty() )
-		return a;
-
-	polygon polyA = convertPolyLinesToBoostGeometry( a );
-	polygon polyB = convertPolyLinesToBoostGeometry( b );
-	
-	std::vector<polygon> output;
-	boost::geometry::union_( polyA, polyB, output );
-
-	return convertBoostGeometryPolygons<T>( output );
+	return calcBoolean( PolygonClipper::UNION, a, b );
 }
 
 template<typename T>
 std::vector<PolyLine<T> > PolyLine<T>::calcIntersection( const std::vector<PolyLine<T> > &a, std::vector<PolyLine<T> > &b )
 {
-	typedef boost::geometry::model::polygon<boost::geometry::model::d2::point_xy<double> > polygon;
-
-	if( a.empty() )
-		return b;
-	else if( b.empty() )
-		return a;
-
-	polygon polyA = convertPolyLinesToBoostGeometry( a );
-	polygon polyB = convertPolyLinesToBoostGeometry( b );
-	
-	std::vector<polygon> output;
-	boost::geometry::intersection( polyA, polyB, output );
-
-	return convertBoostGeometryPolygons<T>( output );
+	return calcBoolean( PolygonClipper::INTERSECTION, a, b );
 }
 
 template<typename T>
 std::vector<PolyLine<T> > PolyLine<T>::calcXor( const std::vector<PolyLine<T> > &a, std::vector<PolyLine<T> > &b )
 {
-	typedef boost::geometry::model::polygon<boost::geometry::model::d2::point_xy<double> > polygon;
-
-	if( a.empty() )
-		return b;
-	else if( b.empty() )
-		return a;
-
-	polygon polyA = convertPolyLinesToBoostGeometry( a );
-	polygon polyB = convertPolyLinesToBoostGeometry( b );
-	
-	std::vector<polygon> output;
-	boost::geometry::sym_difference( polyA, polyB, output );
-
-	return convertBoostGeometryPolygons<T>( output );
+	return calcBoolean( PolygonClipper::XOR, a, b );
 }
 
 template<typename T>
 std::vector<PolyLine<T> > PolyLine<T>::calcDifference( const std::vector<PolyLine<T> > &a, std::vector<PolyLine<T> > &b )
 {
-	typedef boost::geometry::model::polygon<boost::geometry::model::d2::point_xy<double> > polygon;
-
-	if( a.empty() )
-		return b;
-	else if( b.empty() )
-		return a;
+	return calcBoolean( PolygonClipper::DIFFERENCE, a, b );
+}
 
-	polygon polyA = convertPolyLinesToBoostGeometry( a );
-	polygon polyB = convertPolyLinesToBoostGeometry( b );
-	
-	std::vector<polygon> output;
-	boost::geometry::difference( polyA, polyB, output );
+template<typename T>
+std::vector<PolyLine<T> > PolyLine<T>::calcOffset( const std::vector<PolyLine<T> > &a, typename T::TYPE distance )
+{
+	ScopedPolygonClipper clipper;
+	clipper->addSubject( a );
 
-	return convertBoostGeometryPolygons<T>( output );
+	std::vector<PolyLine<T> > result;
+	clipper->calcOffset( distance, &result );
+	return result;
 }
 
 template class PolyLine<Vec2f>;
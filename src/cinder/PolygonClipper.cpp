@@ -0,0 +1,891 @@
+/*
+ Copyright (c) 2014, The Cinder Project: http://libcinder.org
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/PolygonClipper.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+// Input is snapped to integers in [0, GRID_SIZE], which keeps every cross product of edge vectors exact in both int64_t and double
+const double GRID_SIZE = double( 1 << 25 );
+
+struct IntPoint {
+	IntPoint() {}
+	IntPoint( int64_t x, int64_t y ) : x( x ), y( y ) {}
+
+	bool operator==( const IntPoint &rhs ) const { return x == rhs.x && y == rhs.y; }
+	bool operator!=( const IntPoint &rhs ) const { return x != rhs.x || y != rhs.y; }
+
+	int64_t		x, y;
+};
+
+// Non-horizontal input edge, stored bottom to top
+struct Edge {
+	double	xAt( double y ) const
+	{
+		if( y <= mY0 )
+			return mX0;
+		else if( y >= mY1 )
+			return mX1;
+		else
+			return mX0 + ( y - mY0 ) * mDxDy;
+	}
+
+	int64_t		mX0, mY0, mX1, mY1;
+	int			mWind;		// +1 for edges running downwards, -1 upwards
+	int			mPoly;		// 0 for subject, 1 for clip
+	double		mDxDy;
+	int			mIndex;			// position in the active list, or -1
+	int			mWinding[2];	// subject and clip winding numbers immediately right of the edge
+	bool		mFilled;		// whether the result is filled immediately right of the edge
+	double		mX;				// x at the most recent event involving the edge
+	int			mSide;			// which side of the result the edge currently bounds
+	double		mSideX, mSideY;	// where it started doing so
+};
+
+enum { SIDE_NONE, SIDE_LEFT, SIDE_RIGHT };
+
+bool edgeYLess( const Edge &a, const Edge &b )
+{
+	return a.mY0 < b.mY0;
+}
+
+bool edgeTopLess( const Edge *a, const Edge *b )
+{
+	return a->mY1 < b->mY1;
+}
+
+// Returns dx/dy of \a a compared to \a b as -1, 0 or 1
+int compareSlopes( const Edge *a, const Edge *b )
+{
+	int64_t lhs = ( a->mX1 - a->mX0 ) * ( b->mY1 - b->mY0 );
+	int64_t rhs = ( b->mX1 - b->mX0 ) * ( a->mY1 - a->mY0 );
+	return ( lhs < rhs ) ? -1 : ( ( lhs > rhs ) ? 1 : 0 );
+}
+
+double calcCrossingY( const Edge *a, const Edge *b )
+{
+	int64_t adx = a->mX1 - a->mX0, ady = a->mY1 - a->mY0;
+	int64_t bdx = b->mX1 - b->mX0, bdy = b->mY1 - b->mY0;
+	int64_t den = adx * bdy - ady * bdx;
+	int64_t num = ( b->mX0 - a->mX0 ) * bdy - ( b->mY0 - a->mY0 ) * bdx;
+	return a->mY0 + ady * ( (double)num / (double)den );
+}
+
+// Pending intersection of adjacent active edges; ordered for use as a min-heap
+struct Crossing {
+	Crossing() {}
+	Crossing( double y, Edge *left, Edge *right ) : mY( y ), mLeft( left ), mRight( right ) {}
+
+	bool operator<( const Crossing &rhs ) const { return mY > rhs.mY; }
+
+	double		mY;
+	Edge		*mLeft, *mRight;
+};
+
+// Boundary segment of the result; \a mEdge is the index of the input edge it lies on or -1 for horizontal segments
+struct Segment {
+	Segment() {}
+	Segment( double x0, double y0, double x1, double y1, int edge ) : mX0( x0 ), mY0( y0 ), mX1( x1 ), mY1( y1 ), mEdge( edge ) {}
+
+	double		mX0, mY0, mX1, mY1;
+	int			mEdge;
+};
+
+// Signed angle turned from \a a to \a b, positive to the left
+double calcTurn( const Segment &a, const Segment &b )
+{
+	Vec2d dirA( a.mX1 - a.mX0, a.mY1 - a.mY0 ), dirB( b.mX1 - b.mX0, b.mY1 - b.mY0 );
+	return math<double>::atan2( dirA.x * dirB.y - dirA.y * dirB.x, dirA.dot( dirB ) );
+}
+
+struct SegmentStartLess {
+	SegmentStartLess( const std::vector<Segment> &segments ) : mSegments( segments ) {}
+
+	bool operator()( size_t a, size_t b ) const
+	{
+		const Segment &sa = mSegments[a], &sb = mSegments[b];
+		return ( sa.mX0 < sb.mX0 ) || ( sa.mX0 == sb.mX0 && sa.mY0 < sb.mY0 );
+	}
+
+	bool operator()( size_t a, const Vec2d &pt ) const
+	{
+		const Segment &sa = mSegments[a];
+		return ( sa.mX0 < pt.x ) || ( sa.mX0 == pt.x && sa.mY0 < pt.y );
+	}
+
+	bool operator()( const Vec2d &pt, size_t b ) const
+	{
+		const Segment &sb = mSegments[b];
+		return ( pt.x < sb.mX0 ) || ( pt.x == sb.mX0 && pt.y < sb.mY0 );
+	}
+
+	const std::vector<Segment>	&mSegments;
+};
+
+struct HorizontalEvent {
+	HorizontalEvent() {}
+	HorizontalEvent( double x, int delta ) : mX( x ), mDelta( delta ) {}
+
+	bool operator<( const HorizontalEvent &rhs ) const { return mX < rhs.mX; }
+
+	double		mX;
+	int			mDelta;
+};
+
+bool isFilled( int winding, PolygonClipper::FillRule fillRule )
+{
+	switch( fillRule ) {
+		case PolygonClipper::FILL_EVEN_ODD:		return ( winding & 1 ) != 0;
+		case PolygonClipper::FILL_NONZERO:		return winding != 0;
+		case PolygonClipper::FILL_POSITIVE:		return winding > 0;
+		case PolygonClipper::FILL_NEGATIVE:		return winding < 0;
+	}
+	return false;
+}
+
+bool applyOperation( bool a, bool b, PolygonClipper::Operation op )
+{
+	switch( op ) {
+		case PolygonClipper::UNION:			return a || b;
+		case PolygonClipper::INTERSECTION:	return a && b;
+		case PolygonClipper::XOR:			return a != b;
+		case PolygonClipper::DIFFERENCE:	return a && ! b;
+	}
+	return false;
+}
+
+double calcArea( const Vec2d *pts, size_t count )
+{
+	double result = 0;
+	for( size_t i = 0, j = count - 1; i < count; j = i++ )
+		result += pts[j].x * pts[i].y - pts[i].x * pts[j].y;
+	return result * 0.5;
+}
+
+bool contains( const Vec2d *pts, size_t count, const Vec2d &pt )
+{
+	bool result = false;
+	for( size_t i = 0, j = count - 1; i < count; j = i++ ) {
+		if( ( pts[i].y > pt.y ) != ( pts[j].y > pt.y ) ) {
+			double x = pts[i].x + ( pts[j].x - pts[i].x ) * ( pt.y - pts[i].y ) / ( pts[j].y - pts[i].y );
+			if( pt.x < x )
+				result = ! result;
+		}
+	}
+	return result;
+}
+
+} // anonymous namespace
+
+class PolygonClipper::Impl {
+  public:
+	// Input contours in user coordinates, indexed by subject (0) and clip (1)
+	std::vector<Vec2d>		mInput[2];
+	std::vector<size_t>		mInputEnds[2];
+
+	// Input contours snapped to the grid
+	std::vector<IntPoint>	mGrid[2];
+	std::vector<size_t>		mGridEnds[2];
+	Vec2d					mOrigin;
+	double					mScale;
+
+	// Sweep state
+	Operation				mOperation;
+	FillRule				mFillRules[2];
+	std::vector<Edge>		mEdges;
+	std::vector<Edge*>		mEdgesByTop;
+	std::vector<int64_t>	mScanlines;
+	std::vector<Edge*>		mActive, mRange;
+	std::vector<Crossing>	mCrossings;
+	std::vector<HorizontalEvent>	mEvents;
+	double					mY;
+	std::vector<Segment>	mSegments;
+	std::vector<size_t>		mOrder;
+	std::vector<bool>		mUsed;
+	std::vector<int>		mChainEdges;
+
+	// Result contours in grid coordinates
+	std::vector<Vec2d>		mContours;
+	std::vector<size_t>		mContourEnds;
+	std::vector<double>		mContourAreas;
+
+	// Offset scratch
+	std::vector<Vec2d>		mNormals, mJoin;
+
+	// Output scratch
+	std::vector<size_t>		mParents, mOutputOrder;
+
+	void	snapToGrid( double margin );
+	bool	inputBoundsOverlap() const;
+	void	sweep( Operation op, FillRule fillRuleSubject, FillRule fillRuleClip );
+	void	offset( double delta, JoinType joinType, double miterLimit, double arcTolerance );
+	template<typename T>
+	void	outputContours( std::vector<PolyLine<T> > *result );
+
+  private:
+	void	buildEdges();
+	size_t	findActive( double x, bool inclusive ) const;
+	void	processScanline( size_t firstStarting, size_t lastStarting, size_t firstEnding, size_t lastEnding );
+	void	processCrossing( const Crossing &crossing );
+	void	addCrossing( int leftIndex );
+	int		updateEdge( Edge *edge );
+	void	endSide( Edge *edge );
+	void	addHorizontals();
+	void	buildContours();
+};
+
+void PolygonClipper::Impl::snapToGrid( double margin )
+{
+	Vec2d minPt( numeric_limits<double>::max(), numeric_limits<double>::max() );
+	Vec2d maxPt( -numeric_limits<double>::max(), -numeric_limits<double>::max() );
+	for( int poly = 0; poly < 2; ++poly ) {
+		for( vector<Vec2d>::const_iterator ptIt = mInput[poly].begin(); ptIt != mInput[poly].end(); ++ptIt ) {
+			minPt.x = std::min( minPt.x, ptIt->x ); minPt.y = std::min( minPt.y, ptIt->y );
+			maxPt.x = std::max( maxPt.x, ptIt->x ); maxPt.y = std::max( maxPt.y, ptIt->y );
+		}
+	}
+
+	mOrigin = minPt - Vec2d( margin, margin );
+	double extent = std::max( maxPt.x - minPt.x, maxPt.y - minPt.y ) + margin * 2;
+	mScale = ( extent > 0 ) ? GRID_SIZE / extent : 1.0;
+
+	for( int poly = 0; poly < 2; ++poly ) {
+		mGrid[poly].clear();
+		mGridEnds[poly].clear();
+		size_t begin = 0;
+		for( size_t c = 0; c < mInputEnds[poly].size(); ++c ) {
+			size_t first = mGrid[poly].size();
+			for( size_t i = begin; i < mInputEnds[poly][c]; ++i ) {
+				const Vec2d &p = mInput[poly][i];
+				IntPoint ip( (int64_t)math<double>::floor( ( p.x - mOrigin.x ) * mScale + 0.5 ), (int64_t)math<double>::floor( ( p.y - mOrigin.y ) * mScale + 0.5 ) );
+				if( mGrid[poly].size() == first || mGrid[poly].back() != ip )
+					mGrid[poly].push_back( ip );
+			}
+			if( mGrid[poly].size() > first + 1 && mGrid[poly].back() == mGrid[poly][first] )
+				mGrid[poly].pop_back();
+			if( mGrid[poly].size() < first + 3 )
+				mGrid[poly].resize( first );
+			else
+				mGridEnds[poly].push_back( mGrid[poly].size() );
+			begin = mInputEnds[poly][c];
+		}
+	}
+}
+
+bool PolygonClipper::Impl::inputBoundsOverlap() const
+{
+	IntPoint minPt[2], maxPt[2];
+	for( int poly = 0; poly < 2; ++poly ) {
+		if( mGrid[poly].empty() )
+			return false;
+		minPt[poly] = maxPt[poly] = mGrid[poly][0];
+		for( vector<IntPoint>::const_iterator ptIt = mGrid[poly].begin(); ptIt != mGrid[poly].end(); ++ptIt ) {
+			minPt[poly].x = std::min( minPt[poly].x, ptIt->x ); minPt[poly].y = std::min( minPt[poly].y, ptIt->y );
+			maxPt[poly].x = std::max( maxPt[poly].x, ptIt->x ); maxPt[poly].y = std::max( maxPt[poly].y, ptIt->y );
+		}
+	}
+	return minPt[0].x <= maxPt[1].x && minPt[1].x <= maxPt[0].x && minPt[0].y <= maxPt[1].y && minPt[1].y <= maxPt[0].y;
+}
+
+void PolygonClipper::Impl::buildEdges()
+{
+	mEdges.clear();
+	mScanlines.clear();
+	for( int poly = 0; poly < 2; ++poly ) {
+		size_t begin = 0;
+		for( size_t c = 0; c < mGridEnds[poly].size(); ++c ) {
+			size_t end = mGridEnds[poly][c];
+			for( size_t i = begin; i < end; ++i ) {
+				const IntPoint &a = mGrid[poly][i];
+				const IntPoint &b = mGrid[poly][( i + 1 < end ) ? i + 1 : begin];
+				if( a.y == b.y )
+					continue;
+				Edge e;
+				const IntPoint &bottom = ( a.y < b.y ) ? a : b;
+				const IntPoint &top = ( a.y < b.y ) ? b : a;
+				e.mX0 = bottom.x; e.mY0 = bottom.y;
+				e.mX1 = top.x; e.mY1 = top.y;
+				e.mWind = ( a.y < b.y ) ? -1 : 1;
+				e.mPoly = poly;
+				e.mDxDy = double( e.mX1 - e.mX0 ) / double( e.mY1 - e.mY0 );
+				e.mIndex = -1;
+				e.mSide = SIDE_NONE;
+				mEdges.push_back( e );
+				mScanlines.push_back( e.mY0 );
+				mScanlines.push_back( e.mY1 );
+			}
+			begin = end;
+		}
+	}
+
+	std::sort( mEdges.begin(), mEdges.end(), edgeYLess );
+	mEdgesByTop.resize( mEdges.size() );
+	for( size_t i = 0; i < mEdges.size(); ++i )
+		mEdgesByTop[i] = &mEdges[i];
+	std::sort( mEdgesByTop.begin(), mEdgesByTop.end(), edgeTopLess );
+	std::sort( mScanlines.begin(), mScanlines.end() );
+	mScanlines.erase( std::unique( mScanlines.begin(), mScanlines.end() ), mScanlines.end() );
+}
+
+size_t PolygonClipper::Impl::findActive( double x, bool inclusive ) const
+{
+	// first active edge right of x (or at it, when not \a inclusive) at the current scanline
+	size_t lo = 0, hi = mActive.size();
+	while( lo < hi ) {
+		size_t mid = ( lo + hi ) / 2;
+		double midX = mActive[mid]->xAt( mY );
+		if( midX < x || ( inclusive && midX == x ) )
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+int PolygonClipper::Impl::updateEdge( Edge *edge )
+{
+	// recalculates the winding to the right of the edge from its left neighbor, starting a new boundary segment if the side it bounds changes
+	const Edge *left = ( edge->mIndex > 0 ) ? mActive[edge->mIndex - 1] : 0;
+	bool filledLeft = left ? left->mFilled : false;
+	edge->mWinding[0] = left ? left->mWinding[0] : 0;
+	edge->mWinding[1] = left ? left->mWinding[1] : 0;
+	edge->mWinding[edge->mPoly] += edge->mWind;
+	edge->mFilled = applyOperation( isFilled( edge->mWinding[0], mFillRules[0] ), isFilled( edge->mWinding[1], mFillRules[1] ), mOperation );
+
+	int side = ( filledLeft == edge->mFilled ) ? SIDE_NONE : ( edge->mFilled ? SIDE_LEFT : SIDE_RIGHT );
+	if( side != edge->mSide ) {
+		endSide( edge );
+		edge->mSide = side;
+		edge->mSideX = edge->mX;
+		edge->mSideY = mY;
+	}
+	return side;
+}
+
+void PolygonClipper::Impl::endSide( Edge *edge )
+{
+	// interior lies to the left of each boundary segment: down the left side, up the right
+	int index = (int)( edge - &mEdges[0] );
+	if( edge->mX != edge->mSideX || mY != edge->mSideY ) {
+		if( edge->mSide == SIDE_LEFT )
+			mSegments.push_back( Segment( edge->mX, mY, edge->mSideX, edge->mSideY, index ) );
+		else if( edge->mSide == SIDE_RIGHT )
+			mSegments.push_back( Segment( edge->mSideX, edge->mSideY, edge->mX, mY, index ) );
+	}
+	edge->mSide = SIDE_NONE;
+}
+
+void PolygonClipper::Impl::addCrossing( int leftIndex )
+{
+	if( leftIndex < 0 || leftIndex + 1 >= (int)mActive.size() )
+		return;
+
+	// only edges converging going up can cross, and only before either ends
+	Edge *left = mActive[leftIndex], *right = mActive[leftIndex + 1];
+	if( compareSlopes( left, right ) <= 0 )
+		return;
+	double y = calcCrossingY( left, right );
+	if( y >= (double)std::min( left->mY1, right->mY1 ) )
+		return;
+
+	// crossings that round below the sweep line are resolved immediately
+	mCrossings.push_back( Crossing( std::max( y, mY ), left, right ) );
+	std::push_heap( mCrossings.begin(), mCrossings.end() );
+}
+
+void PolygonClipper::Impl::processCrossing( const Crossing &crossing )
+{
+	Edge *left = crossing.mLeft, *right = crossing.mRight;
+	if( left->mIndex < 0 || right->mIndex != left->mIndex + 1 )
+		return;
+
+	// both edges share a single crossing point so the boundary segments meeting there connect exactly
+	mY = crossing.mY;
+	left->mX = right->mX = ( left->xAt( mY ) + right->xAt( mY ) ) * 0.5;
+
+	int index = left->mIndex;
+	mActive[index] = right;
+	mActive[index + 1] = left;
+	right->mIndex = index;
+	left->mIndex = index + 1;
+
+	// the winding right of the pair is unchanged, so only these two edges need updating
+	updateEdge( right );
+	updateEdge( left );
+	addCrossing( index - 1 );
+	addCrossing( index + 1 );
+}
+
+void PolygonClipper::Impl::processScanline( size_t firstStarting, size_t lastStarting, size_t firstEnding, size_t lastEnding )
+{
+	// Every contour passing through the scanline does so as a closed chain of vertices and horizontal edges, so winding
+	// numbers can only change between the leftmost and rightmost vertex on it.
+	double xMin = numeric_limits<double>::max(), xMax = -numeric_limits<double>::max();
+	int lo = (int)mActive.size(), hi = -1;
+	for( size_t e = firstEnding; e < lastEnding; ++e ) {
+		xMin = std::min( xMin, (double)mEdgesByTop[e]->mX1 );
+		xMax = std::max( xMax, (double)mEdgesByTop[e]->mX1 );
+		lo = std::min( lo, mEdgesByTop[e]->mIndex );
+		hi = std::max( hi, mEdgesByTop[e]->mIndex );
+	}
+	for( size_t e = firstStarting; e < lastStarting; ++e ) {
+		xMin = std::min( xMin, (double)mEdges[e].mX0 );
+		xMax = std::max( xMax, (double)mEdges[e].mX0 );
+	}
+	lo = std::min( lo, (int)findActive( xMin, false ) );
+	hi = std::max( hi, (int)findActive( xMax, true ) - 1 );
+
+	// record the boundary below the scanline and retire the edges ending on it
+	mEvents.clear();
+	mRange.clear();
+	for( int i = lo; i <= hi; ++i ) {
+		Edge *e = mActive[i];
+		e->mX = e->xAt( mY );
+		if( e->mSide == SIDE_LEFT )
+			mEvents.push_back( HorizontalEvent( e->mX, -1 ) );
+		else if( e->mSide == SIDE_RIGHT )
+			mEvents.push_back( HorizontalEvent( e->mX, 1 ) );
+
+		if( e->mY1 <= mY ) {
+			endSide( e );
+			e->mIndex = -1;
+		}
+		else
+			mRange.push_back( e );
+	}
+
+	// merge in the starting edges, ordered by x and then by the direction they leave the scanline
+	for( size_t s = firstStarting; s < lastStarting; ++s ) {
+		Edge *e = &mEdges[s];
+		e->mX = (double)e->mX0;
+		vector<Edge*>::iterator it = mRange.begin();
+		for( ; it != mRange.end(); ++it ) {
+			if( (*it)->mX > e->mX || ( (*it)->mX == e->mX && compareSlopes( *it, e ) > 0 ) )
+				break;
+		}
+		mRange.insert( it, e );
+	}
+
+	int oldCount = std::max( hi - lo + 1, 0 );
+	int newCount = (int)mRange.size();
+	if( newCount == oldCount )
+		std::copy( mRange.begin(), mRange.end(), mActive.begin() + lo );
+	else {
+		mActive.erase( mActive.begin() + lo, mActive.begin() + lo + oldCount );
+		mActive.insert( mActive.begin() + lo, mRange.begin(), mRange.end() );
+	}
+	int reindexEnd = ( newCount == oldCount ) ? lo + newCount : (int)mActive.size();
+	for( int i = lo; i < reindexEnd; ++i )
+		mActive[i]->mIndex = i;
+
+	// and the boundary above it
+	for( int i = lo; i < lo + newCount; ++i ) {
+		int side = updateEdge( mActive[i] );
+		if( side == SIDE_LEFT )
+			mEvents.push_back( HorizontalEvent( mActive[i]->mX, 1 ) );
+		else if( side == SIDE_RIGHT )
+			mEvents.push_back( HorizontalEvent( mActive[i]->mX, -1 ) );
+	}
+	addHorizontals();
+
+	for( int i = lo - 1; i < lo + newCount; ++i )
+		addCrossing( i );
+}
+
+void PolygonClipper::Impl::addHorizontals()
+{
+	// Horizontal boundaries lie where the intervals covered above the scanline differ from those below it. Coverage is
+	// signed so that slightly misordered edges from rounding still produce a closed boundary.
+	std::sort( mEvents.begin(), mEvents.end() );
+
+	int coverage = 0;
+	for( size_t i = 0; i < mEvents.size(); ) {
+		double x = mEvents[i].mX;
+		for( ; i < mEvents.size() && mEvents[i].mX == x; ++i )
+			coverage += mEvents[i].mDelta;
+		if( coverage == 0 || i == mEvents.size() )
+			continue;
+		double nextX = mEvents[i].mX;
+		// interior above runs left to right, interior below right to left
+		for( int c = 0; c < coverage; ++c )
+			mSegments.push_back( Segment( x, mY, nextX, mY, -1 ) );
+		for( int c = 0; c > coverage; --c )
+			mSegments.push_back( Segment( nextX, mY, x, mY, -1 ) );
+	}
+}
+
+void PolygonClipper::Impl::sweep( Operation op, FillRule fillRuleSubject, FillRule fillRuleClip )
+{
+	mOperation = op;
+	mFillRules[0] = fillRuleSubject;
+	mFillRules[1] = fillRuleClip;
+	mSegments.clear();
+	mContours.clear();
+	mContourEnds.clear();
+	mContourAreas.clear();
+	mActive.clear();
+	mCrossings.clear();
+
+	buildEdges();
+
+	size_t nextStarting = 0, nextEnding = 0;
+	for( size_t scanline = 0; scanline < mScanlines.size(); ) {
+		double y = (double)mScanlines[scanline];
+		if( ! mCrossings.empty() && mCrossings.front().mY <= y ) {
+			std::pop_heap( mCrossings.begin(), mCrossings.end() );
+			Crossing crossing = mCrossings.back();
+			mCrossings.pop_back();
+			processCrossing( crossing );
+			continue;
+		}
+
+		mY = y;
+		size_t firstStarting = nextStarting, firstEnding = nextEnding;
+		while( nextStarting < mEdges.size() && mEdges[nextStarting].mY0 == mScanlines[scanline] )
+			++nextStarting;
+		while( nextEnding < mEdgesByTop.size() && mEdgesByTop[nextEnding]->mY1 == mScanlines[scanline] )
+			++nextEnding;
+		processScanline( firstStarting, nextStarting, firstEnding, nextEnding );
+		++scanline;
+	}
+
+	buildContours();
+}
+
+void PolygonClipper::Impl::buildContours()
+{
+	SegmentStartLess startLess( mSegments );
+	mOrder.resize( mSegments.size() );
+	for( size_t i = 0; i < mOrder.size(); ++i )
+		mOrder[i] = i;
+	std::sort( mOrder.begin(), mOrder.end(), startLess );
+	mUsed.assign( mSegments.size(), false );
+
+	for( size_t o = 0; o < mOrder.size(); ++o ) {
+		size_t first = mOrder[o];
+		if( mUsed[first] )
+			continue;
+
+		size_t contourBegin = mContours.size();
+		mChainEdges.clear();
+		Vec2d start( mSegments[first].mX0, mSegments[first].mY0 );
+		size_t cur = first;
+		for(;;) {
+			const Segment &s = mSegments[cur];
+			mUsed[cur] = true;
+			// consecutive segments along the same input edge (or both horizontal) are collinear
+			if( mChainEdges.empty() || mChainEdges.back() != s.mEdge ) {
+				mContours.push_back( Vec2d( s.mX0, s.mY0 ) );
+				mChainEdges.push_back( s.mEdge );
+			}
+
+			Vec2d end( s.mX1, s.mY1 );
+			if( end == start )
+				break;
+
+			// where boundaries touch at a point, take the sharpest left turn to keep contours simple
+			pair<vector<size_t>::iterator, vector<size_t>::iterator> range = std::equal_range( mOrder.begin(), mOrder.end(), end, startLess );
+			size_t next = mSegments.size();
+			double bestAngle = 0;
+			bool compared = false;
+			for( vector<size_t>::iterator it = range.first; it != range.second; ++it ) {
+				if( mUsed[*it] )
+					continue;
+				if( next == mSegments.size() ) {
+					next = *it;
+					continue;
+				}
+				if( ! compared ) {
+					bestAngle = calcTurn( s, mSegments[next] );
+					compared = true;
+				}
+				double angle = calcTurn( s, mSegments[*it] );
+				if( angle > bestAngle ) {
+					next = *it;
+					bestAngle = angle;
+				}
+			}
+			if( next == mSegments.size() )
+				break;
+			cur = next;
+		}
+
+		if( mChainEdges.size() > 1 && mChainEdges.front() == mChainEdges.back() ) {
+			mContours.erase( mContours.begin() + contourBegin );
+			mChainEdges.erase( mChainEdges.begin() );
+		}
+
+		size_t count = mContours.size() - contourBegin;
+		double area = ( count >= 3 ) ? calcArea( &mContours[contourBegin], count ) : 0;
+		// discard slivers left behind by rounding at edge crossings
+		if( math<double>::abs( area ) < 1e-3 ) {
+			mContours.resize( contourBegin );
+			continue;
+		}
+		mContourEnds.push_back( mContours.size() );
+		mContourAreas.push_back( area );
+	}
+}
+
+void PolygonClipper::Impl::offset( double delta, JoinType joinType, double miterLimit, double arcTolerance )
+{
+	// snapToGrid() and a normalizing sweep() have already run, so mContours holds oriented, non-intersecting contours
+	delta *= mScale;
+	arcTolerance *= mScale;
+	double absDelta = math<double>::abs( delta );
+
+	double miterThreshold = 2.0 / ( std::max( miterLimit, 1.0 ) * std::max( miterLimit, 1.0 ) );
+	if( arcTolerance <= 0 || arcTolerance > absDelta * 0.25 )
+		arcTolerance = absDelta * 0.25;
+	double steps = std::min( M_PI / math<double>::acos( 1 - arcTolerance / std::max( absDelta, 1e-12 ) ), absDelta * M_PI );
+	steps = std::max( steps, 4.0 );
+	double stepSin = math<double>::sin( 2 * M_PI / steps ), stepCos = math<double>::cos( 2 * M_PI / steps );
+	double stepsPerRadian = steps / ( 2 * M_PI );
+	if( delta < 0 )
+		stepSin = -stepSin;
+
+	mGrid[0].clear(); mGridEnds[0].clear();
+	mGrid[1].clear(); mGridEnds[1].clear();
+	std::vector<IntPoint> &out = mGrid[0];
+
+	size_t begin = 0;
+	for( size_t c = 0; c < mContourEnds.size(); ++c ) {
+		const Vec2d *pts = &mContours[begin];
+		size_t count = mContourEnds[c] - begin;
+		begin = mContourEnds[c];
+
+		// outward (right hand) unit normal of each edge
+		mNormals.resize( count );
+		for( size_t i = 0; i < count; ++i ) {
+			Vec2d d = pts[( i + 1 ) % count] - pts[i];
+			double len = d.length();
+			mNormals[i] = ( len > 0 ) ? Vec2d( d.y / len, -d.x / len ) : Vec2d::zero();
+		}
+
+		size_t first = out.size();
+		for( size_t j = 0, k = count - 1; j < count; k = j++ ) {
+			const Vec2d &p = pts[j];
+			const Vec2d &nk = mNormals[k], &nj = mNormals[j];
+			double sinA = math<double>::clamp( nk.x * nj.y - nj.x * nk.y, -1.0, 1.0 );
+			double cosA = nk.dot( nj );
+
+			vector<Vec2d> &joinPts = mJoin;
+			joinPts.clear();
+			if( math<double>::abs( sinA * delta ) < 1.0 && cosA > 0 ) {
+				// nearly straight
+				joinPts.push_back( p + nk * delta );
+			}
+			else if( sinA * delta < 0 ) {
+				// concave; the loop this forms has the wrong winding and is removed by the positive fill
+				joinPts.push_back( p + nk * delta );
+				joinPts.push_back( p );
+				joinPts.push_back( p + nj * delta );
+			}
+			else if( joinType == JOIN_MITER && 1 + cosA >= miterThreshold ) {
+				joinPts.push_back( p + ( nk + nj ) * ( delta / ( 1 + cosA ) ) );
+			}
+			else if( joinType == JOIN_ROUND ) {
+				double angle = math<double>::atan2( sinA, cosA );
+				int numSteps = std::max( (int)( stepsPerRadian * math<double>::abs( angle ) + 0.5 ), 1 );
+				Vec2d n = nk;
+				for( int s = 0; s < numSteps; ++s ) {
+					joinPts.push_back( p + n * delta );
+					n = Vec2d( n.x * stepCos - stepSin * n.y, n.x * stepSin + n.y * stepCos );
+				}
+				joinPts.push_back( p + nj * delta );
+			}
+			else {
+				// square, or a miter past its limit
+				double dx = math<double>::tan( math<double>::atan2( sinA, cosA ) / 4 );
+				joinPts.push_back( p + Vec2d( nk.x - nk.y * dx, nk.y + nk.x * dx ) * delta );
+				joinPts.push_back( p + Vec2d( nj.x + nj.y * dx, nj.y - nj.x * dx ) * delta );
+			}
+
+			for( vector<Vec2d>::const_iterator ptIt = joinPts.begin(); ptIt != joinPts.end(); ++ptIt ) {
+				IntPoint ip( (int64_t)math<double>::floor( ptIt->x + 0.5 ), (int64_t)math<double>::floor( ptIt->y + 0.5 ) );
+				if( out.size() == first || out.back() != ip )
+					out.push_back( ip );
+			}
+		}
+
+		if( out.size() - first >= 3 )
+			mGridEnds[0].push_back( out.size() );
+		else
+			out.resize( first );
+	}
+}
+
+template<typename T>
+void PolygonClipper::Impl::outputContours( std::vector<PolyLine<T> > *result )
+{
+	typedef typename T::TYPE R;
+
+	// group each hole after the smallest outer contour containing it
+	size_t numContours = mContourEnds.size();
+	vector<size_t> &parents = mParents;
+	parents.assign( numContours, numContours );
+	for( size_t h = 0; h < numContours; ++h ) {
+		if( mContourAreas[h] > 0 )
+			continue;
+		size_t hBegin = ( h == 0 ) ? 0 : mContourEnds[h-1];
+		Vec2d probe = ( mContours[hBegin] + mContours[hBegin+1] ) * 0.5;
+		double bestArea = numeric_limits<double>::max();
+		for( size_t o = 0; o < numContours; ++o ) {
+			if( mContourAreas[o] <= 0 || mContourAreas[o] >= bestArea )
+				continue;
+			size_t oBegin = ( o == 0 ) ? 0 : mContourEnds[o-1];
+			if( contains( &mContours[oBegin], mContourEnds[o] - oBegin, probe ) ) {
+				parents[h] = o;
+				bestArea = mContourAreas[o];
+			}
+		}
+	}
+
+	vector<size_t> &order = mOutputOrder;
+	order.clear();
+	for( size_t o = 0; o < numContours; ++o ) {
+		if( mContourAreas[o] <= 0 )
+			continue;
+		order.push_back( o );
+		for( size_t h = 0; h < numContours; ++h )
+			if( parents[h] == o )
+				order.push_back( h );
+	}
+	for( size_t h = 0; h < numContours; ++h )
+		if( mContourAreas[h] <= 0 && parents[h] == numContours )
+			order.push_back( h );
+
+	double invScale = 1.0 / mScale;
+	result->resize( order.size() );
+	for( size_t i = 0; i < order.size(); ++i ) {
+		size_t c = order[i];
+		size_t begin = ( c == 0 ) ? 0 : mContourEnds[c-1];
+		std::vector<T> &pts = (*result)[i].getPoints();
+		pts.clear();
+		for( size_t p = begin; p < mContourEnds[c]; ++p )
+			pts.push_back( T( (R)( mContours[p].x * invScale + mOrigin.x ), (R)( mContours[p].y * invScale + mOrigin.y ) ) );
+		pts.push_back( pts.front() );
+	}
+}
+
+PolygonClipper::PolygonClipper()
+	: mImpl( new Impl )
+{
+}
+
+PolygonClipper::~PolygonClipper()
+{
+}
+
+void PolygonClipper::clear()
+{
+	for( int poly = 0; poly < 2; ++poly ) {
+		mImpl->mInput[poly].clear();
+		mImpl->mInputEnds[poly].clear();
+	}
+}
+
+template<typename T>
+void PolygonClipper::addSubject( const PolyLine<T> &contour )
+{
+	for( typename PolyLine<T>::const_iterator ptIt = contour.begin(); ptIt != contour.end(); ++ptIt )
+		mImpl->mInput[0].push_back( Vec2d( ptIt->x, ptIt->y ) );
+	if( contour.size() < 3 )
+		mImpl->mInput[0].resize( mImpl->mInputEnds[0].empty() ? 0 : mImpl->mInputEnds[0].back() );
+	else
+		mImpl->mInputEnds[0].push_back( mImpl->mInput[0].size() );
+}
+
+template<typename T>
+void PolygonClipper::addSubject( const std::vector<PolyLine<T> > &contours )
+{
+	for( typename std::vector<PolyLine<T> >::const_iterator contourIt = contours.begin(); contourIt != contours.end(); ++contourIt )
+		addSubject( *contourIt );
+}
+
+template<typename T>
+void PolygonClipper::addClip( const PolyLine<T> &contour )
+{
+	for( typename PolyLine<T>::const_iterator ptIt = contour.begin(); ptIt != contour.end(); ++ptIt )
+		mImpl->mInput[1].push_back( Vec2d( ptIt->x, ptIt->y ) );
+	if( contour.size() < 3 )
+		mImpl->mInput[1].resize( mImpl->mInputEnds[1].empty() ? 0 : mImpl->mInputEnds[1].back() );
+	else
+		mImpl->mInputEnds[1].push_back( mImpl->mInput[1].size() );
+}
+
+template<typename T>
+void PolygonClipper::addClip( const std::vector<PolyLine<T> > &contours )
+{
+	for( typename std::vector<PolyLine<T> >::const_iterator contourIt = contours.begin(); contourIt != contours.end(); ++contourIt )
+		addClip( *contourIt );
+}
+
+template<typename T>
+void PolygonClipper::calcBoolean( Operation op, std::vector<PolyLine<T> > *result, FillRule fillRule )
+{
+	mImpl->snapToGrid( 0 );
+	if( ( op == INTERSECTION || op == DIFFERENCE ) && ! mImpl->inputBoundsOverlap() ) {
+		// the clip polygon can't affect the result; drop it, or everything for an intersection
+		if( op == INTERSECTION ) {
+			mImpl->mGrid[0].clear();
+			mImpl->mGridEnds[0].clear();
+		}
+		mImpl->mGrid[1].clear();
+		mImpl->mGridEnds[1].clear();
+	}
+	mImpl->sweep( op, fillRule, fillRule );
+	mImpl->outputContours( result );
+}
+
+template<typename T>
+void PolygonClipper::calcOffset( double delta, std::vector<PolyLine<T> > *result, JoinType joinType, double miterLimit, double arcTolerance, FillRule fillRule )
+{
+	// leave room on the grid for the offset and any miters
+	mImpl->snapToGrid( math<double>::abs( delta ) * std::max( miterLimit, 1.0 ) * 1.5 );
+	mImpl->sweep( UNION, fillRule, FILL_EVEN_ODD );
+	mImpl->offset( delta, joinType, miterLimit, arcTolerance );
+	mImpl->sweep( UNION, FILL_POSITIVE, FILL_POSITIVE );
+	mImpl->outputContours( result );
+}
+
+#define POLYGON_CLIPPER_INSTANTIATE( T ) \
+	template void PolygonClipper::addSubject<T>( const PolyLine<T>& ); \
+	template void PolygonClipper::addSubject<T>( const std::vector<PolyLine<T> >& ); \
+	template void PolygonClipper::addClip<T>( const PolyLine<T>& ); \
+	template void PolygonClipper::addClip<T>( const std::vector<PolyLine<T> >& ); \
+	template void PolygonClipper::calcBoolean<T>( Operation, std::vector<PolyLine<T> >*, FillRule ); \
+	template void PolygonClipper::calcOffset<T>( double, std::vector<PolyLine<T> >*, JoinType, double, double, FillRule );
+
+POLYGON_CLIPPER_INSTANTIATE( Vec2f )
+POLYGON_CLIPPER_INSTANTIATE( Vec2d )
+
+} // namespace cinder
@@ -0,0 +1,353 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/RowSwizzle.h"
+#include "cinder/ChanTraits.h"
+
+#include <cstring>
+#include <type_traits>
+#if defined( CINDER_SSE2 )
+	#include <emmintrin.h>
+#elif defined( CINDER_NEON )
+	#include <arm_neon.h>
+#endif
+
+namespace cinder {
+
+struct RowSwizzleKernels {
+	static void noop( const RowSwizzle &/*s*/, const void */*src*/, void */*dst*/, int32_t /*numPixels*/ )
+	{
+	}
+
+	static void copy( const RowSwizzle &s, const void *src, void *dst, int32_t numPixels )
+	{
+		memcpy( dst, src, numPixels * s.mCopyBytes );
+	}
+
+	template<typename SD, typename TD>
+	static void scalar( const RowSwizzle &s, const void *srcData, void *dstData, int32_t numPixels )
+	{
+		const SD *src = reinterpret_cast<const SD*>( srcData );
+		TD *dst = reinterpret_cast<TD*>( dstData );
+		const int8_t numPairs = s.mNumPairs, srcInc = s.mSrcInc, dstInc = s.mDstInc, fillOffset = s.mFillOffset;
+		const TD fillValue = CHANTRAIT<TD>::max();
+		for( int32_t p = 0; p < numPixels; ++p, src += srcInc, dst += dstInc ) {
+			for( int8_t c = 0; c < numPairs; ++c )
+				dst[s.mDstOffsets[c]] = CHANTRAIT<TD>::convert( src[s.mSrcOffsets[c]] );
+			if( fillOffset >= 0 )
+				dst[fillOffset] = fillValue;
+		}
+	}
+
+	// identical layouts of different types convert element by element
+	template<typename SD, typename TD>
+	static void convert( const RowSwizzle &s, const void *srcData, void *dstData, int32_t numPixels )
+	{
+		const SD *src = reinterpret_cast<const SD*>( srcData );
+		TD *dst = reinterpret_cast<TD*>( dstData );
+		const int32_t numElements = numPixels * s.mSrcInc;
+		for( int32_t i = 0; i < numElements; ++i )
+			dst[i] = CHANTRAIT<TD>::convert( src[i] );
+	}
+
+	template<typename SD, typename TD>
+	static RowSwizzle::Fn getConvertFn( SD*, TD* )
+	{
+		return &convert<SD,TD>;
+	}
+
+	template<typename SD, typename TD>
+	static RowSwizzle::Fn getSwizzleFn( SD*, TD*, int8_t /*srcInc*/, int8_t /*dstInc*/ )
+	{
+		return &scalar<SD,TD>;
+	}
+
+	// bytes of a target pixel which no channel writes, and so must be preserved
+	static uint32_t calcKeepMask( const RowSwizzle &s, int dstInc )
+	{
+		uint32_t keepMask = ( dstInc == 4 ) ? 0xFFFFFFFF : 0x00FFFFFF;
+		for( int8_t c = 0; c < s.mNumPairs; ++c )
+			keepMask &= ~( 0xFFu << ( s.mDstOffsets[c] * 8 ) );
+		if( s.mFillOffset >= 0 )
+			keepMask &= ~( 0xFFu << ( s.mFillOffset * 8 ) );
+		return keepMask;
+	}
+
+#if defined( CINDER_SSE2 )
+	// expands four pixels of INC bytes into one 32-bit lane each
+	template<int INC>
+	static __m128i loadLanes( const uint8_t *data )
+	{
+		__m128i in = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data ) );
+		if( INC == 4 )
+			return in;
+		__m128i lanes01 = _mm_unpacklo_epi32( in, _mm_srli_si128( in, 3 ) );
+		__m128i lanes23 = _mm_unpacklo_epi32( _mm_srli_si128( in, 6 ), _mm_srli_si128( in, 9 ) );
+		return _mm_unpacklo_epi64( lanes01, lanes23 );
+	}
+
+	// packs four 32-bit lanes back into pixels of INC bytes, writing exactly 4 * INC bytes
+	template<int INC>
+	static void storeLanes( uint8_t *data, __m128i lanes )
+	{
+		if( INC == 4 ) {
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( data ), lanes );
+			return;
+		}
+		lanes = _mm_and_si128( lanes, _mm_set1_epi32( 0x00FFFFFF ) );
+		__m128i out = _mm_and_si128( lanes, _mm_set_epi32( 0, 0, 0, -1 ) );
+		out = _mm_or_si128( out, _mm_srli_si128( _mm_and_si128( lanes, _mm_set_epi32( 0, 0, -1, 0 ) ), 1 ) );
+		out = _mm_or_si128( out, _mm_srli_si128( _mm_and_si128( lanes, _mm_set_epi32( 0, -1, 0, 0 ) ), 2 ) );
+		out = _mm_or_si128( out, _mm_srli_si128( _mm_and_si128( lanes, _mm_set_epi32( -1, 0, 0, 0 ) ), 3 ) );
+		_mm_storel_epi64( reinterpret_cast<__m128i*>( data ), out );
+		int32_t tail = _mm_cvtsi128_si32( _mm_srli_si128( out, 8 ) );
+		memcpy( data + 8, &tail, 4 );
+	}
+
+	// reorders, expands or contracts 8-bit pixels of 3 or 4 channels, four at a time
+	template<int SI, int DI>
+	static void swizzle8( const RowSwizzle &s, const void *srcData, void *dstData, int32_t numPixels )
+	{
+		const uint8_t *src = reinterpret_cast<const uint8_t*>( srcData );
+		uint8_t *dst = reinterpret_cast<uint8_t*>( dstData );
+		// 3-byte pixels are loaded 16 bytes at a time, so stay two pixels clear of the end
+		const int32_t guard = ( SI == 3 || DI == 3 ) ? 6 : 4;
+
+		__m128i srcShifts[4], dstShifts[4];
+		for( int8_t c = 0; c < s.mNumPairs; ++c ) {
+			srcShifts[c] = _mm_cvtsi32_si128( s.mSrcOffsets[c] * 8 );
+			dstShifts[c] = _mm_cvtsi32_si128( s.mDstOffsets[c] * 8 );
+		}
+		const uint32_t keepMask = calcKeepMask( s, DI );
+		const __m128i keep = _mm_set1_epi32( (int32_t)keepMask );
+		const __m128i fill = _mm_set1_epi32( ( s.mFillOffset >= 0 ) ? (int32_t)( 0xFFu << ( s.mFillOffset * 8 ) ) : 0 );
+		const __m128i byteMask = _mm_set1_epi32( 0xFF );
+
+		int32_t p = 0;
+		for( ; p + guard <= numPixels; p += 4 ) {
+			__m128i in = loadLanes<SI>( src + p * SI );
+			__m128i out = fill;
+			if( keepMask )
+				out = _mm_or_si128( out, _mm_and_si128( loadLanes<DI>( dst + p * DI ), keep ) );
+			for( int8_t c = 0; c < s.mNumPairs; ++c )
+				out = _mm_or_si128( out, _mm_sll_epi32( _mm_and_si128( _mm_srl_epi32( in, srcShifts[c] ), byteMask ), dstShifts[c] ) );
+			storeLanes<DI>( dst + p * DI, out );
+		}
+
+		scalar<uint8_t,uint8_t>( s, src + p * SI, dst + p * DI, numPixels - p );
+	}
+
+	static void convertU8ToFloat( const RowSwizzle &s, const void *srcData, void *dstData, int32_t numPixels )
+	{
+		const uint8_t *src = reinterpret_cast<const uint8_t*>( srcData );
+		float *dst = reinterpret_cast<float*>( dstData );
+		const int32_t numElements = numPixels * s.mSrcInc;
+		const __m128i zero = _mm_setzero_si128();
+		// divide rather than multiply by the reciprocal to match CHANTRAIT<float>::convert() exactly
+		const __m128 scale = _mm_set1_ps( 255.0f );
+
+		int32_t i = 0;
+		for( ; i + 16 <= numElements; i += 16 ) {
+			__m128i in = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+			__m128i lo = _mm_unpacklo_epi8( in, zero ), hi = _mm_unpackhi_epi8( in, zero );
+			_mm_storeu_ps( dst + i, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( lo, zero ) ), scale ) );
+			_mm_storeu_ps( dst + i + 4, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( lo, zero ) ), scale ) );
+			_mm_storeu_ps( dst + i + 8, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( hi, zero ) ), scale ) );
+			_mm_storeu_ps( dst + i + 12, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( hi, zero ) ), scale ) );
+		}
+		for( ; i < numElements; ++i )
+			dst[i] = CHANTRAIT<float>::convert( src[i] );
+	}
+
+	static void convertFloatToU8( const RowSwizzle &s, const void *srcData, void *dstData, int32_t numPixels )
+	{
+		const float *src = reinterpret_cast<const float*>( srcData );
+		uint8_t *dst = reinterpret_cast<uint8_t*>( dstData );
+		const int32_t numElements = numPixels * s.mSrcInc;
+		// truncates like CHANTRAIT<uint8_t>::convert(); out of range values saturate
+		const __m128 scale = _mm_set1_ps( 255.0f );
+
+		int32_t i = 0;
+		for( ; i + 16 <= numElements; i += 16 ) {
+			__m128i a = _mm_cvttps_epi32( _mm_mul_ps( _mm_loadu_ps( src + i ), scale ) );
+			__m128i b = _mm_cvttps_epi32( _mm_mul_ps( _mm_loadu_ps( src + i + 4 ), scale ) );
+			__m128i c = _mm_cvttps_epi32( _mm_mul_ps( _mm_loadu_ps( src + i + 8 ), scale ) );
+			__m128i d = _mm_cvttps_epi32( _mm_mul_ps( _mm_loadu_ps( src + i + 12 ), scale ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_packus_epi16( _mm_packs_epi32( a, b ), _mm_packs_epi32( c, d ) ) );
+		}
+		for( ; i < numElements; ++i )
+			dst[i] = CHANTRAIT<uint8_t>::convert( src[i] );
+	}
+
+	static RowSwizzle::Fn getConvertFn( uint8_t*, float* )
+	{
+		return &convertU8ToFloat;
+	}
+
+	static RowSwizzle::Fn getConvertFn( float*, uint8_t* )
+	{
+		return &convertFloatToU8;
+	}
+
+	static RowSwizzle::Fn getSwizzleFn( uint8_t*, uint8_t*, int8_t srcInc, int8_t dstInc )
+	{
+		if( srcInc == 4 && dstInc == 4 )
+			return &swizzle8<4,4>;
+		else if( srcInc == 3 && dstInc == 4 )
+			return &swizzle8<3,4>;
+		else if( srcInc == 4 && dstInc == 3 )
+			return &swizzle8<4,3>;
+		else if( srcInc == 3 && dstInc == 3 )
+			return &swizzle8<3,3>;
+		else
+			return &scalar<uint8_t,uint8_t>;
+	}
+
+#elif defined( CINDER_NEON )
+	static void loadPlanes( const uint8_t *data, uint8x16_t planes[4], std::integral_constant<int,3> )
+	{
+		uint8x16x3_t in = vld3q_u8( data );
+		planes[0] = in.val[0]; planes[1] = in.val[1]; planes[2] = in.val[2]; planes[3] = vdupq_n_u8( 0 );
+	}
+
+	static void loadPlanes( const uint8_t *data, uint8x16_t planes[4], std::integral_constant<int,4> )
+	{
+		uint8x16x4_t in = vld4q_u8( data );
+		planes[0] = in.val[0]; planes[1] = in.val[1]; planes[2] = in.val[2]; planes[3] = in.val[3];
+	}
+
+	static void storePlanes( uint8_t *data, const uint8x16_t planes[4], std::integral_constant<int,3> )
+	{
+		uint8x16x3_t out;
+		out.val[0] = planes[0]; out.val[1] = planes[1]; out.val[2] = planes[2];
+		vst3q_u8( data, out );
+	}
+
+	static void storePlanes( uint8_t *data, const uint8x16_t planes[4], std::integral_constant<int,4> )
+	{
+		uint8x16x4_t out;
+		out.val[0] = planes[0]; out.val[1] = planes[1]; out.val[2] = planes[2]; out.val[3] = planes[3];
+		vst4q_u8( data, out );
+	}
+
+	// reorders, expands or contracts 8-bit pixels of 3 or 4 channels, sixteen at a time
+	template<int SI, int DI>
+	static void swizzle8( const RowSwizzle &s, const void *srcData, void *dstData, int32_t numPixels )
+	{
+		const uint8_t *src = reinterpret_cast<const uint8_t*>( srcData );
+		uint8_t *dst = reinterpret_cast<uint8_t*>( dstData );
+		const bool keep = calcKeepMask( s, DI ) != 0;
+
+		int32_t p = 0;
+		for( ; p + 16 <= numPixels; p += 16 ) {
+			uint8x16_t in[4], out[4];
+			loadPlanes( src + p * SI, in, std::integral_constant<int,SI>() );
+			if( keep )
+				loadPlanes( dst + p * DI, out, std::integral_constant<int,DI>() );
+			else
+				out[0] = out[1] = out[2] = out[3] = vdupq_n_u8( 0 );
+			for( int8_t c = 0; c < s.mNumPairs; ++c )
+				out[s.mDstOffsets[c]] = in[s.mSrcOffsets[c]];
+			if( s.mFillOffset >= 0 )
+				out[s.mFillOffset] = vdupq_n_u8( 255 );
+			storePlanes( dst + p * DI, out, std::integral_constant<int,DI>() );
+		}
+
+		scalar<uint8_t,uint8_t>( s, src + p * SI, dst + p * DI, numPixels - p );
+	}
+
+	static RowSwizzle::Fn getSwizzleFn( uint8_t*, uint8_t*, int8_t srcInc, int8_t dstInc )
+	{
+		if( srcInc == 4 && dstInc == 4 )
+			return &swizzle8<4,4>;
+		else if( srcInc == 3 && dstInc == 4 )
+			return &swizzle8<3,4>;
+		else if( srcInc == 4 && dstInc == 3 )
+			return &swizzle8<4,3>;
+		else if( srcInc == 3 && dstInc == 3 )
+			return &swizzle8<3,3>;
+		else
+			return &scalar<uint8_t,uint8_t>;
+	}
+#endif
+};
+
+RowSwizzle::RowSwizzle()
+	: mFn( &RowSwizzleKernels::noop ), mNumPairs( 0 ), mSrcInc( 0 ), mDstInc( 0 ), mFillOffset( -1 ), mCopyBytes( 0 )
+{
+}
+
+template<typename SD, typename TD>
+RowSwizzle RowSwizzle::create( const int8_t srcOffsets[4], int8_t srcInc, const int8_t dstOffsets[4], int8_t dstInc, bool fillAlpha )
+{
+	RowSwizzle result;
+	result.mSrcInc = srcInc;
+	result.mDstInc = dstInc;
+
+	bool identity = true;
+	for( int c = 0; c < 4; ++c ) {
+		if( dstOffsets[c] < 0 )
+			continue;
+		if( srcOffsets[c] >= 0 ) {
+			result.mSrcOffsets[result.mNumPairs] = srcOffsets[c];
+			result.mDstOffsets[result.mNumPairs] = dstOffsets[c];
+			++result.mNumPairs;
+			identity = identity && ( srcOffsets[c] == dstOffsets[c] );
+		}
+		else if( c == 3 && fillAlpha )
+			result.mFillOffset = dstOffsets[c];
+	}
+
+	// every element of the pixel maps to the same place
+	const bool sameLayout = identity && ( srcInc == dstInc ) && ( result.mNumPairs == srcInc ) && ( result.mFillOffset < 0 );
+	if( sameLayout && std::is_same<SD,TD>::value ) {
+		result.mFn = &RowSwizzleKernels::copy;
+		result.mCopyBytes = srcInc * sizeof(SD);
+	}
+	else if( sameLayout )
+		result.mFn = RowSwizzleKernels::getConvertFn( (SD*)0, (TD*)0 );
+	else
+		result.mFn = RowSwizzleKernels::getSwizzleFn( (SD*)0, (TD*)0, srcInc, dstInc );
+
+	return result;
+}
+
+bool RowSwizzle::isCopy() const
+{
+	return mFn == &RowSwizzleKernels::copy;
+}
+
+#define ROW_SWIZZLE_PROTOTYPES( SD, TD ) \
+	template RowSwizzle RowSwizzle::create<SD,TD>( const int8_t srcOffsets[4], int8_t srcInc, const int8_t dstOffsets[4], int8_t dstInc, bool fillAlpha );
+
+ROW_SWIZZLE_PROTOTYPES( uint8_t, uint8_t )
+ROW_SWIZZLE_PROTOTYPES( uint8_t, uint16_t )
+ROW_SWIZZLE_PROTOTYPES( uint8_t, float )
+ROW_SWIZZLE_PROTOTYPES( uint16_t, uint8_t )
+ROW_SWIZZLE_PROTOTYPES( uint16_t, uint16_t )
+ROW_SWIZZLE_PROTOTYPES( uint16_t, float )
+ROW_SWIZZLE_PROTOTYPES( float, uint8_t )
+ROW_SWIZZLE_PROTOTYPES( float, uint16_t )
+ROW_SWIZZLE_PROTOTYPES( float, float )
+
+} // namespace cinder
@@ -21,6 +21,7 @@
 */
 
 #include "cinder/Shape2d.h"
+#include "cinder/Thread.h"
 
 using std::vector;
 
@@ -143,4 +144,16 @@ bool Shape2d::contains( const Vec2f &pt ) const
 	return ( numPathsInside % 2 ) == 1;
 }
 
+void Shape2d::subdivide( vector<vector<Vec2f> > *result, float approximationScale ) const
+{
+	result->resize( mContours.size() );
+
+	// contours are independent, so hand out ranges of them to worker threads
+	const size_t minContoursPerThread = 32;
+	parallelFor( 0, mContours.size(), minContoursPerThread, [&]( size_t begin, size_t end ) {
+		for( size_t c = begin; c < end; ++c )
+			mContours[c].subdivide( &(*result)[c], approximationScale );
+	} );
+}
+
 } // namespace cinder
@@ -37,6 +37,8 @@ using namespace Concurrency;
 
 #include "cinder/ImageIo.h"
 #include "cinder/ip/Fill.h"
+#include "cinder/ip/Statistics.h"
+#include "cinder/RowSwizzle.h"
 
 #include <boost/preprocessor/seq.hpp>
 #include <boost/type_traits/is_same.hpp>
@@ -192,8 +194,20 @@ int	SurfaceChannelOrder::getImageIoChannelOrder() const
 // SurfaceT::Obj
 template<typename T>
 SurfaceT<T>::Obj::Obj( int32_t aWidth, int32_t aHeight, SurfaceChannelOrder aChannelOrder, T *aData, bool aOwnsData, int32_t aRowBytes )
-	: mWidth( aWidth ), mHeight( aHeight ), mChannelOrder( aChannelOrder ), mData( aData ), mOwnsData( aOwnsData ), mRowBytes( aRowBytes ), mIsPremultiplied( false )
+	: mWidth( aWidth ), mHeight( aHeight ), mRowBytes( aRowBytes ), mIsPremultiplied( false ), mData( aData ), mOwnsData( aOwnsData ), mChannelOrder( aChannelOrder )
 {
+	mDeallocatorFunc = NULL;
+	mAllocatedBytes = 0;
+	initChannels();
+}
+
+template<typename T>
+SurfaceT<T>::Obj::Obj( int32_t aWidth, int32_t aHeight, SurfaceChannelOrder aChannelOrder, int32_t aRowBytes, const PixelAllocatorRef &aAllocator )
+	: mWidth( aWidth ), mHeight( aHeight ), mRowBytes( aRowBytes ), mIsPremultiplied( false ), mOwnsData( true ), mAllocator( aAllocator ),
+	mAllocatedBytes( (size_t)aHeight * aRowBytes ), mChannelOrder( aChannelOrder )
+{
+	// rowBytes is in bytes rather than elements of T, so mAllocatedBytes is too
+	mData = reinterpret_cast<T*>( mAllocator->allocate( mAllocatedBytes ) );
 	mDeallocatorFunc = NULL;
 	initChannels();
 }
@@ -204,8 +218,12 @@ SurfaceT<T>::Obj::~Obj()
 	if( mDeallocatorFunc )
 		(*mDeallocatorFunc)( mDeallocatorRefcon );
 
-	if( mOwnsData )
-		delete [] mData;
+	if( mOwnsData ) {
+		if( mAllocator )
+			mAllocator->deallocate( mData, mAllocatedBytes );
+		else
+			delete [] mData;
+	}
 }
 
 template<typename T>
@@ -242,8 +260,7 @@ SurfaceT<T>::SurfaceT( int32_t aWidth, int32_t aHeight, bool alpha, SurfaceChann
 	if( channelOrder == SurfaceChannelOrder::UNSPECIFIED )
 		channelOrder = ( alpha ) ? SurfaceChannelOrder::RGBA : SurfaceChannelOrder::RGB;
 	int32_t rowBytes = aWidth * sizeof(T) * channelOrder.getPixelInc();
-	T *data = new T[aHeight * rowBytes];
-	mObj = std::shared_ptr<Obj>( new Obj( aWidth, aHeight, channelOrder, data, true, rowBytes ) );
+	mObj = std::shared_ptr<Obj>( new Obj( aWidth, aHeight, channelOrder, rowBytes, PixelAllocator::getDefault() ) );
 }
 
 template<typename T>
@@ -251,8 +268,7 @@ SurfaceT<T>::SurfaceT( int32_t aWidth, int32_t aHeight, bool alpha, const Surfac
 {
 	SurfaceChannelOrder channelOrder = constraints.getChannelOrder( alpha );
 	int32_t rowBytes = constraints.getRowBytes( aWidth, channelOrder, sizeof(T) );
-	T *data = new T[aHeight * rowBytes];
-	mObj = std::shared_ptr<Obj>( new Obj( aWidth, aHeight, channelOrder, data, true, rowBytes ) );
+	mObj = std::shared_ptr<Obj>( new Obj( aWidth, aHeight, channelOrder, rowBytes, constraints.getAllocator() ) );
 }
 
 template<typename T>
@@ -355,10 +371,8 @@ void SurfaceT<T>::init( ImageSourceRef imageSource, const SurfaceConstraints &co
 
 	SurfaceChannelOrder channelOrder = constraints.getChannelOrder( hasAlpha );
 	int32_t rowBytes = constraints.getRowBytes( width, channelOrder, sizeof(T) );
-	
-	T *data = new T[height * rowBytes];
 
-	mObj = std::shared_ptr<Obj>( new Obj( width, height, channelOrder, data, true, rowBytes ) );
+	mObj = std::shared_ptr<Obj>( new Obj( width, height, channelOrder, rowBytes, constraints.getAllocator() ) );
 	mObj->mIsPremultiplied = imageSource->isPremultiplied();
 	
 	std::shared_ptr<ImageTargetSurface<T> > target = ImageTargetSurface<T>::createRef( this );
@@ -405,121 +419,60 @@ void SurfaceT<T>::copyRawSameChannelOrder( const SurfaceT<T> &srcSurface, const
 	}
 }
 
+namespace {
+// Builds the RowSwizzle between two channel orders; when \a alpha is false the target's alpha is left alone (or filled, per \a fillAlpha)
 template<typename T>
-void SurfaceT<T>::copyRawRgba( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &absoluteOffset )
+RowSwizzle makeChannelOrderSwizzle( const SurfaceChannelOrder &src, const SurfaceChannelOrder &dst, bool alpha, bool fillAlpha )
+{
+	const int8_t srcOffsets[4] = { (int8_t)src.getRedOffset(), (int8_t)src.getGreenOffset(), (int8_t)src.getBlueOffset(), alpha ? (int8_t)src.getAlphaOffset() : (int8_t)-1 };
+	const int8_t dstOffsets[4] = { (int8_t)dst.getRedOffset(), (int8_t)dst.getGreenOffset(), (int8_t)dst.getBlueOffset(), ( alpha || fillAlpha ) ? (int8_t)dst.getAlphaOffset() : (int8_t)-1 };
+	return RowSwizzle::create<T,T>( srcOffsets, (int8_t)src.getPixelInc(), dstOffsets, (int8_t)dst.getPixelInc(), fillAlpha );
+}
+} // anonymous namespace
+
+template<typename T>
+void SurfaceT<T>::copyRawSwizzled( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &absoluteOffset, const RowSwizzle &swizzle )
 {
 	const int32_t srcRowBytes = srcSurface.getRowBytes();
-	uint8_t srcRed = srcSurface.getChannelOrder().getRedOffset();
-	uint8_t srcGreen = srcSurface.getChannelOrder().getGreenOffset();
-	uint8_t srcBlue = srcSurface.getChannelOrder().getBlueOffset();
-	uint8_t srcAlpha = srcSurface.getChannelOrder().getAlphaOffset();
-	
-	uint8_t dstRed = getChannelOrder().getRedOffset();
-	uint8_t dstGreen = getChannelOrder().getGreenOffset();
-	uint8_t dstBlue = getChannelOrder().getBlueOffset();
-	uint8_t dstAlpha = getChannelOrder().getAlphaOffset();
-	
-	int32_t width = srcArea.getWidth();
+	const int32_t srcPixelInc = srcSurface.getPixelInc();
+	const int32_t dstPixelInc = getPixelInc();
+	const int32_t width = srcArea.getWidth();
 	
 	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
-		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * 4 ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
-			dst[dstRed] = src[srcRed];
-			dst[dstGreen] = src[srcGreen];
-			dst[dstBlue] = src[srcBlue];
-			dst[dstAlpha] = src[srcAlpha];
-			src += 4;
-			dst += 4;
-		}
+		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * srcPixelInc ) + ( srcArea.y1 + y ) * srcRowBytes );
+		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * dstPixelInc ) + ( y + absoluteOffset.y ) * getRowBytes() );
+		swizzle( src, dst, width );
 	}
 }
 
+template<typename T>
+void SurfaceT<T>::copyRawRgba( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &absoluteOffset )
+{
+	copyRawSwizzled( srcSurface, srcArea, absoluteOffset, makeChannelOrderSwizzle<T>( srcSurface.getChannelOrder(), getChannelOrder(), true, false ) );
+}
+
 template<typename T>
 void SurfaceT<T>::copyRawRgbFullAlpha( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &absoluteOffset )
 {
-	const int32_t srcRowBytes = srcSurface.getRowBytes();
-	const int8_t srcPixelInc = srcSurface.getPixelInc();
-	uint8_t srcRed = srcSurface.getChannelOrder().getRedOffset();
-	uint8_t srcGreen = srcSurface.getChannelOrder().getGreenOffset();
-	uint8_t srcBlue = srcSurface.getChannelOrder().getBlueOffset();
-	const T fullAlpha = CHANTRAIT<T>::max();
-	
-	uint8_t dstRed = getChannelOrder().getRedOffset();
-	uint8_t dstGreen = getChannelOrder().getGreenOffset();
-	uint8_t dstBlue = getChannelOrder().getBlueOffset();
-	uint8_t dstAlpha = getChannelOrder().getAlphaOffset();
-	
-	int32_t width = srcArea.getWidth();
-	
-	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
-		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * 4 ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
-			dst[dstRed] = src[srcRed];
-			dst[dstGreen] = src[srcGreen];
-			dst[dstBlue] = src[srcBlue];
-			dst[dstAlpha] = fullAlpha;
-			src += srcPixelInc;
-			dst += 4;
-		}
-	}
+	copyRawSwizzled( srcSurface, srcArea, absoluteOffset, makeChannelOrderSwizzle<T>( srcSurface.getChannelOrder(), getChannelOrder(), false, true ) );
 }
 
 template<typename T>
 void SurfaceT<T>::copyRawRgb( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &absoluteOffset )
 {
-	const int32_t srcRowBytes = srcSurface.getRowBytes();
-	const int8_t srcPixelInc = srcSurface.getPixelInc();
-	const uint8_t srcRed = srcSurface.getChannelOrder().getRedOffset();
-	const uint8_t srcGreen = srcSurface.getChannelOrder().getGreenOffset();
-	const uint8_t srcBlue = srcSurface.getChannelOrder().getBlueOffset();
-	
-	const uint8_t dstPixelInc = getPixelInc();
-	const uint8_t dstRed = getChannelOrder().getRedOffset();
-	const uint8_t dstGreen = getChannelOrder().getGreenOffset();
-	const uint8_t dstBlue = getChannelOrder().getBlueOffset();
-	
-	int32_t width = srcArea.getWidth();
-	
-	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * srcPixelInc ) + ( srcArea.y1 + y ) * srcRowBytes );
-		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * dstPixelInc ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
-			dst[dstRed] = src[srcRed];
-			dst[dstGreen] = src[srcGreen];
-			dst[dstBlue] = src[srcBlue];
-			src += srcPixelInc;
-			dst += dstPixelInc;
-		}
-	}
+	copyRawSwizzled( srcSurface, srcArea, absoluteOffset, makeChannelOrderSwizzle<T>( srcSurface.getChannelOrder(), getChannelOrder(), false, false ) );
 }
 
 template<typename T>
 ColorT<T> SurfaceT<T>::areaAverage( const Area &area ) const
 {
-	typename CHANTRAIT<T>::Sum redSum = 0, greenSum = 0, blueSum = 0;
 	const Area clipped( area.getClipBy( getBounds() ) );
 	
 	if( ( clipped.getWidth() <= 0 ) || ( clipped.getHeight() <= 0 ) )
 		return ColorT<T>( 0, 0, 0 );
 
-	uint8_t red = getRedOffset(), green = getGreenOffset(), blue = getBlueOffset();
-	uint8_t inc = getPixelInc();
-	const T *line = getData( clipped.getUL() );
-	for( int32_t y = clipped.y1; y < clipped.y2; ++y ) {
-		const T *d = line;
-		for( int32_t x = clipped.x1; x < clipped.x2; ++x ) {
-			redSum += d[red];
-			greenSum += d[green];
-			blueSum += d[blue];						
-			d += inc;
-		}
-		
-		line = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( line ) + getRowBytes() );
-	} 
-	
-	return ColorT<T>( (T)(redSum / ( clipped.getWidth() * clipped.getHeight() )), (T)(greenSum / ( clipped.getWidth() * clipped.getHeight() )), (T)(blueSum / ( clipped.getWidth() * clipped.getHeight() )) );
+	const Vec4d mean = ip::calcSum( *this, clipped ) / ( (double)clipped.getWidth() * clipped.getHeight() );
+	return ColorT<T>( (T)mean.x, (T)mean.y, (T)mean.z );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
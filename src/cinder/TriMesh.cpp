@@ -1,5 +1,10 @@
 #include "cinder/TriMesh.h"
 #include "cinder/app/AppBasic.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
 
 using std::vector;
 
@@ -377,23 +382,33 @@ AxisAlignedBox3f TriMesh::calcBoundingBox( const Matrix44f &transform ) const
 	if( mPositions.empty() )
 		return AxisAlignedBox3f( Vec3f::zero(), Vec3f::zero() );
 
-	Vec3f min( transform.transformPointAffine( *(const Vec3f*)(&mPositions[0]) ) );
-	Vec3f max( min );
-	for( size_t i = 0; i < mPositions.size() / 3; ++i ) {
-		Vec3f v = transform.transformPointAffine( *(const Vec3f*)(&mPositions[i*3]) );
+	// transform positions in blocks so the batch (SIMD) transform can be used without allocating
+	const size_t BLOCK_SIZE = 256;
+	Vec3f transformed[BLOCK_SIZE];
+	const Vec3f *positions = (const Vec3f*)mPositions.data();
+	const size_t numPositions = mPositions.size() / 3;
 
-		if( v.x < min.x )
-			min.x = v.x;
-		else if( v.x > max.x )
-			max.x = v.x;
-		if( v.y < min.y )
-			min.y = v.y;
-		else if( v.y > max.y )
-			max.y = v.y;
-		if( v.z < min.z )
-			min.z = v.z;
-		else if( v.z > max.z )
-			max.z = v.z;
+	Vec3f min( transform.transformPointAffine( positions[0] ) );
+	Vec3f max( min );
+	for( size_t block = 0; block < numPositions; block += BLOCK_SIZE ) {
+		size_t blockCount = std::min( BLOCK_SIZE, numPositions - block );
+		transform.transformPointsAffine( positions + block, transformed, blockCount );
+		for( size_t i = 0; i < blockCount; ++i ) {
+			const Vec3f &v = transformed[i];
+
+			if( v.x < min.x )
+				min.x = v.x;
+			else if( v.x > max.x )
+				max.x = v.x;
+			if( v.y < min.y )
+				min.y = v.y;
+			else if( v.y > max.y )
+				max.y = v.y;
+			if( v.z < min.z )
+				min.z = v.z;
+			else if( v.z > max.z )
+				max.z = v.z;
+		}
 	}
 
 	return AxisAlignedBox3f( min, max );
@@ -878,6 +893,881 @@ void TriMesh::subdivide( int division, bool normalize )
 	}
 }
 
+namespace {
+
+// Scoring constants from Tom Forsyth, "Linear-Speed Vertex Cache Optimisation", 2006
+const float		kCacheDecayPower = 1.5f;
+const float		kLastTriangleScore = 0.75f;
+const float		kValenceBoostScale = 2.0f;
+const float		kValenceBoostPower = 0.5f;
+const uint32_t	kMaxValence = 64;
+const uint32_t	kInvalidIndex = 0xFFFFFFFF;
+
+// MurmurHash3's block mix; floats holding small integers differ only in their high bits, which a plain FNV step would discard
+inline uint32_t hashCombine( uint32_t hash, uint32_t bits )
+{
+	bits *= 0xcc9e2d51;
+	bits = ( bits << 15 ) | ( bits >> 17 );
+	bits *= 0x1b873593;
+	hash ^= bits;
+	hash = ( hash << 13 ) | ( hash >> 19 );
+	return hash * 5 + 0xe6546b64;
+}
+
+template<typename T>
+void remapArray( std::vector<T> &data, size_t dims, const std::vector<uint32_t> &remap, size_t numVertices )
+{
+	if( data.empty() || dims == 0 )
+		return;
+
+	std::vector<T> result( numVertices * dims );
+	const size_t count = std::min( remap.size(), data.size() / dims );
+	for( size_t i = 0; i < count; ++i ) {
+		if( remap[i] != kInvalidIndex )
+			std::copy( data.begin() + i * dims, data.begin() + ( i + 1 ) * dims, result.begin() + remap[i] * dims );
+	}
+	data.swap( result );
+}
+
+} // anonymous namespace
+
+TriMesh::VertexCacheStats TriMesh::calcVertexCacheStats( size_t cacheSize ) const
+{
+	VertexCacheStats result = { 0, 0, 0 };
+	if( mIndices.empty() || cacheSize == 0 )
+		return result;
+
+	// a vertex is resident if it was inserted fewer than cacheSize insertions ago
+	std::vector<size_t> insertTime( getNumVertices(), 0 );
+	size_t time = cacheSize + 1, numReferenced = 0;
+	for( vector<uint32_t>::const_iterator indexIt = mIndices.begin(); indexIt != mIndices.end(); ++indexIt ) {
+		if( *indexIt >= insertTime.size() )
+			insertTime.resize( *indexIt + 1, 0 );
+		size_t &inserted = insertTime[*indexIt];
+		if( inserted == 0 )
+			++numReferenced;
+		if( time - inserted > cacheSize ) {
+			inserted = time++;
+			++result.mNumCacheMisses;
+		}
+	}
+
+	result.mAcmr = result.mNumCacheMisses / (float)getNumTriangles();
+	result.mAtvr = result.mNumCacheMisses / (float)numReferenced;
+	return result;
+}
+
+void TriMesh::optimizeVertexCache( size_t cacheSize )
+{
+	const size_t numTriangles = getNumTriangles();
+	if( numTriangles < 2 || cacheSize < 4 )
+		return;
+
+	size_t numVertices = getNumVertices();
+	for( vector<uint32_t>::const_iterator indexIt = mIndices.begin(); indexIt != mIndices.end(); ++indexIt )
+		numVertices = std::max<size_t>( numVertices, *indexIt + 1 );
+
+	// precompute the score contributions of cache position and remaining valence
+	std::vector<float> cacheScores( cacheSize ), valenceScores( kMaxValence + 1 );
+	for( size_t i = 0; i < cacheSize; ++i )
+		cacheScores[i] = ( i < 3 ) ? kLastTriangleScore : math<float>::pow( 1.0f - ( i - 3 ) / float( cacheSize - 3 ), kCacheDecayPower );
+	valenceScores[0] = 0;
+	for( uint32_t i = 1; i <= kMaxValence; ++i )
+		valenceScores[i] = kValenceBoostScale * math<float>::pow( (float)i, -kValenceBoostPower );
+
+	// triangle adjacency per vertex; the first liveTriangles[v] entries are the triangles not yet emitted
+	std::vector<uint32_t> adjacencyOffsets( numVertices + 1, 0 ), liveTriangles( numVertices, 0 ), adjacency( mIndices.size() );
+	for( vector<uint32_t>::const_iterator indexIt = mIndices.begin(); indexIt != mIndices.end(); ++indexIt )
+		++liveTriangles[*indexIt];
+	for( size_t v = 0; v < numVertices; ++v )
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+	std::fill( liveTriangles.begin(), liveTriangles.end(), 0 );
+	for( size_t i = 0; i < mIndices.size(); ++i ) {
+		const uint32_t v = mIndices[i];
+		adjacency[adjacencyOffsets[v] + liveTriangles[v]++] = uint32_t( i / 3 );
+	}
+
+	std::vector<int32_t> cachePositions( numVertices, -1 );
+	std::vector<float> vertexScores( numVertices ), triangleScores( numTriangles, 0 );
+	for( size_t v = 0; v < numVertices; ++v )
+		vertexScores[v] = valenceScores[std::min( liveTriangles[v], kMaxValence )];
+	for( size_t t = 0; t < numTriangles; ++t )
+		triangleScores[t] = vertexScores[mIndices[t*3+0]] + vertexScores[mIndices[t*3+1]] + vertexScores[mIndices[t*3+2]];
+
+	std::vector<uint8_t> emitted( numTriangles, 0 );
+	std::vector<uint32_t> cache, newCache, result;
+	cache.reserve( cacheSize + 3 );
+	newCache.reserve( cacheSize + 3 );
+	result.reserve( mIndices.size() );
+
+	uint32_t bestTriangle = uint32_t( std::max_element( triangleScores.begin(), triangleScores.end() ) - triangleScores.begin() );
+	size_t deadEndCursor = 0;
+	for( size_t numEmitted = 0; numEmitted < numTriangles; ++numEmitted ) {
+		// when no cached vertex has live triangles left, continue from the next unemitted triangle in input order
+		if( bestTriangle == kInvalidIndex ) {
+			while( emitted[deadEndCursor] )
+				++deadEndCursor;
+			bestTriangle = uint32_t( deadEndCursor );
+		}
+
+		const uint32_t *tri = &mIndices[bestTriangle * 3];
+		result.insert( result.end(), tri, tri + 3 );
+		emitted[bestTriangle] = 1;
+
+		// retire the triangle from its vertices' live lists and push them to the front of the cache
+		newCache.clear();
+		for( int k = 0; k < 3; ++k ) {
+			const uint32_t v = tri[k];
+			uint32_t *begin = &adjacency[adjacencyOffsets[v]];
+			uint32_t *end = begin + liveTriangles[v];
+			std::iter_swap( std::find( begin, end, bestTriangle ), end - 1 );
+			--liveTriangles[v];
+			newCache.push_back( v );
+		}
+		for( vector<uint32_t>::const_iterator cacheIt = cache.begin(); cacheIt != cache.end(); ++cacheIt ) {
+			if( *cacheIt != tri[0] && *cacheIt != tri[1] && *cacheIt != tri[2] )
+				newCache.push_back( *cacheIt );
+		}
+
+		// rescore every vertex whose cache position changed, including the ones just evicted
+		bestTriangle = kInvalidIndex;
+		float bestScore = -1;
+		for( size_t i = 0; i < newCache.size(); ++i ) {
+			const uint32_t v = newCache[i];
+			const int32_t position = ( i < cacheSize ) ? int32_t( i ) : -1;
+			cachePositions[v] = position;
+
+			float score = 0;
+			if( liveTriangles[v] ) {
+				score = valenceScores[std::min( liveTriangles[v], kMaxValence )];
+				if( position >= 0 )
+					score += cacheScores[position];
+			}
+			const float delta = score - vertexScores[v];
+			vertexScores[v] = score;
+
+			const uint32_t *adj = &adjacency[adjacencyOffsets[v]];
+			for( uint32_t a = 0; a < liveTriangles[v]; ++a ) {
+				float &triangleScore = triangleScores[adj[a]];
+				triangleScore += delta;
+				if( triangleScore > bestScore ) {
+					bestScore = triangleScore;
+					bestTriangle = adj[a];
+				}
+			}
+		}
+
+		if( newCache.size() > cacheSize )
+			newCache.resize( cacheSize );
+		cache.swap( newCache );
+	}
+
+	mIndices.swap( result );
+}
+
+void TriMesh::optimizeVertexFetch()
+{
+	if( mIndices.empty() )
+		return;
+
+	size_t numVertices = getNumVertices();
+	for( vector<uint32_t>::const_iterator indexIt = mIndices.begin(); indexIt != mIndices.end(); ++indexIt )
+		numVertices = std::max<size_t>( numVertices, *indexIt + 1 );
+
+	std::vector<uint32_t> remap( numVertices, kInvalidIndex );
+	uint32_t nextVertex = 0;
+	for( vector<uint32_t>::iterator indexIt = mIndices.begin(); indexIt != mIndices.end(); ++indexIt ) {
+		uint32_t &newIndex = remap[*indexIt];
+		if( newIndex == kInvalidIndex )
+			newIndex = nextVertex++;
+		*indexIt = newIndex;
+	}
+
+	remapVertices( remap, nextVertex );
+}
+
+size_t TriMesh::weldVertices()
+{
+	const size_t numVertices = getNumVertices();
+	if( numVertices < 2 )
+		return 0;
+
+	// every attribute stored per vertex takes part in the comparison
+	struct AttribArray { const float *mData; size_t mDims; };
+	AttribArray attribs[9];
+	size_t numAttribs = 0;
+	const std::pair<const float*, size_t> candidates[9] = {
+		std::make_pair( mPositions.data(), mPositions.size() ), std::make_pair( mColors.data(), mColors.size() ),
+		std::make_pair( (const float*)mNormals.data(), mNormals.size() * 3 ), std::make_pair( (const float*)mTangents.data(), mTangents.size() * 3 ),
+		std::make_pair( (const float*)mBitangents.data(), mBitangents.size() * 3 ), std::make_pair( mTexCoords0.data(), mTexCoords0.size() ),
+		std::make_pair( mTexCoords1.data(), mTexCoords1.size() ), std::make_pair( mTexCoords2.data(), mTexCoords2.size() ),
+		std::make_pair( mTexCoords3.data(), mTexCoords3.size() ) };
+	const uint8_t dims[9] = { mPositionsDims, mColorsDims, 3, 3, 3, mTexCoords0Dims, mTexCoords1Dims, mTexCoords2Dims, mTexCoords3Dims };
+	for( int a = 0; a < 9; ++a ) {
+		if( dims[a] && candidates[a].second >= numVertices * dims[a] ) {
+			AttribArray attrib = { candidates[a].first, dims[a] };
+			attribs[numAttribs++] = attrib;
+		}
+	}
+
+	// open-addressed hash table of the first vertex seen with each unique set of attributes
+	size_t tableSize = 1;
+	while( tableSize < numVertices * 2 )
+		tableSize *= 2;
+	std::vector<uint32_t> table( tableSize, kInvalidIndex ), remap( numVertices );
+	uint32_t numUnique = 0;
+	for( uint32_t v = 0; v < numVertices; ++v ) {
+		uint32_t hash = 0;
+		for( size_t a = 0; a < numAttribs; ++a ) {
+			const uint32_t *bits = reinterpret_cast<const uint32_t*>( attribs[a].mData + v * attribs[a].mDims );
+			for( size_t d = 0; d < attribs[a].mDims; ++d )
+				hash = hashCombine( hash, bits[d] );
+		}
+
+		size_t slot = hash & ( tableSize - 1 );
+		for( ;; slot = ( slot + 1 ) & ( tableSize - 1 ) ) {
+			const uint32_t other = table[slot];
+			if( other == kInvalidIndex ) {
+				table[slot] = v;
+				remap[v] = numUnique++;
+				break;
+			}
+
+			bool equal = true;
+			for( size_t a = 0; a < numAttribs && equal; ++a )
+				equal = memcmp( attribs[a].mData + v * attribs[a].mDims, attribs[a].mData + other * attribs[a].mDims, attribs[a].mDims * sizeof(float) ) == 0;
+			if( equal ) {
+				remap[v] = remap[other];
+				break;
+			}
+		}
+	}
+
+	if( numUnique == numVertices )
+		return 0;
+
+	for( vector<uint32_t>::iterator indexIt = mIndices.begin(); indexIt != mIndices.end(); ++indexIt ) {
+		if( *indexIt < numVertices )
+			*indexIt = remap[*indexIt];
+	}
+	remapVertices( remap, numUnique );
+
+	return numVertices - numUnique;
+}
+
+void TriMesh::optimize( bool weld )
+{
+	if( weld )
+		weldVertices();
+	optimizeVertexCache();
+	optimizeVertexFetch();
+}
+
+void TriMesh::remapVertices( const std::vector<uint32_t> &remap, size_t numVertices )
+{
+	remapArray( mPositions, mPositionsDims, remap, numVertices );
+	remapArray( mColors, mColorsDims, remap, numVertices );
+	remapArray( mNormals, 1, remap, numVertices );
+	remapArray( mTangents, 1, remap, numVertices );
+	remapArray( mBitangents, 1, remap, numVertices );
+	remapArray( mTexCoords0, mTexCoords0Dims, remap, numVertices );
+	remapArray( mTexCoords1, mTexCoords1Dims, remap, numVertices );
+	remapArray( mTexCoords2, mTexCoords2Dims, remap, numVertices );
+	remapArray( mTexCoords3, mTexCoords3Dims, remap, numVertices );
+}
+
+namespace {
+
+const uint32_t	kMultipleEdges = 0xFFFFFFFE;
+// Open borders and seams get an additional quadric perpendicular to the face so that collapses along them are penalized for drifting off the outline
+const float		kBoundaryWeight = 10.0f;
+
+//! Symmetric 4x4 error quadric of Garland & Heckbert, normalized by its accumulated weight when evaluated
+struct Quadric {
+	Quadric() : a00( 0 ), a11( 0 ), a22( 0 ), a01( 0 ), a02( 0 ), a12( 0 ), b0( 0 ), b1( 0 ), b2( 0 ), c( 0 ), w( 0 ) {}
+	// plane through the origin at distance -d along the unit normal n
+	Quadric( const Vec3f &n, float d, float weight )
+		: a00( weight * n.x * n.x ), a11( weight * n.y * n.y ), a22( weight * n.z * n.z ),
+		a01( weight * n.x * n.y ), a02( weight * n.x * n.z ), a12( weight * n.y * n.z ),
+		b0( weight * n.x * d ), b1( weight * n.y * d ), b2( weight * n.z * d ), c( weight * d * d ), w( weight )
+	{}
+
+	void	add( const Quadric &q )
+	{
+		a00 += q.a00; a11 += q.a11; a22 += q.a22; a01 += q.a01; a02 += q.a02; a12 += q.a12;
+		b0 += q.b0; b1 += q.b1; b2 += q.b2; c += q.c; w += q.w;
+	}
+
+	//! Returns the weighted mean squared distance of \a p to the planes summed into this quadric
+	float	error( const Vec3f &p ) const
+	{
+		const float rx = a00 * p.x + a01 * p.y + a02 * p.z;
+		const float ry = a01 * p.x + a11 * p.y + a12 * p.z;
+		const float rz = a02 * p.x + a12 * p.y + a22 * p.z;
+		const float r = p.x * rx + p.y * ry + p.z * rz + 2 * ( b0 * p.x + b1 * p.y + b2 * p.z ) + c;
+		return ( w > 0 ) ? fabsf( r ) / w : 0;
+	}
+
+	float	a00, a11, a22, a01, a02, a12, b0, b1, b2, c, w;
+};
+
+//! Half-edges leaving each vertex, as (next,prev) of the triangle they belong to
+struct EdgeAdjacency {
+	struct Edge {
+		uint32_t	mNext, mPrev;
+	};
+
+	void build( const std::vector<uint32_t> &indices, size_t numVertices )
+	{
+		mCounts.assign( numVertices, 0 );
+		mOffsets.resize( numVertices );
+		mData.resize( indices.size() );
+		for( size_t i = 0; i < indices.size(); ++i )
+			mCounts[indices[i]]++;
+		uint32_t offset = 0;
+		for( size_t v = 0; v < numVertices; ++v ) {
+			mOffsets[v] = offset;
+			offset += mCounts[v];
+		}
+
+		std::vector<uint32_t> fill( mOffsets );
+		for( size_t i = 0; i < indices.size(); i += 3 ) {
+			const uint32_t a = indices[i+0], b = indices[i+1], c = indices[i+2];
+			Edge ab = { b, c }, bc = { c, a }, ca = { a, b };
+			mData[fill[a]++] = ab;
+			mData[fill[b]++] = bc;
+			mData[fill[c]++] = ca;
+		}
+	}
+
+	bool hasEdge( uint32_t a, uint32_t b ) const
+	{
+		for( uint32_t e = mOffsets[a]; e < mOffsets[a] + mCounts[a]; ++e ) {
+			if( mData[e].mNext == b )
+				return true;
+		}
+		return false;
+	}
+
+	std::vector<uint32_t>	mCounts, mOffsets;
+	std::vector<Edge>		mData;
+};
+
+enum VertexKind { VERTEX_MANIFOLD, VERTEX_BORDER, VERTEX_SEAM, VERTEX_LOCKED };
+
+struct EdgeCollapse {
+	uint32_t	mV0, mV1;
+	float		mError;
+
+	bool operator<( const EdgeCollapse &rhs ) const { return mError < rhs.mError; }
+};
+
+/*! Shared state for simplifying any index buffer over one set of vertices. Positions are scaled into the unit cube, which keeps the
+	single precision quadric sums well conditioned. Vertices which share a position are linked into a circular list of "wedges". */
+class MeshSimplifier {
+  public:
+	MeshSimplifier( const float *positions, uint8_t dims, size_t numVertices )
+		: mPositions( numVertices ), mRemap( numVertices ), mWedge( numVertices ), mScale( 1 )
+	{
+		Vec3f minP( FLT_MAX, FLT_MAX, FLT_MAX ), maxP( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+		for( size_t v = 0; v < numVertices; ++v ) {
+			const float *p = positions + v * dims;
+			mPositions[v] = Vec3f( p[0], ( dims > 1 ) ? p[1] : 0, ( dims > 2 ) ? p[2] : 0 );
+			minP.x = std::min( minP.x, mPositions[v].x ); maxP.x = std::max( maxP.x, mPositions[v].x );
+			minP.y = std::min( minP.y, mPositions[v].y ); maxP.y = std::max( maxP.y, mPositions[v].y );
+			minP.z = std::min( minP.z, mPositions[v].z ); maxP.z = std::max( maxP.z, mPositions[v].z );
+		}
+		const float extent = std::max( maxP.x - minP.x, std::max( maxP.y - minP.y, maxP.z - minP.z ) );
+		if( extent > 0 ) {
+			mScale = extent;
+			for( size_t v = 0; v < numVertices; ++v )
+				mPositions[v] = ( mPositions[v] - minP ) / extent;
+		}
+
+		// link vertices sharing a bitwise identical position
+		size_t tableSize = 1;
+		while( tableSize < numVertices * 2 )
+			tableSize *= 2;
+		std::vector<uint32_t> table( tableSize, kInvalidIndex );
+		for( uint32_t v = 0; v < numVertices; ++v ) {
+			const uint32_t *bits = reinterpret_cast<const uint32_t*>( &mPositions[v].x );
+			size_t slot = hashCombine( hashCombine( hashCombine( 0, bits[0] ), bits[1] ), bits[2] ) & ( tableSize - 1 );
+			for( ;; slot = ( slot + 1 ) & ( tableSize - 1 ) ) {
+				const uint32_t other = table[slot];
+				if( other == kInvalidIndex ) {
+					table[slot] = v;
+					mRemap[v] = v;
+					mWedge[v] = v;
+					break;
+				}
+				if( mPositions[other] == mPositions[v] ) {
+					mRemap[v] = other;
+					mWedge[v] = mWedge[other];
+					mWedge[other] = v;
+					break;
+				}
+			}
+		}
+	}
+
+	float	getScale() const { return mScale; }
+
+	//! Returns \a indices reduced by edge collapses until at most \a targetIndexCount remain or no collapse below \a maxError (normalized squared units) is left
+	std::vector<uint32_t>	simplify( const std::vector<uint32_t> &indices, size_t targetIndexCount, float maxError, float *resultError ) const;
+	//! Returns \a indices clustered on the coarsest grid which yields no more than \a targetIndexCount indices
+	std::vector<uint32_t>	cluster( const std::vector<uint32_t> &indices, size_t targetIndexCount, float *resultError ) const;
+
+  protected:
+	void	computeOpenEdges( const EdgeAdjacency &adjacency, std::vector<uint32_t> *openIn, std::vector<uint32_t> *openOut ) const;
+	void	classifyVertices( const std::vector<uint32_t> &openIn, const std::vector<uint32_t> &openOut, std::vector<uint8_t> *kinds ) const;
+	bool	canCollapse( const std::vector<uint8_t> &kinds, const std::vector<uint32_t> &openIn, const std::vector<uint32_t> &openOut, uint32_t v0, uint32_t v1 ) const;
+	bool	hasPositionEdge( const EdgeAdjacency &adjacency, uint32_t a, uint32_t b ) const;
+	bool	hasTriangleFlips( const EdgeAdjacency &adjacency, uint32_t v0, uint32_t v1 ) const;
+
+	std::vector<Vec3f>		mPositions;
+	std::vector<uint32_t>	mRemap, mWedge;
+	float					mScale;
+};
+
+void MeshSimplifier::computeOpenEdges( const EdgeAdjacency &adjacency, std::vector<uint32_t> *openIn, std::vector<uint32_t> *openOut ) const
+{
+	openIn->assign( mPositions.size(), kInvalidIndex );
+	openOut->assign( mPositions.size(), kInvalidIndex );
+	for( uint32_t v = 0; v < mPositions.size(); ++v ) {
+		for( uint32_t e = adjacency.mOffsets[v]; e < adjacency.mOffsets[v] + adjacency.mCounts[v]; ++e ) {
+			const uint32_t t = adjacency.mData[e].mNext;
+			if( ! adjacency.hasEdge( t, v ) ) {
+				(*openOut)[v] = ( (*openOut)[v] == kInvalidIndex ) ? t : kMultipleEdges;
+				(*openIn)[t] = ( (*openIn)[t] == kInvalidIndex ) ? v : kMultipleEdges;
+			}
+		}
+	}
+}
+
+void MeshSimplifier::classifyVertices( const std::vector<uint32_t> &openIn, const std::vector<uint32_t> &openOut, std::vector<uint8_t> *kinds ) const
+{
+	kinds->assign( mPositions.size(), VERTEX_LOCKED );
+	for( uint32_t v = 0; v < mPositions.size(); ++v ) {
+		if( mRemap[v] != v )
+			continue;
+
+		uint8_t kind = VERTEX_LOCKED;
+		const uint32_t w = mWedge[v];
+		if( w == v ) {
+			const bool singleIn = openIn[v] < kMultipleEdges, singleOut = openOut[v] < kMultipleEdges;
+			if( openIn[v] == kInvalidIndex && openOut[v] == kInvalidIndex )
+				kind = VERTEX_MANIFOLD;
+			// the tip of a seam has a single open edge on either side which meet at the same position; it must stay put
+			else if( singleIn && singleOut && mRemap[openIn[v]] != mRemap[openOut[v]] )
+				kind = VERTEX_BORDER;
+		}
+		else if( mWedge[w] == v ) {
+			// a seam vertex pair, whose open edges have to mirror each other for the pair to collapse in lockstep
+			const bool single = openIn[v] < kMultipleEdges && openOut[v] < kMultipleEdges && openIn[w] < kMultipleEdges && openOut[w] < kMultipleEdges;
+			if( single && mRemap[openIn[v]] == mRemap[openOut[w]] && mRemap[openOut[v]] == mRemap[openIn[w]] )
+				kind = VERTEX_SEAM;
+		}
+
+		uint32_t wedge = v;
+		do {
+			(*kinds)[wedge] = kind;
+			wedge = mWedge[wedge];
+		} while( wedge != v );
+	}
+}
+
+bool MeshSimplifier::canCollapse( const std::vector<uint8_t> &kinds, const std::vector<uint32_t> &openIn, const std::vector<uint32_t> &openOut, uint32_t v0, uint32_t v1 ) const
+{
+	switch( kinds[v0] ) {
+		case VERTEX_MANIFOLD:
+			return true;
+		case VERTEX_BORDER:
+			// only along the border, onto a vertex which is itself pinned to it
+			return ( kinds[v1] == VERTEX_BORDER || kinds[v1] == VERTEX_LOCKED ) && ( openOut[v0] == v1 || openIn[v0] == v1 );
+		case VERTEX_SEAM: {
+			// only along the seam, and both sides of it together
+			if( kinds[v1] != VERTEX_SEAM && ( kinds[v1] != VERTEX_LOCKED || mWedge[v1] == v1 || mWedge[mWedge[v1]] != v1 ) )
+				return false;
+			const uint32_t s0 = mWedge[v0], s1 = mWedge[v1];
+			return ( openOut[v0] == v1 || openIn[v0] == v1 ) && ( openOut[s0] == s1 || openIn[s0] == s1 );
+		}
+		default:
+			return false;
+	}
+}
+
+bool MeshSimplifier::hasPositionEdge( const EdgeAdjacency &adjacency, uint32_t a, uint32_t b ) const
+{
+	const uint32_t rb = mRemap[b];
+	uint32_t wedge = a;
+	do {
+		for( uint32_t e = adjacency.mOffsets[wedge]; e < adjacency.mOffsets[wedge] + adjacency.mCounts[wedge]; ++e ) {
+			if( mRemap[adjacency.mData[e].mNext] == rb )
+				return true;
+		}
+		wedge = mWedge[wedge];
+	} while( wedge != a );
+
+	return false;
+}
+
+bool MeshSimplifier::hasTriangleFlips( const EdgeAdjacency &adjacency, uint32_t v0, uint32_t v1 ) const
+{
+	const uint32_t r1 = mRemap[v1];
+	const Vec3f &target = mPositions[v1];
+	uint32_t wedge = v0;
+	do {
+		const Vec3f &source = mPositions[wedge];
+		for( uint32_t e = adjacency.mOffsets[wedge]; e < adjacency.mOffsets[wedge] + adjacency.mCounts[wedge]; ++e ) {
+			const uint32_t a = adjacency.mData[e].mNext, b = adjacency.mData[e].mPrev;
+			// triangles sharing the collapsed edge disappear
+			if( mRemap[a] == r1 || mRemap[b] == r1 )
+				continue;
+			const Vec3f &pa = mPositions[a], &pb = mPositions[b];
+			const Vec3f before = ( pa - source ).cross( pb - source );
+			const Vec3f after = ( pa - target ).cross( pb - target );
+			if( before.dot( after ) < 0 )
+				return true;
+		}
+		wedge = mWedge[wedge];
+	} while( wedge != v0 );
+
+	return false;
+}
+
+std::vector<uint32_t> MeshSimplifier::simplify( const std::vector<uint32_t> &indices, size_t targetIndexCount, float maxError, float *resultError ) const
+{
+	const size_t numVertices = mPositions.size();
+	std::vector<uint32_t> result( indices );
+	float worstError = 0;
+
+	EdgeAdjacency adjacency;
+	adjacency.build( result, numVertices );
+	std::vector<uint32_t> openIn, openOut;
+	computeOpenEdges( adjacency, &openIn, &openOut );
+	std::vector<uint8_t> kinds;
+	classifyVertices( openIn, openOut, &kinds );
+
+	// per-position quadrics of the incident faces, plus the planes perpendicular to open and seam edges
+	std::vector<Quadric> quadrics( numVertices );
+	for( size_t i = 0; i < result.size(); i += 3 ) {
+		const uint32_t tri[3] = { result[i+0], result[i+1], result[i+2] };
+		Vec3f normal = ( mPositions[tri[1]] - mPositions[tri[0]] ).cross( mPositions[tri[2]] - mPositions[tri[0]] );
+		const float area = normal.length();
+		if( area <= 0 )
+			continue;
+		normal /= area;
+
+		const Quadric face( normal, -normal.dot( mPositions[tri[0]] ), area * 0.5f );
+		for( int k = 0; k < 3; ++k )
+			quadrics[mRemap[tri[k]]].add( face );
+
+		for( int k = 0; k < 3; ++k ) {
+			const uint32_t i0 = tri[k], i1 = tri[(k+1)%3];
+			if( adjacency.hasEdge( i1, i0 ) )
+				continue;
+			const Vec3f edge = mPositions[i1] - mPositions[i0];
+			const float length = edge.length();
+			if( length <= 0 )
+				continue;
+			Vec3f perpendicular = edge.cross( normal );
+			perpendicular.normalize();
+			const Quadric boundary( perpendicular, -perpendicular.dot( mPositions[i0] ), length * length * kBoundaryWeight );
+			quadrics[mRemap[i0]].add( boundary );
+			quadrics[mRemap[i1]].add( boundary );
+		}
+	}
+
+	std::vector<EdgeCollapse> collapses;
+	std::vector<uint32_t> collapseRemap( numVertices );
+	std::vector<uint8_t> collapseLocked( numVertices );
+	while( result.size() > targetIndexCount ) {
+		// gather each collapsible edge once, in the direction of least error
+		collapses.clear();
+		for( size_t i = 0; i < result.size(); i += 3 ) {
+			for( int k = 0; k < 3; ++k ) {
+				const uint32_t i0 = result[i + k], i1 = result[i + ( k + 1 ) % 3];
+				const uint32_t r0 = mRemap[i0], r1 = mRemap[i1];
+				// interior edges are seen from both of their triangles
+				if( r0 > r1 && hasPositionEdge( adjacency, i1, i0 ) )
+					continue;
+				const bool can01 = canCollapse( kinds, openIn, openOut, i0, i1 ), can10 = canCollapse( kinds, openIn, openOut, i1, i0 );
+				if( ! can01 && ! can10 )
+					continue;
+
+				Quadric q = quadrics[r0];
+				q.add( quadrics[r1] );
+				const float error01 = can01 ? q.error( mPositions[i1] ) : FLT_MAX;
+				const float error10 = can10 ? q.error( mPositions[i0] ) : FLT_MAX;
+				EdgeCollapse collapse = { ( error01 <= error10 ) ? i0 : i1, ( error01 <= error10 ) ? i1 : i0, std::min( error01, error10 ) };
+				collapses.push_back( collapse );
+			}
+		}
+		if( collapses.empty() )
+			break;
+		std::sort( collapses.begin(), collapses.end() );
+
+		// most collapses remove two triangles; cap each pass near the goal so later collapses see updated quadrics
+		const size_t triangleGoal = ( result.size() - targetIndexCount ) / 3;
+		const size_t edgeGoal = std::max<size_t>( triangleGoal / 2, 1 );
+		// rejected candidates don't count against the pass, otherwise a cluster of blocked low-error collapses stalls progress
+		size_t limitIndex = std::min( edgeGoal + edgeGoal / 2, collapses.size() - 1 );
+
+		for( uint32_t v = 0; v < numVertices; ++v )
+			collapseRemap[v] = v;
+		std::fill( collapseLocked.begin(), collapseLocked.end(), 0 );
+		size_t trianglesCollapsed = 0;
+		for( std::vector<EdgeCollapse>::const_iterator collapseIt = collapses.begin(); collapseIt != collapses.end(); ++collapseIt ) {
+			if( collapseIt->mError > std::min( maxError, collapses[limitIndex].mError ) || trianglesCollapsed >= triangleGoal )
+				break;
+			const uint32_t i0 = collapseIt->mV0, i1 = collapseIt->mV1;
+			const uint32_t r0 = mRemap[i0], r1 = mRemap[i1];
+			if( collapseLocked[r0] || collapseLocked[r1] || hasTriangleFlips( adjacency, i0, i1 ) ) {
+				limitIndex = std::min( limitIndex + 1, collapses.size() - 1 );
+				continue;
+			}
+
+			collapseRemap[i0] = i1;
+			if( kinds[i0] == VERTEX_SEAM )
+				collapseRemap[mWedge[i0]] = mWedge[i1];
+			quadrics[r1].add( quadrics[r0] );
+			collapseLocked[r0] = collapseLocked[r1] = 1;
+			worstError = std::max( worstError, collapseIt->mError );
+			trianglesCollapsed += ( kinds[i0] == VERTEX_BORDER ) ? 1 : 2;
+		}
+		if( trianglesCollapsed == 0 )
+			break;
+
+		size_t numIndices = 0;
+		for( size_t i = 0; i < result.size(); i += 3 ) {
+			const uint32_t a = collapseRemap[result[i+0]], b = collapseRemap[result[i+1]], c = collapseRemap[result[i+2]];
+			if( a != b && b != c && c != a ) {
+				result[numIndices++] = a;
+				result[numIndices++] = b;
+				result[numIndices++] = c;
+			}
+		}
+		result.resize( numIndices );
+
+		// collapses open and close edges, so borders and seams are reclassified against the new topology
+		adjacency.build( result, numVertices );
+		computeOpenEdges( adjacency, &openIn, &openOut );
+		classifyVertices( openIn, openOut, &kinds );
+	}
+
+	if( resultError )
+		*resultError = worstError;
+	return result;
+}
+
+std::vector<uint32_t> MeshSimplifier::cluster( const std::vector<uint32_t> &indices, size_t targetIndexCount, float *resultError ) const
+{
+	const size_t numVertices = mPositions.size();
+	const size_t numTriangles = indices.size() / 3;
+	if( indices.size() <= targetIndexCount ) {
+		if( resultError )
+			*resultError = 0;
+		return indices;
+	}
+
+	std::vector<uint32_t> cells( numVertices );
+	auto assignCells = [&]( uint32_t gridSize ) {
+		const uint32_t maxCell = gridSize - 1;
+		parallelFor( 0, numVertices, 16384, [&]( size_t begin, size_t end ) {
+			for( size_t v = begin; v < end; ++v ) {
+				const uint32_t x = std::min( uint32_t( mPositions[v].x * gridSize ), maxCell );
+				const uint32_t y = std::min( uint32_t( mPositions[v].y * gridSize ), maxCell );
+				const uint32_t z = std::min( uint32_t( mPositions[v].z * gridSize ), maxCell );
+				cells[v] = ( x * gridSize + y ) * gridSize + z;
+			}
+		} );
+	};
+	// triangles which survive clustering, before duplicates are removed
+	auto countTriangles = [&]() -> size_t {
+		std::mutex mutex;
+		size_t count = 0;
+		parallelFor( 0, numTriangles, 16384, [&]( size_t begin, size_t end ) {
+			size_t chunkCount = 0;
+			for( size_t t = begin; t < end; ++t ) {
+				const uint32_t a = cells[indices[t*3+0]], b = cells[indices[t*3+1]], c = cells[indices[t*3+2]];
+				chunkCount += ( a != b && b != c && c != a ) ? 1 : 0;
+			}
+			std::lock_guard<std::mutex> lock( mutex );
+			count += chunkCount;
+		} );
+		return count;
+	};
+
+	// binary search for the finest grid which stays within budget; 1024^3 cells still fit in 32 bits
+	uint32_t lowGrid = 1, highGrid = 1024;
+	while( lowGrid + 1 < highGrid ) {
+		const uint32_t gridSize = ( lowGrid + highGrid ) / 2;
+		assignCells( gridSize );
+		if( countTriangles() * 3 <= targetIndexCount )
+			lowGrid = gridSize;
+		else
+			highGrid = gridSize;
+	}
+	assignCells( lowGrid );
+
+	// compact the occupied cells
+	size_t tableSize = 1;
+	while( tableSize < numVertices * 2 )
+		tableSize *= 2;
+	std::vector<uint32_t> table( tableSize, kInvalidIndex ), cellIndices( numVertices );
+	uint32_t numCells = 0;
+	for( uint32_t v = 0; v < numVertices; ++v ) {
+		size_t slot = hashCombine( 0, cells[v] ) & ( tableSize - 1 );
+		for( ;; slot = ( slot + 1 ) & ( tableSize - 1 ) ) {
+			const uint32_t other = table[slot];
+			if( other == kInvalidIndex ) {
+				table[slot] = v;
+				cellIndices[v] = numCells++;
+				break;
+			}
+			if( cells[other] == cells[v] ) {
+				cellIndices[v] = cellIndices[other];
+				break;
+			}
+		}
+	}
+
+	// each cell is represented by its vertex which best fits the planes of the triangles touching the cell
+	std::vector<Quadric> cellQuadrics( numCells );
+	for( size_t i = 0; i < indices.size(); i += 3 ) {
+		const Vec3f &p0 = mPositions[indices[i+0]], &p1 = mPositions[indices[i+1]], &p2 = mPositions[indices[i+2]];
+		Vec3f normal = ( p1 - p0 ).cross( p2 - p0 );
+		const float area = normal.length();
+		if( area <= 0 )
+			continue;
+		normal /= area;
+		const Quadric face( normal, -normal.dot( p0 ), area * 0.5f );
+		for( int k = 0; k < 3; ++k )
+			cellQuadrics[cellIndices[indices[i+k]]].add( face );
+	}
+	std::vector<uint32_t> cellVertices( numCells, kInvalidIndex );
+	std::vector<float> cellErrors( numCells, FLT_MAX );
+	for( uint32_t v = 0; v < numVertices; ++v ) {
+		const uint32_t cell = cellIndices[v];
+		const float error = cellQuadrics[cell].error( mPositions[v] );
+		if( error < cellErrors[cell] ) {
+			cellErrors[cell] = error;
+			cellVertices[cell] = v;
+		}
+	}
+
+	// emit the surviving triangles once each; rotating the smallest index first makes duplicates compare equal without changing winding
+	std::vector<uint32_t> result;
+	result.reserve( std::min( indices.size(), targetIndexCount ) );
+	tableSize = 1;
+	while( tableSize < numTriangles * 2 )
+		tableSize *= 2;
+	table.assign( tableSize, kInvalidIndex );
+	for( size_t i = 0; i < indices.size(); i += 3 ) {
+		uint32_t tri[3] = { cellVertices[cellIndices[indices[i+0]]], cellVertices[cellIndices[indices[i+1]]], cellVertices[cellIndices[indices[i+2]]] };
+		if( tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0] )
+			continue;
+		if( tri[1] < tri[0] && tri[1] < tri[2] )
+			std::rotate( tri, tri + 1, tri + 3 );
+		else if( tri[2] < tri[0] && tri[2] < tri[1] )
+			std::rotate( tri, tri + 2, tri + 3 );
+
+		size_t slot = hashCombine( hashCombine( hashCombine( 0, tri[0] ), tri[1] ), tri[2] ) & ( tableSize - 1 );
+		for( ;; slot = ( slot + 1 ) & ( tableSize - 1 ) ) {
+			const uint32_t other = table[slot];
+			if( other == kInvalidIndex ) {
+				table[slot] = uint32_t( result.size() );
+				result.insert( result.end(), tri, tri + 3 );
+				break;
+			}
+			if( result[other] == tri[0] && result[other+1] == tri[1] && result[other+2] == tri[2] )
+				break;
+		}
+	}
+
+	if( resultError ) {
+		// the distance each referenced vertex moved, squared to match the quadric error of simplify()
+		std::mutex mutex;
+		float worstError = 0;
+		parallelFor( 0, indices.size(), 65536, [&]( size_t begin, size_t end ) {
+			float chunkError = 0;
+			for( size_t i = begin; i < end; ++i )
+				chunkError = std::max( chunkError, mPositions[indices[i]].distanceSquared( mPositions[cellVertices[cellIndices[indices[i]]]] ) );
+			std::lock_guard<std::mutex> lock( mutex );
+			worstError = std::max( worstError, chunkError );
+		} );
+		*resultError = worstError;
+	}
+
+	return result;
+}
+
+} // anonymous namespace
+
+std::vector<uint32_t> TriMesh::simplify( size_t targetNumTriangles, float maxError, float *resultError ) const
+{
+	MeshSimplifier simplifier( mPositions.data(), mPositionsDims, getNumVertices() );
+	const float scale = simplifier.getScale();
+	const float normalizedMaxError = ( maxError < FLT_MAX ) ? ( maxError / scale ) * ( maxError / scale ) : FLT_MAX;
+
+	float error;
+	std::vector<uint32_t> result = simplifier.simplify( mIndices, targetNumTriangles * 3, normalizedMaxError, &error );
+	if( resultError )
+		*resultError = sqrtf( error ) * scale;
+	return result;
+}
+
+std::vector<uint32_t> TriMesh::simplifyClustered( size_t targetNumTriangles, float *resultError ) const
+{
+	MeshSimplifier simplifier( mPositions.data(), mPositionsDims, getNumVertices() );
+
+	float error;
+	std::vector<uint32_t> result = simplifier.cluster( mIndices, targetNumTriangles * 3, &error );
+	if( resultError )
+		*resultError = sqrtf( error ) * simplifier.getScale();
+	return result;
+}
+
+std::vector<std::vector<uint32_t>> TriMesh::calcLodChain( size_t numLevels, float reduction, bool fast, std::vector<float> *resultErrors ) const
+{
+	std::vector<std::vector<uint32_t>> result;
+	if( resultErrors )
+		resultErrors->clear();
+	if( numLevels == 0 )
+		return result;
+
+	result.push_back( mIndices );
+	if( resultErrors )
+		resultErrors->push_back( 0 );
+
+	MeshSimplifier simplifier( mPositions.data(), mPositionsDims, getNumVertices() );
+	const float scale = simplifier.getScale();
+	float errorBound = 0;
+	while( result.size() < numLevels ) {
+		// each level is built from the previous one, which is both cheaper and keeps the chain nested
+		const std::vector<uint32_t> &previous = result.back();
+		const size_t targetIndexCount = size_t( previous.size() / 3 * reduction ) * 3;
+
+		// the full resolution mesh dominates the cost, so in fast mode clustering takes the first step and collapses refine from there
+		float error;
+		std::vector<uint32_t> level;
+		if( fast && result.size() == 1 )
+			level = simplifier.cluster( previous, targetIndexCount, &error );
+		else
+			level = simplifier.simplify( previous, targetIndexCount, FLT_MAX, &error );
+
+		if( level.empty() || level.size() >= previous.size() )
+			break;
+
+		errorBound += sqrtf( error ) * scale;
+		result.push_back( std::move( level ) );
+		if( resultErrors )
+			resultErrors->push_back( errorBound );
+	}
+
+	return result;
+}
+
 /*TriMesh TriMesh::create( vector<uint32_t> &indices, const vector<ColorAf> &colors,
 						const vector<Vec3f> &normals, const vector<Vec3f> &positions,
 						const vector<Vec2f> &texCoords )
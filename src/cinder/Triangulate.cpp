@@ -22,23 +22,122 @@
 
 #include "cinder/Triangulate.h"
 #include "cinder/Shape2d.h"
+#include "cinder/Thread.h"
 #include "../libtess2/tesselator.h"
 
+#include <cstdlib>
+#include <cstring>
+
 using namespace std;
 
 namespace cinder {
 
-void* stdAlloc( void* userData, unsigned int size )
-{
-	int *allocated = (int*)userData;
-	*allocated += (int)size;
-	return malloc( size );
-}
+// Recycling allocator backing libtess2. Blocks are rounded up to power-of-two size classes and kept on per-class
+// free lists when released, so the mesh buckets, priority queues and output arrays of each tesselation reuse the
+// memory of the previous one rather than going back to malloc. Not thread-safe; each Triangulator owns one.
+class Triangulator::MemoryPool {
+  public:
+	MemoryPool()
+		: mAllocated( 0 )
+	{
+		memset( mFreeLists, 0, sizeof(mFreeLists) );
+	}
 
-void stdFree( void* userData, void* ptr )
-{
-	free( ptr );
-}
+	~MemoryPool()
+	{
+		for( size_t c = 0; c < NUM_SIZE_CLASSES; ++c ) {
+			while( mFreeLists[c] ) {
+				Block *block = mFreeLists[c];
+				mFreeLists[c] = block->mNext;
+				free( block );
+			}
+		}
+	}
+
+	void* alloc( size_t size )
+	{
+		size_t sizeClass = calcSizeClass( size );
+		Block *block;
+		if( sizeClass < NUM_SIZE_CLASSES && mFreeLists[sizeClass] ) {
+			block = mFreeLists[sizeClass];
+			mFreeLists[sizeClass] = block->mNext;
+		}
+		else {
+			size_t capacity = ( sizeClass < NUM_SIZE_CLASSES ) ? getClassSize( sizeClass ) : size;
+			block = (Block*)malloc( sizeof(Block) + capacity );
+			if( ! block )
+				return nullptr;
+			mAllocated += capacity;
+		}
+		block->mSizeClass = sizeClass;
+		block->mSize = size;
+		return block + 1;
+	}
+
+	void* realloc( void *ptr, size_t size )
+	{
+		if( ! ptr )
+			return alloc( size );
+		Block *block = (Block*)ptr - 1;
+		if( block->mSizeClass < NUM_SIZE_CLASSES && size <= getClassSize( block->mSizeClass ) ) {
+			block->mSize = size;
+			return ptr;
+		}
+		void *result = alloc( size );
+		if( ! result )
+			return nullptr;
+		memcpy( result, ptr, std::min( size, block->mSize ) );
+		release( ptr );
+		return result;
+	}
+
+	void release( void *ptr )
+	{
+		if( ! ptr )
+			return;
+		Block *block = (Block*)ptr - 1;
+		if( block->mSizeClass < NUM_SIZE_CLASSES ) {
+			block->mNext = mFreeLists[block->mSizeClass];
+			mFreeLists[block->mSizeClass] = block;
+		}
+		else {
+			mAllocated -= block->mSize;
+			free( block );
+		}
+	}
+
+	size_t	getNumBytesAllocated() const { return mAllocated; }
+
+	static void* tessAlloc( void *userData, unsigned int size )					{ return ((MemoryPool*)userData)->alloc( size ); }
+	static void* tessRealloc( void *userData, void *ptr, unsigned int size )	{ return ((MemoryPool*)userData)->realloc( ptr, size ); }
+	static void tessFree( void *userData, void *ptr )							{ ((MemoryPool*)userData)->release( ptr ); }
+
+  private:
+	// 32 bytes through 64MB; anything larger goes straight to the system allocator
+	static const size_t	MIN_SIZE_CLASS_SHIFT = 5;
+	static const size_t	NUM_SIZE_CLASSES = 22;
+
+	// header preceding each block; the size is only needed while the block is live, the link only while it is free
+	struct Block {
+		union {
+			size_t	mSize;
+			Block	*mNext;
+		};
+		size_t		mSizeClass;
+	};
+
+	static size_t	getClassSize( size_t sizeClass ) { return size_t( 1 ) << ( sizeClass + MIN_SIZE_CLASS_SHIFT ); }
+	static size_t	calcSizeClass( size_t size )
+	{
+		size_t sizeClass = 0;
+		while( sizeClass < NUM_SIZE_CLASSES && getClassSize( sizeClass ) < size )
+			++sizeClass;
+		return sizeClass;
+	}
+
+	Block		*mFreeLists[NUM_SIZE_CLASSES];
+	size_t		mAllocated;
+};
 
 Triangulator::Triangulator( const Path2d &path, float approximationScale )
 {	
@@ -65,18 +164,30 @@ Triangulator::Triangulator()
 
 void Triangulator::allocate()
 {
-	mAllocated = 0;
-	
+	if( ! mPool )
+		mPool = make_shared<MemoryPool>();
+
 	TESSalloc ma;
 	memset( &ma, 0, sizeof(ma) );
-	ma.memalloc = stdAlloc;
-	ma.memfree = stdFree;
-	ma.userData = (void*)&mAllocated;
-	ma.extraVertices = 2560; // realloc not provided, allow 256 extra vertices.
+	ma.memalloc = MemoryPool::tessAlloc;
+	ma.memrealloc = MemoryPool::tessRealloc;
+	ma.memfree = MemoryPool::tessFree;
+	ma.userData = (void*)mPool.get();
+	ma.extraVertices = 256;
 
-	mTess = shared_ptr<TESStesselator>( tessNewTess( &ma ), tessDeleteTess );
-	if( ! mTess )
+	// the deleter holds a reference to the pool so that copies of this Triangulator keep it alive
+	shared_ptr<MemoryPool> pool = mPool;
+	mTess.reset();
+	TESStesselator *tess = tessNewTess( &ma );
+	if( ! tess )
 		throw Triangulator::Exception();
+	mTess = shared_ptr<TESStesselator>( tess, [pool]( TESStesselator *t ) { tessDeleteTess( t ); } );
+}
+
+void Triangulator::reset()
+{
+	// libtess2 has no way to discard pending contours short of tesselating them; recreating is cheap since the pool retains its blocks
+	allocate();
 }
 
 void Triangulator::addShape( const Shape2d &shape, float approximationScale )
@@ -89,24 +200,81 @@ void Triangulator::addShape( const Shape2d &shape, float approximationScale )
 
 void Triangulator::addPath( const Path2d &path, float approximationScale )
 {
-	vector<Vec2f> subdivided = path.subdivide( approximationScale );
-	tessAddContour( mTess.get(), 2, &subdivided[0], sizeof(float) * 2, subdivided.size() );
+	path.subdivide( &mSubdivided, approximationScale );
+	addContour( mSubdivided.data(), mSubdivided.size() );
 }
 
 void Triangulator::addPolyLine( const PolyLine2f &polyLine )
 {
-	tessAddContour( mTess.get(), 2, &polyLine.getPoints()[0], sizeof(float) * 2, polyLine.size() );
+	addContour( polyLine.getPoints().data(), polyLine.size() );
+}
+
+void Triangulator::addContour( const Vec2f *points, size_t numPoints )
+{
+	if( numPoints > 0 )
+		tessAddContour( mTess.get(), 2, points, sizeof(float) * 2, (int)numPoints );
+}
+
+bool Triangulator::tesselate( Winding winding )
+{
+	// fails when no contours have been added since the last tesselation
+	return tessTesselate( mTess.get(), (int)winding, TESS_POLYGONS, 3, 2, 0 ) != 0;
 }
 
 TriMesh Triangulator::calcMesh( Winding winding )
 {
 	TriMesh result( TriMesh::Format().positions( 2 ) );
-	
-	tessTesselate( mTess.get(), (int)winding, TESS_POLYGONS, 3, 2, 0 );
-	result.appendVertices( (Vec2f*)tessGetVertices( mTess.get() ), tessGetVertexCount( mTess.get() ) );
-	result.appendIndices( (uint32_t*)( tessGetElements( mTess.get() ) ), tessGetElementCount( mTess.get() ) * 3 );
-	
+	calcMesh( &result, winding );
 	return result;
 }
 
+void Triangulator::calcMesh( TriMesh *result, Winding winding )
+{
+	result->clear();
+	if( ! tesselate( winding ) )
+		return;
+
+	result->appendVertices( (Vec2f*)tessGetVertices( mTess.get() ), tessGetVertexCount( mTess.get() ) );
+	result->appendIndices( (uint32_t*)( tessGetElements( mTess.get() ) ), tessGetElementCount( mTess.get() ) * 3 );
+}
+
+size_t Triangulator::calcMesh( std::vector<Vec2f> *positions, std::vector<uint32_t> *indices, Winding winding )
+{
+	if( ! tesselate( winding ) )
+		return 0;
+
+	const Vec2f *verts = (const Vec2f*)tessGetVertices( mTess.get() );
+	const uint32_t *elements = (const uint32_t*)tessGetElements( mTess.get() );
+	size_t numVerts = tessGetVertexCount( mTess.get() );
+	size_t numIndices = tessGetElementCount( mTess.get() ) * 3;
+	uint32_t offset = (uint32_t)positions->size();
+
+	positions->insert( positions->end(), verts, verts + numVerts );
+	size_t firstIndex = indices->size();
+	indices->resize( firstIndex + numIndices );
+	for( size_t i = 0; i < numIndices; ++i )
+		(*indices)[firstIndex + i] = elements[i] + offset;
+
+	return numIndices / 3;
+}
+
+void Triangulator::calcMeshes( const std::vector<Shape2d> &shapes, std::vector<TriMesh> *result, float approximationScale, Winding winding )
+{
+	if( result->size() != shapes.size() )
+		result->assign( shapes.size(), TriMesh( TriMesh::Format().positions( 2 ) ) );
+
+	parallelFor( 0, shapes.size(), 16, [&]( size_t begin, size_t end ) {
+		Triangulator triangulator;
+		for( size_t s = begin; s < end; ++s ) {
+			triangulator.addShape( shapes[s], approximationScale );
+			triangulator.calcMesh( &(*result)[s], winding );
+		}
+	} );
+}
+
+size_t Triangulator::getNumBytesAllocated() const
+{
+	return mPool->getNumBytesAllocated();
+}
+
 } // namespace cinder
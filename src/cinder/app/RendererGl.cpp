@@ -22,6 +22,7 @@
 */
 
 #include "cinder/app/RendererGl.h"
+#include "cinder/gl/Context.h"
 #include "cinder/ip/Flip.h"
 
 #if defined( CINDER_COCOA )
@@ -80,6 +81,7 @@ void RendererGl::startDraw()
 
 void RendererGl::finishDraw()
 {
+	gl::context()->endFrameStats();
 	[mImpl flushBuffer];
 }
 
@@ -151,6 +153,7 @@ void RendererGl::startDraw()
 
 void RendererGl::finishDraw()
 {
+	gl::context()->endFrameStats();
 	[mImpl flushBuffer];
 }
 
@@ -230,6 +233,7 @@ void RendererGl::makeCurrentContext()
 
 void RendererGl::finishDraw()
 {
+	gl::context()->endFrameStats();
 	mImpl->swapBuffers();
 }
 
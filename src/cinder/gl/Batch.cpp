@@ -178,7 +178,7 @@ void Batch::initVao( const AttributeMapping &attributeMapping )
 
 			if( loc != -1 ) {
 				ctx->enableVertexAttribArray( loc );
-				ctx->vertexAttribPointer( loc, attribInfo.getDims(), GL_FLOAT, GL_FALSE, attribInfo.getStride(), (const void*)attribInfo.getOffset() );
+				ctx->vertexAttribPointer( loc, toGlAttribSize( attribInfo ), toGl( attribInfo.getDataType() ), geom::isNormalized( attribInfo.getDataType() ) ? GL_TRUE : GL_FALSE, attribInfo.getStride(), (const void*)attribInfo.getOffset() );
 				if( attribInfo.getInstanceDivisor() > 0 )
 					ctx->vertexAttribDivisor( loc, attribInfo.getInstanceDivisor() );
 				enabledAttribs.insert( attribInfo.getAttrib() );
@@ -251,14 +251,7 @@ void Batch::reassignContext( Context *context )
 VertBatch::VertBatch( GLenum primType, bool useContextDefaultBuffers )
 	: mPrimType( primType )
 {
-	if( useContextDefaultBuffers ) {
-		auto ctx = gl::context();
-		mVao = ctx->getDefaultVao();
-		mVbo = ctx->getDefaultArrayVbo();
-		mOwnsBuffers = false;
-	}
-	else
-		mOwnsBuffers = true;
+	mOwnsBuffers = ! useContextDefaultBuffers;
 }
 
 VertBatchRef VertBatch::create( GLenum primType, bool useContextDefaultBuffers )
@@ -339,115 +332,132 @@ void VertBatch::clear()
 	mColors.clear();
 	mTexCoords.clear();
 	mVbo.reset();
-	mVao.reset();
 }
 
 void VertBatch::draw()
 {
-	// this pushes the VAO, which needs to be popped
-	setupBuffers();
-	ScopedVao vao( mVao );
-	
 	auto ctx = context();
-	ctx->setDefaultShaderVars();
-	ctx->drawArrays( mPrimType, 0, mVertices.size() );
-	
-	// this was set by setupBuffers
-	ctx->popVao();
-}
 
-// Leaves mVAO bound
-void VertBatch::setupBuffers()
-{
-	auto ctx = gl::context();
-	
 	GlslProgRef glslProg = ctx->getGlslProg();
-	if( ! glslProg )
+	if( ! glslProg || mVertices.empty() )
 		return;
 
-	const size_t verticesSizeBytes = mVertices.size() * sizeof(Vec4f);
-	const size_t normalsSizeBytes = mNormals.size() * sizeof(Vec3f);
-	const size_t colorsSizeBytes = mColors.size() * sizeof(ColorAf);
-	const size_t texCoordsSizeBytes = mTexCoords.size() * sizeof(Vec4f);
-	size_t totalSizeBytes = verticesSizeBytes + normalsSizeBytes + colorsSizeBytes + texCoordsSizeBytes;
+	const size_t sizeBytes = getStride() * mVertices.size();
+	if( ! mOwnsBuffers ) {
+		// write the interleaved vertices straight into the context's streaming buffer and point the default VAO at them
+		size_t offset;
+		writeInterleaved( reinterpret_cast<uint8_t*>( ctx->streamArrayBegin( sizeBytes, &offset ) ) );
+		ctx->streamArrayEnd();
+
+		ctx->pushVao();
+		ctx->getDefaultVao()->replacementBindBegin();
+		setupAttribs( ctx, glslProg, ctx->getStreamArrayVbo(), offset );
+		ctx->getDefaultVao()->replacementBindEnd();
+		ctx->setDefaultShaderVars();
+		ctx->drawArrays( mPrimType, 0, mVertices.size() );
+		ctx->popVao();
+		return;
+	}
 
-	// allocate the VBO if we don't have one yet (which implies we're not using the context defaults)
-	bool forceUpload = false;
+	// upload once; clear() releases the VBO so that the next batch is uploaded anew
 	if( ! mVbo ) {
-		// allocate the VBO and upload the data
-		mVbo = gl::Vbo::create( GL_ARRAY_BUFFER, totalSizeBytes );
-		forceUpload = true;
+		std::vector<uint8_t> interleaved( sizeBytes );
+		writeInterleaved( interleaved.data() );
+		mVbo = Vbo::create( GL_ARRAY_BUFFER, sizeBytes, interleaved.data(), GL_STATIC_DRAW );
+		mVao.reset();
 	}
-	
-	ScopedBuffer ScopedBuffer( mVbo );
-	// if this VBO was freshly made, or we don't own the buffer because we use the context defaults
-	if( forceUpload || ( ! mOwnsBuffers ) ) {
-		mVbo->ensureMinimumSize( totalSizeBytes );
-		
-		// upload positions
-		GLintptr offset = 0;
-		mVbo->bufferSubData( offset, verticesSizeBytes, &mVertices[0] );
-		offset += verticesSizeBytes;
-		
-		// upload normals
-		if( ! mNormals.empty() ) {
-			mVbo->bufferSubData( offset, normalsSizeBytes, &mNormals[0] );
-			offset += normalsSizeBytes;
-		}
 
-		// upload colors
-		if( ! mColors.empty() ) {
-			mVbo->bufferSubData( offset, colorsSizeBytes, &mColors[0] );
-			offset += colorsSizeBytes;
-		}
+	// the attribute locations belong to the GlslProg, so the VAO is only rebuilt when it changes
+	if( ! mVao || mVaoGlslProg != glslProg ) {
+		mVao = Vao::create();
+		mVaoGlslProg = glslProg;
+		ScopedVao vaoScp( mVao );
+		setupAttribs( ctx, glslProg, mVbo, 0 );
+	}
+
+	ScopedVao vaoScp( mVao );
+	ctx->setDefaultShaderVars();
+	ctx->drawArrays( mPrimType, 0, mVertices.size() );
+}
 
-		// upload texCoords
-		if( ! mTexCoords.empty() ) {
-			mVbo->bufferSubData( offset, texCoordsSizeBytes, &mTexCoords[0] );
-			offset += texCoordsSizeBytes;
+size_t VertBatch::getStride() const
+{
+	size_t result = sizeof(Vec4f);
+	if( ! mNormals.empty() )
+		result += sizeof(Vec3f);
+	if( ! mColors.empty() )
+		result += sizeof(ColorAf);
+	if( ! mTexCoords.empty() )
+		result += sizeof(Vec4f);
+	return result;
+}
+
+namespace {
+// attributes supplied after the last vertex() leave their arrays short; repeat the last value as addVertex() would
+template<typename T>
+const T& attribAt( const std::vector<T> &v, size_t i )
+{
+	return ( i < v.size() ) ? v[i] : v.back();
+}
+} // anonymous namespace
+
+void VertBatch::writeInterleaved( uint8_t *dest ) const
+{
+	const bool hasNormals = ! mNormals.empty(), hasColors = ! mColors.empty(), hasTexCoords = ! mTexCoords.empty();
+	for( size_t v = 0; v < mVertices.size(); ++v ) {
+		memcpy( dest, &mVertices[v], sizeof(Vec4f) );
+		dest += sizeof(Vec4f);
+		if( hasNormals ) {
+			memcpy( dest, &attribAt( mNormals, v ), sizeof(Vec3f) );
+			dest += sizeof(Vec3f);
+		}
+		if( hasColors ) {
+			memcpy( dest, &attribAt( mColors, v ), sizeof(ColorAf) );
+			dest += sizeof(ColorAf);
+		}
+		if( hasTexCoords ) {
+			memcpy( dest, &attribAt( mTexCoords, v ), sizeof(Vec4f) );
+			dest += sizeof(Vec4f);
 		}
 	}
+}
 
-	// Setup the VAO
-	ctx->pushVao();
-	if( ! mOwnsBuffers )
-		mVao->replacementBindBegin();
-	else {
-		mVao = gl::Vao::create();
-		mVao->bind();
-	}
+void VertBatch::setupAttribs( Context *ctx, const GlslProgRef &glslProg, const VboRef &vbo, size_t offset ) const
+{
+	const GLsizei stride = (GLsizei)getStride();
+	ScopedBuffer bufferScp( vbo );
 
-	gl::ScopedBuffer vboScope( mVbo );
-	size_t offset = 0;
+	// offsets follow the interleaved layout regardless of which attributes the GlslProg consumes
 	if( glslProg->hasAttribSemantic( geom::Attrib::POSITION ) ) {
 		int loc = glslProg->getAttribSemanticLocation( geom::Attrib::POSITION );
 		ctx->enableVertexAttribArray( loc );
-		ctx->vertexAttribPointer( loc, 4, GL_FLOAT, false, 0, (const GLvoid*)offset );
-		offset += verticesSizeBytes;
+		ctx->vertexAttribPointer( loc, 4, GL_FLOAT, false, stride, (const GLvoid*)offset );
 	}
+	offset += sizeof(Vec4f);
 
-	if( glslProg->hasAttribSemantic( geom::Attrib::NORMAL ) && ( ! mNormals.empty() ) ) {
-		int loc = glslProg->getAttribSemanticLocation( geom::Attrib::NORMAL );
-		ctx->enableVertexAttribArray( loc );
-		ctx->vertexAttribPointer( loc, 3, GL_FLOAT, false, 0, (const GLvoid*)offset );
-		offset += normalsSizeBytes;
+	if( ! mNormals.empty() ) {
+		if( glslProg->hasAttribSemantic( geom::Attrib::NORMAL ) ) {
+			int loc = glslProg->getAttribSemanticLocation( geom::Attrib::NORMAL );
+			ctx->enableVertexAttribArray( loc );
+			ctx->vertexAttribPointer( loc, 3, GL_FLOAT, false, stride, (const GLvoid*)offset );
+		}
+		offset += sizeof(Vec3f);
 	}
 
-	if( glslProg->hasAttribSemantic( geom::Attrib::COLOR ) && ( ! mColors.empty() ) ) {
-		int loc = glslProg->getAttribSemanticLocation( geom::Attrib::COLOR );
-		ctx->enableVertexAttribArray( loc );
-		ctx->vertexAttribPointer( loc, 4, GL_FLOAT, false, 0, (const GLvoid*)offset );
-		offset += colorsSizeBytes;
+	if( ! mColors.empty() ) {
+		if( glslProg->hasAttribSemantic( geom::Attrib::COLOR ) ) {
+			int loc = glslProg->getAttribSemanticLocation( geom::Attrib::COLOR );
+			ctx->enableVertexAttribArray( loc );
+			ctx->vertexAttribPointer( loc, 4, GL_FLOAT, false, stride, (const GLvoid*)offset );
+		}
+		offset += sizeof(ColorAf);
 	}
 
-	if( glslProg->hasAttribSemantic( geom::Attrib::TEX_COORD_0 ) && ( ! mTexCoords.empty() ) ) {
+	if( ! mTexCoords.empty() && glslProg->hasAttribSemantic( geom::Attrib::TEX_COORD_0 ) ) {
 		int loc = glslProg->getAttribSemanticLocation( geom::Attrib::TEX_COORD_0 );
 		ctx->enableVertexAttribArray( loc );
-		ctx->vertexAttribPointer( loc, 4, GL_FLOAT, false, 0, (const GLvoid*)offset );
+		ctx->vertexAttribPointer( loc, 4, GL_FLOAT, false, stride, (const GLvoid*)offset );
 	}
-	
-	if( ! mOwnsBuffers )
-		mVao->replacementBindEnd();
 }
 
 } } // namespace cinder::gl
\ No newline at end of file
@@ -89,6 +89,13 @@ void BufferObj::getBufferSubData( GLintptr offset, GLsizeiptr size, GLvoid *data
 	ScopedBuffer bufferBind( mTarget, mId );
 	glGetBufferSubData( mTarget, offset, size, data );
 }
+
+void BufferObj::bufferStorage( GLsizeiptr size, const GLvoid *data, GLbitfield flags )
+{
+	ScopedBuffer bufferBind( mTarget, mId );
+	mSize = size;
+	glBufferStorage( mTarget, mSize, data, flags );
+}
 #endif
 
 void BufferObj::copyData( GLsizeiptr size, const GLvoid *data )
@@ -31,6 +31,9 @@
 #include "cinder/gl/Fbo.h"
 #include "cinder/gl/Batch.h"
 #include "cinder/gl/ConstantStrings.h"
+#if ! defined( CINDER_GL_ES )
+#include "cinder/gl/Sync.h"
+#endif
 #include "cinder/Log.h"
 #include "cinder/Utilities.h"
 
@@ -90,13 +93,19 @@ Context::Context( const std::shared_ptr<PlatformData> &platformData )
 	mFramebufferStack.push_back( 0 );
 #endif
 	mDefaultArrayVboIdx = 0;
+	mStreamArrayOffset = mStreamArrayReservedOffset = mStreamArrayReservedSize = 0;
+	mStreamArrayMapped = NULL;
+#if ! defined( CINDER_GL_ES )
+	mStreamArraySegment = 0;
+	mProgramBinarySupported = -1;
+#endif
 
 	// initial state for depth mask is enabled
 	mBoolStateStack[GL_DEPTH_WRITEMASK] = vector<GLboolean>();
 	mBoolStateStack[GL_DEPTH_WRITEMASK].push_back( GL_TRUE );
 	mActiveTextureStack.push_back( 0 );
 
-	mImmediateMode = gl::VertBatch::create();
+	mImmediateMode = gl::VertBatch::create( GL_POINTS, true ); // refilled every gl::begin(), so streamed rather than uploaded
 	
 	GLint params[4];
 	glGetIntegerv( GL_VIEWPORT, params );
@@ -216,7 +225,7 @@ void Context::reflectCurrent( Context *context )
 void Context::bindVao( const VaoRef &vao )
 {
 	VaoRef prevVao = getVao();
-	if( setStackState( mVaoStack, vao ) ) {
+	if( mStats.count( ContextStats::VAO, setStackState( mVaoStack, vao ) ) ) {
 		if( prevVao )
 			prevVao->unbindImpl( this );
 		if( vao )
@@ -227,7 +236,7 @@ void Context::bindVao( const VaoRef &vao )
 void Context::pushVao( const VaoRef &vao )
 {
 	VaoRef prevVao = getVao();
-	if( pushStackState( mVaoStack, vao ) ) {
+	if( mStats.count( ContextStats::VAO, pushStackState( mVaoStack, vao ) ) ) {
 		if( prevVao )
 			prevVao->unbindImpl( this );
 		if( vao )
@@ -247,7 +256,7 @@ void Context::popVao()
 	if( ! mVaoStack.empty() ) {
 		mVaoStack.pop_back();
 		if( ! mVaoStack.empty() ) {
-			if( prevVao != mVaoStack.back() ) {
+			if( mStats.count( ContextStats::VAO, prevVao != mVaoStack.back() ) ) {
 				if( prevVao )
 					prevVao->unbindImpl( this );
 				if( mVaoStack.back() )
@@ -296,13 +305,13 @@ void Context::vaoDeleted( const Vao *vao )
 // Viewport
 void Context::viewport( const std::pair<Vec2i, Vec2i> &viewport )
 {
-	if( setStackState( mViewportStack, viewport ) )
+	if( mStats.count( ContextStats::VIEWPORT, setStackState( mViewportStack, viewport ) ) )
 		glViewport( viewport.first.x, viewport.first.y, viewport.second.x, viewport.second.y );
 }
 
 void Context::pushViewport( const std::pair<Vec2i, Vec2i> &viewport )
 {
-	if( pushStackState( mViewportStack, viewport ) )
+	if( mStats.count( ContextStats::VIEWPORT, pushStackState( mViewportStack, viewport ) ) )
 		glViewport( viewport.first.x, viewport.first.y, viewport.second.x, viewport.second.y );
 }
 
@@ -313,7 +322,7 @@ void Context::pushViewport()
 
 void Context::popViewport()
 {
-	if( mViewportStack.empty() || popStackState( mViewportStack ) ) {
+	if( mStats.count( ContextStats::VIEWPORT, mViewportStack.empty() || popStackState( mViewportStack ) ) ) {
 		auto viewport = getViewport();
 		glViewport( viewport.first.x, viewport.first.y, viewport.second.x, viewport.second.y );
 	}
@@ -336,13 +345,13 @@ std::pair<Vec2i, Vec2i> Context::getViewport()
 // Scissor Test
 void Context::setScissor( const std::pair<Vec2i, Vec2i> &scissor )
 {
-	if( setStackState( mScissorStack, scissor ) )
+	if( mStats.count( ContextStats::SCISSOR, setStackState( mScissorStack, scissor ) ) )
 		glScissor( scissor.first.x, scissor.first.y, scissor.second.x, scissor.second.y );
 }
 
 void Context::pushScissor( const std::pair<Vec2i, Vec2i> &scissor )
 {
-	if( pushStackState( mScissorStack, scissor ) )
+	if( mStats.count( ContextStats::SCISSOR, pushStackState( mScissorStack, scissor ) ) )
 		glScissor( scissor.first.x, scissor.first.y, scissor.second.x, scissor.second.y );
 }
 
@@ -354,7 +363,7 @@ void Context::pushScissor()
 //! Sets the active texture unit; expects values relative to \c 0, \em not GL_TEXTURE0
 void Context::popScissor()
 {
-	if( mScissorStack.empty() || popStackState( mScissorStack ) ) {
+	if( mStats.count( ContextStats::SCISSOR, mScissorStack.empty() || popStackState( mScissorStack ) ) ) {
 		auto scissor = getScissor();
 		glScissor( scissor.first.x, scissor.first.y, scissor.second.x, scissor.second.y );
 	}
@@ -378,7 +387,7 @@ std::pair<Vec2i, Vec2i> Context::getScissor()
 void Context::bindBuffer( GLenum target, GLuint id )
 {
 	GLuint prevValue = getBufferBinding( target );
-	if( prevValue != id ) {
+	if( mStats.count( ContextStats::BUFFER_BINDING, prevValue != id ) ) {
 		mBufferBindingStack[target].back() = id;
 		if( target == GL_ARRAY_BUFFER || target == GL_ELEMENT_ARRAY_BUFFER ) {
 			VaoRef vao = getVao();
@@ -409,7 +418,7 @@ void Context::popBufferBinding( GLenum target )
 	GLuint prevValue = getBufferBinding( target );
 	auto cachedIt = mBufferBindingStack.find( target );
 	cachedIt->second.pop_back();
-	if( ! cachedIt->second.empty() && cachedIt->second.back() != prevValue ) {
+	if( ! cachedIt->second.empty() && mStats.count( ContextStats::BUFFER_BINDING, cachedIt->second.back() != prevValue ) ) {
 		if( target == GL_ARRAY_BUFFER || target == GL_ELEMENT_ARRAY_BUFFER ) {
 			VaoRef vao = getVao();
 			if( vao )
@@ -595,7 +604,7 @@ void Context::pushGlslProg( const GlslProgRef &prog )
 	GlslProgRef prevGlsl = getGlslProg();
 
 	mGlslProgStack.push_back( prog );
-	if( prog != prevGlsl ) {
+	if( mStats.count( ContextStats::GLSL_PROG, prog != prevGlsl ) ) {
 		if( prog )
 			prog->bindImpl();
 		else
@@ -615,7 +624,7 @@ void Context::popGlslProg()
 	if( ! mGlslProgStack.empty() ) {
 		mGlslProgStack.pop_back();
 		if( ! mGlslProgStack.empty() ) {
-			if( prevGlsl != mGlslProgStack.back() ) {
+			if( mStats.count( ContextStats::GLSL_PROG, prevGlsl != mGlslProgStack.back() ) ) {
 				if( mGlslProgStack.back() )
 					mGlslProgStack.back()->bindImpl();
 				else
@@ -627,7 +636,7 @@ void Context::popGlslProg()
 
 void Context::bindGlslProg( const GlslProgRef &prog )
 {
-	if( mGlslProgStack.empty() || (mGlslProgStack.back() != prog) ) {
+	if( mStats.count( ContextStats::GLSL_PROG, mGlslProgStack.empty() || (mGlslProgStack.back() != prog) ) ) {
 		if( ! mGlslProgStack.empty() )
 			mGlslProgStack.back() = prog;
 		if( prog )
@@ -670,7 +679,7 @@ void Context::bindTexture( GLenum target, GLuint textureId, uint8_t textureUnit
 		mTextureBindingStack[textureUnit] = std::map<GLenum,std::vector<GLint>>();
 
 	GLuint prevValue = getTextureBinding( target, textureUnit );
-	if( prevValue != textureId ) {
+	if( mStats.count( ContextStats::TEXTURE_BINDING, prevValue != textureId ) ) {
 		mTextureBindingStack[textureUnit][target].back() = textureId;
 		ScopedActiveTexture actScp( textureUnit );
 		glBindTexture( target, textureId );
@@ -719,7 +728,7 @@ void Context::popTextureBinding( GLenum target, uint8_t textureUnit )
 		GLint prevValue = cached->second.back();
 		cached->second.pop_back();
 		if( ! cached->second.empty() ) {
-			if( cached->second.back() != prevValue ) {
+			if( mStats.count( ContextStats::TEXTURE_BINDING, cached->second.back() != prevValue ) ) {
 				ScopedActiveTexture actScp( textureUnit );
 				glBindTexture( target, cached->second.back() );
 		}
@@ -784,13 +793,13 @@ void Context::textureDeleted( const TextureBase *texture )
 // ActiveTexture
 void Context::setActiveTexture( uint8_t textureUnit )
 {
-	if( setStackState<uint8_t>( mActiveTextureStack, textureUnit ) )
+	if( mStats.count( ContextStats::ACTIVE_TEXTURE, setStackState<uint8_t>( mActiveTextureStack, textureUnit ) ) )
 		glActiveTexture( GL_TEXTURE0 + textureUnit );
 }
 
 void Context::pushActiveTexture( uint8_t textureUnit )
 {
-	if( pushStackState<uint8_t>( mActiveTextureStack, textureUnit ) )
+	if( mStats.count( ContextStats::ACTIVE_TEXTURE, pushStackState<uint8_t>( mActiveTextureStack, textureUnit ) ) )
 		glActiveTexture( GL_TEXTURE0 + textureUnit );
 }
 
@@ -802,7 +811,7 @@ void Context::pushActiveTexture()
 //! Sets the active texture unit; expects values relative to \c 0, \em not GL_TEXTURE0
 void Context::popActiveTexture()
 {
-	if( mActiveTextureStack.empty() || popStackState<uint8_t>( mActiveTextureStack ) )
+	if( mStats.count( ContextStats::ACTIVE_TEXTURE, mActiveTextureStack.empty() || popStackState<uint8_t>( mActiveTextureStack ) ) )
 		glActiveTexture( GL_TEXTURE0 + getActiveTexture() );
 }
 
@@ -825,7 +834,7 @@ void Context::bindFramebuffer( GLenum target, GLuint framebuffer )
 {
 #if ! defined( SUPPORTS_FBO_MULTISAMPLING )
 	if( target == GL_FRAMEBUFFER ) {
-		if( setStackState<GLint>( mFramebufferStack, framebuffer ) )
+		if( mStats.count( ContextStats::FRAMEBUFFER, setStackState<GLint>( mFramebufferStack, framebuffer ) ) )
 			glBindFramebuffer( target, framebuffer );
 	}
 	else {
@@ -835,15 +844,15 @@ void Context::bindFramebuffer( GLenum target, GLuint framebuffer )
 	if( target == GL_FRAMEBUFFER ) {
 		bool readRequiresBind = setStackState<GLint>( mReadFramebufferStack, framebuffer );
 		bool drawRequiresBind = setStackState<GLint>( mDrawFramebufferStack, framebuffer );
-		if( readRequiresBind || drawRequiresBind )
+		if( mStats.count( ContextStats::FRAMEBUFFER, readRequiresBind || drawRequiresBind ) )
 			glBindFramebuffer( GL_FRAMEBUFFER, framebuffer );
 	}
 	else if( target == GL_READ_FRAMEBUFFER ) {
-		if( setStackState<GLint>( mReadFramebufferStack, framebuffer ) )
+		if( mStats.count( ContextStats::FRAMEBUFFER, setStackState<GLint>( mReadFramebufferStack, framebuffer ) ) )
 			glBindFramebuffer( target, framebuffer );
 	}
 	else if( target == GL_DRAW_FRAMEBUFFER ) {
-		if( setStackState<GLint>( mDrawFramebufferStack, framebuffer ) )
+		if( mStats.count( ContextStats::FRAMEBUFFER, setStackState<GLint>( mDrawFramebufferStack, framebuffer ) ) )
 			glBindFramebuffer( target, framebuffer );		
 	}
 	else {
@@ -872,15 +881,15 @@ void Context::pushFramebuffer( const FboRef &fbo, GLenum target )
 void Context::pushFramebuffer( GLenum target, GLuint framebuffer )
 {
 #if ! defined( SUPPORTS_FBO_MULTISAMPLING )
-	if( pushStackState<GLint>( mFramebufferStack, framebuffer ) )
+	if( mStats.count( ContextStats::FRAMEBUFFER, pushStackState<GLint>( mFramebufferStack, framebuffer ) ) )
 		glBindFramebuffer( target, framebuffer );
 #else
 	if( target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER ) {
-		if( pushStackState<GLint>( mReadFramebufferStack, framebuffer ) )
+		if( mStats.count( ContextStats::FRAMEBUFFER, pushStackState<GLint>( mReadFramebufferStack, framebuffer ) ) )
 			glBindFramebuffer( GL_READ_FRAMEBUFFER, framebuffer );
 	}
 	if( target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER ) {
-		if( pushStackState<GLint>( mDrawFramebufferStack, framebuffer ) )
+		if( mStats.count( ContextStats::FRAMEBUFFER, pushStackState<GLint>( mDrawFramebufferStack, framebuffer ) ) )
 			glBindFramebuffer( GL_DRAW_FRAMEBUFFER, framebuffer );	
 	}
 #endif
@@ -903,19 +912,16 @@ void Context::pushFramebuffer( GLenum target )
 void Context::popFramebuffer( GLenum target )
 {
 #if ! defined( SUPPORTS_FBO_MULTISAMPLING )
-	if( popStackState<GLint>( mFramebufferStack ) )
-		if( ! mFramebufferStack.empty() )
-			glBindFramebuffer( target, mFramebufferStack.back() );
+	if( mStats.count( ContextStats::FRAMEBUFFER, popStackState<GLint>( mFramebufferStack ) && ( ! mFramebufferStack.empty() ) ) )
+		glBindFramebuffer( target, mFramebufferStack.back() );
 #else
 	if( target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER ) {
-		if( popStackState<GLint>( mReadFramebufferStack ) )
-			if( ! mReadFramebufferStack.empty() )
-				glBindFramebuffer( target, mReadFramebufferStack.back() );
+		if( mStats.count( ContextStats::FRAMEBUFFER, popStackState<GLint>( mReadFramebufferStack ) && ( ! mReadFramebufferStack.empty() ) ) )
+			glBindFramebuffer( target, mReadFramebufferStack.back() );
 	}
 	if( target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER ) {
-		if( popStackState<GLint>( mDrawFramebufferStack ) )
-			if( ! mDrawFramebufferStack.empty() )
-				glBindFramebuffer( target, mDrawFramebufferStack.back() );
+		if( mStats.count( ContextStats::FRAMEBUFFER, popStackState<GLint>( mDrawFramebufferStack ) && ( ! mDrawFramebufferStack.empty() ) ) )
+			glBindFramebuffer( target, mDrawFramebufferStack.back() );
 	}
 #endif
 }
@@ -985,7 +991,7 @@ void Context::setBoolState( GLenum cap, GLboolean value )
 	}
 	else
 		mBoolStateStack[cap].back() = value;
-	if( needsToBeSet ) {
+	if( mStats.count( ContextStats::BOOL_STATE, needsToBeSet ) ) {
 		if( value )
 			glEnable( cap );
 		else
@@ -1005,7 +1011,7 @@ void Context::setBoolState( GLenum cap, GLboolean value, const std::function<voi
 	}
 	else
 		mBoolStateStack[cap].back() = value;
-	if( needsToBeSet )
+	if( mStats.count( ContextStats::BOOL_STATE, needsToBeSet ) )
 		setter( value );
 }
 
@@ -1020,7 +1026,7 @@ void Context::pushBoolState( GLenum cap, GLboolean value )
 		mBoolStateStack[cap].push_back( glIsEnabled( cap ) );
 	}
 	mBoolStateStack[cap].push_back( value );
-	if( needsToBeSet ) {
+	if( mStats.count( ContextStats::BOOL_STATE, needsToBeSet ) ) {
 		if( value )
 			glEnable( cap );
 		else
@@ -1041,7 +1047,7 @@ void Context::popBoolState( GLenum cap )
 		GLboolean prevValue = cached->second.back();
 		cached->second.pop_back();
 		if( ! cached->second.empty() ) {
-			if( cached->second.back() != prevValue ) {
+			if( mStats.count( ContextStats::BOOL_STATE, cached->second.back() != prevValue ) ) {
 				if( cached->second.back() )
 					glEnable( cap );
 				else
@@ -1085,7 +1091,7 @@ void Context::blendFuncSeparate( GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha,
 	needsChange = setStackState<GLint>( mBlendDstRgbStack, dstRGB ) || needsChange;
 	needsChange = setStackState<GLint>( mBlendSrcAlphaStack, srcAlpha ) || needsChange;
 	needsChange = setStackState<GLint>( mBlendDstAlphaStack, dstAlpha ) || needsChange;
-	if( needsChange )
+	if( mStats.count( ContextStats::BLEND_FUNC, needsChange ) )
 		glBlendFuncSeparate( srcRGB, dstRGB, srcAlpha, dstAlpha );
 }
 
@@ -1095,7 +1101,7 @@ void Context::pushBlendFuncSeparate( GLenum srcRGB, GLenum dstRGB, GLenum srcAlp
 	needsChange = pushStackState<GLint>( mBlendDstRgbStack, dstRGB ) || needsChange;
 	needsChange = pushStackState<GLint>( mBlendSrcAlphaStack, srcAlpha ) || needsChange;
 	needsChange = pushStackState<GLint>( mBlendDstAlphaStack, dstAlpha ) || needsChange;
-	if( needsChange )
+	if( mStats.count( ContextStats::BLEND_FUNC, needsChange ) )
 		glBlendFuncSeparate( srcRGB, dstRGB, srcAlpha, dstAlpha );
 }
 
@@ -1116,7 +1122,8 @@ void Context::popBlendFuncSeparate()
 	needsChange = popStackState<GLint>( mBlendDstRgbStack ) || needsChange;
 	needsChange = popStackState<GLint>( mBlendSrcAlphaStack ) || needsChange;
 	needsChange = popStackState<GLint>( mBlendDstAlphaStack ) || needsChange;
-	if( needsChange && ( ! mBlendSrcRgbStack.empty() ) && ( ! mBlendSrcAlphaStack.empty() ) && ( ! mBlendDstRgbStack.empty() ) && ( ! mBlendDstAlphaStack.empty() ) )
+	needsChange = needsChange && ( ! mBlendSrcRgbStack.empty() ) && ( ! mBlendSrcAlphaStack.empty() ) && ( ! mBlendDstRgbStack.empty() ) && ( ! mBlendDstAlphaStack.empty() );
+	if( mStats.count( ContextStats::BLEND_FUNC, needsChange ) )
 		glBlendFuncSeparate( mBlendSrcRgbStack.back(), mBlendDstRgbStack.back(), mBlendSrcAlphaStack.back(), mBlendDstAlphaStack.back() );
 }
 
@@ -1392,24 +1399,38 @@ void Context::vertexAttrib4f( GLuint index, float v0, float v1, float v2, float
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 // draw*
+void Context::flushGlslProgUniforms()
+{
+	if( ! mGlslProgStack.empty() && mGlslProgStack.back() )
+		mGlslProgStack.back()->flushUniforms();
+}
+
 void Context::drawArrays( GLenum mode, GLint first, GLsizei count )
 {
+	flushGlslProgUniforms();
+	++mStats.mNumDrawCalls;
 	glDrawArrays( mode, first, count );
 }
 
 void Context::drawElements( GLenum mode, GLsizei count, GLenum type, const GLvoid *indices )
 {
+	flushGlslProgUniforms();
+	++mStats.mNumDrawCalls;
 	glDrawElements( mode, count, type, indices );
 }
 
 #if ! defined( CINDER_GL_ES )
 void Context::drawArraysInstanced( GLenum mode, GLint first, GLsizei count, GLsizei primcount )
 {
+	flushGlslProgUniforms();
+	++mStats.mNumDrawCalls;
 	glDrawArraysInstanced( mode, first, count, primcount );
 }
 
 void Context::drawElementsInstanced( GLenum mode, GLsizei count, GLenum type, const GLvoid *indices, GLsizei primcount )
 {
+	flushGlslProgUniforms();
+	++mStats.mNumDrawCalls;
 	glDrawElementsInstanced( mode, count, type, indices, primcount );
 }
 #endif // ! defined( CINDER_GL_ES )
@@ -1428,12 +1449,81 @@ GlslProgRef	Context::getStockShader( const ShaderDef &shaderDef )
 		return existing->second;
 }
 
+std::vector<ShaderDef> Context::getCommonStockShaderDefs()
+{
+	std::vector<ShaderDef> result;
+	result.push_back( ShaderDef() );
+	result.push_back( ShaderDef().color() );
+	result.push_back( ShaderDef().texture() );
+	result.push_back( ShaderDef().texture().color() );
+#if ! defined( CINDER_GL_ES )
+	result.push_back( ShaderDef().texture( GL_TEXTURE_RECTANGLE_ARB ) );
+	result.push_back( ShaderDef().texture( GL_TEXTURE_RECTANGLE_ARB ).color() );
+#endif
+	result.push_back( ShaderDef().uniformBasedPosAndTexCoord().texture() );
+	result.push_back( ShaderDef().uniformBasedPosAndTexCoord().color().texture() );
+
+	return result;
+}
+
+void Context::preloadStockShaders()
+{
+	for( const auto &shaderDef : getCommonStockShaderDefs() )
+		getStockShader( shaderDef );
+}
+
+#if ! defined( CINDER_GL_ES )
+std::thread Context::warmStockShaderCacheAsync()
+{
+	if( GlslProg::getBinaryCacheDirectory().empty() )
+		CI_LOG_W( "No binary cache directory set; warming stock shaders will have no effect" );
+
+	// the default semantic maps are filled in on first use, which isn't safe from two threads at once
+	GlslProg::getDefaultUniformNameToSemanticMap();
+	GlslProg::getDefaultAttribNameToSemanticMap();
+
+	// creating the shared Context restores the platform's current context but not ours
+	ContextRef sharedContext = Context::create( this );
+	Context::reflectCurrent( this );
+
+	std::vector<ShaderDef> shaderDefs = getCommonStockShaderDefs();
+	return std::thread( [sharedContext, shaderDefs] {
+		sharedContext->makeCurrent();
+		for( const auto &shaderDef : shaderDefs ) {
+			try {
+				gl::env()->buildShader( shaderDef );
+			}
+			catch( std::exception &exc ) {
+				CI_LOG_E( "Failed to warm stock shader: " << exc.what() );
+			}
+		}
+		// the GlslProgs are gone by now; only the cached binaries remain
+		::glFlush();
+	} );
+}
+
+bool Context::isProgramBinarySupported()
+{
+	if( mProgramBinarySupported < 0 ) {
+		mProgramBinarySupported = 0;
+		if( gl::getVersion() >= std::make_pair( (GLint)4, (GLint)1 ) || gl::isExtensionAvailable( "GL_ARB_get_program_binary" ) ) {
+			// drivers may expose the entry points while supporting no formats at all
+			GLint numFormats = 0;
+			glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats );
+			mProgramBinarySupported = ( numFormats > 0 ) ? 1 : 0;
+		}
+	}
+
+	return mProgramBinarySupported != 0;
+}
+#endif // ! defined( CINDER_GL_ES )
+
 void Context::setDefaultShaderVars()
 {
 	const auto &ctx = gl::context();
 	const auto &glslProg = ctx->getGlslProg();
 	if( glslProg ) {
-		const auto &uniforms = glslProg->getUniformSemantics();
+		const auto &uniforms = glslProg->getUniformSemanticLocations();
 		for( const auto &unifIt : uniforms ) {
 			switch( unifIt.second ) {
 				case UNIFORM_MODEL_MATRIX:
@@ -1484,6 +1574,8 @@ void Context::setDefaultShaderVars()
 					;
 			}
 		}
+
+		glslProg->flushUniforms();
 	}
 }
 
@@ -1567,6 +1659,186 @@ VboRef Context::getDefaultElementVbo( size_t requiredSize )
 	
 	return mDefaultElementVbo;
 }
+///////////////////////////////////////////////////////////////////////////////////////////
+// ContextStats
+void ContextStats::reset()
+{
+	for( int s = 0; s < NUM_STATES; ++s )
+		mNumIssued[s] = mNumRedundant[s] = 0;
+	mNumDrawCalls = 0;
+}
+
+uint32_t ContextStats::getTotalIssued() const
+{
+	uint32_t result = 0;
+	for( int s = 0; s < NUM_STATES; ++s )
+		result += mNumIssued[s];
+	return result;
+}
+
+uint32_t ContextStats::getTotalRedundant() const
+{
+	uint32_t result = 0;
+	for( int s = 0; s < NUM_STATES; ++s )
+		result += mNumRedundant[s];
+	return result;
+}
+
+const char* ContextStats::stateToString( State state )
+{
+	switch( state ) {
+		case BUFFER_BINDING: return "buffer binding";
+		case TEXTURE_BINDING: return "texture binding";
+		case ACTIVE_TEXTURE: return "active texture";
+		case GLSL_PROG: return "GlslProg";
+		case VAO: return "VAO";
+		case FRAMEBUFFER: return "framebuffer";
+		case BOOL_STATE: return "bool state";
+		case BLEND_FUNC: return "blend func";
+		case VIEWPORT: return "viewport";
+		case SCISSOR: return "scissor";
+		default: return "unknown";
+	}
+}
+
+std::ostream& operator<<( std::ostream &os, const ContextStats &stats )
+{
+	os << "draw calls: " << stats.getNumDrawCalls() << ", state changes issued: " << stats.getTotalIssued() << ", redundant: " << stats.getTotalRedundant();
+	for( int s = 0; s < ContextStats::NUM_STATES; ++s ) {
+		ContextStats::State state = (ContextStats::State)s;
+		if( stats.getNumIssued( state ) || stats.getNumRedundant( state ) )
+			os << std::endl << "  " << ContextStats::stateToString( state ) << ": " << stats.getNumIssued( state ) << " issued, " << stats.getNumRedundant( state ) << " redundant";
+	}
+	return os;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// Streaming vertex buffer
+namespace {
+const size_t STREAM_ARRAY_MIN_SIZE = 1024 * 1024;
+const int STREAM_ARRAY_NUM_SEGMENTS = 4; // matches mStreamArrayFences; streamArrayReserve() keeps each region within one segment
+const size_t STREAM_ARRAY_ALIGNMENT = 16;
+
+#if ! defined( CINDER_GL_ES )
+bool isBufferStorageAvailable()
+{
+	static bool sResult = ( glBufferStorage != NULL ) && ( gl::getVersion() >= std::make_pair( (GLint)4, (GLint)4 ) || gl::isExtensionAvailable( "GL_ARB_buffer_storage" ) );
+	return sResult;
+}
+#endif
+} // anonymous namespace
+
+void Context::allocateStreamArrayVbo( size_t minSegmentSize )
+{
+	size_t size = mStreamArrayVbo ? (size_t)mStreamArrayVbo->getSize() : STREAM_ARRAY_MIN_SIZE;
+	while( size < minSegmentSize * STREAM_ARRAY_NUM_SEGMENTS )
+		size *= 2;
+
+	mStreamArrayVbo = Vbo::create( GL_ARRAY_BUFFER );
+	mStreamArrayOffset = 0;
+	mStreamArrayMapped = NULL;
+#if ! defined( CINDER_GL_ES )
+	for( int s = 0; s < STREAM_ARRAY_NUM_SEGMENTS; ++s )
+		mStreamArrayFences[s].reset();
+	mStreamArraySegment = 0;
+
+	// Where immutable storage is available the buffer is mapped once and written in place, synchronizing with fences per segment
+	if( isBufferStorageAvailable() ) {
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		mStreamArrayVbo->bufferStorage( size, NULL, flags );
+		mStreamArrayMapped = reinterpret_cast<uint8_t*>( mStreamArrayVbo->mapBufferRange( 0, size, flags ) );
+		if( mStreamArrayMapped )
+			return;
+		mStreamArrayVbo = Vbo::create( GL_ARRAY_BUFFER ); // immutable storage can't be respecified below
+	}
+#endif
+	// Otherwise regions are written with bufferSubData() and the storage is orphaned each time the buffer wraps around
+	mStreamArrayVbo->bufferData( size, NULL, GL_STREAM_DRAW );
+}
+
+#if ! defined( CINDER_GL_ES )
+void Context::enterStreamArraySegment( int segment )
+{
+	mStreamArrayFences[mStreamArraySegment] = Sync::create();
+
+	SyncRef &fence = mStreamArrayFences[segment];
+	if( fence ) {
+		while( fence->clientWaitSync( GL_SYNC_FLUSH_COMMANDS_BIT, 1000000 ) == GL_TIMEOUT_EXPIRED )
+			;
+		fence.reset();
+	}
+
+	mStreamArraySegment = segment;
+}
+#endif
+
+size_t Context::streamArrayReserve( size_t sizeBytes )
+{
+	const size_t alignedSize = ( sizeBytes + STREAM_ARRAY_ALIGNMENT - 1 ) & ~( STREAM_ARRAY_ALIGNMENT - 1 );
+	if( ! mStreamArrayVbo || alignedSize * STREAM_ARRAY_NUM_SEGMENTS > (size_t)mStreamArrayVbo->getSize() )
+		allocateStreamArrayVbo( alignedSize );
+
+	const size_t capacity = mStreamArrayVbo->getSize();
+#if ! defined( CINDER_GL_ES )
+	if( mStreamArrayMapped ) {
+		// A region which would straddle two segments starts at the next one instead. The fence on a segment is set when a region is first
+		// reserved past it, which only follows every draw sourcing the segment if none of its regions extend beyond it.
+		const size_t segmentSize = capacity / STREAM_ARRAY_NUM_SEGMENTS;
+		const size_t segmentEnd = ( mStreamArrayOffset / segmentSize + 1 ) * segmentSize;
+		if( mStreamArrayOffset + alignedSize > segmentEnd )
+			mStreamArrayOffset = segmentEnd;
+		if( mStreamArrayOffset >= capacity ) {
+			mStreamArrayOffset = 0;
+			enterStreamArraySegment( 0 );
+		}
+		while( mStreamArraySegment < int( mStreamArrayOffset / segmentSize ) )
+			enterStreamArraySegment( mStreamArraySegment + 1 );
+	}
+	else
+#endif
+	if( mStreamArrayOffset + alignedSize > capacity ) {
+		// orphan; pending draws keep sourcing from the previous storage
+		mStreamArrayOffset = 0;
+		mStreamArrayVbo->bufferData( capacity, NULL, GL_STREAM_DRAW );
+	}
+
+	size_t result = mStreamArrayOffset;
+	mStreamArrayOffset += alignedSize;
+	return result;
+}
+
+void* Context::streamArrayBegin( size_t sizeBytes, size_t *resultOffset )
+{
+	mStreamArrayReservedOffset = streamArrayReserve( sizeBytes );
+	mStreamArrayReservedSize = sizeBytes;
+	*resultOffset = mStreamArrayReservedOffset;
+
+	if( mStreamArrayMapped )
+		return mStreamArrayMapped + mStreamArrayReservedOffset;
+
+	if( mStreamArrayStaging.size() < sizeBytes )
+		mStreamArrayStaging.resize( sizeBytes );
+	return mStreamArrayStaging.data();
+}
+
+void Context::streamArrayEnd()
+{
+	if( ! mStreamArrayMapped && mStreamArrayReservedSize )
+		mStreamArrayVbo->bufferSubData( mStreamArrayReservedOffset, mStreamArrayReservedSize, mStreamArrayStaging.data() );
+	mStreamArrayReservedSize = 0;
+}
+
+size_t Context::streamArrayData( const void *data, size_t sizeBytes )
+{
+	size_t offset = streamArrayReserve( sizeBytes );
+	if( mStreamArrayMapped )
+		memcpy( mStreamArrayMapped + offset, data, sizeBytes );
+	else
+		mStreamArrayVbo->bufferSubData( offset, sizeBytes, data );
+
+	return offset;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 #if defined( CINDER_MSW ) && ! defined( CINDER_GL_ANGLE )
 namespace {
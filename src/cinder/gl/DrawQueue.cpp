@@ -0,0 +1,355 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/DrawQueue.h"
+#include "cinder/gl/Context.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/gl/Vao.h"
+#include "cinder/gl/Vbo.h"
+
+#include <algorithm>
+#include <map>
+
+namespace cinder { namespace gl {
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DrawQueue::Draw
+DrawQueue::Draw::Draw( DrawQueue *queue, const BatchRef &batch, const Matrix44f &modelMatrix )
+	: mQueue( queue ), mBatch( batch ), mModelMatrix( modelMatrix ), mNumUniforms( 0 ), mNumTextures( 0 )
+{
+	mFirstUniform = (uint32_t)queue->mUniforms.size();
+	mFirstTexture = (uint32_t)queue->mTextures.size();
+}
+
+DrawQueue::Draw& DrawQueue::Draw::addUniform( const std::string &name, GLenum type, const void *data, size_t sizeBytes )
+{
+	UniformRecord record;
+	record.mLocation = mBatch->getGlslProg()->getUniformLocation( name );
+	if( record.mLocation == -1 )
+		return *this;
+	record.mType = type;
+	record.mDataOffset = (uint32_t)mQueue->mUniformData.size();
+	record.mDataSize = (uint32_t)sizeBytes;
+
+	const uint8_t *bytes = reinterpret_cast<const uint8_t*>( data );
+	mQueue->mUniformData.insert( mQueue->mUniformData.end(), bytes, bytes + sizeBytes );
+	mQueue->mUniforms.push_back( record );
+	++mNumUniforms;
+	return *this;
+}
+
+DrawQueue::Draw& DrawQueue::Draw::uniform( const std::string &name, int data )
+{
+	return addUniform( name, GL_INT, &data, sizeof(data) );
+}
+
+DrawQueue::Draw& DrawQueue::Draw::uniform( const std::string &name, float data )
+{
+	return addUniform( name, GL_FLOAT, &data, sizeof(data) );
+}
+
+DrawQueue::Draw& DrawQueue::Draw::uniform( const std::string &name, const Vec2f &data )
+{
+	return addUniform( name, GL_FLOAT_VEC2, &data, sizeof(data) );
+}
+
+DrawQueue::Draw& DrawQueue::Draw::uniform( const std::string &name, const Vec3f &data )
+{
+	return addUniform( name, GL_FLOAT_VEC3, &data, sizeof(data) );
+}
+
+DrawQueue::Draw& DrawQueue::Draw::uniform( const std::string &name, const Vec4f &data )
+{
+	return addUniform( name, GL_FLOAT_VEC4, &data, sizeof(data) );
+}
+
+DrawQueue::Draw& DrawQueue::Draw::uniform( const std::string &name, const Color &data )
+{
+	return addUniform( name, GL_FLOAT_VEC3, &data, sizeof(data) );
+}
+
+DrawQueue::Draw& DrawQueue::Draw::uniform( const std::string &name, const ColorA &data )
+{
+	return addUniform( name, GL_FLOAT_VEC4, &data, sizeof(data) );
+}
+
+DrawQueue::Draw& DrawQueue::Draw::uniform( const std::string &name, const Matrix33f &data )
+{
+	return addUniform( name, GL_FLOAT_MAT3, &data, sizeof(data) );
+}
+
+DrawQueue::Draw& DrawQueue::Draw::uniform( const std::string &name, const Matrix44f &data )
+{
+	return addUniform( name, GL_FLOAT_MAT4, &data, sizeof(data) );
+}
+
+DrawQueue::Draw& DrawQueue::Draw::texture( const TextureRef &texture, uint8_t textureUnit )
+{
+	mQueue->mTextures.push_back( std::make_pair( textureUnit, texture ) );
+	++mNumTextures;
+	return *this;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DrawQueue
+DrawQueue::DrawQueue()
+	: mInstanceMatrixAttrib( "ciInstanceMatrix" ), mNumDrawCalls( 0 ), mNumInstancedDrawCalls( 0 ), mNumDrawCallsSaved( 0 ),
+	mNumStateChanges( 0 ), mNumStateChangesSaved( 0 )
+{
+}
+
+DrawQueue::Draw& DrawQueue::draw( const BatchRef &batch, const Matrix44f &modelMatrix )
+{
+	mDraws.push_back( Draw( this, batch, modelMatrix ) );
+	return mDraws.back();
+}
+
+void DrawQueue::clear()
+{
+	mDraws.clear();
+	mUniforms.clear();
+	mUniformData.clear();
+	mTextures.clear();
+}
+
+namespace {
+GLuint firstTextureId( const std::vector<std::pair<uint8_t,TextureRef>> &textures, uint32_t first, uint32_t count )
+{
+	return count ? textures[first].second->getId() : 0;
+}
+} // anonymous namespace
+
+size_t DrawQueue::countStateChanges( const Draw *a, const Draw &b ) const
+{
+	if( ! a )
+		return 2 + b.mNumTextures;
+
+	size_t result = 0;
+	if( a->mBatch->getGlslProg() != b.mBatch->getGlslProg() )
+		++result;
+	if( a->mBatch->getVao() != b.mBatch->getVao() )
+		++result;
+	for( uint32_t t = b.mFirstTexture; t < b.mFirstTexture + b.mNumTextures; ++t ) {
+		bool bound = false;
+		for( uint32_t s = a->mFirstTexture; s < a->mFirstTexture + a->mNumTextures && ! bound; ++s )
+			bound = mTextures[s].first == mTextures[t].first && mTextures[s].second == mTextures[t].second;
+		if( ! bound )
+			++result;
+	}
+
+	return result;
+}
+
+bool DrawQueue::isInstanceable( const Draw &a, const Draw &b ) const
+{
+	if( a.mBatch != b.mBatch || a.mNumUniforms != b.mNumUniforms || a.mNumTextures != b.mNumTextures )
+		return false;
+
+	for( uint32_t t = 0; t < a.mNumTextures; ++t )
+		if( mTextures[a.mFirstTexture + t] != mTextures[b.mFirstTexture + t] )
+			return false;
+
+	for( uint32_t u = 0; u < a.mNumUniforms; ++u ) {
+		const UniformRecord &ua = mUniforms[a.mFirstUniform + u], &ub = mUniforms[b.mFirstUniform + u];
+		if( ua.mLocation != ub.mLocation || ua.mType != ub.mType || ua.mDataSize != ub.mDataSize )
+			return false;
+		if( memcmp( &mUniformData[ua.mDataOffset], &mUniformData[ub.mDataOffset], ua.mDataSize ) != 0 )
+			return false;
+	}
+
+	return true;
+}
+
+void DrawQueue::getUniformLocations( const Draw &draw, std::vector<GLint> *result ) const
+{
+	result->clear();
+	for( uint32_t u = draw.mFirstUniform; u < draw.mFirstUniform + draw.mNumUniforms; ++u )
+		result->push_back( mUniforms[u].mLocation );
+	std::sort( result->begin(), result->end() );
+	result->erase( std::unique( result->begin(), result->end() ), result->end() );
+}
+
+void DrawQueue::applyUniforms( const Draw &draw ) const
+{
+	const GlslProgRef &glsl = draw.mBatch->getGlslProg();
+	for( uint32_t u = draw.mFirstUniform; u < draw.mFirstUniform + draw.mNumUniforms; ++u ) {
+		const UniformRecord &record = mUniforms[u];
+		const void *data = &mUniformData[record.mDataOffset];
+		switch( record.mType ) {
+			case GL_INT:			glsl->uniform( record.mLocation, *reinterpret_cast<const int*>( data ) ); break;
+			case GL_FLOAT:			glsl->uniform( record.mLocation, *reinterpret_cast<const float*>( data ) ); break;
+			case GL_FLOAT_VEC2:		glsl->uniform( record.mLocation, *reinterpret_cast<const Vec2f*>( data ) ); break;
+			case GL_FLOAT_VEC3:		glsl->uniform( record.mLocation, *reinterpret_cast<const Vec3f*>( data ) ); break;
+			case GL_FLOAT_VEC4:		glsl->uniform( record.mLocation, *reinterpret_cast<const Vec4f*>( data ) ); break;
+			case GL_FLOAT_MAT3:		glsl->uniform( record.mLocation, *reinterpret_cast<const Matrix33f*>( data ) ); break;
+			case GL_FLOAT_MAT4:		glsl->uniform( record.mLocation, *reinterpret_cast<const Matrix44f*>( data ) ); break;
+		}
+	}
+}
+
+void DrawQueue::bindTextures( const Draw &draw ) const
+{
+	auto ctx = gl::context();
+	for( uint32_t t = draw.mFirstTexture; t < draw.mFirstTexture + draw.mNumTextures; ++t )
+		ctx->bindTexture( mTextures[t].second->getTarget(), mTextures[t].second->getId(), mTextures[t].first );
+}
+
+void DrawQueue::submit()
+{
+	mNumDrawCalls = mNumInstancedDrawCalls = mNumDrawCallsSaved = mNumStateChanges = mNumStateChangesSaved = 0;
+	if( mDraws.empty() )
+		return;
+
+	auto ctx = gl::context();
+
+	// the cost of drawing in recorded order
+	size_t recordedStateChanges = 0;
+	for( size_t d = 0; d < mDraws.size(); ++d )
+		recordedStateChanges += countStateChanges( d ? &mDraws[d-1] : nullptr, mDraws[d] );
+
+	// A draw only sets its own uniforms, and sees those of the draws of its program before it for the rest. Its program's draws can
+	// only be reordered when they all set the same locations, as then each sees its own values wherever the others differ.
+	std::map<GLuint,std::vector<GLint>> progUniformLocs; // by GlslProg handle, the locations set by its first draw
+	std::map<GLuint,bool> progReorderable;
+	std::vector<GLint> uniformLocs;
+	for( size_t d = 0; d < mDraws.size(); ++d ) {
+		const GLuint prog = mDraws[d].mBatch->getGlslProg()->getHandle();
+		getUniformLocations( mDraws[d], &uniformLocs );
+		auto locsIt = progUniformLocs.find( prog );
+		if( locsIt == progUniformLocs.end() ) {
+			progUniformLocs[prog] = uniformLocs;
+			progReorderable[prog] = true;
+		}
+		else if( locsIt->second != uniformLocs )
+			progReorderable[prog] = false;
+	}
+
+	// sort by program, then VAO, then texture; the stable sort keeps the recorded order among equal draws
+	mOrder.resize( mDraws.size() );
+	for( size_t d = 0; d < mOrder.size(); ++d )
+		mOrder[d] = (uint32_t)d;
+	std::stable_sort( mOrder.begin(), mOrder.end(), [&]( uint32_t a, uint32_t b ) {
+		const Draw &da = mDraws[a], &db = mDraws[b];
+		const GLuint progA = da.mBatch->getGlslProg()->getHandle(), progB = db.mBatch->getGlslProg()->getHandle();
+		if( progA != progB )
+			return progA < progB;
+		if( ! progReorderable[progA] )
+			return false;
+		const GLuint vaoA = da.mBatch->getVao()->getId(), vaoB = db.mBatch->getVao()->getId();
+		if( vaoA != vaoB )
+			return vaoA < vaoB;
+		return firstTextureId( mTextures, da.mFirstTexture, da.mNumTextures ) < firstTextureId( mTextures, db.mFirstTexture, db.mNumTextures );
+	} );
+
+	ctx->pushGlslProg();
+	ctx->pushVao();
+	gl::pushModelMatrix();
+
+	std::map<GLuint,GLint> instanceMatrixLocs; // by GlslProg handle
+	const Draw *prev = nullptr;
+	for( size_t groupBegin = 0; groupBegin < mOrder.size(); ) {
+		const Draw &head = mDraws[mOrder[groupBegin]];
+		size_t groupEnd = groupBegin + 1;
+		while( groupEnd < mOrder.size() && isInstanceable( head, mDraws[mOrder[groupEnd]] ) )
+			++groupEnd;
+
+		mNumStateChanges += countStateChanges( prev, head );
+		prev = &head;
+
+		const BatchRef &batch = head.mBatch;
+		const GlslProgRef &glsl = batch->getGlslProg();
+		ctx->bindGlslProg( glsl );
+		ctx->bindVao( batch->getVao() );
+		bindTextures( head );
+		applyUniforms( head );
+
+		GLint instanceMatrixLoc = -1;
+#if ! defined( CINDER_GL_ES )
+		if( groupEnd - groupBegin > 1 && ! mInstanceMatrixAttrib.empty() ) {
+			auto locIt = instanceMatrixLocs.find( glsl->getHandle() );
+			if( locIt == instanceMatrixLocs.end() )
+				locIt = instanceMatrixLocs.insert( std::make_pair( glsl->getHandle(), glsl->getAttribLocation( mInstanceMatrixAttrib ) ) ).first;
+			instanceMatrixLoc = locIt->second;
+		}
+#endif
+
+		if( instanceMatrixLoc == -1 ) {
+			for( size_t d = groupBegin; d < groupEnd; ++d ) {
+				gl::setModelMatrix( mDraws[mOrder[d]].mModelMatrix );
+				ctx->setDefaultShaderVars();
+				if( batch->getNumIndices() )
+					ctx->drawElements( batch->getPrimitive(), batch->getNumIndices(), batch->getIndexDataType(), 0 );
+				else
+					ctx->drawArrays( batch->getPrimitive(), 0, batch->getNumVertices() );
+				++mNumDrawCalls;
+			}
+		}
+#if ! defined( CINDER_GL_ES )
+		else {
+			// stream the model matrices and temporarily add them to the Batch's VAO as a per-instance attribute
+			const GLsizei numInstances = GLsizei( groupEnd - groupBegin );
+			size_t offset;
+			Matrix44f *matrices = reinterpret_cast<Matrix44f*>( ctx->streamArrayBegin( numInstances * sizeof(Matrix44f), &offset ) );
+			for( size_t d = groupBegin; d < groupEnd; ++d )
+				*matrices++ = mDraws[mOrder[d]].mModelMatrix;
+			ctx->streamArrayEnd();
+
+			{
+				ScopedBuffer bufferScp( ctx->getStreamArrayVbo() );
+				for( GLuint column = 0; column < 4; ++column ) {
+					ctx->enableVertexAttribArray( instanceMatrixLoc + column );
+					ctx->vertexAttribPointer( instanceMatrixLoc + column, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix44f), (const GLvoid*)( offset + column * sizeof(Vec4f) ) );
+					ctx->vertexAttribDivisor( instanceMatrixLoc + column, 1 );
+				}
+			}
+
+			gl::setModelMatrix( Matrix44f::identity() );
+			ctx->setDefaultShaderVars();
+			if( batch->getNumIndices() )
+				ctx->drawElementsInstanced( batch->getPrimitive(), batch->getNumIndices(), batch->getIndexDataType(), 0, numInstances );
+			else
+				ctx->drawArraysInstanced( batch->getPrimitive(), 0, batch->getNumVertices(), numInstances );
+			++mNumDrawCalls;
+			++mNumInstancedDrawCalls;
+
+			for( GLuint column = 0; column < 4; ++column ) {
+				ctx->vertexAttribDivisor( instanceMatrixLoc + column, 0 );
+				ctx->disableVertexAttribArray( instanceMatrixLoc + column );
+			}
+		}
+#endif
+
+		groupBegin = groupEnd;
+	}
+
+	gl::popModelMatrix();
+	ctx->popVao();
+	ctx->popGlslProg();
+
+	mNumDrawCallsSaved = mDraws.size() - mNumDrawCalls;
+	mNumStateChangesSaved = ( recordedStateChanges > mNumStateChanges ) ? recordedStateChanges - mNumStateChanges : 0;
+
+	clear();
+}
+
+} } // namespace cinder::gl
@@ -28,6 +28,7 @@
 #include "cinder/gl/Shader.h"
 #include "cinder/gl/Context.h"
 #include "cinder/gl/Vao.h"
+#include "cinder/gl/NullDispatch.h"
 
 #if ! defined( CINDER_GL_ES )
 
@@ -55,7 +56,8 @@ Environment* allocateEnvironmentCore()
 void EnvironmentCore::initializeFunctionPointers()
 {
 	static bool sInitialized = false;
-	if( ! sInitialized ) {
+	// loading would replace the stubs, which stand in for the context
+	if( ! sInitialized && ! NullDispatch::isInstalled() ) {
 		ogl_LoadFunctions();
 		sInitialized = true;
 	}
@@ -25,6 +25,10 @@
 #include "cinder/gl/ConstantStrings.h"
 #include "cinder/gl/Environment.h"
 #include "cinder/Log.h"
+#include "cinder/Utilities.h"
+
+#include <fstream>
+#include <algorithm>
 
 using namespace std;
 
@@ -174,20 +178,12 @@ GlslProg::~GlslProg()
 // GlslProg
 
 GlslProg::GlslProg( const Format &format )
-	: mActiveUniformTypesCached( false ), mActiveAttribTypesCached( false ),
+	: mUniformsDeferred( false ), mHasUniformArrays( false ), mActiveUniformTypesCached( false ), mActiveAttribTypesCached( false ),
 	mUniformSemanticsCached( false ), mUniformNameToSemanticMap( getDefaultUniformNameToSemanticMap() ),
-	mAttribSemanticsCached( false ), mAttribNameToSemanticMap( getDefaultAttribNameToSemanticMap() )
+	mAttribSemanticsCached( false ), mAttribNameToSemanticMap( getDefaultAttribNameToSemanticMap() ),
+	mLoadedFromBinaryCache( false )
 {
 	mHandle = glCreateProgram();
-	
-	if( ! format.getVertex().empty() )
-		loadShader( format.getVertex(), GL_VERTEX_SHADER );
-	if( ! format.getFragment().empty() )
-		loadShader( format.getFragment(), GL_FRAGMENT_SHADER );
-#if ! defined( CINDER_GL_ES )
-	if( ! format.getGeometry().empty() )
-		loadShader( format.getGeometry(), GL_GEOMETRY_SHADER );
-#endif
 
 	// copy the Format's attribute-semantic map
 	for( auto &attribSemantic : format.getAttribSemantics() )
@@ -216,33 +212,59 @@ GlslProg::GlslProg( const Format &format )
 		if( ! attribName.empty() )
 			attribLocations[attribName] = semanticLoc.second;
 	}
-	
-	// finally, bind all location-specified attributes to their respective locations
-	for( auto &attribLoc : attribLocations )
-		glBindAttribLocation( mHandle, attribLoc.second, attribLoc.first.c_str() );
+
+#if ! defined( CINDER_GL_ES )
+	// a cached binary already has its attribute locations and feedback varyings linked in
+	const fs::path binaryPath = getBinaryCachePath( format, attribLocations );
+	if( ! binaryPath.empty() )
+		mLoadedFromBinaryCache = loadBinary( binaryPath );
+#endif
+
+	if( ! mLoadedFromBinaryCache ) {
+		if( ! format.getVertex().empty() )
+			loadShader( format.getVertex(), GL_VERTEX_SHADER );
+		if( ! format.getFragment().empty() )
+			loadShader( format.getFragment(), GL_FRAGMENT_SHADER );
+#if ! defined( CINDER_GL_ES )
+		if( ! format.getGeometry().empty() )
+			loadShader( format.getGeometry(), GL_GEOMETRY_SHADER );
+#endif
+
+		// finally, bind all location-specified attributes to their respective locations
+		for( auto &attribLoc : attribLocations )
+			glBindAttribLocation( mHandle, attribLoc.second, attribLoc.first.c_str() );
 	
 #if ! defined( CINDER_GL_ES )
-	if( ! format.getVaryings().empty() && format.getTransformFormat() > 0 ) {
-		// This is a mess due to an NVidia driver bug on MSW which expects the memory passed to glTransformFeedbackVaryings
-		// to still be around after the call. We allocate the storage and put it on the GlslProg itself to be freed at destruction
-		size_t totalSizeBytes = 0;
-		for( auto &v : format.getVaryings() )
-			totalSizeBytes += v.length() + 1;
-
-		mTransformFeedbackVaryingsChars = std::unique_ptr<std::vector<GLchar>>( new vector<GLchar>() );
-		mTransformFeedbackVaryingsCharStarts = std::unique_ptr<std::vector<GLchar*>>( new vector<GLchar*>() );
-		mTransformFeedbackVaryingsChars->resize( totalSizeBytes );
-		size_t curOffset = 0;
-		for( auto &v : format.getVaryings() ) {
-			mTransformFeedbackVaryingsCharStarts->push_back( &(*mTransformFeedbackVaryingsChars)[curOffset] );
-			memcpy( &(*mTransformFeedbackVaryingsChars)[curOffset], v.c_str(), v.length() + 1 );
-			curOffset += v.length() + 1;
+		if( ! format.getVaryings().empty() && format.getTransformFormat() > 0 ) {
+			// This is a mess due to an NVidia driver bug on MSW which expects the memory passed to glTransformFeedbackVaryings
+			// to still be around after the call. We allocate the storage and put it on the GlslProg itself to be freed at destruction
+			size_t totalSizeBytes = 0;
+			for( auto &v : format.getVaryings() )
+				totalSizeBytes += v.length() + 1;
+
+			mTransformFeedbackVaryingsChars = std::unique_ptr<std::vector<GLchar>>( new vector<GLchar>() );
+			mTransformFeedbackVaryingsCharStarts = std::unique_ptr<std::vector<GLchar*>>( new vector<GLchar*>() );
+			mTransformFeedbackVaryingsChars->resize( totalSizeBytes );
+			size_t curOffset = 0;
+			for( auto &v : format.getVaryings() ) {
+				mTransformFeedbackVaryingsCharStarts->push_back( &(*mTransformFeedbackVaryingsChars)[curOffset] );
+				memcpy( &(*mTransformFeedbackVaryingsChars)[curOffset], v.c_str(), v.length() + 1 );
+				curOffset += v.length() + 1;
+			}
+			glTransformFeedbackVaryings( mHandle, format.getVaryings().size(), mTransformFeedbackVaryingsCharStarts->data(), format.getTransformFormat() );
 		}
-		glTransformFeedbackVaryings( mHandle, format.getVaryings().size(), mTransformFeedbackVaryingsCharStarts->data(), format.getTransformFormat() );
-	}
+
+		if( ! binaryPath.empty() )
+			glProgramParameteri( mHandle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
 #endif
 	
-	link();
+		link();
+
+#if ! defined( CINDER_GL_ES )
+		if( ! binaryPath.empty() )
+			saveBinary( binaryPath );
+#endif
+	}
 	
 	setLabel( format.getLabel() );
 	gl::context()->glslProgCreated( this );
@@ -316,6 +338,131 @@ void GlslProg::link()
 	glLinkProgram( mHandle );
 }
 
+#if ! defined( CINDER_GL_ES )
+namespace {
+fs::path sBinaryCacheDirectory;
+
+const uint32_t BINARY_CACHE_MAGIC = 0x42504943; // 'CIPB'
+
+uint64_t hashString( const std::string &str, uint64_t hash )
+{
+	// 64-bit FNV-1a
+	for( size_t c = 0; c < str.size(); ++c ) {
+		hash ^= (uint8_t)str[c];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+const char* getGlString( GLenum name )
+{
+	const char *result = reinterpret_cast<const char*>( glGetString( name ) );
+	return result ? result : "";
+}
+} // anonymous namespace
+
+void GlslProg::setBinaryCacheDirectory( const fs::path &directory )
+{
+	sBinaryCacheDirectory = directory;
+	if( ! directory.empty() && ! fs::exists( directory ) ) {
+		try {
+			fs::create_directories( directory );
+		}
+		catch( std::exception &exc ) {
+			CI_LOG_E( "Failed to create program binary cache directory " << directory << ": " << exc.what() );
+		}
+	}
+}
+
+const fs::path& GlslProg::getBinaryCacheDirectory()
+{
+	return sBinaryCacheDirectory;
+}
+
+bool GlslProg::isBinaryCacheSupported()
+{
+	return gl::context()->isProgramBinarySupported();
+}
+
+fs::path GlslProg::getBinaryCachePath( const Format &format, const std::map<std::string,GLint> &attribLocations )
+{
+	if( sBinaryCacheDirectory.empty() || ! isBinaryCacheSupported() )
+		return fs::path();
+
+	uint64_t hash = 14695981039346656037ULL;
+	hash = hashString( format.getVertex(), hash );
+	hash = hashString( "\x01", hash );
+	hash = hashString( format.getFragment(), hash );
+	hash = hashString( "\x01", hash );
+	hash = hashString( format.getGeometry(), hash );
+	for( auto &attribLoc : attribLocations )
+		hash = hashString( "\x02" + attribLoc.first + "=" + toString( attribLoc.second ), hash );
+	for( auto &varying : format.getVaryings() )
+		hash = hashString( "\x03" + varying, hash );
+	hash = hashString( "\x04" + toString( format.getTransformFormat() ), hash );
+	// a driver update invalidates the binaries
+	hash = hashString( getGlString( GL_VENDOR ), hash );
+	hash = hashString( getGlString( GL_RENDERER ), hash );
+	hash = hashString( getGlString( GL_VERSION ), hash );
+
+	char fileName[32];
+	sprintf( fileName, "%016llx.bin", (unsigned long long)hash );
+	return sBinaryCacheDirectory / fileName;
+}
+
+bool GlslProg::loadBinary( const fs::path &path )
+{
+	std::ifstream stream( path.string().c_str(), std::ios::binary );
+	if( ! stream )
+		return false;
+
+	uint32_t header[3]; // magic, binary format, size in bytes
+	if( ! stream.read( reinterpret_cast<char*>( header ), sizeof(header) ) || header[0] != BINARY_CACHE_MAGIC )
+		return false;
+
+	std::vector<char> binary( header[2] );
+	if( binary.empty() || ! stream.read( binary.data(), binary.size() ) )
+		return false;
+
+	glProgramBinary( mHandle, (GLenum)header[1], binary.data(), (GLsizei)binary.size() );
+	GLint status = GL_FALSE;
+	glGetProgramiv( mHandle, GL_LINK_STATUS, &status );
+	return status == GL_TRUE;
+}
+
+void GlslProg::saveBinary( const fs::path &path ) const
+{
+	GLint status = GL_FALSE, length = 0;
+	glGetProgramiv( mHandle, GL_LINK_STATUS, &status );
+	glGetProgramiv( mHandle, GL_PROGRAM_BINARY_LENGTH, &length );
+	if( status != GL_TRUE || length <= 0 )
+		return;
+
+	std::vector<char> binary( length );
+	GLenum binaryFormat = 0;
+	glGetProgramBinary( mHandle, length, &length, &binaryFormat, binary.data() );
+
+	// write to a temporary file first, so that a program built concurrently never reads a partial binary
+	fs::path tempPath = path;
+	tempPath.replace_extension( ".tmp" + toString( reinterpret_cast<size_t>( this ) ) );
+	{
+		std::ofstream stream( tempPath.string().c_str(), std::ios::binary );
+		uint32_t header[3] = { BINARY_CACHE_MAGIC, (uint32_t)binaryFormat, (uint32_t)length };
+		stream.write( reinterpret_cast<const char*>( header ), sizeof(header) );
+		stream.write( binary.data(), length );
+		if( ! stream ) {
+			CI_LOG_W( "Failed to write program binary " << path );
+			return;
+		}
+	}
+
+	boost::system::error_code errorCode;
+	fs::rename( tempPath, path, errorCode );
+	if( errorCode )
+		fs::remove( tempPath, errorCode );
+}
+#endif // ! defined( CINDER_GL_ES )
+
 void GlslProg::bind() const
 {
 	// this will in turn call bindImpl; this is so that the context can update its reference to the active shader
@@ -350,384 +497,316 @@ std::string GlslProg::getShaderLog( GLuint handle ) const
 // int
 void GlslProg::uniform( int location, int data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform1i( location, data );
+	setUniformValue( location, GL_INT, 1, false, &data, sizeof(int) );
 }
 
 void GlslProg::uniform( const std::string &name, int data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform1i( loc, data );
+	uniform( findUniformLocation( name ), data );
 }
 
 // Vec2i
 void GlslProg::uniform( int location, const Vec2i &data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform2i( location, data.x, data.y );
+	setUniformValue( location, GL_INT_VEC2, 1, false, &data.x, sizeof(Vec2i) );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec2i &data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform2i( loc, data.x, data.y );
+	uniform( findUniformLocation( name ), data );
 }
 
 // int *, count
 void GlslProg::uniform( int location, const int *data, int count ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform1iv( location, count, data );
+	setUniformValue( location, GL_INT, count, false, data, sizeof(int) * count );
 }
 
 void GlslProg::uniform( const std::string &name, const int *data, int count ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform1iv( loc, count, data );
+	uniform( findUniformLocation( name ), data, count );
 }
 
 // Vec2i *, count
 void GlslProg::uniform( int location, const Vec2i *data, int count ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform2iv( location, count, &data[0].x );
+	setUniformValue( location, GL_INT_VEC2, count, false, &data[0].x, sizeof(Vec2i) * count );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec2i *data, int count ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform2iv( loc, count, &data[0].x );
+	uniform( findUniformLocation( name ), data, count );
 }
 
 // float
 void GlslProg::uniform( int location, float data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform1f( location, data );
+	setUniformValue( location, GL_FLOAT, 1, false, &data, sizeof(float) );
 }
 
 void GlslProg::uniform( const std::string &name, float data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform1f( loc, data );
+	uniform( findUniformLocation( name ), data );
 }
 
 // Vec2f
 void GlslProg::uniform( int location, const Vec2f &data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform2f( location, data.x, data.y );
+	setUniformValue( location, GL_FLOAT_VEC2, 1, false, &data.x, sizeof(Vec2f) );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec2f &data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform2f( loc, data.x, data.y );
+	uniform( findUniformLocation( name ), data );
 }
 
 // Vec3f
 void GlslProg::uniform( int location, const Vec3f &data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform3f( location, data.x, data.y, data.z );
+	setUniformValue( location, GL_FLOAT_VEC3, 1, false, &data.x, sizeof(Vec3f) );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec3f &data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform3f( loc, data.x, data.y, data.z );
+	uniform( findUniformLocation( name ), data );
 }
 
 // Vec4f
 void GlslProg::uniform( int location, const Vec4f &data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform4f( location, data.x, data.y, data.z, data.w );
+	setUniformValue( location, GL_FLOAT_VEC4, 1, false, &data.x, sizeof(Vec4f) );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec4f &data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform4f( loc, data.x, data.y, data.z, data.w );
+	uniform( findUniformLocation( name ), data );
 }
 
 // Matrix33f
 void GlslProg::uniform( int location, const Matrix33f &data, bool transpose ) const
 {
-    ScopedGlslProg shaderBind( shared_from_this() );
-    glUniformMatrix3fv( location, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
+	setUniformValue( location, GL_FLOAT_MAT3, 1, transpose, data.m, sizeof(Matrix33f) );
 }
 
 void GlslProg::uniform( const std::string &name, const Matrix33f &data, bool transpose ) const
 {
-    ScopedGlslProg shaderBind( shared_from_this() );
-    GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniformMatrix3fv( loc, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
+	uniform( findUniformLocation( name ), data, transpose );
 }
 
 // Matrix44f
 void GlslProg::uniform( int location, const Matrix44f &data, bool transpose ) const
 {
-    ScopedGlslProg shaderBind( shared_from_this() );
-    glUniformMatrix4fv( location, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
+	setUniformValue( location, GL_FLOAT_MAT4, 1, transpose, data.m, sizeof(Matrix44f) );
 }
 
 void GlslProg::uniform( const std::string &name, const Matrix44f &data, bool transpose ) const
 {
-    ScopedGlslProg shaderBind( shared_from_this() );
-    GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniformMatrix4fv( loc, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
+	uniform( findUniformLocation( name ), data, transpose );
 }
 
 // Color
 void GlslProg::uniform( int location, const Color &data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform3f( location, data.r, data.g, data.b );
+	setUniformValue( location, GL_FLOAT_VEC3, 1, false, &data.r, sizeof(Color) );
 }
 
 void GlslProg::uniform( const std::string &name, const Color &data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform3f( loc, data.r, data.g, data.b );
+	uniform( findUniformLocation( name ), data );
 }
 
 // ColorA
 void GlslProg::uniform( int location, const ColorA &data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform4f( location, data.r, data.g, data.b, data.a );
+	setUniformValue( location, GL_FLOAT_VEC4, 1, false, &data.r, sizeof(ColorA) );
 }
 
 void GlslProg::uniform( const std::string &name, const ColorA &data ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform4f( loc, data.r, data.g, data.b, data.a );
+	uniform( findUniformLocation( name ), data );
 }
 
 // float*, count
 void GlslProg::uniform( int location, const float *data, int count ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform1fv( location, count, data );
+	setUniformValue( location, GL_FLOAT, count, false, data, sizeof(float) * count );
 }
 
 void GlslProg::uniform( const std::string &name, const float *data, int count ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform1fv( loc, count, data );
+	uniform( findUniformLocation( name ), data, count );
 }
 
 // Vec2f*, count
 void GlslProg::uniform( int location, const Vec2f *data, int count ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform2fv( location, count, &data[0].x );
+	setUniformValue( location, GL_FLOAT_VEC2, count, false, &data[0].x, sizeof(Vec2f) * count );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec2f *data, int count ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform2fv( loc, count, &data[0].x );
+	uniform( findUniformLocation( name ), data, count );
 }
 
 // Vec3f*, count
 void GlslProg::uniform( int location, const Vec3f *data, int count ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform3fv( location, count, &data[0].x );
+	setUniformValue( location, GL_FLOAT_VEC3, count, false, &data[0].x, sizeof(Vec3f) * count );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec3f *data, int count ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform3fv( loc, count, &data[0].x );
+	uniform( findUniformLocation( name ), data, count );
 }
 
 // Vec4f*, count
 void GlslProg::uniform( int location, const Vec4f *data, int count ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	glUniform4fv( location, count, &data[0].x );
+	setUniformValue( location, GL_FLOAT_VEC4, count, false, &data[0].x, sizeof(Vec4f) * count );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec4f *data, int count ) const
 {
-	ScopedGlslProg shaderBind( shared_from_this() );
-	GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniform4fv( loc, count, &data[0].x );
+	uniform( findUniformLocation( name ), data, count );
 }
 
 // Matrix33f*, count
 void GlslProg::uniform( int location, const Matrix33f *data, int count, bool transpose ) const
 {
-    ScopedGlslProg shaderBind( shared_from_this() );
-    glUniformMatrix3fv( location, count, ( transpose ) ? GL_TRUE : GL_FALSE, &data->m[0] );
+	setUniformValue( location, GL_FLOAT_MAT3, count, transpose, &data->m[0], sizeof(Matrix33f) * count );
 }
 
 void GlslProg::uniform( const std::string &name, const Matrix33f *data, int count, bool transpose ) const
 {
-    ScopedGlslProg shaderBind( shared_from_this() );
-    GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
-		}
-	}
-	else
-		glUniformMatrix3fv( loc, count, ( transpose ) ? GL_TRUE : GL_FALSE, &data->m[0] );
+	uniform( findUniformLocation( name ), data, count, transpose );
 }
 
 // Matrix44f*, count
 void GlslProg::uniform( int location, const Matrix44f *data, int count, bool transpose ) const
 {
-    ScopedGlslProg shaderBind( shared_from_this() );
-    glUniformMatrix4fv( location, count, ( transpose ) ? GL_TRUE : GL_FALSE, &data->m[0] );
+	setUniformValue( location, GL_FLOAT_MAT4, count, transpose, &data->m[0], sizeof(Matrix44f) * count );
 }
 
 void GlslProg::uniform( const std::string &name, const Matrix44f *data, int count, bool transpose ) const
 {
-    ScopedGlslProg shaderBind( shared_from_this() );
-    GLint loc = getUniformLocation( name );
-	if( loc == -1 ) {
-		if( mLoggedMissingUniforms.count( name ) == 0 ) {
-			CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
-			mLoggedMissingUniforms.insert( name );
+	uniform( findUniformLocation( name ), data, count, transpose );
+}
+
+// Records the value in the uniform's shadow and uploads it unless it's unchanged or uploads are deferred
+void GlslProg::setUniformValue( int location, GLenum type, GLsizei count, bool transpose, const void *data, size_t dataSize ) const
+{
+	if( location == -1 )
+		return;
+
+	UniformValue &value = mUniformValues[location];
+	const uint8_t *bytes = reinterpret_cast<const uint8_t*>( data );
+	if( ! value.mStale && value.mType == type && value.mCount == count && value.mTranspose == transpose
+		&& value.mData.size() == dataSize && memcmp( value.mData.data(), bytes, dataSize ) == 0 )
+		return;
+
+	// The elements of an array uniform have the locations following the array's, so setting "u" with a count of 4 also sets "u[1]" through
+	// "u[3]". Each value overlapping this one no longer reflects what GL holds.
+	bool overlaps = false;
+	mHasUniformArrays = mHasUniformArrays || ( count > 1 );
+	if( mHasUniformArrays ) {
+		for( auto &other : mUniformValues ) {
+			if( other.first != location && other.first < location + count && location < other.first + other.second.mCount ) {
+				other.second.mStale = true;
+				overlaps = true;
+			}
 		}
 	}
-	else
-		glUniformMatrix4fv( loc, count, ( transpose ) ? GL_TRUE : GL_FALSE, &data->m[0] );
+
+	value.mType = type;
+	value.mCount = count;
+	value.mTranspose = transpose;
+	value.mStale = false;
+	value.mData.assign( bytes, bytes + dataSize );
+
+	if( mUniformsDeferred ) {
+		// overlapping values have to be uploaded in the order they were set, so this one moves behind any recorded since its last upload
+		if( value.mDirty && overlaps ) {
+			mDirtyUniforms.erase( std::find( mDirtyUniforms.begin(), mDirtyUniforms.end(), location ) );
+			value.mDirty = false;
+		}
+		if( ! value.mDirty ) {
+			value.mDirty = true;
+			mDirtyUniforms.push_back( location );
+		}
+	}
+	else {
+		// avoid the push and pop of the GlslProg stack when we're already bound, which is the common case
+		if( gl::context()->getGlslProg().get() == this )
+			uploadUniform( location, value );
+		else {
+			ScopedGlslProg shaderBind( shared_from_this() );
+			uploadUniform( location, value );
+		}
+	}
+}
+
+// Requires that this GlslProg is bound
+void GlslProg::uploadUniform( int location, const UniformValue &value ) const
+{
+	const GLboolean transpose = ( value.mTranspose ) ? GL_TRUE : GL_FALSE;
+	switch( value.mType ) {
+		case GL_INT:			glUniform1iv( location, value.mCount, reinterpret_cast<const GLint*>( value.mData.data() ) ); break;
+		case GL_INT_VEC2:		glUniform2iv( location, value.mCount, reinterpret_cast<const GLint*>( value.mData.data() ) ); break;
+		case GL_FLOAT:			glUniform1fv( location, value.mCount, reinterpret_cast<const GLfloat*>( value.mData.data() ) ); break;
+		case GL_FLOAT_VEC2:		glUniform2fv( location, value.mCount, reinterpret_cast<const GLfloat*>( value.mData.data() ) ); break;
+		case GL_FLOAT_VEC3:		glUniform3fv( location, value.mCount, reinterpret_cast<const GLfloat*>( value.mData.data() ) ); break;
+		case GL_FLOAT_VEC4:		glUniform4fv( location, value.mCount, reinterpret_cast<const GLfloat*>( value.mData.data() ) ); break;
+		case GL_FLOAT_MAT3:		glUniformMatrix3fv( location, value.mCount, transpose, reinterpret_cast<const GLfloat*>( value.mData.data() ) ); break;
+		case GL_FLOAT_MAT4:		glUniformMatrix4fv( location, value.mCount, transpose, reinterpret_cast<const GLfloat*>( value.mData.data() ) ); break;
+		default:
+			CI_LOG_E( "Unsupported uniform type: " << gl::constantToString( value.mType ) );
+	}
+}
+
+void GlslProg::setUniformsDeferred( bool deferred )
+{
+	if( mUniformsDeferred && ! deferred )
+		flushUniforms();
+	mUniformsDeferred = deferred;
+}
+
+void GlslProg::flushUniforms() const
+{
+	if( mDirtyUniforms.empty() )
+		return;
+
+	auto upload = [this] {
+		for( int location : mDirtyUniforms ) {
+			UniformValue &value = mUniformValues[location];
+			uploadUniform( location, value );
+			value.mDirty = false;
+		}
+		mDirtyUniforms.clear();
+	};
+
+	if( gl::context()->getGlslProg().get() == this )
+		upload();
+	else {
+		ScopedGlslProg shaderBind( shared_from_this() );
+		upload();
+	}
+}
+
+// Returns the location of uniform \a name, logging it the first time it's found to be missing
+GLint GlslProg::findUniformLocation( const std::string &name ) const
+{
+	GLint loc = getUniformLocation( name );
+	if( loc == -1 && mLoggedMissingUniforms.count( name ) == 0 ) {
+		CI_LOG_E( "Unknown uniform: \"" << name << "\"" );
+		mLoggedMissingUniforms.insert( name );
+	}
+
+	return loc;
 }
 
 GLint GlslProg::getUniformLocation( const std::string &name ) const
 {
-	map<string,int>::const_iterator uniformIt = mUniformLocs.find( name );
+	auto uniformIt = mUniformLocs.find( name );
 	if( uniformIt == mUniformLocs.end() ) {
 		GLint loc = glGetUniformLocation( mHandle, name.c_str() );
 		mUniformLocs[name] = loc;
@@ -787,6 +866,7 @@ const GlslProg::UniformSemanticMap& GlslProg::getUniformSemantics() const
 			if( semantic != mUniformNameToSemanticMap.end() ) {
 				// found this semantic, add it mUniformSemantics
 				mUniformSemantics[semantic->first] = semantic->second;
+				mUniformSemanticLocations.push_back( make_pair( getUniformLocation( semantic->first ), semantic->second ) );
 			}
 			// if this uniform starts with "ci[A-Z]" it is likely a typo
 			else if( (activeUnifIt->first.length() > 4) && (activeUnifIt->first.substr( 0, 2 ) == "ci") && (isupper(activeUnifIt->first[2]) ) ) {
@@ -800,6 +880,12 @@ const GlslProg::UniformSemanticMap& GlslProg::getUniformSemantics() const
 	return mUniformSemantics;
 }
 
+const std::vector<std::pair<GLint,UniformSemantic>>& GlslProg::getUniformSemanticLocations() const
+{
+	getUniformSemantics();
+	return mUniformSemanticLocations;
+}
+
 const GlslProg::AttribSemanticMap& GlslProg::getAttribSemantics() const
 {
 	if( ! mAttribSemanticsCached ) {
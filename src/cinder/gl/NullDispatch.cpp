@@ -0,0 +1,385 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/NullDispatch.h"
+
+#include <algorithm>
+#include <vector>
+
+#if defined( CINDER_MSW ) && ( _MSC_VER < 1800 )
+	#define CINDER_NO_VARIADIC_TEMPLATES
+	#include <boost/preprocessor/repetition.hpp>
+#endif
+
+namespace cinder { namespace gl {
+
+#if ! defined( CINDER_GL_ES )
+
+// Every entry point called by the gl namespace. Arguments are never macro-expanded, so glBindTexture names _funcptr_glBindTexture.
+#define CI_NULL_DISPATCH_ENTRY_POINTS( E ) \
+	E( glActiveTexture ) E( glAttachShader ) E( glBeginTransformFeedback ) E( glBindAttribLocation ) \
+	E( glBindBuffer ) E( glBindBufferBase ) E( glBindFramebuffer ) E( glBindRenderbuffer ) \
+	E( glBindTexture ) E( glBindTransformFeedback ) E( glBindVertexArray ) E( glBlendFunc ) \
+	E( glBlendFuncSeparate ) E( glBlitFramebuffer ) E( glBlitFramebufferEXT ) E( glBufferData ) \
+	E( glBufferStorage ) E( glBufferSubData ) E( glCheckFramebufferStatus ) E( glClear ) \
+	E( glClearColor ) E( glClearDepth ) E( glClearDepthf ) E( glClearStencil ) \
+	E( glClientWaitSync ) E( glColorMask ) E( glCompileShader ) E( glCompressedTexImage2D ) \
+	E( glCompressedTexSubImage2D ) E( glCreateProgram ) E( glCreateShader ) E( glDebugMessageCallback ) \
+	E( glDeleteBuffers ) E( glDeleteFramebuffers ) E( glDeleteProgram ) E( glDeleteRenderbuffers ) \
+	E( glDeleteSync ) E( glDeleteTextures ) E( glDeleteTransformFeedbacks ) E( glDeleteVertexArrays ) \
+	E( glDepthMask ) E( glDisable ) E( glDisableVertexAttribArray ) E( glDrawArrays ) \
+	E( glDrawArraysInstanced ) E( glDrawBuffer ) E( glDrawBuffers ) E( glDrawElements ) \
+	E( glDrawElementsInstanced ) E( glEnable ) E( glEnableVertexAttribArray ) E( glEndTransformFeedback ) \
+	E( glFenceSync ) E( glFlush ) E( glFramebufferRenderbuffer ) E( glFramebufferTexture2D ) \
+	E( glGenBuffers ) E( glGenFramebuffers ) E( glGenRenderbuffers ) E( glGenTextures ) \
+	E( glGenTransformFeedbacks ) E( glGenVertexArrays ) E( glGenerateMipmap ) E( glGetActiveAttrib ) \
+	E( glGetActiveUniform ) E( glGetAttribLocation ) E( glGetBufferSubData ) E( glGetError ) \
+	E( glGetFloatv ) E( glGetIntegerv ) E( glGetProgramBinary ) E( glGetProgramiv ) \
+	E( glGetShaderInfoLog ) E( glGetShaderiv ) E( glGetString ) E( glGetStringi ) \
+	E( glGetTexImage ) E( glGetTexLevelParameteriv ) E( glGetUniformLocation ) E( glGetVertexAttribiv ) \
+	E( glIsEnabled ) E( glLinkProgram ) E( glMapBuffer ) E( glMapBufferRange ) \
+	E( glObjectLabel ) E( glPauseTransformFeedback ) E( glPixelStorei ) E( glPolygonMode ) \
+	E( glProgramBinary ) E( glProgramParameteri ) E( glReadBuffer ) E( glReadPixels ) \
+	E( glRenderbufferStorage ) E( glRenderbufferStorageMultisample ) E( glRenderbufferStorageMultisampleCoverageNV ) E( glResumeTransformFeedback ) \
+	E( glScissor ) E( glShaderSource ) E( glStencilFunc ) E( glStencilMask ) \
+	E( glStencilOp ) E( glTexBuffer ) E( glTexImage2D ) E( glTexImage3D ) \
+	E( glTexParameterf ) E( glTexParameterfv ) E( glTexParameteri ) E( glTexParameteriv ) \
+	E( glTexSubImage2D ) E( glTexSubImage3D ) E( glTransformFeedbackVaryings ) E( glUniform1fv ) \
+	E( glUniform1iv ) E( glUniform2fv ) E( glUniform2iv ) E( glUniform3fv ) \
+	E( glUniform4fv ) E( glUniformMatrix3fv ) E( glUniformMatrix4fv ) E( glUnmapBuffer ) \
+	E( glUseProgram ) E( glVertexAttrib1f ) E( glVertexAttrib2f ) E( glVertexAttrib3f ) \
+	E( glVertexAttrib4f ) E( glVertexAttribDivisor ) E( glVertexAttribDivisorARB ) E( glVertexAttribIPointer ) \
+	E( glVertexAttribPointer ) E( glViewport ) E( glWaitSync )
+
+namespace {
+
+#define ENUM_ENTRY_POINT( name )	ENTRY_POINT_##name,
+enum EntryPointId { CI_NULL_DISPATCH_ENTRY_POINTS( ENUM_ENTRY_POINT ) NUM_ENTRY_POINTS };
+#undef ENUM_ENTRY_POINT
+
+typedef void (CODEGEN_FUNCPTR *GenericProc)();
+
+struct EntryPoint {
+	const char		*mName;
+	GenericProc		*mFuncPtr;
+	GenericProc		mStub, mSaved;
+};
+
+EntryPoint				sEntryPoints[NUM_ENTRY_POINTS];
+uint32_t				sNumCalls[NUM_ENTRY_POINTS];
+bool					sInstalled = false;
+GLuint					sNextName = 0;
+std::vector<uint8_t>	sMapScratch;
+
+// The default stub for an entry point of type Proc, which counts the call and returns zero
+template<typename Proc>
+struct NullProc;
+
+#if ! defined( CINDER_NO_VARIADIC_TEMPLATES )
+template<typename R, typename... Args>
+struct NullProc<R (CODEGEN_FUNCPTR *)( Args... )> {
+	template<int ID>
+	static R CODEGEN_FUNCPTR call( Args... ) { ++sNumCalls[ID]; return R(); }
+};
+#else
+#define NULL_PROC( z, n, unused )																	\
+	template<typename R BOOST_PP_ENUM_TRAILING_PARAMS( n, typename Arg )>								\
+	struct NullProc<R (CODEGEN_FUNCPTR *)( BOOST_PP_ENUM_PARAMS( n, Arg ) )> {						\
+		template<int ID>																			\
+		static R CODEGEN_FUNCPTR call( BOOST_PP_ENUM_PARAMS( n, Arg ) ) { ++sNumCalls[ID]; return R(); }	\
+	};
+
+	BOOST_PP_REPEAT( 12, NULL_PROC, ~ )
+#undef NULL_PROC
+#endif
+
+// Queries which return arrays
+GLint numQueryValues( GLenum pname )
+{
+	switch( pname ) {
+		case GL_VIEWPORT: case GL_SCISSOR_BOX: case GL_COLOR_CLEAR_VALUE: case GL_COLOR_WRITEMASK: case GL_BLEND_COLOR:
+			return 4;
+		case GL_MAX_VIEWPORT_DIMS: case GL_DEPTH_RANGE: case GL_POLYGON_MODE: case GL_ALIASED_LINE_WIDTH_RANGE: case GL_SMOOTH_LINE_WIDTH_RANGE: case GL_POINT_SIZE_RANGE:
+			return 2;
+		case GL_COMPRESSED_TEXTURE_FORMATS: case GL_PROGRAM_BINARY_FORMATS: // GL_NUM_* report none
+			return 0;
+		default:
+			return 1;
+	}
+}
+
+// Stubs for the queries and object creation whose results the gl namespace depends on
+
+void CODEGEN_FUNCPTR nullGetIntegerv( GLenum pname, GLint *data )
+{
+	++sNumCalls[ENTRY_POINT_glGetIntegerv];
+	std::fill( data, data + numQueryValues( pname ), 0 );
+}
+
+void CODEGEN_FUNCPTR nullGetFloatv( GLenum pname, GLfloat *data )
+{
+	++sNumCalls[ENTRY_POINT_glGetFloatv];
+	std::fill( data, data + numQueryValues( pname ), 0.0f );
+}
+
+void CODEGEN_FUNCPTR nullGetShaderiv( GLuint shader, GLenum pname, GLint *params )
+{
+	++sNumCalls[ENTRY_POINT_glGetShaderiv];
+	*params = ( pname == GL_COMPILE_STATUS ) ? GL_TRUE : 0;
+}
+
+void CODEGEN_FUNCPTR nullGetProgramiv( GLuint program, GLenum pname, GLint *params )
+{
+	++sNumCalls[ENTRY_POINT_glGetProgramiv];
+	*params = ( pname == GL_LINK_STATUS || pname == GL_VALIDATE_STATUS ) ? GL_TRUE : 0;
+}
+
+void CODEGEN_FUNCPTR nullGetShaderInfoLog( GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog )
+{
+	++sNumCalls[ENTRY_POINT_glGetShaderInfoLog];
+	if( length )
+		*length = 0;
+	if( bufSize > 0 )
+		infoLog[0] = 0;
+}
+
+void CODEGEN_FUNCPTR nullGetActive( GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name )
+{
+	if( length )
+		*length = 0;
+	*size = 0;
+	*type = 0;
+	if( bufSize > 0 )
+		name[0] = 0;
+}
+
+void CODEGEN_FUNCPTR nullGetActiveAttrib( GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name )
+{
+	++sNumCalls[ENTRY_POINT_glGetActiveAttrib];
+	nullGetActive( bufSize, length, size, type, name );
+}
+
+void CODEGEN_FUNCPTR nullGetActiveUniform( GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name )
+{
+	++sNumCalls[ENTRY_POINT_glGetActiveUniform];
+	nullGetActive( bufSize, length, size, type, name );
+}
+
+void CODEGEN_FUNCPTR nullGetProgramBinary( GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, GLvoid *binary )
+{
+	++sNumCalls[ENTRY_POINT_glGetProgramBinary];
+	if( length )
+		*length = 0;
+}
+
+void CODEGEN_FUNCPTR nullGetVertexAttribiv( GLuint index, GLenum pname, GLint *params )
+{
+	++sNumCalls[ENTRY_POINT_glGetVertexAttribiv];
+	std::fill( params, params + ( ( pname == GL_CURRENT_VERTEX_ATTRIB ) ? 4 : 1 ), 0 );
+}
+
+void CODEGEN_FUNCPTR nullGetTexLevelParameteriv( GLenum target, GLint level, GLenum pname, GLint *params )
+{
+	++sNumCalls[ENTRY_POINT_glGetTexLevelParameteriv];
+	*params = 0;
+}
+
+GLint CODEGEN_FUNCPTR nullGetUniformLocation( GLuint program, const GLchar *name )
+{
+	++sNumCalls[ENTRY_POINT_glGetUniformLocation];
+	return -1;
+}
+
+GLint CODEGEN_FUNCPTR nullGetAttribLocation( GLuint program, const GLchar *name )
+{
+	++sNumCalls[ENTRY_POINT_glGetAttribLocation];
+	return -1;
+}
+
+const GLubyte* CODEGEN_FUNCPTR nullGetString( GLenum name )
+{
+	++sNumCalls[ENTRY_POINT_glGetString];
+	switch( name ) {
+		case GL_VERSION:					return reinterpret_cast<const GLubyte*>( "3.2 NullDispatch" );
+		case GL_SHADING_LANGUAGE_VERSION:	return reinterpret_cast<const GLubyte*>( "1.50" );
+		case GL_VENDOR:						return reinterpret_cast<const GLubyte*>( "Cinder" );
+		case GL_RENDERER:					return reinterpret_cast<const GLubyte*>( "NullDispatch" );
+		default:							return reinterpret_cast<const GLubyte*>( "" );
+	}
+}
+
+const GLubyte* CODEGEN_FUNCPTR nullGetStringi( GLenum name, GLuint index )
+{
+	++sNumCalls[ENTRY_POINT_glGetStringi];
+	return reinterpret_cast<const GLubyte*>( "" );
+}
+
+void generateNames( GLsizei n, GLuint *names )
+{
+	for( GLsizei i = 0; i < n; ++i )
+		names[i] = ++sNextName;
+}
+
+void CODEGEN_FUNCPTR nullGenBuffers( GLsizei n, GLuint *buffers )					{ ++sNumCalls[ENTRY_POINT_glGenBuffers]; generateNames( n, buffers ); }
+void CODEGEN_FUNCPTR nullGenFramebuffers( GLsizei n, GLuint *framebuffers )			{ ++sNumCalls[ENTRY_POINT_glGenFramebuffers]; generateNames( n, framebuffers ); }
+void CODEGEN_FUNCPTR nullGenRenderbuffers( GLsizei n, GLuint *renderbuffers )		{ ++sNumCalls[ENTRY_POINT_glGenRenderbuffers]; generateNames( n, renderbuffers ); }
+void CODEGEN_FUNCPTR nullGenTextures( GLsizei n, GLuint *textures )					{ ++sNumCalls[ENTRY_POINT_glGenTextures]; generateNames( n, textures ); }
+void CODEGEN_FUNCPTR nullGenTransformFeedbacks( GLsizei n, GLuint *ids )			{ ++sNumCalls[ENTRY_POINT_glGenTransformFeedbacks]; generateNames( n, ids ); }
+void CODEGEN_FUNCPTR nullGenVertexArrays( GLsizei n, GLuint *arrays )				{ ++sNumCalls[ENTRY_POINT_glGenVertexArrays]; generateNames( n, arrays ); }
+GLuint CODEGEN_FUNCPTR nullCreateProgram()											{ ++sNumCalls[ENTRY_POINT_glCreateProgram]; return ++sNextName; }
+GLuint CODEGEN_FUNCPTR nullCreateShader( GLenum type )								{ ++sNumCalls[ENTRY_POINT_glCreateShader]; return ++sNextName; }
+
+GLenum CODEGEN_FUNCPTR nullCheckFramebufferStatus( GLenum target )
+{
+	++sNumCalls[ENTRY_POINT_glCheckFramebufferStatus];
+	return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void* CODEGEN_FUNCPTR nullMapBufferRange( GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access )
+{
+	++sNumCalls[ENTRY_POINT_glMapBufferRange];
+	if( sMapScratch.size() < (size_t)length )
+		sMapScratch.resize( length );
+	return sMapScratch.empty() ? nullptr : &sMapScratch[0];
+}
+
+GLboolean CODEGEN_FUNCPTR nullUnmapBuffer( GLenum target )
+{
+	++sNumCalls[ENTRY_POINT_glUnmapBuffer];
+	return GL_TRUE;
+}
+
+GLsync CODEGEN_FUNCPTR nullFenceSync( GLenum condition, GLbitfield flags )
+{
+	++sNumCalls[ENTRY_POINT_glFenceSync];
+	return reinterpret_cast<GLsync>( (size_t)++sNextName );
+}
+
+GLenum CODEGEN_FUNCPTR nullClientWaitSync( GLsync sync, GLbitfield flags, GLuint64 timeout )
+{
+	++sNumCalls[ENTRY_POINT_glClientWaitSync];
+	return GL_ALREADY_SIGNALED;
+}
+
+void initEntryPoints()
+{
+#define INIT_ENTRY_POINT( name ) \
+	sEntryPoints[ENTRY_POINT_##name].mName = #name; \
+	sEntryPoints[ENTRY_POINT_##name].mFuncPtr = reinterpret_cast<GenericProc*>( &_funcptr_##name ); \
+	sEntryPoints[ENTRY_POINT_##name].mStub = reinterpret_cast<GenericProc>( &NullProc<decltype( _funcptr_##name )>::call<ENTRY_POINT_##name> );
+
+	CI_NULL_DISPATCH_ENTRY_POINTS( INIT_ENTRY_POINT )
+#undef INIT_ENTRY_POINT
+
+#define OVERRIDE_ENTRY_POINT( name, stub ) \
+	sEntryPoints[ENTRY_POINT_##name].mStub = reinterpret_cast<GenericProc>( static_cast<decltype( _funcptr_##name )>( &stub ) );
+
+	OVERRIDE_ENTRY_POINT( glGetIntegerv, nullGetIntegerv )
+	OVERRIDE_ENTRY_POINT( glGetFloatv, nullGetFloatv )
+	OVERRIDE_ENTRY_POINT( glGetShaderiv, nullGetShaderiv )
+	OVERRIDE_ENTRY_POINT( glGetProgramiv, nullGetProgramiv )
+	OVERRIDE_ENTRY_POINT( glGetShaderInfoLog, nullGetShaderInfoLog )
+	OVERRIDE_ENTRY_POINT( glGetActiveAttrib, nullGetActiveAttrib )
+	OVERRIDE_ENTRY_POINT( glGetActiveUniform, nullGetActiveUniform )
+	OVERRIDE_ENTRY_POINT( glGetProgramBinary, nullGetProgramBinary )
+	OVERRIDE_ENTRY_POINT( glGetVertexAttribiv, nullGetVertexAttribiv )
+	OVERRIDE_ENTRY_POINT( glGetTexLevelParameteriv, nullGetTexLevelParameteriv )
+	OVERRIDE_ENTRY_POINT( glGetUniformLocation, nullGetUniformLocation )
+	OVERRIDE_ENTRY_POINT( glGetAttribLocation, nullGetAttribLocation )
+	OVERRIDE_ENTRY_POINT( glGetString, nullGetString )
+	OVERRIDE_ENTRY_POINT( glGetStringi, nullGetStringi )
+	OVERRIDE_ENTRY_POINT( glGenBuffers, nullGenBuffers )
+	OVERRIDE_ENTRY_POINT( glGenFramebuffers, nullGenFramebuffers )
+	OVERRIDE_ENTRY_POINT( glGenRenderbuffers, nullGenRenderbuffers )
+	OVERRIDE_ENTRY_POINT( glGenTextures, nullGenTextures )
+	OVERRIDE_ENTRY_POINT( glGenTransformFeedbacks, nullGenTransformFeedbacks )
+	OVERRIDE_ENTRY_POINT( glGenVertexArrays, nullGenVertexArrays )
+	OVERRIDE_ENTRY_POINT( glCreateProgram, nullCreateProgram )
+	OVERRIDE_ENTRY_POINT( glCreateShader, nullCreateShader )
+	OVERRIDE_ENTRY_POINT( glCheckFramebufferStatus, nullCheckFramebufferStatus )
+	OVERRIDE_ENTRY_POINT( glMapBufferRange, nullMapBufferRange )
+	OVERRIDE_ENTRY_POINT( glUnmapBuffer, nullUnmapBuffer )
+	OVERRIDE_ENTRY_POINT( glFenceSync, nullFenceSync )
+	OVERRIDE_ENTRY_POINT( glClientWaitSync, nullClientWaitSync )
+#undef OVERRIDE_ENTRY_POINT
+}
+
+} // anonymous namespace
+
+void NullDispatch::install()
+{
+	if( sInstalled )
+		return;
+
+	if( ! sEntryPoints[0].mName )
+		initEntryPoints();
+	for( int e = 0; e < NUM_ENTRY_POINTS; ++e ) {
+		sEntryPoints[e].mSaved = *sEntryPoints[e].mFuncPtr;
+		*sEntryPoints[e].mFuncPtr = sEntryPoints[e].mStub;
+	}
+	resetCounts();
+	sInstalled = true;
+}
+
+void NullDispatch::uninstall()
+{
+	if( ! sInstalled )
+		return;
+
+	for( int e = 0; e < NUM_ENTRY_POINTS; ++e )
+		*sEntryPoints[e].mFuncPtr = sEntryPoints[e].mSaved;
+	sInstalled = false;
+}
+
+bool NullDispatch::isInstalled()
+{
+	return sInstalled;
+}
+
+uint32_t NullDispatch::getNumCalls( const std::string &name )
+{
+	for( int e = 0; e < NUM_ENTRY_POINTS; ++e ) {
+		if( sEntryPoints[e].mName && name == sEntryPoints[e].mName )
+			return sNumCalls[e];
+	}
+
+	return 0;
+}
+
+uint32_t NullDispatch::getTotalCalls()
+{
+	uint32_t result = 0;
+	for( int e = 0; e < NUM_ENTRY_POINTS; ++e )
+		result += sNumCalls[e];
+	return result;
+}
+
+void NullDispatch::resetCounts()
+{
+	std::fill( sNumCalls, sNumCalls + NUM_ENTRY_POINTS, 0 );
+}
+
+#endif // ! defined( CINDER_GL_ES )
+
+} } // namespace cinder::gl
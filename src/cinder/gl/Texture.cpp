@@ -675,12 +675,18 @@ Texture::Texture( const TextureData &data, Format format )
 	
 	replace( data );
 
-	if( format.mMipmapping && data.getNumLevels() <= 1 ) {
+	// levels supplied by \a data, such as a KTX's or generateMipmapTextureData()'s, are used as they are; a chain which stops
+	// short of 1x1 is only complete up to its last level
+	if( format.mMipmapping ) {
 #if ! defined( CINDER_GL_ES )	
 		glTexParameteri( mTarget, GL_TEXTURE_BASE_LEVEL, format.mBaseMipmapLevel );
-		glTexParameteri( mTarget, GL_TEXTURE_MAX_LEVEL, format.mMaxMipmapLevel );
+		if( data.getNumLevels() > 1 )
+			glTexParameteri( mTarget, GL_TEXTURE_MAX_LEVEL, std::min<GLint>( format.mMaxMipmapLevel, (GLint)data.getNumLevels() - 1 ) );
+		else
+			glTexParameteri( mTarget, GL_TEXTURE_MAX_LEVEL, format.mMaxMipmapLevel );
 #endif		
-		glGenerateMipmap( mTarget );
+		if( data.getNumLevels() <= 1 )
+			glGenerateMipmap( mTarget );
 	}
 }
 	
@@ -1597,6 +1603,27 @@ void* TextureData::getDataStorePtr( size_t offset ) const
 		return mDataStoreMem.get() + offset;
 }
 
+namespace {
+// Runs \a parseFn on \a textureData, uploading each level to \a texture as soon as it has been read when \a streamLevels and the sizes match; otherwise updates \a texture once parsing completes
+void updateFromParser( Texture *texture, TextureData *textureData, bool streamLevels, const std::function<void( TextureData*, const TextureDataLevelFn& )> &parseFn )
+{
+	bool streamed = false;
+	TextureDataLevelFn levelFn;
+	if( streamLevels ) {
+		levelFn = [&]( const TextureData &data, size_t levelIndex ) {
+			if( levelIndex == 0 )
+				streamed = ( data.getWidth() == texture->getWidth() ) && ( data.getHeight() == texture->getHeight() );
+			if( streamed )
+				texture->update( data, (int)levelIndex );
+		};
+	}
+
+	parseFn( textureData, levelFn );
+	if( ! streamed )
+		texture->update( *textureData );
+}
+} // anonymous namespace
+
 TextureRef Texture::createFromKtx( const DataSourceRef &dataSource, const Format &format )
 {
 #if ! defined( CINDER_GL_ES )
@@ -1617,11 +1644,14 @@ void Texture::updateFromKtx( const DataSourceRef &dataSource, const PboRef &inte
 {
 #if defined( CINDER_GL_ES )
 	TextureData textureData;
+	const bool streamLevels = true;
 #else
 	TextureData textureData( intermediatePbo );
+	const bool streamLevels = ! intermediatePbo; // the PBO stays mapped until parsing completes
 #endif
-	parseKtx( dataSource, &textureData );
-	update( textureData );
+	updateFromParser( this, &textureData, streamLevels, [&]( TextureData *resultData, const TextureDataLevelFn &levelFn ) {
+		parseKtx( dataSource, resultData, levelFn );
+	} );
 }
 
 void Texture::update( const TextureData &textureData )
@@ -1629,23 +1659,24 @@ void Texture::update( const TextureData &textureData )
 	if( textureData.getWidth() != mWidth || textureData.getHeight() != mHeight )
 		replace( textureData );
 	else {
-		ScopedTextureBind bindScope( mTarget, mTextureId );
-		if( textureData.getUnpackAlignment() != 0 )
-			glPixelStorei( GL_UNPACK_ALIGNMENT, textureData.getUnpackAlignment() );
-
-		int curLevel = 0;
-		for( const auto &textureDataLevel : textureData.getLevels() ) {		
-			if( textureData.getDataType() != 0 )
-				glTexSubImage2D( mTarget, curLevel, 0, 0, textureDataLevel.width, textureDataLevel.height, textureData.getDataFormat(), textureData.getDataType(), textureData.getDataStorePtr( textureDataLevel.offset ) );
-			else
-				glCompressedTexSubImage2D( mTarget, curLevel, 0, 0, textureDataLevel.width, textureDataLevel.height, textureData.getInternalFormat(), textureDataLevel.dataSize, textureData.getDataStorePtr( textureDataLevel.offset ) );
-			++curLevel;
-		}
-		if( textureData.getUnpackAlignment() != 0 )
-			glPixelStorei( GL_UNPACK_ALIGNMENT, textureData.getUnpackAlignment() );
+		for( size_t level = 0; level < textureData.getNumLevels(); ++level )
+			update( textureData, (int)level );
 	}
 }
 
+void Texture::update( const TextureData &textureData, int mipLevel )
+{
+	ScopedTextureBind bindScope( mTarget, mTextureId );
+	if( textureData.getUnpackAlignment() != 0 )
+		glPixelStorei( GL_UNPACK_ALIGNMENT, textureData.getUnpackAlignment() );
+
+	const TextureData::Level &textureDataLevel = textureData.getLevel( mipLevel );
+	if( textureData.getDataType() != 0 )
+		glTexSubImage2D( mTarget, mipLevel, 0, 0, textureDataLevel.width, textureDataLevel.height, textureData.getDataFormat(), textureData.getDataType(), textureData.getDataStorePtr( textureDataLevel.offset ) );
+	else
+		glCompressedTexSubImage2D( mTarget, mipLevel, 0, 0, textureDataLevel.width, textureDataLevel.height, textureData.getInternalFormat(), textureDataLevel.dataSize, textureData.getDataStorePtr( textureDataLevel.offset ) );
+}
+
 void Texture::replace( const TextureData &textureData )
 {
 	mCleanWidth = mWidth = textureData.getWidth();
@@ -1697,12 +1728,15 @@ void Texture::updateFromDds( const DataSourceRef &dataSource, const PboRef &inte
 {
 #if defined( CINDER_GL_ES )
 	TextureData textureData;
+	const bool streamLevels = true;
 #else
 	TextureData textureData( intermediatePbo );
+	const bool streamLevels = ! intermediatePbo; // the PBO stays mapped until parsing completes
 #endif
 
-	parseDds( dataSource, &textureData );
-	update( textureData );
+	updateFromParser( this, &textureData, streamLevels, [&]( TextureData *resultData, const TextureDataLevelFn &levelFn ) {
+		parseDds( dataSource, resultData, levelFn );
+	} );
 }
 #endif // ! defined( CINDER_GL_ES ) || defined( CINDER_GL_ANGLE )
 
@@ -38,7 +38,10 @@
 	#endif
 #endif
 #include "cinder/Unicode.h"
+#include "cinder/GlyphAtlas.h"
+#include "cinder/Thread.h"
 
+#include <deque>
 #include <set>
 
 #if defined( _MSC_VER ) && ( _MSC_VER >= 1600 ) || defined( _LIBCPP_VERSION )
@@ -57,6 +60,11 @@ TextureFont::TextureFont( const Font &font, const string &supportedChars, const
 {
 	// get the glyph indices we'll need
 	vector<Font::Glyph>	tempGlyphs = font.getGlyphs( supportedChars );
+	if( mFormat.isDynamicAtlas() ) {
+		startDynamicAtlas( tempGlyphs );
+		return;
+	}
+
 	set<Font::Glyph> glyphs( tempGlyphs.begin(), tempGlyphs.end() );
 	// determine the max glyph extents
 	Vec2f glyphExtents = Vec2f::zero();
@@ -208,6 +216,11 @@ TextureFont::TextureFont( const Font &font, const string &utf8Chars, const Forma
 {
 	// get the glyph indices we'll need
 	set<Font::Glyph> glyphs = getNecessaryGlyphs( font, utf8Chars );
+	if( mFormat.isDynamicAtlas() ) {
+		startDynamicAtlas( vector<Font::Glyph>( glyphs.begin(), glyphs.end() ) );
+		return;
+	}
+
 	// determine the max glyph extents
 	Vec2i glyphExtents = Vec2f::zero();
 	for( set<Font::Glyph>::const_iterator glyphIt = glyphs.begin(); glyphIt != glyphs.end(); ++glyphIt ) {
@@ -316,8 +329,264 @@ TextureFont::TextureFont( const Font &font, const string &utf8Chars, const Forma
 }
 #endif
 
+namespace {
+
+// a glyph rasterized by a dynamic atlas' worker thread; mOriginOffset is relative to the font's ascent, as GlyphInfo's is
+struct RasterizedGlyph {
+	Font::Glyph		mGlyph;
+	Channel8u		mCoverage;
+	Vec2f			mOriginOffset;
+};
+
+#if defined( CINDER_COCOA )
+// renders each glyph into its own alpha-only bitmap context, which is safe off the main thread
+class GlyphRasterizer {
+  public:
+	GlyphRasterizer( const Font &font ) : mFont( font ) {}
+
+	void rasterize( Font::Glyph glyph, RasterizedGlyph *result )
+	{
+		const Rectf bb = mFont.getGlyphBoundingBox( glyph );
+		if( ( bb.getWidth() <= 0 ) || ( bb.getHeight() <= 0 ) )
+			return;
+
+		// a pixel of margin around the bounding box for antialiasing
+		const int32_t x1 = (int32_t)floor( bb.x1 ) - 1, y1 = (int32_t)floor( bb.y1 ) - 1;
+		const int32_t x2 = (int32_t)ceil( bb.x2 ) + 1, y2 = (int32_t)ceil( bb.y2 ) + 1;
+		Channel8u coverage( x2 - x1, y2 - y1 );
+		ip::fill<uint8_t>( &coverage, 0 );
+		::CGContextRef cgContext = ::CGBitmapContextCreate( coverage.getData(), coverage.getWidth(), coverage.getHeight(), 8, coverage.getRowBytes(), NULL, (CGBitmapInfo)kCGImageAlphaOnly );
+		::CGContextSetGrayFillColor( cgContext, 1, 1 );
+		::CGContextSetFont( cgContext, mFont.getCgFontRef() );
+		::CGContextSetFontSize( cgContext, mFont.getSize() );
+		::CGContextSetTextMatrix( cgContext, CGAffineTransformIdentity );
+		CGGlyph cgGlyph = glyph;
+		CGPoint position = CGPointMake( -x1, -y1 );
+		::CGContextShowGlyphsAtPositions( cgContext, &cgGlyph, &position, 1 );
+		::CGContextRelease( cgContext );
+
+		// the bitmap's top row is y2 above the baseline
+		result->mCoverage = coverage;
+		result->mOriginOffset = Vec2f( (float)x1, mFont.getAscent() - y2 );
+	}
+
+  private:
+	const Font		&mFont;
+};
+#elif defined( CINDER_MSW )
+// renders glyphs through a DC of its own, since Font::getGlobalDc() belongs to the main thread
+class GlyphRasterizer {
+  public:
+	GlyphRasterizer( const Font &font )
+		: mFont( font ), mDc( ::CreateCompatibleDC( NULL ) )
+	{
+		::SelectObject( mDc, mFont.getHfont() );
+	}
+
+	~GlyphRasterizer()
+	{
+		::DeleteDC( mDc );
+	}
+
+	void rasterize( Font::Glyph glyph, RasterizedGlyph *result )
+	{
+		GLYPHMETRICS gm = { 0, };
+		MAT2 identityMatrix = { {0,1},{0,0},{0,0},{0,1} };
+		DWORD bufferSize = ::GetGlyphOutline( mDc, glyph, GGO_GRAY8_BITMAP | GGO_GLYPH_INDEX, &gm, 0, NULL, &identityMatrix );
+		if( ( bufferSize == 0 ) || ( bufferSize == GDI_ERROR ) )
+			return;
+		mBuffer.resize( bufferSize );
+		if( ::GetGlyphOutline( mDc, glyph, GGO_GRAY8_BITMAP | GGO_GLYPH_INDEX, &gm, bufferSize, &mBuffer[0], &identityMatrix ) == GDI_ERROR )
+			return;
+
+		// rows are DWORD aligned, with 6bit gray
+		const int32_t alignedRowBytes = ( gm.gmBlackBoxX + 3 ) & ~3;
+		Channel8u coverage( gm.gmBlackBoxX, gm.gmBlackBoxY );
+		for( int32_t y = 0; y < (int32_t)gm.gmBlackBoxY; ++y ) {
+			const BYTE *src = &mBuffer[y * alignedRowBytes];
+			uint8_t *dst = coverage.getData( 0, y );
+			for( int32_t x = 0; x < (int32_t)gm.gmBlackBoxX; ++x )
+				dst[x] = ((uint32_t)src[x]) * 255 / 64;
+		}
+
+		result->mCoverage = coverage;
+		result->mOriginOffset = Vec2f( (float)gm.gmptGlyphOrigin.x, mFont.getAscent() - gm.gmptGlyphOrigin.y );
+	}
+
+  private:
+	const Font			&mFont;
+	HDC					mDc;
+	std::vector<BYTE>	mBuffer;
+};
+#else
+// no platform rasterizer; every glyph comes out empty
+class GlyphRasterizer {
+  public:
+	GlyphRasterizer( const Font &/*font*/ ) {}
+
+	void rasterize( Font::Glyph /*glyph*/, RasterizedGlyph * /*result*/ ) {}
+};
+#endif
+
+} // anonymous namespace
+
+struct TextureFont::DynamicAtlas {
+	DynamicAtlas( const Font &font, const Format &format )
+		: mFont( font ), mAtlas( format.getTextureWidth(), format.getTextureHeight(), std::min<size_t>( format.getMaxTextures(), 256 ), 2 ), mShouldQuit( false )
+	{
+		mThread = std::thread( std::bind( &DynamicAtlas::workerLoop, this ) );
+	}
+
+	~DynamicAtlas()
+	{
+		{
+			lock_guard<mutex> lock( mMutex );
+			mShouldQuit = true;
+		}
+		mQueueCond.notify_all();
+		mThread.join();
+	}
+
+	void workerLoop()
+	{
+		ThreadSetup threadSetup;
+		GlyphRasterizer rasterizer( mFont );
+
+		while( true ) {
+			RasterizedGlyph rasterized;
+			{
+				unique_lock<mutex> lock( mMutex );
+				while( mQueue.empty() && ! mShouldQuit )
+					mQueueCond.wait( lock );
+				if( mShouldQuit )
+					return;
+				rasterized.mGlyph = mQueue.front();
+				mQueue.pop_front();
+			}
+
+			rasterizer.rasterize( rasterized.mGlyph, &rasterized );
+
+			lock_guard<mutex> lock( mMutex );
+			mRasterized.push_back( rasterized );
+		}
+	}
+
+	Font						mFont;
+	GlyphAtlas					mAtlas;
+	set<Font::Glyph>			mRequested; // queued or rasterized but not yet in mAtlas; main thread only
+	mutex						mMutex;
+	condition_variable			mQueueCond;
+	deque<Font::Glyph>			mQueue;
+	vector<RasterizedGlyph>		mRasterized;
+	bool						mShouldQuit;
+	std::thread					mThread;
+};
+
+TextureFont::~TextureFont()
+{
+}
+
+size_t TextureFont::getNumPendingGlyphs() const
+{
+	return mDynamicAtlas ? mDynamicAtlas->mRequested.size() : 0;
+}
+
+void TextureFont::startDynamicAtlas( const vector<Font::Glyph> &glyphs )
+{
+	mDynamicAtlas.reset( new DynamicAtlas( mFont, mFormat ) );
+	{
+		lock_guard<mutex> lock( mDynamicAtlas->mMutex );
+		for( vector<Font::Glyph>::const_iterator glyphIt = glyphs.begin(); glyphIt != glyphs.end(); ++glyphIt ) {
+			if( mDynamicAtlas->mRequested.insert( *glyphIt ).second )
+				mDynamicAtlas->mQueue.push_back( *glyphIt );
+		}
+	}
+	mDynamicAtlas->mQueueCond.notify_one();
+}
+
+void TextureFont::updateDynamicAtlas( const vector<pair<uint16_t,Vec2f> > &glyphMeasures )
+{
+	GlyphAtlas &atlas = mDynamicAtlas->mAtlas;
+
+	// mark the glyphs already in the atlas as used before any new ones can evict them, and request the rest
+	atlas.beginUse();
+	vector<Font::Glyph> requests;
+	for( vector<pair<uint16_t,Vec2f> >::const_iterator glyphIt = glyphMeasures.begin(); glyphIt != glyphMeasures.end(); ++glyphIt ) {
+		if( ( ! atlas.find( glyphIt->first ) ) && mDynamicAtlas->mRequested.insert( glyphIt->first ).second )
+			requests.push_back( glyphIt->first );
+	}
+
+	vector<RasterizedGlyph> rasterized;
+	{
+		lock_guard<mutex> lock( mDynamicAtlas->mMutex );
+		mDynamicAtlas->mQueue.insert( mDynamicAtlas->mQueue.end(), requests.begin(), requests.end() );
+		rasterized.swap( mDynamicAtlas->mRasterized );
+	}
+	if( ! requests.empty() )
+		mDynamicAtlas->mQueueCond.notify_one();
+
+	for( vector<RasterizedGlyph>::const_iterator rasterIt = rasterized.begin(); rasterIt != rasterized.end(); ++rasterIt ) {
+		mDynamicAtlas->mRequested.erase( rasterIt->mGlyph );
+		const GlyphAtlas::Entry *entry = atlas.insert( rasterIt->mGlyph, rasterIt->mCoverage, rasterIt->mOriginOffset );
+		const vector<GlyphAtlas::Glyph> evicted = atlas.takeEvicted();
+		for( vector<GlyphAtlas::Glyph>::const_iterator evictedIt = evicted.begin(); evictedIt != evicted.end(); ++evictedIt )
+			mGlyphMap.erase( *evictedIt );
+		// a glyph which didn't fit is requested again the next time it's drawn
+		if( entry ) {
+			GlyphInfo &info = mGlyphMap[rasterIt->mGlyph];
+			info.mTextureIndex = (uint8_t)entry->mPage;
+			info.mTexCoords = entry->mArea;
+			info.mOriginOffset = entry->mOriginOffset;
+		}
+	}
+
+	// upload what changed as luminance-alpha, like the static atlas
+	gl::Texture::Format textureFormat = gl::Texture::Format();
+	textureFormat.enableMipmapping( mFormat.hasMipmapping() );
+#if defined( CINDER_GL_ES )
+	const GLenum dataFormat = GL_LUMINANCE_ALPHA;
+	textureFormat.setInternalFormat( dataFormat );
+#else
+	const GLenum dataFormat = GL_RG;
+	textureFormat.setInternalFormat( dataFormat );
+	textureFormat.setSwizzleMask( { GL_RED, GL_RED, GL_RED, GL_GREEN } );
+#endif
+	vector<uint8_t> lumAlphaData;
+	for( size_t page = 0; page < atlas.getNumPages(); ++page ) {
+		const Area dirtyArea = atlas.getDirtyArea( page );
+		if( dirtyArea.calcArea() == 0 )
+			continue;
+
+		lumAlphaData.resize( dirtyArea.calcArea() * 2 );
+		const Channel8u &coverage = atlas.getPage( page );
+		size_t offset = 0;
+		for( int32_t y = dirtyArea.y1; y < dirtyArea.y2; ++y ) {
+			const uint8_t *src = coverage.getData( dirtyArea.x1, y );
+			for( int32_t x = 0; x < dirtyArea.getWidth(); ++x, offset += 2 ) {
+				lumAlphaData[offset+0] = ( mFormat.getPremultiply() || ( src[x] == 0 ) ) ? src[x] : 255;
+				lumAlphaData[offset+1] = src[x];
+			}
+		}
+
+		// a new page is dirty in its entirety
+		if( page == mTextures.size() )
+			mTextures.push_back( gl::Texture::create( lumAlphaData.data(), dataFormat, atlas.getPageWidth(), atlas.getPageHeight(), textureFormat ) );
+		else {
+			ScopedTextureBind texBindScp( mTextures[page] );
+			glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+			glTexSubImage2D( mTextures[page]->getTarget(), 0, dirtyArea.x1, dirtyArea.y1, dirtyArea.getWidth(), dirtyArea.getHeight(), dataFormat, GL_UNSIGNED_BYTE, lumAlphaData.data() );
+			if( mFormat.hasMipmapping() )
+				glGenerateMipmap( mTextures[page]->getTarget() );
+		}
+		atlas.clearDirtyArea( page );
+	}
+}
+
 void TextureFont::drawGlyphs( const vector<pair<uint16_t,Vec2f> > &glyphMeasures, const Vec2f &baselineIn, const DrawOptions &options, const std::vector<ColorA8u> &colors )
 {
+	if( mDynamicAtlas )
+		updateDynamicAtlas( glyphMeasures );
+
 	if( mTextures.empty() )
 		return;
 
@@ -394,45 +663,51 @@ void TextureFont::drawGlyphs( const vector<pair<uint16_t,Vec2f> > &glyphMeasures
 		ctx->pushVao();
 		ctx->getDefaultVao()->replacementBindBegin();
 		VboRef defaultElementVbo = ctx->getDefaultElementVbo( indices.size() * sizeof(curIdx) );
-		VboRef defaultArrayVbo = ctx->getDefaultArrayVbo( dataSize );
+		size_t streamOffset;
+		uint8_t *arrayData = reinterpret_cast<uint8_t*>( ctx->streamArrayBegin( dataSize, &streamOffset ) );
 
-		ScopedBuffer vboArrayScp( defaultArrayVbo );
+		ScopedBuffer vboArrayScp( ctx->getStreamArrayVbo() );
 		ScopedBuffer vboElScp( defaultElementVbo );
 
 		size_t dataOffset = 0;
 		int posLoc = shader->getAttribSemanticLocation( geom::Attrib::POSITION );
 		if( posLoc >= 0 ) {
 			enableVertexAttribArray( posLoc );
-			vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
-			defaultArrayVbo->bufferSubData( dataOffset, verts.size() * sizeof(float), verts.data() );
+			vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)(streamOffset + dataOffset) );
+			memcpy( arrayData + dataOffset, verts.data(), verts.size() * sizeof(float) );
 			dataOffset += verts.size() * sizeof(float);
 		}
 		int texLoc = shader->getAttribSemanticLocation( geom::Attrib::TEX_COORD_0 );
 		if( texLoc >= 0 ) {
 			enableVertexAttribArray( texLoc );
-			vertexAttribPointer( texLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)dataOffset );
-			defaultArrayVbo->bufferSubData( dataOffset, texCoords.size() * sizeof(float), texCoords.data() );
+			vertexAttribPointer( texLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)(streamOffset + dataOffset) );
+			memcpy( arrayData + dataOffset, texCoords.data(), texCoords.size() * sizeof(float) );
 			dataOffset += texCoords.size() * sizeof(float);
 		}
 		if( ! vertColors.empty() ) {
 			int colorLoc = shader->getAttribSemanticLocation( geom::Attrib::COLOR );
 			if( colorLoc >= 0 ) {
 				enableVertexAttribArray( colorLoc );
-				vertexAttribPointer( colorLoc, 4, GL_UNSIGNED_BYTE, GL_FALSE, 0, (void*)dataOffset );
-				defaultArrayVbo->bufferSubData( dataOffset, vertColors.size() * sizeof(ColorA8u), vertColors.data() );
+				vertexAttribPointer( colorLoc, 4, GL_UNSIGNED_BYTE, GL_FALSE, 0, (void*)(streamOffset + dataOffset) );
+				memcpy( arrayData + dataOffset, vertColors.data(), vertColors.size() * sizeof(ColorA8u) );
 				dataOffset += vertColors.size() * sizeof(ColorA8u);				
 			}
 		}
+		ctx->streamArrayEnd();
 
 		defaultElementVbo->bufferSubData( 0, indices.size() * sizeof(curIdx), indices.data() );
 		ctx->getDefaultVao()->replacementBindEnd();
 		gl::setDefaultShaderVars();
 		ctx->drawElements( GL_TRIANGLES, indices.size(), indexType, 0 );
+		ctx->popVao();
 	}
 }
 
 void TextureFont::drawGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures, const Rectf &clip, Vec2f offset, const DrawOptions &options, const std::vector<ColorA8u> &colors )
 {
+	if( mDynamicAtlas )
+		updateDynamicAtlas( glyphMeasures );
+
 	if( mTextures.empty() )
 		return;
 
@@ -528,40 +803,43 @@ void TextureFont::drawGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &gly
 		ctx->pushVao();
 		ctx->getDefaultVao()->replacementBindBegin();
 		VboRef defaultElementVbo = ctx->getDefaultElementVbo( indices.size() * sizeof(curIdx) );
-		VboRef defaultArrayVbo = ctx->getDefaultArrayVbo( dataSize );
+		size_t streamOffset;
+		uint8_t *arrayData = reinterpret_cast<uint8_t*>( ctx->streamArrayBegin( dataSize, &streamOffset ) );
 
-		ScopedBuffer vboArrayScp( defaultArrayVbo );
+		ScopedBuffer vboArrayScp( ctx->getStreamArrayVbo() );
 		ScopedBuffer vboElScp( defaultElementVbo );
 
 		size_t dataOffset = 0;
 		int posLoc = shader->getAttribSemanticLocation( geom::Attrib::POSITION );
 		if( posLoc >= 0 ) {
 			enableVertexAttribArray( posLoc );
-			vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
-			defaultArrayVbo->bufferSubData( dataOffset, verts.size() * sizeof(float), verts.data() );
+			vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)(streamOffset + dataOffset) );
+			memcpy( arrayData + dataOffset, verts.data(), verts.size() * sizeof(float) );
 			dataOffset += verts.size() * sizeof(float);
 		}
 		int texLoc = shader->getAttribSemanticLocation( geom::Attrib::TEX_COORD_0 );
 		if( texLoc >= 0 ) {
 			enableVertexAttribArray( texLoc );
-			vertexAttribPointer( texLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)dataOffset );
-			defaultArrayVbo->bufferSubData( dataOffset, texCoords.size() * sizeof(float), texCoords.data() );
+			vertexAttribPointer( texLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)(streamOffset + dataOffset) );
+			memcpy( arrayData + dataOffset, texCoords.data(), texCoords.size() * sizeof(float) );
 			dataOffset += texCoords.size() * sizeof(float);
 		}
 		if( ! vertColors.empty() ) {
 			int colorLoc = shader->getAttribSemanticLocation( geom::Attrib::COLOR );
 			if( colorLoc >= 0 ) {
 				enableVertexAttribArray( colorLoc );
-				vertexAttribPointer( colorLoc, 4, GL_UNSIGNED_BYTE, GL_FALSE, 0, (void*)dataOffset );
-				defaultArrayVbo->bufferSubData( dataOffset, vertColors.size() * sizeof(ColorA8u), vertColors.data() );
+				vertexAttribPointer( colorLoc, 4, GL_UNSIGNED_BYTE, GL_FALSE, 0, (void*)(streamOffset + dataOffset) );
+				memcpy( arrayData + dataOffset, vertColors.data(), vertColors.size() * sizeof(ColorA8u) );
 				dataOffset += vertColors.size() * sizeof(ColorA8u);				
 			}
 		}
+		ctx->streamArrayEnd();
 
 		defaultElementVbo->bufferSubData( 0, indices.size() * sizeof(curIdx), indices.data() );
 		ctx->getDefaultVao()->replacementBindEnd();
 		gl::setDefaultShaderVars();
 		ctx->drawElements( GL_TRIANGLES, indices.size(), indexType, 0 );
+		ctx->popVao();
 	}
 }
 
@@ -598,6 +876,16 @@ Vec2f TextureFont::measureString( const std::string &str, const DrawOptions &opt
 		unordered_map<Font::Glyph, GlyphInfo>::const_iterator glyphInfoIt = mGlyphMap.find( glyphMeasures.back().first );
 		if( glyphInfoIt != mGlyphMap.end() )
 			result += glyphInfoIt->second.mOriginOffset + glyphInfoIt->second.mTexCoords.getSize();
+#if defined( CINDER_MSW )
+		else if( mDynamicAtlas ) {
+			// not rasterized yet, so measure it from its metrics as GlyphRasterizer will place it
+			GLYPHMETRICS gm = { 0, };
+			MAT2 identityMatrix = { {0,1},{0,0},{0,0},{0,1} };
+			::SelectObject( Font::getGlobalDc(), mFont.getHfont() );
+			if( ::GetGlyphOutline( Font::getGlobalDc(), glyphMeasures.back().first, GGO_METRICS | GGO_GLYPH_INDEX, &gm, 0, NULL, &identityMatrix ) != GDI_ERROR )
+				result += Vec2f( (float)( gm.gmptGlyphOrigin.x + (int)gm.gmBlackBoxX ), mFont.getAscent() - gm.gmptGlyphOrigin.y + (int)gm.gmBlackBoxY );
+		}
+#endif
 		return result;
 	}
 	else {
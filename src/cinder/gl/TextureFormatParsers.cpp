@@ -22,6 +22,9 @@
 */
 
 #include "cinder/gl/TextureFormatParsers.h"
+#include "cinder/ip/Mipmap.h"
+
+#include <type_traits>
 
 #if defined( CINDER_GL_ANGLE )
 #define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT	GL_COMPRESSED_RGBA_S3TC_DXT3_ANGLE
@@ -30,7 +33,7 @@
 
 namespace cinder { namespace gl {
 
-void parseKtx( const DataSourceRef &dataSource, TextureData *resultData )
+void parseKtx( const DataSourceRef &dataSource, TextureData *resultData, const TextureDataLevelFn &levelFn )
 {
 	typedef struct {
 		uint8_t		identifier[12];
@@ -115,13 +118,16 @@ void parseKtx( const DataSourceRef &dataSource, TextureData *resultData )
 			}
 		}
 		ktxStream->seekRelative( 3 - (imageSize + 3) % 4 );
+
+		if( levelFn )
+			levelFn( *resultData, resultData->getNumLevels() - 1 );
 	}
 
 	resultData->unmapDataStore();
 }
 
 #if ! defined( CINDER_GL_ES ) || defined( CINDER_GL_ANGLE )
-void parseDds( const DataSourceRef &dataSource, TextureData *resultData )
+void parseDds( const DataSourceRef &dataSource, TextureData *resultData, const TextureDataLevelFn &levelFn )
 {
 	typedef struct { // DDCOLORKEY
 		uint32_t dw1;
@@ -254,7 +260,8 @@ void parseDds( const DataSourceRef &dataSource, TextureData *resultData )
 	resultData->setHeight( ddsd.dwHeight );
 	resultData->setDepth( 1 );
 
-	int numMipMaps = ddsd.dwMipMapCount;
+	// dwMipMapCount includes the top level, and is 0 in files without mipmaps
+	const int numLevels = std::max<int>( 1, ddsd.dwMipMapCount );
 	int dataFormat;
 	size_t blockSizeBytes = 16;
 	switch( ddsd.ddpfPixelFormat.dwFourCC ) { 
@@ -332,13 +339,13 @@ void parseDds( const DataSourceRef &dataSource, TextureData *resultData )
 
 	// calculate the space we need
 	uint32_t spaceRequired = 0;
-	for( int level = 0; level <= numMipMaps && (ddsd.dwWidth || ddsd.dwHeight); ++level )
+	for( int level = 0; level < numLevels && (ddsd.dwWidth || ddsd.dwHeight); ++level )
 		spaceRequired += calcImageLevelSize( level );
 	resultData->allocateDataStore( spaceRequired );
 
 	resultData->mapDataStore();
 	size_t byteOffset = 0;
-	for( int level = 0; level <= numMipMaps && (ddsd.dwWidth || ddsd.dwHeight); ++level ) { 
+	for( int level = 0; level < numLevels && (ddsd.dwWidth || ddsd.dwHeight); ++level ) { 
 		int levelWidth = std::max<int>( 1, (ddsd.dwWidth>>level) );
 		int levelHeight = std::max<int>( 1, (ddsd.dwHeight>>level) );
 		const uint32_t imageSize = calcImageLevelSize( level );
@@ -354,10 +361,96 @@ void parseDds( const DataSourceRef &dataSource, TextureData *resultData )
 
 		ddsStream->readDataAvailable( resultData->getDataStorePtr( byteOffset ), imageSize );
 		byteOffset += imageSize;
+
+		if( levelFn )
+			levelFn( *resultData, resultData->getNumLevels() - 1 );
 	}
 
 	resultData->unmapDataStore();
 }
 #endif // ! defined( CINDER_GL_ES ) || defined( CINDER_GL_ANGLE )
 
-} } // namespace cinder::gl
\ No newline at end of file
+namespace {
+
+template<typename T>
+void generateMipmapTextureDataImpl( const SurfaceT<T> &surface, TextureData *resultData, const FilterBase &filter, bool srgb )
+{
+	std::vector<SurfaceT<T> > levels = ip::generateMipmaps( surface, filter, srgb );
+	levels.insert( levels.begin(), surface );
+
+	const bool alpha = surface.hasAlpha();
+	const size_t numChannels = alpha ? 4 : 3;
+	size_t spaceRequired = 0;
+	for( const auto &level : levels )
+		spaceRequired += level.getWidth() * level.getHeight() * numChannels * sizeof(T);
+
+	resultData->setWidth( surface.getWidth() );
+	resultData->setHeight( surface.getHeight() );
+	resultData->setDepth( 1 );
+	resultData->setDataFormat( alpha ? GL_RGBA : GL_RGB );
+	resultData->setUnpackAlignment( 1 );
+	if( std::is_same<T,float>::value ) {
+		resultData->setDataType( GL_FLOAT );
+#if defined( CINDER_GL_ES )
+		resultData->setInternalFormat( alpha ? GL_RGBA : GL_RGB );
+#else
+		resultData->setInternalFormat( alpha ? GL_RGBA32F : GL_RGB32F );
+#endif
+	}
+	else {
+		resultData->setDataType( GL_UNSIGNED_BYTE );
+#if defined( CINDER_GL_ES )
+		resultData->setInternalFormat( alpha ? GL_RGBA : GL_RGB );
+#else
+		if( srgb )
+			resultData->setInternalFormat( alpha ? GL_SRGB8_ALPHA8 : GL_SRGB8 );
+		else
+			resultData->setInternalFormat( alpha ? GL_RGBA8 : GL_RGB8 );
+#endif
+	}
+
+	resultData->clear();
+	resultData->allocateDataStore( spaceRequired );
+	resultData->mapDataStore();
+	size_t byteOffset = 0;
+	for( const auto &level : levels ) {
+		const int32_t width = level.getWidth(), height = level.getHeight();
+		const size_t levelSize = width * height * numChannels * sizeof(T);
+		resultData->push_back( TextureData::Level() );
+		resultData->back().dataSize = levelSize;
+		resultData->back().offset = byteOffset;
+		resultData->back().width = width;
+		resultData->back().height = height;
+		resultData->back().depth = 0;
+
+		// repack from the Surface's channel order and row bytes
+		const SurfaceChannelOrder &channelOrder = level.getChannelOrder();
+		const uint8_t pixelInc = channelOrder.getPixelInc();
+		const uint8_t offsets[4] = { channelOrder.getRedOffset(), channelOrder.getGreenOffset(), channelOrder.getBlueOffset(), alpha ? channelOrder.getAlphaOffset() : (uint8_t)0 };
+		T *dst = reinterpret_cast<T*>( resultData->getDataStorePtr( byteOffset ) );
+		for( int32_t y = 0; y < height; ++y ) {
+			const T *src = level.getData( Vec2i( 0, y ) );
+			for( int32_t x = 0; x < width; ++x, src += pixelInc, dst += numChannels ) {
+				for( size_t c = 0; c < numChannels; ++c )
+					dst[c] = src[offsets[c]];
+			}
+		}
+		byteOffset += levelSize;
+	}
+
+	resultData->unmapDataStore();
+}
+
+} // anonymous namespace
+
+void generateMipmapTextureData( const Surface8u &surface, TextureData *resultData, const FilterBase &filter, bool srgb )
+{
+	generateMipmapTextureDataImpl( surface, resultData, filter, srgb );
+}
+
+void generateMipmapTextureData( const Surface32f &surface, TextureData *resultData, const FilterBase &filter, bool srgb )
+{
+	generateMipmapTextureDataImpl( surface, resultData, filter, srgb );
+}
+
+} } // namespace cinder::gl
@@ -56,7 +56,15 @@ class VboMeshSource : public geom::Source {
 class VboMeshGeomTarget : public geom::Target {
   public:
 	VboMeshGeomTarget( geom::Primitive prim, const geom::BufferLayout &bufferLayout, uint8_t *data, VboMesh *vboMesh )
-		: mPrimitive( prim ), mBufferLayout( bufferLayout ), mData( data ), mVboMesh( vboMesh )
+		: mPrimitive( prim ), mVboMesh( vboMesh )
+	{
+		mBufferLayouts.push_back( make_pair( &bufferLayout, data ) );
+		mVboMesh->mNumIndices = 0; // this may be replaced later with a copyIndices call
+	}
+
+	//! Target which distributes attributes across several (BufferLayout,data) pairs, converting to each layout's geom::DataType
+	VboMeshGeomTarget( geom::Primitive prim, const std::vector<std::pair<const geom::BufferLayout*,uint8_t*>> &bufferLayouts, VboMesh *vboMesh )
+		: mPrimitive( prim ), mBufferLayouts( bufferLayouts ), mVboMesh( vboMesh )
 	{
 		mVboMesh->mNumIndices = 0; // this may be replaced later with a copyIndices call
 	}
@@ -67,10 +75,9 @@ class VboMeshGeomTarget : public geom::Target {
 	virtual void copyIndices( geom::Primitive primitive, const uint32_t *source, size_t numIndices, uint8_t requiredBytesPerIndex ) override;
 	
   protected:
-	geom::Primitive				mPrimitive;
-	const geom::BufferLayout	&mBufferLayout;
-	uint8_t						*mData;
-	VboMesh						*mVboMesh;
+	geom::Primitive												mPrimitive;
+	std::vector<std::pair<const geom::BufferLayout*,uint8_t*>>	mBufferLayouts;
+	VboMesh														*mVboMesh;
 };
 
 geom::Primitive	VboMeshGeomTarget::getPrimitive() const
@@ -80,15 +87,22 @@ geom::Primitive	VboMeshGeomTarget::getPrimitive() const
 
 uint8_t	VboMeshGeomTarget::getAttribDims( geom::Attrib attr ) const
 {
-	return mBufferLayout.getAttribDims( attr );
+	for( const auto &bufferLayout : mBufferLayouts ) {
+		if( bufferLayout.first->hasAttrib( attr ) )
+			return bufferLayout.first->getAttribDims( attr );
+	}
+	
+	return 0;
 }
 
 void VboMeshGeomTarget::copyAttrib( geom::Attrib attr, uint8_t dims, size_t strideBytes, const float *srcData, size_t count )
 {
-//	mMesh->copyAttrib( attr, dims, strideBytes, srcData, count );
-	if( mBufferLayout.hasAttrib( attr ) ) {
-		geom::AttribInfo attrInfo = mBufferLayout.getAttribInfo( attr );
-		geom::copyData( dims, srcData, count, attrInfo.getDims(), attrInfo.getStride(), reinterpret_cast<float*>( mData + attrInfo.getOffset() ) ); 
+	for( const auto &bufferLayout : mBufferLayouts ) {
+		if( bufferLayout.first->hasAttrib( attr ) ) {
+			geom::AttribInfo attrInfo = bufferLayout.first->getAttribInfo( attr );
+			geom::copyData( dims, srcData, count, attrInfo.getDims(), attrInfo.getDataType(), attrInfo.getStride(), bufferLayout.second + attrInfo.getOffset() );
+			return;
+		}
 	}
 }
 
@@ -170,6 +184,11 @@ VboMeshRef VboMesh::create( uint32_t numVertices, GLenum glPrimitive, const std:
 	return VboMeshRef( new VboMesh( numVertices, numIndices, glPrimitive, indexType, vertexArrayLayouts, indexVbo ) );
 }
 
+VboMeshRef VboMesh::create( const geom::Source &source, const std::vector<Layout> &vertexArrayLayouts )
+{
+	return VboMeshRef( new VboMesh( source, vertexArrayLayouts ) );
+}
+
 VboMesh::VboMesh( const geom::Source &source, const VboRef &arrayVbo, const VboRef &indexArrayVbo )
 {
 	mNumVertices = source.getNumVertices();
@@ -204,6 +223,32 @@ VboMesh::VboMesh( const geom::Source &source, const VboRef &arrayVbo, const VboR
 	mVertexArrayVbos.push_back( make_pair( bufferLayout, vertexDataVbo ) );
 }
 
+VboMesh::VboMesh( const geom::Source &source, const std::vector<Layout> &vertexArrayLayouts )
+{
+	mNumVertices = source.getNumVertices();
+	mGlPrimitive = toGl( source.getPrimitive() );
+
+	// allocate a VBO per Layout, plus a matching CPU-side buffer for the target to convert into
+	std::vector<std::unique_ptr<uint8_t[]>> buffers;
+	for( const auto &layout : vertexArrayLayouts ) {
+		geom::BufferLayout bufferLayout;
+		VboRef vbo;
+		layout.allocate( mNumVertices, &bufferLayout, &vbo );
+		mVertexArrayVbos.push_back( make_pair( bufferLayout, vbo ) );
+		buffers.push_back( std::unique_ptr<uint8_t[]>( new uint8_t[vbo->getSize()] ) );
+	}
+
+	std::vector<std::pair<const geom::BufferLayout*,uint8_t*>> targetLayouts;
+	for( size_t i = 0; i < mVertexArrayVbos.size(); ++i )
+		targetLayouts.push_back( make_pair( &mVertexArrayVbos[i].first, buffers[i].get() ) );
+
+	VboMeshGeomTarget target( source.getPrimitive(), targetLayouts, this );
+	source.loadInto( &target );
+
+	for( size_t i = 0; i < mVertexArrayVbos.size(); ++i )
+		mVertexArrayVbos[i].second->bufferSubData( 0, mVertexArrayVbos[i].second->getSize(), buffers[i].get() );
+}
+
 VboMesh::VboMesh( uint32_t numVertices, uint32_t numIndices, GLenum glPrimitive, GLenum indexType, const std::vector<pair<geom::BufferLayout,VboRef>> &vertexArrayBuffers, const VboRef &indexVbo )
 	: mNumVertices( numVertices ), mNumIndices( numIndices ), mGlPrimitive( glPrimitive ), mIndexType( indexType ), mVertexArrayVbos( vertexArrayBuffers ), mIndices( indexVbo )
 {
@@ -265,7 +310,7 @@ void VboMesh::buildVao( const GlslProgRef &shader, const AttribGlslMap &attribut
 			// if either the shader's mapping or 'attributeMapping' has this semantic, add it to the VAO
 			if( loc != -1 ) {
 				ctx->enableVertexAttribArray( loc );
-				ctx->vertexAttribPointer( loc, attribInfo.getDims(), GL_FLOAT, GL_FALSE, attribInfo.getStride(), (const void*)attribInfo.getOffset() );
+				ctx->vertexAttribPointer( loc, toGlAttribSize( attribInfo ), toGl( attribInfo.getDataType() ), geom::isNormalized( attribInfo.getDataType() ) ? GL_TRUE : GL_FALSE, attribInfo.getStride(), (const void*)attribInfo.getOffset() );
 				if( attribInfo.getInstanceDivisor() > 0 )
 					ctx->vertexAttribDivisor( loc, attribInfo.getInstanceDivisor() );
 			}
@@ -378,6 +423,9 @@ VboMesh::MappedAttrib<T> VboMesh::mapAttribImpl( geom::Attrib attr, int dims, bo
 	if( dims != attribInfo.getDims() ) {
 		CI_LOG_W( "Mapping geom::Attrib of dims " << (int)attribInfo.getDims() << " to type of dims " << dims );	
 	}
+	if( attribInfo.getDataType() != geom::DataType::FLOAT ) {
+		CI_LOG_W( "Mapping geom::Attrib " << geom::attribToString( attr ) << " which is not stored as geom::DataType::FLOAT" );
+	}
 
 	auto stride = ( attribInfo.getStride() == 0 ) ? sizeof(T) : attribInfo.getStride();
 	return VboMesh::MappedAttrib<T>( this, layoutVbo->second, ((uint8_t*)dataPtr) + attribInfo.getOffset(), stride );
@@ -671,7 +719,15 @@ void VboMeshSource::loadInto( geom::Target *target ) const
 		const void *rawData = vertArrayVbo.second->map( GL_READ_ONLY );
 		// now iterate the attributes associated with this VBO
 		for( const auto &attribInfo : vertArrayVbo.first.getAttribs() ) {
-			target->copyAttrib( attribInfo.getAttrib(), attribInfo.getDims(), attribInfo.getStride(), (const float*)((const uint8_t*)rawData + attribInfo.getOffset()), getNumVertices() );
+			const uint8_t *attribData = (const uint8_t*)rawData + attribInfo.getOffset();
+			if( attribInfo.getDataType() == geom::DataType::FLOAT )
+				target->copyAttrib( attribInfo.getAttrib(), attribInfo.getDims(), attribInfo.getStride(), (const float*)attribData, getNumVertices() );
+			else {
+				// quantized attributes are expanded back to floats, which is what geom::Target expects
+				std::unique_ptr<float[]> unpacked( new float[attribInfo.getDims() * getNumVertices()] );
+				geom::unpackData( attribInfo.getDataType(), attribInfo.getDims(), attribInfo.getStride(), attribData, getNumVertices(), unpacked.get() );
+				target->copyAttrib( attribInfo.getAttrib(), attribInfo.getDims(), 0, unpacked.get(), getNumVertices() );
+			}
 		}
 		
 		vertArrayVbo.second->unmap();
@@ -821,6 +821,49 @@ GLenum toGl( geom::Primitive prim )
 	}
 }
 
+GLenum toGl( geom::DataType dataType )
+{
+	switch( dataType ) {
+		case geom::DataType::FLOAT:
+		case geom::DataType::INTEGER:
+			return GL_FLOAT;
+#if ! defined( CINDER_GL_ES )
+		case geom::DataType::DOUBLE:
+			return GL_DOUBLE;
+		case geom::DataType::HALF_FLOAT:
+			return GL_HALF_FLOAT;
+		case geom::DataType::INT_10_10_10_2_NORM:
+			return GL_INT_2_10_10_10_REV;
+		case geom::DataType::UINT_10_10_10_2_NORM:
+			return GL_UNSIGNED_INT_2_10_10_10_REV;
+#elif defined( GL_HALF_FLOAT_OES )
+		case geom::DataType::HALF_FLOAT:
+			return GL_HALF_FLOAT_OES;
+#endif
+		case geom::DataType::INT8_NORM:
+			return GL_BYTE;
+		case geom::DataType::UINT8_NORM:
+			return GL_UNSIGNED_BYTE;
+		case geom::DataType::INT16_NORM:
+			return GL_SHORT;
+		case geom::DataType::UINT16_NORM:
+			return GL_UNSIGNED_SHORT;
+		default:
+			return 0;
+	}
+}
+
+GLint toGlAttribSize( const geom::AttribInfo &attribInfo )
+{
+	switch( attribInfo.getDataType() ) {
+		case geom::DataType::INT_10_10_10_2_NORM:
+		case geom::DataType::UINT_10_10_10_2_NORM:
+			return 4;
+		default:
+			return attribInfo.getDims();
+	}
+}
+
 geom::Primitive toGeomPrimitive( GLenum prim )
 {
 	switch( prim ) {
@@ -942,8 +985,9 @@ void drawCubeImpl( const Vec3f &c, const Vec3f &size, bool faceColors )
 	ctx->pushVao();
 	ctx->getDefaultVao()->replacementBindBegin();
 
-	VboRef defaultArrayVbo = ctx->getDefaultArrayVbo( totalArrayBufferSize );
-	ScopedBuffer vboScp( defaultArrayVbo );
+	size_t offset;
+	uint8_t *arrayData = reinterpret_cast<uint8_t*>( ctx->streamArrayBegin( totalArrayBufferSize, &offset ) );
+	ScopedBuffer vboScp( ctx->getStreamArrayVbo() );
 	VboRef elementVbo = ctx->getDefaultElementVbo( 6*6 );
 
 	elementVbo->bind();
@@ -951,31 +995,32 @@ void drawCubeImpl( const Vec3f &c, const Vec3f &size, bool faceColors )
 	if( hasPositions ) {
 		int loc = curGlslProg->getAttribSemanticLocation( geom::Attrib::POSITION );
 		enableVertexAttribArray( loc );
-		vertexAttribPointer( loc, 3, GL_FLOAT, GL_FALSE, 0, (void*)curBufferOffset );
-		defaultArrayVbo->bufferSubData( curBufferOffset, sizeof(float)*24*3, vertices );
+		vertexAttribPointer( loc, 3, GL_FLOAT, GL_FALSE, 0, (void*)(offset + curBufferOffset) );
+		memcpy( arrayData + curBufferOffset, vertices, sizeof(float)*24*3 );
 		curBufferOffset += sizeof(float)*24*3;
 	}
 	if( hasNormals ) {
 		int loc = curGlslProg->getAttribSemanticLocation( geom::Attrib::NORMAL );
 		enableVertexAttribArray( loc );
-		vertexAttribPointer( loc, 3, GL_FLOAT, GL_FALSE, 0, (void*)curBufferOffset );
-		defaultArrayVbo->bufferSubData( curBufferOffset, sizeof(float)*24*3, normals );
+		vertexAttribPointer( loc, 3, GL_FLOAT, GL_FALSE, 0, (void*)(offset + curBufferOffset) );
+		memcpy( arrayData + curBufferOffset, normals, sizeof(float)*24*3 );
 		curBufferOffset += sizeof(float)*24*3;
 	}
 	if( hasTextureCoords ) {
 		int loc = curGlslProg->getAttribSemanticLocation( geom::Attrib::TEX_COORD_0 );
 		enableVertexAttribArray( loc );
-		vertexAttribPointer( loc, 2, GL_FLOAT, GL_FALSE, 0, (void*)curBufferOffset );
-		defaultArrayVbo->bufferSubData( curBufferOffset, sizeof(float)*24*2, texs );
+		vertexAttribPointer( loc, 2, GL_FLOAT, GL_FALSE, 0, (void*)(offset + curBufferOffset) );
+		memcpy( arrayData + curBufferOffset, texs, sizeof(float)*24*2 );
 		curBufferOffset += sizeof(float)*24*2;
 	}
 	if( hasColors ) {
 		int loc = curGlslProg->getAttribSemanticLocation( geom::Attrib::COLOR );
 		enableVertexAttribArray( loc );
-		vertexAttribPointer( loc, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, (void*)curBufferOffset );
-		defaultArrayVbo->bufferSubData( curBufferOffset, 24*4, colors );
+		vertexAttribPointer( loc, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, (void*)(offset + curBufferOffset) );
+		memcpy( arrayData + curBufferOffset, colors, 24*4 );
 		curBufferOffset += 24*4;
 	}
+	ctx->streamArrayEnd();
 
 	elementVbo->bufferSubData( 0, 36, elements );
 	ctx->getDefaultVao()->replacementBindEnd();
@@ -1043,8 +1088,8 @@ void draw( const Path2d &path, float approximationScale )
 	}
 
 	vector<Vec2f> points = path.subdivide( approximationScale );
-	VboRef arrayVbo = ctx->getDefaultArrayVbo( sizeof(Vec2f) * points.size() );
-	arrayVbo->bufferSubData( 0, sizeof(Vec2f) * points.size(), points.data() );
+	size_t offset = ctx->streamArrayData( points.data(), sizeof(Vec2f) * points.size() );
+	const VboRef &arrayVbo = ctx->getStreamArrayVbo();
 
 	ctx->pushVao();
 	ctx->getDefaultVao()->replacementBindBegin();
@@ -1052,7 +1097,7 @@ void draw( const Path2d &path, float approximationScale )
 	int posLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::POSITION );
 	if( posLoc >= 0 ) {
 		enableVertexAttribArray( posLoc );
-		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)nullptr );
+		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)offset );
 	}
 
 	ctx->getDefaultVao()->replacementBindEnd();
@@ -1071,8 +1116,8 @@ void draw( const PolyLine<Vec2f> &polyLine )
 	}
 
 	const vector<Vec2f> &points = polyLine.getPoints();
-	VboRef arrayVbo = ctx->getDefaultArrayVbo( sizeof(Vec2f) * points.size() );
-	arrayVbo->bufferSubData( 0, sizeof(Vec2f) * points.size(), points.data() );
+	size_t offset = ctx->streamArrayData( points.data(), sizeof(Vec2f) * points.size() );
+	const VboRef &arrayVbo = ctx->getStreamArrayVbo();
 
 	ctx->pushVao();
 	ctx->getDefaultVao()->replacementBindBegin();
@@ -1080,7 +1125,7 @@ void draw( const PolyLine<Vec2f> &polyLine )
 	int posLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::POSITION );
 	if( posLoc >= 0 ) {
 		enableVertexAttribArray( posLoc );
-		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)nullptr );
+		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)offset );
 	}
 
 	ctx->getDefaultVao()->replacementBindEnd();
@@ -1099,8 +1144,8 @@ void draw( const PolyLine<Vec3f> &polyLine )
 	}
 	
 	const vector<Vec3f> &points = polyLine.getPoints();
-	VboRef arrayVbo = ctx->getDefaultArrayVbo( sizeof(Vec3f) * points.size() );
-	arrayVbo->bufferSubData( 0, sizeof(Vec3f) * points.size(), points.data() );
+	size_t offset = ctx->streamArrayData( points.data(), sizeof(Vec3f) * points.size() );
+	const VboRef &arrayVbo = ctx->getStreamArrayVbo();
 
 	ctx->pushVao();
 	ctx->getDefaultVao()->replacementBindBegin();
@@ -1108,7 +1153,7 @@ void draw( const PolyLine<Vec3f> &polyLine )
 	int posLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::POSITION );
 	if( posLoc >= 0 ) {
 		enableVertexAttribArray( posLoc );
-		vertexAttribPointer( posLoc, 3, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)nullptr );
+		vertexAttribPointer( posLoc, 3, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)offset );
 	}
 
 	ctx->getDefaultVao()->replacementBindEnd();
@@ -1133,14 +1178,12 @@ void drawLine( const Vec3f &a, const Vec3f &b )
 	ctx->pushVao();
 	ctx->getDefaultVao()->replacementBindBegin();
 
-	VboRef arrayVbo = ctx->getDefaultArrayVbo( size );
-	ScopedBuffer bufferBindScp( arrayVbo );
-
-	arrayVbo->bufferSubData( 0, size, points.data() );
+	size_t offset = ctx->streamArrayData( points.data(), size );
+	ScopedBuffer bufferBindScp( ctx->getStreamArrayVbo() );
 	int posLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::POSITION );
 	if( posLoc >= 0 ) {
 		enableVertexAttribArray( posLoc );
-		vertexAttribPointer( posLoc, dims, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)nullptr );
+		vertexAttribPointer( posLoc, dims, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)offset );
 	}
 	ctx->getDefaultVao()->replacementBindEnd();
 	ctx->setDefaultShaderVars();
@@ -1163,14 +1206,12 @@ void drawLine( const Vec2f &a, const Vec2f &b )
 	ctx->pushVao();
 	ctx->getDefaultVao()->replacementBindBegin();
 
-	VboRef arrayVbo = ctx->getDefaultArrayVbo( size );
-	ScopedBuffer bufferBindScp( arrayVbo );
-
-	arrayVbo->bufferSubData( 0, size, points.data() );
+	size_t offset = ctx->streamArrayData( points.data(), size );
+	ScopedBuffer bufferBindScp( ctx->getStreamArrayVbo() );
 	int posLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::POSITION );
 	if( posLoc >= 0 ) {
 		enableVertexAttribArray( posLoc );
-		vertexAttribPointer( posLoc, dims, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)nullptr );
+		vertexAttribPointer( posLoc, dims, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)offset );
 	}
 	ctx->getDefaultVao()->replacementBindEnd();
 	ctx->setDefaultShaderVars();
@@ -1224,19 +1265,18 @@ void drawSolidRect( const Rectf &r, const Rectf &texCoords )
 
 	ctx->pushVao();
 	ctx->getDefaultVao()->replacementBindBegin();
-	VboRef defaultVbo = ctx->getDefaultArrayVbo( sizeof(float)*16 );
-	ScopedBuffer bufferBindScp( defaultVbo );
-	defaultVbo->bufferSubData( 0, sizeof(float)*16, data );
+	size_t offset = ctx->streamArrayData( data, sizeof(float)*16 );
+	ScopedBuffer bufferBindScp( ctx->getStreamArrayVbo() );
 
 	int posLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::POSITION );
 	if( posLoc >= 0 ) {
 		enableVertexAttribArray( posLoc );
-		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
+		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)offset );
 	}
 	int texLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::TEX_COORD_0 );
 	if( texLoc >= 0 ) {
 		enableVertexAttribArray( texLoc );
-		vertexAttribPointer( texLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)(sizeof(float)*8) );
+		vertexAttribPointer( texLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)(offset + sizeof(float)*8) );
 	}
 	ctx->getDefaultVao()->replacementBindEnd();
 	ctx->setDefaultShaderVars();
@@ -1262,14 +1302,13 @@ void drawStrokedRect( const Rectf &rect )
 	ctx->pushVao();
 	ctx->getDefaultVao()->replacementBindBegin();
 
-	VboRef defaultVbo = ctx->getDefaultArrayVbo( 8 * sizeof( float ) );
-	ScopedBuffer bufferBindScp( defaultVbo );
-	defaultVbo->bufferSubData( 0, 8 * sizeof( float ), verts );
+	size_t offset = ctx->streamArrayData( verts, 8 * sizeof( float ) );
+	ScopedBuffer bufferBindScp( ctx->getStreamArrayVbo() );
 
 	int posLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::POSITION );
 	if( posLoc >= 0 ) {
 		enableVertexAttribArray( posLoc );
-		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
+		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)offset );
 	}
 
 	ctx->setDefaultShaderVars();
@@ -1309,14 +1348,13 @@ void drawStrokedRect( const Rectf &rect, float lineWidth )
 	ctx->pushVao();
 	ctx->getDefaultVao()->replacementBindBegin();
 
-	VboRef defaultVbo = ctx->getDefaultArrayVbo( 32 * sizeof( float ) );
-	ScopedBuffer bufferBindScp( defaultVbo );
-	defaultVbo->bufferSubData( 0, 32 * sizeof( float ), verts );
+	size_t offset = ctx->streamArrayData( verts, 32 * sizeof( float ) );
+	ScopedBuffer bufferBindScp( ctx->getStreamArrayVbo() );
 
 	int posLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::POSITION );
 	if( posLoc >= 0 ) {
 		enableVertexAttribArray( posLoc );
-		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
+		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)offset );
 	}
 
 	ctx->setDefaultShaderVars();
@@ -1353,8 +1391,8 @@ void drawStrokedCircle( const Vec2f &center, float radius, int numSegments )
 	}
 	// copy data to GPU
 	const size_t size = positions.size() * sizeof( Vec2f );
-	auto arrayVbo = ctx->getDefaultArrayVbo( size );
-	arrayVbo->bufferSubData( 0, size, (GLvoid*)positions.data() );
+	size_t offset = ctx->streamArrayData( positions.data(), size );
+	const VboRef &arrayVbo = ctx->getStreamArrayVbo();
 	// set attributes
 	ctx->pushVao();
 	ctx->getDefaultVao()->replacementBindBegin();
@@ -1363,7 +1401,7 @@ void drawStrokedCircle( const Vec2f &center, float radius, int numSegments )
 	int posLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::POSITION );
 	if( posLoc >= 0 ) {
 		enableVertexAttribArray( posLoc );
-		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (GLvoid*)nullptr );
+		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (GLvoid*)offset );
 	}
 	ctx->getDefaultVao()->replacementBindEnd();
 	ctx->setDefaultShaderVars();
@@ -1390,39 +1428,31 @@ void drawSolidCircle( const Vec2f &center, float radius, int numSegments )
 	if( numSegments < 3 ) numSegments = 3;
 	size_t numVertices = numSegments + 2;
 
-	size_t worstCaseSize = numVertices * sizeof(float) * ( 2 + 2 + 3 );
-	VboRef defaultVbo = ctx->getDefaultArrayVbo( worstCaseSize );
-	ScopedBuffer vboScp( defaultVbo );
-
 	size_t dataSizeBytes = 0;
 
 	size_t vertsOffset, texCoordsOffset, normalsOffset;
 	int posLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::POSITION );
 	if( posLoc >= 0 ) {
-		enableVertexAttribArray( posLoc );
-		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)dataSizeBytes );
 		vertsOffset = dataSizeBytes;
 		dataSizeBytes += numVertices * 2 * sizeof(float);
 	}
 	int texLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::TEX_COORD_0 );
 	if( texLoc >= 0 ) {
-		enableVertexAttribArray( texLoc );
-		vertexAttribPointer( texLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)dataSizeBytes );
 		texCoordsOffset = dataSizeBytes;
 		dataSizeBytes += numVertices * 2 * sizeof(float);
 	}
 	int normalLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::NORMAL );
 	if( normalLoc >= 0 ) {
-		enableVertexAttribArray( normalLoc );
-		vertexAttribPointer( normalLoc, 3, GL_FLOAT, GL_FALSE, 0, (void*)(dataSizeBytes) );
 		normalsOffset = dataSizeBytes;
 		dataSizeBytes += numVertices * 3 * sizeof(float);
 	}
 
-	unique_ptr<uint8_t[]> data( new uint8_t[dataSizeBytes] );
-	Vec2f *verts = ( posLoc >= 0 ) ? reinterpret_cast<Vec2f*>( data.get() + vertsOffset ) : nullptr;
-	Vec2f *texCoords = ( texLoc >= 0 ) ? reinterpret_cast<Vec2f*>( data.get() + texCoordsOffset ) : nullptr;
-	Vec3f *normals = ( normalLoc >= 0 ) ? reinterpret_cast<Vec3f*>( data.get() + normalsOffset ) : nullptr;
+	// generate directly into the streaming buffer
+	size_t offset;
+	uint8_t *data = reinterpret_cast<uint8_t*>( ctx->streamArrayBegin( dataSizeBytes, &offset ) );
+	Vec2f *verts = ( posLoc >= 0 ) ? reinterpret_cast<Vec2f*>( data + vertsOffset ) : nullptr;
+	Vec2f *texCoords = ( texLoc >= 0 ) ? reinterpret_cast<Vec2f*>( data + texCoordsOffset ) : nullptr;
+	Vec3f *normals = ( normalLoc >= 0 ) ? reinterpret_cast<Vec3f*>( data + normalsOffset ) : nullptr;
 
 	if( verts )
 		verts[0] = center;
@@ -1442,8 +1472,22 @@ void drawSolidCircle( const Vec2f &center, float radius, int numSegments )
 			normals[s+1] = Vec3f::zAxis();
 		t += tDelta;
 	}
+	ctx->streamArrayEnd();
+
+	ScopedBuffer vboScp( ctx->getStreamArrayVbo() );
+	if( posLoc >= 0 ) {
+		enableVertexAttribArray( posLoc );
+		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)(offset + vertsOffset) );
+	}
+	if( texLoc >= 0 ) {
+		enableVertexAttribArray( texLoc );
+		vertexAttribPointer( texLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)(offset + texCoordsOffset) );
+	}
+	if( normalLoc >= 0 ) {
+		enableVertexAttribArray( normalLoc );
+		vertexAttribPointer( normalLoc, 3, GL_FLOAT, GL_FALSE, 0, (void*)(offset + normalsOffset) );
+	}
 
-	defaultVbo->bufferSubData( 0, dataSizeBytes, data.get() );
 	ctx->getDefaultVao()->replacementBindEnd();
 
 	ctx->setDefaultShaderVars();
@@ -1500,19 +1544,18 @@ void drawBillboard( const Vec3f &pos, const Vec2f &scale, float rotationRadians,
 
 	ctx->pushVao();
 	ctx->getDefaultVao()->replacementBindBegin();
-	VboRef defaultVbo = ctx->getDefaultArrayVbo( sizeof(float)*20 );
-	ScopedBuffer bufferBindScp( defaultVbo );
-	defaultVbo->bufferSubData( 0, sizeof(float)*20, data );
+	size_t offset = ctx->streamArrayData( data, sizeof(float)*20 );
+	ScopedBuffer bufferBindScp( ctx->getStreamArrayVbo() );
 
 	int posLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::POSITION );
 	if( posLoc >= 0 ) {
 		enableVertexAttribArray( posLoc );
-		vertexAttribPointer( posLoc, 3, GL_FLOAT, GL_FALSE, 0, (void*)0 );
+		vertexAttribPointer( posLoc, 3, GL_FLOAT, GL_FALSE, 0, (void*)offset );
 	}
 	int texLoc = curGlslProg->getAttribSemanticLocation( geom::Attrib::TEX_COORD_0 );
 	if( texLoc >= 0 ) {
 		enableVertexAttribArray( texLoc );
-		vertexAttribPointer( texLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)(sizeof(float)*12) );
+		vertexAttribPointer( texLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)(offset + sizeof(float)*12) );
 	}
 
 	ctx->getDefaultVao()->replacementBindEnd();
@@ -0,0 +1,341 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/ColorConvert.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/ip/ParallelRows.h"
+
+#include <boost/preprocessor/seq.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#if defined( CINDER_SSE2 )
+	#include <emmintrin.h>
+#endif
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// 8-bit sRGB tables, built on first use
+struct SrgbTables {
+	SrgbTables();
+
+	uint8_t		encode8( float v ) const;
+
+	float		mDecode[256]; // 8-bit sRGB to linear
+	uint8_t		mDecode8[256], mEncode8[256]; // 8-bit sRGB to 8-bit linear and back
+	float		mThresholds[257]; // the smallest linear value which encodes to at least each 8-bit sRGB value; the last is past any input
+	uint8_t		mEncodeStart[4096]; // the encoding of i / 4096, from which encode8() steps up through mThresholds
+};
+
+inline uint8_t encode8Scalar( float v )
+{
+	return static_cast<uint8_t>( linearToSrgb( v ) * 255 + 0.5f );
+}
+
+SrgbTables::SrgbTables()
+{
+	for( int v = 0; v < 256; ++v ) {
+		mDecode[v] = srgbToLinear( v / 255.0f );
+		mDecode8[v] = static_cast<uint8_t>( mDecode[v] * 255 + 0.5f );
+		mEncode8[v] = encode8Scalar( v / 255.0f );
+	}
+
+	// bisect over the bit patterns of positive floats, which sort the same as their values
+	mThresholds[0] = 0;
+	uint32_t one;
+	const float oneFloat = 1.0f;
+	memcpy( &one, &oneFloat, sizeof(one) );
+	for( int k = 1; k < 256; ++k ) {
+		uint32_t lo = 0, hi = one;
+		while( hi - lo > 1 ) {
+			const uint32_t mid = lo + ( hi - lo ) / 2;
+			float midValue;
+			memcpy( &midValue, &mid, sizeof(midValue) );
+			if( encode8Scalar( midValue ) >= k )
+				hi = mid;
+			else
+				lo = mid;
+		}
+		memcpy( &mThresholds[k], &hi, sizeof(float) );
+	}
+	mThresholds[256] = 2.0f;
+
+	for( int i = 0; i < 4096; ++i )
+		mEncodeStart[i] = encode8Scalar( i / 4096.0f );
+}
+
+inline uint8_t SrgbTables::encode8( float v ) const
+{
+	if( ! ( v > 0 ) ) // also catches NaN
+		return 0;
+	else if( v >= 1 )
+		return 255;
+
+	int k = mEncodeStart[(int)( v * 4096 )];
+	while( v >= mThresholds[k + 1] )
+		++k;
+	return static_cast<uint8_t>( k );
+}
+
+std::once_flag sSrgbTablesFlag;
+const SrgbTables *sSrgbTables = NULL;
+
+const SrgbTables& getSrgbTables()
+{
+	// VS2012's function-local statics aren't thread-safe, and these are first used from parallelFor() workers as often as not
+	std::call_once( sSrgbTablesFlag, [] { sSrgbTables = new SrgbTables; } );
+	return *sSrgbTables;
+}
+
+template<typename T>
+inline T fromFloat( float v )
+{
+	return static_cast<T>( std::min( std::max( v, 0.0f ), 1.0f ) * CHANTRAIT<T>::max() + 0.5f );
+}
+
+template<>
+inline float fromFloat<float>( float v )
+{
+	return v;
+}
+
+// applies fn to the red, green and blue elements of every pixel of surface
+template<typename T, typename FN>
+void forEachColorElement( SurfaceT<T> *surface, const FN &fn )
+{
+	const uint8_t pixelInc = surface->getPixelInc();
+	const uint8_t red = surface->getRedOffset(), green = surface->getGreenOffset(), blue = surface->getBlueOffset();
+	impl::forEachRow( surface, [&]( T *row, int32_t width ) {
+		for( int32_t x = 0; x < width; ++x, row += pixelInc ) {
+			row[red] = fn( row[red] );
+			row[green] = fn( row[green] );
+			row[blue] = fn( row[blue] );
+		}
+	} );
+}
+
+// converts each row of surface to Colorf, passes it through convertFn( const Colorf*, Colorf*, count ) and writes it back
+template<typename T, typename FN>
+void convertColorRows( SurfaceT<T> *surface, const FN &convertFn )
+{
+	const uint8_t pixelInc = surface->getPixelInc();
+	const uint8_t red = surface->getRedOffset(), green = surface->getGreenOffset(), blue = surface->getBlueOffset();
+	const int32_t width = surface->getWidth();
+	impl::forEachRowChunk( 0, surface->getHeight(), width, [&]( size_t rowBegin, size_t rowEnd ) {
+		std::vector<Colorf> colors( width ), converted( width );
+		for( size_t y = rowBegin; y < rowEnd; ++y ) {
+			T *row = surface->getData( Vec2i( 0, (int32_t)y ) );
+			const T *src = row;
+			for( int32_t x = 0; x < width; ++x, src += pixelInc )
+				colors[x] = Colorf( CHANTRAIT<float>::convert( src[red] ), CHANTRAIT<float>::convert( src[green] ), CHANTRAIT<float>::convert( src[blue] ) );
+			convertFn( colors.data(), converted.data(), width );
+			T *dst = row;
+			for( int32_t x = 0; x < width; ++x, dst += pixelInc ) {
+				dst[red] = fromFloat<T>( converted[x].r );
+				dst[green] = fromFloat<T>( converted[x].g );
+				dst[blue] = fromFloat<T>( converted[x].b );
+			}
+		}
+	} );
+}
+
+#if defined( CINDER_SSE2 )
+// deinterleaves 4 consecutive 3-float triples into one register per component
+inline void loadTriples( const float *src, __m128 *a, __m128 *b, __m128 *c )
+{
+	const __m128 v0 = _mm_loadu_ps( src ), v1 = _mm_loadu_ps( src + 4 ), v2 = _mm_loadu_ps( src + 8 );
+	*a = _mm_shuffle_ps( v0, _mm_shuffle_ps( v1, v2, _MM_SHUFFLE( 1, 1, 2, 2 ) ), _MM_SHUFFLE( 2, 0, 3, 0 ) );
+	*b = _mm_shuffle_ps( _mm_shuffle_ps( v0, v1, _MM_SHUFFLE( 0, 0, 1, 1 ) ), _mm_shuffle_ps( v1, v2, _MM_SHUFFLE( 2, 2, 3, 3 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+	*c = _mm_shuffle_ps( _mm_shuffle_ps( v0, v1, _MM_SHUFFLE( 1, 1, 2, 2 ) ), v2, _MM_SHUFFLE( 3, 0, 2, 0 ) );
+}
+
+inline void storeTriples( float *dst, __m128 a, __m128 b, __m128 c )
+{
+	float as[4], bs[4], cs[4];
+	_mm_storeu_ps( as, a );
+	_mm_storeu_ps( bs, b );
+	_mm_storeu_ps( cs, c );
+	for( int i = 0; i < 4; ++i ) {
+		dst[i * 3 + 0] = as[i];
+		dst[i * 3 + 1] = bs[i];
+		dst[i * 3 + 2] = cs[i];
+	}
+}
+
+inline __m128 select( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+#endif
+
+} // anonymous namespace
+
+float srgbToLinear( float v )
+{
+	return ( v <= 0.04045f ) ? ( v / 12.92f ) : pow( ( v + 0.055f ) / 1.055f, 2.4f );
+}
+
+float linearToSrgb( float v )
+{
+	v = std::min( std::max( v, 0.0f ), 1.0f );
+	return ( v <= 0.0031308f ) ? ( v * 12.92f ) : ( 1.055f * pow( v, 1.0f / 2.4f ) - 0.055f );
+}
+
+void srgbToLinear( const uint8_t *src, float *dst, size_t count )
+{
+	const float *table = getSrgbTables().mDecode;
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = table[src[i]];
+}
+
+void linearToSrgb( const float *src, uint8_t *dst, size_t count )
+{
+	const SrgbTables &tables = getSrgbTables();
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = tables.encode8( src[i] );
+}
+
+void srgbToLinear( const float *src, float *dst, size_t count )
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = srgbToLinear( src[i] );
+}
+
+void linearToSrgb( const float *src, float *dst, size_t count )
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = linearToSrgb( src[i] );
+}
+
+void rgbToHsv( const Colorf *src, Vec3f *dst, size_t count )
+{
+	size_t i = 0;
+#if defined( CINDER_SSE2 )
+	// every branch of rgbToHSV() is evaluated and selected, with the same operations in the same order
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps( 1 ), two = _mm_set1_ps( 2 ), four = _mm_set1_ps( 4 ), six = _mm_set1_ps( 6 );
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128 x, y, z;
+		loadTriples( &src[i].r, &x, &y, &z );
+		const __m128 max = _mm_max_ps( _mm_max_ps( x, y ), z );
+		const __m128 min = _mm_min_ps( _mm_min_ps( x, y ), z );
+		const __m128 range = _mm_sub_ps( max, min );
+		const __m128 sat = _mm_and_ps( _mm_cmpneq_ps( max, zero ), _mm_div_ps( range, max ) );
+		const __m128 hx = _mm_div_ps( _mm_sub_ps( y, z ), range );
+		const __m128 hy = _mm_add_ps( two, _mm_div_ps( _mm_sub_ps( z, x ), range ) );
+		const __m128 hz = _mm_add_ps( four, _mm_div_ps( _mm_sub_ps( x, y ), range ) );
+		__m128 hue = _mm_div_ps( select( _mm_cmpeq_ps( x, max ), hx, select( _mm_cmpeq_ps( y, max ), hy, hz ) ), six );
+		hue = _mm_add_ps( hue, _mm_and_ps( _mm_cmplt_ps( hue, zero ), one ) );
+		hue = _mm_and_ps( _mm_cmpneq_ps( sat, zero ), hue );
+		storeTriples( &dst[i].x, hue, sat, max );
+	}
+#endif
+	for( ; i < count; ++i )
+		dst[i] = rgbToHSV( src[i] );
+}
+
+void hsvToRgb( const Vec3f *src, Colorf *dst, size_t count )
+{
+	size_t i = 0;
+#if defined( CINDER_SSE2 )
+	// every case of hsvToRGB()'s switch is evaluated and selected, with the same operations in the same order
+	const __m128 one = _mm_set1_ps( 1 ), six = _mm_set1_ps( 6 );
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128 hue, sat, val;
+		loadTriples( &src[i].x, &hue, &sat, &val );
+		hue = _mm_andnot_ps( _mm_cmpeq_ps( hue, one ), _mm_mul_ps( hue, six ) );
+		// floor, by truncating and stepping down where that rounded up
+		__m128i sextant = _mm_cvttps_epi32( hue );
+		__m128 sextantFloat = _mm_cvtepi32_ps( sextant );
+		const __m128 roundedUp = _mm_cmpgt_ps( sextantFloat, hue );
+		sextant = _mm_add_epi32( sextant, _mm_castps_si128( roundedUp ) );
+		sextantFloat = _mm_sub_ps( sextantFloat, _mm_and_ps( roundedUp, one ) );
+		const __m128 f = _mm_sub_ps( hue, sextantFloat );
+		const __m128 p = _mm_mul_ps( val, _mm_sub_ps( one, sat ) );
+		const __m128 q = _mm_mul_ps( val, _mm_sub_ps( one, _mm_mul_ps( sat, f ) ) );
+		const __m128 t = _mm_mul_ps( val, _mm_sub_ps( one, _mm_mul_ps( sat, _mm_sub_ps( one, f ) ) ) );
+
+		const __m128 cases[6][3] = { { val, t, p }, { q, val, p }, { p, val, t }, { p, q, val }, { t, p, val }, { val, p, q } };
+		__m128 rgb[3] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+		for( int c = 0; c < 6; ++c ) {
+			const __m128 isCase = _mm_castsi128_ps( _mm_cmpeq_epi32( sextant, _mm_set1_epi32( c ) ) );
+			for( int channel = 0; channel < 3; ++channel )
+				rgb[channel] = _mm_or_ps( rgb[channel], _mm_and_ps( isCase, cases[c][channel] ) );
+		}
+		storeTriples( &dst[i].r, rgb[0], rgb[1], rgb[2] );
+	}
+#endif
+	for( ; i < count; ++i )
+		dst[i] = hsvToRGB( src[i] );
+}
+
+template<typename T>
+void srgbToLinear( SurfaceT<T> *surface )
+{
+	forEachColorElement( surface, []( T v ) { return fromFloat<T>( srgbToLinear( CHANTRAIT<float>::convert( v ) ) ); } );
+}
+
+template<>
+void srgbToLinear( SurfaceT<uint8_t> *surface )
+{
+	const uint8_t *table = getSrgbTables().mDecode8;
+	forEachColorElement( surface, [=]( uint8_t v ) { return table[v]; } );
+}
+
+template<typename T>
+void linearToSrgb( SurfaceT<T> *surface )
+{
+	forEachColorElement( surface, []( T v ) { return fromFloat<T>( linearToSrgb( CHANTRAIT<float>::convert( v ) ) ); } );
+}
+
+template<>
+void linearToSrgb( SurfaceT<uint8_t> *surface )
+{
+	const uint8_t *table = getSrgbTables().mEncode8;
+	forEachColorElement( surface, [=]( uint8_t v ) { return table[v]; } );
+}
+
+template<typename T>
+void rgbToHsv( SurfaceT<T> *surface )
+{
+	convertColorRows( surface, []( const Colorf *src, Colorf *dst, size_t count ) { rgbToHsv( src, reinterpret_cast<Vec3f*>( dst ), count ); } );
+}
+
+template<typename T>
+void hsvToRgb( SurfaceT<T> *surface )
+{
+	convertColorRows( surface, []( const Colorf *src, Colorf *dst, size_t count ) { hsvToRgb( reinterpret_cast<const Vec3f*>( src ), dst, count ); } );
+}
+
+#define colorConvert_PROTOTYPES(r,data,T)\
+	template void srgbToLinear( SurfaceT<T> *surface );\
+	template void linearToSrgb( SurfaceT<T> *surface );\
+	template void rgbToHsv( SurfaceT<T> *surface );\
+	template void hsvToRgb( SurfaceT<T> *surface );
+
+BOOST_PP_SEQ_FOR_EACH( colorConvert_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+
+} } // namespace cinder::ip
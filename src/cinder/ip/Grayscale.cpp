@@ -22,77 +22,251 @@
 
 #include "cinder/ip/Grayscale.h"
 #include "cinder/ChanTraits.h"
+#include "cinder/ip/ParallelRows.h"
 
 #include <boost/preprocessor/seq.hpp>
-
+#include <algorithm>
+#if defined( CINDER_SSE2 )
+	#include <emmintrin.h>
+#endif
 
 namespace cinder { namespace ip {
 
+namespace {
+
+// Pixel layouts of a row: the element increment, the offsets of red, green and blue (only the first is used for a Channel), and which of up to
+// 4 elements a destination row leaves untouched
+struct RowLayout {
+	RowLayout( int8_t inc, uint8_t red, uint8_t green, uint8_t blue )
+		: mInc( inc ), mKeepMask( 0 )
+	{
+		mOffsets[0] = red; mOffsets[1] = green; mOffsets[2] = blue;
+		if( inc == 4 )
+			mKeepMask = 0xF & ~( ( 1 << red ) | ( 1 << green ) | ( 1 << blue ) );
+	}
+
+	int8_t		mInc;
+	uint8_t		mOffsets[3];
+	uint8_t		mKeepMask; // bit i set when element i of a 4-element pixel is neither red, green nor blue
+};
+
 template<typename T>
-void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
+RowLayout surfaceLayout( const SurfaceT<T> &surface )
 {
-	Area area = srcSurface.getBounds().getClipBy( dstSurface->getBounds() );
+	return RowLayout( surface.getPixelInc(), surface.getRedOffset(), surface.getGreenOffset(), surface.getBlueOffset() );
+}
 
-	int8_t srcPixelInc = srcSurface.getPixelInc();
-	uint8_t srcRedOffset = srcSurface.getRedOffset(), srcGreenOffset = srcSurface.getGreenOffset(), srcBlueOffset = srcSurface.getBlueOffset();
-	uint8_t dstRedOffset = dstSurface->getRedOffset(), dstGreenOffset = dstSurface->getGreenOffset(), dstBlueOffset = dstSurface->getBlueOffset();	
-	int8_t dstPixelInc = dstSurface->getPixelInc();
-	for( int32_t y = 0; y < area.getHeight(); ++y ) {
-		T *dstPtr = dstSurface->getData( Vec2i( area.getX1(), y ) );
-		const T *srcPtr = srcSurface.getData( Vec2i( area.getX1(), y ) );
-		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
-			T gray = CHANTRAIT<T>::grayscale( srcPtr[srcRedOffset], srcPtr[srcGreenOffset], srcPtr[srcBlueOffset] );
-			dstPtr[dstRedOffset] = gray;
-			dstPtr[dstGreenOffset] = gray;
-			dstPtr[dstBlueOffset] = gray;
-			dstPtr += dstPixelInc;
-			srcPtr += srcPixelInc;
+template<typename T>
+RowLayout channelLayout( const ChannelT<T> &channel )
+{
+	return RowLayout( channel.getIncrement(), 0, 0, 0 );
+}
+
+// luma of CHANTRAIT<T>::grayscale(), or of 8-bit weights summing to 256
+template<typename T>
+struct Luma {
+	T operator()( T r, T g, T b ) const { return CHANTRAIT<T>::grayscale( r, g, b ); }
+};
+
+struct Luma8 {
+	Luma8( uint16_t red, uint16_t green, uint16_t blue ) : mRed( red ), mGreen( green ), mBlue( blue ) {}
+
+	uint8_t operator()( uint8_t r, uint8_t g, uint8_t b ) const { return static_cast<uint8_t>( ( r * mRed + g * mGreen + b * mBlue ) >> 8 ); }
+
+	uint16_t	mRed, mGreen, mBlue;
+};
+
+// writes the luma of each source pixel to the red, green and blue (or only) elements of each destination pixel
+template<typename T, typename LUMA>
+void grayscaleRowScalar( const T *src, const RowLayout &srcLayout, T *dst, const RowLayout &dstLayout, int numDstOffsets, int32_t width, const LUMA &luma )
+{
+	for( int32_t x = 0; x < width; ++x ) {
+		const T gray = luma( src[srcLayout.mOffsets[0]], src[srcLayout.mOffsets[1]], src[srcLayout.mOffsets[2]] );
+		for( int c = 0; c < numDstOffsets; ++c )
+			dst[dstLayout.mOffsets[c]] = gray;
+		src += srcLayout.mInc;
+		dst += dstLayout.mInc;
+	}
+}
+
+#if defined( CINDER_SSE2 )
+// 32-bit mask of the elements a 4-element destination keeps
+inline __m128i keepMask8( uint8_t keepBits )
+{
+	uint32_t mask = 0;
+	for( int i = 0; i < 4; ++i )
+		if( keepBits & ( 1 << i ) )
+			mask |= 0xFFu << ( i * 8 );
+	return _mm_set1_epi32( (int)mask );
+}
+
+// stores 8 gray values held in 16-bit lanes, either packed (DST_INC 1) or replicated into 4-byte pixels whose kept bytes are preserved
+template<int DST_INC>
+inline void storeGray8( uint8_t *dst, __m128i gray, __m128i keep )
+{
+	const __m128i zero = _mm_setzero_si128();
+	if( DST_INC == 1 ) {
+		_mm_storel_epi64( reinterpret_cast<__m128i*>( dst ), _mm_packus_epi16( gray, zero ) );
+	}
+	else {
+		for( int half = 0; half < 2; ++half ) {
+			__m128i lanes = half ? _mm_unpackhi_epi16( gray, zero ) : _mm_unpacklo_epi16( gray, zero );
+			lanes = _mm_or_si128( lanes, _mm_slli_epi32( lanes, 8 ) );
+			lanes = _mm_or_si128( lanes, _mm_slli_epi32( lanes, 16 ) );
+			__m128i *dstPixels = reinterpret_cast<__m128i*>( dst + half * 16 );
+			const __m128i old = _mm_loadu_si128( dstPixels );
+			_mm_storeu_si128( dstPixels, _mm_or_si128( _mm_and_si128( old, keep ), _mm_andnot_si128( keep, lanes ) ) );
 		}
 	}
 }
 
-template<typename T>
-void grayscale( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel )
+// luma of 8 4-byte pixels at a time, computed in 16-bit lanes; every weight set sums to 256 so no lane overflows
+template<int DST_INC>
+int32_t grayscaleRow8Sse( const uint8_t *src, const RowLayout &srcLayout, uint8_t *dst, const RowLayout &dstLayout, int32_t width, const Luma8 &luma )
 {
-	Area area = srcSurface.getBounds().getClipBy( dstChannel->getBounds() );
+	const __m128i byteMask = _mm_set1_epi32( 0xFF );
+	const __m128i redShift = _mm_cvtsi32_si128( srcLayout.mOffsets[0] * 8 ), greenShift = _mm_cvtsi32_si128( srcLayout.mOffsets[1] * 8 ), blueShift = _mm_cvtsi32_si128( srcLayout.mOffsets[2] * 8 );
+	const __m128i redWeight = _mm_set1_epi16( luma.mRed ), greenWeight = _mm_set1_epi16( luma.mGreen ), blueWeight = _mm_set1_epi16( luma.mBlue );
+	const __m128i keep = keepMask8( dstLayout.mKeepMask );
+	int32_t x = 0;
+	for( ; x + 8 <= width; x += 8, src += 32, dst += 8 * DST_INC ) {
+		const __m128i lo = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) ), hi = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + 16 ) );
+		const __m128i r = _mm_packs_epi32( _mm_and_si128( _mm_srl_epi32( lo, redShift ), byteMask ), _mm_and_si128( _mm_srl_epi32( hi, redShift ), byteMask ) );
+		const __m128i g = _mm_packs_epi32( _mm_and_si128( _mm_srl_epi32( lo, greenShift ), byteMask ), _mm_and_si128( _mm_srl_epi32( hi, greenShift ), byteMask ) );
+		const __m128i b = _mm_packs_epi32( _mm_and_si128( _mm_srl_epi32( lo, blueShift ), byteMask ), _mm_and_si128( _mm_srl_epi32( hi, blueShift ), byteMask ) );
+		const __m128i sum = _mm_add_epi16( _mm_add_epi16( _mm_mullo_epi16( r, redWeight ), _mm_mullo_epi16( g, greenWeight ) ), _mm_mullo_epi16( b, blueWeight ) );
+		storeGray8<DST_INC>( dst, _mm_srli_epi16( sum, 8 ), keep );
+	}
+	
+	return x;
+}
 
-	int8_t srcPixelInc = srcSurface.getPixelInc();
-	uint8_t srcRedOffset = srcSurface.getRedOffset(), srcGreenOffset = srcSurface.getGreenOffset(), srcBlueOffset = srcSurface.getBlueOffset();
-	int8_t dstPixelInc = dstChannel->getIncrement();
-	for( int32_t y = 0; y < area.getHeight(); ++y ) {
-		T *dstPtr = dstChannel->getData( Vec2i( area.getX1(), y ) );
-		const T *srcPtr = srcSurface.getData( Vec2i( area.getX1(), y ) );
-		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
-			*dstPtr = CHANTRAIT<T>::grayscale( srcPtr[srcRedOffset], srcPtr[srcGreenOffset], srcPtr[srcBlueOffset] );
-			dstPtr += dstPixelInc;
-			srcPtr += srcPixelInc;
+// luma of 4 4-float pixels at a time, in the same order of operations as CHANTRAIT<float>::grayscale()
+template<int DST_INC>
+int32_t grayscaleRowFloatSse( const float *src, const RowLayout &srcLayout, float *dst, const RowLayout &dstLayout, int32_t width )
+{
+	const __m128 redWeight = _mm_set1_ps( 0.2126f ), greenWeight = _mm_set1_ps( 0.7152f ), blueWeight = _mm_set1_ps( 0.0722f );
+	__m128 keep = _mm_setzero_ps();
+	if( DST_INC == 4 )
+		keep = _mm_castsi128_ps( _mm_setr_epi32( ( dstLayout.mKeepMask & 1 ) ? -1 : 0, ( dstLayout.mKeepMask & 2 ) ? -1 : 0, ( dstLayout.mKeepMask & 4 ) ? -1 : 0, ( dstLayout.mKeepMask & 8 ) ? -1 : 0 ) );
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4, src += 16, dst += 4 * DST_INC ) {
+		__m128 channels[4] = { _mm_loadu_ps( src ), _mm_loadu_ps( src + 4 ), _mm_loadu_ps( src + 8 ), _mm_loadu_ps( src + 12 ) };
+		_MM_TRANSPOSE4_PS( channels[0], channels[1], channels[2], channels[3] );
+		const __m128 gray = _mm_add_ps( _mm_add_ps( _mm_mul_ps( channels[srcLayout.mOffsets[0]], redWeight ), _mm_mul_ps( channels[srcLayout.mOffsets[1]], greenWeight ) ), _mm_mul_ps( channels[srcLayout.mOffsets[2]], blueWeight ) );
+		if( DST_INC == 1 ) {
+			_mm_storeu_ps( dst, gray );
+		}
+		else {
+			const __m128 grays[4] = { _mm_shuffle_ps( gray, gray, _MM_SHUFFLE( 0, 0, 0, 0 ) ), _mm_shuffle_ps( gray, gray, _MM_SHUFFLE( 1, 1, 1, 1 ) ),
+									_mm_shuffle_ps( gray, gray, _MM_SHUFFLE( 2, 2, 2, 2 ) ), _mm_shuffle_ps( gray, gray, _MM_SHUFFLE( 3, 3, 3, 3 ) ) };
+			for( int p = 0; p < 4; ++p ) {
+				const __m128 old = _mm_loadu_ps( dst + p * 4 );
+				_mm_storeu_ps( dst + p * 4, _mm_or_ps( _mm_and_ps( old, keep ), _mm_andnot_ps( keep, grays[p] ) ) );
+			}
 		}
 	}
+
+	return x;
+}
+#endif
+
+// converts a row, handing as much of it as possible to the SIMD kernels
+template<typename T, typename LUMA>
+void grayscaleRow( const T *src, const RowLayout &srcLayout, T *dst, const RowLayout &dstLayout, int numDstOffsets, int32_t width, const LUMA &luma )
+{
+	grayscaleRowScalar( src, srcLayout, dst, dstLayout, numDstOffsets, width, luma );
+}
+
+#if defined( CINDER_SSE2 )
+inline void grayscaleRow( const uint8_t *src, const RowLayout &srcLayout, uint8_t *dst, const RowLayout &dstLayout, int numDstOffsets, int32_t width, const Luma8 &luma )
+{
+	int32_t x = 0;
+	if( srcLayout.mInc == 4 && numDstOffsets == 1 && dstLayout.mInc == 1 )
+		x = grayscaleRow8Sse<1>( src, srcLayout, dst, dstLayout, width, luma );
+	else if( srcLayout.mInc == 4 && numDstOffsets == 3 && dstLayout.mInc == 4 )
+		x = grayscaleRow8Sse<4>( src, srcLayout, dst, dstLayout, width, luma );
+	grayscaleRowScalar( src + x * srcLayout.mInc, srcLayout, dst + x * dstLayout.mInc, dstLayout, numDstOffsets, width - x, luma );
+}
+
+inline void grayscaleRow( const float *src, const RowLayout &srcLayout, float *dst, const RowLayout &dstLayout, int numDstOffsets, int32_t width, const Luma<float> &luma )
+{
+	int32_t x = 0;
+	if( srcLayout.mInc == 4 && numDstOffsets == 1 && dstLayout.mInc == 1 )
+		x = grayscaleRowFloatSse<1>( src, srcLayout, dst, dstLayout, width );
+	else if( srcLayout.mInc == 4 && numDstOffsets == 3 && dstLayout.mInc == 4 )
+		x = grayscaleRowFloatSse<4>( src, srcLayout, dst, dstLayout, width );
+	grayscaleRowScalar( src + x * srcLayout.mInc, srcLayout, dst + x * dstLayout.mInc, dstLayout, numDstOffsets, width - x, luma );
+}
+#endif
+
+// the luma the Surface overloads use; the 8-bit one has the same weights as CHANTRAIT<uint8_t>::grayscale()
+template<typename T>
+struct SurfaceLuma {
+	typedef Luma<T>	Type;
+	static Type		get() { return Type(); }
+};
+
+template<>
+struct SurfaceLuma<uint8_t> {
+	typedef Luma8	Type;
+	static Type		get() { return Luma8( 54, 183, 19 ); }
+};
+
+template<typename T, typename LUMA>
+void grayscaleImpl( const SurfaceT<T> &srcSurface, T *dstData, int32_t dstRowBytes, const RowLayout &dstLayout, int numDstOffsets, const Area &area, const LUMA &luma )
+{
+	const RowLayout srcLayout = surfaceLayout( srcSurface );
+	impl::forEachRow( area.y1, area.y2, area.getWidth(), [&]( int32_t y ) {
+		T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( dstData + area.getX1() * dstLayout.mInc ) + y * dstRowBytes );
+		grayscaleRow( srcSurface.getData( Vec2i( area.getX1(), y ) ), srcLayout, dstPtr, dstLayout, numDstOffsets, area.getWidth(), luma );
+	} );
+}
+
+} // anonymous namespace
+
+template<typename T>
+void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
+{
+	Area area = srcSurface.getBounds().getClipBy( dstSurface->getBounds() );
+	grayscaleImpl( srcSurface, dstSurface->getData(), dstSurface->getRowBytes(), surfaceLayout( *dstSurface ), 3, area, SurfaceLuma<T>::get() );
+}
+
+template<typename T>
+void grayscale( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel )
+{
+	Area area = srcSurface.getBounds().getClipBy( dstChannel->getBounds() );
+	grayscaleImpl( srcSurface, dstChannel->getData(), dstChannel->getRowBytes(), channelLayout( *dstChannel ), 1, area, SurfaceLuma<T>::get() );
 }
 
 template<>
 void grayscale( const Surface8u &srcSurface, Channel8u *dstChannel )
 {
 	Area area = srcSurface.getBounds().getClipBy( dstChannel->getBounds() );
+	grayscaleImpl( srcSurface, dstChannel->getData(), dstChannel->getRowBytes(), channelLayout( *dstChannel ), 1, area, Luma8( 74, 147, 35 ) );
+}
 
-	int8_t srcPixelInc = srcSurface.getPixelInc();
-	uint8_t srcRedOffset = srcSurface.getRedOffset(), srcGreenOffset = srcSurface.getGreenOffset(), srcBlueOffset = srcSurface.getBlueOffset();
-	int8_t dstPixelInc = dstChannel->getIncrement();
-	const uint8_t redWeight = 74, greenWeight = 147, blueWeight = 35;
-	for( int32_t y = 0; y < area.getHeight(); ++y ) {
-		uint8_t *dstPtr = dstChannel->getData( Vec2i( area.getX1(), y ) );
-		const uint8_t *srcPtr = srcSurface.getData( Vec2i( area.getX1(), y ) );
+template<typename T>
+void grayscale( const ChannelT<T> &srcChannel, SurfaceT<T> *dstSurface )
+{
+	const Area area = srcChannel.getBounds().getClipBy( dstSurface->getBounds() );
+	const int8_t srcInc = srcChannel.getIncrement();
+	const int8_t dstPixelInc = dstSurface->getPixelInc();
+	const uint8_t dstRedOffset = dstSurface->getRedOffset(), dstGreenOffset = dstSurface->getGreenOffset(), dstBlueOffset = dstSurface->getBlueOffset();
+	impl::forEachRow( area.y1, area.y2, area.getWidth(), [&]( int32_t y ) {
+		const T *srcPtr = srcChannel.getData( Vec2i( area.getX1(), y ) );
+		T *dstPtr = dstSurface->getData( Vec2i( area.getX1(), y ) );
 		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
-			uint32_t sum = srcPtr[srcRedOffset] * redWeight + srcPtr[srcGreenOffset] * greenWeight + srcPtr[srcBlueOffset] * blueWeight;
-			*dstPtr = static_cast<uint8_t>( sum >> 8 );
+			dstPtr[dstRedOffset] = dstPtr[dstGreenOffset] = dstPtr[dstBlueOffset] = *srcPtr;
 			dstPtr += dstPixelInc;
-			srcPtr += srcPixelInc;
+			srcPtr += srcInc;
 		}
-	}
+	} );
 }
 
 #define grayscale_PROTOTYPES(r,data,T)\
-	template void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );
+	template void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );\
+	template void grayscale( const ChannelT<T> &srcChannel, SurfaceT<T> *dstSurface );
 	
 template void grayscale( const SurfaceT<float> &srcSurface, ChannelT<float> *dstChannel );
 
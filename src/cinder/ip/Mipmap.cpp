@@ -0,0 +1,247 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Mipmap.h"
+#include "cinder/ip/ColorConvert.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/Thread.h"
+
+#include <boost/preprocessor/seq.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// destination rows filtered per parallel task
+const int32_t ROWS_PER_BAND = 32;
+
+struct FilterTaps {
+	int32_t			start;
+	vector<float>	weights;
+};
+
+// calculates the normalized filter taps for each of the \a dstLength samples resampled from \a srcLength samples
+void makeFilterTaps( int32_t srcLength, int32_t dstLength, const FilterBase &filter, vector<FilterTaps> *result )
+{
+	const float scale = srcLength / (float)dstLength;
+	const float filterScale = std::max( 1.0f, scale );
+	const float support = std::max( 0.5f, filter.getSupport() * filterScale );
+
+	result->resize( dstLength );
+	for( int32_t d = 0; d < dstLength; ++d ) {
+		const float center = ( d + 0.5f ) * scale;
+		const int32_t start = std::max<int32_t>( 0, (int32_t)floor( center - support ) );
+		const int32_t end = std::min<int32_t>( srcLength, (int32_t)ceil( center + support ) );
+		FilterTaps &taps = (*result)[d];
+		taps.start = start;
+		taps.weights.clear();
+		float sum = 0;
+		for( int32_t s = start; s < end; ++s ) {
+			float weight = filter( ( s + 0.5f - center ) / filterScale );
+			taps.weights.push_back( weight );
+			sum += weight;
+		}
+
+		if( sum == 0 ) { // degenerate filter; point sample instead
+			taps.start = std::min<int32_t>( srcLength - 1, (int32_t)center );
+			taps.weights.assign( 1, 1.0f );
+		}
+		else {
+			for( size_t t = 0; t < taps.weights.size(); ++t )
+				taps.weights[t] /= sum;
+		}
+	}
+}
+
+template<typename T>
+inline T fromFloat( float v )
+{
+	return static_cast<T>( std::min( std::max( v, 0.0f ), 1.0f ) * CHANTRAIT<T>::max() + 0.5f );
+}
+
+template<>
+inline float fromFloat<float>( float v )
+{
+	return v;
+}
+
+} // anonymous namespace
+
+template<typename T>
+vector<SurfaceT<T> > generateMipmaps( const SurfaceT<T> &srcSurface, const FilterBase &filter, bool srgb, int maxLevels )
+{
+	vector<SurfaceT<T> > result;
+	const int32_t srcWidth = srcSurface.getWidth(), srcHeight = srcSurface.getHeight();
+	if( srcWidth <= 0 || srcHeight <= 0 )
+		return result;
+
+	int numLevels = 0;
+	for( int32_t w = srcWidth, h = srcHeight; w > 1 || h > 1; w = std::max( 1, w / 2 ), h = std::max( 1, h / 2 ) )
+		++numLevels;
+	if( maxLevels > 0 )
+		numLevels = std::min( numLevels, maxLevels );
+	if( numLevels == 0 )
+		return result;
+
+	const bool hasAlpha = srcSurface.hasAlpha();
+	const bool srcPremultiplied = hasAlpha && srcSurface.isPremultiplied();
+	// filtering happens on linear, premultiplied values; these decide what has to be undone on either side
+	const bool unpremultiplySource = srcPremultiplied && srgb;
+	const bool premultiplyWorking = hasAlpha && ( ! srcPremultiplied || srgb );
+	const int32_t numChannels = hasAlpha ? 4 : 3;
+	const SurfaceChannelOrder &channelOrder = srcSurface.getChannelOrder();
+	const uint8_t pixelInc = channelOrder.getPixelInc();
+	const uint8_t offsets[4] = { channelOrder.getRedOffset(), channelOrder.getGreenOffset(), channelOrder.getBlueOffset(), hasAlpha ? channelOrder.getAlphaOffset() : (uint8_t)0 };
+
+	// an 8-bit source without premultiplication can decode sRGB through a table
+	vector<float> decodeTable;
+	if( srgb && ( CHANTRAIT<T>::max() == 255 ) && ! unpremultiplySource ) {
+		decodeTable.resize( 256 );
+		for( int v = 0; v < 256; ++v )
+			decodeTable[v] = srgbToLinear( v / 255.0f );
+	}
+
+	vector<float> working( (size_t)srcWidth * srcHeight * numChannels );
+	parallelFor( 0, srcHeight, 64, [&]( size_t rowBegin, size_t rowEnd ) {
+		for( size_t y = rowBegin; y < rowEnd; ++y ) {
+			const T *src = srcSurface.getData( Vec2i( 0, (int32_t)y ) );
+			float *dst = &working[y * srcWidth * numChannels];
+			for( int32_t x = 0; x < srcWidth; ++x, src += pixelInc, dst += numChannels ) {
+				const float alpha = hasAlpha ? CHANTRAIT<float>::convert( src[offsets[3]] ) : 1.0f;
+				for( int c = 0; c < 3; ++c ) {
+					if( ! decodeTable.empty() ) {
+						dst[c] = decodeTable[(size_t)src[offsets[c]]];
+					}
+					else {
+						float v = CHANTRAIT<float>::convert( src[offsets[c]] );
+						if( unpremultiplySource )
+							v = ( alpha > 0 ) ? ( v / alpha ) : 0;
+						dst[c] = srgb ? srgbToLinear( v ) : v;
+					}
+					if( premultiplyWorking )
+						dst[c] *= alpha;
+				}
+				if( hasAlpha )
+					dst[3] = alpha;
+			}
+		}
+	} );
+
+	// each level is filtered from the previous one, whose linear premultiplied values are kept in floating point so that nothing is requantized along the chain
+	vector<float> nextWorking;
+	vector<FilterTaps> xTaps, yTaps;
+	int32_t prevWidth = srcWidth, prevHeight = srcHeight;
+	for( int level = 0; level < numLevels; ++level ) {
+		const int32_t levelWidth = std::max( 1, prevWidth / 2 ), levelHeight = std::max( 1, prevHeight / 2 );
+		result.push_back( SurfaceT<T>( levelWidth, levelHeight, hasAlpha, channelOrder ) );
+		result.back().setPremultiplied( srcPremultiplied );
+		makeFilterTaps( prevWidth, levelWidth, filter, &xTaps );
+		makeFilterTaps( prevHeight, levelHeight, filter, &yTaps );
+		const bool lastLevel = ( level == numLevels - 1 );
+		if( ! lastLevel )
+			nextWorking.resize( (size_t)levelWidth * levelHeight * numChannels );
+
+		const int32_t numBands = ( levelHeight + ROWS_PER_BAND - 1 ) / ROWS_PER_BAND;
+		parallelFor( 0, numBands, 1, [&]( size_t bandBegin, size_t bandEnd ) {
+			vector<float> horizontal, accum;
+			for( size_t b = bandBegin; b < bandEnd; ++b ) {
+				const int32_t rowBegin = (int32_t)b * ROWS_PER_BAND, rowEnd = std::min( rowBegin + ROWS_PER_BAND, levelHeight );
+				SurfaceT<T> &dstSurface = result[level];
+				const size_t dstRowSize = (size_t)levelWidth * numChannels;
+
+				int32_t srcRowBegin = prevHeight, srcRowEnd = 0;
+				for( int32_t y = rowBegin; y < rowEnd; ++y ) {
+					srcRowBegin = std::min( srcRowBegin, yTaps[y].start );
+					srcRowEnd = std::max( srcRowEnd, yTaps[y].start + (int32_t)yTaps[y].weights.size() );
+				}
+
+				// filter the previous level's rows this band depends on horizontally
+				horizontal.resize( ( srcRowEnd - srcRowBegin ) * dstRowSize );
+				for( int32_t sy = srcRowBegin; sy < srcRowEnd; ++sy ) {
+					const float *srcRow = &working[(size_t)sy * prevWidth * numChannels];
+					float *out = &horizontal[( sy - srcRowBegin ) * dstRowSize];
+					for( int32_t dx = 0; dx < levelWidth; ++dx, out += numChannels ) {
+						const FilterTaps &taps = xTaps[dx];
+						const float *src = srcRow + taps.start * numChannels;
+						float sum[4] = { 0, 0, 0, 0 };
+						for( size_t t = 0; t < taps.weights.size(); ++t, src += numChannels )
+							for( int32_t c = 0; c < numChannels; ++c )
+								sum[c] += src[c] * taps.weights[t];
+						for( int32_t c = 0; c < numChannels; ++c )
+							out[c] = sum[c];
+					}
+				}
+
+				// then vertically, keeping the result for the next level and converting it back to the source's encoding
+				accum.resize( dstRowSize );
+				for( int32_t dy = rowBegin; dy < rowEnd; ++dy ) {
+					const FilterTaps &taps = yTaps[dy];
+					std::fill( accum.begin(), accum.end(), 0.0f );
+					for( size_t t = 0; t < taps.weights.size(); ++t ) {
+						const float *src = &horizontal[( taps.start + t - srcRowBegin ) * dstRowSize];
+						const float weight = taps.weights[t];
+						for( size_t i = 0; i < dstRowSize; ++i )
+							accum[i] += src[i] * weight;
+					}
+					if( ! lastLevel )
+						std::copy( accum.begin(), accum.end(), nextWorking.begin() + dy * dstRowSize );
+
+					T *dst = dstSurface.getData( Vec2i( 0, dy ) );
+					const float *src = &accum[0];
+					for( int32_t dx = 0; dx < levelWidth; ++dx, dst += pixelInc, src += numChannels ) {
+						const float alpha = hasAlpha ? std::min( std::max( src[3], 0.0f ), 1.0f ) : 1.0f;
+						for( int c = 0; c < 3; ++c ) {
+							float v = src[c];
+							if( premultiplyWorking )
+								v = ( alpha > 0 ) ? ( v / alpha ) : 0;
+							if( srgb )
+								v = linearToSrgb( v );
+							if( unpremultiplySource )
+								v *= alpha;
+							dst[offsets[c]] = fromFloat<T>( v );
+						}
+						if( hasAlpha )
+							dst[offsets[3]] = fromFloat<T>( alpha );
+					}
+				}
+			}
+		} );
+
+		working.swap( nextWorking );
+		prevWidth = levelWidth;
+		prevHeight = levelHeight;
+	}
+
+	return result;
+}
+
+#define mipmap_PROTOTYPES(r,data,T)\
+	template vector<SurfaceT<T> > generateMipmaps( const SurfaceT<T> &srcSurface, const FilterBase &filter, bool srgb, int maxLevels );
+
+BOOST_PP_SEQ_FOR_EACH( mipmap_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} } // namespace cinder::ip
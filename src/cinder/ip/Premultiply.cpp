@@ -22,102 +22,236 @@
 
 #include "cinder/ip/Premultiply.h"
 #include "cinder/ChanTraits.h"
+#include "cinder/ip/ParallelRows.h"
 
 #include <boost/preprocessor/seq.hpp>
 #include <algorithm>
+#include <mutex>
+#if defined( CINDER_SSE2 )
+	#include <emmintrin.h>
+#endif
 
 namespace cinder { namespace ip {
 
-// this is a candidate for sse2
+namespace {
+
 template<typename T>
-void premultiply( SurfaceT<T> *surface )
+void premultiplyRow( T *dstPtr, int32_t width, uint8_t pixelInc, uint8_t redOffset, uint8_t greenOffset, uint8_t blueOffset, uint8_t alphaOffset )
 {
-	const Area clippedArea = surface->getBounds();
+	for( int32_t x = 0; x < width; ++x ) {
+		T alpha = dstPtr[alphaOffset];
+		dstPtr[redOffset] = CHANTRAIT<T>::premultiply( dstPtr[redOffset], alpha );
+		dstPtr[greenOffset] = CHANTRAIT<T>::premultiply( dstPtr[greenOffset], alpha );
+		dstPtr[blueOffset] = CHANTRAIT<T>::premultiply( dstPtr[blueOffset], alpha );
+		dstPtr += pixelInc;
+	}
+}
 
-	if( ! surface->hasAlpha() )
-		return;
+void unpremultiplyRow( uint8_t *dstPtr, int32_t width, uint8_t pixelInc, uint8_t redOffset, uint8_t greenOffset, uint8_t blueOffset, uint8_t alphaOffset )
+{
+	for( int32_t x = 0; x < width; ++x ) {
+		// The basic formula for unpremultiplication is to divide by the alpha
+		// which in 8bit pixel arithmetic is to multiply by 255 and divide by the alpha
+		uint8_t alpha = dstPtr[alphaOffset];
+		if( alpha ) {
+			dstPtr[redOffset] = std::min<int>( dstPtr[redOffset] * 255 / alpha, 255 );
+			dstPtr[greenOffset] = std::min<int>( dstPtr[greenOffset] * 255 / alpha, 255 );
+			dstPtr[blueOffset] = std::min<int>( dstPtr[blueOffset] * 255 / alpha, 255 );
+		}
+		dstPtr += pixelInc;
+	}
+}
 
-	surface->setPremultiplied( true );
+void unpremultiplyRow( float *dstPtr, int32_t width, uint8_t pixelInc, uint8_t redOffset, uint8_t greenOffset, uint8_t blueOffset, uint8_t alphaOffset )
+{
+	for( int32_t x = 0; x < width; ++x ) {
+		// The basic formula for unpremultiplication is to divide by the alpha
+		if( dstPtr[alphaOffset] != 0 ) {
+			float invAlpha = 1.0f / dstPtr[alphaOffset];
+			dstPtr[redOffset] *= invAlpha;
+			dstPtr[greenOffset] *= invAlpha;
+			dstPtr[blueOffset] *= invAlpha;
+		}
+		dstPtr += pixelInc;
+	}
+}
 
-	int32_t rowBytes = surface->getRowBytes();
-	uint8_t pixelInc = surface->getPixelInc();
-	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
-	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
-		T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes );
-		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
-			// The basic formula for unpremultiplication is to divide by the alpha
-			T alpha = dstPtr[alphaOffset];
-			
-			dstPtr[redOffset] = CHANTRAIT<T>::premultiply( dstPtr[redOffset], alpha );
-			dstPtr[greenOffset] = CHANTRAIT<T>::premultiply( dstPtr[greenOffset], alpha );
-			dstPtr[blueOffset] = CHANTRAIT<T>::premultiply( dstPtr[blueOffset], alpha );
-			dstPtr += pixelInc;
+#if defined( CINDER_SSE2 )
+// 255 / alpha, nudged up so that truncating c * 255 / alpha lands on the same integer as the scalar divide; alpha 0 leaves the pixel alone
+struct UnpremultiplyTable {
+	UnpremultiplyTable()
+	{
+		mReciprocals[0] = 1.0f;
+		for( int a = 1; a < 256; ++a )
+			mReciprocals[a] = (float)( 255.0 / a ) * ( 1.0f + 1.0f / ( 1 << 20 ) );
+	}
+
+	float	mReciprocals[256];
+};
+
+std::once_flag sUnpremultiplyTableFlag;
+const UnpremultiplyTable *sUnpremultiplyTable = NULL;
+
+const UnpremultiplyTable& getUnpremultiplyTable()
+{
+	// VS2012's function-local statics aren't thread-safe, and the table is first read from parallelFor() workers
+	std::call_once( sUnpremultiplyTableFlag, [] { sUnpremultiplyTable = new UnpremultiplyTable; } );
+	return *sUnpremultiplyTable;
+}
+
+// ALPHA is the alpha channel's offset, 0 or 3; the SIMD paths only handle 4-channel pixels
+template<int ALPHA>
+void premultiplyRowSse( uint8_t *dstPtr, int32_t width )
+{
+	const __m128i alphaMask = _mm_set1_epi32( 0xFF << ( ALPHA * 8 ) );
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i div255 = _mm_set1_epi16( (short)0x8081 );
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4, dstPtr += 16 ) {
+		__m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( dstPtr ) );
+		__m128i lo = _mm_unpacklo_epi8( pixels, zero ), hi = _mm_unpackhi_epi8( pixels, zero );
+		// broadcast each pixel's alpha across its four 16-bit lanes
+		__m128i alphaLo = _mm_shufflehi_epi16( _mm_shufflelo_epi16( lo, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) ), _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+		__m128i alphaHi = _mm_shufflehi_epi16( _mm_shufflelo_epi16( hi, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) ), _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+		// c * a / 255, truncated like the scalar divide: ( x * 0x8081 ) >> 23 is exact for every product of two bytes
+		lo = _mm_srli_epi16( _mm_mulhi_epu16( _mm_mullo_epi16( lo, alphaLo ), div255 ), 7 );
+		hi = _mm_srli_epi16( _mm_mulhi_epu16( _mm_mullo_epi16( hi, alphaHi ), div255 ), 7 );
+		__m128i result = _mm_packus_epi16( lo, hi );
+		result = _mm_or_si128( _mm_and_si128( pixels, alphaMask ), _mm_andnot_si128( alphaMask, result ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dstPtr ), result );
+	}
+	
+	premultiplyRow<uint8_t>( dstPtr, width - x, 4, ( ALPHA + 1 ) & 3, ( ALPHA + 2 ) & 3, ( ALPHA + 3 ) & 3, ALPHA );
+}
+
+template<int ALPHA>
+void unpremultiplyRowSse( uint8_t *dstPtr, int32_t width )
+{
+	const float *reciprocals = getUnpremultiplyTable().mReciprocals;
+	const __m128 alphaLane = _mm_castsi128_ps( _mm_setr_epi32( ALPHA == 0 ? -1 : 0, 0, 0, ALPHA == 3 ? -1 : 0 ) );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128i zero = _mm_setzero_si128();
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4, dstPtr += 16 ) {
+		__m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( dstPtr ) );
+		__m128i lo = _mm_unpacklo_epi8( pixels, zero ), hi = _mm_unpackhi_epi8( pixels, zero );
+		__m128i channels[4] = { _mm_unpacklo_epi16( lo, zero ), _mm_unpackhi_epi16( lo, zero ), _mm_unpacklo_epi16( hi, zero ), _mm_unpackhi_epi16( hi, zero ) };
+		for( int p = 0; p < 4; ++p ) {
+			// the alpha lane is multiplied by one, leaving it intact
+			__m128 scale = _mm_or_ps( _mm_andnot_ps( alphaLane, _mm_set1_ps( reciprocals[dstPtr[p * 4 + ALPHA]] ) ), _mm_and_ps( alphaLane, one ) );
+			channels[p] = _mm_cvttps_epi32( _mm_mul_ps( _mm_cvtepi32_ps( channels[p] ), scale ) );
 		}
+		// saturation on packing clamps to 255
+		__m128i result = _mm_packus_epi16( _mm_packs_epi32( channels[0], channels[1] ), _mm_packs_epi32( channels[2], channels[3] ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dstPtr ), result );
+	}
+
+	unpremultiplyRow( dstPtr, width - x, 4, ( ALPHA + 1 ) & 3, ( ALPHA + 2 ) & 3, ( ALPHA + 3 ) & 3, ALPHA );
+}
+
+template<int ALPHA>
+void premultiplyRowSse( float *dstPtr, int32_t width )
+{
+	const __m128 alphaLane = _mm_castsi128_ps( _mm_setr_epi32( ALPHA == 0 ? -1 : 0, 0, 0, ALPHA == 3 ? -1 : 0 ) );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	for( int32_t x = 0; x < width; ++x, dstPtr += 4 ) {
+		__m128 pixel = _mm_loadu_ps( dstPtr );
+		__m128 alpha = _mm_shuffle_ps( pixel, pixel, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+		__m128 scale = _mm_or_ps( _mm_andnot_ps( alphaLane, alpha ), _mm_and_ps( alphaLane, one ) );
+		_mm_storeu_ps( dstPtr, _mm_mul_ps( pixel, scale ) );
+	}
+}
+
+template<int ALPHA>
+void unpremultiplyRowSse( float *dstPtr, int32_t width )
+{
+	const __m128 alphaLane = _mm_castsi128_ps( _mm_setr_epi32( ALPHA == 0 ? -1 : 0, 0, 0, ALPHA == 3 ? -1 : 0 ) );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 zero = _mm_setzero_ps();
+	for( int32_t x = 0; x < width; ++x, dstPtr += 4 ) {
+		__m128 pixel = _mm_loadu_ps( dstPtr );
+		__m128 alpha = _mm_shuffle_ps( pixel, pixel, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+		// a zero alpha, like the alpha lane itself, is multiplied by one
+		__m128 keep = _mm_or_ps( alphaLane, _mm_cmpeq_ps( alpha, zero ) );
+		__m128 scale = _mm_or_ps( _mm_andnot_ps( keep, _mm_div_ps( one, alpha ) ), _mm_and_ps( keep, one ) );
+		_mm_storeu_ps( dstPtr, _mm_mul_ps( pixel, scale ) );
 	}
 }
+#endif
 
-// this is a candidate for sse2
-template<>
-void unpremultiply<uint8_t>( SurfaceT<uint8_t> *surface )
+// returns the alpha offset the SIMD row functions handle for this surface's layout, or -1
+template<typename T>
+int simdAlphaOffset( const SurfaceT<T> *surface )
 {
-	const Area clippedArea = surface->getBounds();
+#if defined( CINDER_SSE2 )
+	if( surface->getPixelInc() == 4 ) {
+		const uint8_t alphaOffset = surface->getAlphaOffset();
+		if( alphaOffset == 0 || alphaOffset == 3 )
+			return alphaOffset;
+	}
+#endif
+	return -1;
+}
 
+} // anonymous namespace
+
+template<typename T>
+void premultiply( SurfaceT<T> *surface )
+{
 	if( ! surface->hasAlpha() )
 		return;
 
-	surface->setPremultiplied( false );
+	surface->setPremultiplied( true );
 
-	int32_t rowBytes = surface->getRowBytes();
+#if defined( CINDER_SSE2 )
+	const int simdAlpha = simdAlphaOffset( surface );
+	if( simdAlpha == 0 ) {
+		impl::forEachRow( surface, []( T *row, int32_t width ) { premultiplyRowSse<0>( row, width ); } );
+		return;
+	}
+	else if( simdAlpha == 3 ) {
+		impl::forEachRow( surface, []( T *row, int32_t width ) { premultiplyRowSse<3>( row, width ); } );
+		return;
+	}
+#endif
+	
 	uint8_t pixelInc = surface->getPixelInc();
 	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
-	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
-		uint8_t *dstPtr = reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes;
-		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
-			// The basic formula for unpremultiplication is to divide by the alpha
-			// which in 8bit pixel arithmetic is to multiply by 255 and divide by the alpha
-			uint8_t alpha = dstPtr[alphaOffset];
-			if( alpha ) {
-				dstPtr[redOffset] = std::min<int>( dstPtr[redOffset] * 255 / alpha, 255 );
-				dstPtr[greenOffset] = std::min<int>( dstPtr[greenOffset] * 255 / alpha, 255 );
-				dstPtr[blueOffset] = std::min<int>( dstPtr[blueOffset] * 255 / alpha, 255 );
-			}
-			dstPtr += pixelInc;
-		}
-	}	
+	impl::forEachRow( surface, [=]( T *row, int32_t width ) {
+		premultiplyRow( row, width, pixelInc, redOffset, greenOffset, blueOffset, alphaOffset );
+	} );
 }
 
-template<>
-void unpremultiply<float>( SurfaceT<float> *surface )
+template<typename T>
+void unpremultiply( SurfaceT<T> *surface )
 {
-	const Area clippedArea = surface->getBounds();
-
 	if( ! surface->hasAlpha() )
 		return;
 
 	surface->setPremultiplied( false );
 
-	int32_t rowBytes = surface->getRowBytes();
+#if defined( CINDER_SSE2 )
+	const int simdAlpha = simdAlphaOffset( surface );
+	if( simdAlpha == 0 ) {
+		impl::forEachRow( surface, []( T *row, int32_t width ) { unpremultiplyRowSse<0>( row, width ); } );
+		return;
+	}
+	else if( simdAlpha == 3 ) {
+		impl::forEachRow( surface, []( T *row, int32_t width ) { unpremultiplyRowSse<3>( row, width ); } );
+		return;
+	}
+#endif
+
 	uint8_t pixelInc = surface->getPixelInc();
 	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
-	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
-		float *dstPtr = reinterpret_cast<float*>( reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes );
-		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
-			// The basic formula for unpremultiplication is to divide by the alpha
-			if( dstPtr[alphaOffset] != 0 ) {
-				float invAlpha = 1.0f / dstPtr[alphaOffset];
-				dstPtr[redOffset] *= invAlpha;
-				dstPtr[greenOffset] *= invAlpha;
-				dstPtr[blueOffset] *= invAlpha;
-			}
-			dstPtr += pixelInc;
-		}
-	}	
+	impl::forEachRow( surface, [=]( T *row, int32_t width ) {
+		unpremultiplyRow( row, width, pixelInc, redOffset, greenOffset, blueOffset, alphaOffset );
+	} );
 }
 
-
-
 #define premult_PROTOTYPES(r,data,T)\
-	template void premultiply( SurfaceT<T> *Surface );
+	template void premultiply( SurfaceT<T> *Surface );\
+	template void unpremultiply( SurfaceT<T> *Surface );
 
 BOOST_PP_SEQ_FOR_EACH( premult_PROTOTYPES, ~, CHANNEL_TYPES )
 	
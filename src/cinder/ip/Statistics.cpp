@@ -0,0 +1,531 @@
+/*
+ Copyright (c) 2014, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Statistics.h"
+#include "cinder/ip/ParallelRows.h"
+
+#include <boost/preprocessor/seq.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#if defined( CINDER_SSE2 )
+	#include <emmintrin.h>
+#endif
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// Pixels are reduced as runs of 'inc' elements; lane i collects element i of every pixel. Only the first 'numLanes' lanes are read, so a Channel inside
+// a Surface (numLanes 1) never touches memory past its own last element.
+
+struct LaneSums {
+	LaneSums() { std::fill( mSums, mSums + 4, 0.0 ); }
+
+	void	merge( const LaneSums &other )	{ for( int c = 0; c < 4; ++c ) mSums[c] += other.mSums[c]; }
+
+	double	mSums[4];
+};
+
+template<typename T>
+struct LaneMinMax {
+	LaneMinMax() { std::fill( mMin, mMin + 4, std::numeric_limits<T>::max() ); std::fill( mMax, mMax + 4, std::numeric_limits<T>::lowest() ); }
+
+	void	merge( const LaneMinMax &other )	{ for( int c = 0; c < 4; ++c ) { mMin[c] = std::min( mMin[c], other.mMin[c] ); mMax[c] = std::max( mMax[c], other.mMax[c] ); } }
+
+	T		mMin[4], mMax[4];
+};
+
+// calls rowFn( rowPtr, width, partial ) for each row of area, in parallel chunks for large areas, each chunk reducing into its own copy of init before being merged into the result
+template<typename T, typename R, typename ROWFN>
+R reduceArea( const T *data, int32_t rowBytes, int8_t inc, const Area &area, const R &init, const ROWFN &rowFn )
+{
+	R result = init;
+	std::mutex resultMutex;
+	const int32_t width = area.getWidth();
+	const uint8_t *base = reinterpret_cast<const uint8_t*>( data + area.x1 * inc );
+	impl::forEachRowChunk( area.y1, area.y2, width, [&]( size_t rowBegin, size_t rowEnd ) {
+		R partial = init;
+		for( size_t y = rowBegin; y < rowEnd; ++y )
+			rowFn( reinterpret_cast<const T*>( base + y * rowBytes ), width, partial );
+		std::lock_guard<std::mutex> lock( resultMutex );
+		result.merge( partial );
+	} );
+	
+	return result;
+}
+
+template<typename T>
+void sumRowScalar( const T *row, int32_t width, int8_t inc, int8_t numLanes, LaneSums *result )
+{
+	double sums[4] = { 0, 0, 0, 0 };
+	for( int32_t x = 0; x < width; ++x, row += inc )
+		for( int8_t c = 0; c < numLanes; ++c )
+			sums[c] += row[c];
+	for( int8_t c = 0; c < numLanes; ++c )
+		result->mSums[c] += sums[c];
+}
+
+template<typename T>
+void minMaxRowScalar( const T *row, int32_t width, int8_t inc, int8_t numLanes, LaneMinMax<T> *result )
+{
+	for( int32_t x = 0; x < width; ++x, row += inc ) {
+		for( int8_t c = 0; c < numLanes; ++c ) {
+			result->mMin[c] = std::min( result->mMin[c], row[c] );
+			result->mMax[c] = std::max( result->mMax[c], row[c] );
+		}
+	}
+}
+
+// The row kernels are chosen per element type; the SSE2 ones handle 1 to 4 elements per pixel and leave the rest to the scalar loops
+template<typename T>
+class RowKernels {
+  public:
+	RowKernels( int8_t inc, int8_t numLanes ) : mInc( inc ), mNumLanes( numLanes ) {}
+
+	void	sum( const T *row, int32_t width, LaneSums *result ) const				{ sumRowScalar( row, width, mInc, mNumLanes, result ); }
+	void	minMax( const T *row, int32_t width, LaneMinMax<T> *result ) const		{ minMaxRowScalar( row, width, mInc, mNumLanes, result ); }
+
+  private:
+	int8_t		mInc, mNumLanes;
+};
+
+#if defined( CINDER_SSE2 )
+// Blocks of 16 pixels are held in 'inc' registers, so byte j of register k always belongs to lane ( 16 * k + j ) % inc.
+template<>
+class RowKernels<uint8_t> {
+  public:
+	RowKernels( int8_t inc, int8_t numLanes )
+		: mInc( inc ), mNumLanes( numLanes ), mSimd( inc >= 1 && inc <= 4 )
+	{}
+
+	void sum( const uint8_t *row, int32_t width, LaneSums *result ) const
+	{
+		int32_t x = 0;
+		if( mSimd ) {
+			// even and odd bytes are summed in 16-bit lanes, which hold 256 blocks before being widened into 32-bit lanes
+			const __m128i zero = _mm_setzero_si128(), lowBytes = _mm_set1_epi16( 0x00FF );
+			__m128i wide[4][4]; // per register: even bytes 0-7, even bytes 8-15, odd bytes 0-7, odd bytes 8-15
+			for( int k = 0; k < mInc; ++k )
+				for( int i = 0; i < 4; ++i )
+					wide[k][i] = zero;
+			const int32_t end = simdWidth( width );
+			while( x + 16 <= end ) {
+				__m128i even[4] = { zero, zero, zero, zero }, odd[4] = { zero, zero, zero, zero };
+				for( int blocks = 0; blocks < 256 && x + 16 <= end; ++blocks, x += 16, row += 16 * mInc ) {
+					for( int k = 0; k < mInc; ++k ) {
+						const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( row + 16 * k ) );
+						even[k] = _mm_add_epi16( even[k], _mm_and_si128( v, lowBytes ) );
+						odd[k] = _mm_add_epi16( odd[k], _mm_srli_epi16( v, 8 ) );
+					}
+				}
+				for( int k = 0; k < mInc; ++k ) {
+					wide[k][0] = _mm_add_epi32( wide[k][0], _mm_unpacklo_epi16( even[k], zero ) );
+					wide[k][1] = _mm_add_epi32( wide[k][1], _mm_unpackhi_epi16( even[k], zero ) );
+					wide[k][2] = _mm_add_epi32( wide[k][2], _mm_unpacklo_epi16( odd[k], zero ) );
+					wide[k][3] = _mm_add_epi32( wide[k][3], _mm_unpackhi_epi16( odd[k], zero ) );
+				}
+			}
+			for( int k = 0; k < mInc; ++k ) {
+				for( int i = 0; i < 4; ++i ) {
+					uint32_t sums[4];
+					_mm_storeu_si128( reinterpret_cast<__m128i*>( sums ), wide[k][i] );
+					for( int j = 0; j < 4; ++j ) {
+						const int byte = 2 * ( ( i & 1 ) * 4 + j ) + ( i >> 1 );
+						const int c = ( 16 * k + byte ) % mInc;
+						if( c < mNumLanes )
+							result->mSums[c] += sums[j];
+					}
+				}
+			}
+		}
+		sumRowScalar( row, width - x, mInc, mNumLanes, result );
+	}
+
+	void minMax( const uint8_t *row, int32_t width, LaneMinMax<uint8_t> *result ) const
+	{
+		int32_t x = 0;
+		if( mSimd ) {
+			__m128i minAcc[4], maxAcc[4];
+			for( int k = 0; k < mInc; ++k ) {
+				minAcc[k] = _mm_set1_epi8( (char)0xFF );
+				maxAcc[k] = _mm_setzero_si128();
+			}
+			for( ; x + 16 <= simdWidth( width ); x += 16, row += 16 * mInc ) {
+				for( int k = 0; k < mInc; ++k ) {
+					const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( row + 16 * k ) );
+					minAcc[k] = _mm_min_epu8( minAcc[k], v );
+					maxAcc[k] = _mm_max_epu8( maxAcc[k], v );
+				}
+			}
+			for( int k = 0; k < mInc; ++k ) {
+				uint8_t mins[16], maxs[16];
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( mins ), minAcc[k] );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( maxs ), maxAcc[k] );
+				for( int j = 0; j < 16; ++j ) {
+					const int c = ( 16 * k + j ) % mInc;
+					if( c < mNumLanes ) {
+						result->mMin[c] = std::min( result->mMin[c], mins[j] );
+						result->mMax[c] = std::max( result->mMax[c], maxs[j] );
+					}
+				}
+			}
+		}
+		minMaxRowScalar( row, width - x, mInc, mNumLanes, result );
+	}
+
+  private:
+	// when only some lanes are read, the last pixel's unread elements may lie past the end of the data, so it is left to the scalar loop
+	int32_t		simdWidth( int32_t width ) const { return ( mNumLanes < mInc ) ? width - 1 : width; }
+
+	int8_t		mInc, mNumLanes;
+	bool		mSimd;
+};
+
+// Blocks of 4 pixels are held in 'inc' registers, so element j of register k always belongs to lane ( 4 * k + j ) % inc.
+template<>
+class RowKernels<float> {
+  public:
+	RowKernels( int8_t inc, int8_t numLanes )
+		: mInc( inc ), mNumLanes( numLanes ), mSimd( inc >= 1 && inc <= 4 )
+	{}
+
+	void sum( const float *row, int32_t width, LaneSums *result ) const
+	{
+		int32_t x = 0;
+		if( mSimd ) {
+			// each row is summed in single precision and added to the double precision total
+			__m128 acc[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+			for( ; x + 4 <= simdWidth( width ); x += 4, row += 4 * mInc )
+				for( int k = 0; k < mInc; ++k )
+					acc[k] = _mm_add_ps( acc[k], _mm_loadu_ps( row + 4 * k ) );
+			for( int k = 0; k < mInc; ++k ) {
+				float sums[4];
+				_mm_storeu_ps( sums, acc[k] );
+				for( int j = 0; j < 4; ++j ) {
+					const int c = ( 4 * k + j ) % mInc;
+					if( c < mNumLanes )
+						result->mSums[c] += sums[j];
+				}
+			}
+		}
+		sumRowScalar( row, width - x, mInc, mNumLanes, result );
+	}
+
+	void minMax( const float *row, int32_t width, LaneMinMax<float> *result ) const
+	{
+		int32_t x = 0;
+		if( mSimd ) {
+			__m128 minAcc[4], maxAcc[4];
+			for( int k = 0; k < mInc; ++k ) {
+				minAcc[k] = _mm_set1_ps( std::numeric_limits<float>::max() );
+				maxAcc[k] = _mm_set1_ps( std::numeric_limits<float>::lowest() );
+			}
+			for( ; x + 4 <= simdWidth( width ); x += 4, row += 4 * mInc ) {
+				for( int k = 0; k < mInc; ++k ) {
+					const __m128 v = _mm_loadu_ps( row + 4 * k );
+					minAcc[k] = _mm_min_ps( minAcc[k], v );
+					maxAcc[k] = _mm_max_ps( maxAcc[k], v );
+				}
+			}
+			for( int k = 0; k < mInc; ++k ) {
+				float mins[4], maxs[4];
+				_mm_storeu_ps( mins, minAcc[k] );
+				_mm_storeu_ps( maxs, maxAcc[k] );
+				for( int j = 0; j < 4; ++j ) {
+					const int c = ( 4 * k + j ) % mInc;
+					if( c < mNumLanes ) {
+						result->mMin[c] = std::min( result->mMin[c], mins[j] );
+						result->mMax[c] = std::max( result->mMax[c], maxs[j] );
+					}
+				}
+			}
+		}
+		minMaxRowScalar( row, width - x, mInc, mNumLanes, result );
+	}
+
+  private:
+	int32_t		simdWidth( int32_t width ) const { return ( mNumLanes < mInc ) ? width - 1 : width; }
+
+	int8_t		mInc, mNumLanes;
+	bool		mSimd;
+};
+#endif
+
+template<typename T>
+LaneSums sumArea( const T *data, int32_t rowBytes, int8_t inc, int8_t numLanes, const Area &area )
+{
+	const RowKernels<T> kernels( inc, numLanes );
+	return reduceArea( data, rowBytes, inc, area, LaneSums(), [&]( const T *row, int32_t width, LaneSums &partial ) {
+		kernels.sum( row, width, &partial );
+	} );
+}
+
+template<typename T>
+LaneMinMax<T> minMaxArea( const T *data, int32_t rowBytes, int8_t inc, int8_t numLanes, const Area &area )
+{
+	const RowKernels<T> kernels( inc, numLanes );
+	return reduceArea( data, rowBytes, inc, area, LaneMinMax<T>(), [&]( const T *row, int32_t width, LaneMinMax<T> &partial ) {
+		kernels.minMax( row, width, &partial );
+	} );
+}
+
+// one histogram of numBins per lane, stored consecutively
+struct LaneHistograms {
+	LaneHistograms( int8_t numLanes, int32_t numBins ) : mNumBins( numBins ), mCounts( numLanes * numBins, 0 ) {}
+
+	void	merge( const LaneHistograms &other )	{ for( size_t i = 0; i < mCounts.size(); ++i ) mCounts[i] += other.mCounts[i]; }
+
+	int32_t					mNumBins;
+	std::vector<uint32_t>	mCounts;
+};
+
+template<typename T>
+LaneHistograms histogramArea( const T *data, int32_t rowBytes, int8_t inc, const int8_t *laneOffsets, int8_t numLanes, const Area &area, int32_t numBins, float rangeMin, float rangeMax )
+{
+	// 8-bit values spanning [0,255] in 256 bins index their bin directly
+	const bool direct = ( sizeof(T) == 1 ) && numBins == 256 && rangeMin == 0 && rangeMax == 255;
+	const float scale = ( rangeMax > rangeMin ) ? numBins / ( rangeMax - rangeMin ) : 0;
+	return reduceArea( data, rowBytes, inc, area, LaneHistograms( numLanes, numBins ), [&]( const T *row, int32_t width, LaneHistograms &partial ) {
+		for( int8_t c = 0; c < numLanes; ++c ) {
+			uint32_t *counts = &partial.mCounts[c * numBins];
+			const T *src = row + laneOffsets[c];
+			if( direct ) {
+				for( int32_t x = 0; x < width; ++x, src += inc )
+					++counts[(size_t)*src];
+			}
+			else {
+				for( int32_t x = 0; x < width; ++x, src += inc ) {
+					const float bin = ( *src - rangeMin ) * scale;
+					// written so that NaN lands in the first bin
+					++counts[( ! ( bin >= 0 ) ) ? 0 : ( bin >= numBins ) ? numBins - 1 : (int32_t)bin];
+				}
+			}
+		}
+	} );
+}
+
+struct LuminanceSums {
+	LuminanceSums() : mSum( 0 ), mLogSum( 0 ), mMin( std::numeric_limits<float>::max() ), mMax( std::numeric_limits<float>::lowest() ) {}
+
+	void	merge( const LuminanceSums &other )	{ mSum += other.mSum; mLogSum += other.mLogSum; mMin = std::min( mMin, other.mMin ); mMax = std::max( mMax, other.mMax ); }
+
+	double	mSum, mLogSum;
+	float	mMin, mMax;
+};
+
+const float LUMINANCE_LOG_DELTA = 0.0001f;
+
+} // anonymous namespace
+
+template<typename T>
+Vec4d calcSum( const SurfaceT<T> &surface, const Area &area )
+{
+	const Area clipped( area.getClipBy( surface.getBounds() ) );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return Vec4d::zero();
+
+	const int8_t inc = surface.getPixelInc();
+	const LaneSums sums = sumArea( surface.getData(), surface.getRowBytes(), inc, inc, clipped );
+	return Vec4d( sums.mSums[surface.getRedOffset()], sums.mSums[surface.getGreenOffset()], sums.mSums[surface.getBlueOffset()], surface.hasAlpha() ? sums.mSums[surface.getAlphaOffset()] : 0 );
+}
+
+template<typename T>
+double calcSum( const ChannelT<T> &channel, const Area &area )
+{
+	const Area clipped( area.getClipBy( channel.getBounds() ) );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return 0;
+
+	return sumArea( channel.getData(), channel.getRowBytes(), channel.getIncrement(), 1, clipped ).mSums[0];
+}
+
+template<typename T>
+ColorA calcMean( const SurfaceT<T> &surface, const Area &area )
+{
+	const Area clipped( area.getClipBy( surface.getBounds() ) );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return ColorA( 0, 0, 0, 0 );
+
+	const Vec4d mean = calcSum( surface, clipped ) / ( (double)clipped.getWidth() * clipped.getHeight() );
+	return ColorA( (float)mean.x, (float)mean.y, (float)mean.z, (float)mean.w );
+}
+
+template<typename T>
+float calcMean( const ChannelT<T> &channel, const Area &area )
+{
+	const Area clipped( area.getClipBy( channel.getBounds() ) );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return 0;
+
+	return (float)( calcSum( channel, clipped ) / ( (double)clipped.getWidth() * clipped.getHeight() ) );
+}
+
+template<typename T>
+void getMinMax( const SurfaceT<T> &surface, const Area &area, ColorAT<T> *resultMin, ColorAT<T> *resultMax )
+{
+	const Area clipped( area.getClipBy( surface.getBounds() ) );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 ) {
+		*resultMin = *resultMax = ColorAT<T>( 0, 0, 0, 0 );
+		return;
+	}
+
+	const int8_t inc = surface.getPixelInc();
+	const LaneMinMax<T> minMax = minMaxArea( surface.getData(), surface.getRowBytes(), inc, inc, clipped );
+	const uint8_t red = surface.getRedOffset(), green = surface.getGreenOffset(), blue = surface.getBlueOffset();
+	*resultMin = ColorAT<T>( minMax.mMin[red], minMax.mMin[green], minMax.mMin[blue], surface.hasAlpha() ? minMax.mMin[surface.getAlphaOffset()] : CHANTRAIT<T>::max() );
+	*resultMax = ColorAT<T>( minMax.mMax[red], minMax.mMax[green], minMax.mMax[blue], surface.hasAlpha() ? minMax.mMax[surface.getAlphaOffset()] : CHANTRAIT<T>::max() );
+}
+
+template<typename T>
+void getMinMax( const ChannelT<T> &channel, const Area &area, T *resultMin, T *resultMax )
+{
+	const Area clipped( area.getClipBy( channel.getBounds() ) );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 ) {
+		*resultMin = *resultMax = 0;
+		return;
+	}
+
+	const LaneMinMax<T> minMax = minMaxArea( channel.getData(), channel.getRowBytes(), channel.getIncrement(), 1, clipped );
+	*resultMin = minMax.mMin[0];
+	*resultMax = minMax.mMax[0];
+}
+
+template<typename T>
+void calcHistogram( const ChannelT<T> &channel, const Area &area, std::vector<uint32_t> *result, int32_t numBins, float rangeMin, float rangeMax )
+{
+	result->assign( std::max<int32_t>( numBins, 1 ), 0 );
+	const Area clipped( area.getClipBy( channel.getBounds() ) );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return;
+
+	const int8_t laneOffsets[1] = { 0 };
+	*result = histogramArea( channel.getData(), channel.getRowBytes(), channel.getIncrement(), laneOffsets, 1, clipped, (int32_t)result->size(), rangeMin, rangeMax ).mCounts;
+}
+
+template<typename T>
+void calcHistogram( const SurfaceT<T> &surface, const Area &area, std::vector<uint32_t> *resultRed, std::vector<uint32_t> *resultGreen, std::vector<uint32_t> *resultBlue, std::vector<uint32_t> *resultAlpha,
+					int32_t numBins, float rangeMin, float rangeMax )
+{
+	numBins = std::max<int32_t>( numBins, 1 );
+	std::vector<uint32_t>* results[4] = { resultRed, resultGreen, resultBlue, resultAlpha };
+	for( int c = 0; c < 4; ++c )
+		if( results[c] )
+			results[c]->assign( numBins, 0 );
+
+	const Area clipped( area.getClipBy( surface.getBounds() ) );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return;
+
+	const int8_t numLanes = ( resultAlpha && surface.hasAlpha() ) ? 4 : 3;
+	const int8_t laneOffsets[4] = { (int8_t)surface.getRedOffset(), (int8_t)surface.getGreenOffset(), (int8_t)surface.getBlueOffset(), (int8_t)surface.getAlphaOffset() };
+	const LaneHistograms histograms = histogramArea( surface.getData(), surface.getRowBytes(), surface.getPixelInc(), laneOffsets, numLanes, clipped, numBins, rangeMin, rangeMax );
+	for( int c = 0; c < numLanes; ++c )
+		if( results[c] )
+			std::copy( histograms.mCounts.begin() + c * numBins, histograms.mCounts.begin() + ( c + 1 ) * numBins, results[c]->begin() );
+}
+
+template<typename T>
+LuminanceStats calcLuminanceStats( const SurfaceT<T> &surface, const Area &area )
+{
+	LuminanceStats result;
+	const Area clipped( area.getClipBy( surface.getBounds() ) );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return result;
+
+	const int8_t inc = surface.getPixelInc();
+	const uint8_t red = surface.getRedOffset(), green = surface.getGreenOffset(), blue = surface.getBlueOffset();
+	const float invMax = 1.0f / CHANTRAIT<T>::max();
+	const LuminanceSums sums = reduceArea( surface.getData(), surface.getRowBytes(), inc, clipped, LuminanceSums(), [&]( const T *row, int32_t width, LuminanceSums &partial ) {
+		for( int32_t x = 0; x < width; ++x, row += inc ) {
+			const float luminance = CHANTRAIT<float>::grayscale( row[red] * invMax, row[green] * invMax, row[blue] * invMax );
+			partial.mSum += luminance;
+			partial.mLogSum += std::log( LUMINANCE_LOG_DELTA + luminance );
+			partial.mMin = std::min( partial.mMin, luminance );
+			partial.mMax = std::max( partial.mMax, luminance );
+		}
+	} );
+
+	const double numPixels = (double)clipped.getWidth() * clipped.getHeight();
+	result.mMin = sums.mMin;
+	result.mMax = sums.mMax;
+	result.mMean = (float)( sums.mSum / numPixels );
+	result.mLogMean = (float)std::exp( sums.mLogSum / numPixels );
+	return result;
+}
+
+// 8-bit luma takes only 256 values, so a histogram of it yields every statistic with one logarithm per bin
+template<>
+LuminanceStats calcLuminanceStats( const SurfaceT<uint8_t> &surface, const Area &area )
+{
+	LuminanceStats result;
+	const Area clipped( area.getClipBy( surface.getBounds() ) );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return result;
+
+	const int8_t inc = surface.getPixelInc();
+	const uint8_t red = surface.getRedOffset(), green = surface.getGreenOffset(), blue = surface.getBlueOffset();
+	const LaneHistograms histogram = reduceArea( surface.getData(), surface.getRowBytes(), inc, clipped, LaneHistograms( 1, 256 ), [&]( const uint8_t *row, int32_t width, LaneHistograms &partial ) {
+		uint32_t *counts = &partial.mCounts[0];
+		for( int32_t x = 0; x < width; ++x, row += inc )
+			++counts[CHANTRAIT<uint8_t>::grayscale( row[red], row[green], row[blue] )];
+	} );
+
+	double sum = 0, logSum = 0;
+	int minLuma = 255, maxLuma = 0;
+	for( int luma = 0; luma < 256; ++luma ) {
+		const uint32_t count = histogram.mCounts[luma];
+		if( ! count )
+			continue;
+		const float luminance = luma / 255.0f;
+		sum += (double)count * luminance;
+		logSum += count * std::log( (double)( LUMINANCE_LOG_DELTA + luminance ) );
+		minLuma = std::min( minLuma, luma );
+		maxLuma = std::max( maxLuma, luma );
+	}
+
+	const double numPixels = (double)clipped.getWidth() * clipped.getHeight();
+	result.mMin = minLuma / 255.0f;
+	result.mMax = maxLuma / 255.0f;
+	result.mMean = (float)( sum / numPixels );
+	result.mLogMean = (float)std::exp( logSum / numPixels );
+	return result;
+}
+
+#define statistics_PROTOTYPES(r,data,T)\
+	template Vec4d calcSum( const SurfaceT<T> &surface, const Area &area );\
+	template double calcSum( const ChannelT<T> &channel, const Area &area );\
+	template ColorA calcMean( const SurfaceT<T> &surface, const Area &area );\
+	template float calcMean( const ChannelT<T> &channel, const Area &area );\
+	template void getMinMax( const SurfaceT<T> &surface, const Area &area, ColorAT<T> *resultMin, ColorAT<T> *resultMax );\
+	template void getMinMax( const ChannelT<T> &channel, const Area &area, T *resultMin, T *resultMax );\
+	template void calcHistogram( const ChannelT<T> &channel, const Area &area, std::vector<uint32_t> *result, int32_t numBins, float rangeMin, float rangeMax );\
+	template void calcHistogram( const SurfaceT<T> &surface, const Area &area, std::vector<uint32_t> *resultRed, std::vector<uint32_t> *resultGreen, std::vector<uint32_t> *resultBlue, std::vector<uint32_t> *resultAlpha, int32_t numBins, float rangeMin, float rangeMax );
+
+BOOST_PP_SEQ_FOR_EACH( statistics_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+
+template LuminanceStats calcLuminanceStats( const SurfaceT<uint16_t> &surface, const Area &area );
+template LuminanceStats calcLuminanceStats( const SurfaceT<float> &surface, const Area &area );
+
+} } // namespace cinder::ip
@@ -22,13 +22,104 @@
 
 #include "cinder/ip/Threshold.h"
 #include "cinder/ChanTraits.h"
+#include "cinder/ip/ParallelRows.h"
 
 #include <stdlib.h>
 #include <boost/preprocessor/seq.hpp>
+#include <algorithm>
+#if defined( CINDER_SSE2 )
+	#include <emmintrin.h>
+#endif
 
 
 namespace cinder { namespace ip {
 
+namespace {
+
+// Thresholds runs of elements where every element is a color value (packed Channels and 3-element pixels), or 4-element pixels where the elements
+// set in keepBits belong to the destination and are left alone. Returns the number of elements handled; the rest are left to the caller.
+template<typename T>
+size_t thresholdElementsSimd( const T * /*src*/, T * /*dst*/, size_t /*numElements*/, T /*value*/, uint8_t /*keepBits*/ )
+{
+	return 0;
+}
+
+#if defined( CINDER_SSE2 )
+inline __m128i keepMaskElements( uint8_t keepBits, int elementBytes )
+{
+	uint8_t bytes[16];
+	for( int i = 0; i < 16; ++i )
+		bytes[i] = ( keepBits & ( 1 << ( ( i / elementBytes ) % 4 ) ) ) ? 0xFF : 0;
+	return _mm_loadu_si128( reinterpret_cast<const __m128i*>( bytes ) );
+}
+
+// unsigned comparison by flipping the sign bits; all-ones is the maximum value for the integer types
+template<>
+size_t thresholdElementsSimd<uint8_t>( const uint8_t *src, uint8_t *dst, size_t numElements, uint8_t value, uint8_t keepBits )
+{
+	const __m128i signBits = _mm_set1_epi8( (char)0x80 ), threshold = _mm_set1_epi8( (char)( value ^ 0x80 ) );
+	const __m128i keep = keepMaskElements( keepBits, 1 );
+	size_t i = 0;
+	for( ; i + 16 <= numElements; i += 16 ) {
+		const __m128i above = _mm_cmpgt_epi8( _mm_xor_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) ), signBits ), threshold );
+		const __m128i old = _mm_loadu_si128( reinterpret_cast<const __m128i*>( dst + i ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_or_si128( _mm_and_si128( old, keep ), _mm_andnot_si128( keep, above ) ) );
+	}
+	return i;
+}
+
+template<>
+size_t thresholdElementsSimd<uint16_t>( const uint16_t *src, uint16_t *dst, size_t numElements, uint16_t value, uint8_t keepBits )
+{
+	const __m128i signBits = _mm_set1_epi16( (short)0x8000 ), threshold = _mm_set1_epi16( (short)( value ^ 0x8000 ) );
+	const __m128i keep = keepMaskElements( keepBits, 2 );
+	size_t i = 0;
+	for( ; i + 8 <= numElements; i += 8 ) {
+		const __m128i above = _mm_cmpgt_epi16( _mm_xor_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) ), signBits ), threshold );
+		const __m128i old = _mm_loadu_si128( reinterpret_cast<const __m128i*>( dst + i ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_or_si128( _mm_and_si128( old, keep ), _mm_andnot_si128( keep, above ) ) );
+	}
+	return i;
+}
+
+template<>
+size_t thresholdElementsSimd<float>( const float *src, float *dst, size_t numElements, float value, uint8_t keepBits )
+{
+	const __m128 threshold = _mm_set1_ps( value ), maxValue = _mm_set1_ps( CHANTRAIT<float>::max() );
+	const __m128 keep = _mm_castsi128_ps( keepMaskElements( keepBits, 4 ) );
+	size_t i = 0;
+	for( ; i + 4 <= numElements; i += 4 ) {
+		const __m128 above = _mm_and_ps( _mm_cmpgt_ps( _mm_loadu_ps( src + i ), threshold ), maxValue );
+		const __m128 old = _mm_loadu_ps( dst + i );
+		_mm_storeu_ps( dst + i, _mm_or_ps( _mm_and_ps( old, keep ), _mm_andnot_ps( keep, above ) ) );
+	}
+	return i;
+}
+#endif
+
+// thresholds numElements elements, 4-element pixels keeping the elements in keepBits
+template<typename T>
+void thresholdElements( const T *src, T *dst, size_t numElements, T value, uint8_t keepBits )
+{
+	const T maxValue = CHANTRAIT<T>::max();
+	for( size_t i = thresholdElementsSimd( src, dst, numElements, value, keepBits ); i < numElements; ++i )
+		if( ! ( keepBits & ( 1 << ( i % 4 ) ) ) )
+			dst[i] = ( src[i] > value ) ? maxValue : 0;
+}
+
+// returns the elements of a pixel outside red, green and blue, or -1 when the layout can't be thresholded as a run of elements
+inline int keepBitsForLayout( uint8_t pixelInc, uint8_t redOffset, uint8_t greenOffset, uint8_t blueOffset )
+{
+	if( pixelInc == 3 )
+		return 0;
+	else if( pixelInc == 4 )
+		return 0xF & ~( ( 1 << redOffset ) | ( 1 << greenOffset ) | ( 1 << blueOffset ) );
+	else
+		return -1;
+}
+
+} // anonymous namespace
+
 template<typename T>
 void thresholdImpl( SurfaceT<T> *surface, T value, const Area &area )
 {
@@ -36,16 +127,22 @@ void thresholdImpl( SurfaceT<T> *surface, T value, const Area &area )
 	int32_t rowBytes = surface->getRowBytes();
 	uint8_t pixelInc = surface->getPixelInc();
 	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset();
+	const int keepBits = keepBitsForLayout( pixelInc, redOffset, greenOffset, blueOffset );
 	T maxValue = CHANTRAIT<T>::max();
-	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
+	impl::forEachRow( 0, clippedArea.getHeight(), clippedArea.getWidth(), [&]( int32_t row ) {
+		const int32_t y = clippedArea.getY1() + row;
 		T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes );
+		if( keepBits >= 0 ) {
+			thresholdElements<T>( dstPtr, dstPtr, clippedArea.getWidth() * pixelInc, value, (uint8_t)keepBits );
+			return;
+		}
 		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
 			dstPtr[redOffset] = ( dstPtr[redOffset] > value ) ? maxValue : 0;
 			dstPtr[greenOffset] = ( dstPtr[greenOffset] > value ) ? maxValue : 0;
-			dstPtr[blueOffset] = ( dstPtr[blueOffset] > value ) ? maxValue : 0;;
+			dstPtr[blueOffset] = ( dstPtr[blueOffset] > value ) ? maxValue : 0;
 			dstPtr += pixelInc;
 		}
-	}	
+	} );
 }
 
 template<typename T>
@@ -61,18 +158,25 @@ void thresholdImpl( const SurfaceT<T> &srcSurface, T value, const Area &srcArea,
 	int32_t dstRowBytes = dstSurface->getRowBytes();
 	int8_t dstPixelInc = dstSurface->getPixelInc();
 	uint8_t dstRedOffset = dstSurface->getRedOffset(), dstGreenOffset = dstSurface->getGreenOffset(), dstBlueOffset = dstSurface->getBlueOffset();
+	// matching layouts are thresholded as runs of elements
+	const bool sameLayout = srcPixelInc == dstPixelInc && srcRedOffset == dstRedOffset && srcGreenOffset == dstGreenOffset && srcBlueOffset == dstBlueOffset;
+	const int keepBits = sameLayout ? keepBitsForLayout( dstPixelInc, dstRedOffset, dstGreenOffset, dstBlueOffset ) : -1;
 	const T maxValue = CHANTRAIT<T>::max();
-	for( int32_t y = 0; y < area.getHeight(); ++y ) {
+	impl::forEachRow( 0, area.getHeight(), area.getWidth(), [&]( int32_t y ) {
 		T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( dstSurface->getData() + ( dstOffset.x + area.getX1() ) * dstPixelInc ) + ( y + dstOffset.y ) * dstRowBytes );
 		const T *srcPtr = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + area.getX1() * srcPixelInc ) + ( y + area.getY1() ) * srcRowBytes );
+		if( keepBits >= 0 ) {
+			thresholdElements<T>( srcPtr, dstPtr, area.getWidth() * dstPixelInc, value, (uint8_t)keepBits );
+			return;
+		}
 		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
 			dstPtr[dstRedOffset] = ( srcPtr[srcRedOffset] > value ) ? maxValue : 0;
 			dstPtr[dstGreenOffset] = ( srcPtr[srcGreenOffset] > value ) ? maxValue : 0;
-			dstPtr[dstBlueOffset] = ( srcPtr[srcBlueOffset] > value ) ? maxValue : 0;;			
+			dstPtr[dstBlueOffset] = ( srcPtr[srcBlueOffset] > value ) ? maxValue : 0;
 			dstPtr += dstPixelInc;
 			srcPtr += srcPixelInc;
 		}
-	}
+	} );
 }
 
 template<typename T>
@@ -85,15 +189,19 @@ void thresholdImpl( const ChannelT<T> &srcChannel, T value, const Area &srcArea,
 	int8_t srcInc = srcChannel.getIncrement();
 	int8_t dstInc = dstChannel->getIncrement();
 	const T maxValue = CHANTRAIT<T>::max();
-	for( int32_t y = 0; y < area.getHeight(); ++y ) {
+	impl::forEachRow( 0, area.getHeight(), area.getWidth(), [&]( int32_t y ) {
 		T *dstPtr = dstChannel->getData( Vec2i( area.getX1(), y ) + dstOffset );
 		const T *srcPtr = srcChannel.getData( Vec2i( area.getX1(), y ) );
+		if( srcInc == 1 && dstInc == 1 ) {
+			thresholdElements<T>( srcPtr, dstPtr, area.getWidth(), value, 0 );
+			return;
+		}
 		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
 			*dstPtr = ( *srcPtr > value ) ? maxValue : 0;
 			dstPtr += dstInc;
 			srcPtr += srcInc;
 		}
-	}
+	} );
 }
 
 template<typename T>
@@ -364,13 +472,16 @@ template class AdaptiveThresholdT<float>;
 	template void threshold( SurfaceT<T> *surface, T value ); \
 	template void threshold( SurfaceT<T> *surface, T value, const Area &area ); \
 	template void threshold( const SurfaceT<T> &srcSurface, T value, SurfaceT<T> *dstSurface );\
-	template void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel );\
+	template void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel );
+
+#define adaptiveThreshold_PROTOTYPES(r,data,T)\
 	template void adaptiveThreshold( const ChannelT<T> &srcChannel, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel ); \
 	template void adaptiveThreshold( ChannelT<T> *channel, int32_t windowSize, float percentageDelta ); \
 	template void adaptiveThresholdZero( ChannelT<T> *channel, int32_t windowSize ); \
 	template void adaptiveThresholdZero( const ChannelT<T> &srcChannel, int32_t windowSize, ChannelT<T> *dstChannel );
 
-BOOST_PP_SEQ_FOR_EACH( threshold_PROTOTYPES, ~, (uint8_t) )
+BOOST_PP_SEQ_FOR_EACH( threshold_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+BOOST_PP_SEQ_FOR_EACH( adaptiveThreshold_PROTOTYPES, ~, (uint8_t) )
 
 
 } } // namespace cinder::ip
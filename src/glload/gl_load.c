@@ -12177,6 +12177,9 @@ static void ProcExtsFromExtString(const char *strExtList)
 
 void ogl_CopyFromC();
 
+/*Core in 4.4 and ARB_buffer_storage, which the generated loader predates.*/
+PFNGLBUFFERSTORAGEPROC _funcptr_glBufferStorage = NULL;
+
 static int g_majorVersion = 0;
 static int g_minorVersion = 0;
 
@@ -12246,6 +12249,8 @@ static int InternalLoad()
 			return ogl_LOAD_FAILED;
 	}
 	
+	_funcptr_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)IntGetProcAddress("glBufferStorage");
+	
 	return ogl_LOAD_SUCCEEDED + numFailed;
 }
 
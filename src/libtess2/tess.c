@@ -523,6 +523,8 @@ TESStesselator* tessNewTess( TESSalloc* alloc )
 	tess->elements = 0;
 	tess->elementCount = 0;
 
+	tess->outOfMemory = 0;
+
 	return tess;
 }
 
@@ -826,6 +828,9 @@ int tessTesselate( TESStesselator *tess, int windingRule, int elementType,
 		tess->alloc.memfree( tess->alloc.userData, tess->elements );
 		tess->elements = 0;
 	}
+	tess->vertexCount = 0;
+	tess->elementCount = 0;
+	tess->outOfMemory = 0;
 
 	if (normal)
 	{
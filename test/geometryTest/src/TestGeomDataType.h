@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+inline uint32_t FloatBits( float f )
+{
+	uint32_t bits;
+	memcpy( &bits, &f, sizeof(bits) );
+	return bits;
+}
+
+// Returns the next float after \a f, away from zero when \a up
+inline float NextFloat( float f, bool up )
+{
+	uint32_t bits = FloatBits( f ) + ( up ? 1 : -1 );
+	memcpy( &f, &bits, sizeof(f) );
+	return f;
+}
+
+// Round-to-nearest-even float to half conversion, computed in double rather than on the bits
+inline uint16_t RefFloatToHalf( float f )
+{
+	const uint16_t sign = uint16_t( FloatBits( f ) >> 16 ) & 0x8000;
+	const double a = std::fabs( double( f ) );
+	if( a != a )
+		return sign | 0x7e00;
+	if( a >= 65520.0 ) // halfway between the largest half, 65504, and 65536 rounds to even, which is infinity
+		return sign | 0x7c00;
+	if( a == 0 )
+		return sign;
+
+	int exp;
+	std::frexp( a, &exp );
+	const int halfExp = std::max( exp - 1, -14 ); // subnormals share the smallest normal exponent's spacing
+	const double scaled = std::ldexp( a, 10 - halfExp ); // exact
+	double steps = std::floor( scaled );
+	if( scaled - steps > 0.5 || ( scaled - steps == 0.5 && std::fmod( steps, 2.0 ) == 1 ) ) // half to even
+		steps += 1;
+	if( exp - 1 < -14 )
+		return sign | uint16_t( steps ); // 1024 steps is the smallest normal
+	return sign | uint16_t( ( ( halfExp + 15 ) << 10 ) + int( steps ) - 1024 ); // 2048 steps carries into the next exponent
+}
+
+// The scalar encoders' rounding: half away from zero, after clamping with NaN taken to \a lower
+inline int32_t RefQuantize( float v, float lower, float scale )
+{
+	const float clamped = ( v >= lower ) ? ( ( v > 1 ) ? 1 : v ) : lower;
+	const float scaled = clamped * scale;
+	return int32_t( ( scaled >= 0 ) ? ( scaled + 0.5f ) : ( scaled - 0.5f ) );
+}
+
+// Encodes \a v as \a dataType the way the scalar kernels of geom::copyData() do, into 4 bytes or 8 for half and 16-bit
+inline void RefEncode( geom::DataType dataType, const float *v, uint8_t *out )
+{
+	for( int i = 0; i < 4; ++i ) {
+		switch( dataType ) {
+			case geom::DataType::HALF_FLOAT: reinterpret_cast<uint16_t*>( out )[i] = RefFloatToHalf( v[i] ); break;
+			case geom::DataType::INT8_NORM: reinterpret_cast<int8_t*>( out )[i] = int8_t( RefQuantize( v[i], -1, 127 ) ); break;
+			case geom::DataType::UINT8_NORM: out[i] = uint8_t( RefQuantize( v[i], 0, 255 ) ); break;
+			case geom::DataType::INT16_NORM: reinterpret_cast<int16_t*>( out )[i] = int16_t( RefQuantize( v[i], -1, 32767 ) ); break;
+			case geom::DataType::UINT16_NORM: reinterpret_cast<uint16_t*>( out )[i] = uint16_t( RefQuantize( v[i], 0, 65535 ) ); break;
+			default: break;
+		}
+	}
+
+	uint32_t packed = 0;
+	if( dataType == geom::DataType::INT_10_10_10_2_NORM ) {
+		for( int i = 0; i < 3; ++i )
+			packed |= ( uint32_t( RefQuantize( v[i], -1, 511 ) ) & 0x3ff ) << ( i * 10 );
+		packed |= uint32_t( RefQuantize( v[3], -1, 1 ) ) << 30;
+	}
+	else if( dataType == geom::DataType::UINT_10_10_10_2_NORM ) {
+		for( int i = 0; i < 3; ++i )
+			packed |= uint32_t( RefQuantize( v[i], 0, 1023 ) ) << ( i * 10 );
+		packed |= uint32_t( RefQuantize( v[3], 0, 3 ) ) << 30;
+	}
+	else
+		return;
+	memcpy( out, &packed, sizeof(packed) );
+}
+
+// Returns whether geom::copyData() encodes every 4-component element of \a values as RefEncode() does
+inline bool IsEncodedExactly( geom::DataType dataType, const std::vector<float> &values )
+{
+	const size_t numElements = values.size() / 4, elementBytes = geom::dataTypeByteSize( dataType, 4 );
+	std::vector<uint8_t> encoded( numElements * elementBytes ), expected( numElements * elementBytes );
+	geom::copyData( 4, values.data(), numElements, 4, dataType, 0, encoded.data() );
+	for( size_t e = 0; e < numElements; ++e )
+		RefEncode( dataType, &values[e * 4], &expected[e * elementBytes] );
+	return encoded == expected;
+}
+
+// Special values, values around the rounding ties of every format, and random values across the float range, in every component position
+inline std::vector<float> MakeEncodeValues()
+{
+	const float inf = std::numeric_limits<float>::infinity(), nan = std::numeric_limits<float>::quiet_NaN();
+	const float denorm = std::numeric_limits<float>::denorm_min(), minNormal = std::numeric_limits<float>::min();
+	std::vector<float> special;
+	const float specials[] = { 0, 1, 0.5f, 2, 100, 1e10f, 65504, 65519.99f, 65520, 65536, 1e-5f, 6.1035156e-5f, 5.9604645e-8f, 2.9802322e-8f,
+								2.9802326e-8f, 8.940697e-8f, 1 + 1.0f / 2048, 1 + 3.0f / 2048, 1.0f / 3, inf, nan, denorm, minNormal,
+								std::numeric_limits<float>::max() };
+	for( size_t s = 0; s < sizeof(specials) / sizeof(specials[0]); ++s ) {
+		special.push_back( specials[s] );
+		special.push_back( -specials[s] );
+	}
+	const float scales[] = { 3, 127, 255, 511, 1023, 32767, 65535 };
+	for( size_t s = 0; s < sizeof(scales) / sizeof(scales[0]); ++s ) {
+		for( int step = 0; step <= 8; ++step ) {
+			const float tie = ( step + 0.5f ) / scales[s];
+			special.push_back( tie );
+			special.push_back( -tie );
+			special.push_back( NextFloat( tie, false ) );
+			special.push_back( NextFloat( tie, true ) );
+		}
+	}
+
+	std::vector<float> values;
+	// each special value in each component position, with the others cycling through the list
+	for( size_t s = 0; s < special.size(); ++s ) {
+		for( int c = 0; c < 4; ++c )
+			values.push_back( special[( s + c * 7 ) % special.size()] );
+	}
+	Rand rnd( 7 );
+	for( int i = 0; i < 40000; ++i ) {
+		const uint32_t bits = rnd.nextUint();
+		float f;
+		memcpy( &f, &bits, sizeof(f) );
+		values.push_back( ( i % 2 ) ? f : rnd.nextFloat( -1.5f, 1.5f ) );
+	}
+	return values;
+}
+
+inline void TestGeomDataType( std::ostream& os )
+{
+	const std::vector<float> values = MakeEncodeValues();
+
+	// void copyData( ..., DataType dstDataType, ... ); HALF_FLOAT
+	{
+		// every half is decoded exactly, and encodes back to itself
+		bool result = IsEncodedExactly( geom::DataType::HALF_FLOAT, values );
+		std::vector<uint16_t> halves;
+		for( uint32_t h = 0; h < 0x10000; ++h ) {
+			if( ( h & 0x7c00 ) != 0x7c00 || ( h & 0x3ff ) == 0 ) // NaNs aren't preserved
+				halves.push_back( uint16_t( h ) );
+		}
+		std::vector<float> decoded( halves.size() );
+		geom::unpackData( geom::DataType::HALF_FLOAT, 1, sizeof(uint16_t), halves.data(), halves.size(), decoded.data() );
+		for( size_t h = 0; h < halves.size() && result; ++h )
+			result = RefFloatToHalf( decoded[h] ) == halves[h];
+		result = result && IsEncodedExactly( geom::DataType::HALF_FLOAT, decoded );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void copyData( ..., DataType dstDataType, ... ); HALF_FLOAT" << "\n";
+	}
+
+	// void copyData( ..., DataType dstDataType, ... ); INT_10_10_10_2_NORM, UINT_10_10_10_2_NORM
+	{
+		bool result = IsEncodedExactly( geom::DataType::INT_10_10_10_2_NORM, values ) && IsEncodedExactly( geom::DataType::UINT_10_10_10_2_NORM, values );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void copyData( ..., DataType dstDataType, ... ); INT_10_10_10_2_NORM, UINT_10_10_10_2_NORM" << "\n";
+	}
+
+	// void copyData( ..., DataType dstDataType, ... ); INT8_NORM, UINT8_NORM, INT16_NORM, UINT16_NORM
+	{
+		bool result = IsEncodedExactly( geom::DataType::INT8_NORM, values ) && IsEncodedExactly( geom::DataType::UINT8_NORM, values )
+					&& IsEncodedExactly( geom::DataType::INT16_NORM, values ) && IsEncodedExactly( geom::DataType::UINT16_NORM, values );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void copyData( ..., DataType dstDataType, ... ); INT8_NORM, UINT8_NORM, INT16_NORM, UINT16_NORM" << "\n";
+	}
+}
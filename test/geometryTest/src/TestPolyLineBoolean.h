@@ -0,0 +1,352 @@
+#pragma once
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/point_xy.hpp>
+#include <boost/geometry/geometries/polygon.hpp>
+#include <boost/geometry/multi/multi.hpp>
+
+// The boost::geometry path PolyLine used before PolygonClipper, kept as the reference implementation
+typedef boost::geometry::model::d2::point_xy<double>	BoostPoint;
+typedef boost::geometry::model::polygon<BoostPoint>		BoostPolygon;
+
+inline BoostPolygon PolyLinesToBoost( const std::vector<PolyLine2f> &a )
+{
+	BoostPolygon result;
+	for( std::vector<Vec2f>::const_iterator ptIt = a[0].begin(); ptIt != a[0].end(); ++ptIt )
+		result.outer().push_back( BoostPoint( ptIt->x, ptIt->y ) );
+	for( size_t h = 1; h < a.size(); ++h ) {
+		result.inners().push_back( BoostPolygon::ring_type() );
+		for( std::vector<Vec2f>::const_iterator ptIt = a[h].begin(); ptIt != a[h].end(); ++ptIt )
+			result.inners().back().push_back( BoostPoint( ptIt->x, ptIt->y ) );
+	}
+	boost::geometry::correct( result );
+	return result;
+}
+
+inline std::vector<BoostPolygon> CalcBoostBoolean( PolygonClipper::Operation op, const std::vector<PolyLine2f> &a, const std::vector<PolyLine2f> &b )
+{
+	BoostPolygon polyA = PolyLinesToBoost( a ), polyB = PolyLinesToBoost( b );
+	std::vector<BoostPolygon> output;
+	switch( op ) {
+		case PolygonClipper::UNION: boost::geometry::union_( polyA, polyB, output ); break;
+		case PolygonClipper::INTERSECTION: boost::geometry::intersection( polyA, polyB, output ); break;
+		case PolygonClipper::XOR: boost::geometry::sym_difference( polyA, polyB, output ); break;
+		case PolygonClipper::DIFFERENCE: boost::geometry::difference( polyA, polyB, output ); break;
+	}
+	return output;
+}
+
+inline std::vector<PolyLine2f> CalcPolyLineBoolean( PolygonClipper::Operation op, const std::vector<PolyLine2f> &a, std::vector<PolyLine2f> b )
+{
+	switch( op ) {
+		case PolygonClipper::UNION: return PolyLine2f::calcUnion( a, b );
+		case PolygonClipper::INTERSECTION: return PolyLine2f::calcIntersection( a, b );
+		case PolygonClipper::XOR: return PolyLine2f::calcXor( a, b );
+		default: return PolyLine2f::calcDifference( a, b );
+	}
+}
+
+inline double CalcBoostArea( const std::vector<BoostPolygon> &polygons )
+{
+	double result = 0;
+	for( size_t i = 0; i < polygons.size(); ++i )
+		result += boost::geometry::area( polygons[i] );
+	return result;
+}
+
+inline bool BoostContains( const std::vector<BoostPolygon> &polygons, const Vec2f &pt )
+{
+	for( size_t i = 0; i < polygons.size(); ++i ) {
+		if( boost::geometry::within( BoostPoint( pt.x, pt.y ), polygons[i] ) )
+			return true;
+	}
+	return false;
+}
+
+// Outer contours are counter-clockwise and holes clockwise, so the signed areas sum to the covered area
+inline double CalcPolyLinesArea( const std::vector<PolyLine2f> &contours )
+{
+	double result = 0;
+	for( size_t c = 0; c < contours.size(); ++c ) {
+		const std::vector<Vec2f> &pts = contours[c].getPoints();
+		for( size_t i = 0; i < pts.size(); ++i ) {
+			const Vec2f &p0 = pts[i], &p1 = pts[( i + 1 ) % pts.size()];
+			result += ( (double)p0.x * p1.y - (double)p1.x * p0.y ) * 0.5;
+		}
+	}
+	return result;
+}
+
+inline bool PolyLinesContain( const std::vector<PolyLine2f> &contours, const Vec2f &pt )
+{
+	bool inside = false;
+	for( size_t c = 0; c < contours.size(); ++c )
+		inside ^= contours[c].contains( pt );
+	return inside;
+}
+
+inline float DistanceToSegment( const Vec2f &pt, const Vec2f &a, const Vec2f &b )
+{
+	Vec2f ab = b - a;
+	float t = math<float>::clamp( ( pt - a ).dot( ab ) / std::max( ab.lengthSquared(), 1.0e-12f ), 0, 1 );
+	return ( a + ab * t ).distance( pt );
+}
+
+inline float DistanceToContours( const std::vector<PolyLine2f> &contours, const Vec2f &pt )
+{
+	float result = std::numeric_limits<float>::max();
+	for( size_t c = 0; c < contours.size(); ++c ) {
+		const std::vector<Vec2f> &pts = contours[c].getPoints();
+		for( size_t i = 0; i < pts.size(); ++i )
+			result = std::min( result, DistanceToSegment( pt, pts[i], pts[( i + 1 ) % pts.size()] ) );
+	}
+	return result;
+}
+
+inline PolyLine2f MakeStar( Rand &rnd, const Vec2f &center, float minRadius, float maxRadius, int numPoints, bool clockwise = false )
+{
+	PolyLine2f result;
+	for( int i = 0; i < numPoints; ++i ) {
+		float angle = ( clockwise ? -1 : 1 ) * 2 * (float)M_PI * i / numPoints;
+		result.push_back( center + Vec2f( math<float>::cos( angle ), math<float>::sin( angle ) ) * rnd.nextFloat( minRadius, maxRadius ) );
+	}
+	return result;
+}
+
+inline std::vector<PolyLine2f> MakeRect( const Rectf &r )
+{
+	PolyLine2f result;
+	result.push_back( r.getUpperLeft() );
+	result.push_back( r.getUpperRight() );
+	result.push_back( r.getLowerRight() );
+	result.push_back( r.getLowerLeft() );
+	return std::vector<PolyLine2f>( 1, result );
+}
+
+// Compares area and point membership of the PolyLine result of every operation against boost::geometry. Sample points close to an input edge are skipped, since both sides snap or round there.
+inline bool ComparePolyLineBooleans( Rand &rnd, const std::vector<PolyLine2f> &a, const std::vector<PolyLine2f> &b, const Rectf &bounds, double *maxAreaError )
+{
+	std::vector<PolyLine2f> inputs( a );
+	inputs.insert( inputs.end(), b.begin(), b.end() );
+	double inputArea = boost::geometry::area( PolyLinesToBoost( a ) ) + boost::geometry::area( PolyLinesToBoost( b ) );
+
+	bool result = true;
+	for( int op = PolygonClipper::UNION; op <= PolygonClipper::DIFFERENCE; ++op ) {
+		std::vector<BoostPolygon> expected = CalcBoostBoolean( (PolygonClipper::Operation)op, a, b );
+		std::vector<PolyLine2f> actual = CalcPolyLineBoolean( (PolygonClipper::Operation)op, a, b );
+
+		double areaError = math<double>::abs( CalcPolyLinesArea( actual ) - CalcBoostArea( expected ) ) / inputArea;
+		*maxAreaError = std::max( *maxAreaError, areaError );
+		result = result && ( areaError < 1.0e-5 );
+
+		for( int s = 0; s < 200; ++s ) {
+			Vec2f pt( rnd.nextFloat( bounds.x1, bounds.x2 ), rnd.nextFloat( bounds.y1, bounds.y2 ) );
+			if( DistanceToContours( inputs, pt ) < bounds.getWidth() * 1.0e-4f )
+				continue;
+			result = result && ( PolyLinesContain( actual, pt ) == BoostContains( expected, pt ) );
+		}
+	}
+	return result;
+}
+
+inline void TestPolyLineBoolean( std::ostream& os )
+{
+	Rand rnd( 5489 );
+	const Rectf bounds( -200, -200, 200, 200 );
+	double maxAreaError = 0;
+
+	// static std::vector<PolyLine> calcUnion/calcIntersection/calcXor/calcDifference( const std::vector<PolyLine> &a, std::vector<PolyLine> &b );
+	{
+		bool result = true;
+		for( int i = 0; i < 200; ++i ) {
+			std::vector<PolyLine2f> a( 1, MakeStar( rnd, Vec2f( rnd.nextFloat( -50, 50 ), rnd.nextFloat( -50, 50 ) ), 20, 120, rnd.nextInt( 3, 64 ) ) );
+			std::vector<PolyLine2f> b( 1, MakeStar( rnd, Vec2f( rnd.nextFloat( -50, 50 ), rnd.nextFloat( -50, 50 ) ), 20, 120, rnd.nextInt( 3, 64 ) ) );
+			result = result && ComparePolyLineBooleans( rnd, a, b, bounds, &maxAreaError );
+		}
+		os << (result ? "passed" : "FAILED") << " : " << "random stars, union, intersection, xor and difference against boost::geometry" << "\n";
+	}
+
+	// polygons with holes; eight or more outer points at a radius of 90 or more keep the chords clear of the hole
+	{
+		bool result = true;
+		for( int i = 0; i < 100; ++i ) {
+			Vec2f centerA( rnd.nextFloat( -30, 30 ), rnd.nextFloat( -30, 30 ) ), centerB( rnd.nextFloat( -30, 30 ), rnd.nextFloat( -30, 30 ) );
+			std::vector<PolyLine2f> a, b;
+			a.push_back( MakeStar( rnd, centerA, 90, 150, rnd.nextInt( 8, 48 ) ) );
+			a.push_back( MakeStar( rnd, centerA, 20, 80, rnd.nextInt( 3, 48 ), true ) );
+			b.push_back( MakeStar( rnd, centerB, 90, 150, rnd.nextInt( 8, 48 ) ) );
+			b.push_back( MakeStar( rnd, centerB, 20, 80, rnd.nextInt( 3, 48 ), true ) );
+			result = result && ComparePolyLineBooleans( rnd, a, b, bounds, &maxAreaError );
+		}
+		os << (result ? "passed" : "FAILED") << " : " << "random stars with holes against boost::geometry" << "\n";
+	}
+
+	// shared and collinear edges, containment, disjoint operands
+	{
+		bool result = true;
+		const Rectf cases[][2] = {
+			{ Rectf( 0, 0, 100, 100 ), Rectf( 50, 0, 150, 100 ) },
+			{ Rectf( 0, 0, 100, 100 ), Rectf( 100, 0, 200, 100 ) },
+			{ Rectf( 0, 0, 100, 100 ), Rectf( 0, 0, 100, 100 ) },
+			{ Rectf( 0, 0, 100, 100 ), Rectf( 25, 25, 75, 75 ) },
+			{ Rectf( 0, 0, 100, 100 ), Rectf( 25, 0, 75, 50 ) },
+			{ Rectf( 0, 0, 100, 100 ), Rectf( 150, 150, 190, 190 ) }
+		};
+		for( size_t i = 0; i < sizeof( cases ) / sizeof( cases[0] ); ++i )
+			result = result && ComparePolyLineBooleans( rnd, MakeRect( cases[i][0] ), MakeRect( cases[i][1] ), bounds, &maxAreaError );
+		os << (result ? "passed" : "FAILED") << " : " << "rectangles with shared edges, containment and no overlap against boost::geometry" << "\n";
+	}
+
+	os << "   " << "largest area difference relative to the input area: " << maxAreaError << "\n";
+
+	// empty operands
+	{
+		std::vector<PolyLine2f> a = MakeRect( Rectf( 0, 0, 100, 100 ) ), empty;
+		bool result = PolyLine2f::calcIntersection( a, empty ).empty()
+					&& math<double>::abs( CalcPolyLinesArea( PolyLine2f::calcUnion( a, empty ) ) - 10000 ) < 1.0e-3
+					&& math<double>::abs( CalcPolyLinesArea( PolyLine2f::calcDifference( a, empty ) ) - 10000 ) < 1.0e-3
+					&& PolyLine2f::calcDifference( empty, a ).empty();
+		os << (result ? "passed" : "FAILED") << " : " << "empty operands" << "\n";
+	}
+
+	int iter = 1000;
+	os << "   " << "speed test, 12-gon against a viewport rectangle:" << "\n";
+	{
+		std::vector<PolyLine2f> viewport = MakeRect( Rectf( -100, -100, 100, 100 ) );
+		std::vector<std::vector<PolyLine2f> > polygons;
+		for( int i = 0; i < iter; ++i )
+			polygons.push_back( std::vector<PolyLine2f>( 1, MakeStar( rnd, Vec2f( rnd.nextFloat( -120, 120 ), rnd.nextFloat( -120, 120 ) ), 15, 25, 12 ) ) );
+		std::vector<PolyLine2f> output;
+
+		Timer timer;
+		timer.start();
+		for( int i = 0; i < iter; ++i )
+			CalcBoostBoolean( PolygonClipper::INTERSECTION, polygons[i], viewport );
+		timer.stop();
+		os << "   " << "   " << iter << " boost::geometry::intersection() calls took " << timer.getSeconds() << " seconds" << "\n";
+
+		PolygonClipper clipper;
+		timer.start();
+		for( int i = 0; i < iter; ++i ) {
+			clipper.clear();
+			clipper.addSubject( polygons[i] );
+			clipper.addClip( viewport );
+			clipper.calcBoolean( PolygonClipper::INTERSECTION, &output );
+		}
+		timer.stop();
+		os << "   " << "   " << iter << " reused PolygonClipper intersections took " << timer.getSeconds() << " seconds" << "\n";
+
+		timer.start();
+		for( int i = 0; i < iter; ++i )
+			output = PolyLine2f::calcIntersection( polygons[i], viewport );
+		timer.stop();
+		os << "   " << "   " << iter << " PolyLine2f::calcIntersection() calls took " << timer.getSeconds() << " seconds" << "\n";
+	}
+
+	iter = 200;
+	os << "   " << "speed test, 24-gon with a hole against a 16-gon, per operation:" << "\n";
+	{
+		std::vector<PolyLine2f> withHole( 1, MakeStar( rnd, Vec2f::zero(), 60, 100, 24 ) ), star( 1, MakeStar( rnd, Vec2f( 50, 20 ), 30, 70, 16 ) );
+		withHole.push_back( MakeStar( rnd, Vec2f( 10, 0 ), 20, 35, 10, true ) );
+		const char *names[] = { "union", "intersection", "xor", "difference" };
+		std::vector<PolyLine2f> output;
+		PolygonClipper clipper;
+		for( int op = PolygonClipper::UNION; op <= PolygonClipper::DIFFERENCE; ++op ) {
+			Timer timer;
+			timer.start();
+			for( int i = 0; i < iter; ++i )
+				CalcBoostBoolean( PolygonClipper::Operation( op ), withHole, star );
+			timer.stop();
+			const double boostSeconds = timer.getSeconds();
+
+			timer.start();
+			for( int i = 0; i < iter; ++i ) {
+				clipper.clear();
+				clipper.addSubject( withHole );
+				clipper.addClip( star );
+				clipper.calcBoolean( PolygonClipper::Operation( op ), &output );
+			}
+			timer.stop();
+			os << "   " << "   " << names[op] << ": boost::geometry " << boostSeconds * 1e6 / iter << "us, PolygonClipper " << timer.getSeconds() * 1e6 / iter << "us" << "\n";
+		}
+	}
+}
+
+inline void TestPolyLineOffset( std::ostream& os )
+{
+	Rand rnd( 7919 );
+
+	// static std::vector<PolyLine> calcOffset( const std::vector<PolyLine> &a, typename T::TYPE distance );
+	// Mitered offsets of a convex polygon whose corners stay within the miter limit are the polygon's edge half-planes, each moved by the distance.
+	{
+		bool result = true;
+		for( int i = 0; i < 100; ++i ) {
+			int numSides = rnd.nextInt( 4, 16 );
+			float radius = rnd.nextFloat( 40, 100 ), rotation = rnd.nextFloat( 0, 2 * (float)M_PI );
+			float distance = rnd.nextFloat( -0.4f, 0.6f ) * radius;
+			Vec2f center( rnd.nextFloat( -20, 20 ), rnd.nextFloat( -20, 20 ) );
+			PolyLine2f polygon;
+			for( int s = 0; s < numSides; ++s ) {
+				float angle = rotation + 2 * (float)M_PI * s / numSides;
+				polygon.push_back( center + Vec2f( math<float>::cos( angle ), math<float>::sin( angle ) ) * radius );
+			}
+
+			std::vector<PolyLine2f> offset = PolyLine2f::calcOffset( std::vector<PolyLine2f>( 1, polygon ), distance );
+			for( int s = 0; s < 200; ++s ) {
+				Vec2f pt = center + Vec2f( rnd.nextFloat( -2, 2 ), rnd.nextFloat( -2, 2 ) ) * radius;
+				// largest signed distance outside any edge line
+				float outside = -std::numeric_limits<float>::max();
+				for( int e = 0; e < numSides; ++e ) {
+					Vec2f p0 = polygon.getPoints()[e], p1 = polygon.getPoints()[( e + 1 ) % numSides];
+					Vec2f normal = Vec2f( p1.y - p0.y, p0.x - p1.x ).normalized();
+					outside = std::max( outside, ( pt - p0 ).dot( normal ) );
+				}
+				if( math<float>::abs( outside - distance ) < radius * 1.0e-3f )
+					continue;
+				result = result && ( PolyLinesContain( offset, pt ) == ( outside < distance ) );
+			}
+		}
+		os << (result ? "passed" : "FAILED") << " : " << "static std::vector<PolyLine> calcOffset( const std::vector<PolyLine> &a, typename T::TYPE distance );" << "\n";
+	}
+
+	// rectangle with a hole; miters keep the corners square, so the areas are exact. Deflating by 20 leaves only the two side bands.
+	{
+		std::vector<PolyLine2f> frame = MakeRect( Rectf( 0, 0, 200, 100 ) );
+		PolyLine2f hole = MakeRect( Rectf( 50, 25, 150, 75 ) )[0];
+		std::reverse( hole.getPoints().begin(), hole.getPoints().end() );
+		frame.push_back( hole );
+
+		double inflated = CalcPolyLinesArea( PolyLine2f::calcOffset( frame, 10 ) );
+		double deflated = CalcPolyLinesArea( PolyLine2f::calcOffset( frame, -5 ) );
+		bool result = math<double>::abs( inflated - ( 220.0 * 120.0 - 80.0 * 30.0 ) ) < 1.0e-2
+					&& math<double>::abs( deflated - ( 190.0 * 90.0 - 110.0 * 60.0 ) ) < 1.0e-2
+					&& PolyLine2f::calcOffset( frame, -20 ).size() == 2
+					&& PolyLine2f::calcOffset( frame, -30 ).empty();
+		os << (result ? "passed" : "FAILED") << " : " << "calcOffset() of a rectangle with a hole" << "\n";
+	}
+
+	// void PolygonClipper::calcOffset( double delta, std::vector<PolyLine<T> > *result, JOIN_ROUND );
+	// Round offsets of any polygon are the points within the distance of it, up to the arc tolerance.
+	{
+		bool result = true;
+		PolygonClipper clipper;
+		std::vector<PolyLine2f> offset;
+		for( int i = 0; i < 50; ++i ) {
+			std::vector<PolyLine2f> star( 1, MakeStar( rnd, Vec2f::zero(), 20, 100, rnd.nextInt( 3, 40 ) ) );
+			float distance = rnd.nextFloat( -15, 30 );
+			clipper.clear();
+			clipper.addSubject( star );
+			clipper.calcOffset( distance, &offset, PolygonClipper::JOIN_ROUND );
+
+			for( int s = 0; s < 200; ++s ) {
+				Vec2f pt( rnd.nextFloat( -140, 140 ), rnd.nextFloat( -140, 140 ) );
+				float edgeDistance = DistanceToContours( star, pt );
+				float signedDistance = PolyLinesContain( star, pt ) ? -edgeDistance : edgeDistance;
+				if( math<float>::abs( signedDistance - distance ) < 0.5f )
+					continue;
+				result = result && ( PolyLinesContain( offset, pt ) == ( signedDistance < distance ) );
+			}
+		}
+		os << (result ? "passed" : "FAILED") << " : " << "void calcOffset( double delta, std::vector<PolyLine<T> > *result, JOIN_ROUND );" << "\n";
+	}
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+// Records every attribute and index a Source loads, as the floats and indices it copies
+class TargetRecording : public geom::Target {
+  public:
+	TargetRecording( const geom::Source &source ) : mSource( source ) {}
+
+	virtual geom::Primitive	getPrimitive() const override { return geom::Primitive::TRIANGLES; }
+	virtual uint8_t			getAttribDims( geom::Attrib attr ) const override { return mSource.getAttribDims( attr ); }
+
+	virtual void	copyAttrib( geom::Attrib attr, uint8_t dims, size_t strideBytes, const float *srcData, size_t count ) override
+	{
+		mAttribs[attr].assign( srcData, srcData + dims * count );
+	}
+	virtual void	copyIndices( geom::Primitive primitive, const uint32_t *source, size_t numIndices, uint8_t requiredBytesPerIndex ) override
+	{
+		mIndices.assign( source, source + numIndices );
+	}
+
+	const geom::Source							&mSource;
+	std::map<geom::Attrib, std::vector<float> >	mAttribs;
+	std::vector<uint32_t>						mIndices;
+};
+
+// The attributes and indices \a source loads
+struct CapturedMesh {
+	CapturedMesh( const geom::Source &source )
+	{
+		TargetRecording target( source );
+		source.loadInto( &target );
+		mAttribs.swap( target.mAttribs );
+		mIndices.swap( target.mIndices );
+	}
+
+	bool	operator==( const CapturedMesh &rhs ) const { return ( mAttribs == rhs.mAttribs ) && ( mIndices == rhs.mIndices ) && IsBitwiseEqual( rhs ); }
+	bool	operator!=( const CapturedMesh &rhs ) const { return ! ( *this == rhs ); }
+
+	// vector<float>'s == would pass -0 for 0, so the floats are compared as bits too
+	bool	IsBitwiseEqual( const CapturedMesh &rhs ) const
+	{
+		for( auto it = mAttribs.begin(); it != mAttribs.end(); ++it ) {
+			const std::vector<float> &other = rhs.mAttribs.find( it->first )->second;
+			if( ! it->second.empty() && memcmp( it->second.data(), other.data(), it->second.size() * sizeof(float) ) != 0 )
+				return false;
+		}
+		return true;
+	}
+
+	std::map<geom::Attrib, std::vector<float> >	mAttribs;
+	std::vector<uint32_t>						mIndices;
+};
+
+// Builds the Teapot's patches one after another, as Teapot did before generatePatches() split them across threads
+class TeapotSerial : public geom::Teapot {
+  public:
+	static void generate( std::vector<float> *v, std::vector<float> *n, std::vector<float> *tc, std::vector<uint32_t> *el, int grid, bool serial )
+	{
+		const size_t numVertices = 32 * ( grid + 1 ) * ( grid + 1 );
+		v->assign( numVertices * 3, 0 );
+		n->assign( numVertices * 3, 0 );
+		tc->assign( numVertices * 2, 0 );
+		el->assign( grid * grid * 32 * 6, 0 );
+		if( ! serial ) {
+			generatePatches( v->data(), n->data(), tc->data(), el->data(), grid );
+			return;
+		}
+
+		std::vector<float> B( 4 * ( grid + 1 ) ), dB( 4 * ( grid + 1 ) );
+		computeBasisFunctions( B.data(), dB.data(), grid );
+		const Matrix33f reflectX( Vec3f( -1, 0, 0 ), Vec3f( 0, 1, 0 ), Vec3f( 0, 0, 1 ) );
+		const Matrix33f reflectY( Vec3f( 1, 0, 0 ), Vec3f( 0, -1, 0 ), Vec3f( 0, 0, 1 ) );
+		const Matrix33f reflectXY( Vec3f( -1, 0, 0 ), Vec3f( 0, -1, 0 ), Vec3f( 0, 0, 1 ) );
+		int index = 0, elIndex = 0, tcIndex = 0;
+		for( int patchNum = 0; patchNum < 10; ++patchNum ) {
+			Vec3f patch[4][4], patchRevV[4][4];
+			getPatch( patchNum, patch, false );
+			getPatch( patchNum, patchRevV, true );
+			buildPatch( patchRevV, B.data(), dB.data(), v->data(), n->data(), tc->data(), el->data(), index, elIndex, tcIndex, grid, Matrix33f::identity(), false );
+			if( patchNum < 6 )
+				buildPatch( patch, B.data(), dB.data(), v->data(), n->data(), tc->data(), el->data(), index, elIndex, tcIndex, grid, reflectX, true );
+			buildPatch( patch, B.data(), dB.data(), v->data(), n->data(), tc->data(), el->data(), index, elIndex, tcIndex, grid, reflectY, true );
+			if( patchNum < 6 )
+				buildPatch( patchRevV, B.data(), dB.data(), v->data(), n->data(), tc->data(), el->data(), index, elIndex, tcIndex, grid, reflectXY, false );
+		}
+	}
+};
+
+// Splits each triangle in turn, appending its vertices and triangles, as Icosphere did before subdivide() split them across threads
+class IcosphereSerial : public geom::Icosphere {
+  protected:
+	virtual void subdivide() const override
+	{
+		for( int j = 0; j < mSubdivision; ++j ) {
+			const size_t numTriangles = mIndices.size() / 3;
+			for( size_t i = 0; i < numTriangles; ++i ) {
+				uint32_t index0 = mIndices[i * 3 + 0];
+				uint32_t index1 = mIndices[i * 3 + 1];
+				uint32_t index2 = mIndices[i * 3 + 2];
+
+				uint32_t index3 = uint32_t( mPositions.size() );
+				uint32_t index4 = index3 + 1;
+				uint32_t index5 = index4 + 1;
+
+				mIndices[i * 3 + 1] = index3;
+				mIndices[i * 3 + 2] = index5;
+				const uint32_t added[] = { index3, index1, index4, index5, index3, index4, index5, index4, index2 };
+				mIndices.insert( mIndices.end(), added, added + 9 );
+
+				mPositions.push_back( 0.5f * (mPositions[index0] + mPositions[index1]) );
+				mPositions.push_back( 0.5f * (mPositions[index1] + mPositions[index2]) );
+				mPositions.push_back( 0.5f * (mPositions[index2] + mPositions[index0]) );
+
+				mNormals.push_back( 0.5f * (mNormals[index0] + mNormals[index1]) );
+				mNormals.push_back( 0.5f * (mNormals[index1] + mNormals[index2]) );
+				mNormals.push_back( 0.5f * (mNormals[index2] + mNormals[index0]) );
+			}
+		}
+	}
+};
+
+inline bool IsBitwiseEqual( const std::vector<float> &a, const std::vector<float> &b )
+{
+	return ( a.size() == b.size() ) && ( a.empty() || memcmp( a.data(), b.data(), a.size() * sizeof(float) ) == 0 );
+}
+
+// Returns whether copies of \a prototype load the same data with the cache disabled, on a miss, which grows the cache, and on a hit, which doesn't
+template<typename SourceT>
+bool MatchesUncached( const SourceT &prototype )
+{
+	const size_t capacity = geom::PrimitiveCache::getCapacity();
+	geom::PrimitiveCache::clear();
+	geom::PrimitiveCache::setCapacity( 0 );
+	const CapturedMesh uncached = CapturedMesh( SourceT( prototype ) );
+	bool result = ( geom::PrimitiveCache::getSize() == 0 ) && ! uncached.mIndices.empty();
+	geom::PrimitiveCache::setCapacity( capacity );
+
+	const CapturedMesh miss = CapturedMesh( SourceT( prototype ) );
+	const size_t size = geom::PrimitiveCache::getSize();
+	const CapturedMesh hit = CapturedMesh( SourceT( prototype ) );
+	return result && ( size > 0 ) && ( geom::PrimitiveCache::getSize() == size ) && ( miss == uncached ) && ( hit == uncached );
+}
+
+inline void TestPrimitiveCache( std::ostream& os )
+{
+	const size_t defaultCapacity = geom::PrimitiveCache::getCapacity();
+
+	// static DataRef get( const Key &key, const std::function<void( Data *data )> &generate ); cached == uncached
+	{
+		// every cached primitive loads exactly what it generates with the cache disabled, with and without colors
+		bool result = true;
+		for( int color = 0; color < 2; ++color ) {
+			geom::Sphere sphere = geom::Sphere().segments( 23 ).radius( 1.5f ).center( Vec3f( 1, 2, 3 ) );
+			geom::Capsule capsule = geom::Capsule().segments( 14 ).slices( 3 ).length( 2.5f );
+			geom::Icosahedron icosahedron;
+			geom::Icosphere icosphere;
+			icosphere.subdivision( 3 );
+			geom::Torus torus = geom::Torus().segmentsAxis( 20 ).segmentsRing( 9 ).twist( 2, 0.3f );
+			geom::Helix helix = geom::Helix().coils( 2.5f ).height( 3 );
+			geom::Cylinder cylinder = geom::Cylinder().segments( 17 ).slices( 4 ).height( 2 );
+			geom::Cone cone = geom::Cone().segments( 11 ).radius( 1, 0.25f );
+			if( color ) {
+				sphere.enable( geom::Attrib::COLOR ); capsule.enable( geom::Attrib::COLOR ); icosahedron.enable( geom::Attrib::COLOR );
+				icosphere.enable( geom::Attrib::COLOR ); torus.enable( geom::Attrib::COLOR ); helix.enable( geom::Attrib::COLOR );
+				cylinder.enable( geom::Attrib::COLOR ); cone.enable( geom::Attrib::COLOR );
+			}
+			result = result && MatchesUncached( sphere ) && MatchesUncached( capsule ) && MatchesUncached( icosahedron ) && MatchesUncached( icosphere )
+						&& MatchesUncached( torus ) && MatchesUncached( helix ) && MatchesUncached( cylinder ) && MatchesUncached( cone );
+		}
+		result = result && MatchesUncached( geom::Teapot().subdivision( 4 ) ) && MatchesUncached( geom::Teapot() );
+
+		os << (result ? "passed" : "FAILED") << " : " << "static DataRef get( const Key &key, const std::function<void( Data *data )> &generate ); cached == uncached" << "\n";
+	}
+
+	// static void generatePatches( float *v, float *n, float *tc, uint32_t *el, int grid );
+	{
+		// each patch writes its own range, so building them in parallel gives exactly the serial patch-by-patch result
+		const int grids[] = { 1, 2, 6, 13, 31 };
+		bool result = true;
+		for( int g = 0; g < 5; ++g ) {
+			std::vector<float> v, n, tc, serialV, serialN, serialTc;
+			std::vector<uint32_t> el, serialEl;
+			TeapotSerial::generate( &v, &n, &tc, &el, grids[g], false );
+			TeapotSerial::generate( &serialV, &serialN, &serialTc, &serialEl, grids[g], true );
+			result = result && IsBitwiseEqual( v, serialV ) && IsBitwiseEqual( n, serialN ) && IsBitwiseEqual( tc, serialTc ) && ( el == serialEl );
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "static void generatePatches( float *v, float *n, float *tc, uint32_t *el, int grid );" << "\n";
+	}
+
+	// virtual void subdivide() const;
+	{
+		// splitting the triangles in parallel gives exactly the serial result, including subdivisions past its 8192-triangle chunks
+		geom::PrimitiveCache::setCapacity( 0 ); // the serial Icosphere shares the Icosphere's key
+		const int subdivisions[] = { 0, 1, 3, 5, 6 };
+		bool result = true;
+		for( int s = 0; s < 5; ++s ) {
+			geom::Icosphere icosphere;
+			IcosphereSerial serial;
+			icosphere.subdivision( subdivisions[s] ).enable( geom::Attrib::COLOR );
+			serial.subdivision( subdivisions[s] ).enable( geom::Attrib::COLOR );
+			const CapturedMesh mesh( icosphere ), serialMesh( serial );
+			result = result && ( mesh == serialMesh ) && ( mesh.mIndices.size() >= size_t( 60 ) << ( 2 * ( subdivisions[s] + 1 ) ) );
+		}
+		geom::PrimitiveCache::setCapacity( defaultCapacity );
+
+		os << (result ? "passed" : "FAILED") << " : " << "virtual void subdivide() const;" << "\n";
+	}
+
+	// static void setCapacity( size_t bytes ); static void clear();
+	{
+		// any parameter or attribute that changes the data makes a new entry; the Teapot, which generates every attribute, shares one
+		geom::PrimitiveCache::clear();
+		bool result = ( geom::PrimitiveCache::getSize() == 0 ) && ( defaultCapacity == 32 * 1024 * 1024 );
+		const CapturedMesh sphere( geom::Sphere().segments( 20 ) );
+		const size_t sphereSize = geom::PrimitiveCache::getSize();
+		result = result && ( sphereSize > 0 ) && ( CapturedMesh( geom::Sphere().segments( 20 ) ) == sphere ) && ( geom::PrimitiveCache::getSize() == sphereSize );
+		const CapturedMesh larger( geom::Sphere().segments( 20 ).radius( 2 ) );
+		const size_t largerSize = geom::PrimitiveCache::getSize();
+		result = result && ( largerSize > sphereSize ) && ( larger != sphere );
+		const CapturedMesh colored( geom::Sphere().segments( 20 ).enable( geom::Attrib::COLOR ) );
+		const size_t coloredSize = geom::PrimitiveCache::getSize();
+		result = result && ( coloredSize > largerSize ) && ( colored != sphere ) && ( colored.mAttribs.count( geom::Attrib::COLOR ) == 1 );
+		result = result && ( CapturedMesh( geom::Sphere().segments( 21 ) ) != sphere ) && ( geom::PrimitiveCache::getSize() > coloredSize );
+
+		geom::PrimitiveCache::clear();
+		const CapturedMesh teapot( geom::Teapot().subdivision( 3 ) );
+		const size_t teapotSize = geom::PrimitiveCache::getSize();
+		const CapturedMesh teapotNoNormals( geom::Teapot().subdivision( 3 ).disable( geom::Attrib::NORMAL ) );
+		result = result && ( teapotSize > 0 ) && ( geom::PrimitiveCache::getSize() == teapotSize ) && ( teapotNoNormals.mAttribs.count( geom::Attrib::NORMAL ) == 0 )
+					&& ( teapotNoNormals.mAttribs.find( geom::Attrib::POSITION )->second == teapot.mAttribs.find( geom::Attrib::POSITION )->second );
+		const CapturedMesh teapotFiner( geom::Teapot().subdivision( 4 ) );
+		result = result && ( geom::PrimitiveCache::getSize() > teapotSize ) && ( teapotFiner != teapot );
+
+		// lowering the capacity evicts the least recently used entries first
+		geom::PrimitiveCache::clear();
+		CapturedMesh( geom::Torus().segmentsAxis( 30 ) );
+		const size_t torusSize = geom::PrimitiveCache::getSize();
+		CapturedMesh( geom::Cylinder().segments( 30 ) );
+		CapturedMesh( geom::Torus().segmentsAxis( 30 ) ); // a hit, which makes the Cylinder the least recently used
+		geom::PrimitiveCache::setCapacity( geom::PrimitiveCache::getSize() - 1 );
+		result = result && ( geom::PrimitiveCache::getSize() == torusSize );
+		CapturedMesh( geom::Torus().segmentsAxis( 30 ) );
+		result = result && ( geom::PrimitiveCache::getSize() == torusSize );
+
+		// a capacity of 0 retains nothing, and clear() releases everything
+		geom::PrimitiveCache::setCapacity( 0 );
+		result = result && ( geom::PrimitiveCache::getSize() == 0 ) && ( CapturedMesh( geom::Sphere().segments( 20 ) ) == sphere ) && ( geom::PrimitiveCache::getSize() == 0 );
+		geom::PrimitiveCache::setCapacity( defaultCapacity );
+		CapturedMesh( geom::Sphere().segments( 20 ) );
+		result = result && ( geom::PrimitiveCache::getSize() == sphereSize );
+		geom::PrimitiveCache::clear();
+		result = result && ( geom::PrimitiveCache::getSize() == 0 ) && ( geom::PrimitiveCache::getCapacity() == defaultCapacity );
+
+		os << (result ? "passed" : "FAILED") << " : " << "static void setCapacity( size_t bytes ); static void clear();" << "\n";
+	}
+}
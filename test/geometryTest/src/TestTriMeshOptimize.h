@@ -0,0 +1,169 @@
+#pragma once
+
+// Builds an n x n quad grid with positions, normals and texture coordinates, with its triangles in row order or shuffled
+inline TriMesh MakeGridTriMesh( int n, Rand *shuffle = 0 )
+{
+	TriMesh result( TriMesh::Format().positions().normals().texCoords() );
+	for( int y = 0; y <= n; ++y ) {
+		for( int x = 0; x <= n; ++x ) {
+			result.appendVertex( Vec3f( (float)x, (float)y, 0 ) );
+			result.appendNormal( Vec3f( 0, 0, 1 ) );
+			result.appendTexCoord( Vec2f( (float)x / n, (float)y / n ) );
+		}
+	}
+
+	std::vector<uint32_t> quads;
+	for( int y = 0; y < n; ++y ) {
+		for( int x = 0; x < n; ++x )
+			quads.push_back( y * ( n + 1 ) + x );
+	}
+	if( shuffle ) {
+		for( size_t i = quads.size() - 1; i > 0; --i )
+			std::swap( quads[i], quads[shuffle->nextInt( (int)i + 1 )] );
+	}
+	for( size_t i = 0; i < quads.size(); ++i ) {
+		uint32_t v = quads[i];
+		result.appendTriangle( v, v + 1, v + n + 2 );
+		result.appendTriangle( v, v + n + 2, v + n + 1 );
+	}
+	return result;
+}
+
+// Copies \a mesh with three unshared vertices per triangle, as a flat-shaded or unindexed file would load
+inline TriMesh MakePerCornerTriMesh( const TriMesh &mesh )
+{
+	TriMesh result( TriMesh::Format().positions().normals() );
+	const Vec3f *positions = mesh.getVertices<3>();
+	const std::vector<uint32_t> &indices = mesh.getIndices();
+	for( size_t i = 0; i < indices.size(); ++i ) {
+		result.appendVertex( positions[indices[i]] );
+		result.appendNormal( mesh.getNormals()[indices[i]] );
+	}
+	for( uint32_t t = 0; t < (uint32_t)mesh.getNumTriangles(); ++t )
+		result.appendTriangle( t * 3, t * 3 + 1, t * 3 + 2 );
+	return result;
+}
+
+// Returns every triangle as its three positions, rotated so that the smallest comes first (preserving the winding) and sorted, to compare meshes independently of triangle and vertex order
+inline std::vector<std::vector<float> > CalcTriangleKeys( const TriMesh &mesh )
+{
+	const Vec3f *positions = mesh.getVertices<3>();
+	const std::vector<uint32_t> &indices = mesh.getIndices();
+	std::vector<std::vector<float> > result( mesh.getNumTriangles() );
+	for( size_t t = 0; t < result.size(); ++t ) {
+		std::vector<float> corners[3];
+		for( int c = 0; c < 3; ++c ) {
+			const Vec3f &p = positions[indices[t * 3 + c]];
+			corners[c].push_back( p.x ); corners[c].push_back( p.y ); corners[c].push_back( p.z );
+		}
+		int first = (int)( std::min_element( corners, corners + 3 ) - corners );
+		for( int c = 0; c < 3; ++c )
+			result[t].insert( result[t].end(), corners[( first + c ) % 3].begin(), corners[( first + c ) % 3].end() );
+	}
+	std::sort( result.begin(), result.end() );
+	return result;
+}
+
+// Checks that every vertex is referenced, in first-use order
+inline bool IsInFetchOrder( const TriMesh &mesh )
+{
+	uint32_t next = 0;
+	const std::vector<uint32_t> &indices = mesh.getIndices();
+	for( size_t i = 0; i < indices.size(); ++i ) {
+		if( indices[i] > next )
+			return false;
+		else if( indices[i] == next )
+			++next;
+	}
+	return next == mesh.getNumVertices();
+}
+
+inline void TestTriMeshOptimize( std::ostream& os )
+{
+	Rand rnd( 4093 );
+
+	// void optimizeVertexCache( size_t cacheSize = 32 );
+	{
+		TriMesh mesh = MakeGridTriMesh( 100, &rnd );
+		std::vector<std::vector<float> > before = CalcTriangleKeys( mesh );
+		float acmrBefore = mesh.calcVertexCacheStats( 16 ).mAcmr;
+		mesh.optimizeVertexCache( 16 );
+		TriMesh::VertexCacheStats stats = mesh.calcVertexCacheStats( 16 );
+		bool result = ( CalcTriangleKeys( mesh ) == before ) && ( stats.mAcmr < 0.75f ) && ( stats.mAcmr < acmrBefore );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void optimizeVertexCache( size_t cacheSize = 32 );" << "\n";
+	}
+
+	// void optimizeVertexFetch();
+	{
+		TriMesh mesh = MakeGridTriMesh( 50, &rnd );
+		// an unreferenced vertex, which the pass drops
+		mesh.appendVertex( Vec3f( -1, -1, -1 ) );
+		mesh.appendNormal( Vec3f( 0, 0, 1 ) );
+		mesh.appendTexCoord( Vec2f( 0, 0 ) );
+		std::vector<std::vector<float> > before = CalcTriangleKeys( mesh );
+		size_t numVertices = mesh.getNumVertices();
+		mesh.optimizeVertexFetch();
+		bool result = ( CalcTriangleKeys( mesh ) == before ) && IsInFetchOrder( mesh ) && ( mesh.getNumVertices() == numVertices - 1 )
+					&& ( mesh.getNormals().size() == mesh.getNumVertices() );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void optimizeVertexFetch();" << "\n";
+	}
+
+	// size_t weldVertices();
+	{
+		TriMesh grid = MakeGridTriMesh( 40 );
+		TriMesh mesh = MakePerCornerTriMesh( grid );
+		std::vector<std::vector<float> > before = CalcTriangleKeys( mesh );
+		size_t numWelded = mesh.weldVertices();
+		bool result = ( CalcTriangleKeys( mesh ) == before ) && ( numWelded == grid.getNumTriangles() * 3 - grid.getNumVertices() )
+					&& ( mesh.getNumVertices() == grid.getNumVertices() ) && ( mesh.weldVertices() == 0 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "size_t weldVertices();" << "\n";
+	}
+
+	// void optimize( bool weld = true );
+	{
+		TriMesh mesh = MakePerCornerTriMesh( MakeGridTriMesh( 60, &rnd ) );
+		std::vector<std::vector<float> > before = CalcTriangleKeys( mesh );
+		mesh.optimize();
+		bool result = ( CalcTriangleKeys( mesh ) == before ) && IsInFetchOrder( mesh ) && ( mesh.calcVertexCacheStats( 32 ).mAcmr < 0.75f );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void optimize( bool weld = true );" << "\n";
+	}
+
+	// ACMR for a 16-entry FIFO before and after optimize(), and the time optimizeVertexCache() took
+	os << "   " << "speed test:" << "\n";
+	{
+		std::vector<std::pair<std::string, TriMesh> > meshes;
+		meshes.push_back( std::make_pair( "300x300 grid, rows", MakeGridTriMesh( 300 ) ) );
+		meshes.push_back( std::make_pair( "300x300 grid, shuffled", MakeGridTriMesh( 300, &rnd ) ) );
+		meshes.push_back( std::make_pair( "geom::Sphere, 256 segments", TriMesh( geom::Sphere().segments( 256 ) ) ) );
+		meshes.push_back( std::make_pair( "geom::Teapot, subdivision 16", TriMesh( geom::Teapot().subdivision( 16 ) ) ) );
+		meshes.push_back( std::make_pair( "geom::Sphere, 64 segments, per-corner", MakePerCornerTriMesh( TriMesh( geom::Sphere().segments( 64 ) ) ) ) );
+		TriMesh icosahedron = TriMesh( geom::Icosahedron() );
+		icosahedron.subdivide( 40 );
+		meshes.push_back( std::make_pair( "geom::Icosahedron, subdivide( 40 )", icosahedron ) );
+
+		for( size_t m = 0; m < meshes.size(); ++m ) {
+			TriMesh &mesh = meshes[m].second;
+			float acmrBefore = mesh.calcVertexCacheStats( 16 ).mAcmr;
+			Timer timer;
+			timer.start();
+			size_t numWelded = mesh.weldVertices();
+			timer.stop();
+			double weldSeconds = timer.getSeconds();
+			timer.start();
+			mesh.optimizeVertexCache( 16 );
+			timer.stop();
+			double cacheSeconds = timer.getSeconds();
+			timer.start();
+			mesh.optimizeVertexFetch();
+			timer.stop();
+			double fetchSeconds = timer.getSeconds();
+
+			os << "   " << "   " << meshes[m].first << ", " << mesh.getNumTriangles() << " triangles: ACMR " << acmrBefore << " -> " << mesh.calcVertexCacheStats( 16 ).mAcmr
+				<< ", optimizeVertexCache() took " << cacheSeconds << " seconds, weldVertices() " << weldSeconds << " (" << numWelded << " welded), optimizeVertexFetch() " << fetchSeconds << "\n";
+		}
+	}
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+// Returns the directed edges of \a indices, by position, which no triangle traverses in the opposite direction
+inline std::vector<std::pair<Vec3f, Vec3f> > CalcOpenEdges( const TriMesh &mesh, const std::vector<uint32_t> &indices )
+{
+	const Vec3f *positions = mesh.getVertices<3>();
+	std::vector<std::vector<float> > edges, reversed;
+	for( size_t i = 0; i < indices.size(); i += 3 ) {
+		for( int k = 0; k < 3; ++k ) {
+			const Vec3f &a = positions[indices[i + k]], &b = positions[indices[i + ( k + 1 ) % 3]];
+			float edge[6] = { a.x, a.y, a.z, b.x, b.y, b.z };
+			float reverse[6] = { b.x, b.y, b.z, a.x, a.y, a.z };
+			edges.push_back( std::vector<float>( edge, edge + 6 ) );
+			reversed.push_back( std::vector<float>( reverse, reverse + 6 ) );
+		}
+	}
+	std::sort( reversed.begin(), reversed.end() );
+
+	std::vector<std::pair<Vec3f, Vec3f> > result;
+	for( size_t e = 0; e < edges.size(); ++e ) {
+		if( ! std::binary_search( reversed.begin(), reversed.end(), edges[e] ) )
+			result.push_back( std::make_pair( Vec3f( edges[e][0], edges[e][1], edges[e][2] ), Vec3f( edges[e][3], edges[e][4], edges[e][5] ) ) );
+	}
+	return result;
+}
+
+// Sum of the signed areas of \a indices projected onto the xy plane
+inline float CalcSignedAreaXY( const TriMesh &mesh, const std::vector<uint32_t> &indices )
+{
+	const Vec3f *positions = mesh.getVertices<3>();
+	float result = 0;
+	for( size_t i = 0; i < indices.size(); i += 3 ) {
+		const Vec3f &a = positions[indices[i]], &b = positions[indices[i + 1]], &c = positions[indices[i + 2]];
+		result += ( ( b.x - a.x ) * ( c.y - a.y ) - ( c.x - a.x ) * ( b.y - a.y ) ) * 0.5f;
+	}
+	return result;
+}
+
+// Checks that every index is in range and no triangle is degenerate by index
+inline bool IsValidIndexBuffer( const TriMesh &mesh, const std::vector<uint32_t> &indices )
+{
+	if( indices.size() % 3 != 0 )
+		return false;
+	for( size_t i = 0; i < indices.size(); i += 3 ) {
+		const uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+		if( a >= mesh.getNumVertices() || b >= mesh.getNumVertices() || c >= mesh.getNumVertices() || a == b || b == c || c == a )
+			return false;
+	}
+	return true;
+}
+
+// Checks that every open edge of \a indices runs along the border of an n x n grid
+inline bool AreOpenEdgesOnGridBorder( const TriMesh &mesh, const std::vector<uint32_t> &indices, int n )
+{
+	std::vector<std::pair<Vec3f, Vec3f> > openEdges = CalcOpenEdges( mesh, indices );
+	for( size_t e = 0; e < openEdges.size(); ++e ) {
+		const Vec3f &a = openEdges[e].first, &b = openEdges[e].second;
+		if( ! ( a.x == b.x && ( a.x == 0 || a.x == n ) ) && ! ( a.y == b.y && ( a.y == 0 || a.y == n ) ) )
+			return false;
+	}
+	return true;
+}
+
+// Splits the vertices of \a mesh's middle column in two, with the right half of the grid referencing copies whose texture coordinates differ
+inline TriMesh MakeSeamedGridTriMesh( int n )
+{
+	TriMesh result = MakeGridTriMesh( n );
+	const int column = n / 2;
+	std::vector<uint32_t> copies( result.getNumVertices(), 0 );
+	for( int y = 0; y <= n; ++y ) {
+		const uint32_t v = y * ( n + 1 ) + column;
+		copies[v] = (uint32_t)result.getNumVertices();
+		result.appendVertex( result.getVertices<3>()[v] );
+		result.appendNormal( Vec3f( 0, 0, 1 ) );
+		result.appendTexCoord( Vec2f( 1, (float)y / n ) );
+	}
+
+	std::vector<uint32_t> &indices = result.getIndices();
+	const Vec3f *positions = result.getVertices<3>();
+	for( size_t i = 0; i < indices.size(); i += 3 ) {
+		if( positions[indices[i]].x + positions[indices[i + 1]].x + positions[indices[i + 2]].x <= column * 3 )
+			continue;
+		for( int k = 0; k < 3; ++k ) {
+			if( copies[indices[i + k]] )
+				indices[i + k] = copies[indices[i + k]];
+		}
+	}
+	return result;
+}
+
+inline void TestTriMeshSimplify( std::ostream& os )
+{
+	// std::vector<uint32_t> simplify( size_t targetNumTriangles, float maxError = FLT_MAX, float *resultError = nullptr ) const;
+	{
+		// a flat open grid loses its interior for free, and its border may only collapse along itself
+		const int n = 40;
+		TriMesh mesh = MakeGridTriMesh( n );
+		std::vector<uint32_t> indices = mesh.simplify( 100 );
+		bool result = IsValidIndexBuffer( mesh, indices ) && ( indices.size() / 3 <= 100 ) && AreOpenEdgesOnGridBorder( mesh, indices, n )
+					&& ( math<float>::abs( CalcSignedAreaXY( mesh, indices ) - n * n ) < 0.01f );
+		// the corners have nowhere to go
+		const Vec3f *positions = mesh.getVertices<3>();
+		const Vec3f corners[4] = { Vec3f( 0, 0, 0 ), Vec3f( (float)n, 0, 0 ), Vec3f( 0, (float)n, 0 ), Vec3f( (float)n, (float)n, 0 ) };
+		for( int c = 0; c < 4 && result; ++c ) {
+			bool found = false;
+			for( size_t i = 0; i < indices.size() && ! found; ++i )
+				found = ( positions[indices[i]] == corners[c] );
+			result = found;
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "std::vector<uint32_t> simplify( size_t targetNumTriangles, float maxError = FLT_MAX, float *resultError = nullptr ) const;" << "\n";
+	}
+
+	// std::vector<uint32_t> simplify( ... ) const; seams
+	{
+		// both sides of the seam have to collapse in lockstep, otherwise a crack opens up along it
+		const int n = 40;
+		TriMesh mesh = MakeSeamedGridTriMesh( n );
+		std::vector<uint32_t> indices = mesh.simplify( 100 );
+		bool result = IsValidIndexBuffer( mesh, indices ) && ( indices.size() / 3 <= 100 ) && AreOpenEdgesOnGridBorder( mesh, indices, n )
+					&& ( math<float>::abs( CalcSignedAreaXY( mesh, indices ) - n * n ) < 0.01f );
+		// and the seam vertices stay on their side
+		const Vec3f *positions = mesh.getVertices<3>();
+		for( size_t i = 0; i < indices.size() && result; ++i )
+			result = ( indices[i] < (uint32_t)( ( n + 1 ) * ( n + 1 ) ) ) || ( positions[indices[i]].x == n / 2 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "std::vector<uint32_t> simplify( ... ) const; seams" << "\n";
+	}
+
+	// std::vector<uint32_t> simplify( ... ) const; closed mesh
+	{
+		// no holes open up, and the triangle count lands near the target rather than stalling
+		TriMesh mesh( geom::Sphere().segments( 64 ) );
+		const size_t target = mesh.getNumTriangles() / 4;
+		float error = -1;
+		std::vector<uint32_t> indices = mesh.simplify( target, FLT_MAX, &error );
+		bool result = IsValidIndexBuffer( mesh, indices ) && ( indices.size() / 3 <= target ) && ( indices.size() / 3 > target * 9 / 10 )
+					&& ( CalcOpenEdges( mesh, indices ).size() <= CalcOpenEdges( mesh, mesh.getIndices() ).size() ) && ( error >= 0 ) && ( error < 0.1f );
+
+		os << (result ? "passed" : "FAILED") << " : " << "std::vector<uint32_t> simplify( ... ) const; closed mesh" << "\n";
+	}
+
+	// std::vector<uint32_t> simplify( ... ) const; maxError
+	{
+		TriMesh mesh( geom::Sphere().segments( 64 ) );
+		const float maxError = 0.002f;
+		float error = -1;
+		std::vector<uint32_t> indices = mesh.simplify( 0, maxError, &error );
+		bool result = IsValidIndexBuffer( mesh, indices ) && ( indices.size() < mesh.getIndices().size() ) && ( indices.size() / 3 > 100 )
+					&& ( error >= 0 ) && ( error <= maxError * 1.001f );
+
+		os << (result ? "passed" : "FAILED") << " : " << "std::vector<uint32_t> simplify( ... ) const; maxError" << "\n";
+	}
+
+	// std::vector<uint32_t> simplifyClustered( size_t targetNumTriangles, float *resultError = nullptr ) const;
+	{
+		TriMesh mesh( geom::Sphere().segments( 128 ) );
+		const size_t target = mesh.getNumTriangles() / 10;
+		std::vector<uint32_t> indices = mesh.simplifyClustered( target );
+		bool result = IsValidIndexBuffer( mesh, indices ) && ( indices.size() / 3 <= target ) && ( indices.size() > 0 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "std::vector<uint32_t> simplifyClustered( size_t targetNumTriangles, float *resultError = nullptr ) const;" << "\n";
+	}
+
+	// std::vector<std::vector<uint32_t>> calcLodChain( size_t numLevels, float reduction = 0.5f, bool fast = false, std::vector<float> *resultErrors = nullptr ) const;
+	{
+		TriMesh mesh( geom::Sphere().segments( 64 ) );
+		std::vector<float> errors;
+		std::vector<std::vector<uint32_t> > lods = mesh.calcLodChain( 5, 0.5f, false, &errors );
+		bool result = ( lods.size() == 5 ) && ( errors.size() == lods.size() ) && ( lods[0] == mesh.getIndices() ) && ( errors[0] == 0 );
+		for( size_t l = 1; l < lods.size() && result; ++l ) {
+			result = IsValidIndexBuffer( mesh, lods[l] ) && ( lods[l].size() / 3 <= lods[l - 1].size() / 6 + 1 ) && ( errors[l] >= errors[l - 1] );
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "std::vector<std::vector<uint32_t>> calcLodChain( size_t numLevels, float reduction = 0.5f, bool fast = false, std::vector<float> *resultErrors = nullptr ) const;" << "\n";
+	}
+
+	// triangles reached and the time taken, reducing to a tenth
+	os << "   " << "speed test:" << "\n";
+	{
+		std::vector<std::pair<std::string, TriMesh> > meshes;
+		meshes.push_back( std::make_pair( "300x300 grid", MakeGridTriMesh( 300 ) ) );
+		meshes.push_back( std::make_pair( "geom::Sphere, 256 segments", TriMesh( geom::Sphere().segments( 256 ) ) ) );
+		meshes.push_back( std::make_pair( "geom::Teapot, subdivision 16", TriMesh( geom::Teapot().subdivision( 16 ) ) ) );
+
+		for( size_t m = 0; m < meshes.size(); ++m ) {
+			const TriMesh &mesh = meshes[m].second;
+			const size_t target = mesh.getNumTriangles() / 10;
+			float error = 0, clusteredError = 0;
+			Timer timer;
+			timer.start();
+			std::vector<uint32_t> indices = mesh.simplify( target, FLT_MAX, &error );
+			timer.stop();
+			double simplifySeconds = timer.getSeconds();
+			timer.start();
+			std::vector<uint32_t> clustered = mesh.simplifyClustered( target, &clusteredError );
+			timer.stop();
+			double clusteredSeconds = timer.getSeconds();
+
+			os << "   " << "   " << meshes[m].first << ", " << mesh.getNumTriangles() << " -> " << target << " triangles: simplify() reached " << indices.size() / 3
+				<< " (error " << error << ") in " << simplifySeconds << " seconds, simplifyClustered() " << clustered.size() / 3
+				<< " (error " << clusteredError << ") in " << clusteredSeconds << " seconds" << "\n";
+
+			// an 8-level LOD chain, quadric and fast, with each level's error relative to the mesh's bounding radius
+			const float radius = mesh.calcBoundingBox().getSize().length() * 0.5f;
+			for( int fast = 0; fast < 2; ++fast ) {
+				std::vector<float> errors;
+				timer.start();
+				std::vector<std::vector<uint32_t> > lods = mesh.calcLodChain( 8, 0.5f, fast != 0, &errors );
+				timer.stop();
+				os << "   " << "   " << "   " << ( fast ? "fast" : "quadric" ) << " calcLodChain(): " << lods.size() << " levels in " << timer.getSeconds() << " seconds, "
+					<< mesh.getNumTriangles() / timer.getSeconds() / 1e6 << " million source triangles/sec; triangles (error % of radius):";
+				for( size_t l = 0; l < lods.size(); ++l )
+					os << " " << lods[l].size() / 3 << " (" << errors[l] / radius * 100 << ")";
+				os << "\n";
+			}
+		}
+	}
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "cinder/gl/DrawQueue.h"
+#include "cinder/gl/Batch.h"
+#include "cinder/GeomIo.h"
+
+#include <vector>
+
+// Records the program, VAO and recorded "uValue" and "uScale" of each draw, using UniformRecorder's uniform state. Every program
+// declares the instance matrix attribute "ciInstanceMatrix" at location 8.
+struct DrawRecorder {
+	struct DrawState {
+		DrawState( GLuint prog, GLuint vao, float value, float scale, GLsizei instances )
+			: mProg( prog ), mVao( vao ), mValue( value ), mScale( scale ), mInstances( instances ) {}
+
+		bool operator==( const DrawState &rhs ) const
+		{
+			return mProg == rhs.mProg && mVao == rhs.mVao && mValue == rhs.mValue && mScale == rhs.mScale && mInstances == rhs.mInstances;
+		}
+
+		GLuint		mProg, mVao;
+		float		mValue, mScale;
+		GLsizei		mInstances;
+	};
+
+	static std::vector<DrawState>&	draws() { static std::vector<DrawState> sDraws; return sDraws; }
+
+	static void record( GLsizei instances )
+	{
+		const gl::GlslProgRef prog = gl::context()->getGlslProg();
+		draws().push_back( DrawState( prog->getHandle(), gl::context()->getVao()->getId(), UniformRecorder::getValue( prog, 1 ), UniformRecorder::getValue( prog, 2 ), instances ) );
+	}
+
+	static GLint CODEGEN_FUNCPTR getAttribLocation( GLuint program, const GLchar *name )
+	{
+		return ( std::string( name ) == "ciInstanceMatrix" ) ? 8 : -1;
+	}
+
+	static void CODEGEN_FUNCPTR drawArrays( GLenum, GLint, GLsizei )										{ record( 1 ); }
+	static void CODEGEN_FUNCPTR drawElements( GLenum, GLsizei, GLenum, const GLvoid* )						{ record( 1 ); }
+	static void CODEGEN_FUNCPTR drawArraysInstanced( GLenum, GLint, GLsizei, GLsizei instances )			{ record( instances ); }
+	static void CODEGEN_FUNCPTR drawElementsInstanced( GLenum, GLsizei, GLenum, const GLvoid*, GLsizei instances )	{ record( instances ); }
+
+	// Requires that UniformRecorder is installed
+	static void install()
+	{
+		_funcptr_glGetAttribLocation = &getAttribLocation;
+		_funcptr_glDrawArrays = &drawArrays;
+		_funcptr_glDrawElements = &drawElements;
+		_funcptr_glDrawArraysInstanced = &drawArraysInstanced;
+		_funcptr_glDrawElementsInstanced = &drawElementsInstanced;
+		draws().clear();
+	}
+};
+
+// Each DrawState's uniforms are those of the draw, or -1 for those it doesn't set
+inline gl::DrawQueue::Draw& RecordDraw( gl::DrawQueue &queue, const gl::BatchRef &batch, float value, float scale )
+{
+	gl::DrawQueue::Draw &draw = queue.draw( batch );
+	if( value != -1 )
+		draw.uniform( "uValue", value );
+	if( scale != -1 )
+		draw.uniform( "uScale", scale );
+	return draw;
+}
+
+// Submits \a queue, returning whether the draws it issued are \a expected in order
+inline bool IsSubmitted( gl::DrawQueue &queue, const std::vector<DrawRecorder::DrawState> &expected )
+{
+	DrawRecorder::draws().clear();
+	queue.submit();
+	return DrawRecorder::draws() == expected;
+}
+
+inline void TestDrawQueue( std::ostream& os )
+{
+	gl::NullDispatch::install();
+	gl::Environment::setCore();
+	gl::ContextRef ctx = gl::Context::createFromExisting( std::make_shared<gl::Context::PlatformData>() );
+	UniformRecorder::install();
+	DrawRecorder::install();
+
+	{
+		// two programs, each with two batches; handles and VAO ids ascend in creation order. They must be released before the Context.
+		gl::GlslProgRef progA = CreateRecordedGlslProg(), progB = CreateRecordedGlslProg();
+		gl::BatchRef batchA1 = gl::Batch::create( geom::Rect(), progA ), batchA2 = gl::Batch::create( geom::Rect(), progA );
+		gl::BatchRef batchB1 = gl::Batch::create( geom::Rect(), progB ), batchB2 = gl::Batch::create( geom::Rect(), progB );
+		const GLuint a = progA->getHandle(), b = progB->getHandle();
+		const GLuint a1 = batchA1->getVao()->getId(), a2 = batchA2->getVao()->getId(), b1 = batchB1->getVao()->getId(), b2 = batchB2->getVao()->getId();
+		typedef DrawRecorder::DrawState DS;
+
+		gl::DrawQueue queue;
+		queue.setInstanceMatrixAttrib( "" );
+
+		// void submit();
+		{
+			// every draw sets the same uniforms, so the draws of each program are sorted by VAO and each sees its own values
+			RecordDraw( queue, batchA2, 1, 1 );
+			RecordDraw( queue, batchB2, 2, 2 );
+			RecordDraw( queue, batchA1, 3, 3 );
+			RecordDraw( queue, batchB1, 4, 4 );
+			RecordDraw( queue, batchA2, 5, 5 );
+			RecordDraw( queue, batchA1, 6, 6 );
+			std::vector<DS> expected;
+			expected.push_back( DS( a, a1, 3, 3, 1 ) );
+			expected.push_back( DS( a, a1, 6, 6, 1 ) );
+			expected.push_back( DS( a, a2, 1, 1, 1 ) );
+			expected.push_back( DS( a, a2, 5, 5, 1 ) );
+			expected.push_back( DS( b, b1, 4, 4, 1 ) );
+			expected.push_back( DS( b, b2, 2, 2, 1 ) );
+			bool result = IsSubmitted( queue, expected );
+			// in recorded order the program and VAO change before every draw but the last, whose VAO alone changes; sorted, the first
+			// draw binds both, then 3 VAOs and 1 program follow
+			result = result && ( queue.getNumDrawCalls() == 6 ) && ( queue.getNumStateChanges() == 2 + 4 ) && ( queue.getNumStateChangesSaved() == 11 - 6 );
+
+			os << (result ? "passed" : "FAILED") << " : " << "void submit();" << "\n";
+		}
+
+		// void submit(); with draws which set different uniforms
+		{
+			// progA's draws leave "uScale" to the draws before them, so they keep their recorded order; progB's are still sorted
+			UniformRecorder::values().clear();
+			RecordDraw( queue, batchA2, 1, 10 );
+			RecordDraw( queue, batchB2, 2, 2 );
+			RecordDraw( queue, batchA1, 3, -1 );
+			RecordDraw( queue, batchB1, 4, 4 );
+			RecordDraw( queue, batchA2, 5, 50 );
+			RecordDraw( queue, batchA1, 6, -1 );
+			std::vector<DS> expected;
+			expected.push_back( DS( a, a2, 1, 10, 1 ) );
+			expected.push_back( DS( a, a1, 3, 10, 1 ) );
+			expected.push_back( DS( a, a2, 5, 50, 1 ) );
+			expected.push_back( DS( a, a1, 6, 50, 1 ) );
+			expected.push_back( DS( b, b1, 4, 4, 1 ) );
+			expected.push_back( DS( b, b2, 2, 2, 1 ) );
+			bool result = IsSubmitted( queue, expected );
+			result = result && ( queue.getNumDrawCalls() == 6 ) && ( queue.getNumStateChanges() == 2 + 6 ) && ( queue.getNumStateChangesSaved() == 11 - 8 );
+
+			os << (result ? "passed" : "FAILED") << " : " << "void submit(); with draws which set different uniforms" << "\n";
+		}
+
+		// void setInstanceMatrixAttrib( const std::string &name );
+		{
+			// identical draws of a batch are merged into one instanced draw, wherever they were recorded
+			queue.setInstanceMatrixAttrib( "ciInstanceMatrix" );
+			RecordDraw( queue, batchA1, 7, 7 );
+			RecordDraw( queue, batchA2, 8, 8 );
+			RecordDraw( queue, batchA1, 7, 7 );
+			RecordDraw( queue, batchA1, 7, 7 );
+			std::vector<DS> expected;
+			expected.push_back( DS( a, a1, 7, 7, 3 ) );
+			expected.push_back( DS( a, a2, 8, 8, 1 ) );
+			bool result = IsSubmitted( queue, expected );
+			result = result && ( queue.getNumDrawCalls() == 2 ) && ( queue.getNumInstancedDrawCalls() == 1 ) && ( queue.getNumDrawCallsSaved() == 2 );
+			queue.setInstanceMatrixAttrib( "" );
+
+			os << (result ? "passed" : "FAILED") << " : " << "void setInstanceMatrixAttrib( const std::string &name );" << "\n";
+		}
+	}
+
+	ctx.reset();
+	gl::NullDispatch::uninstall();
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+// A mix of the gl namespace's convenience drawing and scoped state, with some deliberately redundant requests
+inline void DrawStateWorkload( int iterations )
+{
+	for( int i = 0; i < iterations; ++i ) {
+		gl::ScopedColor color( ColorAf( 1.0f, 0.5f, 0.25f, 1.0f ) );
+		{
+			gl::ScopedAlphaBlend blend( false );
+			gl::drawSolidRect( Rectf( 0, 0, 10, 10 ) );
+			gl::drawSolidCircle( Vec2f( 5, 5 ), 4 );
+			gl::ScopedAlphaBlend sameBlend( false );
+			gl::drawStrokedRect( Rectf( 0, 0, 10, 10 ) );
+		}
+		{
+			gl::ScopedTextureBind texture( GL_TEXTURE_2D, 7 );
+			gl::ScopedTextureBind sameTexture( GL_TEXTURE_2D, 7 );
+			gl::ScopedTextureBind otherUnit( GL_TEXTURE_2D, 8, 1 );
+		}
+		{
+			gl::ScopedViewport viewport( 0, 0, 320, 240 );
+			gl::ScopedScissor scissor( 10, 10, 100, 100 );
+			gl::ScopedState depthTest( GL_DEPTH_TEST, true );
+			gl::ScopedState sameDepthTest( GL_DEPTH_TEST, true );
+			gl::drawLine( Vec2f( 0, 0 ), Vec2f( 10, 10 ) );
+		}
+		{
+			gl::ScopedFramebuffer framebuffer( GL_FRAMEBUFFER, 3 );
+			gl::ScopedFramebuffer sameFramebuffer( GL_FRAMEBUFFER, 3 );
+		}
+	}
+}
+
+// The scene of the ConvenienceDrawingMethods test: circles, lines, a Path2d and PolyLines, stroked and filled, under nested model matrices
+inline void ConvenienceDrawingWorkload( int iterations, const Path2d &path, const PolyLine2f &polyline2D, const PolyLine<Vec3f> &polyline3D )
+{
+	const float radius = 50.0f, step = radius * 2.2f;
+	for( int i = 0; i < iterations; ++i ) {
+		gl::color( Color( 1.0f, 1.0f, 0.0f ) );
+		for( int c = 0; c < 4; ++c )
+			gl::drawSolidCircle( Vec2f( ( c + 1.0f ) * step, step ), radius, c * 3 );
+		gl::color( Color( 1.0f, 0.0f, 0.0f ) );
+		for( int c = 0; c < 4; ++c )
+			gl::drawStrokedCircle( Vec2f( ( c + 1.0f ) * step, step ), radius, c * 3 );
+		gl::drawLine( Vec2f( 10.0f, step * 1.5f ), Vec2f( 630.0f, step * 1.5f ) );
+
+		gl::pushModelMatrix();
+		gl::translate( step, step * 2.0f );
+		gl::draw( path );
+		gl::translate( step, 0.0f );
+		gl::color( Color( 1.0f, 1.0f, 0.0f ) );
+		gl::drawSolid( path );
+		gl::popModelMatrix();
+
+		gl::pushModelMatrix();
+		gl::translate( step, step * 3.0f );
+		gl::color( Color( 1.0f, 0.0f, 0.0f ) );
+		gl::draw( polyline2D );
+		gl::translate( step, 0.0f );
+		gl::color( Color( 1.0f, 1.0f, 0.0f ) );
+		gl::drawSolid( polyline2D );
+		gl::popModelMatrix();
+
+		gl::pushModelMatrix();
+		gl::translate( step, step * 4.0f );
+		gl::pushModelMatrix();
+		gl::rotate( i * 0.75f, 0.0f, 1.0f, 0.0f );
+		gl::color( Color( 1.0f, 0.0f, 0.0f ) );
+		gl::draw( polyline3D );
+		gl::popModelMatrix();
+		gl::translate( step, 0.0f );
+		gl::pushModelMatrix();
+		gl::rotate( i * -1.5f, 0.0f, 0.5f, 1.0f );
+		gl::drawLine( Vec3f( 0.0f, 0.0f, radius ), Vec3f( 0.0f, 0.0f, -radius ) );
+		gl::drawLine( Vec3f( -radius, 0.0f, 0.0f ), Vec3f( radius, 0.0f, 0.0f ) );
+		gl::drawLine( Vec3f( 0.0f, -radius, 0.0f ), Vec3f( 0.0f, radius, 0.0f ) );
+		gl::popModelMatrix();
+		gl::popModelMatrix();
+	}
+}
+
+// Times \a iterations of \a workload and writes the GL calls it made and the Context's tallies of them
+inline void WriteWorkloadSpeed( std::ostream& os, const gl::ContextRef &ctx, const char *name, int iterations, const std::function<void( int )> &workload )
+{
+	gl::NullDispatch::resetCounts();
+	ctx->endFrameStats();
+	Timer timer;
+	timer.start();
+	workload( iterations );
+	timer.stop();
+	ctx->endFrameStats();
+	os << "   " << "   " << iterations << " " << name << " iterations took " << timer.getSeconds() << " seconds, " << gl::NullDispatch::getTotalCalls() << " GL calls" << "\n";
+	std::stringstream ss;
+	ss << ctx->getFrameStats();
+	std::string line;
+	while( std::getline( ss, line ) )
+		os << "   " << "   " << line << "\n";
+}
+
+// Returns whether the Context's count of issued requests for \a state matches the calls which reached the entry points \a names
+inline bool IsIssuedCountExact( const gl::ContextStats &stats, gl::ContextStats::State state, const char *names[], int numNames )
+{
+	uint32_t numCalls = 0;
+	for( int n = 0; n < numNames; ++n )
+		numCalls += gl::NullDispatch::getNumCalls( names[n] );
+	return stats.getNumIssued( state ) == numCalls;
+}
+
+inline void TestNullDispatch( std::ostream& os )
+{
+	// static void install(); static void uninstall();
+	{
+		auto savedBindTexture = _funcptr_glBindTexture;
+		auto savedGetIntegerv = _funcptr_glGetIntegerv;
+		gl::NullDispatch::install();
+		glBindTexture( GL_TEXTURE_2D, 1 );
+		glBindTexture( GL_TEXTURE_2D, 2 );
+		GLint viewport[4] = { -1, -1, -1, -1 };
+		glGetIntegerv( GL_VIEWPORT, viewport );
+		GLint guard[2] = { 0, -1 };
+		glGetIntegerv( GL_ACTIVE_TEXTURE, guard );
+		bool result = gl::NullDispatch::isInstalled() && ( gl::NullDispatch::getNumCalls( "glBindTexture" ) == 2 ) && ( gl::NullDispatch::getNumCalls( "glGetIntegerv" ) == 2 )
+					&& ( gl::NullDispatch::getTotalCalls() == 4 ) && ( gl::NullDispatch::getNumCalls( "glNotAnEntryPoint" ) == 0 )
+					&& ( viewport[0] == 0 && viewport[3] == 0 ) && ( guard[1] == -1 );
+		gl::NullDispatch::resetCounts();
+		result = result && ( gl::NullDispatch::getTotalCalls() == 0 );
+		gl::NullDispatch::uninstall();
+		result = result && ! gl::NullDispatch::isInstalled() && ( _funcptr_glBindTexture == savedBindTexture ) && ( _funcptr_glGetIntegerv == savedGetIntegerv );
+
+		os << (result ? "passed" : "FAILED") << " : " << "static void install(); static void uninstall();" << "\n";
+	}
+
+	// Context without a GL context: every request it counts as issued reaches the driver, and no others do
+	gl::NullDispatch::install();
+	gl::Environment::setCore();
+	gl::ContextRef ctx = gl::Context::createFromExisting( std::make_shared<gl::Context::PlatformData>() );
+	{
+		DrawStateWorkload( 1 ); // warms the stock shaders and vertex buffers
+		gl::NullDispatch::resetCounts();
+		ctx->endFrameStats();
+		DrawStateWorkload( 10 );
+		ctx->endFrameStats();
+		const gl::ContextStats &stats = ctx->getFrameStats();
+
+		const char *textureNames[] = { "glBindTexture" }, *bufferNames[] = { "glBindBuffer" }, *activeTextureNames[] = { "glActiveTexture" };
+		const char *progNames[] = { "glUseProgram" }, *vaoNames[] = { "glBindVertexArray" }, *framebufferNames[] = { "glBindFramebuffer" };
+		const char *boolNames[] = { "glEnable", "glDisable", "glDepthMask" }, *blendNames[] = { "glBlendFuncSeparate" };
+		const char *viewportNames[] = { "glViewport" }, *scissorNames[] = { "glScissor" };
+		const char *drawNames[] = { "glDrawArrays", "glDrawElements", "glDrawArraysInstanced", "glDrawElementsInstanced" };
+		bool result = IsIssuedCountExact( stats, gl::ContextStats::TEXTURE_BINDING, textureNames, 1 )
+					&& IsIssuedCountExact( stats, gl::ContextStats::BUFFER_BINDING, bufferNames, 1 )
+					&& IsIssuedCountExact( stats, gl::ContextStats::ACTIVE_TEXTURE, activeTextureNames, 1 )
+					&& IsIssuedCountExact( stats, gl::ContextStats::GLSL_PROG, progNames, 1 )
+					&& IsIssuedCountExact( stats, gl::ContextStats::VAO, vaoNames, 1 )
+					&& IsIssuedCountExact( stats, gl::ContextStats::FRAMEBUFFER, framebufferNames, 1 )
+					&& IsIssuedCountExact( stats, gl::ContextStats::BOOL_STATE, boolNames, 3 )
+					&& IsIssuedCountExact( stats, gl::ContextStats::BLEND_FUNC, blendNames, 1 )
+					&& IsIssuedCountExact( stats, gl::ContextStats::VIEWPORT, viewportNames, 1 )
+					&& IsIssuedCountExact( stats, gl::ContextStats::SCISSOR, scissorNames, 1 );
+		uint32_t numDraws = 0;
+		for( int n = 0; n < 4; ++n )
+			numDraws += gl::NullDispatch::getNumCalls( drawNames[n] );
+		result = result && ( stats.getNumDrawCalls() == numDraws ) && ( numDraws == 40 ) && ( stats.getTotalRedundant() > 0 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "ContextStats issued counts match NullDispatch calls" << "\n";
+	}
+
+	// void popBlendFuncSeparate(); void popFramebuffer( GLuint framebuffer = GL_FRAMEBUFFER );
+	{
+		// popping past the bottom of the stacks issues nothing, and must not be counted as issued
+		ctx->endFrameStats();
+		gl::NullDispatch::resetCounts();
+		ctx->pushBlendFuncSeparate( GL_ONE, GL_ZERO, GL_ONE, GL_ZERO );
+		for( int i = 0; i < 4; ++i )
+			ctx->popBlendFuncSeparate();
+		ctx->pushFramebuffer( GL_FRAMEBUFFER, 5 );
+		for( int i = 0; i < 4; ++i )
+			ctx->popFramebuffer( GL_FRAMEBUFFER );
+		ctx->endFrameStats();
+		const gl::ContextStats &stats = ctx->getFrameStats();
+		const char *blendNames[] = { "glBlendFuncSeparate" }, *framebufferNames[] = { "glBindFramebuffer" };
+		bool result = IsIssuedCountExact( stats, gl::ContextStats::BLEND_FUNC, blendNames, 1 )
+					&& IsIssuedCountExact( stats, gl::ContextStats::FRAMEBUFFER, framebufferNames, 1 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void popBlendFuncSeparate(); void popFramebuffer( GLuint framebuffer = GL_FRAMEBUFFER );" << "\n";
+	}
+
+	// CPU cost of the gl namespace alone, with the driver out of the picture
+	os << "   " << "speed test:" << "\n";
+	{
+		WriteWorkloadSpeed( os, ctx, "state workload", 10000, DrawStateWorkload );
+
+		Path2d path;
+		path.arc( Vec2f::zero(), 50.0f, 0.0f, M_PI * 1.66f );
+		path.lineTo( Vec2f::zero() );
+		Rand rnd( 1234 );
+		PolyLine2f polyline2D;
+		for( int i = 0; i < 50; ++i )
+			polyline2D.push_back( rnd.nextVec2f() * 50.0f );
+		PolyLine<Vec3f> polyline3D;
+		for( int i = 0; i < 48; ++i ) {
+			const float inclination = i * float( M_PI ) / 48, azimuth = i * 12.0f * float( M_PI ) / 48;
+			polyline3D.push_back( 50.0f * Vec3f( math<float>::sin( inclination ) * math<float>::cos( azimuth ), math<float>::cos( inclination ), math<float>::sin( inclination ) * math<float>::sin( azimuth ) ) );
+		}
+		ConvenienceDrawingWorkload( 1, path, polyline2D, polyline3D ); // warms the stock shaders and vertex buffers
+		WriteWorkloadSpeed( os, ctx, "convenience drawing", 1000, [&]( int iterations ) { ConvenienceDrawingWorkload( iterations, path, polyline2D, polyline3D ); } );
+	}
+
+	ctx.reset();
+	gl::NullDispatch::uninstall();
+}
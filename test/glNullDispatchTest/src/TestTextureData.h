@@ -0,0 +1,299 @@
+#pragma once
+
+#include "cinder/gl/Texture.h"
+#include "cinder/gl/TextureFormatParsers.h"
+#include "cinder/ip/Mipmap.h"
+#include "cinder/DataSource.h"
+#include "cinder/Rand.h"
+
+#include <cstring>
+#include <vector>
+
+inline void AppendUint32( std::vector<uint8_t> *bytes, uint32_t value )
+{
+	for( int b = 0; b < 4; ++b )
+		bytes->push_back( uint8_t( value >> ( b * 8 ) ) );
+}
+
+inline Buffer MakeBuffer( const std::vector<uint8_t> &bytes )
+{
+	Buffer result( bytes.size() );
+	memcpy( result.getData(), bytes.data(), bytes.size() );
+	return result;
+}
+
+// The expected contents of a level of a TextureData
+struct ExpectedLevel {
+	ExpectedLevel( GLint width, GLint height, const std::vector<uint8_t> &data ) : mWidth( width ), mHeight( height ), mData( data ) {}
+
+	GLint					mWidth, mHeight;
+	std::vector<uint8_t>	mData;
+};
+
+// Returns the bytes of a level of \a numBytes, distinct for each \a level
+inline std::vector<uint8_t> MakeLevelData( size_t numBytes, int level )
+{
+	std::vector<uint8_t> result( numBytes );
+	for( size_t i = 0; i < numBytes; ++i )
+		result[i] = uint8_t( level * 53 + i * 7 + 1 );
+	return result;
+}
+
+/* Returns a little endian KTX of GL_RGB / GL_UNSIGNED_BYTE with \a numLevels levels, whose rows are padded to 4 bytes, and 12 bytes
+	of key/value data, appending its levels to \a expected */
+inline Buffer MakeKtx( GLint width, GLint height, uint32_t numLevels, std::vector<ExpectedLevel> *expected )
+{
+	static const uint8_t identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+	std::vector<uint8_t> bytes( identifier, identifier + 12 );
+	const uint32_t header[] = { 0x04030201, GL_UNSIGNED_BYTE, 1, GL_RGB, GL_RGB8, GL_RGB, (uint32_t)width, (uint32_t)height, 0, 0, 1, numLevels, 12 };
+	for( size_t h = 0; h < sizeof(header) / sizeof(header[0]); ++h )
+		AppendUint32( &bytes, header[h] );
+	bytes.insert( bytes.end(), 12, 0xEE );
+
+	for( uint32_t level = 0; level < std::max<uint32_t>( numLevels, 1 ); ++level ) {
+		const GLint levelWidth = std::max<GLint>( 1, width >> level ), levelHeight = std::max<GLint>( 1, height >> level );
+		const std::vector<uint8_t> data = MakeLevelData( ( ( levelWidth * 3 + 3 ) & ~3 ) * levelHeight, level );
+		AppendUint32( &bytes, (uint32_t)data.size() );
+		bytes.insert( bytes.end(), data.begin(), data.end() );
+		expected->push_back( ExpectedLevel( levelWidth, levelHeight, data ) );
+	}
+
+	return MakeBuffer( bytes );
+}
+
+// Returns a DDS of \a fourCC, DXT1 or DXT5, whose header's mip map count is \a mipMapCount, appending its levels to \a expected
+inline Buffer MakeDds( GLint width, GLint height, uint32_t fourCC, uint32_t mipMapCount, std::vector<ExpectedLevel> *expected )
+{
+	const size_t blockBytes = ( fourCC == 0x31545844 /*DXT1*/ ) ? 8 : 16;
+	std::vector<uint8_t> bytes;
+	bytes.push_back( 'D' ); bytes.push_back( 'D' ); bytes.push_back( 'S' ); bytes.push_back( ' ' );
+	uint32_t surface[31] = { 0 };
+	surface[0] = 124;
+	surface[1] = 0x1 | 0x2 | 0x4 | 0x1000 | ( mipMapCount ? 0x20000 : 0 ); // caps, height, width, pixel format and mip map count
+	surface[2] = height;
+	surface[3] = width;
+	surface[6] = mipMapCount;
+	surface[18] = 32; // DDPIXELFORMAT size
+	surface[19] = 0x4; // DDPF_FOURCC
+	surface[20] = fourCC;
+	for( int s = 0; s < 31; ++s )
+		AppendUint32( &bytes, surface[s] );
+
+	for( uint32_t level = 0; level < std::max<uint32_t>( mipMapCount, 1 ); ++level ) {
+		const GLint levelWidth = std::max<GLint>( 1, width >> level ), levelHeight = std::max<GLint>( 1, height >> level );
+		const std::vector<uint8_t> data = MakeLevelData( ( ( levelWidth + 3 ) / 4 ) * ( ( levelHeight + 3 ) / 4 ) * blockBytes, level );
+		bytes.insert( bytes.end(), data.begin(), data.end() );
+		expected->push_back( ExpectedLevel( levelWidth, levelHeight, data ) );
+	}
+
+	return MakeBuffer( bytes );
+}
+
+// Returns whether \a data's levels are \a expected, tightly packed in order from the start of its data store
+inline bool IsLevelData( const gl::TextureData &data, const std::vector<ExpectedLevel> &expected )
+{
+	if( data.getNumLevels() != expected.size() )
+		return false;
+	size_t offset = 0;
+	for( size_t l = 0; l < expected.size(); ++l ) {
+		const gl::TextureData::Level &level = data.getLevel( l );
+		if( level.width != expected[l].mWidth || level.height != expected[l].mHeight || level.dataSize != expected[l].mData.size() || level.offset != offset )
+			return false;
+		if( memcmp( data.getDataStorePtr( level.offset ), expected[l].mData.data(), level.dataSize ) != 0 )
+			return false;
+		offset += level.dataSize;
+	}
+	return offset <= data.getDataStoreSize();
+}
+
+/* Returns a TextureDataLevelFn which checks that each level is passed once, in order, as soon as it has been read: it must be
+	\a expected, and the last level of the TextureData so far. Clears \a result on any mismatch, and counts the calls in \a numCalls. */
+inline gl::TextureDataLevelFn CheckLevels( const std::vector<ExpectedLevel> &expected, bool *result, size_t *numCalls )
+{
+	*numCalls = 0;
+	return [&expected, result, numCalls] ( const gl::TextureData &data, size_t levelIndex ) {
+		const std::vector<ExpectedLevel> soFar( expected.begin(), expected.begin() + std::min( levelIndex + 1, expected.size() ) );
+		*result = *result && ( levelIndex == *numCalls ) && IsLevelData( data, soFar );
+		++*numCalls;
+	};
+}
+
+// Returns \a surface's pixels as tightly packed RGB or RGBA rows
+template<typename T>
+inline std::vector<uint8_t> PackSurface( const SurfaceT<T> &surface )
+{
+	std::vector<uint8_t> result;
+	const int numChannels = surface.hasAlpha() ? 4 : 3;
+	for( int32_t y = 0; y < surface.getHeight(); ++y ) {
+		for( int32_t x = 0; x < surface.getWidth(); ++x ) {
+			const ColorAT<T> c = surface.getPixel( Vec2i( x, y ) );
+			const T channels[4] = { c.r, c.g, c.b, c.a };
+			const uint8_t *bytes = reinterpret_cast<const uint8_t*>( channels );
+			result.insert( result.end(), bytes, bytes + numChannels * sizeof(T) );
+		}
+	}
+	return result;
+}
+
+// Returns whether generateMipmapTextureData() stores \a surface followed by ip::generateMipmaps()'s chain, packed
+template<typename T>
+inline bool IsMipmapTextureData( const SurfaceT<T> &surface, const FilterBase &filter, bool srgb, const gl::TextureData &data )
+{
+	std::vector<SurfaceT<T> > chain = ip::generateMipmaps( surface, filter, srgb );
+	chain.insert( chain.begin(), surface );
+	std::vector<ExpectedLevel> expected;
+	for( size_t l = 0; l < chain.size(); ++l )
+		expected.push_back( ExpectedLevel( chain[l].getWidth(), chain[l].getHeight(), PackSurface( chain[l] ) ) );
+	return IsLevelData( data, expected ) && ( data.getWidth() == surface.getWidth() ) && ( data.getHeight() == surface.getHeight() )
+			&& ( data.getDataFormat() == ( surface.hasAlpha() ? GL_RGBA : GL_RGB ) ) && ( data.getUnpackAlignment() == 1 );
+}
+
+// Records the levels uploaded with glTexImage2D and glCompressedTexImage2D, and the GL_TEXTURE_MAX_LEVEL set, of the bound texture
+struct TexImageRecorder {
+	static std::vector<GLint>&	levels() { static std::vector<GLint> sLevels; return sLevels; }
+	static GLint&				maxLevel() { static GLint sMaxLevel = -1; return sMaxLevel; }
+
+	static void CODEGEN_FUNCPTR texImage2D( GLenum, GLint level, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const GLvoid* )	{ levels().push_back( level ); }
+	static void CODEGEN_FUNCPTR compressedTexImage2D( GLenum, GLint level, GLenum, GLsizei, GLsizei, GLint, GLsizei, const GLvoid* )	{ levels().push_back( level ); }
+	static void CODEGEN_FUNCPTR texParameteri( GLenum, GLenum pname, GLint param )
+	{
+		if( pname == GL_TEXTURE_MAX_LEVEL )
+			maxLevel() = param;
+	}
+
+	// Requires that gl::NullDispatch is installed
+	static void install()
+	{
+		_funcptr_glTexImage2D = &texImage2D;
+		_funcptr_glCompressedTexImage2D = &compressedTexImage2D;
+		_funcptr_glTexParameteri = &texParameteri;
+		reset();
+	}
+
+	static void reset()
+	{
+		levels().clear();
+		maxLevel() = -1;
+		gl::NullDispatch::resetCounts();
+	}
+
+	// Returns whether levels 0 through \a numLevels - 1 were uploaded in order, with \a maxLevel and \a numGenerateMipmaps calls to glGenerateMipmap
+	static bool isUploaded( GLint numLevels, GLint maxLevel, uint32_t numGenerateMipmaps )
+	{
+		bool result = ( levels().size() == (size_t)numLevels ) && ( TexImageRecorder::maxLevel() == maxLevel ) && ( gl::NullDispatch::getNumCalls( "glGenerateMipmap" ) == numGenerateMipmaps );
+		for( GLint l = 0; l < numLevels && result; ++l )
+			result = levels()[l] == l;
+		return result;
+	}
+};
+
+inline void TestTextureData( std::ostream& os )
+{
+	// void parseKtx( const DataSourceRef &dataSource, TextureData *resultData, const TextureDataLevelFn &levelFn );
+	{
+		// a full chain of odd sizes, a partial chain, and a single level
+		const GLint sizes[][3] = { { 5, 3, 3 }, { 16, 4, 2 }, { 7, 7, 1 } };
+		bool result = true;
+		for( int s = 0; s < 3; ++s ) {
+			std::vector<ExpectedLevel> expected;
+			const Buffer buffer = MakeKtx( sizes[s][0], sizes[s][1], sizes[s][2], &expected );
+			gl::TextureData data;
+			size_t numCalls;
+			gl::parseKtx( DataSourceBuffer::create( buffer ), &data, CheckLevels( expected, &result, &numCalls ) );
+			result = result && ( numCalls == expected.size() ) && IsLevelData( data, expected ) && ( data.getWidth() == sizes[s][0] ) && ( data.getHeight() == sizes[s][1] )
+						&& ( data.getDataFormat() == GL_RGB ) && ( data.getDataType() == GL_UNSIGNED_BYTE ) && ( data.getUnpackAlignment() == 4 );
+			// without a callback the result is the same
+			gl::TextureData plainData;
+			gl::parseKtx( DataSourceBuffer::create( buffer ), &plainData );
+			result = result && IsLevelData( plainData, expected );
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "void parseKtx( const DataSourceRef &dataSource, TextureData *resultData, const TextureDataLevelFn &levelFn );" << "\n";
+	}
+
+	// void parseDds( const DataSourceRef &dataSource, TextureData *resultData, const TextureDataLevelFn &levelFn );
+	{
+		// DXT5 levels narrower than a block, DXT1 with a partial chain, and without a mip map count
+		const uint32_t dxt1 = 0x31545844, dxt5 = 0x35545844;
+		const uint32_t fourCCs[] = { dxt5, dxt1, dxt1 }, mipMapCounts[] = { 4, 2, 0 };
+		const GLint sizes[][2] = { { 12, 4 }, { 8, 8 }, { 8, 8 } };
+		const GLenum formats[] = { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT };
+		bool result = true;
+		for( int s = 0; s < 3; ++s ) {
+			std::vector<ExpectedLevel> expected;
+			const Buffer buffer = MakeDds( sizes[s][0], sizes[s][1], fourCCs[s], mipMapCounts[s], &expected );
+			gl::TextureData data;
+			size_t numCalls;
+			gl::parseDds( DataSourceBuffer::create( buffer ), &data, CheckLevels( expected, &result, &numCalls ) );
+			result = result && ( numCalls == expected.size() ) && IsLevelData( data, expected ) && ( data.getInternalFormat() == formats[s] ) && ( data.getDataType() == 0 );
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "void parseDds( const DataSourceRef &dataSource, TextureData *resultData, const TextureDataLevelFn &levelFn );" << "\n";
+	}
+
+	// void generateMipmapTextureData( const Surface8u &surface, TextureData *resultData, const FilterBase &filter, bool srgb );
+	{
+		// BGR and row padding are repacked as RGB; RGBA float levels are stored whole
+		Rand rnd( 31 );
+		Surface8u surface8( 7, 5, false, SurfaceChannelOrder::BGR );
+		for( int32_t y = 0; y < surface8.getHeight(); ++y ) {
+			for( int32_t x = 0; x < surface8.getWidth(); ++x )
+				surface8.setPixel( Vec2i( x, y ), ColorA8u( rnd.nextUint( 256 ), rnd.nextUint( 256 ), rnd.nextUint( 256 ) ) );
+		}
+		Surface32f surface32( 6, 3, true );
+		for( int32_t y = 0; y < surface32.getHeight(); ++y ) {
+			for( int32_t x = 0; x < surface32.getWidth(); ++x )
+				surface32.setPixel( Vec2i( x, y ), ColorAf( rnd.nextFloat(), rnd.nextFloat(), rnd.nextFloat(), rnd.nextFloat() ) );
+		}
+
+		gl::TextureData data8, data8Srgb, data32;
+		gl::generateMipmapTextureData( surface8, &data8 );
+		gl::generateMipmapTextureData( surface8, &data8Srgb, FilterGaussian(), true );
+		gl::generateMipmapTextureData( surface32, &data32 );
+		bool result = IsMipmapTextureData( surface8, FilterBox(), false, data8 ) && ( data8.getNumLevels() == 3 ) && ( data8.getInternalFormat() == GL_RGB8 ) && ( data8.getDataType() == GL_UNSIGNED_BYTE )
+					&& IsMipmapTextureData( surface8, FilterGaussian(), true, data8Srgb ) && ( data8Srgb.getInternalFormat() == GL_SRGB8 )
+					&& IsMipmapTextureData( surface32, FilterBox(), false, data32 ) && ( data32.getNumLevels() == 3 ) && ( data32.getInternalFormat() == GL_RGBA32F ) && ( data32.getDataType() == GL_FLOAT );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void generateMipmapTextureData( const Surface8u &surface, TextureData *resultData, const FilterBase &filter, bool srgb );" << "\n";
+	}
+
+	gl::NullDispatch::install();
+	gl::Environment::setCore();
+	gl::ContextRef ctx = gl::Context::createFromExisting( std::make_shared<gl::Context::PlatformData>() );
+	TexImageRecorder::install();
+
+	// static TextureRef create( const TextureData &data, const Format &format );
+	{
+		// supplied levels are uploaded instead of generated, and a partial chain limits the max level
+		Surface8u surface( 20, 9, true );
+		gl::TextureData mipmapData;
+		gl::generateMipmapTextureData( surface, &mipmapData );
+		const gl::Texture::Format mipmapFormat = gl::Texture::Format().mipmap();
+		gl::Texture::create( mipmapData, mipmapFormat );
+		bool result = TexImageRecorder::isUploaded( 5, 4, 0 );
+
+		std::vector<ExpectedLevel> expected;
+		const Buffer partialKtx = MakeKtx( 16, 16, 2, &expected );
+		TexImageRecorder::reset();
+		gl::Texture::createFromKtx( DataSourceBuffer::create( partialKtx ), mipmapFormat );
+		result = result && TexImageRecorder::isUploaded( 2, 1, 0 );
+		TexImageRecorder::reset();
+		gl::Texture::Format limitedFormat = mipmapFormat;
+		limitedFormat.setMaxMipmapLevel( 2 );
+		gl::Texture::createFromDds( DataSourceBuffer::create( MakeDds( 8, 8, 0x31545844, 4, &expected ) ), limitedFormat );
+		result = result && TexImageRecorder::isUploaded( 4, 2, 0 );
+
+		// nothing is generated without mipmapping, and a single level is still mipmapped by GL
+		TexImageRecorder::reset();
+		gl::Texture::create( mipmapData, gl::Texture::Format() );
+		result = result && TexImageRecorder::isUploaded( 5, -1, 0 );
+		TexImageRecorder::reset();
+		gl::Texture::createFromKtx( DataSourceBuffer::create( MakeKtx( 16, 16, 1, &expected ) ), mipmapFormat );
+		result = result && TexImageRecorder::isUploaded( 1, 1000, 1 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "static TextureRef create( const TextureData &data, const Format &format );" << "\n";
+	}
+
+	ctx.reset();
+	gl::NullDispatch::uninstall();
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "cinder/gl/GlslProg.h"
+
+#include <map>
+
+// Stands in for the driver's uniform state. Every program has the same uniforms: "uValue" and "uScale" at locations 1 and 2, and
+// a float[4] "uArray" whose elements are at locations 4 through 7. Only float uniforms are recorded.
+struct UniformRecorder {
+	static std::map<GLuint, std::map<GLint, float>>&	values() { static std::map<GLuint, std::map<GLint, float>> sValues; return sValues; }
+	static uint32_t&									numUploads() { static uint32_t sNumUploads = 0; return sNumUploads; }
+
+	// Returns the value last uploaded to \a location of \a prog, or -1 if none has been
+	static float getValue( const gl::GlslProgRef &prog, GLint location )
+	{
+		auto &progValues = values()[prog->getHandle()];
+		auto valueIt = progValues.find( location );
+		return ( valueIt == progValues.end() ) ? -1 : valueIt->second;
+	}
+
+	static GLint CODEGEN_FUNCPTR getUniformLocation( GLuint program, const GLchar *name )
+	{
+		static const char *sNames[] = { "uValue", "uScale", "uArray", "uArray[0]", "uArray[1]", "uArray[2]", "uArray[3]" };
+		static const GLint sLocations[] = { 1, 2, 4, 4, 5, 6, 7 };
+		for( int n = 0; n < 7; ++n ) {
+			if( std::string( name ) == sNames[n] )
+				return sLocations[n];
+		}
+		return -1;
+	}
+
+	static void CODEGEN_FUNCPTR uniform1fv( GLint location, GLsizei count, const GLfloat *value )
+	{
+		auto &progValues = values()[gl::context()->getGlslProg()->getHandle()];
+		for( GLsizei i = 0; i < count; ++i )
+			progValues[location + i] = value[i];
+		++numUploads();
+	}
+
+	// Requires that gl::NullDispatch is installed
+	static void install()
+	{
+		_funcptr_glGetUniformLocation = &getUniformLocation;
+		_funcptr_glUniform1fv = &uniform1fv;
+		values().clear();
+		numUploads() = 0;
+	}
+};
+
+inline bool IsArrayUniform( const gl::GlslProgRef &prog, const float *expected )
+{
+	for( int i = 0; i < 4; ++i ) {
+		if( UniformRecorder::getValue( prog, 4 + i ) != expected[i] )
+			return false;
+	}
+	return true;
+}
+
+inline gl::GlslProgRef CreateRecordedGlslProg()
+{
+	return gl::GlslProg::create( "void main() { gl_Position = vec4( 0 ); }", "void main() { gl_FragColor = vec4( 1 ); }" );
+}
+
+inline void TestUniforms( std::ostream& os )
+{
+	gl::NullDispatch::install();
+	gl::Environment::setCore();
+	gl::ContextRef ctx = gl::Context::createFromExisting( std::make_shared<gl::Context::PlatformData>() );
+	UniformRecorder::install();
+
+	const float arrayA[4] = { 1, 2, 3, 4 }, arrayB[4] = { 5, 6, 7, 8 };
+	const float arrayAWith9[4] = { 1, 9, 3, 4 };
+
+	// void uniform( const std::string &name, const float *data, int count ) const;
+	{
+		// setting an element of an array, then the whole array again, must not skip restoring the element
+		gl::GlslProgRef prog = CreateRecordedGlslProg();
+		prog->uniform( "uArray", arrayA, 4 );
+		prog->uniform( "uArray[1]", 9.0f );
+		bool result = IsArrayUniform( prog, arrayAWith9 );
+		prog->uniform( "uArray", arrayA, 4 );
+		result = result && IsArrayUniform( prog, arrayA );
+		// and the reverse: the element's shadow is stale once the whole array has been set
+		prog->uniform( "uArray[1]", 9.0f );
+		result = result && IsArrayUniform( prog, arrayAWith9 );
+		// unrelated uniforms are unaffected, and still skip redundant uploads
+		prog->uniform( "uValue", 0.5f );
+		uint32_t numUploads = UniformRecorder::numUploads();
+		prog->uniform( "uArray", arrayB, 4 );
+		prog->uniform( "uValue", 0.5f );
+		prog->uniform( "uArray", arrayB, 4 );
+		result = result && IsArrayUniform( prog, arrayB ) && ( UniformRecorder::getValue( prog, 1 ) == 0.5f ) && ( UniformRecorder::numUploads() == numUploads + 1 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void uniform( const std::string &name, const float *data, int count ) const;" << "\n";
+	}
+
+	// void setUniformsDeferred( bool deferred ); void flushUniforms() const;
+	{
+		// overlapping values are uploaded in the order they were set, whichever was set first
+		gl::GlslProgRef prog = CreateRecordedGlslProg();
+		prog->setUniformsDeferred( true );
+		prog->uniform( "uArray", arrayA, 4 );
+		prog->uniform( "uArray[1]", 9.0f );
+		prog->flushUniforms();
+		bool result = IsArrayUniform( prog, arrayAWith9 );
+		prog->uniform( "uArray[1]", 9.0f );
+		prog->uniform( "uArray", arrayA, 4 );
+		prog->flushUniforms();
+		result = result && IsArrayUniform( prog, arrayA );
+		prog->uniform( "uArray", arrayB, 4 );
+		prog->uniform( "uArray[2]", 9.0f );
+		prog->uniform( "uArray", arrayA, 4 );
+		prog->uniform( "uArray[1]", 9.0f );
+		result = result && IsArrayUniform( prog, arrayA ); // nothing reaches the driver before the flush
+		prog->flushUniforms();
+		result = result && IsArrayUniform( prog, arrayAWith9 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void setUniformsDeferred( bool deferred ); void flushUniforms() const;" << "\n";
+	}
+
+	// Uploads and program changes with and without deferral, setting uniforms while another program is bound
+	{
+		// each frame sets "uValue" three times, ending where it began, and "uScale" twice to a new value
+		const int numFrames = 10;
+		auto setFrameUniforms = [] ( const gl::GlslProgRef &prog, int frame ) {
+			prog->uniform( "uValue", 1.0f );
+			prog->uniform( "uValue", 2.0f );
+			prog->uniform( "uValue", 1.0f );
+			prog->uniform( "uScale", float( frame ) );
+			prog->uniform( "uScale", float( frame ) );
+		};
+
+		gl::GlslProgRef immediateProg = CreateRecordedGlslProg(), deferredProg = CreateRecordedGlslProg();
+		deferredProg->setUniformsDeferred( true );
+		gl::ScopedGlslProg otherProg( CreateRecordedGlslProg() );
+
+		UniformRecorder::numUploads() = 0;
+		gl::NullDispatch::resetCounts();
+		for( int frame = 0; frame < numFrames; ++frame )
+			setFrameUniforms( immediateProg, frame );
+		uint32_t immediateUploads = UniformRecorder::numUploads(), immediateUsePrograms = gl::NullDispatch::getNumCalls( "glUseProgram" );
+
+		UniformRecorder::numUploads() = 0;
+		gl::NullDispatch::resetCounts();
+		for( int frame = 0; frame < numFrames; ++frame ) {
+			setFrameUniforms( deferredProg, frame );
+			deferredProg->flushUniforms();
+		}
+		uint32_t deferredUploads = UniformRecorder::numUploads(), deferredUsePrograms = gl::NullDispatch::getNumCalls( "glUseProgram" );
+
+		// immediately, the first frame uploads "uValue" three times and each frame after it twice; each upload binds and restores
+		// the program. Deferred, each frame's flush binds once and uploads both, as "uValue" has changed since it was last set.
+		bool result = ( immediateUploads == 3 + ( numFrames - 1 ) * 2 + numFrames ) && ( immediateUsePrograms == 2 * immediateUploads )
+					&& ( deferredUploads == 2 * numFrames ) && ( deferredUsePrograms == 2 * numFrames )
+					&& ( UniformRecorder::getValue( immediateProg, 1 ) == 1.0f ) && ( UniformRecorder::getValue( deferredProg, 1 ) == 1.0f )
+					&& ( UniformRecorder::getValue( immediateProg, 2 ) == numFrames - 1 ) && ( UniformRecorder::getValue( deferredProg, 2 ) == numFrames - 1 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "glUniform and glUseProgram counts with and without deferral" << "\n";
+		os << "   " << "   " << numFrames << " frames: " << immediateUploads << " uploads and " << immediateUsePrograms << " program changes immediately, "
+			<< deferredUploads << " uploads and " << deferredUsePrograms << " program changes deferred" << "\n";
+	}
+
+	ctx.reset();
+	gl::NullDispatch::uninstall();
+}
@@ -0,0 +1,69 @@
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Context.h"
+#include "cinder/gl/Environment.h"
+#include "cinder/gl/NullDispatch.h"
+#include "cinder/Path2d.h"
+#include "cinder/PolyLine.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+using namespace ci;
+
+#include "TestNullDispatch.h"
+#include "TestUniforms.h"
+#include "TestDrawQueue.h"
+#include "TestTextureData.h"
+
+static const std::string kPre = "   ";
+
+std::string MakeIndentedBlock( const std::stringstream& src )
+{
+	std::stringstream ss;
+	std::string data = src.str();
+	if( ! data.empty() ) {
+		ss << kPre;
+		for( size_t i = 0; i < data.size(); ++i ) {
+			char c = data[i];
+			ss << c;
+			if( '\n' == c ) {
+				ss << kPre;
+			}
+		}
+	}
+	return ss.str();
+}
+
+void DoTest( const std::string& name, void (*testFunc)(std::ostream&) );
+
+#define DO_TEST( _FUNC_ ) \
+	DoTest( #_FUNC_, &_FUNC_ );
+
+int main( int argc, char **argv )
+{
+	std::cout << std::endl;
+
+	DO_TEST( TestNullDispatch );
+	DO_TEST( TestUniforms );
+	DO_TEST( TestDrawQueue );
+	DO_TEST( TestTextureData );
+
+	std::cout << std::endl;
+
+	return 0;
+}
+
+void DoTest( const std::string& name, void (*testFunc)( std::ostream& os ) )
+{
+	std::cout << "Testing " << name << "\n";
+	std::stringstream ss;
+	testFunc( ss );
+	std::string output = MakeIndentedBlock( ss );
+	if( ! output.empty() ) {
+		std::cout << output << "\n";
+	}
+	std::cout << std::endl;
+}
@@ -0,0 +1,272 @@
+#pragma once
+
+// Exposes the atlas's pages and slots, so that its layout can be checked against what was inserted
+class GlyphAtlasInspector : public GlyphAtlas {
+  public:
+	GlyphAtlasInspector( int32_t pageWidth, int32_t pageHeight, size_t maxPages, int32_t padding )
+		: GlyphAtlas( pageWidth, pageHeight, maxPages, padding )
+	{}
+
+	// Checks that the shelves of each page are stacked from the top without gaps, that neighboring empty shelves have been merged and empty ones dropped
+	// from the bottom, and that each shelf's free spans are sorted, merged and exactly complement the glyphs allocated on it
+	bool areShelvesValid() const
+	{
+		for( size_t p = 0; p < mPages.size(); ++p ) {
+			const Page &page = mPages[p];
+			int32_t y = 0;
+			for( size_t s = 0; s < page.mShelves.size(); ++s ) {
+				const Shelf &shelf = page.mShelves[s];
+				if( shelf.mY != y || shelf.mHeight <= 0 )
+					return false;
+				y += shelf.mHeight;
+				if( shelf.mNumGlyphs == 0 && ( s + 1 == page.mShelves.size() || ( s > 0 && page.mShelves[s - 1].mNumGlyphs == 0 ) ) )
+					return false;
+
+				int32_t freeWidth = 0;
+				for( size_t span = 0; span < shelf.mFreeSpans.size(); ++span ) {
+					const std::pair<int32_t,int32_t> &free = shelf.mFreeSpans[span];
+					if( free.first < 0 || free.first >= free.second || free.second > mPageWidth )
+						return false;
+					// a span touching the next one should have been merged with it
+					if( span + 1 < shelf.mFreeSpans.size() && free.second >= shelf.mFreeSpans[span + 1].first )
+						return false;
+					freeWidth += free.second - free.first;
+				}
+
+				size_t numGlyphs = 0;
+				int32_t usedWidth = 0;
+				for( auto slotIt = mEntries.begin(); slotIt != mEntries.end(); ++slotIt ) {
+					const Slot &slot = slotIt->second;
+					if( slot.mLruIt == mLru.end() || slot.mEntry.mPage != p || slot.mAllocated.y1 != shelf.mY )
+						continue;
+					if( slot.mAllocated.getHeight() > shelf.mHeight )
+						return false;
+					for( size_t span = 0; span < shelf.mFreeSpans.size(); ++span ) {
+						if( slot.mAllocated.x1 < shelf.mFreeSpans[span].second && shelf.mFreeSpans[span].first < slot.mAllocated.x2 )
+							return false;
+					}
+					++numGlyphs;
+					usedWidth += slot.mAllocated.getWidth();
+				}
+				if( numGlyphs != shelf.mNumGlyphs || freeWidth + usedWidth != mPageWidth )
+					return false;
+			}
+			if( y != page.mShelvesHeight || y > mPageHeight )
+				return false;
+		}
+		return true;
+	}
+
+	// Checks that no two glyphs' padded areas overlap, that each lies within its page and on a shelf
+	bool areAllocationsDisjoint() const
+	{
+		std::vector<const Slot*> slots;
+		for( auto slotIt = mEntries.begin(); slotIt != mEntries.end(); ++slotIt ) {
+			if( slotIt->second.mLruIt != mLru.end() )
+				slots.push_back( &slotIt->second );
+		}
+		for( size_t i = 0; i < slots.size(); ++i ) {
+			const Area &a = slots[i]->mAllocated;
+			if( slots[i]->mEntry.mPage >= mPages.size() || a.x1 < 0 || a.y1 < 0 || a.x2 > mPageWidth || a.y2 > mPages[slots[i]->mEntry.mPage].mShelvesHeight )
+				return false;
+			for( size_t j = i + 1; j < slots.size(); ++j ) {
+				const Area &b = slots[j]->mAllocated;
+				if( slots[i]->mEntry.mPage == slots[j]->mEntry.mPage && a.x1 < b.x2 && b.x1 < a.x2 && a.y1 < b.y2 && b.y1 < a.y2 )
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// Checks that each glyph's pixels hold the coverage it was inserted with, and that its padding is cleared
+	bool arePixelsValid( const std::map<Glyph, Channel8u> &coverages ) const
+	{
+		for( auto slotIt = mEntries.begin(); slotIt != mEntries.end(); ++slotIt ) {
+			const Slot &slot = slotIt->second;
+			if( slot.mLruIt == mLru.end() )
+				continue;
+			const Channel8u &page = mPages[slot.mEntry.mPage].mChannel;
+			const Channel8u &coverage = coverages.find( slotIt->first )->second;
+			for( int32_t y = slot.mAllocated.y1; y < slot.mAllocated.y2; ++y ) {
+				for( int32_t x = slot.mAllocated.x1; x < slot.mAllocated.x2; ++x ) {
+					// the glyph sits in the upper-left of its allocation, with the padding to its right and below
+					const bool inGlyph = ( x < slot.mEntry.mArea.x2 ) && ( y < slot.mEntry.mArea.y2 );
+					const uint8_t expected = inGlyph ? *coverage.getData( x - slot.mEntry.mArea.x1, y - slot.mEntry.mArea.y1 ) : 0;
+					if( *page.getData( x, y ) != expected )
+						return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	size_t	getNumShelves( size_t page ) const { return mPages[page].mShelves.size(); }
+	bool	contains( Glyph glyph ) const { return mEntries.find( glyph ) != mEntries.end(); }
+};
+
+// Returns a \a width x \a height coverage bitmap of random values, which are never 0 so that stale padding can't pass for the glyph
+inline Channel8u MakeRandomCoverage( int32_t width, int32_t height, Rand &rnd )
+{
+	Channel8u result( width, height );
+	for( int32_t y = 0; y < height; ++y ) {
+		for( int32_t x = 0; x < width; ++x )
+			*result.getData( x, y ) = (uint8_t)rnd.nextInt( 1, 256 );
+	}
+	return result;
+}
+
+// Mostly small glyphs, some wide or tall ones, and an occasional empty one such as a space
+inline Channel8u MakeRandomGlyphCoverage( Rand &rnd )
+{
+	const int kind = rnd.nextInt( 20 );
+	if( kind == 0 )
+		return Channel8u();
+	else if( kind == 1 )
+		return MakeRandomCoverage( rnd.nextInt( 20, 40 ), rnd.nextInt( 1, 6 ), rnd );
+	else if( kind == 2 )
+		return MakeRandomCoverage( rnd.nextInt( 1, 6 ), rnd.nextInt( 20, 40 ), rnd );
+	else
+		return MakeRandomCoverage( rnd.nextInt( 1, 16 ), rnd.nextInt( 1, 16 ), rnd );
+}
+
+// Runs \a numUses uses of random finds, inserts and erases against a small atlas, checking its layout after each and that no glyph used since
+// beginUse() is ever evicted. Returns the number of evictions and failed inserts, so that the caller can tell the atlas was kept under pressure.
+inline bool RunRandomUses( GlyphAtlasInspector *atlas, int numUses, Rand &rnd, size_t *resultNumEvicted, size_t *resultNumFailed )
+{
+	const int numGlyphs = 400;
+	std::map<GlyphAtlas::Glyph, Channel8u> coverages;
+	*resultNumEvicted = *resultNumFailed = 0;
+	for( int use = 0; use < numUses; ++use ) {
+		atlas->beginUse();
+		std::set<GlyphAtlas::Glyph> used;
+		const int numOps = rnd.nextInt( 1, 24 );
+		for( int op = 0; op < numOps; ++op ) {
+			const GlyphAtlas::Glyph glyph = (GlyphAtlas::Glyph)rnd.nextInt( numGlyphs );
+			const int action = rnd.nextInt( 10 );
+			if( action < 4 ) {
+				const GlyphAtlas::Entry *entry = atlas->find( glyph );
+				if( ( entry != NULL ) != ( coverages.count( glyph ) > 0 ) )
+					return false;
+				if( entry )
+					used.insert( glyph );
+			}
+			else if( action < 9 ) {
+				Channel8u coverage = MakeRandomGlyphCoverage( rnd );
+				const GlyphAtlas::Entry *entry = atlas->insert( glyph, coverage, Vec2f( -1, 2 ) );
+				// a failed insert still removes the previous version of the glyph
+				coverages.erase( glyph );
+				used.erase( glyph );
+				if( entry ) {
+					if( entry->mOriginOffset != Vec2f( -1, 2 ) || entry->mArea.getSize() != ( coverage ? coverage.getSize() : Vec2i( 0, 0 ) ) )
+						return false;
+					coverages[glyph] = coverage;
+					used.insert( glyph );
+				}
+				else
+					++*resultNumFailed;
+			}
+			else {
+				atlas->erase( glyph );
+				coverages.erase( glyph );
+				used.erase( glyph );
+			}
+
+			const std::vector<GlyphAtlas::Glyph> evicted = atlas->takeEvicted();
+			for( size_t e = 0; e < evicted.size(); ++e ) {
+				if( used.count( evicted[e] ) || ! coverages.count( evicted[e] ) || atlas->contains( evicted[e] ) )
+					return false;
+				coverages.erase( evicted[e] );
+			}
+			*resultNumEvicted += evicted.size();
+		}
+
+		if( atlas->getNumGlyphs() != coverages.size() || ! atlas->areShelvesValid() || ! atlas->areAllocationsDisjoint() || ! atlas->arePixelsValid( coverages ) )
+			return false;
+		for( auto it = coverages.begin(); it != coverages.end(); ++it ) {
+			if( ! atlas->contains( it->first ) )
+				return false;
+		}
+	}
+	return true;
+}
+
+inline void TestGlyphAtlas( std::ostream& os )
+{
+	Rand rnd( 7069 );
+
+	// GlyphAtlas; random find(), insert() and erase()
+	{
+		// pages small enough that most uses evict something, with and without padding
+		bool result = true;
+		for( int32_t padding = 0; padding <= 2; ++padding ) {
+			GlyphAtlasInspector atlas( 96, 80, 2, padding );
+			size_t numEvicted, numFailed;
+			result = result && RunRandomUses( &atlas, 3000, rnd, &numEvicted, &numFailed ) && ( numEvicted > 1000 ) && ( numFailed > 0 ) && ( atlas.getNumPages() == 2 );
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "GlyphAtlas; random find(), insert() and erase()" << "\n";
+	}
+
+	// GlyphAtlas; merging free spans and shelves
+	{
+		GlyphAtlasInspector atlas( 64, 64, 1, 1 );
+		size_t numEvicted, numFailed;
+		bool result = RunRandomUses( &atlas, 500, rnd, &numEvicted, &numFailed );
+
+		// erasing every glyph, in random order, leaves no shelves behind
+		std::vector<GlyphAtlas::Glyph> glyphs;
+		for( int g = 0; g < 400; ++g ) {
+			if( atlas.contains( (GlyphAtlas::Glyph)g ) )
+				glyphs.push_back( (GlyphAtlas::Glyph)g );
+		}
+		result = result && ! glyphs.empty();
+		for( size_t g = glyphs.size(); g > 1; --g )
+			std::swap( glyphs[g - 1], glyphs[rnd.nextInt( (int32_t)g )] );
+		for( size_t g = 0; g < glyphs.size(); ++g ) {
+			atlas.erase( glyphs[g] );
+			result = result && atlas.areShelvesValid();
+		}
+		result = result && ( atlas.getNumGlyphs() == 0 ) && ( atlas.getNumShelves( 0 ) == 0 );
+
+		// so a glyph as large as the page fits, with no evictions
+		atlas.beginUse();
+		result = result && ( atlas.insert( 0, MakeRandomCoverage( 63, 63, rnd ), Vec2f::zero() ) != NULL ) && atlas.takeEvicted().empty();
+
+		// freeing the middle of a shelf and then its neighbors leaves a single span, which a glyph spanning the three fits
+		GlyphAtlasInspector shelf( 32, 16, 1, 0 );
+		shelf.beginUse();
+		for( GlyphAtlas::Glyph g = 0; g < 4; ++g )
+			shelf.insert( g, MakeRandomCoverage( 8, 8, rnd ), Vec2f::zero() );
+		shelf.erase( 1 );
+		shelf.erase( 0 );
+		shelf.erase( 2 );
+		result = result && shelf.areShelvesValid() && ( shelf.getNumShelves( 0 ) == 1 );
+		const GlyphAtlas::Entry *entry = shelf.insert( 4, MakeRandomCoverage( 24, 8, rnd ), Vec2f::zero() );
+		result = result && entry && ( entry->mArea == Area( 0, 0, 24, 8 ) ) && shelf.areShelvesValid();
+
+		os << (result ? "passed" : "FAILED") << " : " << "GlyphAtlas; merging free spans and shelves" << "\n";
+	}
+
+	// time taken to insert a stream of glyphs into a 512x512 atlas, evicting as it fills
+	os << "   " << "speed test:" << "\n";
+	{
+		const int numInserts = 200000;
+		std::vector<Channel8u> coverages;
+		for( int c = 0; c < 256; ++c )
+			coverages.push_back( MakeRandomCoverage( rnd.nextInt( 4, 24 ), rnd.nextInt( 8, 28 ), rnd ) );
+		GlyphAtlas atlas( 512, 512, 1 );
+		Timer timer;
+		timer.start();
+		for( int i = 0; i < numInserts; ++i ) {
+			if( i % 64 == 0 )
+				atlas.beginUse();
+			const GlyphAtlas::Glyph glyph = (GlyphAtlas::Glyph)rnd.nextInt( 4096 );
+			if( ! atlas.find( glyph ) )
+				atlas.insert( glyph, coverages[glyph % coverages.size()], Vec2f::zero() );
+			atlas.takeEvicted();
+		}
+		timer.stop();
+
+		os << "   " << "   " << numInserts << " lookups of 4096 glyphs: " << atlas.getNumGlyphs() << " resident, " << timer.getSeconds() << " seconds" << "\n";
+	}
+}
@@ -0,0 +1,61 @@
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cinder/Channel.h"
+#include "cinder/GlyphAtlas.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+using namespace ci;
+
+#include "TestGlyphAtlas.h"
+
+static const std::string kPre = "   ";
+
+std::string MakeIndentedBlock( const std::stringstream& src )
+{
+	std::stringstream ss;
+	std::string data = src.str();
+	if( ! data.empty() ) {
+		ss << kPre;
+		for( size_t i = 0; i < data.size(); ++i ) {
+			char c = data[i];
+			ss << c;
+			if( '\n' == c ) {
+				ss << kPre;
+			}
+		}
+	}
+	return ss.str();
+}
+
+void DoTest( const std::string& name, void (*testFunc)(std::ostream&) );
+
+#define DO_TEST( _FUNC_ ) \
+	DoTest( #_FUNC_, &_FUNC_ );
+
+int main( int argc, char **argv )
+{
+	std::cout << std::endl;
+
+	DO_TEST( TestGlyphAtlas );
+
+	std::cout << std::endl;
+
+	return 0;
+}
+
+void DoTest( const std::string& name, void (*testFunc)( std::ostream& os ) )
+{
+	std::cout << "Testing " << name << "\n";
+	std::stringstream ss;
+	testFunc( ss );
+	std::string output = MakeIndentedBlock( ss );
+	if( ! output.empty() ) {
+		std::cout << output << "\n";
+	}
+	std::cout << std::endl;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+// Returns the largest denominator of 1, 2, 4 or 8 at which a region of \a regionSize still covers \a targetSize, found by trying each
+inline int32_t BruteForceTargetDenominator( const Vec2i &regionSize, const Vec2i &targetSize )
+{
+	int32_t result = 1;
+	for( int32_t denominator = 2; denominator <= 8; denominator *= 2 ) {
+		if( ( regionSize.x + denominator - 1 ) / denominator >= targetSize.x && ( regionSize.y + denominator - 1 ) / denominator >= targetSize.y )
+			result = denominator;
+	}
+	return result;
+}
+
+/* Checks \a decoded against the box averages of \a original over \a region, clipped to the image, in blocks of \a denominator. Blocks
+	at the region's right and bottom edges average only the pixels they cover. The average is rounded to nearest as the decoder does it,
+	as a float sum times the reciprocal of the count. */
+template<typename T>
+inline bool MatchesBoxAverages( const SurfaceT<T> &original, const Area &region, int32_t denominator, const SurfaceT<T> &decoded )
+{
+	const Area clipped = region.getClipBy( original.getBounds() );
+	const Vec2i expectedSize( ( clipped.getWidth() + denominator - 1 ) / denominator, ( clipped.getHeight() + denominator - 1 ) / denominator );
+	if( decoded.getSize() != expectedSize || decoded.hasAlpha() != original.hasAlpha() )
+		return false;
+
+	const int32_t numChannels = original.hasAlpha() ? 4 : 3;
+	for( int32_t y = 0; y < expectedSize.y; ++y ) {
+		for( int32_t x = 0; x < expectedSize.x; ++x ) {
+			const Area block = Area( clipped.x1 + x * denominator, clipped.y1 + y * denominator, clipped.x1 + ( x + 1 ) * denominator, clipped.y1 + ( y + 1 ) * denominator ).getClipBy( clipped );
+			float sums[4] = { 0, 0, 0, 0 };
+			for( int32_t by = block.y1; by < block.y2; ++by ) {
+				for( int32_t bx = block.x1; bx < block.x2; ++bx ) {
+					const ColorAT<T> c = original.getPixel( Vec2i( bx, by ) );
+					sums[0] += c.r; sums[1] += c.g; sums[2] += c.b; sums[3] += c.a;
+				}
+			}
+			const float invCount = 1.0f / ( block.getWidth() * block.getHeight() );
+			const ColorAT<T> d = decoded.getPixel( Vec2i( x, y ) );
+			const T channels[4] = { d.r, d.g, d.b, d.a };
+			for( int32_t c = 0; c < numChannels; ++c ) {
+				if( channels[c] != (T)( sums[c] * invCount + 0.5f ) )
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Decodes \a buffer, a PNG of \a original, with \a options, checking it against the box averages for \a denominator
+template<typename T>
+inline bool DecodesToBoxAverages( const SurfaceT<T> &original, const Buffer &buffer, const ImageSource::Options &options, int32_t denominator )
+{
+	return MatchesBoxAverages( original, options.calcRegion( original.getWidth(), original.getHeight() ), denominator, SurfaceT<T>( ImageSourcePng::createRef( DataSourceBuffer::create( buffer ), options ) ) );
+}
+
+inline void TestDecodeOptions( std::ostream& os )
+{
+	Rand rnd( 3307 );
+	// odd sizes, so no denominator divides them
+	Surface8u original8( 61, 37, true );
+	FillGradientNoise( &original8, rnd );
+	const Buffer buffer8 = EncodePng( original8 );
+	Surface16u original16( 61, 37, false );
+	FillGradientNoise( &original16, rnd );
+	const Buffer buffer16 = EncodePng( original16 );
+
+	// Options& region( const Area &area );
+	{
+		// inside, touching the right and bottom edges, extending past every edge, a single pixel, and the whole image
+		const Area regions[] = { Area( 7, 5, 30, 21 ), Area( 40, 20, 61, 37 ), Area( -5, 10, 30, 200 ), Area( -10, -10, 100, 100 ), Area( 60, 36, 61, 37 ), Area( 0, 0, 61, 37 ) };
+		bool result = true;
+		for( size_t r = 0; r < sizeof(regions) / sizeof(regions[0]); ++r ) {
+			const ImageSource::Options options = ImageSource::Options().region( regions[r] );
+			result = result && DecodesToBoxAverages( original8, buffer8, options, 1 ) && DecodesToBoxAverages( original16, buffer16, options, 1 );
+		}
+
+		// a region entirely outside the image can't be decoded
+		bool threw = false;
+		try {
+			Surface8u decoded( ImageSourcePng::createRef( DataSourceBuffer::create( buffer8 ), ImageSource::Options().region( Area( 70, 0, 80, 10 ) ) ) );
+		}
+		catch( ImageIoExceptionFailedLoad & ) {
+			threw = true;
+		}
+		result = result && threw;
+
+		os << (result ? "passed" : "FAILED") << " : " << "Options& region( const Area &area );" << "\n";
+	}
+
+	// Options& scaleDenominator( int32_t denominator );
+	{
+		// denominators between the supported ones round down to one; the image and regions leave partial blocks at the edges
+		const int32_t requested[] = { 1, 2, 3, 4, 5, 8, 100 }, denominators[] = { 1, 2, 2, 4, 4, 8, 8 };
+		const Area regions[] = { Area( 0, 0, 61, 37 ), Area( 3, 2, 58, 35 ), Area( -4, 30, 13, 50 ) };
+		bool result = true;
+		for( size_t s = 0; s < sizeof(requested) / sizeof(requested[0]); ++s ) {
+			for( size_t r = 0; r < sizeof(regions) / sizeof(regions[0]); ++r ) {
+				const ImageSource::Options options = ImageSource::Options().scaleDenominator( requested[s] ).region( regions[r] );
+				result = result && DecodesToBoxAverages( original8, buffer8, options, denominators[s] ) && DecodesToBoxAverages( original16, buffer16, options, denominators[s] );
+			}
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "Options& scaleDenominator( int32_t denominator );" << "\n";
+	}
+
+	// Options& targetSize( const Vec2i &size );
+	{
+		// every target size up to the image's, with and without a region; targetSize() overrides scaleDenominator()
+		bool result = true;
+		const Area regions[] = { Area( 0, 0, 61, 37 ), Area( 5, 3, 50, 37 ) };
+		for( size_t r = 0; r < sizeof(regions) / sizeof(regions[0]) && result; ++r ) {
+			const Vec2i regionSize = regions[r].getSize();
+			for( int32_t ty = 0; ty <= regionSize.y && result; ++ty ) {
+				for( int32_t tx = ( ty == 0 ) ? 1 : 0; tx <= regionSize.x && result; tx += ( tx < 12 ) ? 1 : 5 ) {
+					const ImageSource::Options options = ImageSource::Options().targetSize( Vec2i( tx, ty ) ).scaleDenominator( 8 ).region( regions[r] );
+					const int32_t denominator = BruteForceTargetDenominator( regionSize, Vec2i( tx, ty ) );
+					result = ( options.calcScaleDenominator( regionSize.x, regionSize.y ) == denominator ) && DecodesToBoxAverages( original8, buffer8, options, denominator );
+				}
+			}
+		}
+		// the boundaries for 61 pixels: 8 covers up to 8, 4 up to 16, 2 up to 31
+		const int32_t targets[] = { 8, 9, 16, 17, 31, 32, 61 }, expected[] = { 8, 4, 4, 2, 2, 1, 1 };
+		for( size_t t = 0; t < sizeof(targets) / sizeof(targets[0]); ++t )
+			result = result && ( ImageSource::Options().targetSize( Vec2i( targets[t], 0 ) ).calcScaleDenominator( 61, 37 ) == expected[t] );
+
+		os << (result ? "passed" : "FAILED") << " : " << "Options& targetSize( const Vec2i &size );" << "\n";
+	}
+}
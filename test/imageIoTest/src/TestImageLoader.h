@@ -0,0 +1,242 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+/* An in-memory PNG whose stream can be held back, so a test decides when each of the ImageLoader's workers proceeds. createStream()
+	records its id in the order the sources are opened, then blocks until release(). */
+class DataSourceBlocking : public DataSource {
+  public:
+	static std::shared_ptr<DataSourceBlocking>	create( const Buffer &buffer, int id, bool blocked ) { return std::shared_ptr<DataSourceBlocking>( new DataSourceBlocking( buffer, id, blocked ) ); }
+
+	virtual bool	isFilePath() { return false; }
+	virtual bool	isUrl() { return false; }
+
+	virtual IStreamRef	createStream()
+	{
+		std::unique_lock<std::mutex> lock( mutex() );
+		opened().push_back( mId );
+		condition().notify_all();
+		while( mBlocked )
+			condition().wait( lock );
+		return IStreamMem::create( mBuffer.getData(), mBuffer.getDataSize() );
+	}
+
+	//! Lets createStream() return, now or when it is called
+	void release()
+	{
+		std::lock_guard<std::mutex> lock( mutex() );
+		mBlocked = false;
+		condition().notify_all();
+	}
+
+	//! Returns whether this source has been opened, waiting up to 10 seconds for it
+	bool waitUntilOpened() const
+	{
+		std::unique_lock<std::mutex> lock( mutex() );
+		return condition().wait_for( lock, std::chrono::seconds( 10 ), [this] { return std::find( opened().begin(), opened().end(), mId ) != opened().end(); } );
+	}
+
+	//! Returns the ids of the sources opened so far, in order
+	static std::vector<int> getOpened()
+	{
+		std::lock_guard<std::mutex> lock( mutex() );
+		return opened();
+	}
+
+	static void clearOpened()
+	{
+		std::lock_guard<std::mutex> lock( mutex() );
+		opened().clear();
+	}
+
+  protected:
+	DataSourceBlocking( const Buffer &buffer, int id, bool blocked )
+		: DataSource( "", Url() ), mId( id ), mBlocked( blocked )
+	{
+		mBuffer = buffer;
+	}
+
+	virtual void	createBuffer() {}
+
+	static std::mutex&					mutex() { static std::mutex sMutex; return sMutex; }
+	static std::condition_variable&		condition() { static std::condition_variable sCondition; return sCondition; }
+	static std::vector<int>&			opened() { static std::vector<int> sOpened; return sOpened; }
+
+	int		mId;
+	bool	mBlocked;
+};
+
+// Records the ids of the requests whose completions were delivered, in order, and whether each Surface was decoded at \a size
+struct LoadRecorder {
+	LoadRecorder( const Vec2i &size ) : mSize( size ), mAllDecoded( true ) {}
+
+	ImageLoader::CompletionFn completion( int id )
+	{
+		return [this, id] ( const Surface8u &surface ) {
+			mDelivered.push_back( id );
+			mAllDecoded = mAllDecoded && surface && ( surface.getSize() == mSize );
+		};
+	}
+
+	//! Calls \a loader's update() until \a numDelivered completions have been delivered in all, giving up after 10 seconds
+	bool updateUntil( ImageLoader &loader, size_t numDelivered )
+	{
+		for( int tries = 0; tries < 10000 && mDelivered.size() < numDelivered; ++tries ) {
+			loader.update();
+			if( mDelivered.size() < numDelivered )
+				std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+		}
+		return mDelivered.size() == numDelivered;
+	}
+
+	Vec2i				mSize;
+	std::vector<int>	mDelivered;
+	bool				mAllDecoded;
+};
+
+inline void TestImageLoader( std::ostream& os )
+{
+	Rand rnd( 4409 );
+	Surface8u original( 16, 12, false );
+	FillGradientNoise( &original, rnd );
+	const Buffer buffer = EncodePng( original );
+	const size_t imageBytes = 16 * 12 * 3;
+	const std::string extension = "png";
+
+	// CancelTokenRef load( const DataSourceRef &dataSource, const CompletionFn &completionFn, int priority, ... );
+	{
+		// a single worker, held on the first request while the rest are queued, then takes them highest priority first and equal
+		// priorities in the order they were made
+		ImageLoaderRef loader = ImageLoader::create( ImageLoader::Format().numThreads( 1 ) );
+		LoadRecorder recorder( original.getSize() );
+		DataSourceBlocking::clearOpened();
+		std::shared_ptr<DataSourceBlocking> first = DataSourceBlocking::create( buffer, 0, true );
+		loader->load( first, recorder.completion( 0 ), 0, ImageLoader::CancelTokenRef(), extension );
+		bool result = first->waitUntilOpened();
+		const int priorities[] = { 0, 5, -1, 5, 2, 0 };
+		for( int r = 0; r < 6; ++r )
+			loader->load( DataSourceBlocking::create( buffer, r + 1, false ), recorder.completion( r + 1 ), priorities[r], ImageLoader::CancelTokenRef(), extension );
+		result = result && ( loader->getNumQueued() == 6 );
+		first->release();
+		result = result && recorder.updateUntil( *loader, 7 );
+
+		const int expected[] = { 0, 2, 4, 5, 1, 6, 3 };
+		result = result && ( DataSourceBlocking::getOpened() == std::vector<int>( expected, expected + 7 ) ) && ( recorder.mDelivered == DataSourceBlocking::getOpened() )
+					&& recorder.mAllDecoded && ( loader->getNumQueued() == 0 ) && ( loader->getBytesInFlight() == 0 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "CancelTokenRef load( const DataSourceRef &dataSource, const CompletionFn &completionFn, int priority, ... );" << "\n";
+	}
+
+	// void CancelToken::cancel(); before decoding
+	{
+		// cancelled while queued, a request is never opened; a token shared by several requests cancels them all, and cancelAll()
+		// drops whatever is still queued
+		ImageLoaderRef loader = ImageLoader::create( ImageLoader::Format().numThreads( 1 ) );
+		LoadRecorder recorder( original.getSize() );
+		DataSourceBlocking::clearOpened();
+		std::shared_ptr<DataSourceBlocking> first = DataSourceBlocking::create( buffer, 0, true );
+		loader->load( first, recorder.completion( 0 ), 10, ImageLoader::CancelTokenRef(), extension );
+		bool result = first->waitUntilOpened();
+		ImageLoader::CancelTokenRef single = loader->load( DataSourceBlocking::create( buffer, 1, false ), recorder.completion( 1 ), 0, ImageLoader::CancelTokenRef(), extension );
+		ImageLoader::CancelTokenRef shared( new ImageLoader::CancelToken );
+		result = result && ( loader->load( DataSourceBlocking::create( buffer, 2, false ), recorder.completion( 2 ), 0, shared, extension ) == shared );
+		loader->load( DataSourceBlocking::create( buffer, 3, false ), recorder.completion( 3 ), 0, ImageLoader::CancelTokenRef(), extension );
+		loader->load( DataSourceBlocking::create( buffer, 4, false ), recorder.completion( 4 ), 0, shared, extension );
+		single->cancel();
+		shared->cancel();
+		first->release();
+		result = result && recorder.updateUntil( *loader, 2 );
+		const int expected[] = { 0, 3 };
+		result = result && ( DataSourceBlocking::getOpened() == std::vector<int>( expected, expected + 2 ) ) && ( recorder.mDelivered == DataSourceBlocking::getOpened() );
+
+		std::shared_ptr<DataSourceBlocking> held = DataSourceBlocking::create( buffer, 5, true );
+		loader->load( held, recorder.completion( 5 ), 10, ImageLoader::CancelTokenRef(), extension );
+		result = result && held->waitUntilOpened();
+		loader->load( DataSourceBlocking::create( buffer, 6, false ), recorder.completion( 6 ), 0, ImageLoader::CancelTokenRef(), extension );
+		loader->cancelAll();
+		result = result && ( loader->getNumQueued() == 0 );
+		// a request made after cancelAll() is unaffected by it
+		std::shared_ptr<DataSourceBlocking> last = DataSourceBlocking::create( buffer, 7, false );
+		loader->load( last, recorder.completion( 7 ), 0, ImageLoader::CancelTokenRef(), extension );
+		held->release();
+		result = result && recorder.updateUntil( *loader, 3 );
+		const int expectedAll[] = { 0, 3, 5, 7 }, expectedDelivered[] = { 0, 3, 7 };
+		result = result && ( DataSourceBlocking::getOpened() == std::vector<int>( expectedAll, expectedAll + 4 ) )
+					&& ( recorder.mDelivered == std::vector<int>( expectedDelivered, expectedDelivered + 3 ) ) && recorder.mAllDecoded && ( loader->getBytesInFlight() == 0 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void CancelToken::cancel(); before decoding" << "\n";
+	}
+
+	// void CancelToken::cancel(); while decoding
+	{
+		// cancelled once a worker has opened it, a request still decodes, but its completion is discarded and its bytes returned
+		ImageLoaderRef loader = ImageLoader::create( ImageLoader::Format().numThreads( 2 ) );
+		LoadRecorder recorder( original.getSize() );
+		DataSourceBlocking::clearOpened();
+		std::shared_ptr<DataSourceBlocking> cancelled = DataSourceBlocking::create( buffer, 0, true ), kept = DataSourceBlocking::create( buffer, 1, true );
+		ImageLoader::CancelTokenRef token = loader->load( cancelled, recorder.completion( 0 ), 0, ImageLoader::CancelTokenRef(), extension );
+		loader->load( kept, recorder.completion( 1 ), 0, ImageLoader::CancelTokenRef(), extension );
+		bool result = cancelled->waitUntilOpened() && kept->waitUntilOpened();
+		token->cancel();
+		cancelled->release();
+		kept->release();
+		result = result && recorder.updateUntil( *loader, 1 );
+		// the cancelled decode may finish after the kept one; it's discarded by the update() which finds it
+		for( int tries = 0; tries < 10000 && loader->getBytesInFlight() != 0; ++tries ) {
+			std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+			loader->update();
+		}
+		result = result && ( recorder.mDelivered == std::vector<int>( 1, 1 ) ) && recorder.mAllDecoded && ( loader->getBytesInFlight() == 0 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void CancelToken::cancel(); while decoding" << "\n";
+	}
+
+	// Format& maxBytesInFlight( size_t maxBytes );
+	{
+		// room for one image: the second worker reads its header, then waits until the first image is delivered
+		PixelAllocatorPoolRef pool = PixelAllocatorPool::create();
+		ImageLoaderRef loader = ImageLoader::create( ImageLoader::Format().numThreads( 2 ).maxBytesInFlight( imageBytes + imageBytes / 2 ).allocator( pool ) );
+		LoadRecorder recorder( original.getSize() );
+		DataSourceBlocking::clearOpened();
+		std::shared_ptr<DataSourceBlocking> first = DataSourceBlocking::create( buffer, 0, false ), second = DataSourceBlocking::create( buffer, 1, true );
+		loader->load( first, recorder.completion( 0 ), 1, ImageLoader::CancelTokenRef(), extension );
+		loader->load( second, recorder.completion( 1 ), 0, ImageLoader::CancelTokenRef(), extension );
+		bool result = second->waitUntilOpened();
+		// nothing is delivered until update(), so the first image's bytes stay in flight however long the second waits
+		for( int tries = 0; tries < 10000 && loader->getBytesInFlight() == 0; ++tries )
+			std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+		second->release();
+		std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+		result = result && ( loader->getBytesInFlight() == imageBytes );
+		result = result && ( loader->update( 1 ) == 1 ) && ( recorder.mDelivered == std::vector<int>( 1, 0 ) );
+		result = result && recorder.updateUntil( *loader, 2 ) && ( loader->getBytesInFlight() == 0 );
+		const size_t allocationsPerImage = pool->getNumAllocations() / 2;
+
+		// while waiting for room, a cancelled request gives up without decoding
+		std::shared_ptr<DataSourceBlocking> third = DataSourceBlocking::create( buffer, 2, false ), fourth = DataSourceBlocking::create( buffer, 3, false );
+		loader->load( third, recorder.completion( 2 ), 1, ImageLoader::CancelTokenRef(), extension );
+		result = result && third->waitUntilOpened();
+		for( int tries = 0; tries < 10000 && loader->getBytesInFlight() == 0; ++tries )
+			std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+		ImageLoader::CancelTokenRef token = loader->load( fourth, recorder.completion( 3 ), 0, ImageLoader::CancelTokenRef(), extension );
+		result = result && fourth->waitUntilOpened();
+		token->cancel();
+		std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) ); // longer than the wait's 50ms poll for cancellation
+		result = result && ( loader->getBytesInFlight() == imageBytes ) && recorder.updateUntil( *loader, 3 );
+		std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+		loader->update();
+		const int expected[] = { 0, 1, 2 };
+		result = result && ( loader->getBytesInFlight() == 0 ) && ( pool->getNumAllocations() == 3 * allocationsPerImage )
+					&& ( recorder.mDelivered == std::vector<int>( expected, expected + 3 ) ) && recorder.mAllDecoded;
+
+		// an image larger than the whole budget is still decoded, once nothing else is in flight
+		ImageLoaderRef smallLoader = ImageLoader::create( ImageLoader::Format().numThreads( 2 ).maxBytesInFlight( imageBytes / 2 ) );
+		LoadRecorder smallRecorder( original.getSize() );
+		for( int r = 0; r < 3; ++r )
+			smallLoader->load( DataSourceBlocking::create( buffer, 10 + r, false ), smallRecorder.completion( r ), 0, ImageLoader::CancelTokenRef(), extension );
+		result = result && smallRecorder.updateUntil( *smallLoader, 3 ) && smallRecorder.mAllDecoded && ( smallLoader->getBytesInFlight() == 0 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "Format& maxBytesInFlight( size_t maxBytes );" << "\n";
+	}
+}
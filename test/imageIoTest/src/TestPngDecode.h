@@ -0,0 +1,135 @@
+#pragma once
+
+// Orders channels as BGR or BGRA, which ImageSourcePng reaches through png_set_bgr() rather than a row function
+class SurfaceConstraintsBgr : public SurfaceConstraints {
+ public:
+	virtual SurfaceChannelOrder getChannelOrder( bool alpha ) const { return ( alpha ) ? SurfaceChannelOrder::BGRA : SurfaceChannelOrder::BGR; }
+};
+
+// Fills \a surface with gradients plus some noise, so that it compresses about as well as a photograph
+template<typename T>
+inline void FillGradientNoise( SurfaceT<T> *surface, Rand &rnd )
+{
+	const int32_t numChannels = surface->hasAlpha() ? 4 : 3;
+	const float noise = CHANTRAIT<T>::max() / 32.0f;
+	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
+		T *p = surface->getData( Vec2i( 0, y ) );
+		for( int32_t x = 0; x < surface->getWidth(); ++x, p += surface->getPixelInc() ) {
+			for( int32_t c = 0; c < numChannels; ++c ) {
+				float v = ( x + y * ( c + 1 ) ) / (float)( surface->getWidth() + surface->getHeight() * 4 ) * ( CHANTRAIT<T>::max() - noise ) + rnd.nextFloat( noise );
+				p[c] = (T)v;
+			}
+		}
+	}
+}
+
+// Encodes \a imageSource as a PNG in memory
+inline Buffer EncodePng( const ImageSourceRef &imageSource, const ImageTarget::Options &options = ImageTarget::Options() )
+{
+	OStreamMemRef stream = OStreamMem::create();
+	writeImage( ImageTargetPng::createRef( DataTargetStream::createRef( stream ), imageSource, options, "png" ), imageSource );
+	Buffer result( (size_t)stream->tell() );
+	memcpy( result.getData(), stream->getBuffer(), result.getDataSize() );
+	return result;
+}
+
+inline ImageSourceRef DecodePng( const Buffer &buffer )
+{
+	return ImageSourcePng::createRef( DataSourceBuffer::create( buffer ) );
+}
+
+// Checks that every channel of \a decoded is the same channel of \a original, converted with CHANTRAIT<U>::convert()
+template<typename T, typename U>
+inline bool MatchesConverted( const SurfaceT<T> &original, const SurfaceT<U> &decoded )
+{
+	if( decoded.getSize() != original.getSize() || decoded.hasAlpha() != original.hasAlpha() )
+		return false;
+	for( int32_t y = 0; y < original.getHeight(); ++y ) {
+		for( int32_t x = 0; x < original.getWidth(); ++x ) {
+			const ColorAT<T> a = original.getPixel( Vec2i( x, y ) );
+			const ColorAT<U> b = decoded.getPixel( Vec2i( x, y ) );
+			if( b.r != CHANTRAIT<U>::convert( a.r ) || b.g != CHANTRAIT<U>::convert( a.g ) || b.b != CHANTRAIT<U>::convert( a.b ) || b.a != CHANTRAIT<U>::convert( a.a ) )
+				return false;
+		}
+	}
+	return true;
+}
+
+// Decodes \a buffer into each Surface type and layout, checking each against \a original
+template<typename T>
+inline bool DecodesToAllTargets( const SurfaceT<T> &original, const Buffer &buffer )
+{
+	return MatchesConverted( original, Surface8u( DecodePng( buffer ) ) )
+		&& MatchesConverted( original, Surface8u( DecodePng( buffer ), SurfaceConstraintsBgr() ) )
+		&& MatchesConverted( original, Surface16u( DecodePng( buffer ) ) )
+		&& MatchesConverted( original, Surface16u( DecodePng( buffer ), SurfaceConstraintsBgr() ) )
+		&& MatchesConverted( original, Surface32f( DecodePng( buffer ) ) );
+}
+
+inline void TestPngDecode( std::ostream& os )
+{
+	Rand rnd( 2053 );
+
+	// ImageSourcePng; 8-bit
+	{
+		bool result = true;
+		for( int alpha = 0; alpha < 2; ++alpha ) {
+			Surface8u original( 61, 37, alpha != 0 );
+			FillGradientNoise( &original, rnd );
+			result = result && DecodesToAllTargets( original, EncodePng( original ) );
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "ImageSourcePng; 8-bit" << "\n";
+	}
+
+	// ImageSourcePng; 16-bit
+	{
+		bool result = true;
+		for( int alpha = 0; alpha < 2; ++alpha ) {
+			Surface16u original( 61, 37, alpha != 0 );
+			FillGradientNoise( &original, rnd );
+			result = result && DecodesToAllTargets( original, EncodePng( original ) );
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "ImageSourcePng; 16-bit" << "\n";
+	}
+
+	// decode throughput for a 2048x2048 image, into a Surface matching the file's depth and into the other depth
+	os << "   " << "speed test:" << "\n";
+	{
+		const int32_t size = 2048;
+		const int numIterations = 5;
+		for( int depth = 8; depth <= 16; depth += 8 ) {
+			for( int alpha = 0; alpha < 2; ++alpha ) {
+				Buffer buffer;
+				if( depth == 8 ) {
+					Surface8u original( size, size, alpha != 0 );
+					FillGradientNoise( &original, rnd );
+					buffer = EncodePng( original );
+				}
+				else {
+					Surface16u original( size, size, alpha != 0 );
+					FillGradientNoise( &original, rnd );
+					buffer = EncodePng( original );
+				}
+
+				for( int target = 8; target <= 16; target += 8 ) {
+					Timer timer;
+					timer.start();
+					for( int i = 0; i < numIterations; ++i ) {
+						if( target == 8 )
+							Surface8u decoded( DecodePng( buffer ) );
+						else
+							Surface16u decoded( DecodePng( buffer ) );
+					}
+					timer.stop();
+
+					const double seconds = timer.getSeconds() / numIterations;
+					const double megapixels = size * size / 1000000.0;
+					os << "   " << "   " << depth << "-bit " << ( alpha ? "RGBA" : "RGB" ) << " (" << buffer.getDataSize() / 1024 << " KB) into Surface" << target << "u: "
+						<< seconds * 1000 << " ms, " << megapixels / seconds << " megapixels per second" << "\n";
+				}
+			}
+		}
+	}
+}
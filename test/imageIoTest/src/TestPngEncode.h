@@ -0,0 +1,91 @@
+#pragma once
+
+// Returns the number of IDAT chunks in \a png, which ImageTargetPng writes one per band, or 0 if its chunks don't run to an IEND
+inline size_t CountIdatChunks( const Buffer &png )
+{
+	const uint8_t *data = static_cast<const uint8_t*>( png.getData() );
+	const size_t size = png.getDataSize();
+	size_t numIdat = 0;
+	for( size_t pos = 8; pos + 12 <= size; ) {
+		const size_t length = ( (size_t)data[pos] << 24 ) | ( data[pos + 1] << 16 ) | ( data[pos + 2] << 8 ) | data[pos + 3];
+		const std::string type( reinterpret_cast<const char*>( data + pos + 4 ), 4 );
+		if( type == "IDAT" )
+			++numIdat;
+		else if( type == "IEND" )
+			return ( pos + 12 == size ) ? numIdat : 0;
+		pos += 12 + length;
+	}
+	return 0;
+}
+
+inline bool IsSameBuffer( const Buffer &a, const Buffer &b )
+{
+	return a.getDataSize() == b.getDataSize() && memcmp( a.getData(), b.getData(), a.getDataSize() ) == 0;
+}
+
+inline bool MatchesChannel( const Channel8u &original, const Channel8u &decoded )
+{
+	if( decoded.getSize() != original.getSize() )
+		return false;
+	for( int32_t y = 0; y < original.getHeight(); ++y ) {
+		for( int32_t x = 0; x < original.getWidth(); ++x ) {
+			if( decoded.getValue( Vec2i( x, y ) ) != original.getValue( Vec2i( x, y ) ) )
+				return false;
+		}
+	}
+	return true;
+}
+
+inline void TestPngEncode( std::ostream& os )
+{
+	Rand rnd( 6151 );
+	// each is several bands high: 8-bit RGBA, 16-bit RGB and 8-bit gray
+	Surface8u original8( 301, 700, true );
+	FillGradientNoise( &original8, rnd );
+	Surface16u original16( 257, 300, false );
+	FillGradientNoise( &original16, rnd );
+	Channel8u originalGray( 600, 1100 );
+	for( int32_t y = 0; y < originalGray.getHeight(); ++y ) {
+		for( int32_t x = 0; x < originalGray.getWidth(); ++x )
+			originalGray.setValue( Vec2i( x, y ), uint8_t( ( x + y ) / 7 + rnd.nextInt( 8 ) ) );
+	}
+	const ImageSourceRef sources[] = { original8, original16, originalGray };
+
+	// Options& numThreads( size_t numThreads );
+	{
+		// the bands and their dictionaries don't depend on the threads encoding them, so neither does the file
+		const ImageTarget::Options::Filter filters[] = { ImageTarget::Options::FILTER_ADAPTIVE, ImageTarget::Options::FILTER_PAETH };
+		const int levels[] = { -1, 9 };
+		const size_t numThreads[] = { 2, 3, 4, 7, 16, 0 };
+		bool result = true;
+		for( size_t s = 0; s < sizeof(sources) / sizeof(sources[0]); ++s ) {
+			for( int f = 0; f < 2; ++f ) {
+				const ImageTarget::Options options = ImageTarget::Options().filter( filters[f] ).compressionLevel( levels[f] );
+				const Buffer single = EncodePng( sources[s], ImageTarget::Options( options ).numThreads( 1 ) );
+				result = result && ( CountIdatChunks( single ) > 1 );
+				for( size_t t = 0; t < sizeof(numThreads) / sizeof(numThreads[0]); ++t )
+					result = result && IsSameBuffer( single, EncodePng( sources[s], ImageTarget::Options( options ).numThreads( numThreads[t] ) ) );
+			}
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "Options& numThreads( size_t numThreads );" << "\n";
+	}
+
+	// Options& filter( Filter filter ); Options& compressionLevel( int level );
+	{
+		// every filter at every level round-trips through libpng, across several bands
+		const int levels[] = { 0, 1, 5, 6, 9, -1 };
+		bool result = true;
+		for( int f = ImageTarget::Options::FILTER_NONE; f <= ImageTarget::Options::FILTER_ADAPTIVE; ++f ) {
+			for( size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); ++l ) {
+				const ImageTarget::Options options = ImageTarget::Options().filter( ImageTarget::Options::Filter( f ) ).compressionLevel( levels[l] ).numThreads( 4 );
+				const Buffer buffer8 = EncodePng( original8, options ), buffer16 = EncodePng( original16, options ), bufferGray = EncodePng( originalGray, options );
+				result = result && ( CountIdatChunks( buffer8 ) > 1 ) && ( CountIdatChunks( buffer16 ) > 1 ) && ( CountIdatChunks( bufferGray ) > 1 )
+							&& MatchesConverted( original8, Surface8u( DecodePng( buffer8 ) ) ) && MatchesConverted( original16, Surface16u( DecodePng( buffer16 ) ) )
+							&& MatchesChannel( originalGray, Channel8u( DecodePng( bufferGray ) ) );
+			}
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "Options& filter( Filter filter ); Options& compressionLevel( int level );" << "\n";
+	}
+}
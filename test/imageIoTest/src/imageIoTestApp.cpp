@@ -0,0 +1,71 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cinder/Buffer.h"
+#include "cinder/DataSource.h"
+#include "cinder/DataTarget.h"
+#include "cinder/ImageLoader.h"
+#include "cinder/ImageSourcePng.h"
+#include "cinder/ImageTargetPng.h"
+#include "cinder/Rand.h"
+#include "cinder/Stream.h"
+#include "cinder/Surface.h"
+#include "cinder/Timer.h"
+using namespace ci;
+
+#include "TestPngDecode.h"
+#include "TestPngEncode.h"
+#include "TestDecodeOptions.h"
+#include "TestImageLoader.h"
+
+static const std::string kPre = "   ";
+
+std::string MakeIndentedBlock( const std::stringstream& src )
+{
+	std::stringstream ss;
+	std::string data = src.str();
+	if( ! data.empty() ) {
+		ss << kPre;
+		for( size_t i = 0; i < data.size(); ++i ) {
+			char c = data[i];
+			ss << c;
+			if( '\n' == c ) {
+				ss << kPre;
+			}
+		}
+	}
+	return ss.str();
+}
+
+void DoTest( const std::string& name, void (*testFunc)(std::ostream&) );
+
+#define DO_TEST( _FUNC_ ) \
+	DoTest( #_FUNC_, &_FUNC_ );
+
+int main( int argc, char **argv )
+{
+	std::cout << std::endl;
+
+	DO_TEST( TestPngDecode );
+	DO_TEST( TestPngEncode );
+	DO_TEST( TestDecodeOptions );
+	DO_TEST( TestImageLoader );
+
+	std::cout << std::endl;
+
+	return 0;
+}
+
+void DoTest( const std::string& name, void (*testFunc)( std::ostream& os ) )
+{
+	std::cout << "Testing " << name << "\n";
+	std::stringstream ss;
+	testFunc( ss );
+	std::string output = MakeIndentedBlock( ss );
+	if( ! output.empty() ) {
+		std::cout << output << "\n";
+	}
+	std::cout << std::endl;
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+// Returns the float \a ulps representable values above the non-negative \a v, or below it for negative \a ulps, stopping at 0
+inline float StepUlps( float v, int32_t ulps )
+{
+	int32_t bits;
+	memcpy( &bits, &v, sizeof(bits) );
+	bits = std::max<int32_t>( 0, bits + ulps );
+	memcpy( &v, &bits, sizeof(v) );
+	return v;
+}
+
+// The 8-bit encoding linearToSrgb( const float*, uint8_t*, size_t ) must match: linearToSrgb( float ), rounded to nearest
+inline uint8_t EncodeSrgb8( float v )
+{
+	return static_cast<uint8_t>( ip::linearToSrgb( v ) * 255 + 0.5f );
+}
+
+// Clamps \a v to [0,1] and rounds it to the nearest value of T, as the in-place Surface conversions store their results
+template<typename T>
+inline T FromFloat( float v )
+{
+	return ( CHANTRAIT<T>::max() == 1 ) ? (T)v : (T)( std::min( std::max( v, 0.0f ), 1.0f ) * CHANTRAIT<T>::max() + 0.5f );
+}
+
+// Returns a copy of \a surface with \a fn applied to the red, green and blue of every pixel
+template<typename T, typename FN>
+inline SurfaceT<T> ApplyToColorElements( const SurfaceT<T> &surface, const FN &fn )
+{
+	SurfaceT<T> result = surface.clone();
+	for( int32_t y = 0; y < result.getHeight(); ++y ) {
+		T *p = result.getData( Vec2i( 0, y ) );
+		for( int32_t x = 0; x < result.getWidth(); ++x, p += result.getPixelInc() ) {
+			p[result.getRedOffset()] = fn( p[result.getRedOffset()] );
+			p[result.getGreenOffset()] = fn( p[result.getGreenOffset()] );
+			p[result.getBlueOffset()] = fn( p[result.getBlueOffset()] );
+		}
+	}
+	return result;
+}
+
+// Returns a copy of \a surface with each pixel's color passed through \a fn as a Colorf and stored back in its red, green and blue
+template<typename T, typename FN>
+inline SurfaceT<T> ApplyToColors( const SurfaceT<T> &surface, const FN &fn )
+{
+	SurfaceT<T> result = surface.clone();
+	for( int32_t y = 0; y < result.getHeight(); ++y ) {
+		T *p = result.getData( Vec2i( 0, y ) );
+		for( int32_t x = 0; x < result.getWidth(); ++x, p += result.getPixelInc() ) {
+			const Vec3f v = fn( Vec3f( CHANTRAIT<float>::convert( p[result.getRedOffset()] ), CHANTRAIT<float>::convert( p[result.getGreenOffset()] ), CHANTRAIT<float>::convert( p[result.getBlueOffset()] ) ) );
+			p[result.getRedOffset()] = FromFloat<T>( v.x );
+			p[result.getGreenOffset()] = FromFloat<T>( v.y );
+			p[result.getBlueOffset()] = FromFloat<T>( v.z );
+		}
+	}
+	return result;
+}
+
+// Random values across the range of T, with runs of grays and of repeated elements so rgbToHsv() meets zero ranges and ties
+template<typename T>
+inline void FillRandomColors( SurfaceT<T> *surface, Rand &rnd )
+{
+	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
+		T *p = surface->getData( Vec2i( 0, y ) );
+		for( int32_t x = 0; x < surface->getWidth(); ++x, p += surface->getPixelInc() ) {
+			for( int e = 0; e < surface->getPixelInc(); ++e )
+				p[e] = ( CHANTRAIT<T>::max() == 1 ) ? (T)rnd.nextFloat() : (T)rnd.nextInt( (int32_t)CHANTRAIT<T>::max() + 1 );
+			if( x % 5 == 0 )
+				p[surface->getGreenOffset()] = p[surface->getBlueOffset()] = p[surface->getRedOffset()];
+			else if( x % 5 == 1 )
+				p[surface->getGreenOffset()] = p[surface->getRedOffset()];
+		}
+	}
+}
+
+// Checks the in-place Surface conversions of every channel order against the scalar functions, leaving alpha and padding alone
+template<typename T>
+inline bool MatchesScalarColorConvert( Rand &rnd )
+{
+	const std::vector<SurfaceChannelOrder> orders = AllChannelOrders();
+	for( size_t o = 0; o < orders.size(); ++o ) {
+		SurfaceT<T> original( 37, 11, orders[o].hasAlpha(), orders[o] );
+		FillRandomColors( &original, rnd );
+
+		SurfaceT<T> decoded = original.clone(), encoded = original.clone(), hsv = original.clone(), rgb = original.clone();
+		ip::srgbToLinear( &decoded );
+		ip::linearToSrgb( &encoded );
+		ip::rgbToHsv( &hsv );
+		ip::hsvToRgb( &rgb );
+		if( ! AreBitwiseEqual( decoded, ApplyToColorElements( original, []( T v ) { return FromFloat<T>( ip::srgbToLinear( CHANTRAIT<float>::convert( v ) ) ); } ) )
+			|| ! AreBitwiseEqual( encoded, ApplyToColorElements( original, []( T v ) { return FromFloat<T>( ip::linearToSrgb( CHANTRAIT<float>::convert( v ) ) ); } ) )
+			|| ! AreBitwiseEqual( hsv, ApplyToColors( original, []( const Vec3f &c ) { return rgbToHSV( Colorf( c.x, c.y, c.z ) ); } ) )
+			|| ! AreBitwiseEqual( rgb, ApplyToColors( original, []( const Vec3f &c ) { const Colorf result = hsvToRGB( c ); return Vec3f( result.r, result.g, result.b ); } ) ) )
+			return false;
+	}
+	return true;
+}
+
+// Colors for rgbToHsv(): random, gray, black, white, the primaries and secondaries, and ties for the largest element
+inline Colorf RandomHsvTestColor( Rand &rnd )
+{
+	const float v = rnd.nextFloat(), w = rnd.nextFloat();
+	switch( rnd.nextInt( 8 ) ) {
+		case 0: return Colorf( v, v, v );
+		case 1: return Colorf( (float)rnd.nextInt( 2 ), (float)rnd.nextInt( 2 ), (float)rnd.nextInt( 2 ) );
+		case 2: return Colorf( v, v, w );
+		case 3: return Colorf( w, v, v );
+		case 4: return Colorf( v, w, v );
+		case 5: return Colorf( rnd.nextInt( 256 ) / 255.0f, rnd.nextInt( 256 ) / 255.0f, rnd.nextInt( 256 ) / 255.0f );
+		default: return Colorf( v, w, rnd.nextFloat() );
+	}
+}
+
+// Triples for hsvToRgb(): random, a hue of exactly 1, the sextant boundaries, and no saturation
+inline Vec3f RandomHsvTestTriple( Rand &rnd )
+{
+	switch( rnd.nextInt( 5 ) ) {
+		case 0: return Vec3f( 1, rnd.nextFloat(), rnd.nextFloat() );
+		case 1: return Vec3f( rnd.nextInt( 7 ) / 6.0f, rnd.nextFloat(), rnd.nextFloat() );
+		case 2: return Vec3f( rnd.nextFloat(), 0, rnd.nextFloat() );
+		default: return Vec3f( rnd.nextFloat(), rnd.nextFloat(), rnd.nextFloat() );
+	}
+}
+
+inline void TestColorConvert( std::ostream& os )
+{
+	Rand rnd( 5119 );
+
+	// float srgbToLinear( float v ); float linearToSrgb( float v );
+	{
+		// the pow() formulas, against the same in double precision, with the clamp on encoding and the round trip of every 8-bit value
+		bool result = ( ip::srgbToLinear( 0.0f ) == 0 ) && ( ip::srgbToLinear( 1.0f ) == 1 ) && ( ip::linearToSrgb( 0.0f ) == 0 )
+					&& ( ip::linearToSrgb( -1.0f ) == 0 ) && ( ip::linearToSrgb( 2.0f ) == ip::linearToSrgb( 1.0f ) );
+		for( int i = 0; i <= 1000; ++i ) {
+			const double v = i / 1000.0;
+			const double decoded = ( v <= 0.04045 ) ? ( v / 12.92 ) : std::pow( ( v + 0.055 ) / 1.055, 2.4 );
+			const double encoded = ( v <= 0.0031308 ) ? ( v * 12.92 ) : ( 1.055 * std::pow( v, 1 / 2.4 ) - 0.055 );
+			result = result && ( std::abs( ip::srgbToLinear( (float)v ) - decoded ) < 1e-6 ) && ( std::abs( ip::linearToSrgb( (float)v ) - encoded ) < 1e-6 );
+		}
+		for( int k = 0; k < 256; ++k )
+			result = result && ( std::abs( ip::linearToSrgb( ip::srgbToLinear( k / 255.0f ) ) - k / 255.0f ) < 1e-5f );
+
+		os << (result ? "passed" : "FAILED") << " : " << "float srgbToLinear( float v ); float linearToSrgb( float v );" << "\n";
+	}
+
+	// void linearToSrgb( const float *src, uint8_t *dst, size_t count );
+	{
+		// the table must round exactly as linearToSrgb( float ) does: a few ulps either side of each rounding threshold, found here by bisection,
+		// a sweep across [0,1], and values outside it
+		std::vector<float> values;
+		for( int k = 1; k < 256; ++k ) {
+			float lo = 0, hi = 1;
+			while( StepUlps( lo, 1 ) < hi ) {
+				const float mid = lo + ( hi - lo ) / 2;
+				if( mid <= lo || mid >= hi )
+					break;
+				( EncodeSrgb8( mid ) >= k ? hi : lo ) = mid;
+			}
+			for( int32_t ulps = -8; ulps <= 8; ++ulps )
+				values.push_back( StepUlps( hi, ulps ) );
+		}
+		for( float v = 0; v < 1; v = StepUlps( v, 4099 ) )
+			values.push_back( v );
+		const float outside[] = { -1, -0.0f, 1, 1.5f, 1e30f, -1e30f, 1e-40f };
+		values.insert( values.end(), outside, outside + sizeof(outside) / sizeof(outside[0]) );
+
+		std::vector<uint8_t> encoded( values.size() );
+		ip::linearToSrgb( values.data(), encoded.data(), values.size() );
+		bool result = true;
+		for( size_t i = 0; i < values.size(); ++i )
+			result = result && ( encoded[i] == EncodeSrgb8( values[i] ) );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void linearToSrgb( const float *src, uint8_t *dst, size_t count );" << "\n";
+	}
+
+	// void srgbToLinear( const uint8_t *src, float *dst, size_t count );
+	{
+		// the 8-bit table, and the float batches, in place or not, equal the scalar functions bit for bit
+		std::vector<uint8_t> bytes( 256 );
+		std::vector<float> floats( 256 ), decoded( 256 ), encoded( 256 ), inPlace;
+		for( int k = 0; k < 256; ++k ) {
+			bytes[k] = (uint8_t)k;
+			floats[k] = rnd.nextFloat( -0.25f, 1.25f );
+		}
+		std::vector<float> table( 256 );
+		ip::srgbToLinear( bytes.data(), table.data(), 256 );
+		ip::srgbToLinear( floats.data(), decoded.data(), 256 );
+		ip::linearToSrgb( floats.data(), encoded.data(), 256 );
+		bool result = true;
+		for( int k = 0; k < 256; ++k )
+			result = result && ( table[k] == ip::srgbToLinear( k / 255.0f ) ) && ( encoded[k] == ip::linearToSrgb( floats[k] ) )
+						&& ( decoded[k] == ip::srgbToLinear( floats[k] ) );
+		inPlace = floats;
+		ip::srgbToLinear( inPlace.data(), inPlace.data(), 256 );
+		result = result && ( memcmp( inPlace.data(), decoded.data(), 256 * sizeof(float) ) == 0 );
+		inPlace = floats;
+		ip::linearToSrgb( inPlace.data(), inPlace.data(), 256 );
+		result = result && ( inPlace == encoded );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void srgbToLinear( const uint8_t *src, float *dst, size_t count );" << "\n";
+	}
+
+	// void rgbToHsv( const Colorf *src, Vec3f *dst, size_t count ); void hsvToRgb( const Vec3f *src, Colorf *dst, size_t count );
+	{
+		// bit for bit the same as rgbToHSV() and hsvToRGB(), for every count up to 23 so the SIMD loop meets each tail
+		bool result = true;
+		for( size_t count = 0; count < 24; ++count ) {
+			for( int repeat = 0; repeat < 50; ++repeat ) {
+				std::vector<Colorf> colors( count ), rgb( count );
+				std::vector<Vec3f> triples( count ), hsv( count );
+				for( size_t i = 0; i < count; ++i ) {
+					colors[i] = RandomHsvTestColor( rnd );
+					triples[i] = RandomHsvTestTriple( rnd );
+				}
+				ip::rgbToHsv( colors.data(), hsv.data(), count );
+				ip::hsvToRgb( triples.data(), rgb.data(), count );
+				for( size_t i = 0; i < count; ++i ) {
+					const Vec3f expectedHsv = rgbToHSV( colors[i] );
+					const Colorf expectedRgb = hsvToRGB( triples[i] );
+					result = result && ( memcmp( &hsv[i], &expectedHsv, sizeof(Vec3f) ) == 0 ) && ( memcmp( &rgb[i], &expectedRgb, sizeof(Colorf) ) == 0 );
+				}
+			}
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "void rgbToHsv( const Colorf *src, Vec3f *dst, size_t count ); void hsvToRgb( const Vec3f *src, Colorf *dst, size_t count );" << "\n";
+	}
+
+	// template<typename T> void srgbToLinear( SurfaceT<T> *surface ); linearToSrgb(); rgbToHsv(); hsvToRgb();
+	{
+		// 8-bit Surfaces go through the tables, the others through the float functions; all must store what the scalar functions give
+		bool result = MatchesScalarColorConvert<uint8_t>( rnd ) && MatchesScalarColorConvert<uint16_t>( rnd ) && MatchesScalarColorConvert<float>( rnd );
+
+		os << (result ? "passed" : "FAILED") << " : " << "template<typename T> void srgbToLinear( SurfaceT<T> *surface ); linearToSrgb(); rgbToHsv(); hsvToRgb();" << "\n";
+	}
+}
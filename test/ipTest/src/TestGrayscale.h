@@ -0,0 +1,259 @@
+#pragma once
+
+// Every channel order, with and without alpha or padding
+inline std::vector<SurfaceChannelOrder> AllChannelOrders()
+{
+	const int codes[] = { SurfaceChannelOrder::RGBA, SurfaceChannelOrder::BGRA, SurfaceChannelOrder::ARGB, SurfaceChannelOrder::ABGR, SurfaceChannelOrder::RGBX,
+							SurfaceChannelOrder::BGRX, SurfaceChannelOrder::XRGB, SurfaceChannelOrder::XBGR, SurfaceChannelOrder::RGB, SurfaceChannelOrder::BGR };
+	return std::vector<SurfaceChannelOrder>( codes, codes + sizeof(codes) / sizeof(codes[0]) );
+}
+
+template<typename T>
+inline SurfaceT<T> MakeNoiseSurface( int32_t width, int32_t height, const SurfaceChannelOrder &order, Rand &rnd )
+{
+	SurfaceT<T> result( width, height, order.hasAlpha(), order );
+	FillStatisticsNoise( &result, rnd );
+	return result;
+}
+
+// Noise which often equals the threshold: the full range for the integer types, multiples of 1/8 in [0,2] for float
+template<typename T>
+inline void FillThresholdNoise( SurfaceT<T> *surface, Rand &rnd )
+{
+	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
+		T *p = surface->getData( Vec2i( 0, y ) );
+		for( int32_t x = 0; x < surface->getWidth() * surface->getPixelInc(); ++x )
+			p[x] = ( CHANTRAIT<T>::max() == 1 ) ? (T)( rnd.nextInt( 17 ) / 8.0f ) : (T)rnd.nextInt( (int32_t)CHANTRAIT<T>::max() + 1 );
+	}
+}
+
+template<typename T>
+inline bool AreBitwiseEqual( const ChannelT<T> &a, const ChannelT<T> &b )
+{
+	for( int32_t y = 0; y < a.getHeight(); ++y ) {
+		for( int32_t x = 0; x < a.getWidth(); ++x ) {
+			if( memcmp( a.getData( Vec2i( x, y ) ), b.getData( Vec2i( x, y ) ), sizeof(T) ) )
+				return false;
+		}
+	}
+	return true;
+}
+
+// The luma of the Surface to Channel overload, whose 8-bit weights differ from CHANTRAIT's
+inline uint8_t ChannelLuma( uint8_t r, uint8_t g, uint8_t b )	{ return ( r * 74 + g * 147 + b * 35 ) >> 8; }
+inline float ChannelLuma( float r, float g, float b )			{ return CHANTRAIT<float>::grayscale( r, g, b ); }
+
+// Returns \a dst with the red, green and blue of each pixel the two share set to CHANTRAIT's luma of \a src
+template<typename T>
+inline SurfaceT<T> GrayscaleScalar( const SurfaceT<T> &src, const SurfaceT<T> &dst )
+{
+	SurfaceT<T> result = dst.clone();
+	const Area area = src.getBounds().getClipBy( dst.getBounds() );
+	for( int32_t y = area.y1; y < area.y2; ++y ) {
+		for( int32_t x = area.x1; x < area.x2; ++x ) {
+			const T *s = src.getData( Vec2i( x, y ) );
+			T *d = result.getData( Vec2i( x, y ) );
+			d[result.getRedOffset()] = d[result.getGreenOffset()] = d[result.getBlueOffset()] = CHANTRAIT<T>::grayscale( s[src.getRedOffset()], s[src.getGreenOffset()], s[src.getBlueOffset()] );
+		}
+	}
+	return result;
+}
+
+// Returns \a surface with the red, green and blue of each pixel in \a area of \a src thresholded against \a value, at the same position offset by \a dstOffset
+template<typename T>
+inline SurfaceT<T> ThresholdScalar( const SurfaceT<T> &src, T value, const Area &area, const Vec2i &dstOffset, const SurfaceT<T> &surface )
+{
+	SurfaceT<T> result = surface.clone();
+	for( int32_t y = area.y1; y < area.y2; ++y ) {
+		for( int32_t x = area.x1; x < area.x2; ++x ) {
+			const T *s = src.getData( Vec2i( x, y ) );
+			T *d = result.getData( Vec2i( x, y ) + dstOffset );
+			d[result.getRedOffset()] = ( s[src.getRedOffset()] > value ) ? CHANTRAIT<T>::max() : 0;
+			d[result.getGreenOffset()] = ( s[src.getGreenOffset()] > value ) ? CHANTRAIT<T>::max() : 0;
+			d[result.getBlueOffset()] = ( s[src.getBlueOffset()] > value ) ? CHANTRAIT<T>::max() : 0;
+		}
+	}
+	return result;
+}
+
+// Checks threshold() in place over partial areas, and into Surfaces of every channel order and a different size, for sources of every order
+template<typename T>
+inline bool MatchesScalarThreshold( const T *values, size_t numValues, Rand &rnd )
+{
+	const std::vector<SurfaceChannelOrder> orders = AllChannelOrders();
+	// inside, across every edge, touching the right and bottom edges, empty, and the whole surface
+	const Area areas[] = { Area( 3, 2, 30, 9 ), Area( -5, -5, 10, 100 ), Area( 20, 0, 37, 11 ), Area( 5, 5, 5, 9 ), Area( 0, 0, 37, 11 ) };
+	for( size_t o = 0; o < orders.size(); ++o ) {
+		SurfaceT<T> original( 37, 11, orders[o].hasAlpha(), orders[o] );
+		FillThresholdNoise( &original, rnd );
+		for( size_t v = 0; v < numValues; ++v ) {
+			for( size_t a = 0; a < sizeof(areas) / sizeof(areas[0]); ++a ) {
+				SurfaceT<T> thresholded = original.clone();
+				ip::threshold( &thresholded, values[v], areas[a] );
+				if( ! AreBitwiseEqual( thresholded, ThresholdScalar( original, values[v], areas[a].getClipBy( original.getBounds() ), Vec2i::zero(), original ) ) )
+					return false;
+			}
+
+			SurfaceT<T> whole = original.clone();
+			ip::threshold( &whole, values[v] );
+			if( ! AreBitwiseEqual( whole, ThresholdScalar( original, values[v], original.getBounds(), Vec2i::zero(), original ) ) )
+				return false;
+
+			// the same order takes the element runs, the others pixel by pixel; alpha and padding in the destination are kept
+			for( size_t d = 0; d < orders.size(); ++d ) {
+				SurfaceT<T> dst( 29, 13, orders[d].hasAlpha(), orders[d] );
+				FillThresholdNoise( &dst, rnd );
+				const SurfaceT<T> expected = ThresholdScalar( original, values[v], Area( 0, 0, 29, 11 ), Vec2i::zero(), dst );
+				ip::threshold( original, values[v], &dst );
+				if( ! AreBitwiseEqual( dst, expected ) )
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Checks threshold() between packed Channels, which take the element runs, and the strided Channels of 4-element Surfaces
+template<typename T>
+inline bool MatchesScalarChannelThreshold( const T *values, size_t numValues, Rand &rnd )
+{
+	SurfaceT<T> srcSurface( 37, 11, true, SurfaceChannelOrder::BGRA );
+	FillThresholdNoise( &srcSurface, rnd );
+	ChannelT<T> packed( 37, 11 );
+	for( int32_t y = 0; y < 11; ++y ) {
+		for( int32_t x = 0; x < 37; ++x )
+			packed.setValue( Vec2i( x, y ), srcSurface.getChannelGreen().getValue( Vec2i( x, y ) ) );
+	}
+
+	for( size_t v = 0; v < numValues; ++v ) {
+		ChannelT<T> packedDst( 40, 9 );
+		SurfaceT<T> stridedDst( 40, 9, true, SurfaceChannelOrder::ARGB );
+		FillThresholdNoise( &stridedDst, rnd );
+		for( int32_t y = 0; y < 9; ++y ) {
+			for( int32_t x = 0; x < 40; ++x )
+				packedDst.setValue( Vec2i( x, y ), stridedDst.getChannelBlue().getValue( Vec2i( x, y ) ) );
+		}
+		ChannelT<T> packedExpected = packedDst.clone();
+		SurfaceT<T> stridedExpected = stridedDst.clone();
+		for( int32_t y = 0; y < 9; ++y ) {
+			for( int32_t x = 0; x < 37; ++x ) {
+				const T thresholded = ( packed.getValue( Vec2i( x, y ) ) > values[v] ) ? CHANTRAIT<T>::max() : 0;
+				packedExpected.setValue( Vec2i( x, y ), thresholded );
+				stridedExpected.getChannelBlue().setValue( Vec2i( x, y ), thresholded );
+			}
+		}
+
+		ip::threshold( packed, values[v], &packedDst );
+		ip::threshold( srcSurface.getChannelGreen(), values[v], &stridedDst.getChannelBlue() );
+		if( ! AreBitwiseEqual( packedDst, packedExpected ) || ! AreBitwiseEqual( stridedDst, stridedExpected ) )
+			return false;
+	}
+	return true;
+}
+
+inline void TestGrayscale( std::ostream& os )
+{
+	Rand rnd( 2687 );
+	const std::vector<SurfaceChannelOrder> orders = AllChannelOrders();
+
+	// template<typename T> void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );
+	{
+		// every pair of orders matches CHANTRAIT's luma bit for bit, over the area the two share; alpha, padding and the rest of the destination are kept
+		bool result = true;
+		for( size_t s = 0; s < orders.size(); ++s ) {
+			const Surface8u src8 = MakeNoiseSurface<uint8_t>( 37, 11, orders[s], rnd );
+			const Surface32f src32 = MakeNoiseSurface<float>( 37, 11, orders[s], rnd );
+			for( size_t d = 0; d < orders.size(); ++d ) {
+				Surface8u dst8 = MakeNoiseSurface<uint8_t>( 29, 13, orders[d], rnd ), same8 = MakeNoiseSurface<uint8_t>( 37, 11, orders[d], rnd );
+				Surface32f dst32 = MakeNoiseSurface<float>( 29, 13, orders[d], rnd );
+				const Surface8u expected8 = GrayscaleScalar( src8, dst8 ), expectedSame8 = GrayscaleScalar( src8, same8 );
+				const Surface32f expected32 = GrayscaleScalar( src32, dst32 );
+				ip::grayscale( src8, &dst8 );
+				ip::grayscale( src8, &same8 );
+				ip::grayscale( src32, &dst32 );
+				result = result && AreBitwiseEqual( dst8, expected8 ) && AreBitwiseEqual( same8, expectedSame8 ) && AreBitwiseEqual( dst32, expected32 );
+			}
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "template<typename T> void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );" << "\n";
+	}
+
+	// template<typename T> void grayscale( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel );
+	{
+		// 8-bit keeps its own weights; packed Channels take the SIMD kernels, the strided Channel of a Surface the scalar loop, leaving its other elements alone
+		bool result = true;
+		for( size_t s = 0; s < orders.size(); ++s ) {
+			const Surface8u src8 = MakeNoiseSurface<uint8_t>( 37, 11, orders[s], rnd );
+			const Surface32f src32 = MakeNoiseSurface<float>( 37, 11, orders[s], rnd );
+			Channel8u dst8( 29, 13 );
+			Channel32f dst32( 40, 9 );
+			Surface8u strided8 = MakeNoiseSurface<uint8_t>( 40, 9, SurfaceChannelOrder::RGBA, rnd );
+			Surface8u expectedStrided8 = strided8.clone();
+			ip::grayscale( src8, &dst8 );
+			ip::grayscale( src32, &dst32 );
+			ip::grayscale( src8, &strided8.getChannelGreen() );
+			for( int32_t y = 0; y < 13; ++y ) {
+				for( int32_t x = 0; x < 40; ++x ) {
+					const Vec2i pos( x, y );
+					if( src8.getBounds().contains( pos ) && dst8.getBounds().contains( pos ) ) {
+						const ColorA8u c = src8.getPixel( pos );
+						result = result && ( dst8.getValue( pos ) == ChannelLuma( c.r, c.g, c.b ) );
+					}
+					if( src8.getBounds().contains( pos ) && strided8.getBounds().contains( pos ) ) {
+						const ColorA8u c = src8.getPixel( pos );
+						expectedStrided8.getChannelGreen().setValue( pos, ChannelLuma( c.r, c.g, c.b ) );
+					}
+					if( src32.getBounds().contains( pos ) && dst32.getBounds().contains( pos ) ) {
+						const ColorAf c = src32.getPixel( pos );
+						const float value = dst32.getValue( pos ), expected = ChannelLuma( c.r, c.g, c.b );
+						result = result && ( memcmp( &value, &expected, sizeof(float) ) == 0 );
+					}
+				}
+			}
+			result = result && AreBitwiseEqual( strided8, expectedStrided8 );
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "template<typename T> void grayscale( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel );" << "\n";
+	}
+
+	// template<typename T> void grayscale( const ChannelT<T> &srcChannel, SurfaceT<T> *dstSurface );
+	{
+		bool result = true;
+		for( size_t d = 0; d < orders.size(); ++d ) {
+			const Surface32f gray = MakeNoiseSurface<float>( 37, 11, SurfaceChannelOrder::RGBA, rnd );
+			Surface32f dst = MakeNoiseSurface<float>( 29, 13, orders[d], rnd );
+			Surface32f expected = dst.clone();
+			for( int32_t y = 0; y < 11; ++y ) {
+				for( int32_t x = 0; x < 29; ++x ) {
+					float *p = expected.getData( Vec2i( x, y ) );
+					p[expected.getRedOffset()] = p[expected.getGreenOffset()] = p[expected.getBlueOffset()] = gray.getChannelAlpha().getValue( Vec2i( x, y ) );
+				}
+			}
+			ip::grayscale( gray.getChannelAlpha(), &dst );
+			result = result && AreBitwiseEqual( dst, expected );
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "template<typename T> void grayscale( const ChannelT<T> &srcChannel, SurfaceT<T> *dstSurface );" << "\n";
+	}
+
+	// template<typename T> void threshold( SurfaceT<T> *surface, T value, const Area &area );
+	{
+		// in place and between Surfaces, at the extremes of each type's range and at values the data often equals
+		const uint8_t values8[] = { 0, 1, 127, 128, 254, 255 };
+		const uint16_t values16[] = { 0, 1, 32767, 32768, 65534, 65535 };
+		const float values32[] = { -1, 0, 0.5f, 1, 1.875f, 2 };
+		bool result = MatchesScalarThreshold( values8, 6, rnd ) && MatchesScalarThreshold( values16, 6, rnd ) && MatchesScalarThreshold( values32, 6, rnd );
+
+		os << (result ? "passed" : "FAILED") << " : " << "template<typename T> void threshold( SurfaceT<T> *surface, T value, const Area &area );" << "\n";
+	}
+
+	// template<typename T> void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel );
+	{
+		const uint8_t values8[] = { 0, 128, 255 };
+		const uint16_t values16[] = { 0, 32768, 65535 };
+		const float values32[] = { 0, 0.5f, 1 };
+		bool result = MatchesScalarChannelThreshold( values8, 3, rnd ) && MatchesScalarChannelThreshold( values16, 3, rnd ) && MatchesScalarChannelThreshold( values32, 3, rnd );
+
+		os << (result ? "passed" : "FAILED") << " : " << "template<typename T> void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel );" << "\n";
+	}
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+// Fills \a surface with uniformly distributed values
+template<typename T>
+inline void FillRandom( SurfaceT<T> *surface, Rand &rnd )
+{
+	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
+		T *p = surface->getData( Vec2i( 0, y ) );
+		for( int32_t x = 0; x < surface->getWidth() * surface->getPixelInc(); ++x )
+			p[x] = ( CHANTRAIT<T>::max() == 255 ) ? (T)rnd.nextInt( 256 ) : (T)rnd.nextFloat();
+	}
+}
+
+// Checks the size of each level, which halves (rounding down, but never below 1) until 1x1
+template<typename T>
+inline bool AreMipmapSizesValid( const SurfaceT<T> &surface, const std::vector<SurfaceT<T> > &levels )
+{
+	int32_t width = surface.getWidth(), height = surface.getHeight();
+	for( size_t l = 0; l < levels.size(); ++l ) {
+		width = std::max( 1, width / 2 );
+		height = std::max( 1, height / 2 );
+		if( levels[l].getWidth() != width || levels[l].getHeight() != height || levels[l].hasAlpha() != surface.hasAlpha() || ! ( levels[l].getChannelOrder() == surface.getChannelOrder() ) )
+			return false;
+	}
+	return true;
+}
+
+// Checks every channel of each level of a power-of-two \a surface against the plain average of the block of source pixels it covers
+template<typename T>
+inline bool MatchesBoxAverage( const SurfaceT<T> &surface, const std::vector<SurfaceT<T> > &levels, float tolerance )
+{
+	const int numChannels = surface.hasAlpha() ? 4 : 3;
+	for( size_t l = 0; l < levels.size(); ++l ) {
+		const int32_t blockWidth = surface.getWidth() / levels[l].getWidth(), blockHeight = surface.getHeight() / levels[l].getHeight();
+		for( int32_t y = 0; y < levels[l].getHeight(); ++y ) {
+			for( int32_t x = 0; x < levels[l].getWidth(); ++x ) {
+				double sum[4] = { 0, 0, 0, 0 };
+				for( int32_t sy = y * blockHeight; sy < ( y + 1 ) * blockHeight; ++sy ) {
+					for( int32_t sx = x * blockWidth; sx < ( x + 1 ) * blockWidth; ++sx ) {
+						ColorAT<T> c = surface.getPixel( Vec2i( sx, sy ) );
+						sum[0] += c.r; sum[1] += c.g; sum[2] += c.b; sum[3] += c.a;
+					}
+				}
+				ColorAT<T> c = levels[l].getPixel( Vec2i( x, y ) );
+				const T actual[4] = { c.r, c.g, c.b, c.a };
+				for( int ch = 0; ch < numChannels; ++ch ) {
+					if( std::abs( actual[ch] - sum[ch] / ( blockWidth * blockHeight ) ) > tolerance )
+						return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+inline void TestMipmap( std::ostream& os )
+{
+	Rand rnd( 1031 );
+
+	// std::vector<SurfaceT<T> > generateMipmaps( const SurfaceT<T> &srcSurface, const FilterBase &filter = FilterBox(), bool srgb = false, int maxLevels = 0 );
+	{
+		// level sizes, including non-square and odd sources
+		Surface8u surface( 37, 20, false );
+		FillRandom( &surface, rnd );
+		std::vector<Surface8u> levels = ip::generateMipmaps( surface );
+		bool result = ( levels.size() == 5 ) && AreMipmapSizesValid( surface, levels ) && ( levels.back().getSize() == Vec2i( 1, 1 ) );
+
+		Surface8u tall( 1, 9, true );
+		FillRandom( &tall, rnd );
+		levels = ip::generateMipmaps( tall );
+		result = result && ( levels.size() == 3 ) && AreMipmapSizesValid( tall, levels );
+
+		levels = ip::generateMipmaps( surface, FilterBox(), false, 2 );
+		result = result && ( levels.size() == 2 ) && AreMipmapSizesValid( surface, levels );
+
+		// a 1x1 source has no levels below it
+		result = result && ip::generateMipmaps( Surface8u( 1, 1, false ) ).empty();
+
+		os << (result ? "passed" : "FAILED") << " : " << "std::vector<SurfaceT<T> > generateMipmaps( const SurfaceT<T> &srcSurface, const FilterBase &filter = FilterBox(), bool srgb = false, int maxLevels = 0 );" << "\n";
+	}
+
+	// generateMipmaps(); FilterBox
+	{
+		// each pixel averages the block of the source it covers, within rounding
+		Surface8u surface( 64, 32, true, SurfaceChannelOrder::BGRA );
+		FillRandom( &surface, rnd );
+		surface.setPremultiplied( true );
+		bool result = MatchesBoxAverage( surface, ip::generateMipmaps( surface ), 0.5f + 0.001f );
+
+		Surface32f surface32f( 32, 32, false );
+		FillRandom( &surface32f, rnd );
+		result = result && MatchesBoxAverage( surface32f, ip::generateMipmaps( surface32f ), 0.0001f );
+
+		// an odd dimension spreads the box over three source pixels
+		Surface8u odd( 3, 3, false );
+		for( int32_t y = 0; y < 3; ++y )
+			for( int32_t x = 0; x < 3; ++x )
+				odd.setPixel( Vec2i( x, y ), Color8u( (uint8_t)( 10 * ( y * 3 + x ) ), 0, 255 ) );
+		std::vector<Surface8u> levels = ip::generateMipmaps( odd );
+		result = result && ( levels.size() == 1 ) && ( levels[0].getPixel( Vec2i( 0, 0 ) ) == ColorA8u( 40, 0, 255, 255 ) );
+
+		os << (result ? "passed" : "FAILED") << " : " << "generateMipmaps(); FilterBox" << "\n";
+	}
+
+	// generateMipmaps(); alpha
+	{
+		// an unpremultiplied transparent pixel doesn't bleed its color into the level below
+		Surface8u surface( 2, 2, true );
+		surface.setPixel( Vec2i( 0, 0 ), ColorA8u( 255, 0, 0, 0 ) );
+		surface.setPixel( Vec2i( 1, 0 ), ColorA8u( 0, 200, 0, 255 ) );
+		surface.setPixel( Vec2i( 0, 1 ), ColorA8u( 0, 200, 0, 255 ) );
+		surface.setPixel( Vec2i( 1, 1 ), ColorA8u( 0, 200, 0, 255 ) );
+		std::vector<Surface8u> levels = ip::generateMipmaps( surface );
+		bool result = ( levels.size() == 1 ) && ( ! levels[0].isPremultiplied() ) && ( levels[0].getPixel( Vec2i( 0, 0 ) ) == ColorA8u( 0, 200, 0, 191 ) );
+
+		// while a premultiplied source is averaged as is
+		surface.setPixel( Vec2i( 0, 0 ), ColorA8u( 0, 0, 0, 0 ) );
+		surface.setPremultiplied( true );
+		levels = ip::generateMipmaps( surface );
+		result = result && ( levels.size() == 1 ) && levels[0].isPremultiplied() && ( levels[0].getPixel( Vec2i( 0, 0 ) ) == ColorA8u( 0, 150, 0, 191 ) );
+
+		os << (result ? "passed" : "FAILED") << " : " << "generateMipmaps(); alpha" << "\n";
+	}
+
+	// generateMipmaps(); srgb
+	{
+		// black and white average to linear 0.5, not to 8-bit 128
+		Surface8u surface( 2, 2, false );
+		for( int32_t y = 0; y < 2; ++y ) {
+			surface.setPixel( Vec2i( 0, y ), Color8u( 0, 0, 0 ) );
+			surface.setPixel( Vec2i( 1, y ), Color8u( 255, 255, 255 ) );
+		}
+		const uint8_t expected = (uint8_t)( ip::linearToSrgb( 0.5f ) * 255 + 0.5f );
+		std::vector<Surface8u> levels = ip::generateMipmaps( surface, FilterBox(), true );
+		bool result = ( levels.size() == 1 ) && ( levels[0].getPixel( Vec2i( 0, 0 ) ) == ColorA8u( expected, expected, expected, 255 ) ) && ( expected > 180 );
+		levels = ip::generateMipmaps( surface, FilterBox(), false );
+		result = result && ( levels[0].getPixel( Vec2i( 0, 0 ) ) == ColorA8u( 128, 128, 128, 255 ) );
+
+		os << (result ? "passed" : "FAILED") << " : " << "generateMipmaps(); srgb" << "\n";
+	}
+
+	// time taken for the full chain of a 2048x2048 RGBA source
+	os << "   " << "speed test:" << "\n";
+	{
+		Surface8u surface( 2048, 2048, true );
+		FillRandom( &surface, rnd );
+		const FilterBox box;
+		const FilterTriangle triangle;
+		const FilterGaussian gaussian;
+		const std::pair<std::string, const FilterBase*> filters[] = {
+			std::make_pair( "FilterBox", &box ), std::make_pair( "FilterTriangle", &triangle ), std::make_pair( "FilterGaussian", &gaussian )
+		};
+		for( size_t f = 0; f < sizeof(filters) / sizeof(filters[0]); ++f ) {
+			for( int srgb = 0; srgb < 2; ++srgb ) {
+				Timer timer;
+				timer.start();
+				std::vector<Surface8u> levels = ip::generateMipmaps( surface, *filters[f].second, srgb != 0 );
+				timer.stop();
+
+				os << "   " << "   " << filters[f].first << ( srgb ? ", srgb" : "" ) << ": " << levels.size() << " levels in " << timer.getSeconds() << " seconds" << "\n";
+			}
+		}
+	}
+}
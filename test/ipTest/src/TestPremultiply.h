@@ -0,0 +1,126 @@
+#pragma once
+
+// The per-pixel scalar definitions which the SSE2 paths of ip::premultiply() and ip::unpremultiply() must match bit for bit
+inline void PremultiplyScalar( uint8_t *color, uint8_t alpha )		{ *color = CHANTRAIT<uint8_t>::premultiply( *color, alpha ); }
+inline void PremultiplyScalar( float *color, float alpha )			{ *color = CHANTRAIT<float>::premultiply( *color, alpha ); }
+inline void UnpremultiplyScalar( uint8_t *color, uint8_t alpha )	{ if( alpha ) *color = std::min<int>( *color * 255 / alpha, 255 ); }
+inline void UnpremultiplyScalar( float *color, float alpha )		{ if( alpha != 0 ) *color *= 1.0f / alpha; }
+
+// Every 8-bit color against every alpha, with the row width not a multiple of the SIMD width
+inline void FillPremultiplyPattern( Surface8u *surface, Rand &rnd )
+{
+	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
+		for( int32_t x = 0; x < surface->getWidth(); ++x ) {
+			const uint8_t c = (uint8_t)( x + y );
+			surface->setPixel( Vec2i( x, y ), ColorA8u( c, (uint8_t)~c, (uint8_t)rnd.nextInt( 256 ), (uint8_t)y ) );
+		}
+	}
+}
+
+// Random colors and alphas, with a run of zero alphas
+inline void FillPremultiplyPattern( Surface32f *surface, Rand &rnd )
+{
+	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
+		for( int32_t x = 0; x < surface->getWidth(); ++x ) {
+			const float alpha = ( y % 8 == 0 ) ? 0.0f : ( x % 16 == 0 ) ? 1.0f : rnd.nextFloat();
+			surface->setPixel( Vec2i( x, y ), ColorAf( rnd.nextFloat(), rnd.nextFloat( 2.0f ), rnd.nextFloat(), alpha ) );
+		}
+	}
+}
+
+// Applies \a fn to each color channel of a copy of \a surface, with the pixel's alpha
+template<typename T, typename FN>
+inline SurfaceT<T> ApplyScalar( const SurfaceT<T> &surface, const FN &fn )
+{
+	SurfaceT<T> result = surface.clone();
+	for( int32_t y = 0; y < result.getHeight(); ++y ) {
+		T *p = result.getData( Vec2i( 0, y ) );
+		for( int32_t x = 0; x < result.getWidth(); ++x, p += result.getPixelInc() ) {
+			const T alpha = p[result.getAlphaOffset()];
+			fn( &p[result.getRedOffset()], alpha );
+			fn( &p[result.getGreenOffset()], alpha );
+			fn( &p[result.getBlueOffset()], alpha );
+		}
+	}
+	return result;
+}
+
+template<typename T>
+inline bool AreBitwiseEqual( const SurfaceT<T> &a, const SurfaceT<T> &b )
+{
+	for( int32_t y = 0; y < a.getHeight(); ++y ) {
+		if( memcmp( a.getData( Vec2i( 0, y ) ), b.getData( Vec2i( 0, y ) ), a.getWidth() * a.getPixelInc() * sizeof(T) ) )
+			return false;
+	}
+	return true;
+}
+
+// Checks premultiply() and unpremultiply() against the scalar definitions for each 4-channel order
+template<typename T>
+inline bool MatchesScalarPremultiply( int32_t width, int32_t height, Rand &rnd )
+{
+	const SurfaceChannelOrder orders[4] = { SurfaceChannelOrder::RGBA, SurfaceChannelOrder::BGRA, SurfaceChannelOrder::ARGB, SurfaceChannelOrder::ABGR };
+	for( int o = 0; o < 4; ++o ) {
+		SurfaceT<T> original( width, height, true, orders[o] );
+		FillPremultiplyPattern( &original, rnd );
+
+		SurfaceT<T> premultiplied = original.clone();
+		ip::premultiply( &premultiplied );
+		if( ! premultiplied.isPremultiplied() || ! AreBitwiseEqual( premultiplied, ApplyScalar( original, []( T *c, T a ) { PremultiplyScalar( c, a ); } ) ) )
+			return false;
+
+		// unpremultiplying the original as well covers colors greater than their alpha
+		SurfaceT<T> unpremultiplied = original.clone();
+		unpremultiplied.setPremultiplied( true );
+		ip::unpremultiply( &unpremultiplied );
+		if( unpremultiplied.isPremultiplied() || ! AreBitwiseEqual( unpremultiplied, ApplyScalar( original, []( T *c, T a ) { UnpremultiplyScalar( c, a ); } ) ) )
+			return false;
+	}
+	return true;
+}
+
+inline void TestPremultiply( std::ostream& os )
+{
+	Rand rnd( 5003 );
+
+	// template<typename T> void premultiply( SurfaceT<T> *surface ); template<typename T> void unpremultiply( SurfaceT<T> *surface ); Surface8u
+	{
+		bool result = MatchesScalarPremultiply<uint8_t>( 259, 256, rnd ) && MatchesScalarPremultiply<uint8_t>( 3, 256, rnd );
+
+		os << (result ? "passed" : "FAILED") << " : " << "template<typename T> void premultiply( SurfaceT<T> *surface ); template<typename T> void unpremultiply( SurfaceT<T> *surface ); Surface8u" << "\n";
+	}
+
+	// template<typename T> void premultiply( SurfaceT<T> *surface ); template<typename T> void unpremultiply( SurfaceT<T> *surface ); Surface32f
+	{
+		bool result = MatchesScalarPremultiply<float>( 131, 64, rnd );
+
+		os << (result ? "passed" : "FAILED") << " : " << "template<typename T> void premultiply( SurfaceT<T> *surface ); template<typename T> void unpremultiply( SurfaceT<T> *surface ); Surface32f" << "\n";
+	}
+
+	// time taken for a 4096x4096 RGBA surface
+	os << "   " << "speed test:" << "\n";
+	{
+		Surface8u surface8u( 4096, 4096, true );
+		FillPremultiplyPattern( &surface8u, rnd );
+		Timer timer;
+		timer.start();
+		ip::premultiply( &surface8u );
+		timer.stop();
+		double premultiplySeconds = timer.getSeconds();
+		timer.start();
+		ip::unpremultiply( &surface8u );
+		timer.stop();
+		os << "   " << "   " << "Surface8u: premultiply() " << premultiplySeconds << " seconds, unpremultiply() " << timer.getSeconds() << " seconds" << "\n";
+
+		Surface32f surface32f( 4096, 4096, true );
+		FillPremultiplyPattern( &surface32f, rnd );
+		timer.start();
+		ip::premultiply( &surface32f );
+		timer.stop();
+		premultiplySeconds = timer.getSeconds();
+		timer.start();
+		ip::unpremultiply( &surface32f );
+		timer.stop();
+		os << "   " << "   " << "Surface32f: premultiply() " << premultiplySeconds << " seconds, unpremultiply() " << timer.getSeconds() << " seconds" << "\n";
+	}
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+// Fills \a surface with noise over the full range of T, or [0,2] for float so that luminances stay positive while exceeding 1
+template<typename T>
+inline void FillStatisticsNoise( SurfaceT<T> *surface, Rand &rnd )
+{
+	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
+		T *p = surface->getData( Vec2i( 0, y ) );
+		for( int32_t x = 0; x < surface->getWidth() * surface->getPixelInc(); ++x )
+			p[x] = ( CHANTRAIT<T>::max() == 1 ) ? (T)rnd.nextFloat( 2.0f ) : (T)rnd.nextInt( (int32_t)CHANTRAIT<T>::max() + 1 );
+	}
+}
+
+inline bool IsNear( double a, double b, double relativeTolerance )
+{
+	return std::abs( a - b ) <= relativeTolerance * std::max( 1.0, std::max( std::abs( a ), std::abs( b ) ) );
+}
+
+// The brute-force references below visit every pixel of the clipped area one at a time through getData( Vec2i )
+
+template<typename T>
+inline bool MatchesBruteForceSumMean( const SurfaceT<T> &surface, const Area &area, double tolerance )
+{
+	const Area clipped = area.getClipBy( surface.getBounds() );
+	double sums[4] = { 0, 0, 0, 0 };
+	for( int32_t y = clipped.y1; y < clipped.y2; ++y ) {
+		for( int32_t x = clipped.x1; x < clipped.x2; ++x ) {
+			const T *p = surface.getData( Vec2i( x, y ) );
+			sums[0] += p[surface.getRedOffset()]; sums[1] += p[surface.getGreenOffset()]; sums[2] += p[surface.getBlueOffset()];
+			if( surface.hasAlpha() )
+				sums[3] += p[surface.getAlphaOffset()];
+		}
+	}
+	const double numPixels = std::max( 1.0, (double)clipped.calcArea() );
+	const Vec4d sum = ip::calcSum( surface, area );
+	const ColorA mean = ip::calcMean( surface, area );
+	return IsNear( sum.x, sums[0], tolerance ) && IsNear( sum.y, sums[1], tolerance ) && IsNear( sum.z, sums[2], tolerance ) && IsNear( sum.w, sums[3], tolerance )
+		&& IsNear( mean.r, sums[0] / numPixels, 1e-5 ) && IsNear( mean.g, sums[1] / numPixels, 1e-5 ) && IsNear( mean.b, sums[2] / numPixels, 1e-5 ) && IsNear( mean.a, sums[3] / numPixels, 1e-5 );
+}
+
+template<typename T>
+inline bool MatchesBruteForceSumMean( const ChannelT<T> &channel, const Area &area, double tolerance )
+{
+	const Area clipped = area.getClipBy( channel.getBounds() );
+	double sum = 0;
+	for( int32_t y = clipped.y1; y < clipped.y2; ++y )
+		for( int32_t x = clipped.x1; x < clipped.x2; ++x )
+			sum += *channel.getData( Vec2i( x, y ) );
+	const double numPixels = std::max( 1.0, (double)clipped.calcArea() );
+	return IsNear( ip::calcSum( channel, area ), sum, tolerance ) && IsNear( ip::calcMean( channel, area ), sum / numPixels, 1e-5 );
+}
+
+template<typename T>
+inline bool MatchesBruteForceMinMax( const SurfaceT<T> &surface, const Area &area )
+{
+	const Area clipped = area.getClipBy( surface.getBounds() );
+	ColorAT<T> expectedMin( 0, 0, 0, 0 ), expectedMax( 0, 0, 0, 0 );
+	for( int32_t y = clipped.y1; y < clipped.y2; ++y ) {
+		for( int32_t x = clipped.x1; x < clipped.x2; ++x ) {
+			const ColorAT<T> c = surface.getPixel( Vec2i( x, y ) );
+			if( x == clipped.x1 && y == clipped.y1 )
+				expectedMin = expectedMax = c;
+			expectedMin = ColorAT<T>( std::min( expectedMin.r, c.r ), std::min( expectedMin.g, c.g ), std::min( expectedMin.b, c.b ), std::min( expectedMin.a, c.a ) );
+			expectedMax = ColorAT<T>( std::max( expectedMax.r, c.r ), std::max( expectedMax.g, c.g ), std::max( expectedMax.b, c.b ), std::max( expectedMax.a, c.a ) );
+		}
+	}
+	ColorAT<T> resultMin, resultMax;
+	ip::getMinMax( surface, area, &resultMin, &resultMax );
+	return ( resultMin == expectedMin ) && ( resultMax == expectedMax );
+}
+
+template<typename T>
+inline bool MatchesBruteForceMinMax( const ChannelT<T> &channel, const Area &area )
+{
+	const Area clipped = area.getClipBy( channel.getBounds() );
+	T expectedMin = 0, expectedMax = 0;
+	for( int32_t y = clipped.y1; y < clipped.y2; ++y ) {
+		for( int32_t x = clipped.x1; x < clipped.x2; ++x ) {
+			const T v = *channel.getData( Vec2i( x, y ) );
+			if( x == clipped.x1 && y == clipped.y1 )
+				expectedMin = expectedMax = v;
+			expectedMin = std::min( expectedMin, v );
+			expectedMax = std::max( expectedMax, v );
+		}
+	}
+	T resultMin, resultMax;
+	ip::getMinMax( channel, area, &resultMin, &resultMax );
+	return ( resultMin == expectedMin ) && ( resultMax == expectedMax );
+}
+
+template<typename T>
+inline std::vector<uint32_t> CalcBruteForceHistogram( const ChannelT<T> &channel, const Area &area, int32_t numBins, float rangeMin, float rangeMax )
+{
+	const Area clipped = area.getClipBy( channel.getBounds() );
+	std::vector<uint32_t> result( numBins, 0 );
+	for( int32_t y = clipped.y1; y < clipped.y2; ++y ) {
+		for( int32_t x = clipped.x1; x < clipped.x2; ++x ) {
+			const float bin = ( *channel.getData( Vec2i( x, y ) ) - rangeMin ) * ( numBins / ( rangeMax - rangeMin ) );
+			++result[( bin < 0 ) ? 0 : ( bin >= numBins ) ? numBins - 1 : (int32_t)bin];
+		}
+	}
+	return result;
+}
+
+template<typename T>
+inline bool MatchesBruteForceHistogram( const SurfaceT<T> &surface, const Area &area, int32_t numBins, float rangeMin, float rangeMax )
+{
+	std::vector<uint32_t> red, green, blue, alpha, single;
+	ip::calcHistogram( surface, area, &red, &green, &blue, &alpha, numBins, rangeMin, rangeMax );
+	ip::calcHistogram( surface.getChannelGreen(), area, &single, numBins, rangeMin, rangeMax );
+	return ( red == CalcBruteForceHistogram( surface.getChannelRed(), area, numBins, rangeMin, rangeMax ) )
+		&& ( green == CalcBruteForceHistogram( surface.getChannelGreen(), area, numBins, rangeMin, rangeMax ) )
+		&& ( blue == CalcBruteForceHistogram( surface.getChannelBlue(), area, numBins, rangeMin, rangeMax ) )
+		&& ( alpha == ( surface.hasAlpha() ? CalcBruteForceHistogram( surface.getChannelAlpha(), area, numBins, rangeMin, rangeMax ) : std::vector<uint32_t>( numBins, 0 ) ) )
+		&& ( single == green );
+}
+
+template<typename T>
+inline bool MatchesBruteForceLuminanceStats( const SurfaceT<T> &surface, const Area &area )
+{
+	const Area clipped = area.getClipBy( surface.getBounds() );
+	double sum = 0, logSum = 0;
+	float minLuminance = 0, maxLuminance = 0;
+	for( int32_t y = clipped.y1; y < clipped.y2; ++y ) {
+		for( int32_t x = clipped.x1; x < clipped.x2; ++x ) {
+			const T *p = surface.getData( Vec2i( x, y ) );
+			// 8-bit Surfaces are defined by the luma of ip::grayscale()
+			const float luminance = ( sizeof(T) == 1 ) ? CHANTRAIT<uint8_t>::grayscale( (uint8_t)p[surface.getRedOffset()], (uint8_t)p[surface.getGreenOffset()], (uint8_t)p[surface.getBlueOffset()] ) / 255.0f
+									: CHANTRAIT<float>::grayscale( p[surface.getRedOffset()] / (float)CHANTRAIT<T>::max(), p[surface.getGreenOffset()] / (float)CHANTRAIT<T>::max(), p[surface.getBlueOffset()] / (float)CHANTRAIT<T>::max() );
+			if( x == clipped.x1 && y == clipped.y1 )
+				minLuminance = maxLuminance = luminance;
+			sum += luminance;
+			logSum += std::log( 0.0001 + luminance );
+			minLuminance = std::min( minLuminance, luminance );
+			maxLuminance = std::max( maxLuminance, luminance );
+		}
+	}
+	const double numPixels = std::max( 1.0, (double)clipped.calcArea() );
+	const ip::LuminanceStats stats = ip::calcLuminanceStats( surface, area );
+	const double expectedLogMean = clipped.calcArea() ? std::exp( logSum / numPixels ) : 0;
+	return ( stats.mMin == minLuminance ) && ( stats.mMax == maxLuminance ) && IsNear( stats.mMean, sum / numPixels, 1e-5 ) && IsNear( stats.mLogMean, expectedLogMean, 1e-4 );
+}
+
+// Runs each comparison on a Surface of every 4-channel and 3-channel layout, its channels and a tightly packed copy of one, over several areas
+template<typename T>
+inline bool MatchesBruteForceStatistics( Rand &rnd, double sumTolerance, int32_t numBins, float rangeMin, float rangeMax )
+{
+	const SurfaceChannelOrder orders[4] = { SurfaceChannelOrder::RGBA, SurfaceChannelOrder::BGRA, SurfaceChannelOrder::RGB, SurfaceChannelOrder::BGR };
+	// whole, inset with odd edges, reaching past the bounds, a single column, and empty
+	const Area areas[5] = { Area( 0, 0, 263, 97 ), Area( 17, 5, 250, 90 ), Area( -10, -20, 1000, 50 ), Area( 262, 0, 263, 97 ), Area( 40, 40, 40, 60 ) };
+	for( int o = 0; o < 4; ++o ) {
+		SurfaceT<T> surface( 263, 97, orders[o].hasAlpha(), orders[o] );
+		FillStatisticsNoise( &surface, rnd );
+		ChannelT<T> packed = surface.getChannelBlue().clone();
+		for( int a = 0; a < 5; ++a ) {
+			if( ! MatchesBruteForceSumMean( surface, areas[a], sumTolerance ) || ! MatchesBruteForceMinMax( surface, areas[a] )
+				|| ! MatchesBruteForceHistogram( surface, areas[a], 256, 0, CHANTRAIT<T>::max() ) || ! MatchesBruteForceHistogram( surface, areas[a], numBins, rangeMin, rangeMax )
+				|| ! MatchesBruteForceLuminanceStats( surface, areas[a] ) )
+				return false;
+			for( uint8_t c = 0; c < ( surface.hasAlpha() ? 4 : 3 ); ++c ) {
+				if( ! MatchesBruteForceSumMean( surface.getChannel( c ), areas[a], sumTolerance ) || ! MatchesBruteForceMinMax( surface.getChannel( c ), areas[a] ) )
+					return false;
+			}
+			if( ! MatchesBruteForceSumMean( packed, areas[a], sumTolerance ) || ! MatchesBruteForceMinMax( packed, areas[a] ) )
+				return false;
+		}
+	}
+	return true;
+}
+
+inline void TestStatistics( std::ostream& os )
+{
+	Rand rnd( 7919 );
+
+	// calcSum(), calcMean(), getMinMax(), calcHistogram(), calcLuminanceStats(); uint8_t
+	{
+		bool result = MatchesBruteForceStatistics<uint8_t>( rnd, 0, 10, 20, 200 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "calcSum(), calcMean(), getMinMax(), calcHistogram(), calcLuminanceStats(); uint8_t" << "\n";
+	}
+
+	// calcSum(), calcMean(), getMinMax(), calcHistogram(), calcLuminanceStats(); uint16_t
+	{
+		bool result = MatchesBruteForceStatistics<uint16_t>( rnd, 0, 100, 1000, 60000 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "calcSum(), calcMean(), getMinMax(), calcHistogram(), calcLuminanceStats(); uint16_t" << "\n";
+	}
+
+	// calcSum(), calcMean(), getMinMax(), calcHistogram(), calcLuminanceStats(); float
+	{
+		// rows are summed in single precision
+		bool result = MatchesBruteForceStatistics<float>( rnd, 1e-5, 64, 0.25f, 1.5f );
+
+		os << (result ? "passed" : "FAILED") << " : " << "calcSum(), calcMean(), getMinMax(), calcHistogram(), calcLuminanceStats(); float" << "\n";
+	}
+
+	// time taken over a 4096x4096 RGBA surface
+	os << "   " << "speed test:" << "\n";
+	{
+		Surface8u surface8u( 4096, 4096, true );
+		FillStatisticsNoise( &surface8u, rnd );
+		Surface32f surface32f( 4096, 4096, true );
+		FillStatisticsNoise( &surface32f, rnd );
+		std::vector<uint32_t> red, green, blue, alpha;
+		ColorA8u min8u, max8u;
+		ColorAf min32f, max32f;
+
+		Timer timer;
+		timer.start();
+		ip::calcSum( surface8u, surface8u.getBounds() );
+		timer.stop();
+		os << "   " << "   " << "Surface8u: calcSum() " << timer.getSeconds() << " seconds, ";
+		timer.start();
+		ip::getMinMax( surface8u, surface8u.getBounds(), &min8u, &max8u );
+		timer.stop();
+		os << "getMinMax() " << timer.getSeconds() << " seconds, ";
+		timer.start();
+		ip::calcHistogram( surface8u, surface8u.getBounds(), &red, &green, &blue, &alpha );
+		timer.stop();
+		os << "calcHistogram() " << timer.getSeconds() << " seconds, ";
+		timer.start();
+		ip::calcLuminanceStats( surface8u, surface8u.getBounds() );
+		timer.stop();
+		os << "calcLuminanceStats() " << timer.getSeconds() << " seconds" << "\n";
+
+		timer.start();
+		ip::calcSum( surface32f, surface32f.getBounds() );
+		timer.stop();
+		os << "   " << "   " << "Surface32f: calcSum() " << timer.getSeconds() << " seconds, ";
+		timer.start();
+		ip::getMinMax( surface32f, surface32f.getBounds(), &min32f, &max32f );
+		timer.stop();
+		os << "getMinMax() " << timer.getSeconds() << " seconds, ";
+		timer.start();
+		ip::calcHistogram( surface32f, surface32f.getBounds(), &red, &green, &blue, &alpha, 256, 0, 1 );
+		timer.stop();
+		os << "calcHistogram() " << timer.getSeconds() << " seconds, ";
+		timer.start();
+		ip::calcLuminanceStats( surface32f, surface32f.getBounds() );
+		timer.stop();
+		os << "calcLuminanceStats() " << timer.getSeconds() << " seconds" << "\n";
+	}
+}
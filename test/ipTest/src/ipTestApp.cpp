@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cinder/Channel.h"
+#include "cinder/Filter.h"
+#include "cinder/Rand.h"
+#include "cinder/Surface.h"
+#include "cinder/Timer.h"
+#include "cinder/ip/ColorConvert.h"
+#include "cinder/ip/Grayscale.h"
+#include "cinder/ip/Mipmap.h"
+#include "cinder/ip/Premultiply.h"
+#include "cinder/ip/Statistics.h"
+#include "cinder/ip/Threshold.h"
+using namespace ci;
+
+#include "TestMipmap.h"
+#include "TestPremultiply.h"
+#include "TestStatistics.h"
+#include "TestGrayscale.h"
+#include "TestColorConvert.h"
+
+static const std::string kPre = "   ";
+
+std::string MakeIndentedBlock( const std::stringstream& src )
+{
+	std::stringstream ss;
+	std::string data = src.str();
+	if( ! data.empty() ) {
+		ss << kPre;
+		for( size_t i = 0; i < data.size(); ++i ) {
+			char c = data[i];
+			ss << c;
+			if( '\n' == c ) {
+				ss << kPre;
+			}
+		}
+	}
+	return ss.str();
+}
+
+void DoTest( const std::string& name, void (*testFunc)(std::ostream&) );
+
+#define DO_TEST( _FUNC_ ) \
+	DoTest( #_FUNC_, &_FUNC_ );
+
+int main( int argc, char **argv )
+{
+	std::cout << std::endl;
+
+	DO_TEST( TestMipmap );
+	DO_TEST( TestPremultiply );
+	DO_TEST( TestStatistics );
+	DO_TEST( TestGrayscale );
+	DO_TEST( TestColorConvert );
+
+	std::cout << std::endl;
+
+	return 0;
+}
+
+void DoTest( const std::string& name, void (*testFunc)( std::ostream& os ) )
+{
+	std::cout << "Testing " << name << "\n";
+	std::stringstream ss;
+	testFunc( ss );
+	std::string output = MakeIndentedBlock( ss );
+	if( ! output.empty() ) {
+		std::cout << output << "\n";
+	}
+	std::cout << std::endl;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+// Scalar reference: one Frustum::intersects() call per object, written into a mask like the batch tests.
+inline size_t FrustumCullScalar( const Frustumf &frustum, const std::vector<AxisAlignedBox3f> &boxes, std::vector<uint32_t> *mask )
+{
+	std::fill( mask->begin(), mask->end(), 0 );
+	size_t visible = 0;
+	for( size_t i = 0; i < boxes.size(); ++i ) {
+		if( frustum.intersects( boxes[i] ) ) {
+			(*mask)[i / 32] |= 1u << ( i % 32 );
+			++visible;
+		}
+	}
+	return visible;
+}
+
+inline void TestFrustum( std::ostream& os )
+{
+	CameraPersp cam( 640, 480, 60.0f, 1.0f, 1000.0f );
+	cam.lookAt( Vec3f( 10.0f, 20.0f, -300.0f ), Vec3f( 0.0f, 0.0f, 0.0f ) );
+	Frustumf frustum( cam );
+
+	// Random boxes around the camera; an odd count exercises the SIMD and mask word tails.
+	const size_t count = 200003;
+	Rand rnd( 1234 );
+	std::vector<AxisAlignedBox3f> boxes( count );
+	std::vector<float> cx( count ), cy( count ), cz( count ), hx( count ), hy( count ), hz( count ), radius( count );
+	for( size_t i = 0; i < count; ++i ) {
+		Vec3f center( rnd.nextFloat( -600, 600 ), rnd.nextFloat( -600, 600 ), rnd.nextFloat( -600, 900 ) );
+		Vec3f halfSize( rnd.nextFloat( 0.5f, 10 ), rnd.nextFloat( 0.5f, 10 ), rnd.nextFloat( 0.5f, 10 ) );
+		boxes[i] = AxisAlignedBox3f( center - halfSize, center + halfSize );
+		cx[i] = center.x; cy[i] = center.y; cz[i] = center.z;
+		hx[i] = halfSize.x; hy[i] = halfSize.y; hz[i] = halfSize.z;
+		radius[i] = halfSize.length();
+	}
+
+	const size_t maskWords = ( count + 31 ) / 32;
+	std::vector<uint32_t> scalarMask( maskWords ), batchMask( maskWords ), treeMask( maskWords );
+	size_t scalarVisible = FrustumCullScalar( frustum, boxes, &scalarMask );
+
+	// size_t intersectsSpheres( const T *centerX, const T *centerY, const T *centerZ, const T *radius, size_t count, uint32_t *resultMask ) const;
+	{
+		bool result = true;
+		std::vector<uint32_t> sphereMask( maskWords );
+		size_t visible = frustum.intersectsSpheres( &cx[0], &cy[0], &cz[0], &radius[0], count, &sphereMask[0] );
+		size_t expected = 0;
+		for( size_t i = 0; i < count; ++i ) {
+			bool inside = frustum.intersects( Vec3f( cx[i], cy[i], cz[i] ), radius[i] );
+			expected += inside ? 1 : 0;
+			result = result && ( inside == ( ( sphereMask[i / 32] >> ( i % 32 ) ) & 1 ) );
+		}
+		result = result && ( visible == expected );
+
+		os << (result ? "passed" : "FAILED") << " : " << "size_t intersectsSpheres( const T *centerX, const T *centerY, const T *centerZ, const T *radius, size_t count, uint32_t *resultMask ) const;" << "\n";
+	}
+
+	// size_t intersectsBoxes( const T *centerX, const T *centerY, const T *centerZ, const T *halfSizeX, const T *halfSizeY, const T *halfSizeZ, size_t count, uint32_t *resultMask ) const;
+	{
+		bool result = true;
+		size_t visible = frustum.intersectsBoxes( &cx[0], &cy[0], &cz[0], &hx[0], &hy[0], &hz[0], count, &batchMask[0] );
+		result = ( visible == scalarVisible ) && ( batchMask == scalarMask );
+
+		// counts below the SIMD width and mask word size
+		for( size_t n = 0; n < 40 && result; ++n ) {
+			std::vector<uint32_t> smallMask( ( n + 31 ) / 32 + 1, 0xFFFFFFFF );
+			size_t smallVisible = frustum.intersectsBoxes( &cx[0], &cy[0], &cz[0], &hx[0], &hy[0], &hz[0], n, &smallMask[0] );
+			size_t expected = 0;
+			for( size_t i = 0; i < n; ++i ) {
+				bool inside = ( ( scalarMask[i / 32] >> ( i % 32 ) ) & 1 ) != 0;
+				expected += inside ? 1 : 0;
+				result = result && ( inside == ( ( ( smallMask[i / 32] >> ( i % 32 ) ) & 1 ) != 0 ) );
+			}
+			result = result && ( smallVisible == expected ) && ( smallMask.back() == 0xFFFFFFFF );
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "size_t intersectsBoxes( const T *centerX, const T *centerY, const T *centerZ, const T *halfSizeX, const T *halfSizeY, const T *halfSizeZ, size_t count, uint32_t *resultMask ) const;" << "\n";
+	}
+
+	// size_t intersects( const AxisAlignedBoxTree &tree, uint32_t *resultMask ) const;
+	AxisAlignedBoxTree tree( &boxes[0], count );
+	{
+		bool result = true;
+		size_t visible = frustum.intersects( tree, &treeMask[0] );
+		result = ( visible == scalarVisible ) && ( treeMask == scalarMask );
+
+		// a camera inside the cloud, so that subtrees are split between inside, outside and partial
+		CameraPersp innerCam( 640, 480, 90.0f, 1.0f, 200.0f );
+		innerCam.lookAt( Vec3f( 0.0f, 0.0f, 0.0f ), Vec3f( 1.0f, 0.5f, 0.2f ) );
+		Frustumf innerFrustum( innerCam );
+		std::vector<uint32_t> innerScalarMask( maskWords );
+		size_t innerVisible = FrustumCullScalar( innerFrustum, boxes, &innerScalarMask );
+		result = result && ( innerFrustum.intersects( tree, &treeMask[0] ) == innerVisible ) && ( treeMask == innerScalarMask );
+
+		os << (result ? "passed" : "FAILED") << " : " << "size_t intersects( const AxisAlignedBoxTree &tree, uint32_t *resultMask ) const;" << "\n";
+	}
+
+	// void AxisAlignedBoxTree::refit( const AxisAlignedBox3f *boxes );
+	{
+		bool result = true;
+		std::vector<AxisAlignedBox3f> moved( boxes );
+		for( size_t i = 0; i < count; ++i ) {
+			Vec3f offset( rnd.nextFloat( -40, 40 ), rnd.nextFloat( -40, 40 ), rnd.nextFloat( -40, 40 ) );
+			moved[i] = AxisAlignedBox3f( boxes[i].getMin() + offset, boxes[i].getMax() + offset );
+		}
+		AxisAlignedBoxTree refitTree( tree );
+		refitTree.refit( &moved[0] );
+
+		std::vector<uint32_t> movedScalarMask( maskWords );
+		size_t movedVisible = FrustumCullScalar( frustum, moved, &movedScalarMask );
+		result = ( frustum.intersects( refitTree, &treeMask[0] ) == movedVisible ) && ( treeMask == movedScalarMask );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void AxisAlignedBoxTree::refit( const AxisAlignedBox3f *boxes );" << "\n";
+	}
+
+	// static size_t maskToIndices( const uint32_t *mask, size_t count, uint32_t *indices );
+	{
+		bool result = true;
+		std::vector<uint32_t> indices( count );
+		size_t numIndices = Frustumf::maskToIndices( &scalarMask[0], count, &indices[0] );
+		result = ( numIndices == scalarVisible );
+		size_t next = 0;
+		for( size_t i = 0; i < count && result; ++i ) {
+			if( ( scalarMask[i / 32] >> ( i % 32 ) ) & 1 )
+				result = ( next < numIndices ) && ( indices[next++] == i );
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "static size_t maskToIndices( const uint32_t *mask, size_t count, uint32_t *indices );" << "\n";
+	}
+
+	int iter = 20;
+	os << "   " << "speed test, " << count << " boxes, " << scalarVisible << " visible:" << "\n";
+	{
+		Timer timer;
+		timer.start();
+		for( int i = 0; i < iter; ++i )
+			FrustumCullScalar( frustum, boxes, &scalarMask );
+		timer.stop();
+		os << "   " << "   " << iter << " scalar intersects() loops took " << timer.getSeconds() << " seconds" << "\n";
+	}
+	{
+		Timer timer;
+		timer.start();
+		for( int i = 0; i < iter; ++i )
+			frustum.intersectsBoxes( &cx[0], &cy[0], &cz[0], &hx[0], &hy[0], &hz[0], count, &batchMask[0] );
+		timer.stop();
+		os << "   " << "   " << iter << " intersectsBoxes() calls took " << timer.getSeconds() << " seconds" << "\n";
+	}
+	{
+		Timer timer;
+		timer.start();
+		for( int i = 0; i < iter; ++i )
+			frustum.intersects( tree, &treeMask[0] );
+		timer.stop();
+		os << "   " << "   " << iter << " AxisAlignedBoxTree culls took " << timer.getSeconds() << " seconds" << "\n";
+	}
+}
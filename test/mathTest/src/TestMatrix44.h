@@ -667,6 +667,14 @@ template <typename T> void TestMatrix44( std::ostream& os )
 		result = ( c0 == ( m0*m1 ) );
 
 		os << (result ? "passed" : "FAILED") << " : " << "const Matrix44<T> operator*( const Matrix44<T> &rhs ) const;" << "\n";
+
+		// Multiply comparison test; the SSE kernel sums in a different order, so compare relative to each element
+		Matrix44f fm0( m0 ), fm1( m1 );
+		Matrix44f prod = fm0 * fm1, sseProd = SseMultiply( fm0, fm1 );
+		bool sseResult = true;
+		for( int i = 0; i < 16; ++i )
+			sseResult = sseResult && ( math<float>::abs( prod.m[i] - sseProd.m[i] ) <= (float)EPSILON * std::max( 1.0f, math<float>::abs( prod.m[i] ) ) );
+		os << "   " << "comparison of operator* and MatrixAlgo::SseMultiply test: " << ( sseResult ? "passed" : "FAILED" ) << "\n";
 	}
 
 
@@ -1660,6 +1668,86 @@ template <typename T> void TestMatrix44( std::ostream& os )
 	}
 
 
+	// void transformPoints/transformPointsAffine/transformVecs( const Vec3<T> *src, Vec3<T> *dst, size_t count ) const;
+	// void postMultiply( const Vec4<T> *src, Vec4<T> *dst, size_t count ) const;
+	{
+		bool result = true;
+
+		MatT m0 = MatT::createRotation( Vec3<T>( (T)0.3, (T)1.2, (T)-0.7 ) );
+		m0.setTranslate( Vec3<T>( (T)-22.1904, (T)22.5298, (T)45.0 ) );
+		m0.at( 3, 2 ) = (T)0.01;
+
+		const size_t count = 1000;
+		std::vector<Vec3<T> > src( count ), dst( count );
+		std::vector<Vec4<T> > src4( count ), dst4( count );
+		for( size_t i = 0; i < count; ++i ) {
+			src[i] = Vec3<T>( (T)i * (T)0.1, (T)-4.312 + (T)i, (T)5.2112 - (T)i * (T)0.05 );
+			src4[i] = Vec4<T>( src[i], (T)1 - (T)i * (T)0.001 );
+		}
+
+		m0.transformPoints( &src[0], &dst[0], count );
+		for( size_t i = 0; i < count; ++i )
+			result = result && ( ( dst[i] - m0.transformPoint( src[i] ) ).length() < EPSILON * dst[i].length() + EPSILON );
+		m0.transformPointsAffine( &src[0], &dst[0], count );
+		for( size_t i = 0; i < count; ++i )
+			result = result && ( ( dst[i] - m0.transformPointAffine( src[i] ) ).length() < EPSILON * dst[i].length() + EPSILON );
+		m0.transformVecs( &src[0], &dst[0], count );
+		for( size_t i = 0; i < count; ++i )
+			result = result && ( ( dst[i] - m0.transformVec( src[i] ) ).length() < EPSILON * dst[i].length() + EPSILON );
+		m0.postMultiply( &src4[0], &dst4[0], count );
+		for( size_t i = 0; i < count; ++i )
+			result = result && ( ( dst4[i] - m0 * src4[i] ).length() < EPSILON * dst4[i].length() + EPSILON );
+
+		// in place
+		dst = src;
+		m0.transformPointsAffine( &dst[0], &dst[0], count );
+		for( size_t i = 0; i < count; ++i )
+			result = result && ( ( dst[i] - m0.transformPointAffine( src[i] ) ).length() < EPSILON * dst[i].length() + EPSILON );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void transformPoints/transformPointsAffine/transformVecs/postMultiply( src, dst, count ) const;" << "\n";
+
+		// Batch transform
+		os << "   " << "speed test:" << "\n";
+		int iter = 10000;
+		{
+			Timer timer;
+			timer.start();
+			for( int n = 0; n < iter; ++n ) {
+				for( size_t i = 0; i < count; ++i )
+					dst[i] = m0.transformPoint( src[i] );
+			}
+			timer.stop();
+			os << "   " << "   " << iter * count << " transformPoint() calls took " << timer.getSeconds() << " seconds" << "\n";
+		}
+		{
+			Timer timer;
+			timer.start();
+			for( int n = 0; n < iter; ++n )
+				m0.transformPoints( &src[0], &dst[0], count );
+			timer.stop();
+			os << "   " << "   " << iter * count << " points through transformPoints() took " << timer.getSeconds() << " seconds" << "\n";
+		}
+		{
+			Timer timer;
+			timer.start();
+			for( int n = 0; n < iter; ++n ) {
+				for( size_t i = 0; i < count; ++i )
+					dst[i] = m0.transformPointAffine( src[i] );
+			}
+			timer.stop();
+			os << "   " << "   " << iter * count << " transformPointAffine() calls took " << timer.getSeconds() << " seconds" << "\n";
+		}
+		{
+			Timer timer;
+			timer.start();
+			for( int n = 0; n < iter; ++n )
+				m0.transformPointsAffine( &src[0], &dst[0], count );
+			timer.stop();
+			os << "   " << "   " << iter * count << " points through transformPointsAffine() took " << timer.getSeconds() << " seconds" << "\n";
+		}
+	}
+
+
 	// Vec4<T> getTranslation() const;
 	{
 		bool result = false;
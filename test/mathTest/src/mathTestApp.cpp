@@ -3,8 +3,11 @@
 #include <string>
 #include <vector>
 
+#include "cinder/Camera.h"
+#include "cinder/Frustum.h"
 #include "cinder/Matrix.h"
 #include "cinder/Quaternion.h"
+#include "cinder/Rand.h"
 #include "cinder/Timer.h"
 #include "cinder/Vector.h"
 using namespace ci;
@@ -12,6 +15,7 @@ using namespace ci;
 #include "TestMatrix22.h"
 #include "TestMatrix33.h"
 #include "TestMatrix44.h"
+#include "TestFrustum.h"
 
 static const std::string kPre = "   ";
 
@@ -70,6 +74,7 @@ int main( int argc, char **argv )
 	DO_TEST( TestMatrix22<float> );
 	DO_TEST( TestMatrix33<float> );
 	DO_TEST( TestMatrix44<float> );
+	DO_TEST( TestFrustum );
 	
 	std::cout << std::endl;
 
@@ -0,0 +1,163 @@
+#pragma once
+
+// Pads each row by \a padBytes, which needn't be a multiple of the element size, and allocates from \a allocator
+class SurfaceConstraintsPadded : public SurfaceConstraints {
+  public:
+	SurfaceConstraintsPadded( int32_t padBytes, const PixelAllocatorRef &allocator ) : mPadBytes( padBytes ), mAllocator( allocator ) {}
+
+	virtual int32_t				getRowBytes( int requestedWidth, const SurfaceChannelOrder &sco, int elementSize ) const { return requestedWidth * elementSize * sco.getPixelInc() + mPadBytes; }
+	virtual PixelAllocatorRef	getAllocator() const { return mAllocator; }
+
+	int32_t				mPadBytes;
+	PixelAllocatorRef	mAllocator;
+};
+
+// Passes requests on to \a allocator, recording the sizes last asked for
+class PixelAllocatorRecording : public PixelAllocator {
+  public:
+	PixelAllocatorRecording( const PixelAllocatorRef &allocator ) : mAllocator( allocator ), mAllocatedBytes( 0 ), mDeallocatedBytes( 0 ) {}
+
+	virtual void*	allocate( size_t numBytes ) override { mAllocatedBytes = numBytes; return mAllocator->allocate( numBytes ); }
+	virtual void	deallocate( void *data, size_t numBytes ) override { mDeallocatedBytes = numBytes; mAllocator->deallocate( data, numBytes ); }
+
+	PixelAllocatorRef	mAllocator;
+	size_t				mAllocatedBytes, mDeallocatedBytes;
+};
+
+inline bool IsAligned( const void *data )
+{
+	return ( reinterpret_cast<uintptr_t>( data ) % PixelAllocator::ALIGNMENT ) == 0;
+}
+
+// Returns whether \a pool's counts and byte totals are as given
+inline bool IsPoolState( const PixelAllocatorPoolRef &pool, size_t numAllocations, size_t numHits, size_t residentBytes, size_t pooledBytes )
+{
+	return ( pool->getNumAllocations() == numAllocations ) && ( pool->getNumHits() == numHits ) && ( pool->getResidentBytes() == residentBytes ) && ( pool->getPooledBytes() == pooledBytes );
+}
+
+inline void TestPixelAllocator( std::ostream& os )
+{
+	// void* allocate( size_t numBytes ); hits
+	{
+		// sizes are pooled by their 64-byte bucket, and each bucket hands back the block released last
+		PixelAllocatorPoolRef pool = PixelAllocatorPool::create();
+		void *a = pool->allocate( 100 );
+		bool result = IsPoolState( pool, 1, 0, 128, 0 ) && ( pool->getHitRate() == 0 );
+		pool->deallocate( a, 100 );
+		result = result && IsPoolState( pool, 1, 0, 128, 128 );
+		void *b = pool->allocate( 65 );
+		result = result && ( b == a ) && IsPoolState( pool, 2, 1, 128, 0 );
+		void *c = pool->allocate( 129 );
+		void *d = pool->allocate( 128 );
+		result = result && ( c != a ) && ( d != a ) && IsPoolState( pool, 4, 1, 128 + 192 + 128, 0 ) && ( pool->getHitRate() == 0.25f );
+		pool->deallocate( b, 128 );
+		pool->deallocate( d, 128 );
+		void *e = pool->allocate( 70 );
+		result = result && ( e == d ) && IsPoolState( pool, 5, 2, 128 + 192 + 128, 128 );
+		pool->resetStats();
+		result = result && IsPoolState( pool, 0, 0, 128 + 192 + 128, 128 ) && ( pool->getHitRate() == 0 );
+		pool->deallocate( c, 129 );
+		pool->deallocate( e, 70 );
+		result = result && IsPoolState( pool, 0, 0, 128 + 192 + 128, 128 + 192 + 128 );
+		// a zero-byte allocation still takes a block, from the smallest bucket
+		void *f = pool->allocate( 0 );
+		result = result && ( f != nullptr ) && IsPoolState( pool, 1, 0, 128 + 192 + 128 + 64, 128 + 192 + 128 );
+		pool->deallocate( f, 0 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void* allocate( size_t numBytes ); hits" << "\n";
+	}
+
+	// void setMaxPooledBytes( size_t maxPooledBytes ); void purge();
+	{
+		// releases beyond the limit go back to the heap, and lowering the limit trims the largest buckets first
+		PixelAllocatorPoolRef pool = PixelAllocatorPool::create( 1024 );
+		std::vector<void*> blocks;
+		const size_t sizes[] = { 64, 64, 128, 256, 512, 1024 };
+		for( int i = 0; i < 6; ++i )
+			blocks.push_back( pool->allocate( sizes[i] ) );
+		bool result = IsPoolState( pool, 6, 0, 2048, 0 );
+		for( int i = 0; i < 5; ++i )
+			pool->deallocate( blocks[i], sizes[i] );
+		result = result && IsPoolState( pool, 6, 0, 2048, 1024 );
+		pool->deallocate( blocks[5], 1024 ); // over the limit, so freed
+		result = result && IsPoolState( pool, 6, 0, 1024, 1024 );
+		pool->setMaxPooledBytes( 300 ); // trims 512 and 256
+		result = result && IsPoolState( pool, 6, 0, 256, 256 ) && ( pool->getMaxPooledBytes() == 300 );
+		void *small = pool->allocate( 64 ), *large = pool->allocate( 512 );
+		result = result && IsPoolState( pool, 8, 1, 256 + 512, 192 );
+		pool->purge();
+		result = result && IsPoolState( pool, 8, 1, 64 + 512, 0 );
+		pool->deallocate( small, 64 );
+		pool->deallocate( large, 512 ); // over the lowered limit
+		result = result && IsPoolState( pool, 8, 1, 64, 64 );
+		pool->setMaxPooledBytes( 0 );
+		result = result && IsPoolState( pool, 8, 1, 0, 0 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "void setMaxPooledBytes( size_t maxPooledBytes ); void purge();" << "\n";
+	}
+
+	// void* allocate( size_t numBytes ); alignment
+	{
+		// every block is aligned, from the heap and from the pool, and so is every row of a SurfaceConstraintsAligned Surface
+		Rand rnd( 1801 );
+		PixelAllocatorRef aligned = PixelAllocatorAligned::create();
+		PixelAllocatorPoolRef pool = PixelAllocatorPool::create();
+		std::vector<std::pair<void*,size_t> > blocks;
+		bool result = true;
+		for( int i = 0; i < 2000; ++i ) {
+			const size_t size = rnd.nextUint( 5000 );
+			void *fromHeap = aligned->allocate( size ), *fromPool = pool->allocate( size );
+			result = result && IsAligned( fromHeap ) && IsAligned( fromPool );
+			aligned->deallocate( fromHeap, size );
+			if( rnd.nextBool() )
+				pool->deallocate( fromPool, size );
+			else
+				blocks.push_back( std::make_pair( fromPool, size ) );
+		}
+		result = result && ( pool->getNumHits() > 0 );
+		for( size_t b = 0; b < blocks.size(); ++b )
+			pool->deallocate( blocks[b].first, blocks[b].second );
+
+		for( int32_t width = 1; width < 40; ++width ) {
+			Surface8u surface( width, 3, false, SurfaceConstraintsAligned() );
+			Surface32f surface32( width, 3, true, SurfaceConstraintsAligned() );
+			result = result && ( surface.getRowBytes() % PixelAllocator::ALIGNMENT == 0 ) && ( surface32.getRowBytes() % PixelAllocator::ALIGNMENT == 0 );
+			for( int32_t y = 0; y < 3; ++y )
+				result = result && IsAligned( surface.getData( Vec2i( 0, y ) ) ) && IsAligned( surface32.getData( Vec2i( 0, y ) ) );
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "void* allocate( size_t numBytes ); alignment" << "\n";
+	}
+
+	// SurfaceT( int32_t width, int32_t height, bool alpha, const SurfaceConstraints &constraints );
+	{
+		// a Surface asks for exactly height * rowBytes bytes, whatever the row padding, takes them rounded up to the alignment, and returns them when released
+		PixelAllocatorPoolRef pool = PixelAllocatorPool::create();
+		std::shared_ptr<PixelAllocatorRecording> recording( new PixelAllocatorRecording( pool ) );
+		bool result = true;
+		const int32_t padBytes[] = { 0, 1, 2, 3, 6, 64 };
+		for( int p = 0; p < 6; ++p ) {
+			for( int alpha = 0; alpha < 2; ++alpha ) {
+				{
+					Surface32f surface( 13, 7, alpha != 0, SurfaceConstraintsPadded( padBytes[p], recording ) );
+					const int32_t rowBytes = 13 * ( alpha ? 4 : 3 ) * sizeof(float) + padBytes[p];
+					result = result && ( surface.getRowBytes() == rowBytes ) && ( recording->mAllocatedBytes == size_t( 7 * rowBytes ) ) && ( pool->getResidentBytes() - pool->getPooledBytes() == PixelAllocator::alignSize( 7 * rowBytes ) );
+					// the last pixel of the last row lies within the allocation
+					surface.setPixel( Vec2i( 12, 6 ), ColorAf( 1, 2, 3, 4 ) );
+					result = result && ( surface.getPixel( Vec2i( 12, 6 ) ) == ColorAf( 1, 2, 3, alpha ? 4.0f : 1.0f ) );
+				}
+				result = result && ( recording->mDeallocatedBytes == recording->mAllocatedBytes ) && ( pool->getResidentBytes() == pool->getPooledBytes() );
+			}
+		}
+		// the default constraints use the default allocator, and pack rows tightly: 4 bytes per float channel, not 4 times that
+		pool->purge();
+		PixelAllocator::setDefault( pool );
+		{
+			Surface32f surface( 100, 10, false );
+			result = result && ( pool->getResidentBytes() == PixelAllocator::alignSize( 100 * 10 * 3 * sizeof(float) ) );
+		}
+		PixelAllocator::setDefault( nullptr );
+
+		os << (result ? "passed" : "FAILED") << " : " << "SurfaceT( int32_t width, int32_t height, bool alpha, const SurfaceConstraints &constraints );" << "\n";
+	}
+}
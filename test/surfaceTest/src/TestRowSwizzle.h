@@ -0,0 +1,179 @@
+#pragma once
+
+// Converts as RowSwizzle documents it, one channel at a time
+template<typename SD, typename TD>
+inline void ReferenceSwizzle( const SD *src, const int8_t srcOffsets[4], int8_t srcInc, TD *dst, const int8_t dstOffsets[4], int8_t dstInc, bool fillAlpha, int32_t numPixels )
+{
+	for( int32_t p = 0; p < numPixels; ++p, src += srcInc, dst += dstInc ) {
+		for( int c = 0; c < 4; ++c ) {
+			if( dstOffsets[c] < 0 )
+				continue;
+			if( srcOffsets[c] >= 0 )
+				dst[dstOffsets[c]] = CHANTRAIT<TD>::convert( src[srcOffsets[c]] );
+			else if( c == 3 && fillAlpha )
+				dst[dstOffsets[c]] = CHANTRAIT<TD>::max();
+		}
+	}
+}
+
+template<typename T> inline T RandomValue( Rand &rnd );
+template<> inline uint8_t RandomValue<uint8_t>( Rand &rnd ) { return (uint8_t)rnd.nextUint( 256 ); }
+template<> inline uint16_t RandomValue<uint16_t>( Rand &rnd ) { return (uint16_t)rnd.nextUint( 65536 ); }
+// half exact multiples of 1/255, including 0 and 1
+template<> inline float RandomValue<float>( Rand &rnd ) { return rnd.nextBool() ? rnd.nextUint( 256 ) / 255.0f : rnd.nextFloat(); }
+
+// Fills \a offsets with a random layout of \a inc elements: gray (and alpha) for 1 or 2, otherwise any three or four of red, green, blue and alpha in any order
+inline void RandomLayout( Rand &rnd, int8_t inc, int8_t offsets[4] )
+{
+	offsets[0] = offsets[1] = offsets[2] = offsets[3] = -1;
+	if( inc <= 2 ) {
+		const bool swap = ( inc == 2 ) && rnd.nextBool();
+		offsets[0] = swap ? 1 : 0;
+		if( inc == 2 )
+			offsets[3] = swap ? 0 : 1;
+		return;
+	}
+	int8_t positions[4] = { 0, 1, 2, 3 };
+	for( int i = 3; i > 0; --i )
+		std::swap( positions[i], positions[rnd.nextInt( i + 1 )] );
+	// with three elements, the channel given position 3 is absent
+	for( int c = 0; c < 4; ++c )
+		offsets[c] = ( positions[c] < inc ) ? positions[c] : -1;
+}
+
+/* Returns whether the RowSwizzle for the given layouts converts \a numPixels random pixels, starting \a start elements into each buffer, exactly as
+	ReferenceSwizzle() does. The target starts out random, so untouched channels are checked too, and runs on past the row to catch writes beyond it. */
+template<typename SD, typename TD>
+inline bool MatchesReferenceSwizzle( Rand &rnd, const int8_t srcOffsets[4], int8_t srcInc, const int8_t dstOffsets[4], int8_t dstInc, bool fillAlpha, int32_t numPixels, size_t start )
+{
+	std::vector<SD> src( start + numPixels * srcInc + 16 );
+	for( size_t i = 0; i < src.size(); ++i )
+		src[i] = RandomValue<SD>( rnd );
+	std::vector<TD> dst( start + numPixels * dstInc + 16 );
+	for( size_t i = 0; i < dst.size(); ++i )
+		dst[i] = RandomValue<TD>( rnd );
+	std::vector<TD> expected( dst );
+
+	ReferenceSwizzle( &src[start], srcOffsets, srcInc, &expected[start], dstOffsets, dstInc, fillAlpha, numPixels );
+	RowSwizzle::create<SD,TD>( srcOffsets, srcInc, dstOffsets, dstInc, fillAlpha )( &src[start], &dst[start], numPixels );
+	return dst == expected;
+}
+
+// Checks \a numLayouts random pairs of layouts, at every width up to 40 so every kernel runs both its vector loop and its tail
+template<typename SD, typename TD>
+inline bool MatchesReferenceSwizzles( Rand &rnd, int numLayouts, int8_t minInc )
+{
+	bool result = true;
+	for( int l = 0; l < numLayouts; ++l ) {
+		const int8_t srcInc = minInc + rnd.nextInt( 5 - minInc ), dstInc = minInc + rnd.nextInt( 5 - minInc );
+		int8_t srcOffsets[4], dstOffsets[4];
+		RandomLayout( rnd, srcInc, srcOffsets );
+		RandomLayout( rnd, dstInc, dstOffsets );
+		const bool fillAlpha = rnd.nextBool();
+		for( int32_t numPixels = 0; numPixels <= 40; ++numPixels )
+			result = result && MatchesReferenceSwizzle<SD,TD>( rnd, srcOffsets, srcInc, dstOffsets, dstInc, fillAlpha, numPixels, rnd.nextUint( 4 ) );
+	}
+	return result;
+}
+
+// Returns whether every pixel's alpha at \a alphaOffset in \a dst is the maximum, and its other elements are \a untouched
+template<typename T>
+inline bool IsFilledAlpha( const std::vector<T> &dst, int8_t dstInc, int8_t alphaOffset, T untouched )
+{
+	for( size_t i = 0; i < dst.size(); ++i ) {
+		if( dst[i] != ( ( (int8_t)( i % dstInc ) == alphaOffset ) ? CHANTRAIT<T>::max() : untouched ) )
+			return false;
+	}
+	return true;
+}
+
+inline void TestRowSwizzle( std::ostream& os )
+{
+	Rand rnd( 4243 );
+
+	// template<typename SD, typename TD> static RowSwizzle create( ... ); 8-bit
+	{
+		// random reorderings, expansions and contractions of 3- and 4-channel pixels take the SIMD kernels; gray layouts take the scalar loop
+		bool result = MatchesReferenceSwizzles<uint8_t,uint8_t>( rnd, 400, 3 ) && MatchesReferenceSwizzles<uint8_t,uint8_t>( rnd, 200, 1 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "template<typename SD, typename TD> static RowSwizzle create( ... ); 8-bit" << "\n";
+	}
+
+	// template<typename SD, typename TD> static RowSwizzle create( ... ); uint8_t <-> float
+	{
+		// identical layouts take the SIMD conversions, 16 elements at a time, which must match CHANTRAIT exactly, tails included
+		bool result = true;
+		for( int8_t inc = 1; inc <= 4; ++inc ) {
+			int8_t offsets[4];
+			RandomLayout( rnd, inc, offsets );
+			for( int32_t numPixels = 0; numPixels <= 40; ++numPixels ) {
+				for( size_t start = 0; start < 4; ++start )
+					result = result && MatchesReferenceSwizzle<uint8_t,float>( rnd, offsets, inc, offsets, inc, false, numPixels, start )
+								&& MatchesReferenceSwizzle<float,uint8_t>( rnd, offsets, inc, offsets, inc, false, numPixels, start );
+			}
+		}
+		// every 8-bit value converts to float and back to itself
+		std::vector<uint8_t> values( 256 ), roundTrip( 256 );
+		std::vector<float> floats( 256 );
+		for( int i = 0; i < 256; ++i )
+			values[i] = (uint8_t)i;
+		const int8_t gray[4] = { 0, -1, -1, -1 };
+		RowSwizzle::create<uint8_t,float>( gray, 1, gray, 1 )( &values[0], &floats[0], 256 );
+		RowSwizzle::create<float,uint8_t>( gray, 1, gray, 1 )( &floats[0], &roundTrip[0], 256 );
+		result = result && ( roundTrip == values );
+		// and differing layouts convert in the scalar loop
+		result = result && MatchesReferenceSwizzles<uint8_t,float>( rnd, 100, 1 ) && MatchesReferenceSwizzles<float,uint8_t>( rnd, 100, 1 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "template<typename SD, typename TD> static RowSwizzle create( ... ); uint8_t <-> float" << "\n";
+	}
+
+	// template<typename SD, typename TD> static RowSwizzle create( ... ); uint16_t
+	{
+		bool result = MatchesReferenceSwizzles<uint16_t,uint16_t>( rnd, 100, 1 ) && MatchesReferenceSwizzles<uint8_t,uint16_t>( rnd, 100, 1 ) && MatchesReferenceSwizzles<uint16_t,uint8_t>( rnd, 100, 1 )
+					&& MatchesReferenceSwizzles<uint16_t,float>( rnd, 100, 1 ) && MatchesReferenceSwizzles<float,uint16_t>( rnd, 100, 1 ) && MatchesReferenceSwizzles<float,float>( rnd, 100, 1 );
+
+		os << (result ? "passed" : "FAILED") << " : " << "template<typename SD, typename TD> static RowSwizzle create( ... ); uint16_t" << "\n";
+	}
+
+	// template<typename SD, typename TD> static RowSwizzle create( ..., bool fillAlpha );
+	{
+		// RGB into RGBA and ARGB sets alpha to its maximum and leaves it alone without fillAlpha; a source alpha is copied rather than filled
+		const int8_t rgb[4] = { 0, 1, 2, -1 }, rgbx[4] = { 0, 1, 2, -1 }, rgba[4] = { 0, 1, 2, 3 }, argb[4] = { 1, 2, 3, 0 }, none[4] = { -1, -1, -1, -1 };
+		bool result = true;
+		for( int32_t numPixels = 0; numPixels <= 40; ++numPixels ) {
+			std::vector<uint8_t> src( numPixels * 4, 0 ), dst8( numPixels * 4, 7 ), dstArgb( numPixels * 4, 7 );
+			std::vector<uint16_t> dst16( numPixels * 4, 7 );
+			std::vector<float> dst32( numPixels * 4, 0.5f );
+			RowSwizzle::create<uint8_t,uint8_t>( rgb, 3, rgba, 4, true )( src.data(), dst8.data(), numPixels );
+			RowSwizzle::create<uint8_t,uint8_t>( rgbx, 4, argb, 4, true )( src.data(), dstArgb.data(), numPixels );
+			RowSwizzle::create<uint8_t,uint16_t>( rgb, 3, rgba, 4, true )( src.data(), dst16.data(), numPixels );
+			RowSwizzle::create<uint8_t,float>( rgb, 3, rgba, 4, true )( src.data(), dst32.data(), numPixels );
+			result = result && IsFilledAlpha<uint8_t>( dst8, 4, 3, 0 ) && IsFilledAlpha<uint8_t>( dstArgb, 4, 0, 0 ) && IsFilledAlpha<uint16_t>( dst16, 4, 3, 0 ) && IsFilledAlpha<float>( dst32, 4, 3, 0 );
+
+			// no source channels at all still fills alpha, and touches nothing else
+			std::vector<uint8_t> dstNone( numPixels * 4, 7 );
+			RowSwizzle::create<uint8_t,uint8_t>( none, 4, rgba, 4, true )( src.data(), dstNone.data(), numPixels );
+			result = result && IsFilledAlpha<uint8_t>( dstNone, 4, 3, 7 );
+
+			std::vector<uint8_t> dstKept( numPixels * 4, 7 ), dstCopied( numPixels * 4, 7 );
+			RowSwizzle::create<uint8_t,uint8_t>( rgb, 3, rgba, 4, false )( src.data(), dstKept.data(), numPixels );
+			RowSwizzle::create<uint8_t,uint8_t>( rgba, 4, argb, 4, true )( src.data(), dstCopied.data(), numPixels );
+			for( int32_t p = 0; p < numPixels; ++p )
+				result = result && ( dstKept[p * 4 + 3] == 7 ) && ( dstCopied[p * 4] == 0 );
+		}
+
+		os << (result ? "passed" : "FAILED") << " : " << "template<typename SD, typename TD> static RowSwizzle create( ..., bool fillAlpha );" << "\n";
+	}
+
+	// bool isCopy() const;
+	{
+		// only identical layouts of the same type are copied; filling an alpha the source already has doesn't prevent it
+		const int8_t rgba[4] = { 0, 1, 2, 3 }, bgra[4] = { 2, 1, 0, 3 }, rgbx[4] = { 0, 1, 2, -1 };
+		bool result = RowSwizzle::create<uint8_t,uint8_t>( rgba, 4, rgba, 4 ).isCopy() && RowSwizzle::create<float,float>( rgba, 4, rgba, 4, true ).isCopy()
+					&& RowSwizzle::create<uint8_t,uint8_t>( rgbx, 3, rgbx, 3 ).isCopy() && ( ! RowSwizzle::create<uint8_t,float>( rgba, 4, rgba, 4 ).isCopy() )
+					&& ( ! RowSwizzle::create<uint8_t,uint8_t>( rgba, 4, bgra, 4 ).isCopy() ) && ( ! RowSwizzle::create<uint8_t,uint8_t>( rgbx, 4, rgba, 4, true ).isCopy() )
+					&& ( ! RowSwizzle().isCopy() );
+
+		os << (result ? "passed" : "FAILED") << " : " << "bool isCopy() const;" << "\n";
+	}
+}